@@ -112,6 +112,9 @@ typedef unsigned char		psych_bool;
         // Datatype for threads:
         typedef pthread_t   psych_thread;
         typedef pthread_t   psych_threadid;
+
+        // Full memory barrier for lock-free data exchange between threads:
+        #define PsychMemoryBarrier() __sync_synchronize()
 #endif
 
 #if PSYCH_SYSTEM == PSYCH_WINDOWS
@@ -150,6 +153,9 @@ typedef unsigned char		psych_bool;
 
         typedef psych_uint32  psych_threadid;
 
+        // Full memory barrier for lock-free data exchange between threads:
+        #define PsychMemoryBarrier() MemoryBarrier()
+
 #elif PSYCH_SYSTEM == PSYCH_OSX
         typedef UInt8         psych_uint8;
         typedef UInt16        psych_uint16;
@@ -164,6 +170,9 @@ typedef unsigned char		psych_bool;
         // Datatype for threads:
         typedef pthread_t     psych_thread;
         typedef pthread_t     psych_threadid;
+
+        // Full memory barrier for lock-free data exchange between threads:
+        #define PsychMemoryBarrier() __sync_synchronize()
 #endif
 
 #if PSYCH_LANGUAGE == PSYCH_MATLAB
@@ -31,7 +31,216 @@ double  PsychPopClock(void)
 	return(instrumentTime);
 }
 
+// Number of bins of the histograms of call durations: Bin 0 counts calls shorter
+// than 1 usec, bin k > 0 counts calls of 2^(k-1) to 2^k usecs, the last bin also
+// all longer calls:
+#define PSYCH_PROFILE_HISTOGRAM_BINS 24
 
+// Maximum depth of recursive calls into the module, as in PsychScriptingGlue.c:
+#define PSYCH_PROFILE_MAX_LEVELS 5
 
+typedef struct PsychProfileEntry {
+	double			calls;
+	double			totalTime;
+	double			minTime;
+	double			maxTime;
+	double			bodyTime;
+	double			tempBytes;
+	double			histogram[PSYCH_PROFILE_HISTOGRAM_BINS];
+} PsychProfileEntry;
 
+// State of a call in progress, per recursion level:
+typedef struct PsychProfileCall {
+	psych_bool		active;
+	int				index;
+	double			startTime;
+	double			bodyStartTime;
+	double			bodyTime;
+	psych_uint64	tempBytes;
+} PsychProfileCall;
 
+psych_bool psychProfilingEnabled = FALSE;
+
+// Stats per subfunction, indexed by function table index, with one extra entry for the base function:
+static PsychProfileEntry profileEntries[PSYCH_MAX_FUNCTIONS + 1];
+static PsychProfileCall profileCalls[PSYCH_PROFILE_MAX_LEVELS];
+
+// Start of a call into the module, before marshalling of arguments:
+void	PsychProfileCallBegin(int level)
+{
+	PsychProfileCall *call;
+
+	if ((level < 0) || (level >= PSYCH_PROFILE_MAX_LEVELS)) return;
+	call = &profileCalls[level];
+
+	call->active = TRUE;
+	call->index = PSYCH_MAX_FUNCTIONS;
+	call->bodyTime = 0;
+	call->tempBytes = PsychGetTempMemoryRequested();
+	PsychGetPrecisionTimerSeconds(&call->startTime);
+}
+
+// Start of execution of the subfunction or base function:
+void	PsychProfileBodyBegin(int level)
+{
+	PsychProfileCall *call;
+	int index;
+
+	if ((level < 0) || (level >= PSYCH_PROFILE_MAX_LEVELS) || !profileCalls[level].active) return;
+	call = &profileCalls[level];
+
+	index = PsychGetFunctionIndex();
+	call->index = (index >= 0) ? index : PSYCH_MAX_FUNCTIONS;
+	PsychGetPrecisionTimerSeconds(&call->bodyStartTime);
+}
+
+// End of execution of the subfunction or base function:
+void	PsychProfileBodyEnd(int level)
+{
+	PsychProfileCall *call;
+	double now;
+
+	if ((level < 0) || (level >= PSYCH_PROFILE_MAX_LEVELS) || !profileCalls[level].active) return;
+	call = &profileCalls[level];
+
+	PsychGetPrecisionTimerSeconds(&now);
+	call->bodyTime = now - call->bodyStartTime;
+}
+
+// End of a call into the module, after marshalling of return arguments. Calls aborted by an error are not accounted:
+void	PsychProfileCallEnd(int level)
+{
+	PsychProfileCall *call;
+	PsychProfileEntry *entry;
+	double now, duration;
+	int bin;
+
+	if ((level < 0) || (level >= PSYCH_PROFILE_MAX_LEVELS) || !profileCalls[level].active) return;
+	call = &profileCalls[level];
+	call->active = FALSE;
+
+	PsychGetPrecisionTimerSeconds(&now);
+	duration = now - call->startTime;
+
+	entry = &profileEntries[call->index];
+	if ((entry->calls == 0) || (duration < entry->minTime)) entry->minTime = duration;
+	if (duration > entry->maxTime) entry->maxTime = duration;
+	entry->calls++;
+	entry->totalTime += duration;
+	entry->bodyTime += call->bodyTime;
+	entry->tempBytes += (double) (PsychGetTempMemoryRequested() - call->tempBytes);
+
+	for (bin = 0; (bin < PSYCH_PROFILE_HISTOGRAM_BINS - 1) && (duration * 1e6 >= (double) (1 << bin)); bin++);
+	entry->histogram[bin]++;
+}
+
+/*  This function is called by the special subfunction 'Profile', which is
+ *  available in all modules. It controls profiling of calls into the module,
+ *  and returns the collected stats per subfunction.
+ */
+PsychError PsychProfileModuleFunction(void)
+{
+	static char useString[] = "profile = Modulename('Profile', command);";
+	static char synopsisString[] =
+		"Profile the time spent in calls to each subfunction of this module.\n\n"
+		"'command' can be one of:\n"
+		"'Start' Start profiling of all following calls into the module.\n"
+		"'Stop' Stop profiling. Collected stats are kept.\n"
+		"'Reset' Discard all collected stats.\n"
+		"'Get' Return the collected stats in the struct array 'profile', with one element "
+		"for each subfunction which was called at least once while profiling was active. "
+		"Profiling is disabled by default, and costs almost no time while disabled.\n\n"
+		"Each element has the following fields:\n"
+		"'Name' Name of the subfunction. The module name for calls without subfunction.\n"
+		"'Calls' Number of calls.\n"
+		"'TotalTime' Total duration of all calls in seconds.\n"
+		"'MinTime', 'MaxTime', 'MeanTime' Minimum, maximum and mean duration of a call.\n"
+		"'BodyTime' Total time spent executing the subfunction.\n"
+		"'MarshallingTime' Total time spent in the scripting glue, e.g., with conversion "
+		"of arguments and return values between Matlab/Octave and the module.\n"
+		"'TempBytes' Total amount of temporary memory in Bytes requested by all calls.\n"
+		"'Histogram' Vector with a histogram of call durations: Element 1 counts calls "
+		"shorter than 1 microsecond, element k+1 counts calls of 2^(k-1) to 2^k "
+		"microseconds, the last element also counts all longer calls.\n\n"
+		"Calls aborted by an error are not counted.\n\n"
+		"'TempMemory' Return statistics of the allocator for temporary memory of the "
+		"module since it was loaded, as a struct with the fields 'Allocations', "
+		"'BytesRequested', 'ArenaAllocations' for small buffers from the arena, "
+		"'PoolHits' for reuse of released buffers, 'SystemAllocations' of memory from "
+		"the operating system, 'Frees' of individual buffers, 'BytesInUse', "
+		"'PeakBytesInUse', 'BytesPooled' for reuse and 'ArenaBytes'. On Matlab, "
+		"which manages temporary memory itself, only 'Allocations', 'BytesRequested' "
+		"and 'SystemAllocations' are meaningful.\n";
+	static char seeAlsoString[] = "";
+
+	static const char *FieldNames[] = { "Name", "Calls", "TotalTime", "MinTime", "MaxTime", "MeanTime", "BodyTime", "MarshallingTime", "TempBytes", "Histogram" };
+	static const char *MemFieldNames[] = { "Allocations", "BytesRequested", "ArenaAllocations", "PoolHits", "SystemAllocations", "Frees", "BytesInUse", "PeakBytesInUse", "BytesPooled", "ArenaBytes" };
+	PsychGenericScriptType	*profile, *histogram;
+	PsychTempMemoryStats	memStats;
+	PsychProfileEntry		*entry;
+	double					*bins;
+	char					*command;
+	int						i, count;
+
+	//all subfunctions should have these two lines.
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+	PsychErrorExit(PsychCapNumInputArgs(1));
+	PsychErrorExit(PsychRequireNumInputArgs(1));
+	PsychErrorExit(PsychCapNumOutputArgs(1));
+
+	PsychAllocInCharArg(1, kPsychArgRequired, &command);
+
+	if (PsychMatch(command, "Start")) {
+		psychProfilingEnabled = TRUE;
+	}
+	else if (PsychMatch(command, "Stop")) {
+		psychProfilingEnabled = FALSE;
+	}
+	else if (PsychMatch(command, "Reset")) {
+		memset(profileEntries, 0, sizeof(profileEntries));
+	}
+	else if (PsychMatch(command, "Get")) {
+		for (i = 0, count = 0; i <= PSYCH_MAX_FUNCTIONS; i++) if (profileEntries[i].calls > 0) count++;
+
+		PsychAllocOutStructArray(1, kPsychArgOptional, count, 10, FieldNames, &profile);
+		for (i = 0, count = 0; i <= PSYCH_MAX_FUNCTIONS; i++) {
+			entry = &profileEntries[i];
+			if (entry->calls == 0) continue;
+
+			PsychSetStructArrayStringElement("Name", count, (i < PSYCH_MAX_FUNCTIONS) ? PsychGetFunctionNameByIndex(i) : PsychGetModuleName(), profile);
+			PsychSetStructArrayDoubleElement("Calls", count, entry->calls, profile);
+			PsychSetStructArrayDoubleElement("TotalTime", count, entry->totalTime, profile);
+			PsychSetStructArrayDoubleElement("MinTime", count, entry->minTime, profile);
+			PsychSetStructArrayDoubleElement("MaxTime", count, entry->maxTime, profile);
+			PsychSetStructArrayDoubleElement("MeanTime", count, entry->totalTime / entry->calls, profile);
+			PsychSetStructArrayDoubleElement("BodyTime", count, entry->bodyTime, profile);
+			PsychSetStructArrayDoubleElement("MarshallingTime", count, entry->totalTime - entry->bodyTime, profile);
+			PsychSetStructArrayDoubleElement("TempBytes", count, entry->tempBytes, profile);
+
+			bins = &entry->histogram[0];
+			PsychAllocateNativeDoubleMat(1, PSYCH_PROFILE_HISTOGRAM_BINS, 1, &bins, &histogram);
+			PsychSetStructArrayNativeElement("Histogram", count, histogram, profile);
+			count++;
+		}
+	}
+	else if (PsychMatch(command, "TempMemory")) {
+		PsychGetTempMemoryStats(&memStats);
+
+		PsychAllocOutStructArray(1, kPsychArgOptional, 1, 10, MemFieldNames, &profile);
+		PsychSetStructArrayDoubleElement("Allocations", 0, (double) memStats.allocations, profile);
+		PsychSetStructArrayDoubleElement("BytesRequested", 0, (double) memStats.bytesRequested, profile);
+		PsychSetStructArrayDoubleElement("ArenaAllocations", 0, (double) memStats.arenaAllocations, profile);
+		PsychSetStructArrayDoubleElement("PoolHits", 0, (double) memStats.poolHits, profile);
+		PsychSetStructArrayDoubleElement("SystemAllocations", 0, (double) memStats.systemAllocations, profile);
+		PsychSetStructArrayDoubleElement("Frees", 0, (double) memStats.frees, profile);
+		PsychSetStructArrayDoubleElement("BytesInUse", 0, (double) memStats.bytesInUse, profile);
+		PsychSetStructArrayDoubleElement("PeakBytesInUse", 0, (double) memStats.peakBytesInUse, profile);
+		PsychSetStructArrayDoubleElement("BytesPooled", 0, (double) memStats.bytesPooled, profile);
+		PsychSetStructArrayDoubleElement("ArenaBytes", 0, (double) memStats.arenaBytes, profile);
+	}
+	else PsychErrorExitMsg(PsychError_user, "Unknown 'command' provided. Must be 'Start', 'Stop', 'Reset', 'Get' or 'TempMemory'.");
+
+	return(PsychError_none);
+}
@@ -22,6 +22,16 @@
 void	PsychPushClock(void);
 double  PsychPopClock(void);
 
+// Per-subfunction profiling of calls into the module, controlled via Modulename('Profile').
+// The scripting glue calls the probe functions only if psychProfilingEnabled is set:
+extern psych_bool psychProfilingEnabled;
+
+void	PsychProfileCallBegin(int level);
+void	PsychProfileBodyBegin(int level);
+void	PsychProfileBodyEnd(int level);
+void	PsychProfileCallEnd(int level);
+PsychError PsychProfileModuleFunction(void);
+
 
 
 
@@ -16,12 +16,37 @@
   
   DESCRIPTION:
 
-  TO DO: 
+  Allocator for temporary memory, which is valid until control returns to the runtime.
+
+  On Matlab we use Matlab's memory manager. Otherwise we use our own: Small buffers
+  get carved out of a chunked arena by bumping a pointer. Bigger buffers come from
+  free lists of size classes, four per power of two, and go back to them when freed.
+  At the end of each call into the module, all buffers are released into the arena
+  and the free lists, so steady state calls don't allocate any memory from the system.
+  What is kept for reuse is capped at 16 MB in the free lists, for buffers of up to
+  4 MB each, plus 1 MB of arena, as each module has its own allocator and keeps it
+  for the whole session. Bigger buffers are rare, and for them the cost of getting
+  fresh pages from the system dominates the cost of the allocation anyway.
   
 */
 
 #include "Psych.h"
 
+// Allocation statistics, for diagnostics and profiling:
+static PsychTempMemoryStats tempMemStats;
+
+// Return total count of Bytes requested via PsychMallocTemp() and PsychCallocTemp() since the module was loaded:
+psych_uint64 PsychGetTempMemoryRequested(void)
+{
+  return(tempMemStats.bytesRequested);
+}
+
+// Return allocation statistics of the temporary memory allocator in 'stats':
+void PsychGetTempMemoryStats(PsychTempMemoryStats* stats)
+{
+  *stats = tempMemStats;
+}
+
 // Convert a double value (which encodes a memory address) into a ptr:
 void*  PsychDoubleToPtr(volatile double dptr)
 {
@@ -46,6 +71,9 @@ void *PsychCallocTemp(size_t n, size_t size)
 {
   void *ret;
   
+  tempMemStats.allocations++;
+  tempMemStats.systemAllocations++;
+  tempMemStats.bytesRequested += n * size;
   if(NULL==(ret=mxCalloc(n, size))){
     if(size * n != 0)
       PsychErrorExitMsg(PsychError_outofMemory, NULL);
@@ -57,6 +85,9 @@ void *PsychMallocTemp(size_t n)
 {
   void *ret;
   
+  tempMemStats.allocations++;
+  tempMemStats.systemAllocations++;
+  tempMemStats.bytesRequested += n;
   if(NULL==(ret=mxMalloc(n))){
     if(n!=0)
       PsychErrorExitMsg(PsychError_outofMemory,NULL);
@@ -68,178 +99,306 @@ void *PsychMallocTemp(size_t n)
 
 // If not running on Matlab, we use our own allocator...
 
-#define PTBTEMPMEMDEC(n) totalTempMemAllocated -=(n)
+// Header in front of each buffer:
+typedef struct PsychTempMemHeader {
+  struct PsychTempMemHeader* prev;  // Previous buffer in list of pooled buffers in use, or free list.
+  struct PsychTempMemHeader* next;  // Next buffer in list of pooled buffers in use, or free list.
+  size_t size;                      // Usable size of buffer after the header.
+  int sizeClass;                    // Index of size class, or kPsychTempMemArena or kPsychTempMemUnpooled.
+} PsychTempMemHeader;
+
+// Chunk of the arena for small buffers. Buffers follow the chunk header:
+typedef struct PsychTempMemChunk {
+  struct PsychTempMemChunk* next;   // Next chunk of arena.
+  size_t used;                      // Bytes used by buffers.
+} PsychTempMemChunk;
+
+#define kPsychTempMemArena          -1
+#define kPsychTempMemUnpooled       -2
+
+// Buffers up to this size come from the arena, bigger ones from the size classes:
+#define kPsychTempMemArenaMaxSize   1024
+#define kPsychTempMemChunkSize      (64 * 1024)
+// Chunks beyond this count are released to the system at end of a call:
+#define kPsychTempMemMaxChunks      16
+
+// Four size classes per power of two from 2^10 upwards:
+#define kPsychTempMemMinClassLog2   10
+#define kPsychTempMemNumClasses     (4 * (8 * (int) sizeof(size_t) - kPsychTempMemMinClassLog2))
+// Maximum Bytes kept in the free lists. Buffers beyond this get released to the system:
+#define kPsychTempMemMaxPooled      ((size_t) 16 * 1024 * 1024)
+// Maximum size of a single buffer kept in the free lists:
+#define kPsychTempMemMaxPooledSize  ((size_t) 4 * 1024 * 1024)
+
+// Alignment of buffers:
+#define PsychTempMemAlign(n) (((n) + 15) & ~((size_t) 15))
+
+// Doubly linked list of pooled buffers in use:
+static PsychTempMemHeader* PsychTempMemHead = NULL;
+// Free lists of released buffers, per size class:
+static PsychTempMemHeader* tempMemFreeLists[kPsychTempMemNumClasses];
+// Chunks of arena, and chunk which is currently used for new buffers:
+static PsychTempMemChunk* tempMemChunks = NULL;
+static PsychTempMemChunk* tempMemCurrentChunk = NULL;
+
+// Return size class of buffers of 'n' Bytes, and its size in 'classSize':
+static int PsychTempMemSizeClass(size_t n, size_t* classSize)
+{
+  int e = kPsychTempMemMinClassLog2;
+  size_t k;
+
+  while ((e < 8 * (int) sizeof(size_t) - 1) && ((((size_t) 1) << (e + 1)) <= n)) e++;
+
+  // Round up to next quarter of the power of two:
+  k = ((n - (((size_t) 1) << e)) + (((size_t) 1) << (e - 2)) - 1) >> (e - 2);
+  if (k == 4) {
+    e++;
+    k = 0;
+  }
+
+  *classSize = (((size_t) 1) << e) + k * (((size_t) 1) << (e - 2));
+  return(4 * (e - kPsychTempMemMinClassLog2) + (int) k);
+}
+
+// Return buffer of 'n' Bytes from the arena:
+static PsychTempMemHeader* PsychTempMemArenaAlloc(size_t n)
+{
+  size_t total = PsychTempMemAlign(sizeof(PsychTempMemHeader) + n);
+  PsychTempMemChunk* chunk;
+  PsychTempMemHeader* hdr;
+
+  if (tempMemCurrentChunk == NULL) tempMemCurrentChunk = tempMemChunks;
+
+  // Find chunk with enough space, starting with the current one. Chunks after
+  // the current one are unused, as chunks get filled in order:
+  while (tempMemCurrentChunk && (tempMemCurrentChunk->used + total > kPsychTempMemChunkSize)) {
+    if (tempMemCurrentChunk->next == NULL) break;
+    tempMemCurrentChunk = tempMemCurrentChunk->next;
+  }
+
+  if ((tempMemCurrentChunk == NULL) || (tempMemCurrentChunk->used + total > kPsychTempMemChunkSize)) {
+    // Need a new chunk, appended at the end of the list:
+    if (NULL == (chunk = (PsychTempMemChunk*) malloc(PsychTempMemAlign(sizeof(PsychTempMemChunk)) + kPsychTempMemChunkSize))) return(NULL);
+    chunk->next = NULL;
+    chunk->used = 0;
+    tempMemStats.systemAllocations++;
+    tempMemStats.arenaBytes += kPsychTempMemChunkSize;
+
+    if (tempMemCurrentChunk) tempMemCurrentChunk->next = chunk; else tempMemChunks = chunk;
+    tempMemCurrentChunk = chunk;
+  }
+
+  chunk = tempMemCurrentChunk;
+  hdr = (PsychTempMemHeader*) ((char*) chunk + PsychTempMemAlign(sizeof(PsychTempMemChunk)) + chunk->used);
+  chunk->used += total;
+
+  hdr->prev = hdr->next = NULL;
+  hdr->size = total - sizeof(PsychTempMemHeader);
+  hdr->sizeClass = kPsychTempMemArena;
+  tempMemStats.arenaAllocations++;
+
+  return(hdr);
+}
+
+// Return buffer of 'n' Bytes from the free list of its size class, or from the system:
+static PsychTempMemHeader* PsychTempMemPoolAlloc(size_t n)
+{
+  PsychTempMemHeader* hdr;
+  size_t classSize;
+  int sizeClass;
+
+  sizeClass = PsychTempMemSizeClass(n, &classSize);
+  if (classSize > kPsychTempMemMaxPooledSize) {
+    // Too big for pooling:
+    if (NULL == (hdr = (PsychTempMemHeader*) malloc(sizeof(PsychTempMemHeader) + n))) return(NULL);
+    hdr->size = n;
+    hdr->sizeClass = kPsychTempMemUnpooled;
+    tempMemStats.systemAllocations++;
+  }
+  else if ((hdr = tempMemFreeLists[sizeClass])) {
+    // Reuse released buffer:
+    tempMemFreeLists[sizeClass] = hdr->next;
+    tempMemStats.bytesPooled -= hdr->size;
+    tempMemStats.poolHits++;
+  }
+  else {
+    if (NULL == (hdr = (PsychTempMemHeader*) malloc(sizeof(PsychTempMemHeader) + classSize))) return(NULL);
+    hdr->size = classSize;
+    hdr->sizeClass = sizeClass;
+    tempMemStats.systemAllocations++;
+  }
+
+  // Enqueue into list of buffers in use:
+  hdr->prev = NULL;
+  hdr->next = PsychTempMemHead;
+  if (PsychTempMemHead) PsychTempMemHead->prev = hdr;
+  PsychTempMemHead = hdr;
+
+  tempMemStats.bytesInUse += hdr->size;
+  if (tempMemStats.bytesInUse > tempMemStats.peakBytesInUse) tempMemStats.peakBytesInUse = tempMemStats.bytesInUse;
 
-// Enqueues a new record into our linked list of temp. memory buffers.
-// Returns the memory pointer to be passed to rest of Psychtoolbox.
-void* PsychEnqueueTempMemory(void* p, size_t n)
+  return(hdr);
+}
+
+// Put released buffer 'hdr' of the size classes into its free list, or back to the system:
+static void PsychTempMemPoolRelease(PsychTempMemHeader* hdr)
 {
-  // Add current buffer-head ptr as next-pointer to our new buffer:
-  *((size_t*) p) = (size_t) PsychTempMemHead;
+  tempMemStats.bytesInUse -= hdr->size;
+
+  if ((hdr->sizeClass == kPsychTempMemUnpooled) || (tempMemStats.bytesPooled + hdr->size > kPsychTempMemMaxPooled)) {
+    free(hdr);
+    return;
+  }
 
-  // Set our buffer as new head of list:
-  PsychTempMemHead = p;
+  hdr->next = tempMemFreeLists[hdr->sizeClass];
+  tempMemFreeLists[hdr->sizeClass] = hdr;
+  tempMemStats.bytesPooled += hdr->size;
+}
 
-  // Add allocated buffer size as 2nd element:
-  p = p + sizeof(PsychTempMemHead);
-  *((size_t*) p) = n;
+// Allocate temporary buffer of 'n' Bytes:
+static void* PsychTempMemAlloc(size_t n)
+{
+  PsychTempMemHeader* hdr;
 
-  // Accounting:
-  totalTempMemAllocated += n;
-  // printf("TEMPMALLOCED %i Bytes,  new = %i.\n", n, totalTempMemAllocated); fflush(NULL);
+  tempMemStats.allocations++;
+  tempMemStats.bytesRequested += n;
 
-  // Increment p again to get real start of user-visible buffer:
-  p = p + sizeof(n);
+  hdr = (n <= kPsychTempMemArenaMaxSize) ? PsychTempMemArenaAlloc(n) : PsychTempMemPoolAlloc(n);
+  if (hdr == NULL) PsychErrorExitMsg(PsychError_outofMemory, NULL);
 
-  // Return ptr:
-  return(p);
+  // Start of user-visible buffer after the header:
+  return((void*) (hdr + 1));
 }
 
 void *PsychCallocTemp(size_t n, size_t size)
 {
   void *ret;
+
   // MK: This could create an overflow if product n * size is
   // bigger than length of a unsigned long int --> Only
   // happens if more than 4 GB of RAM are allocated at once.
   // --> Improbable for PTB, unless someones trying a buffer
   // overflow attack -- PTB would lose there badly anyway...
-  size_t realsize = n * size + sizeof(void*) + sizeof(realsize);
+  ret = PsychTempMemAlloc(n * size);
 
-  // realsize has extra bytes allocated for our little header...  
-  if(NULL==(ret=calloc((size_t) 1, realsize))) {
-    PsychErrorExitMsg(PsychError_outofMemory, NULL);
-  }
-
-  // Need to enqueue memory buffer...
-  return(PsychEnqueueTempMemory(ret, realsize));
+  // Reused buffers are not zero-filled, so always clear:
+  memset(ret, 0, n * size);
+  return(ret);
 }
 
 void *PsychMallocTemp(size_t n)
 {
-  void *ret;
-
-  // Allocate some extra bytes for our little header...
-  n = n + sizeof(void*) + sizeof(n);
-  if(NULL==(ret=malloc(n))){
-    PsychErrorExitMsg(PsychError_outofMemory,NULL);
-  }
+  return(PsychTempMemAlloc(n));
+}
 
-  // Need to enqueue memory buffer...
-  return(PsychEnqueueTempMemory(ret, n));
-}
-
-// Free a single spec'd temp memory buffer.
-// TODO Note: The current implementation of our allocator
-// uses a single-linked list, which has O(1) cost for
-// allocating memory (Optimal!) and O(n) cost for freeing
-// all allocated memory (Optimal!), but it has up to
-// O(n) cost for deleting a single memory buffer as well,
-// be n the total number of allocated buffers. This is
-// worst-case upper bound. If PsychFreeTemp() is used a
-// lot on long buffer lists, this will incur significant
-// overhead! A better implementation would use a double-
-// linked list or even a binary tree or hash structure,
-// but for now this has to be good enough(TM).
+// Free a single spec'd temp memory buffer. This is O(1), as pooled
+// buffers are in a doubly linked list. Arena buffers only give back
+// their memory if they are the most recently allocated buffer,
+// otherwise it gets reclaimed at the end of the call:
 void PsychFreeTemp(void* ptr)
 {
-  void* ptrbackup = ptr;
-  size_t* psize = NULL;
-  size_t* next = PsychTempMemHead;
-  size_t* prevptr = NULL;
+  PsychTempMemHeader* hdr;
+  size_t total;
 
   if (ptr == NULL) return;
- 
+
   // Convert ptb supplied pointer ptr into real start
   // of our buffer, including our header:
-  ptr = ptr - sizeof(ptr) - sizeof(size_t);
-  if (ptr == NULL) return;
-
-  if (PsychTempMemHead == ptr) {
-    // Special case: ptr is first buffer in queue. Dequeue:
-    PsychTempMemHead = (size_t*) *PsychTempMemHead;
+  hdr = ((PsychTempMemHeader*) ptr) - 1;
+  tempMemStats.frees++;
 
-    // Some accounting:
-    PTBTEMPMEMDEC(((size_t*)ptr)[1]);
-
-    // Release it:
-    free(ptr);
+  if (hdr->sizeClass == kPsychTempMemArena) {
+    total = sizeof(PsychTempMemHeader) + hdr->size;
+    if (tempMemCurrentChunk && ((char*) hdr + total == (char*) tempMemCurrentChunk + PsychTempMemAlign(sizeof(PsychTempMemChunk)) + tempMemCurrentChunk->used)) {
+      tempMemCurrentChunk->used -= total;
+    }
 
     return;
   }
 
-  // ptr valid and not first buffer in queue.
-  // Walk the whole buffer list until we encounter our buffer:
-  while (next != NULL && next!=ptr) {
-    prevptr = next;
-    next = (size_t*) *next;
-  }
-
-  // Done with search loop. Did we find our buffer?
-  if (next == ptr) {
-    // Found it! Set next-ptr of previous buffer to next-ptr
-    // of this buffer to dequeue from list:
-    *prevptr = *next;
-
-    // Some accounting:
-    PTBTEMPMEMDEC(next[1]);
-    
-    // Release:
-    free(ptr);
+  // Dequeue from list of buffers in use:
+  if (hdr->prev) hdr->prev->next = hdr->next; else PsychTempMemHead = hdr->next;
+  if (hdr->next) hdr->next->prev = hdr->prev;
 
-    // Done.
-    return;
-  }
-
-  // Oops.: Did not find matching buffer to pointer --> Trouble!
-  printf("PTB-BUG: In PsychFreeTemp: Tried to free non-existent temporary membuffer %p!!! Ignored.\n", ptrbackup);
-  fflush(NULL);
+  PsychTempMemPoolRelease(hdr);
   return;
 }
 
-// Master cleanup routine: Frees all allocated memory:
+// Master cleanup routine: Frees all allocated memory, keeping it for reuse by future calls:
 void PsychFreeAllTempMemory(void)
 {
-  size_t* p = NULL;
-  size_t* psize = NULL;
-  size_t* next = PsychTempMemHead;
+  PsychTempMemHeader* p = NULL;
+  PsychTempMemHeader* next = PsychTempMemHead;
+  PsychTempMemChunk* chunk;
+  PsychTempMemChunk* last = NULL;
+  int count = 0;
 
   // Walk our whole buffer list and release all buffers on it:
   while (next != NULL) {
-    // next points to current buffer to release. Make a copy of
-    // next:
     p = next;
-
-    // Update next to point to the next buffer to release:
-    next = (size_t*) *p;
-
-    // Some accounting:
-    PTBTEMPMEMDEC(p[1]);
-
-    // Release buffer p:
-    free(p);
-    
-    // We're done with this buffer, next points to next one to release
-    // or is NULL if all released...
+    next = p->next;
+    PsychTempMemPoolRelease(p);
   }
 
   // Done. NULL-out the list start ptr:
   PsychTempMemHead = NULL;
 
+  // Reset the arena, releasing excess chunks:
+  for (chunk = tempMemChunks; chunk; chunk = (last) ? last->next : tempMemChunks) {
+    if (++count > kPsychTempMemMaxChunks) {
+      last->next = chunk->next;
+      free(chunk);
+      tempMemStats.arenaBytes -= kPsychTempMemChunkSize;
+      continue;
+    }
+
+    chunk->used = 0;
+    last = chunk;
+  }
+
+  tempMemCurrentChunk = tempMemChunks;
+
   // Sanity check:
-  if (totalTempMemAllocated != 0) {
+  if (tempMemStats.bytesInUse != 0) {
     // Cannot use PsychErrorXXX Routines here, because this is outside
     // the jumpbuffer context for our error-routines. Could lead to
     // infinite recursion!!!
     printf("PTB-CRITICAL BUG: Inconsistency detected in temporary memory allocator!\n");
-    printf("PTB-CRITICAL BUG: totalTempMemAllocated = %i after PsychFreeAllTempMemory()!!!!\n",
-	   totalTempMemAllocated);
+    printf("PTB-CRITICAL BUG: bytesInUse = %lu after PsychFreeAllTempMemory()!!!!\n", (unsigned long) tempMemStats.bytesInUse);
     fflush(NULL);
 
     // Reset to defined state.
-    totalTempMemAllocated = 0;
+    tempMemStats.bytesInUse = 0;
   }
 
   return;
 }
 
+// Release all memory kept for reuse back to the system. Called at module shutdown,
+// after PsychFreeAllTempMemory():
+void PsychReleaseTempMemoryPool(void)
+{
+  PsychTempMemHeader* hdr;
+  PsychTempMemChunk* chunk;
+  int i;
+
+  for (i = 0; i < kPsychTempMemNumClasses; i++) {
+    while ((hdr = tempMemFreeLists[i])) {
+      tempMemFreeLists[i] = hdr->next;
+      free(hdr);
+    }
+  }
+
+  while ((chunk = tempMemChunks)) {
+    tempMemChunks = chunk->next;
+    free(chunk);
+  }
+
+  tempMemCurrentChunk = NULL;
+  tempMemStats.bytesPooled = 0;
+  tempMemStats.arenaBytes = 0;
+
+  return;
+}
+
 #endif
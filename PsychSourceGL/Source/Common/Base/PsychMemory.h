@@ -35,6 +35,26 @@ double PsychPtrToDouble(void* ptr);
 void *PsychCallocTemp(size_t n, size_t size);
 void *PsychMallocTemp(size_t n);
 
+// Allocation statistics of temporary memory since the module was loaded:
+typedef struct PsychTempMemoryStats {
+	psych_uint64	allocations;		// Number of buffers allocated.
+	psych_uint64	bytesRequested;		// Total Bytes requested.
+	psych_uint64	arenaAllocations;	// Buffers carved out of the arena for small buffers.
+	psych_uint64	poolHits;			// Buffers served by reuse of a released buffer.
+	psych_uint64	systemAllocations;	// Allocations of memory from the system.
+	psych_uint64	frees;				// Buffers freed individually via PsychFreeTemp().
+	size_t			bytesInUse;			// Bytes in buffers currently in use, excluding the arena.
+	size_t			peakBytesInUse;		// Maximum of bytesInUse.
+	size_t			bytesPooled;		// Bytes in released buffers kept for reuse.
+	size_t			arenaBytes;			// Bytes in chunks of the arena.
+} PsychTempMemoryStats;
+
+// Return total count of Bytes requested via PsychMallocTemp() and PsychCallocTemp() since the module was loaded:
+psych_uint64 PsychGetTempMemoryRequested(void);
+
+// Return allocation statistics of the temporary memory allocator in 'stats':
+void PsychGetTempMemoryStats(PsychTempMemoryStats* stats);
+
 //free memory
 #if PSYCH_LANGUAGE == PSYCH_MATLAB
 	#define PsychFreeTemp 			mxFree
@@ -47,13 +67,11 @@ void *PsychMallocTemp(size_t n);
 // the memory anyway when returning control to Matlab/Octave et al.
 void PsychFreeTemp(void* ptr);
 
-// Master cleanup routine: Frees all allocated memory.
+// Master cleanup routine: Frees all allocated memory, keeping it for reuse by future calls.
 void PsychFreeAllTempMemory(void);
 
-// Pointer to the start of our list of allocated temporary memory buffers:
-static size_t* PsychTempMemHead = NULL;
-// Total count of allocated memory in Bytes:
-static size_t totalTempMemAllocated = 0;
+// Release all memory kept for reuse back to the system, at module shutdown.
+void PsychReleaseTempMemoryPool(void);
 
 #endif
 
@@ -15,6 +15,14 @@
 */
 
 #include "Psych.h"
+#include <ctype.h>
+
+// Size of the hash table for lookup of subfunctions by name. Power of two, and
+// four times the maximum number of subfunctions, to keep probe sequences short:
+#define PSYCH_FUNCTION_HASH_SIZE (4 * PSYCH_MAX_FUNCTIONS)
+
+// Number of hash seeds to try when optimizing the hash table for the registered names:
+#define PSYCH_FUNCTION_HASH_SEEDS 64
 
 //file static variable definitions
 static PsychFunctionPtr exitFunctionREGISTER = NULL;
@@ -22,11 +30,23 @@ static PsychFunctionPtr baseFunctionREGISTER = NULL;
 static PsychFunctionTableEntry functionTableREGISTER[PSYCH_MAX_FUNCTIONS];
 static char ModuleNameREGISTER[PSYCH_MAX_FUNCTION_NAME_LENGTH+1]; //+1 for term null
 static char *currentFunctionNameREGISTER;
+static int currentFunctionIndexREGISTER = -1;
 static int numFunctionsREGISTER=0;
 
+// Hash table of indices+1 into functionTableREGISTER, zero for empty slots. Linear probing:
+static unsigned short functionHashREGISTER[PSYCH_FUNCTION_HASH_SIZE];
+static unsigned int functionHashSeedREGISTER = 0;
+static psych_bool functionHashOptimizedREGISTER = FALSE;
+
+// Index of the last found subfunction, checked before the hash table, as scripts often call the same subfunction repeatedly:
+static int lastFunctionREGISTER = -1;
+
 //file static function declarations
 static PsychError PsychRegisterModuleName(char *name);
 static PsychError PsychRegisterBase(PsychFunctionPtr baseFunc);
+static unsigned int PsychHashFunctionName(const char *name, unsigned int seed);
+static int PsychInsertFunctionHash(int index, unsigned int seed);
+static void PsychOptimizeFunctionHash(void);
 
 
 /*  This function is called by the special subfunction 'DescribeModuleFunctionsHelper'.
@@ -84,6 +104,24 @@ PsychError PsychDescribeModuleFunctions(void)
     return(PsychError_none);
 }
 
+/*  This function is called by the special subfunction 'NullCallHelper'.
+ *  It does nothing, so the time for calling it is the fixed overhead of
+ *  each call into a module, e.g., for measuring the cost of subfunction
+ *  dispatch, as done by PsychTests/DispatchOverheadBenchmark.m
+ */
+PsychError PsychNullModuleFunction(void)
+{
+	static char useString[] = "Modulename('NullCallHelper');";
+	static char synopsisString[] = "Do nothing. Used to measure the fixed overhead of each call into a module.";
+	static char seeAlsoString[] = "";
+
+	//all subfunctions should have these two lines.
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+	return(PsychError_none);
+}
+
 /*
 	This function is called by the project to register project functions.
 	
@@ -118,18 +156,23 @@ PsychError PsychRegister(char *name,  PsychFunctionPtr func)
 	if(numFunctionsREGISTER == PSYCH_MAX_FUNCTIONS)
 		return(PsychError_registerLimit);
 		
-	//check to see if the name has already been registered
-	for(i=0;i<PSYCH_MAX_FUNCTIONS;i++){
-		if(strcmp(name, functionTableREGISTER[i].name)==0)
+	//check to see if the name has already been registered, by walking its probe sequence in the hash table
+	for(i = PsychHashFunctionName(name, functionHashSeedREGISTER); functionHashREGISTER[i]; i = (i + 1) & (PSYCH_FUNCTION_HASH_SIZE - 1)){
+		if(strcmp(name, functionTableREGISTER[functionHashREGISTER[i] - 1].name)==0)
 			return(PsychError_registered);
 	}
 	
 	//register the function and enable the subfunction dispatcher
-	functionTableREGISTER[numFunctionsREGISTER].function = func;
 	if(strlen(name) > PSYCH_MAX_FUNCTION_NAME_LENGTH)
 		return(PsychError_longString);
+	functionTableREGISTER[numFunctionsREGISTER].function = func;
 	strcpy(functionTableREGISTER[numFunctionsREGISTER].name, name);
+	PsychInsertFunctionHash(numFunctionsREGISTER, functionHashSeedREGISTER);
 	++numFunctionsREGISTER;
+
+	// Table needs to be optimized again for the new set of names at next lookup:
+	functionHashOptimizedREGISTER = FALSE;
+
 	PsychEnableSubfunctions();
 	return(PsychError_none);
 }
@@ -152,25 +195,43 @@ PsychError PsychRegisterExit(PsychFunctionPtr exitFunc)
 */
 PsychFunctionPtr PsychGetProjectFunction(char *command)
 {
-	int i; 
+	size_t len;
+	int i, index;
 
 	//return the project base function
 	if(command==NULL){
 		currentFunctionNameREGISTER = NULL;
+		currentFunctionIndexREGISTER = -1;
 		return(baseFunctionREGISTER);
 	}
 	// See if help is being requested
-	if (command[strlen(command)-1] == '?') {
+	len = strlen(command);
+	if ((len > 0) && (command[len-1] == '?')) {
 		PsychSetGiveHelp();
-		command[strlen(command)-1]=0;
+		command[len-1]=0;
 	}else
 		PsychClearGiveHelp();
 	
-	//lookup the function in the table
-	for(i=0;i<numFunctionsREGISTER;i++){
-		if(PsychMatch(functionTableREGISTER[i].name, command)){
-			currentFunctionNameREGISTER = functionTableREGISTER[i].name;
-			return(functionTableREGISTER[i].function);
+	// Same subfunction as in the last call?
+	if((lastFunctionREGISTER >= 0) && PsychMatch(functionTableREGISTER[lastFunctionREGISTER].name, command)){
+		currentFunctionNameREGISTER = functionTableREGISTER[lastFunctionREGISTER].name;
+		currentFunctionIndexREGISTER = lastFunctionREGISTER;
+		return(functionTableREGISTER[lastFunctionREGISTER].function);
+	}
+
+	// Pick best hash seed for the registered names, once after registration:
+	if(!functionHashOptimizedREGISTER)
+		PsychOptimizeFunctionHash();
+
+	//lookup the function in the hash table. Names hash case-insensitive, so this works for
+	//case-sensitive and case-insensitive matching. Probing visits names in order of registration:
+	for(i = PsychHashFunctionName(command, functionHashSeedREGISTER); functionHashREGISTER[i]; i = (i + 1) & (PSYCH_FUNCTION_HASH_SIZE - 1)){
+		index = functionHashREGISTER[i] - 1;
+		if(PsychMatch(functionTableREGISTER[index].name, command)){
+			lastFunctionREGISTER = index;
+			currentFunctionNameREGISTER = functionTableREGISTER[index].name;
+			currentFunctionIndexREGISTER = index;
+			return(functionTableREGISTER[index].function);
 		}
 	}
 
@@ -190,6 +251,18 @@ char *PsychGetFunctionName(void)
 		return(currentFunctionNameREGISTER);
 }
 
+// Return index of the current subfunction in the function table, or -1 for the base function:
+int PsychGetFunctionIndex(void)
+{
+	return((currentFunctionNameREGISTER) ? currentFunctionIndexREGISTER : -1);
+}
+
+// Return name of the subfunction with function table index 'index', or NULL if there is none:
+char *PsychGetFunctionNameByIndex(int index)
+{
+	return(((index >= 0) && (index < numFunctionsREGISTER)) ? functionTableREGISTER[index].name : NULL);
+}
+
 //for use by projects
 char *PsychGetModuleName(void)
 {
@@ -242,3 +315,71 @@ static PsychError PsychRegisterBase(PsychFunctionPtr baseFunc)
 		
 	return(PsychError_none);
 }
+
+/*
+	Case-insensitive FNV-1a hash of a subfunction name, mixed with 'seed',
+	reduced to a start slot in the hash table.
+*/
+static unsigned int PsychHashFunctionName(const char *name, unsigned int seed)
+{
+	unsigned int hash = 2166136261U ^ seed;
+
+	while(*name){
+		hash ^= (unsigned int) tolower((unsigned char) *name++);
+		hash *= 16777619U;
+	}
+
+	// Fold upper bits in, as the table index only uses the lowest bits:
+	hash ^= hash >> 15;
+	return(hash & (PSYCH_FUNCTION_HASH_SIZE - 1));
+}
+
+/*
+	Insert subfunction 'index' into the hash table for hash 'seed', returns
+	the length of its probe sequence.
+*/
+static int PsychInsertFunctionHash(int index, unsigned int seed)
+{
+	unsigned int i;
+	int probes = 1;
+
+	for(i = PsychHashFunctionName(functionTableREGISTER[index].name, seed); functionHashREGISTER[i]; i = (i + 1) & (PSYCH_FUNCTION_HASH_SIZE - 1))
+		probes++;
+
+	functionHashREGISTER[i] = (unsigned short) (index + 1);
+	return(probes);
+}
+
+/*
+	Rebuild the hash table with the seed which gives the shortest worst case
+	probe sequence for the set of registered names. A perfect hash, where each
+	name is found at its first probe, ends the search early. Names get inserted
+	in order of registration, so if names only differ in case, the first
+	registered one is found first, as with the linear search of old.
+*/
+static void PsychOptimizeFunctionHash(void)
+{
+	unsigned int seed, bestSeed = 0;
+	int i, probes, maxProbes, bestProbes = PSYCH_MAX_FUNCTIONS + 1;
+
+	for(seed = 0; (seed < PSYCH_FUNCTION_HASH_SEEDS) && (bestProbes > 1); seed++){
+		memset(functionHashREGISTER, 0, sizeof(functionHashREGISTER));
+		for(i = 0, maxProbes = 0; i < numFunctionsREGISTER; i++){
+			probes = PsychInsertFunctionHash(i, seed);
+			if(probes > maxProbes)
+				maxProbes = probes;
+		}
+
+		if(maxProbes < bestProbes){
+			bestProbes = maxProbes;
+			bestSeed = seed;
+		}
+	}
+
+	memset(functionHashREGISTER, 0, sizeof(functionHashREGISTER));
+	for(i = 0; i < numFunctionsREGISTER; i++)
+		PsychInsertFunctionHash(i, bestSeed);
+
+	functionHashSeedREGISTER = bestSeed;
+	functionHashOptimizedREGISTER = TRUE;
+}
@@ -31,10 +31,13 @@ typedef struct
 } PsychFunctionTableEntry;
 	
 PsychError PsychDescribeModuleFunctions(void);
+PsychError PsychNullModuleFunction(void);
 PsychError PsychRegister(char *name,  PsychFunctionPtr func);
 PsychError PsychRegisterExit(PsychFunctionPtr exitFunc);
 PsychFunctionPtr PsychGetProjectFunction(char *command);
 char *PsychGetFunctionName(void);
+int PsychGetFunctionIndex(void);
+char *PsychGetFunctionNameByIndex(int index);
 char *PsychGetModuleName(void);
 char *PsychGetBuildDate(void);
 char *PsychGetBuildTime(void);
@@ -635,6 +635,17 @@ extern "C" void ScreenCloseAllWindows(void);
 void ScreenCloseAllWindows(void);
 #endif
 
+// Invoke subfunction or base function 'fcn', with per-subfunction profiling if enabled:
+static void PsychInvokeSubfunction(PsychFunctionPtr fcn)
+{
+    if (psychProfilingEnabled) {
+        PsychProfileBodyBegin(recLevel);
+        (*fcn)();
+        PsychProfileBodyEnd(recLevel);
+    }
+    else (*fcn)();
+}
+
 void PsychExitRecursion(void)
 {
     if (recLevel < 0) {
@@ -765,6 +776,13 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		// generator script to find out about subfunctions of a module:
 		PsychRegister((char*) "DescribeModuleFunctionsHelper",  &PsychDescribeModuleFunctions);
 
+		// Register hidden helper function which does nothing, for measuring the overhead of
+		// a call into the module, including dispatch of subfunctions:
+		PsychRegister((char*) "NullCallHelper",  &PsychNullModuleFunction);
+
+		// Register subfunction for per-subfunction profiling of calls into the module:
+		PsychRegister((char*) "Profile",  &PsychProfileModuleFunction);
+
 		firstTime = FALSE;
 	}
 	
@@ -779,6 +797,9 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
     }
     
     if (psych_recursion_debug) printf("PTB-DEBUG: Module %s entering recursive call level %i.\n", PsychGetModuleName(), recLevel);
+
+    // Profiling enabled via Modulename('Profile', 'Start')? Start timing of this call:
+    if (psychProfilingEnabled) PsychProfileCallBegin(recLevel);
     
 	// Store away call arguments for use by language-neutral accessor functions in ScriptingGlue.c
 	#if PSYCH_LANGUAGE == PSYCH_MATLAB
@@ -902,7 +923,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		baseFunction = PsychGetProjectFunction(NULL);
 		if(baseFunction != NULL){
                         baseFunctionInvoked[recLevel]=TRUE;
-			(*baseFunction)();  //invoke the unnamed function
+			PsychInvokeSubfunction(baseFunction);  //invoke the unnamed function
 		}else
 			PrintfExit("Project base function invoked but no base function registered");
 	}else{ //subfunctions are enabled so pull out the function name string and invoke it.
@@ -938,7 +959,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 			baseFunction = PsychGetProjectFunction(NULL);
 			if(baseFunction != NULL){
                                 baseFunctionInvoked[recLevel]=TRUE;
-				(*baseFunction)();
+				PsychInvokeSubfunction(baseFunction);
 			}else
 				PrintfExit("Project base function invoked but no base function registered");
 		}
@@ -953,7 +974,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		else if(isArgEmptyMat[0] && isArgText[1]){
 			if(isArgFunction[1]){
 				nameFirstGLUE[recLevel] = FALSE;
-				(*(fArg[1]))();
+				PsychInvokeSubfunction(fArg[1]);
 			}
 			else
 				PrintfExit("Unknown or invalid subfunction name - Typo? Check spelling of the function name.  (error state C)");
@@ -964,7 +985,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		else if(isArgText[0] && !isArgThere[1]){
 			if(isArgFunction[0]){
 				nameFirstGLUE[recLevel] = TRUE;
-				(*(fArg[0]))();
+				PsychInvokeSubfunction(fArg[0]);
 			}else{ //when we receive a first argument  wich is a string and it is  not recognized as a function name then call the default function 
 			/*
                         else
@@ -973,7 +994,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
                             baseFunction = PsychGetProjectFunction(NULL);
                             if(baseFunction != NULL){
                                 baseFunctionInvoked[recLevel]=TRUE;
-				(*baseFunction)();
+				PsychInvokeSubfunction(baseFunction);
                             }else
 				PrintfExit("Project base function invoked but no base function registered");
                         }
@@ -982,7 +1003,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		else if(isArgText[0] && isArgEmptyMat[1]){
 			if(isArgFunction[0]){
 				nameFirstGLUE[recLevel] = TRUE;
-				(*(fArg[0]))();
+				PsychInvokeSubfunction(fArg[0]);
 			}
 			else
 				PrintfExit("Unknown or invalid subfunction name - Typo? Check spelling of the function name.  (error state F)");
@@ -990,18 +1011,18 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		else if(isArgText[0] && isArgText[1]){
 			if(isArgFunction[0] && !isArgFunction[1]){ //the first argument is the function name
 				nameFirstGLUE[recLevel] = TRUE;
-				(*(fArg[0]))();
+				PsychInvokeSubfunction(fArg[0]);
 			}
 			else if(!isArgFunction[0] && isArgFunction[1]){ //the second argument is the function name
 				nameFirstGLUE[recLevel] = FALSE;
-				(*(fArg[1]))();
+				PsychInvokeSubfunction(fArg[1]);
 			}
 			else if(!isArgFunction[0] && !isArgFunction[1]){ //neither argument is a function name
                             //PrintfExit("Invalid command (error state G)");
                             baseFunction = PsychGetProjectFunction(NULL);
                             if(baseFunction != NULL){
                                 baseFunctionInvoked[recLevel]=TRUE;
-				(*baseFunction)();
+				PsychInvokeSubfunction(baseFunction);
                             }else
 				PrintfExit("Project base function invoked but no base function registered");
                         }
@@ -1011,7 +1032,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		else if(isArgText[0] && !isArgText[1]){
 			if(isArgFunction[0]){
 				nameFirstGLUE[recLevel] = TRUE;
-				(*(fArg[0]))();
+				PsychInvokeSubfunction(fArg[0]);
 			}
 			else
 				PrintfExit("Unknown or invalid subfunction name - Typo? Check spelling of the function name.  (error state H)");
@@ -1022,7 +1043,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
                     baseFunction = PsychGetProjectFunction(NULL);
                     if(baseFunction != NULL){
                         baseFunctionInvoked[recLevel]=TRUE;
-                        (*baseFunction)();  //invoke the unnamed function
+                        PsychInvokeSubfunction(baseFunction);  //invoke the unnamed function
                     }else
                         PrintfExit("Project base function invoked but no base function registered");
                 }
@@ -1032,7 +1053,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
 		{
 			if(isArgFunction[1]){
 				nameFirstGLUE[recLevel] = FALSE;
-				(*(fArg[1]))();
+				PsychInvokeSubfunction(fArg[1]);
 			}
 			else
 				PrintfExit("Unknown or invalid subfunction name - Typo? Check spelling of the function name.  (error state J)");
@@ -1042,7 +1063,7 @@ EXP octave_value_list octFunction(const octave_value_list& prhs, const int nlhs)
                     baseFunction = PsychGetProjectFunction(NULL);
                     if(baseFunction != NULL){
                         baseFunctionInvoked[recLevel]=TRUE;
-                        (*baseFunction)();  //invoke the unnamed function
+                        PsychInvokeSubfunction(baseFunction);  //invoke the unnamed function
                     }else
                         PrintfExit("Project base function invoked but no base function registered");
                 }
@@ -1094,6 +1115,12 @@ octFunctionCleanup:
 	// Release all memory allocated via PsychMallocTemp():
 	PsychFreeAllTempMemory();
 
+	// Module shut down via 'JettisonModuleHelper'? Then also release the memory kept for reuse:
+	if (jettisoned) PsychReleaseTempMemoryPool();
+
+	// Account this call in profile, unless it was aborted by an error:
+	if (psychProfilingEnabled && !errorcondition) PsychProfileCallEnd(recLevel);
+
 	// Is this a successfull return?
 	if (errorcondition) {
 	  // Nope - Error return, either due to some PTB detected error or due to
@@ -1121,6 +1148,7 @@ octFunctionCleanup:
 	// back to Octave:
 	return(plhs);
 #else
+	if (psychProfilingEnabled) PsychProfileCallEnd(recLevel);
 	PsychExitRecursion();
 #endif
 }
@@ -2658,6 +2686,72 @@ psych_bool PsychAllocInUnsignedByteMatArg(int position, PsychArgRequirementType
 
 
 
+/*
+    PsychAllocInInt16MatArg64()
+
+    Like PsychAllocInUnsignedByteMatArg() except it returns an array of signed 16 bit integers,
+    aka Matlab/Octave data type int16(), with 64 bit size return-arguments. No type conversion
+    is performed, the returned pointer points to the data of the input matrix.
+*/
+psych_bool PsychAllocInInt16MatArg64(int position, PsychArgRequirementType isRequired, psych_int64 *m, psych_int64 *n, psych_int64 *p, short **array)
+{
+	const mxArray 	*mxPtr;
+	PsychError		matchError;
+	psych_bool			acceptArg;
+
+	PsychSetReceivedArgDescriptor(position, FALSE, PsychArgIn);
+	PsychSetSpecifiedArgDescriptor(position, PsychArgIn, PsychArgType_int16, isRequired, 1,-1,1,-1,0,-1);
+	matchError=PsychMatchDescriptors();
+	acceptArg=PsychAcceptInputArgumentDecider(isRequired, matchError);
+	if(acceptArg){
+		mxPtr = PsychGetInArgMxPtr(position);
+		*m = (psych_int64) mxGetM(mxPtr);
+		*n = (psych_int64) mxGetNOnly(mxPtr);
+		*p = (psych_int64) mxGetP(mxPtr);
+		*array=(short *)mxGetData(mxPtr);
+	}
+	return(acceptArg);
+}
+
+
+/*
+    PsychAllocInNumericMatArg64()
+
+    Alloc-in a numeric matrix of any of the data types in the 'allowedTypes' bit mask, e.g.,
+    PsychArgType_double | PsychArgType_single | PsychArgType_int16, with 64 bit size return-arguments.
+    No type conversion or copy is performed, the returned pointer points to the read-only data of
+    the input matrix, in its native type, which is returned in *type. This allows functions which
+    can process multiple data types, e.g., by passing them to OpenGL as is, to avoid the cost of
+    converting big matrices into double or float.
+
+    Octave's glue passes all non-uint8 matrices as double matrices, so there the returned type is
+    always PsychArgType_double or PsychArgType_uint8, if those are allowed.
+
+    Returns TRUE if a matching argument was provided, FALSE otherwise, same as the other alloc-in
+    functions.
+*/
+psych_bool PsychAllocInNumericMatArg64(int position, PsychArgRequirementType isRequired, PsychArgFormatType allowedTypes, psych_int64 *m, psych_int64 *n, psych_int64 *p, void **array, PsychArgFormatType *type)
+{
+	const mxArray 	*mxPtr;
+	PsychError		matchError;
+	psych_bool			acceptArg;
+
+	PsychSetReceivedArgDescriptor(position, TRUE, PsychArgIn);
+	PsychSetSpecifiedArgDescriptor(position, PsychArgIn, allowedTypes, isRequired, 1,-1,1,-1,0,-1);
+	matchError=PsychMatchDescriptors();
+	acceptArg=PsychAcceptInputArgumentDecider(isRequired, matchError);
+	if(acceptArg){
+		mxPtr = PsychGetInArgMxPtr(position);
+		*m = (psych_int64) mxGetM(mxPtr);
+		*n = (psych_int64) mxGetNOnly(mxPtr);
+		*p = (psych_int64) mxGetP(mxPtr);
+		*array = mxGetData(mxPtr);
+		*type = PsychGetTypeFromMxPtr(mxPtr);
+	}
+	return(acceptArg);
+}
+
+
 /* 
 	PsychCopyInDoubleArg()
 	
@@ -103,6 +103,10 @@ void PsychClearFlagListElement(int index, PsychFlagListType flagList);
 psych_bool PsychAllocInUnsignedByteMatArg(int position, PsychArgRequirementType isRequired, int *m, int *n, int *p, unsigned char **array);
 psych_bool PsychAllocOutUnsignedByteMatArg(int position, PsychArgRequirementType isRequired, psych_int64 m, psych_int64 n, psych_int64 p, psych_uint8 **array);
 
+//for 16 bit integers
+psych_bool PsychAllocInInt16MatArg64(int position, PsychArgRequirementType isRequired, psych_int64 *m, psych_int64 *n, psych_int64 *p, short **array);
+psych_bool PsychAllocInNumericMatArg64(int position, PsychArgRequirementType isRequired, PsychArgFormatType allowedTypes, psych_int64 *m, psych_int64 *n, psych_int64 *p, void **array, PsychArgFormatType *type);
+
 //for strings
 psych_bool PsychAllocInCharArg(int position, PsychArgRequirementType isRequired, char **str);
 psych_bool PsychCopyOutCharArg(int position, PsychArgRequirementType isRequired, const char *str);
@@ -55,7 +55,9 @@ PsychError EyelinkTargetCheck(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
              
+   PsychEyelinkLockLink();
    result = eyelink_target_check(&tx, &ty);
+   PsychEyelinkUnlockLink();
 
    PsychCopyOutDoubleArg(1, TRUE, result);
    PsychCopyOutDoubleArg(2, TRUE, (int)tx);
@@ -53,7 +53,9 @@ PsychError EyelinkAcceptTrigger(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    result = eyelink_accept_trigger();
+   PsychEyelinkUnlockLink();
 
    /* if there is an output variable available, assign result to it.   */
    PsychCopyOutDoubleArg(1, FALSE, result);
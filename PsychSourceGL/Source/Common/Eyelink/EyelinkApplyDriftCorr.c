@@ -54,7 +54,9 @@ PsychError EyelinkApplyDriftCorr(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    result = eyelink_apply_driftcorr();
+   PsychEyelinkUnlockLink();
    
    /* if there is an output variable available, assign result to it.   */
    PsychCopyOutDoubleArg(1, FALSE, result);
@@ -57,7 +57,9 @@ PsychError EyelinkButtonStates(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 	
+	PsychEyelinkLockLink();
 	iButtons = eyelink_button_states();
+	PsychEyelinkUnlockLink();
 	
     // Allocate an output matrix.  Even if argument is not there, we still get the space.     
     PsychAllocOutDoubleArg(1, FALSE, &pfOutArg);
@@ -51,7 +51,9 @@ PsychError EyelinkCalMessage(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 	
+	PsychEyelinkLockLink();
 	result = eyelink_cal_message(strMessage);
+	PsychEyelinkUnlockLink();
 
 	PsychCopyOutDoubleArg(1, TRUE, result);
 	PsychCopyOutCharArg(2, TRUE, strMessage);	
@@ -57,7 +57,9 @@ PsychError EyelinkCalResult(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    result = eyelink_cal_result();
+   PsychEyelinkUnlockLink();
    
    PsychCopyOutDoubleArg(1, TRUE, result);
    
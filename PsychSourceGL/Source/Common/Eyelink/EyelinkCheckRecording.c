@@ -65,7 +65,9 @@ PsychError EyelinkCheckRecording(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    error = check_recording();
+   PsychEyelinkUnlockLink();
 
    PsychCopyOutDoubleArg(1, TRUE, error);
    
@@ -55,7 +55,9 @@ PsychError EyelinkCloseFile(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    closefilestatus = close_data_file();
+   PsychEyelinkUnlockLink();
    
    if (closefilestatus != 0)
       printf("Eyelink closefile: Error in closing file %d\n", closefilestatus);
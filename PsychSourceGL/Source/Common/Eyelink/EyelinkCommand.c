@@ -53,6 +53,7 @@ PURPOSE:
 PsychError EyelinkCommand(void)
 {
 	int iStatus = -1;
+	const char *cmd;
 
 	// Add help strings
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -72,7 +73,10 @@ PsychError EyelinkCommand(void)
 	EyelinkSystemIsInitialized();
 
 	// Build eyelink command and execute
-	iStatus = eyecmd_printf(PsychEyelinkParseToString(1));
+	cmd = PsychEyelinkParseToString(1);
+	PsychEyelinkLockLink();
+	iStatus = eyecmd_printf(cmd);
+	PsychEyelinkUnlockLink();
 
 	// Copy out the command result
 	PsychCopyOutDoubleArg(1, FALSE, iStatus);
@@ -0,0 +1,340 @@
+/*
+	PsychSourceGL/Source/Common/Eyelink/EyelinkCoreStub/eyelink_core_stub.c
+
+	PROJECTS: Eyelink
+
+	PLATFORMS:	Linux
+
+	HISTORY:
+
+		Stub replacement of SR-Research's libeyelink_core for offline testing of Eyelink.mex.
+
+	DESCRIPTION:
+
+		Implements all functions of libeyelink_core which are used by Eyelink.mex. No tracker
+		is needed: While "recording", synthetic samples are generated at a configurable rate
+		and put into a link queue of configurable size, which behaves like the one of the real
+		library: If it isn't emptied often enough, the oldest items are dropped and replaced by
+		a LOST_DATA_EVENT. This allows to measure throughput and drop counts of
+		Eyelink('GetQueuedData'), with and without Eyelink('StartQueuedDataDrain').
+
+		Each sample carries its serial number, starting at zero, in gx[0], so dropped samples
+		can be detected. Every Nth sample is followed by an ENDFIX event.
+
+		Setup and calibration functions are no-ops which report success.
+
+		Settings via environment variables:
+
+		PSYCH_EYELINK_STUB_RATE        Sampling rate in Hz. Default 1000.
+		PSYCH_EYELINK_STUB_QUEUE       Link queue size in items. Default 1000.
+		PSYCH_EYELINK_STUB_EVENTEVERY  Number of samples between ENDFIX events. Default 250, 0 = none.
+
+		Build with the eye_data.h header of the Eyelink SDK in the include path:
+
+		gcc -O2 -fPIC -shared -Wl,-soname,libeyelink_core.so -I/usr/include/EyeLink -o libeyelink_core.so eyelink_core_stub.c -lpthread -lrt -lm
+
+		Then start Octave or Matlab with LD_LIBRARY_PATH pointing to the directory of the stub
+		libeyelink_core.so, so Eyelink.mex uses it instead of the real library.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "eye_data.h"
+
+#define STUB_ITEM_SAMPLE 0
+#define STUB_ITEM_EVENT  1
+
+typedef struct {
+	int			kind;
+	FSAMPLE		fs;
+	FEVENT		fe;
+} StubItem;
+
+static pthread_mutex_t	stubLock = PTHREAD_MUTEX_INITIALIZER;
+static int				connected = 0;
+static int				recording = 0;
+static double			rate = 1000;
+static int				eventEvery = 250;
+static double			tStart = 0;
+static double			tRecordStart = 0;
+static unsigned int		generated = 0;
+
+static StubItem			*queue = NULL;
+static unsigned int		queueSize = 1000;
+static unsigned int		queueHead = 0;
+static unsigned int		queueCount = 0;
+static int				lostPending = 0;
+
+static StubItem			current;
+static int				currentType = 0;
+static FSAMPLE			newestSample;
+static int				newestValid = 0;
+static int				newestFetched = 1;
+
+static char				readRequest[256] = "";
+
+static double stub_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((double) ts.tv_sec + (double) ts.tv_nsec / 1e9);
+}
+
+static void stub_init(void)
+{
+	char *env;
+
+	if (queue) return;
+
+	if ((env = getenv("PSYCH_EYELINK_STUB_RATE")) && atof(env) > 0) rate = atof(env);
+	if ((env = getenv("PSYCH_EYELINK_STUB_QUEUE")) && atoi(env) > 0) queueSize = (unsigned int) atoi(env);
+	if ((env = getenv("PSYCH_EYELINK_STUB_EVENTEVERY")) && atoi(env) >= 0) eventEvery = atoi(env);
+
+	queue = (StubItem*) calloc(queueSize, sizeof(StubItem));
+	tStart = stub_now();
+}
+
+static void stub_push(const StubItem *item)
+{
+	if (queueCount == queueSize) {
+		// Queue full: Drop oldest item, reader will see a LOST_DATA_EVENT first:
+		queueHead = (queueHead + 1) % queueSize;
+		queueCount--;
+		lostPending = 1;
+	}
+
+	queue[(queueHead + queueCount) % queueSize] = *item;
+	queueCount++;
+}
+
+// Generate all samples and events which are due by now. Called with stubLock held.
+static void stub_generate(void)
+{
+	StubItem item;
+	unsigned int due, i;
+	double ms;
+
+	if (!recording) return;
+
+	due = (unsigned int) ((stub_now() - tRecordStart) * rate);
+
+	// Everything beyond the queue size would be dropped anyway, so skip it:
+	if (due - generated > queueSize) {
+		generated = due - queueSize;
+		lostPending = 1;
+	}
+
+	for (; generated < due; generated++) {
+		memset(&item, 0, sizeof(item));
+		ms = (tRecordStart - tStart) * 1000 + generated * 1000 / rate;
+
+		item.kind = STUB_ITEM_SAMPLE;
+		item.fs.time = (UINT32) ms;
+		item.fs.type = SAMPLE_TYPE;
+		item.fs.flags = SAMPLE_LEFT | SAMPLE_GAZEXY | SAMPLE_PUPILSIZE;
+		#ifdef SAMPLE_ADD_OFFSET
+			if (ms - floor(ms) >= 0.5) item.fs.flags |= SAMPLE_ADD_OFFSET;
+		#endif
+		for (i = 0; i < 2; i++) {
+			item.fs.px[i] = item.fs.py[i] = item.fs.hx[i] = item.fs.hy[i] = MISSING_DATA;
+			item.fs.gx[i] = item.fs.gy[i] = item.fs.pa[i] = MISSING_DATA;
+		}
+		item.fs.gx[0] = (float) generated;
+		item.fs.gy[0] = (float) (500 + 100 * sin(ms / 1000));
+		item.fs.pa[0] = 1000;
+		item.fs.rx = item.fs.ry = 30;
+
+		stub_push(&item);
+		newestSample = item.fs;
+		newestValid = 1;
+		newestFetched = 0;
+
+		if (eventEvery > 0 && (generated % eventEvery) == (unsigned int) (eventEvery - 1)) {
+			memset(&item, 0, sizeof(item));
+			item.kind = STUB_ITEM_EVENT;
+			item.fe.time = (UINT32) ms;
+			item.fe.type = ENDFIX;
+			item.fe.eye = LEFT_EYE;
+			item.fe.sttime = (UINT32) (ms - eventEvery * 1000 / rate);
+			item.fe.entime = (UINT32) ms;
+			stub_push(&item);
+		}
+	}
+}
+
+INT16 eyelink_get_next_data(void *buf)
+{
+	pthread_mutex_lock(&stubLock);
+	stub_generate();
+
+	if (lostPending) {
+		lostPending = 0;
+		currentType = LOST_DATA_EVENT;
+	}
+	else if (queueCount > 0) {
+		current = queue[queueHead];
+		queueHead = (queueHead + 1) % queueSize;
+		queueCount--;
+		currentType = (current.kind == STUB_ITEM_SAMPLE) ? current.fs.type : current.fe.type;
+		if (buf) memcpy(buf, (current.kind == STUB_ITEM_SAMPLE) ? (void*) &current.fs : (void*) &current.fe, (current.kind == STUB_ITEM_SAMPLE) ? sizeof(FSAMPLE) : sizeof(FEVENT));
+	}
+	else {
+		currentType = 0;
+	}
+
+	pthread_mutex_unlock(&stubLock);
+	return((INT16) currentType);
+}
+
+INT16 eyelink_get_float_data(void *buf)
+{
+	if (buf && currentType != 0 && currentType != LOST_DATA_EVENT) {
+		if (current.kind == STUB_ITEM_SAMPLE) memcpy(buf, &current.fs, sizeof(FSAMPLE)); else memcpy(buf, &current.fe, sizeof(FEVENT));
+	}
+
+	return((INT16) currentType);
+}
+
+INT16 eyelink_get_last_data(void *buf)
+{
+	return(eyelink_get_float_data(buf));
+}
+
+INT16 eyelink_newest_float_sample(void *buf)
+{
+	int rc;
+
+	pthread_mutex_lock(&stubLock);
+	stub_generate();
+	if (!newestValid) {
+		rc = -1;
+	}
+	else {
+		rc = (newestFetched) ? 0 : 1;
+		if (buf) {
+			memcpy(buf, &newestSample, sizeof(FSAMPLE));
+			newestFetched = 1;
+		}
+	}
+	pthread_mutex_unlock(&stubLock);
+
+	return((INT16) rc);
+}
+
+INT16 eyelink_data_count(INT16 samples, INT16 events)
+{
+	unsigned int i, n = 0;
+
+	pthread_mutex_lock(&stubLock);
+	stub_generate();
+	for (i = 0; i < queueCount; i++) {
+		if ((queue[(queueHead + i) % queueSize].kind == STUB_ITEM_SAMPLE) ? samples : events) n++;
+	}
+	pthread_mutex_unlock(&stubLock);
+
+	return((INT16) ((n > 32767) ? 32767 : n));
+}
+
+INT16 eyelink_get_extra_raw_values(FSAMPLE *s, FSAMPLE_RAW *rv)
+{
+	memset(rv, 0, sizeof(FSAMPLE_RAW));
+	return(0);
+}
+
+INT16 eyelink_get_extra_raw_values_v2(FSAMPLE *s, INT16 eye, FSAMPLE_RAW *rv)
+{
+	memset(rv, 0, sizeof(FSAMPLE_RAW));
+	return(0);
+}
+
+// Connection and system:
+INT16 open_eyelink_system(UINT16 bufsize, char *options) { stub_init(); return(1); }
+void close_eyelink_system(void) { connected = 0; recording = 0; }
+INT16 open_eyelink_connection(INT16 mode) { stub_init(); connected = (mode == 1) ? -1 : 1; return(0); }
+INT16 set_eyelink_address(char *addr) { return(0); }
+INT16 eyelink_open(void) { stub_init(); connected = 1; return(0); }
+INT16 eyelink_open_connection(INT16 mode) { return(eyelink_open()); }
+INT16 eyelink_dummy_open(void) { stub_init(); connected = -1; return(0); }
+INT16 eyelink_close(INT16 send_msg) { connected = 0; recording = 0; return(0); }
+INT16 eyelink_is_connected(void) { return((INT16) connected); }
+void eyelink_dll_version(char *c) { strcpy(c, "1,8,1,0"); }
+INT16 eyelink_get_tracker_version(char *c) { if (c) strcpy(c, "EYELINK CL 4.56"); return(3); }
+char *eyelink_get_error(int id, char *function_name) { return("eyelink_core stub error"); }
+
+// Recording:
+INT16 start_recording(INT16 file_samples, INT16 file_events, INT16 link_samples, INT16 link_events)
+{
+	pthread_mutex_lock(&stubLock);
+	stub_init();
+	tRecordStart = stub_now();
+	generated = 0;
+	queueHead = queueCount = 0;
+	lostPending = 0;
+	recording = 1;
+	pthread_mutex_unlock(&stubLock);
+	return(0);
+}
+
+void stop_recording(void)
+{
+	pthread_mutex_lock(&stubLock);
+	stub_generate();
+	recording = 0;
+	pthread_mutex_unlock(&stubLock);
+}
+
+INT16 check_recording(void) { return((INT16) ((recording) ? 0 : -1)); }
+void set_offline_mode(void) { stop_recording(); }
+INT16 eyelink_tracker_mode(void) { return(0); }
+INT16 eyelink_current_mode(void) { return(0); }
+INT16 eyelink_wait_for_mode_ready(UINT32 maxwait) { return(0); }
+INT16 eyelink_eye_available(void) { return(LEFT_EYE); }
+
+// Commands, messages and files:
+int eyecmd_printf(const char *fmt, ...) { return(0); }
+int eyemsg_printf(const char *fmt, ...) { return(0); }
+INT16 open_data_file(char *name) { return(0); }
+INT16 close_data_file(void) { return(0); }
+INT32 receive_data_file(char *src, char *dest, INT16 dest_is_path) { return(0); }
+INT16 eyelink_read_request(char *text) { strncpy(readRequest, text, sizeof(readRequest) - 1); return(0); }
+
+INT16 eyelink_read_reply(char *buf)
+{
+	if (strstr(readRequest, "link_sample_data")) strcpy(buf, "LEFT,RIGHT,GAZE,GAZERES,AREA,STATUS,INPUT,HMARKER");
+	else strcpy(buf, "");
+	return(OK_RESULT);
+}
+
+// Setup, calibration and drift correction:
+INT16 eyelink_start_setup(void) { return(0); }
+INT16 do_tracker_setup(void) { return(0); }
+INT16 do_drift_correct(INT16 x, INT16 y, INT16 draw, INT16 allow_setup) { return(0); }
+INT16 eyelink_driftcorr_start(INT16 x, INT16 y) { return(0); }
+INT16 eyelink_apply_driftcorr(void) { return(0); }
+INT16 eyelink_cal_result(void) { return(0); }
+INT16 eyelink_cal_message(char *msg) { if (msg) msg[0] = 0; return(0); }
+INT16 eyelink_accept_trigger(void) { return(0); }
+INT16 eyelink_target_check(INT16 *x, INT16 *y) { *x = *y = 0; return(0); }
+INT16 eyelink_send_keybutton(UINT16 code, UINT16 mods, INT16 state) { return(0); }
+UINT16 eyelink_button_states(void) { return(0); }
+
+// Graphics hooks: Hook structs are opaque here, only handled via pointers:
+static void *hookFunctions[64];
+INT16 setup_graphic_hook_functions(void *hooks) { return(0); }
+void *get_all_hook_functions(void) { return(hookFunctions); }
+INT16 get_image_xhair_data(INT16 x[4], INT16 y[4], INT16 *xhairs_on) { *xhairs_on = 0; return(0); }
+void eyelink_draw_cross_hair(void *chi) { }
+
+// Time:
+UINT32 current_msec(void) { stub_init(); return((UINT32) ((stub_now() - tStart) * 1000)); }
+void msec_delay(UINT32 n) { struct timespec ts = { n / 1000, (n % 1000) * 1000000 }; nanosleep(&ts, NULL); }
+double eyelink_tracker_double_usec(void) { stub_init(); return((stub_now() - tStart) * 1e6); }
+double eyelink_double_usec_offset(void) { return(0); }
+UINT32 eyelink_request_time(void) { return(0); }
+UINT32 eyelink_read_time(void) { return(current_msec()); }
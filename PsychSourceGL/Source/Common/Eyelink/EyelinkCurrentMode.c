@@ -61,7 +61,9 @@ PsychError EyelinkCurrentMode(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 	
+	PsychEyelinkLockLink();
 	iMode = eyelink_current_mode();
+	PsychEyelinkUnlockLink();
 	
 	// Assign output arg
 	PsychCopyOutDoubleArg(1, TRUE, iMode);
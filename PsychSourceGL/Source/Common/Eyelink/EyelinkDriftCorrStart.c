@@ -78,9 +78,13 @@ PsychError EyelinkDriftCorrStart(void)
    PsychCopyInIntegerArg(5, FALSE, &allow_setup);
    
    if (dtype == 0) {
+       PsychEyelinkLockLink();
        status = (int) eyelink_driftcorr_start((INT16) x,(INT16) y);
+       PsychEyelinkUnlockLink();
    }
    else {
+       // Runs our calibration callbacks for a long time, so not while the drain owns the link:
+       if (PsychEyelinkQueuedDataDrainRunning()) PsychErrorExitMsg(PsychError_user, "Eyelink: DriftCorrStart: can't run do_drift_correct() while a background drain via Eyelink('StartQueuedDataDrain') is active. Stop it first.");
        status = (int) do_drift_correct((INT16) x,(INT16) y, (INT16) dodraw, (INT16) allow_setup);
    }
    
@@ -72,7 +72,9 @@ PsychError EyelinkEyeAvailable(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    eyeused = eyelink_eye_available();
+   PsychEyelinkUnlockLink();
 
    PsychCopyOutDoubleArg(1, TRUE, eyeused);
    
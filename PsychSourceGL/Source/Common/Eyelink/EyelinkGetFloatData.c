@@ -66,6 +66,7 @@ PsychError EyelinkGetFloatData(void)
 	// Verify eyelink is up and running
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
+	if (PsychEyelinkQueuedDataDrainActive()) PsychErrorExitMsg(PsychError_user, "Eyelink: GetFloatData: can't be used while a background drain via Eyelink('StartQueuedDataDrain') is active. Use Eyelink('GetQueuedData') instead.");
 	
 	PsychCopyInIntegerArg(1, TRUE, &type);
 	
@@ -155,6 +156,7 @@ PsychError EyelinkGetFloatDataRaw(void)
 	// Verify eyelink is up and running
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
+	if (PsychEyelinkQueuedDataDrainActive()) PsychErrorExitMsg(PsychError_user, "Eyelink: GetFloatDataRaw: can't be used while a background drain via Eyelink('StartQueuedDataDrain') is active. Use Eyelink('GetQueuedData') instead.");
 	
 	PsychCopyInIntegerArg(1, TRUE, &type);
 	
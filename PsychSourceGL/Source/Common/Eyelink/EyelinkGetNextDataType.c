@@ -53,6 +53,7 @@ PsychError EyelinkGetNextDataType(void)
 	// Verify eyelink is up and running
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
+	if (PsychEyelinkQueuedDataDrainActive()) PsychErrorExitMsg(PsychError_user, "Eyelink: GetNextDataType: can't be used while a background drain via Eyelink('StartQueuedDataDrain') is active. Use Eyelink('GetQueuedData') instead.");
 
    type = eyelink_get_next_data(NULL);
 
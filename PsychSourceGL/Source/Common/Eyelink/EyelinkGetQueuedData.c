@@ -20,14 +20,16 @@
 
 #include "PsychEyelink.h"
 
-static char useString[] = "[samples, events, drained] = Eyelink('GetQueuedData' [, eye])";
+static char useString[] = "[samples, events, drained, sampleTimes, eventTimes] = Eyelink('GetQueuedData' [, eye])";
 
 static char synopsisString[] =
 "dequeues all samples and events from the link.\n"
 "returns double matrices where columns are items and rows are fields from eyelink sample structs.\n"
 "return flag 'drained' indicates whether queue was emptied or if this function needs to be called again.\n"
 "if you include the eye argument (as LEFT_EYE or RIGHT_EYE as returned by EyelinkInitDefaults), samples will include raw fields for that eye.\n"
-"if you don't remove items from the queue often enough, the oldest items will be replaced by a LOSTDATAEVENT, which will appear in the sample records at the location where items were dropped (fields other than type will be set to MISSING_DATA).\n\n"
+"if you don't remove items from the queue often enough, the oldest items will be replaced by a LOSTDATAEVENT, which will appear in the sample records at the location where items were dropped (fields other than type will be set to MISSING_DATA).\n"
+"optional return vectors 'sampleTimes' and 'eventTimes' contain the GetSecs time at which each sample and event was received from the link.\n"
+"if a background drain was started via Eyelink('StartQueuedDataDrain'), items are taken from its large ring buffer instead of the link, so the link queue can't overflow if you call this function infrequently, and receive times are accurate to about a millisecond. in that case 'drained' is always 1, and raw values are only available for the eye selected in Eyelink('StartQueuedDataDrain').\n\n"
 
 "sample rows are as follows: \n"
 "\t 1: time of sample (when camera imaged eye, in milliseconds since tracker was activated)\n"
@@ -126,7 +128,7 @@ static char synopsisString[] =
 "\t 29: ending angular resolution y in screen pixels per visual degree\n"
 "\t 30: status (collected error and status flags from all samples in the event (only useful for EyeLink II and EyeLink1000, report CR status and tracking error). see eye_data.h.)\n\n";
 
-static char seeAlsoString[] = "";
+static char seeAlsoString[] = "StartQueuedDataDrain StopQueuedDataDrain";
 
 #define NUM_SAMPLE_FIELDS 31
 #define NUM_RAW_SAMPLE_FIELDS 17
@@ -134,11 +136,113 @@ static char seeAlsoString[] = "";
 #define FUDGE_FACTOR 2 // how much more space we allocate beyond the reported queue length to account for additional items arriving as we are dequeueing
 #define ERR_BUFF_LEN 1000
 
+// store one sample as a column of numSampleFields doubles, with raw fields if fr is non-NULL
+static void StoreSample(double *dst, const FSAMPLE *fs, const FSAMPLE_RAW *fr)
+{
+	*dst++=(double)(FLOAT_TIME(fs)); // 1
+	*dst++=(double)(fs->type); // 2
+	*dst++=(double)(fs->flags); // 3
+	*dst++=(double)(fs->px[0]); // 4
+	*dst++=(double)(fs->px[1]); // 5
+	*dst++=(double)(fs->py[0]); // 6
+	*dst++=(double)(fs->py[1]); // 7
+	*dst++=(double)(fs->hx[0]); // 8
+	*dst++=(double)(fs->hx[1]); // 9
+	*dst++=(double)(fs->hy[0]); // 10
+	*dst++=(double)(fs->hy[1]); // 11
+	*dst++=(double)(fs->pa[0]); // 12
+	*dst++=(double)(fs->pa[1]); // 13
+	*dst++=(double)(fs->gx[0]); // 14
+	*dst++=(double)(fs->gx[1]); // 15
+	*dst++=(double)(fs->gy[0]); // 16
+	*dst++=(double)(fs->gy[1]); // 17
+	*dst++=(double)(fs->rx); // 18
+	*dst++=(double)(fs->ry); // 19
+	*dst++=(double)(fs->status); // 20
+	*dst++=(double)(fs->input); // 21
+	*dst++=(double)(fs->buttons); // 22
+	*dst++=(double)(fs->htype); // 23
+	*dst++=(double)(fs->hdata[0]); // 24
+	*dst++=(double)(fs->hdata[1]); // 25
+	*dst++=(double)(fs->hdata[2]); // 26
+	*dst++=(double)(fs->hdata[3]); // 27
+	*dst++=(double)(fs->hdata[4]); // 28
+	*dst++=(double)(fs->hdata[5]); // 29
+	*dst++=(double)(fs->hdata[6]); // 30
+	*dst++=(double)(fs->hdata[7]); // 31
+
+	if (fr) {
+		*dst++=(double)(fr->raw_pupil[0]); // 32
+		*dst++=(double)(fr->raw_pupil[1]); // 33
+		*dst++=(double)(fr->raw_cr[0]); // 34
+		*dst++=(double)(fr->raw_cr[1]); // 35
+		*dst++=(double)(fr->pupil_area); // 36
+		*dst++=(double)(fr->cr_area); // 37
+		*dst++=(double)(fr->pupil_dimension[0]); // 38
+		*dst++=(double)(fr->pupil_dimension[1]); // 39
+		*dst++=(double)(fr->cr_dimension[0]); // 40
+		*dst++=(double)(fr->cr_dimension[1]); // 41
+		*dst++=(double)(fr->window_position[0]); // 42
+		*dst++=(double)(fr->window_position[1]); // 43
+		*dst++=(double)(fr->pupil_cr[0]); // 44
+		*dst++=(double)(fr->pupil_cr[1]); // 45
+		*dst++=(double)(fr->cr_area2); // 46
+		*dst++=(double)(fr->raw_cr2[0]); // 47
+		*dst++=(double)(fr->raw_cr2[1]); // 48
+	}
+}
+
+// store a LOST_DATA_EVENT as a sample column, fields other than type are MISSING_DATA
+static void StoreLostData(double *dst, int numSampleFields)
+{
+	int fieldNum;
+
+	for(fieldNum=0; fieldNum<numSampleFields; fieldNum++){
+		*dst++= (double)((fieldNum==1) ? LOST_DATA_EVENT : MISSING_DATA);
+	}
+}
+
+// store one event as a column of NUM_EVENT_FIELDS doubles
+static void StoreEvent(double *dst, const FEVENT *fe)
+{
+	*dst++=(double)(fe->time); // 1 %FLOAT_TIME currently a noop on events
+	*dst++=(double)(fe->type); // 2
+	*dst++=(double)(fe->read); // 3
+	*dst++=(double)(fe->eye); // 4
+	*dst++=(double)(fe->sttime); // 5
+	*dst++=(double)(fe->entime); // 6
+	*dst++=(double)(fe->hstx); // 7
+	*dst++=(double)(fe->hsty); // 8
+	*dst++=(double)(fe->gstx); // 9
+	*dst++=(double)(fe->gsty); // 10
+	*dst++=(double)(fe->sta); // 11
+	*dst++=(double)(fe->henx); // 12
+	*dst++=(double)(fe->heny); // 13
+	*dst++=(double)(fe->genx); // 14
+	*dst++=(double)(fe->geny); // 15
+	*dst++=(double)(fe->ena); // 16
+	*dst++=(double)(fe->havx); // 17
+	*dst++=(double)(fe->havy); // 18
+	*dst++=(double)(fe->gavx); // 19
+	*dst++=(double)(fe->gavy); // 20
+	*dst++=(double)(fe->ava); // 21
+	*dst++=(double)(fe->avel); // 22
+	*dst++=(double)(fe->pvel); // 23
+	*dst++=(double)(fe->svel); // 24
+	*dst++=(double)(fe->evel); // 25
+	*dst++=(double)(fe->supd_x); // 26
+	*dst++=(double)(fe->eupd_x); // 27
+	*dst++=(double)(fe->supd_y); // 28
+	*dst++=(double)(fe->eupd_y); // 29
+	*dst++=(double)(fe->status); // 30
+}
+
 /*
 ROUTINE: EyelinkGetQueuedData
 PURPOSE:
 	matlab is slow at dealing with structs and looping over eyelink_get_float_data to drain the queue, so we take care of this for the client.
 	also eliminates usage error of supplying incorrect type from Eyelink('GetNextDataType') to Eyelink('GetFloatData').
+	if a background drain thread is active (see EyelinkQueuedDataDrain.c), items are taken from its ring instead of the link.
  
  TODO:
     -enable BINOCULAR raws
@@ -153,13 +257,61 @@ PURPOSE:
 #endif
  */
 
+// bulk copy of all items in the ring of the background drain thread
+static void GetQueuedDataFromDrain(psych_bool useEye, int eye, int numSampleFields)
+{
+	const PsychEyelinkQueuedItem *item;
+	unsigned int numItems, i;
+	int numSamples = 0, numEvents = 0, sampleIndex = 0, eventIndex = 0;
+	double *samples, *events, *sampleTimes, *eventTimes;
+
+	if (useEye && PsychEyelinkQueuedDataDrainEye() != eye) {
+		PsychErrorExitMsg(PsychError_user, "Eyelink: GetQueuedData: raw values for this eye were not requested when starting the background drain via Eyelink('StartQueuedDataDrain').");
+	}
+
+	numItems = PsychEyelinkQueuedItemsAvailable();
+	for(i=0; i<numItems; i++){
+		if (PsychEyelinkGetQueuedItem(i)->type == SAMPLE_TYPE || PsychEyelinkGetQueuedItem(i)->type == LOST_DATA_EVENT) numSamples++; else numEvents++;
+	}
+
+	PsychAllocOutDoubleMatArg(1, kPsychArgOptional, numSampleFields, numSamples, 1, &samples);
+	PsychAllocOutDoubleMatArg(2, kPsychArgOptional, NUM_EVENT_FIELDS, numEvents, 1, &events);
+	PsychAllocOutDoubleMatArg(4, kPsychArgOptional, 1, numSamples, 1, &sampleTimes);
+	PsychAllocOutDoubleMatArg(5, kPsychArgOptional, 1, numEvents, 1, &eventTimes);
+
+	for(i=0; i<numItems; i++){
+		item = PsychEyelinkGetQueuedItem(i);
+		switch(item->type) {
+			case SAMPLE_TYPE:
+				sampleTimes[sampleIndex]=item->hostTime;
+				StoreSample(&samples[numSampleFields*sampleIndex++], &(item->data.fs), (useEye) ? &(item->fr) : NULL);
+				break;
+
+			case LOST_DATA_EVENT:
+				sampleTimes[sampleIndex]=item->hostTime;
+				StoreLostData(&samples[numSampleFields*sampleIndex++], numSampleFields);
+				break;
+
+			default:
+				eventTimes[eventIndex]=item->hostTime;
+				StoreEvent(&events[NUM_EVENT_FIELDS*eventIndex++], &(item->data.fe));
+		}
+	}
+
+	PsychEyelinkQueuedItemsRelease(numItems);
+
+	PsychCopyOutBooleanArg(3, kPsychArgOptional, (PsychNativeBooleanType)TRUE);
+
+	if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: copied %d samples and %d events from background drain\n",numSamples,numEvents);
+}
+
 PsychError EyelinkGetQueuedData(void)
 {
 	FSAMPLE      fs;
 	FSAMPLE_RAW  fr;
 	FEVENT       fe;
-	int numSamples = 0, numEvents = 0, maxSamples, maxEvents, type, eye, fieldNum, index, numSampleFields, err;
-	double *samples, *events;
+	int numSamples = 0, numEvents = 0, maxSamples, maxEvents, type, eye=0, numSampleFields, err;
+	double *samples, *events, *sampleTimes, *eventTimes;
 	psych_bool useEye=FALSE;
 	PsychNativeBooleanType drained=(PsychNativeBooleanType)FALSE;
 	char errmsg[ERR_BUFF_LEN]="";
@@ -171,7 +323,7 @@ PsychError EyelinkGetQueuedData(void)
 	//check to see if the user supplied superfluous arguments
 	PsychErrorExit(PsychCapNumInputArgs(1));
 	PsychErrorExit(PsychRequireNumInputArgs(0));
-	PsychErrorExit(PsychCapNumOutputArgs(3));
+	PsychErrorExit(PsychCapNumOutputArgs(5));
 	
 	// Verify eyelink is up and running
 	EyelinkSystemIsConnected();
@@ -194,12 +346,20 @@ PsychError EyelinkGetQueuedData(void)
 	}
 	
 	if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: eye/raw chosen\n");
+
+	// background drain thread active, or items left in its ring after it was stopped?
+	if (PsychEyelinkQueuedDataDrainActive()) {
+		GetQueuedDataFromDrain(useEye, eye, numSampleFields);
+		return(PsychError_none);
+	}
 	
 	maxSamples = FUDGE_FACTOR*eyelink_data_count(1,0) + 1; //need to allocate at least 1 in case we get a eyelink_get_next_data not predicted by eyelink_data_count
 	maxEvents = FUDGE_FACTOR*eyelink_data_count(0,1) + 1;
 
 	samples = (double *)PsychMallocTemp(maxSamples*numSampleFields*sizeof(double)); // according to mario if OOM, ultimately calls to mxCreateNumericArray/mxMalloc will error inside matlab rather than return NULL
 	events = (double *)PsychMallocTemp(maxEvents*NUM_EVENT_FIELDS*sizeof(double));
+	sampleTimes = (double *)PsychMallocTemp(maxSamples*sizeof(double));
+	eventTimes = (double *)PsychMallocTemp(maxEvents*sizeof(double));
 	
 	if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: memory allocated for %d samples and %d events\n",maxSamples,maxEvents);
 	
@@ -223,67 +383,15 @@ PsychError EyelinkGetQueuedData(void)
 					}
 				}
 				
-				index=PsychIndexElementFrom2DArray(numSampleFields, maxSamples, 0, numSamples++);
-				samples[index++]=(double)(FLOAT_TIME(&fs)); // 1
-				samples[index++]=(double)(fs.type); // 2
-				samples[index++]=(double)(fs.flags); // 3
-				samples[index++]=(double)(fs.px[0]); // 4
-				samples[index++]=(double)(fs.px[1]); // 5
-				samples[index++]=(double)(fs.py[0]); // 6
-				samples[index++]=(double)(fs.py[1]); // 7
-				samples[index++]=(double)(fs.hx[0]); // 8
-				samples[index++]=(double)(fs.hx[1]); // 9
-				samples[index++]=(double)(fs.hy[0]); // 10
-				samples[index++]=(double)(fs.hy[1]); // 11
-				samples[index++]=(double)(fs.pa[0]); // 12
-				samples[index++]=(double)(fs.pa[1]); // 13
-				samples[index++]=(double)(fs.gx[0]); // 14
-				samples[index++]=(double)(fs.gx[1]); // 15
-				samples[index++]=(double)(fs.gy[0]); // 16
-				samples[index++]=(double)(fs.gy[1]); // 17
-				samples[index++]=(double)(fs.rx); // 18
-				samples[index++]=(double)(fs.ry); // 19
-				samples[index++]=(double)(fs.status); // 20
-				samples[index++]=(double)(fs.input); // 21
-				samples[index++]=(double)(fs.buttons); // 22
-				samples[index++]=(double)(fs.htype); // 23
-				samples[index++]=(double)(fs.hdata[0]); // 24
-				samples[index++]=(double)(fs.hdata[1]); // 25
-				samples[index++]=(double)(fs.hdata[2]); // 26
-				samples[index++]=(double)(fs.hdata[3]); // 27
-				samples[index++]=(double)(fs.hdata[4]); // 28
-				samples[index++]=(double)(fs.hdata[5]); // 29
-				samples[index++]=(double)(fs.hdata[6]); // 30
-				samples[index++]=(double)(fs.hdata[7]); // 31
-				
-				if (useEye) {
-					samples[index++]=(double)(fr.raw_pupil[0]); // 32
-					samples[index++]=(double)(fr.raw_pupil[1]); // 33
-					samples[index++]=(double)(fr.raw_cr[0]); // 34
-					samples[index++]=(double)(fr.raw_cr[1]); // 35
-					samples[index++]=(double)(fr.pupil_area); // 36
-					samples[index++]=(double)(fr.cr_area); // 37
-					samples[index++]=(double)(fr.pupil_dimension[0]); // 38
-					samples[index++]=(double)(fr.pupil_dimension[1]); // 39
-					samples[index++]=(double)(fr.cr_dimension[0]); // 40
-					samples[index++]=(double)(fr.cr_dimension[1]); // 41
-					samples[index++]=(double)(fr.window_position[0]); // 42
-					samples[index++]=(double)(fr.window_position[1]); // 43
-					samples[index++]=(double)(fr.pupil_cr[0]); // 44
-					samples[index++]=(double)(fr.pupil_cr[1]); // 45
-					samples[index++]=(double)(fr.cr_area2); // 46
-					samples[index++]=(double)(fr.raw_cr2[0]); // 47
-					samples[index++]=(double)(fr.raw_cr2[1]); // 48
-				}
+				PsychGetAdjustedPrecisionTimerSeconds(&sampleTimes[numSamples]);
+				StoreSample(&samples[PsychIndexElementFrom2DArray(numSampleFields, maxSamples, 0, numSamples++)], &fs, (useEye) ? &fr : NULL);
 				
 				if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: sample copied\n");
 				break;
 				
 			case LOST_DATA_EVENT: // queue overflowed, we are not supposed to call eyelink_get_float_data on this
-				index=PsychIndexElementFrom2DArray(numSampleFields, maxSamples, 0, numSamples++);
-				for(fieldNum=0; fieldNum<numSampleFields; fieldNum++){
-					samples[index++]= (double)((fieldNum==1) ? LOST_DATA_EVENT : MISSING_DATA);
-				}
+				PsychGetAdjustedPrecisionTimerSeconds(&sampleTimes[numSamples]);
+				StoreLostData(&samples[PsychIndexElementFrom2DArray(numSampleFields, maxSamples, 0, numSamples++)], numSampleFields);
 				if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: did lost_data\n");
 				break;
 				
@@ -297,37 +405,8 @@ PsychError EyelinkGetQueuedData(void)
 					PsychErrorExitMsg(PsychError_internal, "Eyelink: GetQueuedData: eyelink_get_float_data did not return same event type as eyelink_get_next_data.");
 				}
 				if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: get_float called on event\n");
-				index=PsychIndexElementFrom2DArray(NUM_EVENT_FIELDS, maxEvents, 0, numEvents++);
-				events[index++]=(double)(fe.time); // 1 %FLOAT_TIME currently a noop on events
-				events[index++]=(double)(fe.type); // 2
-				events[index++]=(double)(fe.read); // 3
-				events[index++]=(double)(fe.eye); // 4
-				events[index++]=(double)(fe.sttime); // 5
-				events[index++]=(double)(fe.entime); // 6
-				events[index++]=(double)(fe.hstx); // 7
-				events[index++]=(double)(fe.hsty); // 8
-				events[index++]=(double)(fe.gstx); // 9
-				events[index++]=(double)(fe.gsty); // 10
-				events[index++]=(double)(fe.sta); // 11
-				events[index++]=(double)(fe.henx); // 12
-				events[index++]=(double)(fe.heny); // 13
-				events[index++]=(double)(fe.genx); // 14
-				events[index++]=(double)(fe.geny); // 15
-				events[index++]=(double)(fe.ena); // 16
-				events[index++]=(double)(fe.havx); // 17
-				events[index++]=(double)(fe.havy); // 18
-				events[index++]=(double)(fe.gavx); // 19
-				events[index++]=(double)(fe.gavy); // 20
-				events[index++]=(double)(fe.ava); // 21
-				events[index++]=(double)(fe.avel); // 22
-				events[index++]=(double)(fe.pvel); // 23
-				events[index++]=(double)(fe.svel); // 24
-				events[index++]=(double)(fe.evel); // 25
-				events[index++]=(double)(fe.supd_x); // 26
-				events[index++]=(double)(fe.eupd_x); // 27
-				events[index++]=(double)(fe.supd_y); // 28
-				events[index++]=(double)(fe.eupd_y); // 29
-				events[index++]=(double)(fe.status); // 30
+				PsychGetAdjustedPrecisionTimerSeconds(&eventTimes[numEvents]);
+				StoreEvent(&events[PsychIndexElementFrom2DArray(NUM_EVENT_FIELDS, maxEvents, 0, numEvents++)], &fe);
 		}
 	}
 
@@ -344,6 +423,9 @@ PsychError EyelinkGetQueuedData(void)
 	PsychCopyOutDoubleMatArg(2, kPsychArgOptional, NUM_EVENT_FIELDS, numEvents, 1, events);
 	
 	PsychCopyOutBooleanArg(3, kPsychArgOptional, drained);
+
+	PsychCopyOutDoubleMatArg(4, kPsychArgOptional, 1, numSamples, 1, sampleTimes);
+	PsychCopyOutDoubleMatArg(5, kPsychArgOptional, 1, numEvents, 1, eventTimes);
 	
 	if (Verbosity() > 6) mexPrintf("Eyelink: GetQueuedData: done with outputs\n");
 	
@@ -366,7 +448,9 @@ psych_bool TrackerOKForRawValues(void) {
 	}
 	
 	while(tryAgain){
+		PsychEyelinkLockLink();
 		if ((err=eyelink_read_request("link_sample_data"))){
+			PsychEyelinkUnlockLink();
 			sprintf(errmsg, "Eyelink: eyelink_read_request returned error code '%d': '%s'", err, eyelink_get_error(err,"eyelink_read_request")); //no snprintf in msvs?  bug: buff overflow
 			PsychErrorExitMsg(PsychError_internal, errmsg);
 		}
@@ -375,6 +459,7 @@ psych_bool TrackerOKForRawValues(void) {
 		while(err==NO_REPLY){
 			err=eyelink_read_reply(buf);
 		}
+		PsychEyelinkUnlockLink();
 		
 		if(err == OK_RESULT){
 			if(strlen(buf)>0){
@@ -437,7 +522,10 @@ psych_bool TrackerOKForRawValues(void) {
 		PsychErrorExitMsg(PsychError_internal, errmsg);
 	}
 	
-	if(eyelink_get_tracker_version(buf)<3){
+	PsychEyelinkLockLink();
+	err = eyelink_get_tracker_version(buf);
+	PsychEyelinkUnlockLink();
+	if(err<3){
 		PsychErrorExitMsg(PsychError_unimplemented, "Eyelink: can't get raw values without eyelink 1000 or better");
 	} else {
 		if (Verbosity() > 6) mexPrintf("Eyelink: TrackerOKForRawValues: tracker version: '%s'\n",buf); //currently "EYELINK CL 4.31"
@@ -56,7 +56,9 @@ PsychError EyelinkGetTrackerVersion(void)
 //	EyelinkSystemIsConnected();
 //	EyelinkSystemIsInitialized();
 	
+	PsychEyelinkLockLink();
 	iVersion = eyelink_get_tracker_version(strVersion);
+	PsychEyelinkUnlockLink();
 	
 	//   mexPrintf("Tracker Version: '%s'\n", strVersion );
 	PsychCopyOutDoubleArg(1, TRUE, iVersion);
@@ -80,6 +80,7 @@ PsychError EyelinkImageModeDisplay(void)
 	// Verify eyelink is up and running
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
+	if (PsychEyelinkQueuedDataDrainRunning()) PsychErrorExitMsg(PsychError_user, "Eyelink: ImageModeDisplay: can't be used while a background drain via Eyelink('StartQueuedDataDrain') is active. Stop it first.");
 	
 	// Optionally dump the whole hookfunctions struct:
 	if (Verbosity() > 5) { printf("Eyelink-Debug: ImageModeDisplay: PreOp: \n"); PsychEyelink_dumpHookfunctions(); }
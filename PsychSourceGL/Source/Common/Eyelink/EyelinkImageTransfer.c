@@ -173,7 +173,9 @@ PsychError EyelinkImageTransfer(void)
 	bmp.format->Bmask = 0x00ff0000;
 	bmp.format->Amask = 0xff000000;
    
+    PsychEyelinkLockLink();
     iStatus = el_bitmap_to_backdrop(&bmp, xs, ys, width, height, xd, yd, xferoptions);
+    PsychEyelinkUnlockLink();
     
 	if (BitmapInfo) {
 		free(BitmapInfo);
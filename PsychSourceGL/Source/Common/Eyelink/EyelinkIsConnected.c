@@ -53,7 +53,9 @@ PsychError EyelinkIsConnected(void)
 	PsychErrorExit(PsychCapNumOutputArgs(1));
 	PsychErrorExit(PsychCapNumInputArgs(0));
 	
+	PsychEyelinkLockLink();
 	iStatus = eyelink_is_connected();
+	PsychEyelinkUnlockLink();
 	
     // Allocate an output matrix.  Even if argument is not there, we still get the space.     
     PsychAllocOutDoubleArg(1, FALSE, &pfOutArg);
@@ -46,6 +46,7 @@ PURPOSE:
 PsychError EyelinkMessage(void)
 {
    int status = -1;
+   const char *msg;
    
    // All sub functions should have these two lines
    PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -59,7 +60,10 @@ PsychError EyelinkMessage(void)
    EyelinkSystemIsConnected();
    EyelinkSystemIsInitialized();
    
-   status = eyemsg_printf(PsychEyelinkParseToString(1));
+   msg = PsychEyelinkParseToString(1);
+   PsychEyelinkLockLink();
+   status = eyemsg_printf(msg);
+   PsychEyelinkUnlockLink();
 
    /* if there is an output variable available, assign eyecmd_printf status to it.   */
    PsychCopyOutDoubleArg(1, FALSE, status);
@@ -53,7 +53,9 @@ PsychError EyelinkNewFloatSampleAvailable(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    result = eyelink_newest_float_sample(NULL);
+   PsychEyelinkUnlockLink();
 
    PsychCopyOutDoubleArg(1, TRUE, result);
    
@@ -73,7 +73,9 @@ PsychError EyelinkNewestFloatSample(void)
 	//mexPrintf("EyelinkSystemIsInitialized\n");
 	
 	// Grab the sample
+	PsychEyelinkLockLink();
 	iSampleType=eyelink_newest_float_sample(&structFloatSample);
+	PsychEyelinkUnlockLink();
 	//mexPrintf("iSampleType is %d\n", iSampleType);
 	
 	mxOutArg = PsychGetOutArgMxPtr(1);
@@ -158,7 +160,9 @@ PsychError EyelinkNewestFloatSampleRaw(void)
 	mxOutArg[1] = PsychGetOutArgMxPtr(2);
 	
 	// Grab the sample
+	PsychEyelinkLockLink();
 	iSampleType=eyelink_newest_float_sample(&structFloatSample);
+	PsychEyelinkUnlockLink();
 	
 	if( iSampleType==1 || iSampleType==0 )
 	{
@@ -171,10 +175,14 @@ PsychError EyelinkNewestFloatSampleRaw(void)
 			}
 			TrackerOKForRawValues();
 			memset(&structFloatSampleRaw, 0, sizeof(structFloatSampleRaw));
+			PsychEyelinkLockLink();
 			eyelink_get_extra_raw_values_v2(&structFloatSample, eye, &structFloatSampleRaw);
+			PsychEyelinkUnlockLink();
 		} else {
 			mexPrintf("EYELINK: WARNING! Omission of the eye argument to NewestFloatSampleRaw is deprecated.\n");
+			PsychEyelinkLockLink();
 			eyelink_get_extra_raw_values(&structFloatSample, &structFloatSampleRaw); //deprecated as of Dec 1, 2006 (see eyelink sdk core_expt.h)
+			PsychEyelinkUnlockLink();
 		}
 		
 		// Can we assume that there is always a raw sample?
@@ -71,7 +71,9 @@ PsychError EyelinkOpenFile(void)
        }
    }
 
+   PsychEyelinkLockLink();
    iOpenFileStatus = open_data_file(filename);
+   PsychEyelinkUnlockLink();
    if (iOpenFileStatus!=0)
       mexPrintf("Eyelink openfile:  Cannot create EDF file '%s' errorcode : %d\n", filename, iOpenFileStatus);
  
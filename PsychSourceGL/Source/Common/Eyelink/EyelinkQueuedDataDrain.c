@@ -0,0 +1,296 @@
+/*
+	PsychSourceGL/Source/Common/Eyelink/EyelinkQueuedDataDrain.c
+
+	PROJECTS: Eyelink
+
+	PLATFORMS:	All
+
+	HISTORY:
+
+		Background drain thread for samples and events, feeding Eyelink('GetQueuedData').
+
+	TARGET LOCATION:
+
+		Eyelink.mexmac resides in:
+			PsychHardware/EyelinkToolbox
+ */
+
+#include "PsychEyelink.h"
+
+static char useStringStart[] = "Eyelink('StartQueuedDataDrain' [, ringSize=32768] [, eye])";
+
+static char synopsisStringStart[] =
+"starts a background thread which drains all samples and events from the link as soon as they arrive, and stores them with their receive time in a ring buffer of 'ringSize' items.\n"
+"Eyelink('GetQueuedData') then returns the contents of this ring, so the internal queue of the link can't overflow even if you call Eyelink('GetQueuedData') infrequently, e.g., only once per trial at 2000 Hz sampling rate.\n"
+"if the ring overflows, new items are dropped and a LOSTDATAEVENT is stored once space is available again.\n"
+"if you include the eye argument (as LEFT_EYE or RIGHT_EYE as returned by EyelinkInitDefaults), raw values are collected for that eye, see Eyelink('GetQueuedData').\n"
+"while the drain is active, Eyelink('GetNextDataType'), Eyelink('GetFloatData') and Eyelink('GetFloatDataRaw') can't be used, as the link queue is owned by the drain thread.\n"
+"neither can Eyelink('ImageModeDisplay'), Eyelink('StartSetup', 1) and Eyelink('DriftCorrStart', x, y, 1), which run the calibration display for a long time. all other subcommands can be used, they share access to the link with the drain thread.\n";
+
+static char seeAlsoStringStart[] = "GetQueuedData StopQueuedDataDrain";
+
+static char useStringStop[] = "[droppedItems, drainedItems] = Eyelink('StopQueuedDataDrain')";
+
+static char synopsisStringStop[] =
+"stops the background drain thread started via Eyelink('StartQueuedDataDrain').\n"
+"items which are still in its ring are returned by following calls to Eyelink('GetQueuedData').\n"
+"returns the number of items which were dropped due to ring overflow, and the total number of items drained from the link.\n";
+
+static char seeAlsoStringStop[] = "GetQueuedData StartQueuedDataDrain";
+
+// ring of drained items: single producer (drain thread), single consumer (GetQueuedData), so
+// it doesn't need a lock, only memory barriers between writing items and publishing positions.
+static PsychEyelinkQueuedItem	*ring = NULL;
+static unsigned int				ringSize = 0;
+static volatile unsigned int	ringWritePos = 0;
+static volatile unsigned int	ringReadPos = 0;
+
+static psych_thread				drainThread = (psych_thread) NULL;
+static volatile int				drainShutdown = 0;
+static int						drainEye = -1;
+static volatile unsigned int	droppedItems = 0;
+static volatile unsigned int	drainedItems = 0;
+
+// libeyelink is not thread-safe: while the drain thread runs, it and all subcommands of the main
+// thread only call into libeyelink with linkMutex held, see PsychEyelinkLockLink().
+static psych_mutex				linkMutex;
+static psych_bool				linkLocked = FALSE;
+
+static void* PsychEyelinkDrainThreadMain(void* unused)
+{
+	PsychEyelinkQueuedItem	*item, scratch;
+	psych_bool				lostPending = FALSE;
+	int						type, rc;
+	double					t;
+
+	PsychSetThreadName("EyelinkDrain");
+
+	// realtime priority, so we don't miss the link queue even under load:
+	if ((rc = PsychSetThreadPriority(NULL, 2, 1)) > 0) {
+		if (Verbosity() > 1) printf("Eyelink: StartQueuedDataDrain: failed to switch drain thread to realtime priority [%s]!\n", strerror(rc));
+	}
+
+	while (!drainShutdown) {
+		// only hold the link lock for one item, so subcommands of the main thread don't wait long:
+		PsychLockMutex(&linkMutex);
+
+		// the link api has no blocking wait for data, so sleep a bit if the queue is empty:
+		if ((type = eyelink_get_next_data(NULL)) == 0) {
+			PsychUnlockMutex(&linkMutex);
+			PsychYieldIntervalSeconds(0.0005);
+			continue;
+		}
+
+		PsychGetAdjustedPrecisionTimerSeconds(&t);
+		drainedItems++;
+
+		// mark dropped items once there is space in the ring again:
+		if (lostPending && (ringWritePos - ringReadPos < ringSize)) {
+			item = &ring[ringWritePos % ringSize];
+			item->type = LOST_DATA_EVENT;
+			item->hostTime = t;
+			PsychMemoryBarrier();
+			ringWritePos++;
+			lostPending = FALSE;
+		}
+
+		// ring full? still dequeue the item from the link, but drop it:
+		if (ringWritePos - ringReadPos >= ringSize) {
+			item = &scratch;
+			droppedItems++;
+			lostPending = TRUE;
+		} else {
+			item = &ring[ringWritePos % ringSize];
+		}
+
+		item->type = type;
+		item->hostTime = t;
+		if (type == SAMPLE_TYPE) {
+			eyelink_get_float_data(&(item->data.fs));
+			if (drainEye >= 0) {
+				memset(&(item->fr), 0, sizeof(item->fr));
+				eyelink_get_extra_raw_values_v2(&(item->data.fs), (INT16) drainEye, &(item->fr));
+			}
+		} else if (type != LOST_DATA_EVENT) {
+			// we are not supposed to call eyelink_get_float_data on LOST_DATA_EVENT
+			eyelink_get_float_data(&(item->data.fe));
+		}
+
+		PsychUnlockMutex(&linkMutex);
+
+		if (item != &scratch) {
+			// item must be complete before the consumer can see it:
+			PsychMemoryBarrier();
+			ringWritePos++;
+		}
+	}
+
+	return(NULL);
+}
+
+/* PsychEyelinkLockLink() and PsychEyelinkUnlockLink()
+ *
+ * Must bracket each call into libeyelink by the main thread, as the drain thread calls into it
+ * concurrently. Both are no-ops while no drain thread runs. If an error exit leaves the lock held,
+ * the main thread still owns it, and the next PsychEyelinkUnlockLink() releases it.
+ */
+void PsychEyelinkLockLink(void)
+{
+	if (drainThread && !linkLocked) {
+		PsychLockMutex(&linkMutex);
+		linkLocked = TRUE;
+	}
+}
+
+void PsychEyelinkUnlockLink(void)
+{
+	if (linkLocked) {
+		linkLocked = FALSE;
+		PsychUnlockMutex(&linkMutex);
+	}
+}
+
+psych_bool PsychEyelinkQueuedDataDrainRunning(void)
+{
+	return((drainThread) ? TRUE : FALSE);
+}
+
+psych_bool PsychEyelinkQueuedDataDrainActive(void)
+{
+	return((ring != NULL) ? TRUE : FALSE);
+}
+
+int PsychEyelinkQueuedDataDrainEye(void)
+{
+	return(drainEye);
+}
+
+unsigned int PsychEyelinkQueuedItemsAvailable(void)
+{
+	unsigned int n = ringWritePos - ringReadPos;
+
+	// items up to the write position must be visible before we read them:
+	PsychMemoryBarrier();
+	return(n);
+}
+
+const PsychEyelinkQueuedItem* PsychEyelinkGetQueuedItem(unsigned int i)
+{
+	return(&ring[(ringReadPos + i) % ringSize]);
+}
+
+void PsychEyelinkQueuedItemsRelease(unsigned int n)
+{
+	// we must be done with reading the items before the drain thread can reuse them:
+	PsychMemoryBarrier();
+	ringReadPos += n;
+
+	// drain stopped and ring emptied? release it, so GetQueuedData goes back to the link:
+	if (!drainThread && (ringReadPos == ringWritePos)) {
+		free(ring);
+		ring = NULL;
+		ringSize = 0;
+	}
+}
+
+void PsychEyelinkStopQueuedDataDrain(psych_bool discardItems)
+{
+	if (drainThread) {
+		drainShutdown = 1;
+		PsychEyelinkUnlockLink();
+		PsychDeleteThread(&drainThread);
+		drainThread = (psych_thread) NULL;
+		PsychDestroyMutex(&linkMutex);
+
+		if (Verbosity() > 3) printf("Eyelink: StopQueuedDataDrain: drained %i items, dropped %i items due to ring overflow.\n", drainedItems, droppedItems);
+	}
+
+	// nothing left for GetQueuedData, or items not wanted anymore? release ring:
+	if (ring && (discardItems || (ringReadPos == ringWritePos))) {
+		free(ring);
+		ring = NULL;
+		ringSize = 0;
+	}
+}
+
+PsychError EyelinkStartQueuedDataDrain(void)
+{
+	int size = 32768, eye = -1, rc;
+
+	//all sub functions should have these two lines
+	PsychPushHelp(useStringStart, synopsisStringStart, seeAlsoStringStart);
+	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+	//check to see if the user supplied superfluous arguments
+	PsychErrorExit(PsychCapNumInputArgs(2));
+	PsychErrorExit(PsychRequireNumInputArgs(0));
+	PsychErrorExit(PsychCapNumOutputArgs(0));
+
+	// Verify eyelink is up and running
+	EyelinkSystemIsConnected();
+	EyelinkSystemIsInitialized();
+
+	if (drainThread || ring) {
+		PsychErrorExitMsg(PsychError_user, "Eyelink: StartQueuedDataDrain: background drain already active, or items of previous drain not yet fetched via Eyelink('GetQueuedData').");
+	}
+
+	PsychCopyInIntegerArg(1, kPsychArgOptional, &size);
+	if (size < 1) PsychErrorExitMsg(PsychErorr_argumentValueOutOfRange, "Eyelink: StartQueuedDataDrain: ringSize must be at least 1.");
+
+	if (PsychCopyInIntegerArg(2, kPsychArgOptional, &eye)) {
+		if (eye!=LEFT_EYE && eye!=RIGHT_EYE) {
+			PsychErrorExitMsg(PsychErorr_argumentValueOutOfRange, "Eyelink: StartQueuedDataDrain: eye argument must be LEFT_EYE or RIGHT_EYE as returned by EyelinkInitDefaults\n");
+		}
+
+		TrackerOKForRawValues();
+	}
+
+	ring = (PsychEyelinkQueuedItem*) calloc(size, sizeof(PsychEyelinkQueuedItem));
+	if (NULL == ring) PsychErrorExitMsg(PsychError_outofMemory, "Eyelink: StartQueuedDataDrain: out of memory for ring buffer.");
+
+	ringSize = (unsigned int) size;
+	ringWritePos = ringReadPos = 0;
+	droppedItems = drainedItems = 0;
+	drainEye = eye;
+	drainShutdown = 0;
+	linkLocked = FALSE;
+
+	if ((rc = PsychInitMutex(&linkMutex))) {
+		free(ring);
+		ring = NULL;
+		ringSize = 0;
+		printf("Eyelink: StartQueuedDataDrain: failed to create link lock [%s].\n", strerror(rc));
+		PsychErrorExitMsg(PsychError_system, "Eyelink: StartQueuedDataDrain: failed to create link lock.");
+	}
+
+	if ((rc = PsychCreateThread(&drainThread, NULL, PsychEyelinkDrainThreadMain, NULL))) {
+		drainThread = (psych_thread) NULL;
+		PsychDestroyMutex(&linkMutex);
+		free(ring);
+		ring = NULL;
+		ringSize = 0;
+		printf("Eyelink: StartQueuedDataDrain: failed to create drain thread [%s].\n", strerror(rc));
+		PsychErrorExitMsg(PsychError_system, "Eyelink: StartQueuedDataDrain: failed to create drain thread.");
+	}
+
+	return(PsychError_none);
+}
+
+PsychError EyelinkStopQueuedDataDrain(void)
+{
+	//all sub functions should have these two lines
+	PsychPushHelp(useStringStop, synopsisStringStop, seeAlsoStringStop);
+	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+	//check to see if the user supplied superfluous arguments
+	PsychErrorExit(PsychCapNumInputArgs(0));
+	PsychErrorExit(PsychRequireNumInputArgs(0));
+	PsychErrorExit(PsychCapNumOutputArgs(2));
+
+	PsychEyelinkStopQueuedDataDrain(FALSE);
+
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) droppedItems);
+	PsychCopyOutDoubleArg(2, kPsychArgOptional, (double) drainedItems);
+
+	return(PsychError_none);
+}
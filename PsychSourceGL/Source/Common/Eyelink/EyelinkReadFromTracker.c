@@ -53,6 +53,7 @@ PsychError EyelinkReadFromTracker(void)
 	
 	PsychAllocInCharArg(1, TRUE, &varbuf);
 	
+	PsychEyelinkLockLink();
 	result = eyelink_read_request(varbuf);
 	
 	if (!result){
@@ -66,10 +67,13 @@ PsychError EyelinkReadFromTracker(void)
 				break;
 			}
             
-            // OS friendly wait for at least 1 msec before retry:
+            // OS friendly wait for at least 1 msec before retry, without blocking a drain thread:
+            PsychEyelinkUnlockLink();
             PsychYieldIntervalSeconds(0.001);
+            PsychEyelinkLockLink();
 		}
 	}
+	PsychEyelinkUnlockLink();
 
 	PsychCopyOutDoubleArg(1, TRUE, result);
 	PsychCopyOutCharArg(2, TRUE, replybuf);	
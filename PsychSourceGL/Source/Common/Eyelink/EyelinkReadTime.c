@@ -55,7 +55,9 @@ PsychError EyelinkReadTime(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    time = eyelink_read_time();
+   PsychEyelinkUnlockLink();
    
    PsychCopyOutDoubleArg(1, FALSE, time);
    
@@ -59,7 +59,9 @@ PsychError EyelinkRequestTime(void)
 	EyelinkSystemIsInitialized();
 	
 	
+	PsychEyelinkLockLink();
 	iStatus = eyelink_request_time();
+	PsychEyelinkUnlockLink();
 	
 	PsychCopyOutDoubleArg(1, FALSE, iStatus);
 	
@@ -79,7 +79,9 @@ PsychError EyelinkSendKeyButton(void)
 	PsychCopyInIntegerArg(2, TRUE, &iMods);
 	PsychCopyInIntegerArg(3, TRUE, &iState);
 	
+	PsychEyelinkLockLink();
 	iResult = (int) eyelink_send_keybutton((UINT16) iCode, (UINT16) iMods, (INT16) iState);
+	PsychEyelinkUnlockLink();
 //	iResult = eyelink_send_keybutton(cCode, iMods, iState);
 	
 	// Copy out arg
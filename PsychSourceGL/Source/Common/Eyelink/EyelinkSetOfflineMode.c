@@ -50,7 +50,9 @@ PsychError EyelinkSetOfflineMode(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    set_offline_mode();
+   PsychEyelinkUnlockLink();
    
    return(PsychError_none);
 }
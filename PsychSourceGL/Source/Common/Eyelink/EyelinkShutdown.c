@@ -29,6 +29,9 @@ PsychError PsychEyelinkShutdown(void)
 	char	strMsg[256];
 
 	if (giSystemInitialized) {
+		// Stop background drain of samples and events, if any:
+		PsychEyelinkStopQueuedDataDrain(TRUE);
+
 		// Zero-out return string:
 		memset(strMsg, 0, sizeof(strMsg));
 		
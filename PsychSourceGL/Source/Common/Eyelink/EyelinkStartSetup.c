@@ -64,12 +64,15 @@ PsychError EyelinkStartSetup(void)
     PsychCopyInIntegerArg(1, FALSE, &iResult);
 
     if (iResult > 0) {
-        // New behaviour:
+        // New behaviour: Runs our calibration callbacks for a long time, so not while the drain owns the link.
+        if (PsychEyelinkQueuedDataDrainRunning()) PsychErrorExitMsg(PsychError_user, "Eyelink: StartSetup: can't run do_tracker_setup() while a background drain via Eyelink('StartQueuedDataDrain') is active. Stop it first.");
         iResult = do_tracker_setup();
     }
     else {
         // Standard behaviour:
+    	PsychEyelinkLockLink();
     	iResult = eyelink_start_setup();
+    	PsychEyelinkUnlockLink();
     }
 
 	// Copy out result
@@ -56,7 +56,9 @@ PsychError EyelinkStopRecording(void)
 	EyelinkSystemIsConnected();
 	//EyelinkSystemIsInitialized();
 
+	PsychEyelinkLockLink();
 	stop_recording();
+	PsychEyelinkUnlockLink();
 	
 	return(PsychError_none); 
 }
@@ -79,7 +79,9 @@ void InitializeSynopsis()
 	synopsis[i++] = "type = Eyelink('GetNextDataType')";
 	synopsis[i++]  = "item = Eyelink('GetFloatData', type)";
 	synopsis[i++]  = "[item, raw] = Eyelink('GetFloatDataRaw', type [, eye])";
-	synopsis[i++]  = "[samples, events, drained] = Eyelink('GetQueuedData'[, eye])";
+	synopsis[i++]  = "[samples, events, drained, sampleTimes, eventTimes] = Eyelink('GetQueuedData'[, eye])";
+	synopsis[i++]  = "Eyelink('StartQueuedDataDrain' [, ringSize=32768] [, eye])";
+	synopsis[i++]  = "[droppedItems, drainedItems] = Eyelink('StopQueuedDataDrain')";
     
 	// Misc eyelink communication:
 	synopsis[i++] = "\n% Miscellaneous functions to communicate with Eyelink:";
@@ -56,7 +56,9 @@ PsychError EyelinkTimeOffset(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    offset = eyelink_double_usec_offset()/1000;
+   PsychEyelinkUnlockLink();
    
    PsychCopyOutDoubleArg(1, FALSE, offset);
    
@@ -47,7 +47,9 @@ PsychError EyelinkTrackerMode(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+	PsychEyelinkLockLink();
 	mode = eyelink_tracker_mode();
+	PsychEyelinkUnlockLink();
 
 	PsychCopyOutDoubleArg(1, FALSE, mode);
 
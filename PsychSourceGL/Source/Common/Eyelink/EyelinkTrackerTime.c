@@ -55,7 +55,9 @@ PsychError EyelinkTrackerTime(void)
 	EyelinkSystemIsConnected();
 	EyelinkSystemIsInitialized();
 
+   PsychEyelinkLockLink();
    time = eyelink_tracker_double_usec()/1000000;
+   PsychEyelinkUnlockLink();
    
    PsychCopyOutDoubleArg(1, FALSE, time);
    
@@ -62,7 +62,9 @@ PsychError EyelinkWaitForModeReady(void)
 
    PsychCopyInIntegerArg(1, TRUE, &maxwait);      
    
+   PsychEyelinkLockLink();
    result = eyelink_wait_for_mode_ready(maxwait);
+   PsychEyelinkUnlockLink();
 
    /* if there is an output variable available, assign result to it.   */
    PsychCopyOutDoubleArg(1, FALSE, result);
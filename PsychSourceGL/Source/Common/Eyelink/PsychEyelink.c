@@ -79,7 +79,9 @@ static void ELCALLBACK   PsychEyelink_dc_target_beep_hook(void);
 PsychError EyelinkSystemIsConnected(void)
 {
 	int iStatus=-9999;
+	PsychEyelinkLockLink();
 	iStatus=eyelink_is_connected();
+	PsychEyelinkUnlockLink();
 //	mexPrintf("EyelinkSystemIsConnected status %d ((iStatus==0)=%d)\n", iStatus, (iStatus==0) );
 	if (iStatus==0) {
 		PsychErrorExitMsg(PsychError_user, "Eyelink system is not connected!\n");
@@ -73,6 +73,17 @@ typedef psych_uint32 UInt32;
 
 extern int		giSystemInitialized;
 
+// One sample or event, drained from the link by the background drain thread:
+typedef struct PsychEyelinkQueuedItem {
+	double		hostTime;	// GetSecs time of reception from the link.
+	int			type;		// SAMPLE_TYPE, LOST_DATA_EVENT or event type.
+	union {
+		FSAMPLE	fs;
+		FEVENT	fe;
+	} data;
+	FSAMPLE_RAW	fr;			// Raw values, if the drain was started for an eye.
+} PsychEyelinkQueuedItem;
+
 /////////////////////////////////////////////////////////////////////////
 //		Eyelink Function prototypes
 
@@ -106,6 +117,17 @@ PsychError PsychEyelinkShutdown(void);
 // Helpers
 psych_bool TrackerOKForRawValues(void); //defined in EyelinkGetQueuedData.c
 
+// Defined in EyelinkQueuedDataDrain.c
+psych_bool PsychEyelinkQueuedDataDrainActive(void);
+psych_bool PsychEyelinkQueuedDataDrainRunning(void);
+void PsychEyelinkLockLink(void);
+void PsychEyelinkUnlockLink(void);
+int PsychEyelinkQueuedDataDrainEye(void);
+unsigned int PsychEyelinkQueuedItemsAvailable(void);
+const PsychEyelinkQueuedItem* PsychEyelinkGetQueuedItem(unsigned int i);
+void PsychEyelinkQueuedItemsRelease(unsigned int n);
+void PsychEyelinkStopQueuedDataDrain(psych_bool discardItems);
+
 // Eyelink Target sub-commands
 PsychError EyelinkButtonStates(void);
 PsychError EyelinkCommand(void);
@@ -144,6 +166,8 @@ PsychError EyelinkGetNextDataType(void);
 PsychError EyelinkGetFloatData(void);
 PsychError EyelinkGetFloatDataRaw(void);
 PsychError EyelinkGetQueuedData(void);
+PsychError EyelinkStartQueuedDataDrain(void);
+PsychError EyelinkStopQueuedDataDrain(void);
 
 PsychError EyelinkTrackerTime(void);
 PsychError EyelinkTimeOffset(void);
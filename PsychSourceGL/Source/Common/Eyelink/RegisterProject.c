@@ -100,6 +100,8 @@ PsychError PsychModuleInit(void)
     
 	// added as of 22/03/09
 	PsychErrorExit(PsychRegister("GetQueuedData", &EyelinkGetQueuedData));
+	PsychErrorExit(PsychRegister("StartQueuedDataDrain", &EyelinkStartQueuedDataDrain));
+	PsychErrorExit(PsychRegister("StopQueuedDataDrain", &EyelinkStopQueuedDataDrain));
 	PsychErrorExit(PsychRegister("Verbosity", &EyelinkVerbosity));
 	PsychErrorExit(PsychRegister("TestSuite", &EyelinkTestSuite));
 	
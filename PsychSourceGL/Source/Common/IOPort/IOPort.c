@@ -57,8 +57,11 @@ void InitializeSynopsis(void)
     synopsis[i++] = "IOPort('Close', handle);";
     synopsis[i++] = "IOPort('CloseAll');";
     synopsis[i++] = "[nwritten, when, errmsg, prewritetime, postwritetime, lastchecktime] = IOPort('Write', handle, data [, blocking=1]);";
+    synopsis[i++] = "[ticket, errmsg] = IOPort('WriteAsync', handle, data [, when=0]);";
+    synopsis[i++] = "[done, nwritten, when, errmsg, prewritetime, postwritetime] = IOPort('WriteAsyncResult', handle, ticket [, waitForCompletion=0]);";
     synopsis[i++] = "IOPort('Flush', handle);";
     synopsis[i++] = "[data, when, errmsg] = IOPort('Read', handle [, blocking=0] [, amount]);";
+    synopsis[i++] = "[data, when, lengths, errmsg] = IOPort('ReadPackets', handle [, blocking=0] [, maxPackets]);";
     synopsis[i++] = "navailable = IOPort('BytesAvailable', handle);";
     synopsis[i++] = "IOPort('Purge', handle);";
 
@@ -225,6 +228,60 @@ int PsychReadIOPort(int handle, void** readbuffer, unsigned int amount, int bloc
     return(0);
 }
 
+int PsychWriteAsyncIOPort(int handle, void* writedata, unsigned int amount, double when, char* errmsg)
+{
+    PsychPortIORecord* portRecord = PsychGetPortIORecord(handle);
+
+    switch(portRecord->portType) {
+        case kPsychIOPortSerial:
+            // Queue write to serial port:
+            return(PsychIOOSWriteSerialPortAsync(portRecord->device, writedata, amount, when, errmsg));
+        break;
+
+        default:
+            PsychErrorExitMsg(PsychError_internal, "Unknown portType - Unsupported.");
+    }
+
+    // Not reached, just to make compiler happy:
+    return(0);
+}
+
+int PsychWriteAsyncResultIOPort(int handle, int ticket, int waitForCompletion, char* errmsg, double* timestamps, int* nwritten)
+{
+    PsychPortIORecord* portRecord = PsychGetPortIORecord(handle);
+
+    switch(portRecord->portType) {
+        case kPsychIOPortSerial:
+            // Query async write to serial port:
+            return(PsychIOOSWriteSerialPortAsyncResult(portRecord->device, ticket, waitForCompletion, errmsg, timestamps, nwritten));
+        break;
+
+        default:
+            PsychErrorExitMsg(PsychError_internal, "Unknown portType - Unsupported.");
+    }
+
+    // Not reached, just to make compiler happy:
+    return(0);
+}
+
+int PsychReadPacketsIOPort(int handle, unsigned int maxPackets, psych_bool maxPacketsGiven, int blocking, char* errmsg, PsychIOPortPackets* packets)
+{
+    PsychPortIORecord* portRecord = PsychGetPortIORecord(handle);
+
+    switch(portRecord->portType) {
+        case kPsychIOPortSerial:
+            // Read packets from serial port:
+            return(PsychIOOSReadSerialPortPackets(portRecord->device, maxPackets, maxPacketsGiven, blocking, errmsg, packets));
+        break;
+
+        default:
+            PsychErrorExitMsg(PsychError_internal, "Unknown portType - Unsupported.");
+    }
+
+    // Not reached, just to make compiler happy:
+    return(0);
+}
+
 int PsychBytesAvailableIOPort(int handle)
 {
     PsychPortIORecord* portRecord = PsychGetPortIORecord(handle);
@@ -403,6 +460,17 @@ PsychError IOPORTOpenSerialPort(void)
         "thread do all data collection in the background and collect the data at the end of a session with a sequence of "
         "IOPort('Read') calls. This way, data collection doesn't clutter your main experiment script.\n\n"
         "BlockingBackgroundRead=0 -- Perform blocking background reads instead of polling reads, if set to 1.\n\n"
+        "FramingMode=None -- Select an event driven background reader which splits the input into packets, instead of the "
+        "polling reader. Must be set before 'StartBackgroundRead'. Not supported on MS-Windows. The reader sleeps until data "
+        "arrives, so it has lower latency and cpu load than the polling reader, even at high data rates. Each packet is "
+        "stored zero-padded in a 'readGranularity' bytes slot, with its length and a timestamp of the reception of its first byte. "
+        "Use IOPort('ReadPackets') to fetch many packets at once. 'PollLatency', 'BlockingBackgroundRead' and "
+        "'ReadFilterFlags' don't apply in this mode. Possible settings:\n"
+        "* None -- No framing, use the polling reader. This is the default.\n"
+        "* Fixed -- Each packet is exactly 'readGranularity' bytes.\n"
+        "* Terminator -- Each packet ends with the 'Terminator' character, or after 'readGranularity' bytes.\n"
+        "* LengthPrefix -- The first byte of each packet is the number of following payload bytes. Packets longer than "
+        "'readGranularity' bytes are truncated.\n\n"
         "StopBackgroundRead -- Stop running background read operation, discard all pending data.\n\n"
         "ReadFilterFlags=0 -- Special flags to specify certain post-processing operations on read input data.\n"
         "* A setting of 1 will enable special filtering for serial input data from the CMU or PST response button boxes. "
@@ -603,6 +671,84 @@ PsychError IOPORTRead(void)
     return(PsychError_none);
 }
 
+PsychError IOPORTReadPackets(void)
+{
+    static char useString[] = "[data, when, lengths, errmsg] = IOPort('ReadPackets', handle [, blocking=0] [, maxPackets]);";
+    static char synopsisString[] =
+        "Read packets from device, specified by 'handle', which has a background read operation with a 'FramingMode' "
+        "running (see help for 'OpenSerialPort').\n"
+        "Returned 'data' will be a uint8 matrix with one column of 'readGranularity' bytes per packet, oldest packet "
+        "first. Packets shorter than 'readGranularity' are zero-padded. 'when' is a row vector with the receive "
+        "timestamp of the first byte of each packet. 'lengths' is a row vector with the number of valid bytes of "
+        "each packet. 'errmsg' will be a human readable char string with an error message if any error occured, "
+        "otherwise an empty string.\n"
+        "The optional flag 'blocking' if set to 0 will return immediately with all packets currently available, "
+        "but at most 'maxPackets' if 'maxPackets' is specified. This is the default. If 'blocking' is set to 1, "
+        "the function will wait until 'maxPackets' are available, or at least one packet if 'maxPackets' is omitted, "
+        "but at most for the 'ReadTimeout'.\n"
+        "This is much faster than fetching packets one by one via 'Read', if many packets are pending.";
+
+    static char seeAlsoString[] = "'Read', 'OpenSerialPort', 'ConfigureSerialPort'";
+
+    char errmsg[1024];
+    int handle, blocking, maxPackets, i, j, n;
+    psych_bool maxPacketsGiven;
+    unsigned int seg;
+    PsychIOPortPackets packets;
+    psych_uint8* outdata;
+    double *outwhen, *outlengths;
+    errmsg[0] = 0;
+
+    // Setup online help:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
+    PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs
+    PsychErrorExit(PsychCapNumOutputArgs(4));    // The maximum number of outputs
+
+    // Get required port handle:
+    PsychCopyInIntegerArg(1, kPsychArgRequired, &handle);
+
+    // Get optional blocking flag: Defaults to 0 -- non-blocking.
+    blocking = 0;
+    PsychCopyInIntegerArg(2, kPsychArgOptional, &blocking);
+
+    // Get optional maximum number of packets to read:
+    maxPackets = INT_MAX;
+    maxPacketsGiven = PsychCopyInIntegerArg(3, kPsychArgOptional, &maxPackets);
+    if (maxPackets < 1) PsychErrorExitMsg(PsychError_user, "Invalid 'maxPackets' to read! Must be at least 1.");
+
+    // Read packets:
+    n = PsychReadPacketsIOPort(handle, (unsigned int) maxPackets, maxPacketsGiven, blocking, errmsg, &packets);
+    if (n < 0) {
+        if (verbosity > 0) printf("IOPort: Error: %s\n", errmsg);
+        n = 0;
+    }
+
+    // Copy both segments of packets from the input buffer directly into the output arguments:
+    PsychAllocOutUnsignedByteMatArg(1, kPsychArgOptional, (n > 0) ? packets.packetSize : 0, n, 1, &outdata);
+    PsychAllocOutDoubleMatArg(2, kPsychArgOptional, 1, n, 1, &outwhen);
+    PsychAllocOutDoubleMatArg(3, kPsychArgOptional, 1, n, 1, &outlengths);
+
+    for (seg = 0; seg < 2 && n > 0; seg++) {
+        i = (seg == 0) ? packets.firstCount : packets.count - packets.firstCount;
+        if (i == 0) continue;
+
+        memcpy(outdata, packets.data[seg], (size_t) i * packets.packetSize);
+        memcpy(outwhen, packets.timeStamps[seg], (size_t) i * sizeof(double));
+        for (j = 0; j < i; j++) outlengths[j] = (double) packets.lengths[seg][j];
+
+        outdata += (size_t) i * packets.packetSize;
+        outwhen += i;
+        outlengths += i;
+    }
+
+    PsychCopyOutCharArg(4, kPsychArgOptional, errmsg);
+
+    return(PsychError_none);
+}
+
 PsychError IOPORTWrite(void)
 {
     static char useString[] = "[nwritten, when, errmsg, prewritetime, postwritetime, lastchecktime] = IOPort('Write', handle, data [, blocking=1]);";
@@ -622,7 +768,8 @@ PsychError IOPORTWrite(void)
         "Another even more agressive polling method is implemented via blocking == 3 on "
         "Linux systems with some limited set of hardware, e.g., real native serial ports.\n"
         "On systems without any support for specific polling modes, the 2 or 3 settings are treated "
-        "as a standard blocking write.\n\n"
+        "as a standard blocking write. The polling modes keep a cpu core busy for the duration "
+        "of the write. See IOPort('WriteAsync') for a cpu friendly alternative with accurate timestamps.\n\n"
         "Optionally, the function returns the following return arguments:\n"
         "'nwritten' Number of bytes written -- Should match amount of data provided on success.\n"
         "'when' A timestamp of write completion: This is only meaningful in blocking mode!\n"
@@ -632,7 +779,7 @@ PsychError IOPORTWrite(void)
         "'postwritetime' A timestamp taken immediately after submitting the write request. "
         "'lastchecktime' A timestamp taken at the time of last check for write completion if applicable. ";
 
-    static char seeAlsoString[] = "";
+    static char seeAlsoString[] = "'WriteAsync'";
 
     char errmsg[1024];
     int handle, blocking, m, n, p, nwritten;
@@ -690,6 +837,132 @@ PsychError IOPORTWrite(void)
     return(PsychError_none);
 }
 
+PsychError IOPORTWriteAsync(void)
+{
+    static char useString[] = "[ticket, errmsg] = IOPort('WriteAsync', handle, data [, when=0]);";
+    static char synopsisString[] =
+        "Queue data for writing to device, specified by 'handle', and return immediately.\n"
+        "'data' must be a vector or matrix of uint8 data items or a char string, as for IOPort('Write'). "
+        "The data is copied, so you can change it right after the call. A background thread writes queued "
+        "data in order of submission and waits for completion of each write without burdening the cpu, "
+        "so this is a cpu friendly alternative to 'Write' with 'blocking' modes 2 or 3.\n"
+        "If the optional 'when' is greater than zero, the write will start at GetSecs time 'when', "
+        "otherwise as soon as possible.\n"
+        "Returns a 'ticket' number for the write, to be used with IOPort('WriteAsyncResult'), "
+        "or -1 and an error message 'errmsg' if the write could not be queued. At most 64 writes "
+        "can be pending at any time. Pending writes are discarded on close of the port.\n"
+        "Not supported on MS-Windows.";
+
+    static char seeAlsoString[] = "'WriteAsyncResult', 'Write'";
+
+    char errmsg[1024];
+    int handle, m, n, p, ticket;
+    psych_uint8* inData = NULL;
+    char* inChars = NULL;
+    void* writedata = NULL;
+    double when;
+    errmsg[0] = 0;
+
+    // Setup online help:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
+    PsychErrorExit(PsychRequireNumInputArgs(2)); // The required number of inputs
+    PsychErrorExit(PsychCapNumOutputArgs(2));    // The maximum number of outputs
+
+    // Get required port handle:
+    PsychCopyInIntegerArg(1, kPsychArgRequired, &handle);
+
+    // Get the data:
+    switch(PsychGetArgType(2)) {
+        case PsychArgType_uint8:
+            PsychAllocInUnsignedByteMatArg(2, kPsychArgRequired, &m, &n, &p, &inData);
+            if (p!=1 || m * n == 0) PsychErrorExitMsg(PsychError_user, "'data' is not a vector or 2D matrix, but some higher dimensional matrix!");
+            n = m * n;
+            writedata = (void*) inData;
+        break;
+
+        case PsychArgType_char:
+            PsychAllocInCharArg(2, kPsychArgRequired, &inChars);
+            n = strlen(inChars);
+            writedata = (void*) inChars;
+        break;
+
+        default:
+            PsychErrorExitMsg(PsychError_user, "Invalid type for 'data' vector: Must be an uint8 or char vector.");
+    }
+
+    // Get optional target time: Defaults to zero -- asap.
+    when = 0;
+    PsychCopyInDoubleArg(3, kPsychArgOptional, &when);
+
+    // Queue write:
+    ticket = PsychWriteAsyncIOPort(handle, writedata, n, when, errmsg);
+    if (ticket < 0 && verbosity > 0) printf("IOPort: Error: %s\n", errmsg);
+
+    PsychCopyOutDoubleArg(1, kPsychArgOptional, ticket);
+    PsychCopyOutCharArg(2, kPsychArgOptional, errmsg);
+
+    return(PsychError_none);
+}
+
+PsychError IOPORTWriteAsyncResult(void)
+{
+    static char useString[] = "[done, nwritten, when, errmsg, prewritetime, postwritetime] = IOPort('WriteAsyncResult', handle, ticket [, waitForCompletion=0]);";
+    static char synopsisString[] =
+        "Query results of a write to device, specified by 'handle', queued via IOPort('WriteAsync').\n"
+        "'ticket' is the ticket number returned by IOPort('WriteAsync'). Results are available for the "
+        "last 64 queued writes. If the optional flag 'waitForCompletion' is set to 1, the function waits "
+        "until the write is completed, otherwise it returns immediately. The wait ends at the latest once the "
+        "configuration setting 'ReadTimeout' of the port has passed after the target time of the write, or "
+        "after the call if that is later. Then 'done' is 0 and 'errmsg' reports the timeout.\n"
+        "'done' is 1 if the write is completed, 0 if it is still pending, or -1 on error. The other return "
+        "arguments are only meaningful if 'done' is 1:\n"
+        "'nwritten' Number of bytes written -- Should match amount of data provided on success.\n"
+        "'when' A timestamp of write completion, taken after the data was transmitted.\n"
+        "'errmsg' A system defined error message if something wen't wrong.\n"
+        "'prewritetime' A timestamp taken immediately before submitting the write request. For writes with a "
+        "target time, you can compare it to the target time to check the accuracy of scheduling.\n"
+        "'postwritetime' A timestamp taken immediately after submitting the write request.";
+
+    static char seeAlsoString[] = "'WriteAsync', 'Write'";
+
+    char errmsg[1024];
+    int handle, ticket, waitForCompletion, done;
+    int nwritten = 0;
+    double timestamps[3] = {0, 0, 0};
+    errmsg[0] = 0;
+
+    // Setup online help:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
+    PsychErrorExit(PsychRequireNumInputArgs(2)); // The required number of inputs
+    PsychErrorExit(PsychCapNumOutputArgs(6));    // The maximum number of outputs
+
+    // Get required port handle and ticket:
+    PsychCopyInIntegerArg(1, kPsychArgRequired, &handle);
+    PsychCopyInIntegerArg(2, kPsychArgRequired, &ticket);
+
+    // Get optional wait flag: Defaults to zero -- don't wait.
+    waitForCompletion = 0;
+    PsychCopyInIntegerArg(3, kPsychArgOptional, &waitForCompletion);
+
+    done = PsychWriteAsyncResultIOPort(handle, ticket, waitForCompletion, errmsg, timestamps, &nwritten);
+    if (done < 0 && verbosity > 0) printf("IOPort: Error: %s\n", errmsg);
+
+    PsychCopyOutDoubleArg(1, kPsychArgOptional, done);
+    PsychCopyOutDoubleArg(2, kPsychArgOptional, nwritten);
+    PsychCopyOutDoubleArg(3, kPsychArgOptional, timestamps[2]);
+    PsychCopyOutCharArg(4, kPsychArgOptional, errmsg);
+    PsychCopyOutDoubleArg(5, kPsychArgOptional, timestamps[0]);
+    PsychCopyOutDoubleArg(6, kPsychArgOptional, timestamps[1]);
+
+    return(PsychError_none);
+}
+
 PsychError IOPORTBytesAvailable(void)
 {
     static char useString[] = "navailable = IOPort('BytesAvailable', handle);";
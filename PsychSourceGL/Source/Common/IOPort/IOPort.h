@@ -41,6 +41,12 @@
 #define kPsychIOPortCRLFFiltering               2            // Filtering for USB/32 Bitwhacker with StickOS.
 #define kPsychIOPortAsyncLineBufferFiltering    4            // Filtering for emulation of line-buffering, like in "cooked" Unixish canonical input processing.
 
+// Packet framing modes for background reads:
+#define kPsychIOPortFramingNone                 0            // No framing, classic byte stream.
+#define kPsychIOPortFramingFixed                1            // Fixed length packets of readGranularity bytes.
+#define kPsychIOPortFramingTerminator           2            // Packets end with the line terminator byte, or after readGranularity bytes.
+#define kPsychIOPortFramingLengthPrefix         3            // First byte of each packet is the number of following payload bytes.
+
 // Types of Input/Output port we support:
 #define KPsychIOPortNone        0                // No port: This indicates a free slot.
 #define kPsychIOPortSerial      1                // Serial port.
@@ -50,12 +56,26 @@ typedef struct PsychPortIORecord {
     void*               device;         // Opaque pointer to struct with device specific data - Different types need different structs...
 } PsychPortIORecord;
 
+// Framed packets returned by a packet read: Pointers into the input ring buffer, which wrap around
+// at most once, so the packets are split into a first and a second segment of consecutive packets:
+typedef struct PsychIOPortPackets {
+    unsigned int        count;          // Number of returned packets.
+    unsigned int        firstCount;     // Number of packets in first segment. The remainder is in the second segment.
+    unsigned int        packetSize;     // Size of each packet slot in bytes. Shorter packets are zero-padded.
+    unsigned char*      data[2];        // Packet data of both segments.
+    double*             timeStamps[2];  // Receive timestamps of both segments.
+    int*                lengths[2];     // Valid bytes per packet of both segments.
+} PsychIOPortPackets;
+
 // Operating system specific glue functions:
 PsychSerialDeviceRecord* PsychIOOSOpenSerialPort(const char* portSpec, const char* configString, char* errmsg);
 void PsychIOOSCloseSerialPort(PsychSerialDeviceRecord* device);
 PsychError PsychIOOSConfigureSerialPort(PsychSerialDeviceRecord* device, const char* configString);
 int PsychIOOSWriteSerialPort(PsychSerialDeviceRecord* device, void* writedata, unsigned int amount, int blocking, char* errmsg, double* timestamp);
 int PsychIOOSReadSerialPort(PsychSerialDeviceRecord* device, void** readdata, unsigned int amount, int blocking, char* errmsg, double* timestamp);
+int PsychIOOSWriteSerialPortAsync(PsychSerialDeviceRecord* device, void* writedata, unsigned int amount, double when, char* errmsg);
+int PsychIOOSWriteSerialPortAsyncResult(PsychSerialDeviceRecord* device, int ticket, int waitForCompletion, char* errmsg, double* timestamps, int* nwritten);
+int PsychIOOSReadSerialPortPackets(PsychSerialDeviceRecord* device, unsigned int maxPackets, psych_bool maxPacketsGiven, int blocking, char* errmsg, PsychIOPortPackets* packets);
 int PsychIOOSBytesAvailableSerialPort(PsychSerialDeviceRecord* device);
 void PsychIOOSFlushSerialPort(PsychSerialDeviceRecord* device);
 void PsychIOOSPurgeSerialPort(PsychSerialDeviceRecord* device);
@@ -74,7 +94,10 @@ PsychError IOPORTVerbosity(void);
 PsychError IOPORTClose(void);
 PsychError IOPORTCloseAll(void);
 PsychError IOPORTRead(void);
+PsychError IOPORTReadPackets(void);
 PsychError IOPORTWrite(void);
+PsychError IOPORTWriteAsync(void);
+PsychError IOPORTWriteAsyncResult(void);
 PsychError IOPORTBytesAvailable(void);
 PsychError IOPORTPurge(void);
 PsychError IOPORTFlush(void);
@@ -95,6 +118,9 @@ PsychError PsychCloseIOPort(int handle);
 // Write function:
 int PsychWriteIOPort(int handle, void* writedata, unsigned int amount, int blocking, char* errmsg, double* timestamp);
 int    PsychReadIOPort(int handle, void** readbuffer, unsigned int amount, int blocking, char* errmsg, double* timestamp);
+int PsychWriteAsyncIOPort(int handle, void* writedata, unsigned int amount, double when, char* errmsg);
+int PsychWriteAsyncResultIOPort(int handle, int ticket, int waitForCompletion, char* errmsg, double* timestamps, int* nwritten);
+int PsychReadPacketsIOPort(int handle, unsigned int maxPackets, psych_bool maxPacketsGiven, int blocking, char* errmsg, PsychIOPortPackets* packets);
 int PsychBytesAvailableIOPort(int handle);
 void PsychPurgeIOPort(int handle);
 void PsychFlushIOPort(int handle);
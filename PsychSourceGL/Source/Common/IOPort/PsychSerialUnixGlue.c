@@ -473,8 +473,176 @@ void* PsychSerialUnixGlueReaderThreadMain( void* deviceToCast)
     return(NULL);
 }
 
+/* PsychSerialUnixGlueFramingReaderThreadMain() -- Event driven background reader with packet framing.
+ *
+ * Sleeps in poll() on the serial port and on the wakeup fd until new data arrives or
+ * shutdown is requested, instead of polling or blocking on single bytes. Each wakeup takes
+ * a timestamp, fetches all pending data with one read() and splits it into packets according
+ * to device->framingMode. Each packet is stored in its own readGranularity slot of the input
+ * ring buffer, zero-padded, together with its length and the timestamp of the wakeup which
+ * delivered its first byte.
+ */
+void* PsychSerialUnixGlueFramingReaderThreadMain(void* deviceToCast)
+{
+    int rc, nread, i, n, slot;
+    int pktLen = 0, pktExpected = 0, skip = 0;
+    unsigned char* pkt = NULL;
+    unsigned char* p;
+    unsigned char chunk[4096];
+    struct pollfd fds[2];
+    double t, pktTime = 0;
+    psych_bool done;
+
+    // Get a handle to our device struct: These pointers must not be NULL!!!
+    PsychSerialDeviceRecord* device = (PsychSerialDeviceRecord*) deviceToCast;
+    int granularity = device->readGranularity;
+
+    // Assign a name to ourselves, for debugging:
+    PsychSetThreadName("IOPortSerialRd");
+
+    // Try to raise our priority: We ask to switch ourselves (NULL) to priority class 2 aka
+    // realtime scheduling, with a tweakPriority of +1, ie., raise the relative
+    // priority level by +1 wrt. to the current level:
+    if ((rc = PsychSetThreadPriority(NULL, 2, 1)) > 0) {
+        if (verbosity > 0) printf("PTB-ERROR: In IOPort:PsychSerialUnixGlueFramingReaderThreadMain(): Failed to switch to realtime priority [%s]!\n", strerror(rc));
+    }
+
+    fds[0].fd = device->fileDescriptor;
+    fds[0].events = POLLIN;
+    fds[1].fd = device->wakeupFd[0];
+    fds[1].events = POLLIN;
+
+    // Main loop: Runs until shutdown request via wakeupFd:
+    while (1) {
+        fds[0].revents = fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "PTB-ERROR: In IOPort:PsychSerialUnixGlueFramingReaderThreadMain(): poll() failed [%s]. Reader stops.\n", strerror(errno));
+            break;
+        }
+
+        // Shutdown requested?
+        if (fds[1].revents) break;
+
+        // Timestamp of arrival of this batch of data:
+        PsychGetAdjustedPrecisionTimerSeconds(&t);
+
+        if (!(fds[0].revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL))) continue;
+
+        // Fetch all pending data, at most one chunk:
+        nread = read(device->fileDescriptor, chunk, sizeof(chunk));
+        if (nread <= 0) {
+            if ((nread < 0) && ((errno == EAGAIN) || (errno == EINTR))) continue;
+
+            // Hangup or error, e.g., a disconnected USB-Serial converter or a closed pty. Stop
+            // polling the port, so we don't spin, but keep waiting for the shutdown request:
+            if (verbosity > 5) fprintf(stderr, "PTB-ERROR: In IOPort:PsychSerialUnixGlueFramingReaderThreadMain(): Port hung up or failed [%s].\n", (nread < 0) ? strerror(errno) : "EOF");
+            fds[0].fd = -1;
+            continue;
+        }
+
+        // Increment serial bytes received counter:
+        device->asyncReadBytesCount += nread;
+
+        // Split the chunk into packets:
+        i = 0;
+        while (i < nread) {
+            // Discard remainder of an oversized length-prefixed packet:
+            if (skip > 0) {
+                n = (skip < nread - i) ? skip : nread - i;
+                skip -= n;
+                i += n;
+                continue;
+            }
+
+            // Start of a new packet?
+            if (pktLen == 0) {
+                pkt = &(device->readBuffer[(device->readerThreadWritePos) % (device->readBufferSize)]);
+                memset(pkt, 0, granularity);
+                pktTime = t;
+
+                if (device->framingMode == kPsychIOPortFramingLengthPrefix) {
+                    // Packet is the length byte plus that many payload bytes, truncated to the slot size:
+                    pktExpected = 1 + (int) chunk[i];
+                    if (pktExpected > granularity) {
+                        skip = pktExpected - granularity;
+                        pktExpected = granularity;
+                    }
+                }
+                else {
+                    pktExpected = granularity;
+                }
+            }
+
+            if (device->framingMode == kPsychIOPortFramingTerminator) {
+                // Copy up to and including the terminator byte, if any, at most until the slot is full:
+                p = memchr(&chunk[i], device->lineTerminator, nread - i);
+                n = (p) ? (int) (p - &chunk[i]) + 1 : nread - i;
+            }
+            else {
+                n = nread - i;
+            }
+
+            if (n > pktExpected - pktLen) n = pktExpected - pktLen;
+            memcpy(&pkt[pktLen], &chunk[i], n);
+            pktLen += n;
+            i += n;
+
+            done = (pktLen == pktExpected) || ((device->framingMode == kPsychIOPortFramingTerminator) && (pkt[pktLen - 1] == device->lineTerminator));
+            if (!done) continue;
+
+            // Packet complete: Store its timestamp and length, then publish it:
+            slot = (device->readerThreadWritePos / granularity) % (device->readBufferSize / granularity);
+            device->timeStamps[slot] = pktTime;
+            device->packetLengths[slot] = pktLen;
+
+            PsychLockMutex(&(device->readerLock));
+            device->readerThreadWritePos += granularity;
+            PsychSignalCondition(&(device->readerCondition));
+            PsychUnlockMutex(&(device->readerLock));
+
+            pktLen = 0;
+        }
+
+        // Next batch...
+    }
+
+    // Go and die peacefully...
+    return(NULL);
+}
+
 void PsychIOOSShutdownSerialReaderThread(PsychSerialDeviceRecord* device)
 {
+    if (device->readerThread && (device->framingMode != kPsychIOPortFramingNone)) {
+        // Event driven framing reader: Wake it up via the wakeupFd, so it exits its loop:
+        #if PSYCH_SYSTEM == PSYCH_LINUX
+            eventfd_write(device->wakeupFd[1], 1);
+        #else
+            if (write(device->wakeupFd[1], "", 1) < 0 && verbosity > 0) printf("IOPort: WARNING: Waking up reader thread for shutdown failed [%s].\n", strerror(errno));
+        #endif
+
+        // Wait for it to die:
+        PsychDeleteThread(&(device->readerThread));
+
+        // Mark it as dead:
+        device->readerThread = (psych_thread) NULL;
+
+        // Release the mutex, condition and wakeupFd:
+        PsychDestroyMutex(&(device->readerLock));
+        PsychDestroyCondition(&(device->readerCondition));
+        close(device->wakeupFd[0]);
+        if (device->wakeupFd[1] != device->wakeupFd[0]) close(device->wakeupFd[1]);
+
+        // Release timestamp and length buffers:
+        free(device->timeStamps);
+        device->timeStamps = NULL;
+        free(device->packetLengths);
+        device->packetLengths = NULL;
+
+        // Back to blocking mode for regular reads:
+        PsychSerialUnixGlueFcntl(device, 0);
+    }
+
     if (device->readerThread) {
         // Cancel the thread:
         PsychAbortThread(&(device->readerThread));
@@ -541,6 +709,141 @@ void* PsychSerialUnixGlueJLTriggerThreadMain( void* deviceToCast)
     return(NULL);
 }
 
+/* PsychSerialUnixGlueExecuteWriteRequest() -- Execute one queued asynchronous write.
+ *
+ * Writes all data, even if the port is in non-blocking mode, then waits for transmission of
+ * the data via tcdrain(), which sleeps in the kernel instead of spinning on the output queue.
+ */
+static void PsychSerialUnixGlueExecuteWriteRequest(PsychSerialDeviceRecord* device, PsychSerialWriteRequest* req)
+{
+    int rc;
+    struct pollfd pfd;
+
+    req->nwritten = 0;
+    req->errmsg[0] = 0;
+
+    PsychGetAdjustedPrecisionTimerSeconds(&(req->timeStamps[0]));
+    while (req->nwritten < (int) req->amount) {
+        if ((rc = write(device->fileDescriptor, req->data + req->nwritten, req->amount - req->nwritten)) == -1) {
+            if (errno == EINTR) continue;
+
+            // Port is in non-blocking mode and the output queue is full? Wait for free space:
+            if (errno == EAGAIN) {
+                pfd.fd = device->fileDescriptor;
+                pfd.events = POLLOUT;
+                if (poll(&pfd, 1, 1000) > 0) continue;
+                snprintf(req->errmsg, sizeof(req->errmsg), "Error during async write to device %s - Timed out waiting for free space in output queue.\n", device->portSpec);
+                break;
+            }
+
+            snprintf(req->errmsg, sizeof(req->errmsg), "Error during async write to device %s - %s(%d).\n", device->portSpec, strerror(errno), errno);
+            break;
+        }
+
+        req->nwritten += rc;
+    }
+    PsychGetAdjustedPrecisionTimerSeconds(&(req->timeStamps[1]));
+
+    // Wait for write completion on physical hardware:
+    if ((req->errmsg[0] == 0) && (!device->dontFlushOnWrite) && (tcdrain(device->fileDescriptor) == -1)) {
+        snprintf(req->errmsg, sizeof(req->errmsg), "Error during async write to device %s while draining the write buffers - %s(%d).\n", device->portSpec, strerror(errno), errno);
+    }
+    PsychGetAdjustedPrecisionTimerSeconds(&(req->timeStamps[2]));
+
+    return;
+}
+
+/* PsychSerialUnixGlueWriterThreadMain() -- Execute queued asynchronous writes.
+ *
+ * Sleeps until writes get queued, executes them in order and records their timestamps.
+ * Writes scheduled for a target time are started at that time: The thread sleeps on its
+ * condition variable until shortly before the target time, so it can still be woken up
+ * for shutdown, then waits for the exact target time via PsychWaitUntilSeconds().
+ */
+void* PsychSerialUnixGlueWriterThreadMain(void* deviceToCast)
+{
+    int rc;
+    double tnow;
+    PsychSerialWriteRequest* req;
+
+    // Get a handle to our device struct: These pointers must not be NULL!!!
+    PsychSerialDeviceRecord* device = (PsychSerialDeviceRecord*) deviceToCast;
+
+    // Assign a name to ourselves, for debugging:
+    PsychSetThreadName("IOPortSerialWr");
+
+    // Try to raise our priority: We ask to switch ourselves (NULL) to priority class 2 aka
+    // realtime scheduling, with a tweakPriority of +2, ie., raise the relative
+    // priority level by +2 wrt. to the current level:
+    if ((rc = PsychSetThreadPriority(NULL, 2, 2)) > 0) {
+        if (verbosity > 0) printf("PTB-ERROR: In IOPort:PsychSerialUnixGlueWriterThreadMain(): Failed to switch to realtime priority [%s]!\n", strerror(rc));
+    }
+
+    PsychLockMutex(&(device->writerLock));
+    while (1) {
+        // Wait for work:
+        while (!device->writerShutdown && (device->writeQueueDone == device->writeQueueTail)) PsychWaitCondition(&(device->writerCondition), &(device->writerLock));
+        if (device->writerShutdown) break;
+
+        req = &(device->writeQueue[device->writeQueueDone % kPsychIOPortWriteQueueSize]);
+
+        // Scheduled write? Sleep until 5 msecs before target time:
+        while ((req->when > 0) && !device->writerShutdown) {
+            PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+            if (tnow >= req->when - 0.005) break;
+            PsychTimedWaitCondition(&(device->writerCondition), &(device->writerLock), req->when - 0.005 - tnow);
+        }
+        if (device->writerShutdown) break;
+
+        // Execute the write without holding the lock, so new writes can be queued meanwhile:
+        PsychUnlockMutex(&(device->writerLock));
+
+        if (req->when > 0) PsychWaitUntilSeconds(req->when);
+        PsychSerialUnixGlueExecuteWriteRequest(device, req);
+
+        // Mark write as completed:
+        PsychLockMutex(&(device->writerLock));
+        device->writeQueueDone++;
+        PsychSignalCondition(&(device->writeDoneCondition));
+    }
+    PsychUnlockMutex(&(device->writerLock));
+
+    // Go and die peacefully...
+    return(NULL);
+}
+
+static void PsychSerialUnixGlueShutdownWriterThread(PsychSerialDeviceRecord* device)
+{
+    int i;
+
+    if (!device->writerThread) return;
+
+    // Ask thread to exit. Queued writes which haven't been started yet are discarded:
+    PsychLockMutex(&(device->writerLock));
+    device->writerShutdown = 1;
+    PsychSignalCondition(&(device->writerCondition));
+    PsychUnlockMutex(&(device->writerLock));
+
+    // Wait for it to die:
+    PsychDeleteThread(&(device->writerThread));
+
+    // Mark it as dead:
+    device->writerThread = (psych_thread) NULL;
+
+    // Release the mutex, conditions and write buffers:
+    PsychDestroyMutex(&(device->writerLock));
+    PsychDestroyCondition(&(device->writerCondition));
+    PsychDestroyCondition(&(device->writeDoneCondition));
+
+    for (i = 0; i < kPsychIOPortWriteQueueSize; i++) {
+        free(device->writeQueue[i].data);
+        device->writeQueue[i].data = NULL;
+        device->writeQueue[i].capacity = 0;
+    }
+
+    return;
+}
+
 /* PsychIOOSOpenSerialPort()
  *
  * Open a serial port device and configure it.
@@ -672,6 +975,7 @@ void PsychIOOSCloseSerialPort(PsychSerialDeviceRecord* device)
     if (device == NULL) PsychErrorExitMsg(PsychError_internal, "NULL-Ptr instead of valid device pointer!");
 
     PsychIOOSShutdownSerialReaderThread(device);
+    PsychSerialUnixGlueShutdownWriterThread(device);
 
     // Drain all send-buffers:
     // Block until all written output has been sent from the device.
@@ -1277,6 +1581,37 @@ PsychError PsychIOOSConfigureSerialPort(PsychSerialDeviceRecord* device, const c
         device->readFilterFlags = (unsigned int) inint;
     }
 
+    if ((p = strstr(configString, "FramingMode="))) {
+        // Make sure we don't change non-mutex-protected variables behind the
+        // back of our readerThread by only allowing this function to be called
+        // with inactive thread:
+        if (device->readerThread) {
+            if (verbosity > 0) printf("Assigned FramingMode= while background read operations are already enabled! Disable first via 'StopBackgroundRead'!\n");
+            return(PsychError_user);
+        }
+
+        if (strstr(p, "FramingMode=None")) {
+            device->framingMode = kPsychIOPortFramingNone;
+        }
+        else
+        if (strstr(p, "FramingMode=Fixed")) {
+            device->framingMode = kPsychIOPortFramingFixed;
+        }
+        else
+        if (strstr(p, "FramingMode=Terminator")) {
+            device->framingMode = kPsychIOPortFramingTerminator;
+        }
+        else
+        if (strstr(p, "FramingMode=LengthPrefix")) {
+            device->framingMode = kPsychIOPortFramingLengthPrefix;
+        }
+        else {
+            // Invalid spec:
+            if (verbosity > 0) printf("Invalid setting for framing mode %s not accepted! (Valid: None, Fixed, Terminator, LengthPrefix)", p);
+            return(PsychError_user);
+        }
+    }
+
     // Stop a background reader?
     if ((p = strstr(configString, "StopBackgroundRead"))) {
         PsychIOOSShutdownSerialReaderThread(device);
@@ -1322,6 +1657,41 @@ PsychError PsychIOOSConfigureSerialPort(PsychSerialDeviceRecord* device, const c
             // Allocate sufficiently large timestamp buffer:
             device->timeStamps = (double*) calloc(sizeof(double), device->readBufferSize / device->readGranularity);
 
+            if (device->framingMode != kPsychIOPortFramingNone) {
+                if ((device->framingMode == kPsychIOPortFramingTerminator) && (device->lineTerminator == _POSIX_VDISABLE)) {
+                    if (verbosity > 0) printf("Called StartBackgroundRead with FramingMode=Terminator, but no 'Terminator' is set!\n");
+                    free(device->timeStamps);
+                    device->timeStamps = NULL;
+                    return(PsychError_user);
+                }
+
+                // Packet lengths buffer, condition variable for waiting on packets, and fd for shutdown wakeup of
+                // the event driven reader thread:
+                device->packetLengths = (int*) calloc(sizeof(int), device->readBufferSize / device->readGranularity);
+                PsychInitCondition(&(device->readerCondition), NULL);
+
+                #if PSYCH_SYSTEM == PSYCH_LINUX
+                    device->wakeupFd[0] = device->wakeupFd[1] = eventfd(0, EFD_CLOEXEC);
+                    rc = (device->wakeupFd[0] == -1) ? -1 : 0;
+                #else
+                    rc = pipe(device->wakeupFd);
+                #endif
+
+                if (rc) {
+                    printf("PTB-ERROR: In StartBackgroundRead(): Could not create wakeup fd for background reader thread [%s].\n", strerror(errno));
+                    PsychDestroyCondition(&(device->readerCondition));
+                    free(device->packetLengths);
+                    device->packetLengths = NULL;
+                    free(device->timeStamps);
+                    device->timeStamps = NULL;
+                    return(PsychError_system);
+                }
+
+                // The reader thread only read()s after poll() signalled pending data, so non-blocking
+                // and blocking mode behave the same, except that non-blocking mode is more robust:
+                PsychSerialUnixGlueFcntl(device, O_NONBLOCK);
+            }
+
             // Create & Init the mutex:
             if ((rc=PsychInitMutex(&(device->readerLock)))) {
                 printf("PTB-ERROR: In StartBackgroundRead(): Could not create readerLock mutex lock [%s].\n", strerror(rc));
@@ -1336,7 +1706,7 @@ PsychError PsychIOOSConfigureSerialPort(PsychSerialDeviceRecord* device, const c
             }
 
             // Create and startup thread:
-            if ((rc=PsychCreateThread(&(device->readerThread), NULL, PsychSerialUnixGlueReaderThreadMain, (void*) device))) {
+            if ((rc=PsychCreateThread(&(device->readerThread), NULL, (device->framingMode != kPsychIOPortFramingNone) ? PsychSerialUnixGlueFramingReaderThreadMain : PsychSerialUnixGlueReaderThreadMain, (void*) device))) {
                 printf("PTB-ERROR: In StartBackgroundRead(): Could not create background reader thread [%s].\n", strerror(rc));
                 return(PsychError_system);
             }
@@ -1487,6 +1857,129 @@ int PsychIOOSWriteSerialPort(PsychSerialDeviceRecord* device, void* writedata, u
     return(nwritten);
 }
 
+/* PsychIOOSWriteSerialPortAsync() -- Queue an asynchronous write.
+ *
+ * Copies the data into the write queue and returns immediately with a ticket for the
+ * write, or -1 on error. The writerThread is started on first use. The write starts
+ * as soon as possible, or at GetSecs time 'when' if 'when' is greater than zero.
+ */
+int PsychIOOSWriteSerialPortAsync(PsychSerialDeviceRecord* device, void* writedata, unsigned int amount, double when, char* errmsg)
+{
+    int rc, ticket;
+    PsychSerialWriteRequest* req;
+
+    if (!device->writerThread) {
+        device->writerShutdown = 0;
+        device->writeQueueTail = 0;
+        device->writeQueueDone = 0;
+
+        if ((rc = PsychInitMutex(&(device->writerLock)))) {
+            sprintf(errmsg, "Error: Could not create writerLock mutex lock for device %s [%s].\n", device->portSpec, strerror(rc));
+            return(-1);
+        }
+
+        PsychInitCondition(&(device->writerCondition), NULL);
+        PsychInitCondition(&(device->writeDoneCondition), NULL);
+
+        if ((rc = PsychCreateThread(&(device->writerThread), NULL, PsychSerialUnixGlueWriterThreadMain, (void*) device))) {
+            device->writerThread = (psych_thread) NULL;
+            PsychDestroyMutex(&(device->writerLock));
+            PsychDestroyCondition(&(device->writerCondition));
+            PsychDestroyCondition(&(device->writeDoneCondition));
+            sprintf(errmsg, "Error: Could not create background writer thread for device %s [%s].\n", device->portSpec, strerror(rc));
+            return(-1);
+        }
+    }
+
+    PsychLockMutex(&(device->writerLock));
+
+    if (device->writeQueueTail - device->writeQueueDone >= kPsychIOPortWriteQueueSize) {
+        PsychUnlockMutex(&(device->writerLock));
+        sprintf(errmsg, "Error: Write queue of device %s is full with %i pending writes.\n", device->portSpec, kPsychIOPortWriteQueueSize);
+        return(-1);
+    }
+
+    // Slot of oldest completed write is free for reuse:
+    req = &(device->writeQueue[device->writeQueueTail % kPsychIOPortWriteQueueSize]);
+    if (req->capacity < amount) {
+        free(req->data);
+        req->data = (unsigned char*) malloc(amount);
+        req->capacity = (req->data) ? amount : 0;
+        if (NULL == req->data) {
+            PsychUnlockMutex(&(device->writerLock));
+            sprintf(errmsg, "Error: Out of memory while queueing write to device %s.\n", device->portSpec);
+            return(-1);
+        }
+    }
+
+    memcpy(req->data, writedata, amount);
+    req->amount = amount;
+    req->when = when;
+    req->nwritten = 0;
+    req->timeStamps[0] = req->timeStamps[1] = req->timeStamps[2] = 0;
+    req->errmsg[0] = 0;
+
+    ticket = device->writeQueueTail++;
+    PsychSignalCondition(&(device->writerCondition));
+    PsychUnlockMutex(&(device->writerLock));
+
+    errmsg[0] = 0;
+
+    return(ticket);
+}
+
+/* PsychIOOSWriteSerialPortAsyncResult() -- Query results of an asynchronous write.
+ *
+ * Returns 1 and assigns timestamps[0-2] and nwritten if the write with 'ticket' is completed,
+ * 0 if it is still pending, or -1 on error. Waits for completion if 'waitForCompletion' is set,
+ * but at most for the read timeout of the device after the target time of the write, or after
+ * now if that is later, so a stuck port can't hang us forever. Returns 0 with a timeout message
+ * in errmsg if the wait timed out.
+ */
+int PsychIOOSWriteSerialPortAsyncResult(PsychSerialDeviceRecord* device, int ticket, int waitForCompletion, char* errmsg, double* timestamps, int* nwritten)
+{
+    PsychSerialWriteRequest* req;
+    double tnow, deadline;
+
+    if (!device->writerThread || (ticket < 0) || (ticket >= device->writeQueueTail)) {
+        sprintf(errmsg, "Error: Invalid ticket %i for async write to device %s.\n", ticket, device->portSpec);
+        return(-1);
+    }
+
+    if (ticket < device->writeQueueTail - kPsychIOPortWriteQueueSize) {
+        sprintf(errmsg, "Error: Results of async write with ticket %i to device %s are no longer available. Only the last %i writes are kept.\n", ticket, device->portSpec, kPsychIOPortWriteQueueSize);
+        return(-1);
+    }
+
+    req = &(device->writeQueue[ticket % kPsychIOPortWriteQueueSize]);
+
+    PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+    deadline = ((req->when > tnow) ? req->when : tnow) + device->readTimeout;
+
+    PsychLockMutex(&(device->writerLock));
+    while (waitForCompletion && (ticket >= device->writeQueueDone) && (tnow < deadline)) {
+        PsychTimedWaitCondition(&(device->writeDoneCondition), &(device->writerLock), deadline - tnow);
+        PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+    }
+
+    if (ticket >= device->writeQueueDone) {
+        PsychUnlockMutex(&(device->writerLock));
+        if (waitForCompletion) {
+            sprintf(errmsg, "Timeout: Async write with ticket %i to device %s did not complete within the read timeout of %f seconds.\n", ticket, device->portSpec, device->readTimeout);
+        }
+        else {
+            errmsg[0] = 0;
+        }
+        return(0);
+    }
+    PsychUnlockMutex(&(device->writerLock));
+    memcpy(timestamps, req->timeStamps, sizeof(req->timeStamps));
+    *nwritten = req->nwritten;
+    strcpy(errmsg, req->errmsg);
+
+    return(1);
+}
+
 int PsychIOOSReadSerialPort(PsychSerialDeviceRecord* device, void** readdata, unsigned int amount, int blocking, char* errmsg, double* timestamp)
 {
     struct termios options;
@@ -1724,6 +2217,83 @@ int PsychIOOSReadSerialPort(PsychSerialDeviceRecord* device, void** readdata, un
     return(nread);
 }
 
+/* PsychIOOSReadSerialPortPackets() -- Fetch packets from a framing background reader.
+ *
+ * Returns the number of fetched packets, at most maxPackets, or -1 on error. In blocking mode,
+ * waits for maxPackets packets if maxPacketsGiven, otherwise for at least one. The packets
+ * are not copied, instead 'packets' gets pointers into the ring buffer of the reader thread.
+ * As the ring buffer may wrap around, these are up to two segments of packets, timestamps
+ * and lengths each. They stay valid until the next read operation on the device.
+ */
+int PsychIOOSReadSerialPortPackets(PsychSerialDeviceRecord* device, unsigned int maxPackets, psych_bool maxPacketsGiven, int blocking, char* errmsg, PsychIOPortPackets* packets)
+{
+    double deadline, tnow;
+    int navail, nslots, slot;
+    unsigned int wanted;
+
+    memset(packets, 0, sizeof(PsychIOPortPackets));
+
+    if (!device->readerThread || (device->framingMode == kPsychIOPortFramingNone)) {
+        sprintf(errmsg, "Error: Device %s has no background reader with packet framing active. Set a 'FramingMode' and use 'StartBackgroundRead' first.\n", device->portSpec);
+        return(-1);
+    }
+
+    nslots = device->readBufferSize / device->readGranularity;
+    packets->packetSize = device->readGranularity;
+
+    // Clamp to number of packets in buffer:
+    if (maxPackets > (unsigned int) nslots) maxPackets = (unsigned int) nslots;
+
+    // Blocking mode: Wait for arrival of wanted number of packets, or at least one
+    // packet if no number is specified, or until timeout:
+    PsychLockMutex(&(device->readerLock));
+    navail = (device->readerThreadWritePos - device->clientThreadReadPos) / device->readGranularity;
+    if (blocking > 0) {
+        wanted = (maxPacketsGiven) ? maxPackets : 1;
+        PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+        deadline = tnow + device->readTimeout;
+        while ((navail >= 0) && ((unsigned int) navail < wanted) && (tnow < deadline)) {
+            PsychTimedWaitCondition(&(device->readerCondition), &(device->readerLock), deadline - tnow);
+            navail = (device->readerThreadWritePos - device->clientThreadReadPos) / device->readGranularity;
+            PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+        }
+    }
+    PsychUnlockMutex(&(device->readerLock));
+
+    // Read successfully completed if we reach this point. Clear error message:
+    errmsg[0] = 0;
+
+    // Check for buffer overflow:
+    if (navail > nslots) {
+        sprintf(errmsg, "Error: Readbuffer overflow for background read operation on device %s. Flushing buffer to recover. At least %i packets of input data have been lost!\n", device->portSpec, navail - nslots);
+
+        // Flush readBuffer - Try to get a fresh start...
+        PsychLockMutex(&(device->readerLock));
+        device->clientThreadReadPos = device->readerThreadWritePos;
+        PsychUnlockMutex(&(device->readerLock));
+
+        return(-1);
+    }
+
+    if ((unsigned int) navail > maxPackets) navail = (int) maxPackets;
+
+    // Hand out up to two contiguous segments of the ring buffer:
+    slot = (device->clientThreadReadPos / device->readGranularity) % nslots;
+    packets->count = navail;
+    packets->firstCount = (slot + navail > nslots) ? nslots - slot : navail;
+    packets->data[0] = &(device->readBuffer[slot * device->readGranularity]);
+    packets->timeStamps[0] = &(device->timeStamps[slot]);
+    packets->lengths[0] = &(device->packetLengths[slot]);
+    packets->data[1] = device->readBuffer;
+    packets->timeStamps[1] = device->timeStamps;
+    packets->lengths[1] = device->packetLengths;
+
+    // Update of read-pointer:
+    device->clientThreadReadPos += navail * device->readGranularity;
+
+    return(navail);
+}
+
 int PsychIOOSBytesAvailableSerialPort(PsychSerialDeviceRecord* device)
 {
     int navail = 0;
@@ -43,6 +43,7 @@
 #include <sys/time.h>
 #include <time.h>
 #include <pthread.h>
+#include <poll.h>
 
 // OS/X specific includes and structures:
 #if PSYCH_SYSTEM == PSYCH_OSX
@@ -59,9 +60,23 @@
 
 // Linux specific includes and structures:
 #if PSYCH_SYSTEM == PSYCH_LINUX
-// None yet.
+#include <sys/eventfd.h>
 #endif
 
+// Maximum number of pending asynchronous writes per device:
+#define kPsychIOPortWriteQueueSize 64
+
+// One asynchronous write request, executed by the writerThread:
+typedef struct PsychSerialWriteRequest {
+    unsigned char*      data;                           // Copy of the data to write.
+    unsigned int        capacity;                       // Allocated size of data buffer.
+    unsigned int        amount;                         // Amount of data to write.
+    double              when;                           // Target time for start of write, or 0 for asap.
+    int                 nwritten;                       // Number of bytes written.
+    double              timeStamps[3];                  // Timestamps before write(), after write() and after drain.
+    char                errmsg[256];                    // Error message, empty on success.
+} PsychSerialWriteRequest;
+
 typedef struct PsychSerialDeviceRecord {
     char                portSpec[1000];                 // Name string of the device file.
     int                 fileDescriptor;                 // Device handle.
@@ -85,6 +100,18 @@ typedef struct PsychSerialDeviceRecord {
     unsigned char       cookedMode;                     // Cooked input processing mode active? Set to 1 if so.
     int                 dontFlushOnWrite;               // If set to 1, don't tcdrain() after blocking writes, otherwise do.
     double              triggerWhen;                    // Target time for trigger byte emission.
+    int                 framingMode;                    // Packet framing for background reads, one of kPsychIOPortFraming...
+    int*                packetLengths;                  // Buffer for lengths of framed packets. Size = readBufferSize / readGranularity.
+    psych_condition     readerCondition;                // Signalled by framing readerThread after reception of a packet.
+    int                 wakeupFd[2];                    // eventfd (Linux) or pipe (OS/X) to wake up framing readerThread for shutdown.
+    pthread_t           writerThread;                   // Thread handle for background writing thread.
+    pthread_mutex_t     writerLock;                     // Lock for the write queue.
+    psych_condition     writerCondition;                // Signalled when a write gets queued, or on shutdown of writerThread.
+    psych_condition     writeDoneCondition;             // Signalled by writerThread after completion of a write.
+    int                 writerShutdown;                 // Set to 1 to ask writerThread to exit.
+    int                 writeQueueTail;                 // Ticket of next queued write.
+    int                 writeQueueDone;                 // Ticket of next write to execute. All older writes are completed.
+    PsychSerialWriteRequest writeQueue[kPsychIOPortWriteQueueSize]; // Ring of write requests, indexed by ticket.
 } PsychSerialDeviceRecord;
 
 #endif
@@ -67,7 +67,10 @@ PsychError PsychModuleInit(void)
     PsychErrorExit(PsychRegister("Close",  &IOPORTClose));
     PsychErrorExit(PsychRegister("CloseAll", &IOPORTCloseAll));
     PsychErrorExit(PsychRegister("Read", &IOPORTRead));
+    PsychErrorExit(PsychRegister("ReadPackets", &IOPORTReadPackets));
     PsychErrorExit(PsychRegister("Write", &IOPORTWrite));
+    PsychErrorExit(PsychRegister("WriteAsync", &IOPORTWriteAsync));
+    PsychErrorExit(PsychRegister("WriteAsyncResult", &IOPORTWriteAsyncResult));
     PsychErrorExit(PsychRegister("BytesAvailable", &IOPORTBytesAvailable));
     PsychErrorExit(PsychRegister("Purge", &IOPORTPurge));
     PsychErrorExit(PsychRegister("Flush", &IOPORTFlush));
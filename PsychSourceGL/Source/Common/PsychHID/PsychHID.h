@@ -204,12 +204,14 @@ PsychError PSYCHHIDKbQueueFlush(void);				// PsychHIDKbQueueFlush.c
 PsychError PSYCHHIDKbQueueRelease(void);			// PsychHIDKbQueueRelease.c
 PsychError PSYCHHIDKbCheck(void);					// PsychHIDKbCheck.c
 PsychError PSYCHHIDKbQueueGetEvent(void);			// PsychHIDKbCheck.c
+PsychError PSYCHHIDKbQueueGetEvents(void);			// PsychHIDKbCheck.c
 
 PsychError PSYCHHIDGetReport(void);					// PsychHIDGetReport.c
 PsychError PSYCHHIDSetReport(void);					// PsychHIDSetReport.c
 PsychError PSYCHHIDReceiveReports(void);			// PsychHIDReceiveReports.c
 PsychError PSYCHHIDReceiveReportsStop(void);		// PsychHIDReceiveReportsStop.c
 PsychError PSYCHHIDGiveMeReports(void);				// PsychHIDGiveMeReports.c
+PsychError PSYCHHIDGiveReports(void);				// PsychHIDGiveReports.c
 PsychError PSYCHHIDOpenUSBDevice(void);				// PSYCHHIDOpenUSBDevice.c
 PsychError PSYCHHIDCloseUSBDevice(void);			// PSYCHHIDCloseUSBDevice.c
 PsychError PSYCHHIDUSBControlTransfer(void);		// PSYCHHIDUSBControlTransfer.c
@@ -221,6 +223,7 @@ PsychError  PsychHIDReceiveReportsCleanup(void); // PsychHIDReceiveReports.c
 PsychError  ReceiveReports(int deviceIndex); // PsychHIDReceiveReports.c
 PsychError  GiveMeReport(int deviceIndex, psych_bool *reportAvailablePtr, unsigned char *reportBuffer, psych_uint32 *reportBytesPtr, double *reportTimePtr); // PsychHIDReceiveReports.c
 PsychError  GiveMeReports(int deviceIndex,int reportBytes); // PsychHIDReceiveReports.c
+PsychError  GiveReports(int deviceIndex,int reportBytes); // PsychHIDReceiveReports.c
 PsychError	ReceiveReportsStop(int deviceIndex);
 PsychError 	PsychHIDCleanup(void);												// PsychHIDHelpers.c 
 void 		PsychHIDVerifyInit(void);											// PsychHIDHelpers.c 
@@ -288,6 +291,7 @@ psych_bool PsychHIDDeleteEventBuffer(int deviceIndex);
 psych_bool PsychHIDFlushEventBuffer(int deviceIndex);
 unsigned int PsychHIDAvailEventBuffer(int deviceIndex, unsigned int flags);
 int PsychHIDReturnEventFromEventBuffer(int deviceIndex, int outArgIndex, double maxWaitTimeSecs);
+int PsychHIDReturnEventsFromEventBuffer(int deviceIndex, int outArgIndex, double maxWaitTimeSecs, unsigned int maxEvents);
 int PsychHIDAddEventToEventBuffer(int deviceIndex, PsychHIDEventRecord* evt);
 
 #ifdef __cplusplus
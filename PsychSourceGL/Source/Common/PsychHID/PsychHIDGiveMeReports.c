@@ -36,7 +36,7 @@ static char synopsisString[]=
 	"The returned value \"err.n\" is zero upon success and a nonzero error code upon failure, "
 	"as spelled out by \"err.name\" and \"err.description\". ";
     
-static char seeAlsoString[]="SetReport, GetReport, ReceiveReports, ReceiveReportsStop, GiveMeReports.";
+static char seeAlsoString[]="SetReport, GetReport, ReceiveReports, ReceiveReportsStop, GiveReports.";
 
 PsychError GiveMeReports(int deviceIndex,int reportBytes); // PsychHIDReceiveReports.c
 
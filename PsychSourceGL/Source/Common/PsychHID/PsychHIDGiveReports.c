@@ -0,0 +1,74 @@
+/*
+	PsychToolbox/Source/Common/PsychHID/PsychHIDGiveReports.c
+
+	PROJECTS: PsychHID
+
+	PLATFORMS:  All
+
+	HISTORY:
+	Based on PsychHIDGiveMeReports.c
+
+ */
+
+#include "PsychHID.h"
+
+static char useString[]= "[reports,times,lengths,err]=PsychHID('GiveReports',deviceNumber,[reportBytes])";
+static char synopsisString[]=
+	"Return, as output arguments, all the saved reports from the connected USB HID device, in one matrix.\n"
+	"This is like GiveMeReports, but much faster if many reports are pending, e.g., from devices "
+	"which send reports at high rates, as it avoids creation of one struct per report.\n"
+	"\"deviceNumber\" specifies which device.\n"
+	"If supplied, the optional \"reportBytes\" argument imposes a maximum length on each report; "
+	"if necessary, reports will be shortened, but not lengthened.\n"
+	"\"reports\" is a uint8 matrix with one column per report, oldest report first. The number of rows is "
+	"the length of the longest report, or \"reportBytes\" if that is smaller. Shorter reports are padded with zeros. "
+	"If your device uses reportID then the first byte of each report is the reportID, the following "
+	"bytes contain the actual received report data. Otherwise (reportID==0), the received data "
+	"starts already in the first byte of each column.\n"
+	"\"times\" is a row vector with the GetSecs time at which each report was received from the system. "
+	"On Linux and MS-Windows, this is the time when PsychHID's background thread received the report, "
+	"which is usually within a fraction of a millisecond of its arrival at the computer.\n"
+	"\"lengths\" is a row vector with the number of valid bytes in each column of \"reports\".\n"
+	"The returned value \"err.n\" is zero upon success and a nonzero error code upon failure, "
+	"as spelled out by \"err.name\" and \"err.description\". ";
+
+static char seeAlsoString[]="SetReport, GetReport, ReceiveReports, ReceiveReportsStop, GiveMeReports.";
+
+PsychError PSYCHHIDGiveReports(void)
+{
+	long error=0;
+	int deviceIndex;
+	int reportBytes=1024;
+	mxArray **outErr;
+
+    PsychPushHelp(useString,synopsisString,seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+    PsychErrorExit(PsychCapNumOutputArgs(4));
+    PsychErrorExit(PsychCapNumInputArgs(2));
+	PsychCopyInIntegerArg(1,TRUE,&deviceIndex);
+	PsychCopyInIntegerArg(2,false,&reportBytes);
+
+	PsychHIDVerifyInit();
+
+	// reports, times, lengths
+	error=GiveReports(deviceIndex,reportBytes); // PsychHIDReceiveReports.c
+
+	// err
+	outErr=PsychGetOutArgMxPtr(4); // outErr==NULL if optional argument is absent.
+	if(outErr!=NULL){
+		const char *fieldNames[]={"n", "name", "description"};
+		mxArray *fieldValue;
+		char *name="",*description="";
+
+		PsychHIDErrors(NULL, error,&name,&description); // Get error name and description, if available.
+		*outErr=mxCreateStructMatrix(1,1,3,fieldNames);
+		fieldValue=mxCreateString(name);
+		mxSetField(*outErr,0,"name",fieldValue);
+		fieldValue=mxCreateString(description);
+		mxSetField(*outErr,0,"description",fieldValue);
+		fieldValue=mxCreateDoubleMatrix(1,1,mxREAL);
+		*mxGetPr(fieldValue)=(double)error;
+		mxSetField(*outErr,0,"n",fieldValue);
+	}
+    return(PsychError_none);
+}
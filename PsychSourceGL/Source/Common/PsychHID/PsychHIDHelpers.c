@@ -45,8 +45,9 @@ PsychUSBDeviceRecord usbDeviceRecordBank[PSYCH_HID_MAX_GENERIC_USB_DEVICES];
 
 PsychHIDEventRecord* hidEventBuffer[PSYCH_HID_MAX_DEVICES];
 unsigned int    hidEventBufferCapacity[PSYCH_HID_MAX_DEVICES];
-unsigned int    hidEventBufferReadPos[PSYCH_HID_MAX_DEVICES];
-unsigned int    hidEventBufferWritePos[PSYCH_HID_MAX_DEVICES];
+volatile unsigned int hidEventBufferReadPos[PSYCH_HID_MAX_DEVICES];
+volatile unsigned int hidEventBufferWritePos[PSYCH_HID_MAX_DEVICES];
+volatile int    hidEventBufferWaiting[PSYCH_HID_MAX_DEVICES];
 psych_mutex     hidEventBufferMutex[PSYCH_HID_MAX_DEVICES];
 psych_condition hidEventBufferCondition[PSYCH_HID_MAX_DEVICES];
 
@@ -70,6 +71,7 @@ void PsychInitializePsychHID(void)
 		hidEventBufferCapacity[i] = 10000; // Initial capacity of event buffer.
 		hidEventBufferReadPos[i] = 0;
 		hidEventBufferWritePos[i] = 0;
+		hidEventBufferWaiting[i] = 0;
 	}
 
     #if PSYCH_SYSTEM == PSYCH_OSX
@@ -273,15 +275,22 @@ psych_bool PsychHIDCreateEventBuffer(int deviceIndex)
     // Already created? If so, nothing to do:
     if (hidEventBuffer[deviceIndex] || (bufferSize < 1)) return(FALSE);
 
+    // Round capacity up to the next power of two, so the free-running read/write
+    // positions can be masked instead of wrapped, also across unsigned int overflow:
+    while (bufferSize & (bufferSize - 1)) bufferSize = (bufferSize | (bufferSize - 1)) + 1;
+    hidEventBufferCapacity[deviceIndex] = bufferSize;
+
     hidEventBuffer[deviceIndex] = (PsychHIDEventRecord*) calloc(sizeof(PsychHIDEventRecord), bufferSize);
     if (NULL == hidEventBuffer[deviceIndex]) {
         printf("PTB-ERROR: PsychHIDCreateEventBuffer(): Insufficient memory to create KbQueue event buffer!");
         return(FALSE);
     }
 
-    // Prepare mutex for buffer:
+    // Prepare mutex and condition for buffer. They are only used to sleep while the
+    // buffer is empty, the data exchange itself is lock-free:
     PsychInitMutex(&hidEventBufferMutex[deviceIndex]);
     PsychInitCondition(&hidEventBufferCondition[deviceIndex], NULL);
+    hidEventBufferWaiting[deviceIndex] = 0;
 
     // Flush it:
     PsychHIDFlushEventBuffer(deviceIndex);
@@ -307,15 +316,21 @@ psych_bool PsychHIDDeleteEventBuffer(int deviceIndex)
 	return(TRUE);
 }
 
+/* The event buffer is a single-producer / single-consumer ringbuffer: Only the
+ * KbQueue processing thread of a device advances the write position, only the
+ * scripting thread advances the read position. Both positions are free-running
+ * and masked with (capacity - 1) on access, so no locking is needed for the data
+ * exchange itself, just memory barriers to order slot contents vs. positions.
+ */
 psych_bool PsychHIDFlushEventBuffer(int deviceIndex)
 {
 	if (deviceIndex < 0) deviceIndex = PsychHIDGetDefaultKbQueueDevice();
 
     if (!hidEventBuffer[deviceIndex]) return(FALSE);
 
-	PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
-	hidEventBufferReadPos[deviceIndex] = hidEventBufferWritePos[deviceIndex] = 0;
-	PsychUnlockMutex(&hidEventBufferMutex[deviceIndex]);
+	// Consumer side flush: Discard everything up to the current write position:
+	hidEventBufferReadPos[deviceIndex] = hidEventBufferWritePos[deviceIndex];
+	PsychMemoryBarrier();
 
 	return(TRUE);
 }
@@ -326,30 +341,62 @@ psych_bool PsychHIDFlushEventBuffer(int deviceIndex)
  */
 unsigned int PsychHIDAvailEventBuffer(int deviceIndex, unsigned int flags)
 {
-	unsigned int navail, i, j;
-    
+	unsigned int navail, i, j, readpos, writepos;
+
 	if (deviceIndex < 0) deviceIndex = PsychHIDGetDefaultKbQueueDevice();
 
     if (!hidEventBuffer[deviceIndex]) return(0);
 
-	PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
-    
+	readpos = hidEventBufferReadPos[deviceIndex];
+	writepos = hidEventBufferWritePos[deviceIndex];
+	PsychMemoryBarrier();
+
     // Compute total number of available events by default:
-	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];
-    
+	navail = writepos - readpos;
+
     // Only count of valid "CookedKey" mapped keypress events, e.g., for use by CharAvail(), requested?
     if (flags & 1) {
         // Yes: Iterate over all available events and only count number of keypress events
         // with meaningful 'CookedKey' field:
         navail = 0;
-        for (i = hidEventBufferReadPos[deviceIndex]; i < hidEventBufferWritePos[deviceIndex]; i++) {
-            j = i % hidEventBufferCapacity[deviceIndex];
+        for (i = readpos; i != writepos; i++) {
+            j = i & (hidEventBufferCapacity[deviceIndex] - 1);
             if ((hidEventBuffer[deviceIndex][j].status & (1<<0)) && (hidEventBuffer[deviceIndex][j].cookedEventCode > 0)) navail++;
         }
     }
-    
+
+	return(navail);
+}
+
+/* Wait for at most maxWaitTimeSecs for the event buffer of 'deviceIndex' to become
+ * non-empty. Returns number of available events. Only called by the consumer:
+ */
+static unsigned int PsychHIDWaitEventBuffer(int deviceIndex, double maxWaitTimeSecs)
+{
+	unsigned int navail;
+
+	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];
+	if ((navail > 0) || (maxWaitTimeSecs <= 0)) return(navail);
+
+	// Nothing available and we're asked to wait for something: Announce ourselves
+	// as waiter to the producer, then recheck under the mutex before going to sleep,
+	// so a concurrently added event can't be missed:
+	PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
+	hidEventBufferWaiting[deviceIndex] = 1;
+	PsychMemoryBarrier();
+
+	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];
+	if (navail == 0) {
+		PsychTimedWaitCondition(&hidEventBufferCondition[deviceIndex], &hidEventBufferMutex[deviceIndex], maxWaitTimeSecs);
+	}
+
+	hidEventBufferWaiting[deviceIndex] = 0;
 	PsychUnlockMutex(&hidEventBufferMutex[deviceIndex]);
-	
+
+	// Recompute number of available events:
+	PsychMemoryBarrier();
+	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];
+
 	return(navail);
 }
 
@@ -363,25 +410,19 @@ int PsychHIDReturnEventFromEventBuffer(int deviceIndex, int outArgIndex, double
 
 	if (deviceIndex < 0) deviceIndex = PsychHIDGetDefaultKbQueueDevice();	
 	if (!hidEventBuffer[deviceIndex]) return(0);
-	
-	PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
-	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];	
 
-	// If nothing available and we're asked to wait for something, then wait:
-	if ((navail == 0) && (maxWaitTimeSecs > 0)) {
-		// Wait for something:
-		PsychTimedWaitCondition(&hidEventBufferCondition[deviceIndex], &hidEventBufferMutex[deviceIndex], maxWaitTimeSecs);
-
-		// Recompute number of available events:
-		navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];	
-	}
+	// Wait for events if requested, return number of available events:
+	navail = PsychHIDWaitEventBuffer(deviceIndex, maxWaitTimeSecs);
 
 	// Check if anything available, copy it if so:
 	if (navail) {
-		memcpy(&evt, &(hidEventBuffer[deviceIndex][hidEventBufferReadPos[deviceIndex] % hidEventBufferCapacity[deviceIndex]]), sizeof(PsychHIDEventRecord));
+		PsychMemoryBarrier();
+		memcpy(&evt, &(hidEventBuffer[deviceIndex][hidEventBufferReadPos[deviceIndex] & (hidEventBufferCapacity[deviceIndex] - 1)]), sizeof(PsychHIDEventRecord));
+
+		// Release the slot to the producer only after we're done copying:
+		PsychMemoryBarrier();
 		hidEventBufferReadPos[deviceIndex]++;
 	}
-	PsychUnlockMutex(&hidEventBufferMutex[deviceIndex]);
 
 	if (navail) {
 		// Return event struct:
@@ -399,30 +440,87 @@ int PsychHIDReturnEventFromEventBuffer(int deviceIndex, int outArgIndex, double
 	}
 }
 
+/* Bulk variant of PsychHIDReturnEventFromEventBuffer(): Drain up to maxEvents events in one go
+ * and return them as a single struct whose fields are 1-by-n row vectors, one column per event.
+ * Returns number of events remaining in the buffer after draining.
+ */
+int PsychHIDReturnEventsFromEventBuffer(int deviceIndex, int outArgIndex, double maxWaitTimeSecs, unsigned int maxEvents)
+{
+	unsigned int navail, ncopy, i, j, readpos;
+	PsychHIDEventRecord *evt;
+	PsychGenericScriptType *retevents, *outMat;
+	double *times = NULL, *pressed = NULL, *keycodes = NULL, *cookedkeys = NULL;
+	const char *FieldNames[] = { "Time", "Pressed", "Keycode", "CookedKey" };
+
+	if (deviceIndex < 0) deviceIndex = PsychHIDGetDefaultKbQueueDevice();
+	if (!hidEventBuffer[deviceIndex]) return(0);
+
+	// Wait for events if requested, return number of available events:
+	navail = PsychHIDWaitEventBuffer(deviceIndex, maxWaitTimeSecs);
+	ncopy = (navail < maxEvents) ? navail : maxEvents;
+
+	// Allocate output struct with one row vector per field, filled directly from the ringbuffer:
+	PsychAllocOutStructArray(outArgIndex, kPsychArgOptional, 1, 4, FieldNames, &retevents);
+	PsychAllocateNativeDoubleMat(1, ncopy, 1, &times, &outMat);
+	PsychSetStructArrayNativeElement("Time", 0, outMat, retevents);
+	PsychAllocateNativeDoubleMat(1, ncopy, 1, &pressed, &outMat);
+	PsychSetStructArrayNativeElement("Pressed", 0, outMat, retevents);
+	PsychAllocateNativeDoubleMat(1, ncopy, 1, &keycodes, &outMat);
+	PsychSetStructArrayNativeElement("Keycode", 0, outMat, retevents);
+	PsychAllocateNativeDoubleMat(1, ncopy, 1, &cookedkeys, &outMat);
+	PsychSetStructArrayNativeElement("CookedKey", 0, outMat, retevents);
+
+	if (ncopy) {
+		PsychMemoryBarrier();
+		readpos = hidEventBufferReadPos[deviceIndex];
+		for (i = 0; i < ncopy; i++) {
+			j = (readpos + i) & (hidEventBufferCapacity[deviceIndex] - 1);
+			evt = &(hidEventBuffer[deviceIndex][j]);
+			times[i] = evt->timestamp;
+			pressed[i] = (evt->status & (1<<0)) ? 1 : 0;
+			keycodes[i] = (double) evt->rawEventCode;
+			cookedkeys[i] = (double) evt->cookedEventCode;
+		}
+
+		// Release all drained slots to the producer at once:
+		PsychMemoryBarrier();
+		hidEventBufferReadPos[deviceIndex] = readpos + ncopy;
+	}
+
+	return(navail - ncopy);
+}
+
 int PsychHIDAddEventToEventBuffer(int deviceIndex, PsychHIDEventRecord* evt)
 {
-	unsigned int navail;
-	
+	unsigned int navail, writepos;
+
 	if (deviceIndex < 0) deviceIndex = PsychHIDGetDefaultKbQueueDevice();	
 
 	if (!hidEventBuffer[deviceIndex]) return(0);
-	
-	PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
 
-	navail = hidEventBufferWritePos[deviceIndex] - hidEventBufferReadPos[deviceIndex];	
+	writepos = hidEventBufferWritePos[deviceIndex];
+	navail = writepos - hidEventBufferReadPos[deviceIndex];
 	if (navail < hidEventBufferCapacity[deviceIndex]) {
-		memcpy(&(hidEventBuffer[deviceIndex][hidEventBufferWritePos[deviceIndex] % hidEventBufferCapacity[deviceIndex]]), evt, sizeof(PsychHIDEventRecord));
-		hidEventBufferWritePos[deviceIndex]++;
-
-		// Announce new event to potential waiters:
-		PsychSignalCondition(&hidEventBufferCondition[deviceIndex]);
+		// Make sure the consumer is done with reading this slot before we overwrite it:
+		PsychMemoryBarrier();
+		memcpy(&(hidEventBuffer[deviceIndex][writepos & (hidEventBufferCapacity[deviceIndex] - 1)]), evt, sizeof(PsychHIDEventRecord));
+
+		// Publish the slot contents before publishing the new write position:
+		PsychMemoryBarrier();
+		hidEventBufferWritePos[deviceIndex] = writepos + 1;
+		PsychMemoryBarrier();
+
+		// Announce new event to potential waiters, if any. Only then do we need the mutex:
+		if (hidEventBufferWaiting[deviceIndex]) {
+			PsychLockMutex(&hidEventBufferMutex[deviceIndex]);
+			PsychSignalCondition(&hidEventBufferCondition[deviceIndex]);
+			PsychUnlockMutex(&hidEventBufferMutex[deviceIndex]);
+		}
 	}
 	else {
 		printf("PsychHID: WARNING: KbQueue event buffer is full! Maximum capacity of %i elements reached, will discard future events.\n", hidEventBufferCapacity[deviceIndex]);
 	}
 
-	PsychUnlockMutex(&hidEventBufferMutex[deviceIndex]);
-
 	return(navail - 1);
 }
 
@@ -98,3 +98,61 @@ PsychError PSYCHHIDKbQueueGetEvent(void)
 
     return(PsychError_none);
 }
+
+PsychError PSYCHHIDKbQueueGetEvents(void)
+{
+	static char useString[]= "[events, navail] = PsychHID('KbQueueGetEvents' [, deviceIndex][, maxWaitTimeSecs=0][, maxEvents=inf])";
+	static char synopsisString[] = 
+        "Fetches all queued keyboard or button events generated by a device in one call.\n"
+        "This is a bulk version of PsychHID('KbQueueGetEvent'), which is more efficient when "
+        "many events need to be fetched at once, e.g., from high rate response boxes.\n"
+        "Up to 'maxEvents' of the oldest queued events are removed from the queue and returned in "
+        "the struct 'events'. If 'maxEvents' is omitted, all queued events are returned. The number of "
+        "queued events remaining in the queue after fetching is returned in 'navail'.\n"
+        "'maxWaitTimeSecs' is an optional maximum wait time for a new event in seconds. "
+        "It defaults to zero, which means to just poll for pending events. A positive value "
+        "will wait until either at least one event arrived or the given amount of time elapses, "
+        "whatever comes first.\n"
+        "The returned struct 'events' contains the same fields as the event struct returned by "
+        "PsychHID('KbQueueGetEvent'), but each field is a 1-by-n row vector, with one column per "
+        "event, in order of arrival. If no events are available, the vectors are empty:\n"
+        "'Keycode' = The KbCheck / KbName style keycodes of the keys or buttons that triggered the events.\n"
+        "'Time' = The GetSecs times of when the events were received.\n"
+        "'Pressed' = 1 for a key press event, 0 for a key release event.\n"
+        "'CookedKey' = Keycodes translated into GetChar() style ASCII character codes. Or zero if key "
+        "does not have a corresponding character. Or -1 if mapping is unsupported for given event.\n\n"
+        "PsychHID('KbQueueCreate') must be called before this routine and PsychHID('KbQueueStart') "
+        "must then be called for any events to get recorded into the event buffer.\n"
+        "The optional 'deviceIndex' is the index of the HID input device whose queue should be queried. "
+        "If omitted, the queue of the default device will be queried.\n";
+
+	static char seeAlsoString[] = "KbQueueGetEvent, KbQueueCreate, KbQueueStart, KbQueueStop, KbQueueFlush, KbQueueRelease";
+
+    int deviceIndex;
+	unsigned int navail, maxEvents;
+	double maxWaitTimeSecs, maxEventsArg;
+
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+    PsychErrorExit(PsychCapNumOutputArgs(2));
+    PsychErrorExit(PsychCapNumInputArgs(3));
+
+    deviceIndex = -1;
+    PsychCopyInIntegerArg(1, kPsychArgOptional, &deviceIndex);
+
+	maxWaitTimeSecs = 0;
+	PsychCopyInDoubleArg(2, kPsychArgOptional, &maxWaitTimeSecs);
+
+	maxEvents = UINT_MAX;
+	if (PsychCopyInDoubleArg(3, kPsychArgOptional, &maxEventsArg)) {
+		if (maxEventsArg < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'maxEvents' specified. Must be zero or a positive number.");
+		if (maxEventsArg < (double) UINT_MAX) maxEvents = (unsigned int) maxEventsArg;
+	}
+
+	// Drain up to maxEvents events from buffer, return them as 1st return argument:
+    navail = PsychHIDReturnEventsFromEventBuffer(deviceIndex, 1, maxWaitTimeSecs, maxEvents);
+    PsychCopyOutDoubleArg(2, FALSE, (double) navail);
+
+    return(PsychError_none);
+}
@@ -112,6 +112,9 @@ void *mxCalloc(size_t n, size_t size);
 // internal prototypes
 PsychError ReceiveReportsStop(int deviceIndex);  // function is below.
 void CountReports(char *string);
+static long PsychHIDStartReportReader(int deviceIndex, void *dev);
+static void PsychHIDStopReportReader(int deviceIndex);
+static void PsychHIDPrintReaderReports(int deviceIndex);
 
 typedef struct ReportStruct{
 	int deviceIndex;
@@ -119,10 +122,24 @@ typedef struct ReportStruct{
 	psych_uint32 bytes;
 	double time;
 	//int type; // 1=input, 2=output, 3=feature
-	struct ReportStruct *next;
 	psych_uint8 *report;
 } ReportStruct;
 
+// Per device state of the background reader thread, which fetches reports from the device as
+// soon as they arrive, timestamps them and enqueues them into the devices report ring:
+typedef struct ReportReader {
+	psych_thread thread;            // Handle of reader thread.
+	psych_bool running;             // Thread created and not yet joined?
+	psych_bool stop;                // Request to thread to stop. Protected by reportsMutex.
+	long error;                     // Error code of hid_read() if thread stopped due to error. Protected by reportsMutex.
+	void *device;                   // hid_device* to read from, NULL for simulated reports.
+	psych_bool simulated;           // Reports are simulated instead of read from a device.
+	double simulateRate;            // Rate of simulated reports in Hz.
+	unsigned int dropped;           // Count of reports discarded due to full ring. Protected by reportsMutex.
+	unsigned int droppedReported;   // Count of dropped reports already warned about.
+	unsigned int summariesPrinted;  // Count of oldest received reports already printed for options.print. Main thread only.
+} ReportReader;
+
 static psych_bool firstTimeInit = TRUE;         // TRUE at PsychHID load & init time and after shutdown. FALSE during operation.
 
 // These are out here for easy access by several routines in this file.
@@ -134,20 +151,113 @@ static psych_bool optionsConsistencyChecks=0;	// options.consistencyChecks
 static int optionsMaxReports=10000;			// options.maxReports
 static int optionsMaxReportSize=65;			// options.maxReportSize
 static double optionsSecs=0.010;			// options.secs
-
-// These are out here for easy access by my report callback function: ReportCallback.
-static ReportStruct *freeReportsPtr[MAXDEVICEINDEXS];   // Per device linked list of free hid input reports.
-static ReportStruct *deviceReportsPtr[MAXDEVICEINDEXS]; // Per device linked list of filled hid input reports.
-
-static ReportStruct *allocatedReports[MAXDEVICEINDEXS]; // Per device linked list storage - list is tightly packed in memory.
+static double optionsSimulateRate=0;		// options.simulateRate: Non-persistent.
+
+// These are out here for easy access by my report callback function and the reader threads.
+// Reports of a device are stored in a FIFO ring of MaxDeviceReports slots: reportsHead is the
+// slot of the oldest received report, reportsCount the number of received reports. Both are
+// protected by reportsMutex, the content of the slots between head and head + count is owned
+// by the consumer, the content of all other slots by the producer of reports:
+static ReportStruct *allocatedReports[MAXDEVICEINDEXS]; // Per device ring of reports - tightly packed in memory.
+static unsigned int reportsHead[MAXDEVICEINDEXS];       // Per device ring slot of oldest received report.
+static unsigned int reportsCount[MAXDEVICEINDEXS];      // Per device number of received reports in ring.
+static psych_mutex reportsMutex[MAXDEVICEINDEXS];       // Per device lock for ring and reader state.
+static ReportReader readers[MAXDEVICEINDEXS];           // Per device reader thread state.
 static psych_bool reportsHaveBeenAllocated[MAXDEVICEINDEXS]; // Allocated flag.
 static int MaxDeviceReports[MAXDEVICEINDEXS];           // Per device number of total reports.
 static int MaxDeviceReportSize[MAXDEVICEINDEXS];        // Per device max size of each report.
 psych_uint8 * reportData[MAXDEVICEINDEXS];              // Per device buffer for all reports databuffers, tightly packed.
 
-// Set by PsychHIDSetReport, read by ReportCallback solely for the optionsPrintReportSummary.
+// Return next free report slot in the ring of deviceIndex for filling in by the producer, or NULL if the ring is full:
+static ReportStruct* PsychHIDGetFreeReport(int deviceIndex)
+{
+	ReportStruct *r = NULL;
+
+	PsychLockMutex(&reportsMutex[deviceIndex]);
+	if (reportsCount[deviceIndex] < (unsigned int) MaxDeviceReports[deviceIndex])
+		r = &(allocatedReports[deviceIndex][(reportsHead[deviceIndex] + reportsCount[deviceIndex]) % MaxDeviceReports[deviceIndex]]);
+	PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+	return(r);
+}
+
+// Append the report slot filled in after PsychHIDGetFreeReport() to the received reports:
+static void PsychHIDCommitReport(int deviceIndex)
+{
+	PsychLockMutex(&reportsMutex[deviceIndex]);
+	reportsCount[deviceIndex]++;
+	PsychUnlockMutex(&reportsMutex[deviceIndex]);
+}
+
+// Return number of received reports, and ring slot of the oldest one in *head:
+static unsigned int PsychHIDPendingReports(int deviceIndex, unsigned int *head)
+{
+	unsigned int n;
+
+	PsychLockMutex(&reportsMutex[deviceIndex]);
+	*head = reportsHead[deviceIndex];
+	n = reportsCount[deviceIndex];
+	PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+	return(n);
+}
+
+// Return the n oldest received reports to the free part of the ring:
+static void PsychHIDReleaseReports(int deviceIndex, unsigned int n)
+{
+	if (n == 0) return;
+
+	PsychLockMutex(&reportsMutex[deviceIndex]);
+	reportsHead[deviceIndex] = (reportsHead[deviceIndex] + n) % MaxDeviceReports[deviceIndex];
+	reportsCount[deviceIndex] -= n;
+	PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+	readers[deviceIndex].summariesPrinted -= (n < readers[deviceIndex].summariesPrinted) ? n : readers[deviceIndex].summariesPrinted;
+}
+
+// Set by PsychHIDSetReport, read by PsychHIDPrintReportSummary solely for the optionsPrintReportSummary.
 double AInScanStart=0;
 
+// Print diagnostic summary of a received report for options.print:
+static void PsychHIDPrintReportSummary(ReportStruct *r)
+{
+	int i,n,m;
+	int serial;
+
+	serial=r->report[62]+256*r->report[63]; // 32-bit serial number at end of AInScan report from PMD-1208FS
+	printf("Got input report %4d: %2ld bytes, dev. %d, %4.0f ms. ",serial,(long)r->bytes,(int)r->deviceIndex,1000*(r->time-AInScanStart));
+	if(r->bytes>0){
+		printf(" report ");
+		n=r->bytes;
+		if(n>6)n=6;
+		for(i=0;i<n;i++)printf("%3d ",(int)r->report[i]);
+		m=r->bytes-2;
+		if(m>i){
+			printf("... ");
+			i=m;
+		}
+		for(;i<r->bytes;i++)printf("%3d ",(int)r->report[i]);
+	}
+	printf("\n");
+}
+
+// Print summaries of the reports received by the reader thread of deviceIndex since the last call, for
+// options.print. The reader thread must not print itself, so this is called from the main thread whenever
+// it checks on the reader or consumes reports. Reports are printed when the main thread sees them, not
+// when they arrive:
+static void PsychHIDPrintReaderReports(int deviceIndex)
+{
+	unsigned int i, n, head;
+
+	if (!optionsPrintReportSummary || !readers[deviceIndex].running) return;
+
+	n = PsychHIDPendingReports(deviceIndex, &head);
+	for (i = readers[deviceIndex].summariesPrinted; i < n; i++)
+		PsychHIDPrintReportSummary(&(allocatedReports[deviceIndex][(head + i) % MaxDeviceReports[deviceIndex]]));
+
+	readers[deviceIndex].summariesPrinted = n;
+}
+
 #if PSYCH_SYSTEM == PSYCH_OSX
 
 #include <IOKit/HID/IOHIDLib.h>
@@ -160,7 +270,7 @@ void ReportCallback(void *target,IOReturn result,void *refcon,void *sender,psych
 
 void ReportCallback(void *target,IOReturn result,void *refcon,void *sender,psych_uint32 bufferSize)
 {
-	int deviceIndex,i,n,m;
+	int deviceIndex,i;
 	unsigned char *ptr;
 	ReportStruct *r;
 	
@@ -172,22 +282,15 @@ void ReportCallback(void *target,IOReturn result,void *refcon,void *sender,psych
 		return;
 	}
 	
-	// take report from free list.
-	if(freeReportsPtr[deviceIndex] == NULL){
+	// take a free slot from the device's report ring.
+	r = PsychHIDGetFreeReport(deviceIndex);
+	if(r == NULL){
 		// Darn. We're full. It might be elegant to discard oldest report, but for now, we'll just ignore the new one.
 		printf("ReportCallback warning. No more free reports. Discarding new report.\n");
 		return;
 	}
-    
-	r = freeReportsPtr[deviceIndex];
-	freeReportsPtr[deviceIndex] = r->next;
-	r->next=NULL;
 	
-	// install report into the device's list.
-	r->next = deviceReportsPtr[deviceIndex];
-	deviceReportsPtr[deviceIndex] = r;
-	
-	// fill in the rest of the report struct
+	// fill in the report struct
 	r->error=result;
 	r->bytes=bufferSize;
 	r->deviceIndex=deviceIndex;
@@ -203,24 +306,12 @@ void ReportCallback(void *target,IOReturn result,void *refcon,void *sender,psych
 	PsychGetPrecisionTimerSeconds(&r->time);
 	if(optionsPrintReportSummary){
 		// print diagnostic summary of the report
-		int serial;
-		
-		serial=r->report[62]+256*r->report[63]; // 32-bit serial number at end of AInScan report from PMD-1208FS
-		printf("Got input report %4d: %2ld bytes, dev. %d, %4.0f ms. ",serial,(long)r->bytes,deviceIndex,1000*(r->time-AInScanStart));
-		if(r->bytes>0){
-			printf(" report ");
-			n=r->bytes;
-			if(n>6)n=6;
-			for(i=0;i<n;i++)printf("%3d ",(int)r->report[i]);
-			m=r->bytes-2;
-			if(m>i){
-				printf("... ");
-				i=m;
-			}
-			for(;i<r->bytes;i++)printf("%3d ",(int)r->report[i]);
-		}
-		printf("\n");
+		PsychHIDPrintReportSummary(r);
 	}
+
+	// install report into the device's ring.
+	PsychHIDCommitReport(deviceIndex);
+
 	CountReports("ReportCallback end.");
 	return;
 }
@@ -240,7 +331,12 @@ PsychError ReceiveReports(int deviceIndex)
     PsychHIDAllocateReports(deviceIndex);
 
 	CountReports("ReceiveReports beginning.");
-	if (freeReportsPtr[deviceIndex] == NULL) PrintfExit("No free reports.");
+
+	// Simulated reports are generated by a reader thread instead of the CFRunLoop callback:
+	if(optionsSimulateRate > 0 || readers[deviceIndex].running){
+		ready[deviceIndex]=1;
+		return(PsychHIDStartReportReader(deviceIndex, NULL));
+	}
 
 	device=PsychHIDGetDeviceRecordPtrFromIndex(deviceIndex);
 	if(!HIDIsValidDevice(device))PrintfExit("PsychHID: Invalid device.\n");
@@ -297,6 +393,14 @@ PsychError ReceiveReports(int deviceIndex)
 
 PsychError ReceiveReportsStop(int deviceIndex)
 {
+	if(deviceIndex < 0 || deviceIndex >= MAXDEVICEINDEXS) PrintfExit("Sorry. Can't cope with deviceNumber %d (more than %d). Please tell denis.pelli@nyu.edu",deviceIndex,(int)MAXDEVICEINDEXS-1);
+
+	if(readers[deviceIndex].simulated){
+		PsychHIDStopReportReader(deviceIndex);
+		ready[deviceIndex]=0;
+		return 0;
+	}
+
 	CheckRunLoopSource(deviceIndex,"ReceiveReportsStop",__LINE__);
 	if(ready[deviceIndex]){
 		// Rob Yepez, at Apple, suggested that it might be better to call CFRunLoopRemoveSource than CFRunLoopSourceInvalidate.
@@ -379,23 +483,20 @@ void CheckRunLoopSource(int deviceIndex,char *caller,int line){
 extern hid_device* source[MAXDEVICEINDEXS]; 
 extern hid_device* last_hid_device;
 
-/* Do all the report processing for all devices: Iterates in a fetch loop
- * until error condition, or a maximum allowable processing time of
- * optionSecs seconds has been exceeded.
- *
- * Calls hidlib function hid_read() to get reports, one at a time, enqueues
- * it in our own reports lists for later retrieval by 'GiveMeReports' or
- * 'GiveMeReport'.
+/* Start reception of reports for a device: Starts a background reader thread
+ * for the device, if it isn't running already. The thread calls hidlib function
+ * hid_read_timeout() to get reports, one at a time, timestamps them on arrival
+ * and enqueues them in the devices report ring for later retrieval by
+ * 'GiveMeReports', 'GiveReports' or 'GiveMeReport'.
  *
+ * Returns the error code of a failed hid_read() if the reader thread stopped
+ * due to a read error since the last call. The thread gets restarted by the
+ * next call.
  */
 PsychError ReceiveReports(int deviceIndex)
 {
-    int rateLimit[MAXDEVICEINDEXS] = { 0 };
-    double deadline, now;
     pRecDevice device;
-    int n, m;
-    unsigned int i;
-    ReportStruct *r;
+    void *dev = NULL;
     long error = 0;
 
     PsychHIDVerifyInit();
@@ -406,105 +507,19 @@ PsychError ReceiveReports(int deviceIndex)
     PsychHIDAllocateReports(deviceIndex);
 
     CountReports("ReceiveReports beginning.");
-    if (freeReportsPtr[deviceIndex] == NULL) PrintfExit("No free reports.");
+
+    // Open real device, unless simulated reports are requested or the reader is already running:
+    if (!readers[deviceIndex].running && (optionsSimulateRate <= 0)) {
+        device = PsychHIDGetDeviceRecordPtrFromIndex(deviceIndex);
+        last_hid_device = (hid_device*) device->interface;
+        dev = device->interface;
+    }
 
     // Enable this device for hid report reception:
     ready[deviceIndex] = TRUE;
 
-    PsychGetAdjustedPrecisionTimerSeconds(&now);
-    deadline = now + optionsSecs;
-    
-    // Iterate until deadline reached or no more pending reports to process:
-    while ((error == 0) && (now <= deadline)) {
-        // Iterate over all active devices:
-        for (deviceIndex = 0; deviceIndex < MAXDEVICEINDEXS; deviceIndex++) {            
-            // Test for timeout:
-            PsychGetAdjustedPrecisionTimerSeconds(&now);
-            if (now > deadline) break;
-
-            // Skip this device if it isn't enabled to receive hid reports:
-            if (!ready[deviceIndex]) continue;
-            
-            // Free target report buffers?
-            if(freeReportsPtr[deviceIndex] == NULL) {
-                // Darn. We're full. It might be elegant to discard oldest report, but for now, we'll just ignore the new one.
-                if (!rateLimit[deviceIndex]) printf("PsychHID: WARNING! ReportCallback warning. No more free reports for deviceIndex %i. Discarding new report.\n", deviceIndex);
-                rateLimit[deviceIndex] = 1;
-                continue;
-            }
-            
-            // Handle one report for this device:
-            CountReports("ReportCallback beginning.");
-
-            device = PsychHIDGetDeviceRecordPtrFromIndex(deviceIndex);
-            last_hid_device = (hid_device*) device->interface;
-
-            // Get a report struct to fill in:
-            r = freeReportsPtr[deviceIndex];
-
-            // Fetch the actual data: Bytes fetched, or zero for no reports available, or
-            // -1 for error condition.
-            r->error = hid_read((hid_device*) device->interface, &(r->report[0]), MaxDeviceReportSize[deviceIndex]);
-
-            // Skip remainder if no data received:
-            if (r->error == 0) continue;
-
-            // Ok, we got something, even if it is only an error code. Need
-            // to move the (r)eport from the free list to the received list:
-            freeReportsPtr[deviceIndex] = r->next;
-            r->next=NULL;
-            
-            // install report into the device's list.
-            r->next = deviceReportsPtr[deviceIndex];
-            deviceReportsPtr[deviceIndex] = r;
-            
-            // fill in the rest of the report struct
-            r->deviceIndex = deviceIndex;
-            
-            // Timestamp processing:
-            PsychGetPrecisionTimerSeconds(&r->time);
-
-            // Success or error?
-            if (r->error > 0) {
-                // Success: Reset error, assign size of retrieved report:
-                r->bytes = r->error;
-                r->error = 0;
-            }
-            else {
-                // Error: No data assigned.
-                r->bytes = 0;
-                
-                // Signal error return code -1:
-                error = -1;
-                
-                // Abort fetch loop:
-                break;
-            }
+    error = PsychHIDStartReportReader(deviceIndex, dev);
 
-            if (optionsPrintReportSummary) {
-                // print diagnostic summary of the report
-                int serial;
-                
-                serial = r->report[62] + 256 * r->report[63]; // 32-bit serial number at end of AInScan report from PMD-1208FS
-                printf("Got input report %4d: %2ld bytes, dev. %d, %4.0f ms. ", serial, (long) r->bytes, deviceIndex, 1000 * (r->time - AInScanStart));
-                if(r->bytes>0) {
-                    printf(" report ");
-                    n = r->bytes;
-                    if (n > 6) n=6;
-                    for(i=0; i < (unsigned int) n; i++) printf("%3d ", (int) r->report[i]);
-                    m = r->bytes - 2;
-                    if (m > (int) i) {
-                        printf("... ");
-                        i = m;
-                    }
-                    for(; i < r->bytes; i++) printf("%3d ", (int) r->report[i]);
-                }
-                printf("\n");
-            }
-            CountReports("ReportCallback end.");
-        }
-    }
-    
     CountReports("ReceiveReports end.");
     return error;
 }
@@ -512,12 +527,20 @@ PsychError ReceiveReports(int deviceIndex)
 PsychError ReceiveReportsStop(int deviceIndex)
 {
 	pRecDevice device;
+	psych_bool simulated;
 
 	PsychHIDVerifyInit();
-    
+
+    if(deviceIndex < 0 || deviceIndex >= MAXDEVICEINDEXS) PrintfExit("Sorry. Can't cope with deviceNumber %d (more than %d). Please tell denis.pelli@nyu.edu",deviceIndex, (int) MAXDEVICEINDEXS-1);
+
     // Disable HID report reception:
     ready[deviceIndex] = FALSE;
 
+    // Stop reader thread before the device gets closed:
+    simulated = readers[deviceIndex].simulated;
+    PsychHIDStopReportReader(deviceIndex);
+    if (simulated) return 0;
+
 	device = PsychHIDGetDeviceRecordPtrFromIndex(deviceIndex);
 	last_hid_device = (hid_device*) device->interface;
 
@@ -540,18 +563,209 @@ PsychError PsychHIDReceiveReportsCleanup(void)
 // OS INDEPENDENT CODE:
 // ====================
 
+// Background reader thread of a device: Fetches reports from the device as soon as they arrive, or
+// generates simulated reports at a fixed rate, timestamps them and appends them to the devices ring:
+static void* ReportReaderThreadMain(void *arg)
+{
+    int deviceIndex = (int) (long) arg;
+    ReportReader *reader = &readers[deviceIndex];
+    psych_uint8 scratch[MAXREPORTSIZE];
+    psych_uint8 *buffer;
+    psych_uint32 serial = 0;
+    ReportStruct *r;
+    double tNext;
+    int rc;
+
+    // Assign a name to ourselves, for debugging:
+    PsychSetThreadName("PsychHIDReports");
+
+    // Try to raise our priority, so reports get timestamped close to arrival:
+    if ((rc = PsychSetThreadPriority(NULL, 2, 1)) > 0) {
+        printf("PsychHID: ReceiveReports: Failed to switch reader thread to realtime priority [%s].\n", strerror(rc));
+    }
+
+    PsychGetPrecisionTimerSeconds(&tNext);
+
+    while (1) {
+        PsychLockMutex(&reportsMutex[deviceIndex]);
+        rc = reader->stop;
+        PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+        // Check if we should terminate:
+        if (rc) break;
+
+        // Get a report struct to fill in. If the ring is full, read into a scratch buffer,
+        // so the report gets consumed and discarded:
+        r = PsychHIDGetFreeReport(deviceIndex);
+        buffer = (r) ? r->report : scratch;
+
+        if (!reader->simulated) {
+            // Fetch the actual data: Bytes fetched, or zero for no reports available within 10 msecs, or
+            // -1 for error condition. The timeout bounds the time until we notice a stop request:
+            #if PSYCH_SYSTEM != PSYCH_OSX
+                rc = hid_read_timeout((hid_device*) reader->device, buffer, MaxDeviceReportSize[deviceIndex], 10);
+            #else
+                rc = -1;
+            #endif
+        }
+        else {
+            // Simulated report at next tick of the requested rate, with a 32-bit serial number in the
+            // first bytes, for detection of lost reports by usercode:
+            tNext += 1.0 / reader->simulateRate;
+            PsychWaitUntilSeconds(tNext);
+            memset(buffer, 0, MaxDeviceReportSize[deviceIndex]);
+            for (rc = 0; (rc < 4) && (rc < MaxDeviceReportSize[deviceIndex]); rc++) buffer[rc] = (psych_uint8) (serial >> (8 * rc));
+            serial++;
+            rc = MaxDeviceReportSize[deviceIndex];
+        }
+
+        // Skip remainder if no data received:
+        if (rc == 0) continue;
+
+        if (r == NULL) {
+            // Darn. We're full. It might be elegant to discard oldest report, but for now, we'll just ignore the new one.
+            // The main thread warns about it, as printing from this thread is not safe:
+            PsychLockMutex(&reportsMutex[deviceIndex]);
+            reader->dropped++;
+            PsychUnlockMutex(&reportsMutex[deviceIndex]);
+        }
+        else {
+            // Timestamp processing:
+            PsychGetPrecisionTimerSeconds(&r->time);
+            r->deviceIndex = deviceIndex;
+
+            // Success or error?
+            if (rc > 0) {
+                // Success: Reset error, assign size of retrieved report:
+                r->bytes = rc;
+                r->error = 0;
+            }
+            else {
+                // Error: No data assigned.
+                r->bytes = 0;
+                r->error = rc;
+            }
+
+            PsychHIDCommitReport(deviceIndex);
+        }
+
+        if (rc < 0) {
+            // Read error: Report it to the main thread and stop reading until restarted by it:
+            PsychLockMutex(&reportsMutex[deviceIndex]);
+            reader->error = rc;
+            PsychUnlockMutex(&reportsMutex[deviceIndex]);
+            break;
+        }
+    }
+
+    return(NULL);
+}
+
+// Warn about reports discarded by the reader thread of deviceIndex since last warning, if any:
+static void PsychHIDReportDropWarning(int deviceIndex)
+{
+    unsigned int dropped;
+
+    PsychLockMutex(&reportsMutex[deviceIndex]);
+    dropped = readers[deviceIndex].dropped;
+    PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+    if (dropped != readers[deviceIndex].droppedReported) {
+        printf("PsychHID: WARNING! No more free reports for deviceIndex %i. Discarded %u new reports so far. Call GiveMeReports or GiveReports more often, or increase options.maxReports!\n", deviceIndex, dropped);
+        readers[deviceIndex].droppedReported = dropped;
+    }
+}
+
+// Start reader thread for deviceIndex, reading from hid_device 'dev', or simulating reports if 'dev' is NULL.
+// If the thread is already running, collect and return the error code of a read error which stopped it, if any:
+static long PsychHIDStartReportReader(int deviceIndex, void *dev)
+{
+    ReportReader *reader = &readers[deviceIndex];
+    unsigned int head;
+    long error;
+
+    PsychHIDReportDropWarning(deviceIndex);
+    PsychHIDPrintReaderReports(deviceIndex);
+
+    if (reader->running) {
+        PsychLockMutex(&reportsMutex[deviceIndex]);
+        error = reader->error;
+        PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+        // Thread still running fine?
+        if (error == 0) return(0);
+
+        // Thread stopped due to read error. Join it, so the next call restarts it:
+        PsychDeleteThread(&reader->thread);
+        PsychHIDPrintReaderReports(deviceIndex);
+        reader->running = FALSE;
+        reader->error = 0;
+        return(error);
+    }
+
+    reader->device = dev;
+    reader->simulated = (dev == NULL);
+    reader->simulateRate = optionsSimulateRate;
+    reader->stop = FALSE;
+    reader->error = 0;
+
+    // Reports already in the ring are not from this thread, so only print newer ones:
+    reader->summariesPrinted = PsychHIDPendingReports(deviceIndex, &head);
+
+    if (reader->simulated && (reader->simulateRate <= 0)) PsychErrorExitMsg(PsychError_internal, "No device to read reports from!");
+
+    if (PsychCreateThread(&reader->thread, NULL, ReportReaderThreadMain, (void*) (long) deviceIndex)) {
+        printf("PsychHID-ERROR: Start of report reader thread for deviceIndex %i failed!\n", deviceIndex);
+        PsychErrorExitMsg(PsychError_system, "Creation of report reader background thread failed!");
+    }
+
+    reader->running = TRUE;
+    return(0);
+}
+
+// Stop reader thread for deviceIndex, if any. Afterwards the device is no longer in simulation mode,
+// so a following ReceiveReports without options.simulateRate uses the real device again:
+static void PsychHIDStopReportReader(int deviceIndex)
+{
+    ReportReader *reader = &readers[deviceIndex];
+
+    reader->simulated = FALSE;
+    if (!reader->running) return;
+
+    PsychLockMutex(&reportsMutex[deviceIndex]);
+    reader->stop = TRUE;
+    PsychUnlockMutex(&reportsMutex[deviceIndex]);
+
+    PsychDeleteThread(&reader->thread);
+    PsychHIDPrintReaderReports(deviceIndex);
+    reader->running = FALSE;
+    reader->error = 0;
+}
+
 void PsychHIDReleaseAllReportMemory(void)
 {
-    int deviceIndex;    
-    for(deviceIndex = 0; deviceIndex < MAXDEVICEINDEXS; deviceIndex++) {        
-        if (!firstTimeInit && reportsHaveBeenAllocated[deviceIndex]) {
-            free(allocatedReports[deviceIndex]);
-            free(reportData[deviceIndex]);
+    int deviceIndex;
+
+    for(deviceIndex = 0; deviceIndex < MAXDEVICEINDEXS; deviceIndex++) {
+        if (firstTimeInit) {
+            // Init: Create locks for the report rings:
+            PsychInitMutex(&reportsMutex[deviceIndex]);
         }
-        
+        else {
+            // Shutdown: Stop all reader threads before anything gets released:
+            PsychHIDStopReportReader(deviceIndex);
+            PsychDestroyMutex(&reportsMutex[deviceIndex]);
+
+            if (reportsHaveBeenAllocated[deviceIndex]) {
+                free(allocatedReports[deviceIndex]);
+                free(reportData[deviceIndex]);
+            }
+        }
+
         // Reset all stuff that needs to be reset at PsychHID init and shutdown:
-        freeReportsPtr[deviceIndex] = NULL;
-        deviceReportsPtr[deviceIndex] = NULL;
+        reportsHead[deviceIndex] = 0;
+        reportsCount[deviceIndex] = 0;
+        memset(&readers[deviceIndex], 0, sizeof(ReportReader));
         allocatedReports[deviceIndex] = NULL;
         reportData[deviceIndex] = NULL;        
         MaxDeviceReports[deviceIndex] = 0;
@@ -585,7 +799,7 @@ void PsychHIDAllocateReports(int deviceIndex)
         // Anything allocated that needs to be reallocated?
         if(reportsHaveBeenAllocated[deviceIndex]) {
             // Yes. Device stopped? Otherwise this is a no-go:
-            if (ready[deviceIndex]) {
+            if (ready[deviceIndex] || readers[deviceIndex].running) {
                 // No-No:
                 printf("PTB-WARNING:PsychHID:ReceiveReports: Tried to set new option.maxReportSize or option.maxReports on deviceIndex %i while report\n", deviceIndex);
                 printf("PTB-WARNING:PsychHID:ReceiveReports: processing is active. Call PsychHID('ReceiveReportsStop', %i); first to release old reports!\n", deviceIndex);
@@ -593,8 +807,8 @@ void PsychHIDAllocateReports(int deviceIndex)
                 // Release all databuffers, so they get reallocated below:
                 free(allocatedReports[deviceIndex]);
                 free(reportData[deviceIndex]);
-                freeReportsPtr[deviceIndex] = NULL;
-                deviceReportsPtr[deviceIndex] = NULL;
+                reportsHead[deviceIndex] = 0;
+                reportsCount[deviceIndex] = 0;
                 allocatedReports[deviceIndex] = NULL;
                 reportData[deviceIndex] = NULL;        
                 MaxDeviceReports[deviceIndex] = 0;
@@ -610,7 +824,7 @@ void PsychHIDAllocateReports(int deviceIndex)
 	if (!reportsHaveBeenAllocated[deviceIndex]) {
 		// Initial set up. Allocate free reports.
 
-        // Allocate common buffer to store linked list of all
+        // Allocate common buffer to store ring of all
         // ReportStruct's, tightly packed:
         allocatedReports[deviceIndex] = (ReportStruct*) calloc(optionsMaxReports, sizeof(ReportStruct));
         if (NULL == allocatedReports[deviceIndex]) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory while trying to allocate hid reports!");
@@ -632,19 +846,16 @@ void PsychHIDAllocateReports(int deviceIndex)
         MaxDeviceReports[deviceIndex] = optionsMaxReports;
         MaxDeviceReportSize[deviceIndex] = optionsMaxReportSize;
         
-        // Setup pointer mappings to create the linked-list in the memory buffers:
-		freeReportsPtr[deviceIndex] = allocatedReports[deviceIndex];
+        // Ring is empty:
+        reportsHead[deviceIndex] = 0;
+        reportsCount[deviceIndex] = 0;
+
 		for(i = 0; i < optionsMaxReports; i++) {
-            // Setup linked-list pointers for linked list of ReportStruct's
-            // insie the allocatedReports[deviceIndex] buffer:
-			r=&(allocatedReports[deviceIndex][i]);
-			r->next=&(allocatedReports[deviceIndex][i+1]);
-            
             // Setup pointer to associated actual HID report data buffer
             // inside the reportData[deviceIndex] buffer:
+			r=&(allocatedReports[deviceIndex][i]);
             r->report = &(reportData[deviceIndex][i * optionsMaxReportSize]);
 		}
-		r->next=NULL;        
 
 		reportsHaveBeenAllocated[deviceIndex] = TRUE;
 	}
@@ -652,37 +863,23 @@ void PsychHIDAllocateReports(int deviceIndex)
 
 void CountReports(char *string)
 {
-	int i, l1, l2;
-	ReportStruct *r;
+	int i;
+	unsigned int n, head;
 
 	// First time init at first invocation after PsycHID load time:
     #if PSYCH_SYSTEM == PSYCH_OSX
 	if (myRunLoopMode==NULL) myRunLoopMode=CFSTR("myMode"); // kCFRunLoopDefaultMode
     #endif
 
-	// Optional consistency check, disabled by default. Do the numbers of
-	// reports enqueued in the different device lists and the free list
-	// sum up to the total number of allocated reports? Print warning and
-	// current numbers if this is not the case:
+	// Optional consistency check, disabled by default. Is the number of
+	// reports enqueued in the device rings within the number of allocated
+	// reports? Print warning and current numbers if this is not the case:
 	if (optionsConsistencyChecks > 0) {
 		for(i = 0; i < MAXDEVICEINDEXS; i++) {
-			r = deviceReportsPtr[i];
-            l1 = 0;
-			while(r != NULL) {
-				r = r->next;
-				l1++;
-			}
-			
-			r = freeReportsPtr[i];
-            l2 = 0;
-			while(r != NULL) {
-				r = r->next;
-				l2++;
-			}
-		
-            if((l1 + l2) != MaxDeviceReports[i]) {
+			n = PsychHIDPendingReports(i, &head);
+            if((n > (unsigned int) MaxDeviceReports[i]) || (MaxDeviceReports[i] > 0 && head >= (unsigned int) MaxDeviceReports[i])) {
                 printf("%s", string);
-                printf(" device:reports. free:%3d, %2d:%3d",l2, i,l1);
+                printf(" device:reports. free:%3d, %2d:%3d",MaxDeviceReports[i] - (int) n, i, (int) n);
                 printf("\n");
             }
         }
@@ -691,44 +888,38 @@ void CountReports(char *string)
 
 // GiveMeReports is called solely by PsychHIDGiveMeReports, but the code resides here
 // in PsychHIDReceiveReports because it uses the typedefs and static variables that
-// are defined solely in this file. The linked lists of reports are unknown outside of this file.
+// are defined solely in this file. The rings of reports are unknown outside of this file.
 PsychError GiveMeReports(int deviceIndex,int reportBytes)
 {
 	mwSize dims[]={1,1};
 	mxArray **outReports;
-	ReportStruct *r,*rTail;
+	ReportStruct *r;
 	const char *fieldNames[]={"report", "device", "time"};
 	mxArray *fieldValue;
 	unsigned char *reportBuffer;
-	int i,n;
-    unsigned int j;
+	unsigned int i, n, head;
 	long error=0;
-	double now;
 	
+	if(deviceIndex < 0 || deviceIndex >= MAXDEVICEINDEXS) PrintfExit("Sorry. Can't cope with deviceNumber %d (more than %d). Please tell denis.pelli@nyu.edu",deviceIndex, (int) MAXDEVICEINDEXS-1);
+
 	CountReports("GiveMeReports beginning.");
+	PsychHIDReportDropWarning(deviceIndex);
+	PsychHIDPrintReaderReports(deviceIndex);
 
 	outReports=PsychGetOutArgMxPtr(1); 
-	r=deviceReportsPtr[deviceIndex];
-	n=0;
-	while(r!=NULL){
-		n++;
-		rTail=r;
-		r=r->next;
-	}
+	n=PsychHIDPendingReports(deviceIndex, &head);
 	*outReports=mxCreateStructMatrix(1,n,3,fieldNames);
-	r=deviceReportsPtr[deviceIndex];
-	PsychGetPrecisionTimerSeconds(&now);
-	for(i=n-1;i>=0;i--){
-		// assert(r!=NULL);
+	for(i=0;i<n;i++){
+		// oldest report first:
+		r=&(allocatedReports[deviceIndex][(head + i) % MaxDeviceReports[deviceIndex]]);
 		if(r->error)error=r->error;
 		dims[0]=1;
-		//printf("%2d: r->bytes %2d, reportBytes %4d, -%4.1f s\n",i,(int)r->bytes,(int)reportBytes, now-r->time);
 		if(r->bytes> (unsigned int) reportBytes)r->bytes=reportBytes;
 		dims[1]=r->bytes;
 		fieldValue=mxCreateNumericArray(2,(void *)dims,mxUINT8_CLASS,mxREAL);
-		reportBuffer=(void *)mxGetData(fieldValue);
-		for(j=0;j<r->bytes;j++)reportBuffer[j]=r->report[j];
 		if(fieldValue==NULL)PrintfExit("Couldn't allocate report array.");
+		reportBuffer=(void *)mxGetData(fieldValue);
+		memcpy(reportBuffer, r->report, r->bytes);
 		mxSetField(*outReports,i,"report",fieldValue);
 		fieldValue=mxCreateDoubleMatrix(1,1,mxREAL);
 		*mxGetPr(fieldValue)=(double)r->deviceIndex;
@@ -736,47 +927,85 @@ PsychError GiveMeReports(int deviceIndex,int reportBytes)
 		fieldValue=mxCreateDoubleMatrix(1,1,mxREAL);
 		*mxGetPr(fieldValue)=r->time;
 		mxSetField(*outReports,i,"time",fieldValue);
-		r=r->next;
-	}
-	if(deviceReportsPtr[deviceIndex]!=NULL){
-		// transfer all these now-obsolete reports to the free list
-		rTail->next=freeReportsPtr[deviceIndex];
-		freeReportsPtr[deviceIndex]=deviceReportsPtr[deviceIndex];
-		deviceReportsPtr[deviceIndex]=NULL;
 	}
+
+	// transfer all these now-obsolete reports to the free part of the ring
+	PsychHIDReleaseReports(deviceIndex, n);
+
 	CountReports("GiveMeReports end.");
 	return error;
 }
 
-// Called solely by PsychHIDGetReport, but resides here in order to access the linked list of reports.
+// GiveReports is called solely by PsychHIDGiveReports: Like GiveMeReports, but returns all reports
+// in one uint8 matrix with one column per report, plus vectors of timestamps and report lengths:
+PsychError GiveReports(int deviceIndex,int reportBytes)
+{
+	ReportStruct *r;
+	psych_uint8 *reports;
+	double *times, *lengths;
+	unsigned int i, n, m, head, bytes;
+	long error=0;
+
+	if(deviceIndex < 0 || deviceIndex >= MAXDEVICEINDEXS) PrintfExit("Sorry. Can't cope with deviceNumber %d (more than %d). Please tell denis.pelli@nyu.edu",deviceIndex, (int) MAXDEVICEINDEXS-1);
+	if(reportBytes < 0) reportBytes = 0;
+
+	CountReports("GiveReports beginning.");
+	PsychHIDReportDropWarning(deviceIndex);
+	PsychHIDPrintReaderReports(deviceIndex);
+
+	n=PsychHIDPendingReports(deviceIndex, &head);
+
+	// Number of rows is the size of the largest report, limited to reportBytes:
+	m=0;
+	for(i=0;i<n;i++){
+		r=&(allocatedReports[deviceIndex][(head + i) % MaxDeviceReports[deviceIndex]]);
+		if(r->bytes > m) m = r->bytes;
+	}
+	if(m > (unsigned int) reportBytes) m = (unsigned int) reportBytes;
+
+	PsychAllocOutUnsignedByteMatArg(1, kPsychArgOptional, m, n, 1, &reports);
+	PsychAllocOutDoubleMatArg(2, kPsychArgOptional, 1, n, 1, &times);
+	PsychAllocOutDoubleMatArg(3, kPsychArgOptional, 1, n, 1, &lengths);
+
+	for(i=0;i<n;i++){
+		// oldest report first:
+		r=&(allocatedReports[deviceIndex][(head + i) % MaxDeviceReports[deviceIndex]]);
+		if(r->error)error=r->error;
+		bytes = (r->bytes > m) ? m : r->bytes;
+		memcpy(&reports[(size_t) i * m], r->report, bytes);
+		if(bytes < m) memset(&reports[(size_t) i * m + bytes], 0, m - bytes);
+		times[i]=r->time;
+		lengths[i]=(double) bytes;
+	}
+
+	// transfer all these now-obsolete reports to the free part of the ring
+	PsychHIDReleaseReports(deviceIndex, n);
+
+	CountReports("GiveReports end.");
+	return error;
+}
+
+// Called solely by PsychHIDGetReport, but resides here in order to access the ring of reports.
 PsychError GiveMeReport(int deviceIndex,psych_bool *reportAvailablePtr,unsigned char *reportBuffer,psych_uint32 *reportBytesPtr,double *reportTimePtr)
 {
-	ReportStruct *r,*rOld;
+	ReportStruct *r;
 	long error;
-	unsigned int i;
+	unsigned int head;
 	
 	CountReports("GiveMeReport beginning.");
+	PsychHIDPrintReaderReports(deviceIndex);
 
-	r=deviceReportsPtr[deviceIndex];
-	if(r!=NULL){ // report available?
-				 // grab the oldest report for this device
+	if(PsychHIDPendingReports(deviceIndex, &head) > 0){ // report available?
+		// grab the oldest report for this device
+		r=&(allocatedReports[deviceIndex][head]);
 		*reportAvailablePtr=1;
-		if(r->next==NULL){
-			deviceReportsPtr[deviceIndex]=NULL;
-		}else{
-			while(r->next->next!=NULL)r=r->next;
-			rOld=r;
-			r=r->next;
-			rOld->next=NULL;
-		}
 		if(*reportBytesPtr > r->bytes)*reportBytesPtr=r->bytes;
-		for(i=0;i<*reportBytesPtr;i++)reportBuffer[i]=r->report[i];
+		memcpy(reportBuffer, r->report, *reportBytesPtr);
 		*reportTimePtr=r->time;
 		error=r->error;
 		
-		// add it to the free list
-		r->next=freeReportsPtr[deviceIndex];
-		freeReportsPtr[deviceIndex]=r;
+		// return it to the free part of the ring
+		PsychHIDReleaseReports(deviceIndex, 1);
 	}else{
 		*reportAvailablePtr=0;
 		*reportBytesPtr=0;
@@ -798,7 +1027,9 @@ static char synopsisString[]=
 "The returned value \"err.n\" is zero upon success and a nonzero error code upon failure, "
 "as spelled out by \"err.name\" and \"err.description\". "
 "\"deviceNumber\" specifies which device.\n"
-"\"options.print\" =1 (initial default 0) enables diagnostic printing of a summary of each report when our callback routine receives it.\n"	
+"\"options.print\" =1 (initial default 0) enables diagnostic printing of a summary of each report when our callback routine receives it. "
+"Reports fetched by a background reader thread, ie. on Linux and Windows, or simulated ones, get printed later, when they are collected "
+"by the next call to ReceiveReports, GiveMeReports, GiveReports, GetReport or ReceiveReportsStop.\n"	
 "\"options.printCrashers\" =1 (initial default 0) enables diagnostic printing of the creation of the callback source and its addition to the CFRunLoop.\n"
 "\"options.consistencyChecks\" =1 (initial default 0) enables diagnostic printing of the consistency of all report structs. Very time consuming!\n"
 "\"options.maxReports\" (initial default 10000) allocate space for at least this many reports for the given device.\n"
@@ -806,7 +1037,15 @@ static char synopsisString[]=
 "64 Bytes, so allowing for one extra byte for the reportID, a default of 65 Bytes is usually sufficient. If you need more, you can increase "
 "this value up to 8192 Bytes. If you need even more, contact us, because likely you are doing something wrong. Smaller values than 65 may "
 "make sense if you are very tight on memory.\n"
-"\"options.secs\" (initial default 0.010 s) is how long to allow the function to process reports received from all active HID devices. "
+"\"options.simulateRate\" (default 0) if set to a rate in Hz, simulates a device which sends reports at that rate, instead of receiving "
+"reports from a real device. Each simulated report has options.maxReportSize bytes and carries a 32-bit serial number in its first four bytes, "
+"least significant byte first, so lost reports can be detected. This is non-persistent and only takes effect if reception for \"deviceNumber\" "
+"isn't already active. The \"deviceNumber\" doesn't need to correspond to an actual device, which allows testing of report reception "
+"without any hardware. Use ReceiveReportsStop to end the simulation.\n"
+"On Linux and MS-Windows, the first call to ReceiveReports for a device starts a background thread for that device, which receives each "
+"report as soon as it arrives, timestamps it and stores it. Further calls to ReceiveReports only check for errors and return immediately, "
+"so \"options.secs\" is ignored on these systems. ReceiveReportsStop stops the thread.\n"
+"\"options.secs\" (initial default 0.010 s) is how long to allow the function to process reports received from all active HID devices on OS/X. "
 "The operating system receives reports all the time after the first call to 'ReceiveReports' or 'GetReport'. "
 "It has a small buffer capacity, discarding the oldest received reports if its small buffer is full. When requested by PsychHID, the OS "
 "tranfers reports to PsychHID (for all devices for which ReceiveReports is still active). "
@@ -816,7 +1055,7 @@ static char synopsisString[]=
 "Calling ReceiveReports enables callbacks (forever) for the incoming reports from that device; "
 "call ReceiveReportsStop to halt acquisition of further reports for a device; "
 " you can resume acquisition for a device by calling ReceiveReports again. "
-"Call GiveMeReports to get all the received reports and empty PsychHID's internal store for a device. "
+"Call GiveMeReports or GiveReports to get all the received reports and empty PsychHID's internal store for a device. "
 "PsychHID can hold up to options.maxReports reports, and discards new incoming reports when it has no room to hold them. "
 "For prolonged data acquisition you may need to call GiveMeReports periodically, emptying PsychHID's store before it becomes full.\n"
 "PsychHID was enhanced by adding HID commands to send and receive HID reports to support the PMD-1208FS. "
@@ -827,7 +1066,7 @@ static char synopsisString[]=
 "but we tested it primarily with the PMD-1208FS, "
 "as well as keyboards, mice, and gamepads, so working with new devices may be an adventure. ";
 
-static char seeAlsoString[]="SetReport, ReceiveReportsStop, GiveMeReports";
+static char seeAlsoString[]="SetReport, ReceiveReportsStop, GiveMeReports, GiveReports";
 
 PsychError PSYCHHIDReceiveReports(void)
 {
@@ -856,6 +1095,9 @@ PsychError PSYCHHIDReceiveReports(void)
 	//optionsMaxReportSize=65;		// options.maxReportSize
 	//optionsSecs=0.010;			// options.secs
     
+	// Non-persistent options:
+	optionsSimulateRate=0;
+
 	mxOptions=PsychGetInArgMxPtr(2);
 	if(mxOptions!=NULL){
 		mx=mxGetField(mxOptions,0,"print");
@@ -866,6 +1108,8 @@ PsychError PSYCHHIDReceiveReports(void)
 		if(mx!=NULL)optionsSecs=mxGetScalar(mx);
 		mx=mxGetField(mxOptions,0,"consistencyChecks");
 		if(mx!=NULL)optionsConsistencyChecks=(psych_bool)mxGetScalar(mx);
+		mx=mxGetField(mxOptions,0,"simulateRate");
+		if(mx!=NULL)optionsSimulateRate=mxGetScalar(mx);
 
         // Changing maxReports or maxReportSize triggers a reallocation of
         // buffer memory:
@@ -889,10 +1133,12 @@ PsychError PSYCHHIDReceiveReports(void)
         printf("PsychHID ReceiveReports: Sorry, requested maximum report size %d bytes exceeds built-in maximum of %d bytes.\n", optionsMaxReportSize, (int) MAXREPORTSIZE);
         PsychErrorExitMsg(PsychError_user, "Invalid option.maxReportSize provided!");
     }
+	if(optionsSimulateRate < 0) PsychErrorExitMsg(PsychError_user, "PsychHID ReceiveReports: Sorry, requested simulateRate must not be negative!");
     
     // Start reception of reports: This will also allocate memory for the reports
     // on first invocation for this deviceIndex:
 	error = ReceiveReports(deviceIndex);
+	optionsSimulateRate=0;
 
 	mxErrPtr=PsychGetOutArgMxPtr(1);
 	if(mxErrPtr!=NULL){
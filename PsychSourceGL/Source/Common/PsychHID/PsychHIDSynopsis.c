@@ -47,6 +47,7 @@ void InitializeSynopsis(void)
 	synopsis[i++] = "[report,err]=PsychHID('GetReport',deviceNumber,reportType,reportID,reportBytes)";
 	synopsis[i++] = "err=PsychHID('SetReport',deviceNumber,reportType,reportID,report)";
 	synopsis[i++] = "[reports,err]=PsychHID('GiveMeReports',deviceNumber,[reportBytes])";
+	synopsis[i++] = "[reports,times,lengths,err]=PsychHID('GiveReports',deviceNumber,[reportBytes])";
 	synopsis[i++] = "err=PsychHID('ReceiveReports',deviceNumber[,options])";
 	synopsis[i++] = "err=PsychHID('ReceiveReportsStop',deviceNumber)";
     
@@ -59,6 +60,7 @@ void InitializeSynopsis(void)
 	synopsis[i++] = "[keyIsDown, firstKeyPressTimes, firstKeyReleaseTimes, lastKeyPressTimes, lastKeyReleaseTimes]=PsychHID('KbQueueCheck' [, deviceIndex])"; 
 	synopsis[i++] = "secs=PsychHID('KbTriggerWait', KeysUsage, [deviceNumber])";
 	synopsis[i++] = "[event, navail] = PsychHID('KbQueueGetEvent' [, deviceIndex][, maxWaitTimeSecs=0])";
+	synopsis[i++] = "[events, navail] = PsychHID('KbQueueGetEvents' [, deviceIndex][, maxWaitTimeSecs=0][, maxEvents=inf])";
 
 	synopsis[i++] = "\n\nSupport for access to generic USB devices: See 'help ColorCal2' for one usage example:\n\n";
 	synopsis[i++] = "usbHandle = PsychHID('OpenUSBDevice', vendorID, deviceID [, configurationId=0])";
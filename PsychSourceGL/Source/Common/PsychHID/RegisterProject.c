@@ -57,6 +57,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("KbQueueFlush", &PSYCHHIDKbQueueFlush));
 	PsychErrorExit(PsychRegister("KbQueueRelease", &PSYCHHIDKbQueueRelease));
 	PsychErrorExit(PsychRegister("KbQueueGetEvent", &PSYCHHIDKbQueueGetEvent));
+	PsychErrorExit(PsychRegister("KbQueueGetEvents", &PSYCHHIDKbQueueGetEvents));
 
 	PsychErrorExit(PsychRegister("RawState",  &PSYCHHIDGetRawState));
 	PsychErrorExit(PsychRegister("KbCheck",  &PSYCHHIDKbCheck));
@@ -65,6 +66,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("ReceiveReports",  &PSYCHHIDReceiveReports));
 	PsychErrorExit(PsychRegister("ReceiveReportsStop",  &PSYCHHIDReceiveReportsStop));
 	PsychErrorExit(PsychRegister("GiveMeReports",  &PSYCHHIDGiveMeReports));
+	PsychErrorExit(PsychRegister("GiveReports",  &PSYCHHIDGiveReports));
 	PsychErrorExit(PsychRegister("SetReport",  &PSYCHHIDSetReport));
 	PsychErrorExit(PsychRegister("OpenUSBDevice", &PSYCHHIDOpenUSBDevice));
 	PsychErrorExit(PsychRegister("CloseUSBDevice", &PSYCHHIDCloseUSBDevice));
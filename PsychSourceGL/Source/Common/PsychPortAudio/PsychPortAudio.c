@@ -30,6 +30,11 @@
  */
 
 #include "PsychPortAudio.h"
+#include "PsychPortAudioKernels.h"
+#include "PsychPortAudioOffline.h"
+#include "PsychPortAudioSoundFile.h"
+#include "PsychPortAudioRecorder.h"
+#include "PsychPortAudioResampler.h"
 
 #if PSYCH_SYSTEM == PSYCH_OSX
 #include "pa_mac_core.h"
@@ -60,8 +65,8 @@ static const char *synopsisSYNOPSIS[MAX_SYNOPSIS_STRINGS];
 #define kPortAudioIsAMModulatorForSlave 128
 
 // Maximum number of audio devices we handle:
-// This consumes around 200 Bytes static memory per potential device, so
-// we waste about 200 kb or RAM here, which is acceptable nowadays. However: If a device
+// This consumes around 1 KB static memory per potential device, so
+// we waste about 1 MB of RAM here, which is acceptable nowadays. However: If a device
 // is actually opened, it will consume additional memory ressources in PortAudio,
 // the operating systems sound subsystem and kernel, and in the audio hardware device
 // driver. It will also consume (potentially limited) audio hardware ressources,
@@ -96,6 +101,18 @@ static const char *synopsisSYNOPSIS[MAX_SYNOPSIS_STRINGS];
 // in the mixing/modulation stage.
 #define PA_ANTICLAMPGAIN 0.9999999
 
+// Number of slots in the per-device command queue for parameter changes from the main thread
+// to the audio processing thread. Must be a power of two:
+#define PSYCH_AUDIO_CMDQUEUE_SIZE 64
+
+// Command codes of the command queue:
+#define kPsychPACmdVolume       0   // Set masterVolume, or outChannelVolumes[channel] on a slave.
+#define kPsychPACmdRepetitions  1   // Set repeatCount.
+#define kPsychPACmdStopTime     2   // Set reqStopTime.
+#define kPsychPACmdStop         3   // Request a stop via reqstate, if the device is still active.
+#define kPsychPACmdLoop         4   // Set playloop to loopStartFrame - loopEndFrame.
+#define kPsychPACmdRewind       5   // Reset play position and set playloop, after a refill of the stopped device.
+
 // Uncomment this define MUTEX_LOCK_TIME_STATS to enable tracing of
 // mutex lock hold times for low-level debugging and tuning:
 //#define MUTEX_LOCK_TIME_STATS 1
@@ -111,6 +128,35 @@ typedef struct PsychPASchedule {
     unsigned int    command;                // Command code: 0 = Normal playback buffer. 1 = Pause & Restart playback, 2 = Schedule end of playback, ..
 } PsychPASchedule;
 
+// A parameter change command, queued by the main thread for execution by paCallback():
+typedef struct PsychPACommand {
+    int             command;                // Command code: kPsychPACmdXXX.
+    int             channel;                // Volume target: -1 = masterVolume, >= 0 = outChannelVolumes[channel] on a slave.
+    double          value;                  // New volume, repeatCount, reqStopTime or reqstate.
+    psych_int64     loopStartFrame;         // Start of new playloop in frames.
+    psych_int64     loopEndFrame;           // End of new playloop in frames.
+} PsychPACommand;
+
+// Consistent snapshot of the runtime status of a device, as published by PsychPAUnlockDeviceMutex():
+typedef struct PsychPAStatusSnapshot {
+    double          startTime;
+    double          captureStartTime;
+    double          estStopTime;
+    double          currentTime;
+    double          predictedLatency;
+    psych_int64     playposition;
+    psych_int64     totalplaycount;
+    psych_int64     recposition;
+    psych_int64     batchsize;
+    unsigned int    schedule_pos;
+    unsigned int    state;
+    unsigned int    xruns;
+    unsigned int    paCalls;
+    unsigned int    noTime;
+    unsigned int    captureSession;
+    psych_int64     prevSessionRecposition;
+} PsychPAStatusSnapshot;
+
 // Our device record:
 typedef struct PsychPADevice {
     psych_mutex             mutex;          // Mutex lock for the PsychPADevice struct.
@@ -135,10 +181,11 @@ typedef struct PsychPADevice {
     volatile double estStopTime;    // Estimated sound offset time after stop of playback.
     volatile double currentTime;    // Current playout time of the last sound sample submitted to the engine. Will be wrong in case of playback abort!
     volatile unsigned int state;    // Current state of the stream: 0=Stopped, 1=Hot Standby, 2=Playing, 3=Aborting playback. Mostly written/updated by paCallback.
-    volatile unsigned int reqstate; // Requested state of the stream, as opposed to current 'state'. Written by main-thread, read & processed by paCallback.
+    volatile unsigned int reqstate; // Requested state of the stream, as opposed to current 'state'. Requested by main-thread via kPsychPACmdStop, read & processed by paCallback.
     double     repeatCount;         // Number of repetitions: -1 = Loop forever, 1 = Once, n = n repetitions.
     float*     outputbuffer;        // Pointer to float memory buffer with sound output data.
     psych_int64 outputbuffersize;   // Size of output buffer in bytes.
+    psych_int64 outputbuffercapacity; // Size of allocated memory for output buffer in bytes. May be bigger than outputbuffersize.
     psych_int64 loopStartFrame;     // Start of current playloop in frames.
     psych_int64 loopEndFrame;       // End of current playloop in frames.
     psych_int64 playposition;       // Current playposition in samples since start of playback for current buffer and playloop (not frames, not bytes!)
@@ -148,6 +195,12 @@ typedef struct PsychPADevice {
     psych_int64 inputbuffersize;    // Size of input buffer in bytes.
     psych_int64 recposition;        // Current record position in samples since start of capture.
     psych_int64 readposition;       // Last read-out sample since start of capture.
+    volatile unsigned int captureSession; // Running count of capture sessions, ie. of resets of recposition by 'Start' or 'RescheduleStart'.
+    psych_int64 prevSessionRecposition; // Final recposition of the previous capture session.
+    volatile psych_int64 captureLimit; // Upper bound of the samples of the current capture session written to the inputbuffer, published before writing them.
+    PsychPARecorder* recorder;      // Streaming disk recorder for captured sound data, or NULL if none.
+    PsychPAResampler* resampler;    // Sample rate converter for fills of sound data at another sample rate, or NULL if none.
+    double     resamplerRate;       // Sample rate of the sound data converted by 'resampler'.
     psych_int64 outchannels;        // Number of output channels.
     psych_int64 inchannels;         // Number of input channels.
     unsigned int xruns;             // Number of over-/underflows of input-/output channel for this stream.
@@ -167,6 +220,7 @@ typedef struct PsychPADevice {
 
     // Master-Slave virtual device related:
     int*    outputmappings;         // Mapping array of output slave channels to associated master channels for mix and merge. NULL on master devices.
+    PsychPAMixPlan* outputplan;     // Mix plan for outputmappings, precomputed when the mapping is set up. NULL on master devices.
     int*    inputmappings;          // Mapping array of input slave channels to associated master channels for distribution. NULL on master devices.
     int    slaveCount;              // Number of attached slave devices. Zero on slave devices.
     int*    slaves;                 // Array of pahandle's of all attached slave devices, ie., an array with slaveCount valid (non -1) entries. NULL on slaves.
@@ -183,6 +237,16 @@ typedef struct PsychPADevice {
     // Mixer volume related:
     float*    outChannelVolumes;    // Array of per-outputchannel volume settings on slave devices, NULL and not used on non-slave devices.
     float    masterVolume;          // Master volume setting for all non-slave audio devices, i.e., masters and regular devices. Unused on slaves.
+    float*    reqOutChannelVolumes; // Most recently requested outChannelVolumes, as seen by the main thread. NULL on non-slave devices.
+    float    reqMasterVolume;       // Most recently requested masterVolume, as seen by the main thread.
+
+    // Lock-free communication with the audio processing thread:
+    PsychPACommand cmdQueue[PSYCH_AUDIO_CMDQUEUE_SIZE]; // Single producer, single consumer ringbuffer of pending parameter changes.
+    volatile unsigned int cmdWritePos;      // Running count of commands enqueued by the main thread.
+    volatile unsigned int cmdReadPos;       // Running count of commands executed. Only advanced with the device mutex held.
+    volatile int cmdOverflow;               // Set by the main thread if the queue was full: Apply reqMasterVolume and reqOutChannelVolumes instead.
+    volatile unsigned int statusSeq;        // Sequence counter of statusSnapshot: Odd while an update is in progress.
+    PsychPAStatusSnapshot statusSnapshot;   // Snapshot of runtime status for lock-free readers like 'GetStatus'.
 } PsychPADevice;
 
 PsychPADevice audiodevices[MAX_PSYCH_AUDIO_DEVS];
@@ -204,6 +268,9 @@ struct PsychPABuffer_Struct {
     float*     outputbuffer;        // Pointer to float memory buffer with sound output data.
     psych_int64 outputbuffersize;   // Size of output buffer in bytes.
     psych_int64 outchannels;        // Number of channels.
+    psych_int64 outputbuffercapacity; // Size of allocated memory for the output buffer in bytes. May be bigger than outputbuffersize.
+    void*       mapping;            // Base address of memory mapped sound file if buffer is backed by a file, NULL otherwise.
+    size_t      mappingsize;        // Size of memory mapping in bytes.
 };
 
 typedef struct PsychPABuffer_Struct PsychPABuffer;
@@ -212,6 +279,63 @@ psych_mutex    bufferListmutex;            // Mutex lock for the audio bufferLis
 PsychPABuffer*  bufferList;                // Pointer to start of audio bufferList.
 int    bufferListCount;                    // Number of slots allocated in bufferList.
 
+// Memory of recently deleted audio buffers, kept for recycling by PsychPACreateAudioBuffer(),
+// so scripts which create and delete buffers of similar size in a loop don't hammer the allocator.
+// At most PSYCH_AUDIO_BUFFERCACHE_MAXBYTES are kept, so deleted long stimuli don't pin lots of memory:
+#define PSYCH_AUDIO_BUFFERCACHE_SIZE 16
+#define PSYCH_AUDIO_BUFFERCACHE_MAXBYTES (32 * 1024 * 1024)
+float*      bufferCache[PSYCH_AUDIO_BUFFERCACHE_SIZE];
+psych_int64 bufferCacheCapacity[PSYCH_AUDIO_BUFFERCACHE_SIZE];
+psych_int64 bufferCacheBytes = 0;
+
+// Allocate memory for a buffer of 'size' bytes, recycling cached memory of deleted buffers if a
+// cached block fits without wasting more than half of it. Returns actual size of allocation in 'capacity':
+static float* PsychPAAllocBufferMemory(psych_int64 size, psych_int64* capacity)
+{
+    float* mem;
+    int i, best = -1;
+
+    for (i = 0; i < PSYCH_AUDIO_BUFFERCACHE_SIZE; i++) {
+        if (bufferCache[i] && (bufferCacheCapacity[i] >= size) && (bufferCacheCapacity[i] <= 2 * size) &&
+            ((best < 0) || (bufferCacheCapacity[i] < bufferCacheCapacity[best]))) best = i;
+    }
+
+    if (best >= 0) {
+        mem = bufferCache[best];
+        *capacity = bufferCacheCapacity[best];
+        bufferCache[best] = NULL;
+        bufferCacheBytes -= bufferCacheCapacity[best];
+        return(mem);
+    }
+
+    *capacity = size;
+    return((float*) malloc((size_t) size));
+}
+
+// Release memory of 'buffer': Unmap it if it is backed by a sound file, otherwise cache it for recycling:
+static void PsychPAReleaseBufferMemory(PsychPABuffer* buffer)
+{
+    int i;
+
+    if (NULL == buffer->outputbuffer) return;
+
+    if (buffer->mapping) {
+        PsychPAUnmapSoundFile(buffer->mapping, buffer->mappingsize);
+        return;
+    }
+
+    for (i = 0; (i < PSYCH_AUDIO_BUFFERCACHE_SIZE) && (bufferCacheBytes + buffer->outputbuffercapacity <= PSYCH_AUDIO_BUFFERCACHE_MAXBYTES); i++) {
+        if (NULL == bufferCache[i]) {
+            bufferCache[i] = buffer->outputbuffer;
+            bufferCacheCapacity[i] = buffer->outputbuffercapacity;
+            bufferCacheBytes += bufferCacheCapacity[i];
+            return;
+        }
+    }
+
+    free(buffer->outputbuffer);
+}
+
 // Scan all schedules of all active and open audio devices to check if
 // given audiobuffer is referenced. Invalidate reference, if so:
 // The special handle == -1 invalidates all references except the ones to special buffer zero.
@@ -243,10 +367,9 @@ psych_bool PsychPAInvalidateBufferReferences(int handle)
     return(anylocked);
 }
 
-// Create a new audiobuffer for 'outchannels' audio channels and 'nrFrames' samples
-// per channel. Init header, allocate zero-filled memory, enqeue in bufferList.
-// Resize/Grow bufferList if neccessary. Return handle to buffer.
-int PsychPACreateAudioBuffer(psych_int64 outchannels, psych_int64 nrFrames)
+// Find a free slot in the bufferList for a new audiobuffer. Resize/Grow bufferList if
+// neccessary. Return handle to the slot:
+static int PsychPAGetFreeAudioBufferSlot(void)
 {
     PsychPABuffer* tmpptr;
     int i, handle;
@@ -302,19 +425,118 @@ int PsychPACreateAudioBuffer(psych_int64 outchannels, psych_int64 nrFrames)
     // Invalidate all potential stale references to the new 'handle' in all schedules:
     PsychPAInvalidateBufferReferences(handle);
 
+    return(handle);
+}
+
+// Create a new audiobuffer for 'outchannels' audio channels and 'nrFrames' samples
+// per channel. Init header, allocate memory, enqeue in bufferList. The memory is not
+// initialized, the caller must fill it. Return handle to buffer.
+int PsychPACreateAudioBuffer(psych_int64 outchannels, psych_int64 nrFrames)
+{
+    int handle = PsychPAGetFreeAudioBufferSlot();
+
     // Allocate actual data buffer:
     bufferList[handle].outputbuffersize = outchannels * nrFrames * sizeof(float);
     bufferList[handle].outchannels = outchannels;
+    bufferList[handle].mapping = NULL;
+    bufferList[handle].mappingsize = 0;
 
-    if (NULL == ( bufferList[handle].outputbuffer = (float*) calloc(1, (size_t) bufferList[handle].outputbuffersize) )) {
+    if (NULL == ( bufferList[handle].outputbuffer = PsychPAAllocBufferMemory(bufferList[handle].outputbuffersize, &bufferList[handle].outputbuffercapacity) )) {
         // Out of memory: Release bufferList header and error out:
         PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffer when trying to allocate actual buffer!");
     }
 
-    // Ok, we're ready with an empty, silence filled audiobuffer. Return its handle:
+    // Ok, we're ready with an empty audiobuffer. Return its handle:
     return(handle);
 }
 
+// Get matrix of sound data at argument 'position' from runtime: Either a double(), single() or int16() matrix.
+// Returns pointer to the sample data in 'data' without copying it, the sample format in 'format' and the
+// gain which maps the samples into our internal float format, including the anti-clamp gain, in 'gain':
+static void PsychPAAllocInSampleMatArg(int position, psych_int64* m, psych_int64* n, psych_int64* p, const void** data, int* format, float* gain)
+{
+    double* indata;
+    float*  indatafloat;
+    short*  indataint16;
+
+    if (PsychAllocInDoubleMatArg64(position, kPsychArgAnything, m, n, p, &indata)) {
+        *data = indata;
+        *format = kPsychPASampleFloat64;
+        *gain = (float) PA_ANTICLAMPGAIN;
+    }
+    else if (PsychAllocInInt16MatArg64(position, kPsychArgAnything, m, n, p, &indataint16)) {
+        // Full int16 range maps to -1.0 to +1.0. The maximum of +32767/32768 is already below clamping threshold:
+        *data = indataint16;
+        *format = kPsychPASampleInt16;
+        *gain = (float) (1.0 / 32768.0);
+    }
+    else {
+        PsychAllocInFloatMatArg64(position, kPsychArgRequired, m, n, p, &indatafloat);
+        *data = indatafloat;
+        *format = kPsychPASampleFloat32;
+        *gain = (float) PA_ANTICLAMPGAIN;
+    }
+}
+
+// Does sound data at 'inRate' Hz need conversion to the sample rate of device 'dev'? Rates which
+// are equal after rounding to integer Hz don't:
+static psych_bool PsychPANeedsResampling(PsychPADevice* dev, double inRate)
+{
+    if (inRate <= 0) PsychErrorExitMsg(PsychError_user, "Invalid 'sampleRate' provided. Must be greater than zero.");
+
+    return((floor(inRate + 0.5) != floor(dev->streaminfo->sampleRate + 0.5)) ? TRUE : FALSE);
+}
+
+// Create resampler for sound data at 'inRate' Hz to the sample rate of device 'dev'. Releases the
+// mapping of 'soundfile', if any, before erroring out:
+static PsychPAResampler* PsychPACreateResampler(PsychPADevice* dev, double inRate, PsychPASoundFile* soundfile)
+{
+    PsychPAResampler* resampler;
+    const char* errmsg;
+
+    if ((errmsg = PsychPAResamplerCreate(&resampler, dev->outchannels, inRate, dev->streaminfo->sampleRate)) != NULL) {
+        if (soundfile) PsychPAUnmapSoundFile(soundfile->mapping, soundfile->mappingsize);
+        if (verbosity > 0) printf("PsychPortAudio-ERROR: Can't convert sound data from %f Hz to %f Hz: %s\n", inRate, dev->streaminfo->sampleRate, errmsg);
+        if (errmsg == PsychPAResamplerOutOfMemory) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory while setting up sample rate conversion.");
+        PsychErrorExitMsg(PsychError_user, "Sound data at given 'sampleRate' can't be converted to the sample rate of the audio device.");
+    }
+
+    return(resampler);
+}
+
+// Get resampler of device 'dev' for sound data at 'inRate' Hz. If 'continueStream' is set, the
+// conversion continues the stream of the previous fill at the same rate, otherwise it starts a new one:
+static PsychPAResampler* PsychPAGetDeviceResampler(PsychPADevice* dev, double inRate, psych_bool continueStream)
+{
+    if (dev->resampler && (dev->resamplerRate != inRate)) {
+        PsychPAResamplerDestroy(dev->resampler);
+        dev->resampler = NULL;
+    }
+
+    if (NULL == dev->resampler) {
+        dev->resampler = PsychPACreateResampler(dev, inRate, NULL);
+        dev->resamplerRate = inRate;
+    }
+    else if (!continueStream) {
+        PsychPAResamplerReset(dev->resampler);
+    }
+
+    return(dev->resampler);
+}
+
+// Convert sound data of 'channels' channels and '*frames' frames with 'resampler'. Replaces 'data', 'format',
+// 'gain' and '*frames' by the converted float samples in temporary memory, released at return to the runtime:
+static void PsychPAResampleSamples(PsychPAResampler* resampler, psych_int64 channels, psych_int64* frames, const void** data, int* format, float* gain)
+{
+    psych_int64 outframes = PsychPAResamplerGetOutputFrames(resampler, *frames);
+    float* outdata = (float*) PsychMallocTemp(sizeof(float) * (size_t) (((outframes > 0) ? outframes : 1) * channels));
+
+    *frames = PsychPAResamplerProcess(resampler, outdata, *data, *format, *gain, *frames);
+    *data = (const void*) outdata;
+    *format = kPsychPASampleFloat32;
+    *gain = 1.0f;
+}
+
 // Delete all audio buffers and bufferList itself: Called during shutdown.
 void PsychPADeleteAllAudioBuffers(void)
 {
@@ -328,9 +550,14 @@ void PsychPADeleteAllAudioBuffers(void)
         PsychPAInvalidateBufferReferences(-1);
 
         // Free all audio buffers:
-        for (i = 0; i < bufferListCount; i++) {
-            if (NULL != bufferList[i].outputbuffer) free(bufferList[i].outputbuffer);
+        for (i = 0; i < bufferListCount; i++) PsychPAReleaseBufferMemory(&bufferList[i]);
+
+        // Free all memory cached for recycling:
+        for (i = 0; i < PSYCH_AUDIO_BUFFERCACHE_SIZE; i++) {
+            if (bufferCache[i]) free(bufferCache[i]);
+            bufferCache[i] = NULL;
         }
+        bufferCacheBytes = 0;
 
         // Release memory for bufferheader array itself:
         free(bufferList);
@@ -370,7 +597,7 @@ psych_bool PsychPAUpdateBufferReferences(void)
         // Device open?
         if (audiodevices[i].stream) {
             // Schedule attached and device active?
-            if ((audiodevices[i].schedule) && ((audiodevices[i].state > 0) && Pa_IsStreamActive(audiodevices[i].stream))) {
+            if ((audiodevices[i].schedule) && ((audiodevices[i].state > 0) && PsychPAStreamIsActive(audiodevices[i].stream))) {
                 // Active schedule. Scan it and mark all referenced buffers as locked:
                 for (j = 0; j < audiodevices[i].schedule_size; j++) {
                     // Slot active and with valid bufferhandle?
@@ -410,7 +637,7 @@ int PsychPADeleteAudioBuffer(int handle, int waitmode)
     }
 
     // Delete buffer:
-    if (NULL != buffer->outputbuffer) free(buffer->outputbuffer);
+    PsychPAReleaseBufferMemory(buffer);
     memset(buffer, 0, sizeof(PsychPABuffer));
 
     // Success:
@@ -431,9 +658,38 @@ static void PsychPALockDeviceMutex(PsychPADevice* dev)
     }
 }
 
+// Copy current runtime status of device 'dev' into 'snapshot':
+static void PsychPAFillStatusSnapshot(PsychPADevice* dev, PsychPAStatusSnapshot* snapshot)
+{
+    snapshot->startTime = dev->startTime;
+    snapshot->captureStartTime = dev->captureStartTime;
+    snapshot->estStopTime = dev->estStopTime;
+    snapshot->currentTime = dev->currentTime;
+    snapshot->predictedLatency = dev->predictedLatency;
+    snapshot->playposition = dev->playposition;
+    snapshot->totalplaycount = dev->totalplaycount;
+    snapshot->recposition = dev->recposition;
+    snapshot->batchsize = dev->batchsize;
+    snapshot->schedule_pos = dev->schedule_pos;
+    snapshot->state = dev->state;
+    snapshot->xruns = dev->xruns;
+    snapshot->paCalls = dev->paCalls;
+    snapshot->noTime = dev->noTime;
+    snapshot->captureSession = dev->captureSession;
+    snapshot->prevSessionRecposition = dev->prevSessionRecposition;
+}
+
 static void PsychPAUnlockDeviceMutex(PsychPADevice* dev)
 {
     if (uselocking) {
+        // Publish a snapshot of the status while we are still the only writer, ie. with the
+        // mutex held. This is a seqlock: An odd statusSeq tells readers an update is in flight:
+        dev->statusSeq++;
+        PsychMemoryBarrier();
+        PsychPAFillStatusSnapshot(dev, &(dev->statusSnapshot));
+        PsychMemoryBarrier();
+        dev->statusSeq++;
+
         PsychUnlockMutex(&(dev->mutex));
     }
 
@@ -443,6 +699,174 @@ static void PsychPAUnlockDeviceMutex(PsychPADevice* dev)
     #endif
 }
 
+// Retrieve a consistent snapshot of the runtime status of 'dev', as published by the
+// last holder of the device mutex, usually without taking the mutex:
+static void PsychPAGetStatusSnapshot(PsychPADevice* dev, PsychPAStatusSnapshot* snapshot)
+{
+    unsigned int seq, tries;
+
+    // Without locking, there isn't a single writer for the snapshot, so just read the live values:
+    if (!uselocking) {
+        PsychPAFillStatusSnapshot(dev, snapshot);
+        return;
+    }
+
+    for (tries = 0; tries < 100; tries++) {
+        seq = dev->statusSeq;
+        PsychMemoryBarrier();
+        *snapshot = dev->statusSnapshot;
+        PsychMemoryBarrier();
+
+        // Done if no update was in flight during our copy:
+        if (!(seq & 1) && (seq == dev->statusSeq)) return;
+    }
+
+    // Writer got preempted in the middle of an update, or updates so often that we can't get a
+    // clean copy? Updates only happen with the mutex held, so wait for it to finish, and copy the
+    // snapshot without publishing a new one:
+    PsychLockMutex(&(dev->mutex));
+    *snapshot = dev->statusSnapshot;
+    PsychUnlockMutex(&(dev->mutex));
+}
+
+// Capture position query function for the disk recorder thread of device 'userData':
+static void PsychPAGetRecorderPosition(void* userData, PsychPARecorderPosition* position)
+{
+    PsychPAStatusSnapshot snapshot;
+
+    PsychPADevice* dev = (PsychPADevice*) userData;
+
+    PsychPAGetStatusSnapshot(dev, &snapshot);
+    position->recposition = snapshot.recposition;
+    position->captureStartTime = snapshot.captureStartTime;
+    position->session = snapshot.captureSession;
+    position->prevrecposition = snapshot.prevSessionRecposition;
+
+    // Live values: The capture limit gets reset before the session counter is advanced, so the
+    // limit read after the counter always belongs to that session or a later point of it:
+    position->limitsession = dev->captureSession;
+    PsychMemoryBarrier();
+    position->capturelimit = dev->captureLimit;
+}
+
+// Execute all pending commands in the command queue of 'dev'. Must be called with the mutex of
+// 'dev' itself held, so the consumer side of the queue is always single-threaded: By paCallback()
+// at the start of each callback, which for an active slave runs on the audio thread of its master,
+// or by the main thread while no callback processes 'dev':
+static void PsychPAExecuteCommands(PsychPADevice* dev)
+{
+    PsychPACommand* cmd;
+    int i;
+
+    while (dev->cmdReadPos != dev->cmdWritePos) {
+        PsychMemoryBarrier();
+        cmd = &(dev->cmdQueue[dev->cmdReadPos % PSYCH_AUDIO_CMDQUEUE_SIZE]);
+
+        switch (cmd->command) {
+            case kPsychPACmdVolume:
+                if (cmd->channel < 0) {
+                    dev->masterVolume = (float) cmd->value;
+                }
+                else if (dev->outChannelVolumes && (cmd->channel < dev->outchannels)) {
+                    dev->outChannelVolumes[cmd->channel] = (float) cmd->value;
+                }
+                break;
+
+            case kPsychPACmdRepetitions:
+                dev->repeatCount = cmd->value;
+                break;
+
+            case kPsychPACmdStopTime:
+                dev->reqStopTime = cmd->value;
+                break;
+
+            case kPsychPACmdStop:
+                // Only an active device can be stopped. It may have stopped by itself meanwhile:
+                if (dev->state > 0) dev->reqstate = (unsigned int) cmd->value;
+                break;
+
+            case kPsychPACmdRewind:
+                dev->playposition = 0;
+                // Fall through to setup of the new playloop.
+
+            case kPsychPACmdLoop:
+                dev->loopStartFrame = cmd->loopStartFrame;
+                dev->loopEndFrame = cmd->loopEndFrame;
+                break;
+        }
+
+        PsychMemoryBarrier();
+        dev->cmdReadPos++;
+    }
+
+    // Commands lost to a full queue? The main thread updated the req values before it
+    // set the flag, and they are the most recent settings, so just apply all of them:
+    if (dev->cmdOverflow) {
+        dev->cmdOverflow = FALSE;
+        PsychMemoryBarrier();
+
+        dev->masterVolume = dev->reqMasterVolume;
+        if (dev->outChannelVolumes && dev->reqOutChannelVolumes) {
+            for (i = 0; i < dev->outchannels; i++) dev->outChannelVolumes[i] = dev->reqOutChannelVolumes[i];
+        }
+    }
+}
+
+// Execute all queued commands of 'dev' immediately, if the engine isn't going to do it for us soon:
+static void PsychPAFlushCommands(PsychPADevice* dev)
+{
+    PsychPADevice* mixdev = (dev->opmode & kPortAudioIsSlave) ? &audiodevices[dev->pamaster] : dev;
+
+    if ((dev->cmdReadPos == dev->cmdWritePos) && !dev->cmdOverflow) return;
+
+    // Engine stopped, or inactive slave? The master skips inactive slaves in its mix cycles, and
+    // only we can make them active again. Either way no callback will consume the commands, and
+    // the device mutex is uncontended:
+    if (((dev->opmode & kPortAudioIsSlave) && (dev->state == 0)) || (PsychPAStreamIsActive(mixdev->stream) != 1)) {
+        PsychPALockDeviceMutex(dev);
+        PsychPAExecuteCommands(dev);
+        PsychPAUnlockDeviceMutex(dev);
+    }
+}
+
+// Queue a command for execution by the audio processing thread of 'dev', without blocking on the
+// device mutex, and execute it right away if the engine doesn't run. Only called from the main
+// thread, after it stored a new volume in reqMasterVolume or reqOutChannelVolumes:
+static void PsychPAEnqueueCommand(PsychPADevice* dev, int command, int channel, double value, psych_int64 loopStartFrame, psych_int64 loopEndFrame)
+{
+    PsychPACommand* cmd;
+
+    // Queue full? This happens if usercode changes settings faster than the engine runs
+    // its mix cycles. Don't wait for a free slot for volume changes, but tell the consumer
+    // to apply all the requested volumes at once. Make the req values visible before the flag.
+    // Other commands are rare and can't be merged, so they wait for the consumer:
+    while (dev->cmdWritePos - dev->cmdReadPos >= PSYCH_AUDIO_CMDQUEUE_SIZE) {
+        if (command == kPsychPACmdVolume) {
+            PsychMemoryBarrier();
+            dev->cmdOverflow = TRUE;
+            PsychPAFlushCommands(dev);
+            return;
+        }
+
+        PsychPAFlushCommands(dev);
+        PsychYieldIntervalSeconds(yieldInterval);
+    }
+
+    cmd = &(dev->cmdQueue[dev->cmdWritePos % PSYCH_AUDIO_CMDQUEUE_SIZE]);
+    cmd->command = command;
+    cmd->channel = channel;
+    cmd->value = value;
+    cmd->loopStartFrame = loopStartFrame;
+    cmd->loopEndFrame = loopEndFrame;
+
+    // Make command visible before publishing it:
+    PsychMemoryBarrier();
+    dev->cmdWritePos++;
+
+    // Engine not running? Then nobody else will execute the command:
+    PsychPAFlushCommands(dev);
+}
+
 static void PsychPACreateSignal(PsychPADevice* dev)
 {
     if (uselocking) {
@@ -591,6 +1015,9 @@ int PsychPAProcessSchedule(PsychPADevice* dev, psych_int64 *playposition, float*
                 return(1);
             }
 
+            // Slots are published lock-free by 'AddToSchedule': Only read its content after its mode:
+            PsychMemoryBarrier();
+
             // Current slot is valid: Assign it:
             cmd = dev->schedule[slotid].command;
             if (cmd > 0) {
@@ -806,8 +1233,11 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
         // DISABLED: PsychAutoLockThreadToCores(NULL);
         #endif
 
-        // Retrieve current system time:
-        PsychGetAdjustedPrecisionTimerSeconds(&now);
+        // Retrieve current system time, or current virtual time of an offline device:
+        if (hA == kPsychPAOfflineHostAPI)
+            now = timeInfo->currentTime;
+        else
+            PsychGetAdjustedPrecisionTimerSeconds(&now);
 
         // FIXME: PortAudio stable sets timeInfo->currentTime == 0 --> Breakage!!!
         // That's why we currently have our own PortAudio version.
@@ -823,19 +1253,34 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
             //
             // Therefore we need to check if CLOCK_MONOTONIC time is returned
             // and remap such timestamps to our standard GetSecs timebase before
-            // further processing.
-
-            // Get current CLOCK_MONOTONIC time:
-            double tMonotonic = PsychOSGetLinuxMonotonicTime();
-
-            // Returned current time timestamp closer to tMonotonic than to GetSecs time?
-            if (fabs(timeInfo->currentTime - tMonotonic) < fabs(timeInfo->currentTime - now)) {
-                // Timestamps are in monotonic time! Need to remap.
-                // tMonotonic shall be the offset between GetSecs and monotonic time,
-                // i.e., the offset that needs to be added to monotonic timestamps to
-                // remap them to GetSecs time:
-                tMonotonic = now - tMonotonic;
+            // further processing. GetSecs itself may use CLOCK_MONOTONIC or another
+            // time base if selected via PSYCH_TIMEBASE, so CLOCK_REALTIME timestamps
+            // may need remapping as well.
+            //
+            // This runs at each callback, so we only take one sample of each clock
+            // right after 'now', instead of the tightly bounded retry loop of
+            // PsychOSMonotonicToRefTime(). The remapping error is the time between
+            // the query of 'now' and of the clock, typically well below a microsecond.
+            double tMonotonic, tRealtime;
+            int timeBase = PsychOSGetTimeBase();
+
+            PsychOSGetTimeBaseSeconds(kPsychTimeBaseMonotonic, &tMonotonic);
+            PsychOSGetTimeBaseSeconds(kPsychTimeBaseRealtime, &tRealtime);
+
+            // Returned current time timestamp closer to tMonotonic than to tRealtime?
+            if (fabs(timeInfo->currentTime - tMonotonic) < fabs(timeInfo->currentTime - tRealtime)) {
+                // Timestamps are in monotonic time. Need to remap, unless GetSecs uses it as well:
+                tMonotonic = (timeBase == kPsychTimeBaseMonotonic) ? 0 : now - tMonotonic;
+            }
+            else {
+                // Timestamps are in gettimeofday() time. Need to remap, unless GetSecs uses it as well:
+                tMonotonic = (timeBase == kPsychTimeBaseRealtime) ? 0 : now - tRealtime;
+            }
 
+            // tMonotonic is now the offset between GetSecs and the ALSA clock,
+            // i.e., the offset that needs to be added to ALSA timestamps to
+            // remap them to GetSecs time:
+            if (tMonotonic != 0) {
                 // Correct all PortAudio timestamps by adding corrective offset:
                 ((PaStreamCallbackTimeInfo*) timeInfo)->currentTime += tMonotonic;
                 ((PaStreamCallbackTimeInfo*) timeInfo)->outputBufferDacTime += tMonotonic;
@@ -925,6 +1370,9 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
     // Acquire device lock: We'll likely hold it until exit from paCallback:
     PsychPALockDeviceMutex(dev);
 
+    // Apply parameter changes queued by the main thread via PsychPAEnqueueCommand():
+    if ((dev->cmdReadPos != dev->cmdWritePos) || dev->cmdOverflow) PsychPAExecuteCommands(dev);
+
     // Cache requested state:
     reqstate = dev->reqstate;
 
@@ -1211,8 +1659,7 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
                     audiodevices[modulatorSlave].slaveDirty = 0;
 
                 // Prefill buffer with neutral 1.0:
-                tmpBuffer = dev->slaveGainBuffer;
-                for (j = 0; j < dev->batchsize * audiodevices[modulatorSlave].outchannels; j++) *(tmpBuffer++) = 1.0;
+                PsychPAFillSamples(dev->slaveGainBuffer, 1.0, dev->batchsize * audiodevices[modulatorSlave].outchannels);
 
                 // This will potentially fill the slaveGainBuffer with gain modulation values.
                 // The passed slaveInBuffer is meaningless for a modulator slave and only contains random junk...
@@ -1236,24 +1683,17 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
                             // Prefill slaves output buffer with 1.0, a neutral gain value for playback slaves
                             // without a AM modulator attached. The same prefill is needed with AM modulator,
                             // this time to make the modulator itself happy:
-                            tmpBuffer = dev->slaveOutBuffer;
-                            for (j = 0; j < dev->batchsize * audiodevices[slaveId].outchannels; j++) *(tmpBuffer++) = 1.0;
+                            PsychPAFillSamples(dev->slaveOutBuffer, 1.0, dev->batchsize * audiodevices[slaveId].outchannels);
 
                             // Ok, the outbuffer is filled with a neutral 1.0 gain value. This will work
                             // even if no per-slave gain modulation is provided by a modulator slave.
 
                             // Is a modulator slave active and did it write any gain AM values?
                             if ((modulatorSlave > -1) && (audiodevices[modulatorSlave].slaveDirty)) {
-                                // Yes. Need to distribute them to proper channels in slaveOutBuffer:
-                                tmpBuffer = dev->slaveGainBuffer;
-                                mixBuffer = dev->slaveOutBuffer;
-                                for (j = 0; j < dev->batchsize; j++) {
-                                    // Iterate over all target channels in the slave device outputbuffer:
-                                    for (k = 0; k < audiodevices[modulatorSlave].outchannels; k++) {
-                                        // Modulate current sample in intermixbuffer via multiplication:
-                                        mixBuffer[(j * audiodevices[slaveId].outchannels) + audiodevices[modulatorSlave].outputmappings[k]] = *(tmpBuffer++) * audiodevices[modulatorSlave].outChannelVolumes[k];
-                                    }
-                                }
+                                // Yes. Need to distribute them to proper channels in slaveOutBuffer, applying
+                                // the modulators per-channel volumes:
+                                PsychPAMixChannels(dev->slaveOutBuffer, dev->slaveGainBuffer, audiodevices[modulatorSlave].outputplan,
+                                                   audiodevices[modulatorSlave].outChannelVolumes, dev->batchsize, kPsychPAMixAssign);
                             }
                         }    // Ok, the slaveOutBuffer for this playback slave is prefilled with valid gain modulation data to apply to the actual sound output.
 
@@ -1287,25 +1727,15 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
                                 // a time-series of gain modulation samples for amplitude modulation.
                                 // Multiply the master channels samples with the slaves "gain samples"
                                 // to apply AM modulation:
-                                for (j = committedFrames; j < dev->batchsize; j++) {
-                                    // Iterate over all target channels in the slave device outputbuffer:
-                                    for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
-                                        // Modulate current sample in intermixbuffer via multiplication:
-                                        mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] *= *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
-                                    }
-                                }
+                                PsychPAMixChannels(&(mixBuffer[committedFrames * outchannels]), tmpBuffer, audiodevices[slaveId].outputplan,
+                                                   audiodevices[slaveId].outChannelVolumes, dev->batchsize - committedFrames, kPsychPAMixMultiply);
                             }
                             else {
                                 // Regular mix: Mix all output channels of the slave into the proper target channels
                                 // of the master by simple addition. Apply per-channel volume settings of the slave
                                 // during mix:
-                                for (j = committedFrames; j < dev->batchsize; j++) {
-                                    // Iterate over all target channels in the slave device outputbuffer:
-                                    for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
-                                        // Mix current sample via addition:
-                                        mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] += *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
-                                    }
-                                }
+                                PsychPAMixChannels(&(mixBuffer[committedFrames * outchannels]), tmpBuffer, audiodevices[slaveId].outputplan,
+                                                   audiodevices[slaveId].outChannelVolumes, dev->batchsize - committedFrames, kPsychPAMixAdd);
                             }
                         }
                     }
@@ -1410,6 +1840,10 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
             return(paAbort);
         }
 
+        // Tell the disk recorder which part of the ring we are about to overwrite:
+        dev->captureLimit = recposition + dev->batchsize * inchannels;
+        PsychMemoryBarrier();
+
         // This is the simple case (compared to playback processing).
         // Just copy all available data to our internal buffer:
         for (i=0; (i < dev->batchsize * inchannels); i++) {
@@ -1615,10 +2049,10 @@ void PsychPACloseStream(int id)
             // Portaudio shutdown.
 
             // Stop, shutdown and release audio stream:
-            Pa_StopStream(stream);
+            PsychPAStreamStop(stream);
 
             // Unregister the stream finished callback:
-            Pa_SetStreamFinishedCallback(stream, NULL);
+            PsychPAStreamSetFinishedCallback(stream, NULL);
 
             // Our device thread, callbacks and hardware are stopped, all mutexes are unlocked,
             // all our potential slaves are inactive as well. We can safely destroy our slaves,
@@ -1638,7 +2072,7 @@ void PsychPACloseStream(int id)
             // Destruction for both master- and regular audio devices:
 
             // Close and destroy the hardware portaudio stream:
-            Pa_CloseStream(stream);
+            PsychPAStreamClose(stream);
         }
 
         // Common destruct path for all types of devices:
@@ -1651,6 +2085,19 @@ void PsychPACloseStream(int id)
             free(audiodevices[id].outputbuffer);
             audiodevices[id].outputbuffer = NULL;
             audiodevices[id].outputbuffersize = 0;
+            audiodevices[id].outputbuffercapacity = 0;
+        }
+
+        // Release sample rate converter for fills at other sample rates:
+        if (audiodevices[id].resampler) {
+            PsychPAResamplerDestroy(audiodevices[id].resampler);
+            audiodevices[id].resampler = NULL;
+        }
+
+        // Stop disk recording of the inputbuffer, after writing out the remaining sound data:
+        if (audiodevices[id].recorder) {
+            PsychPARecorderDestroy(audiodevices[id].recorder);
+            audiodevices[id].recorder = NULL;
         }
 
         // Free associated sound inputbuffer:
@@ -1698,6 +2145,8 @@ void PsychPACloseStream(int id)
         if(audiodevices[id].outputmappings) {
             free(audiodevices[id].outputmappings);
             audiodevices[id].outputmappings = NULL;
+            PsychPADestroyMixPlan(audiodevices[id].outputplan);
+            audiodevices[id].outputplan = NULL;
         }
 
         // Free vector of outChannelVolumes:
@@ -1706,6 +2155,11 @@ void PsychPACloseStream(int id)
             audiodevices[id].outChannelVolumes = NULL;
         }
 
+        if(audiodevices[id].reqOutChannelVolumes) {
+            free(audiodevices[id].reqOutChannelVolumes);
+            audiodevices[id].reqOutChannelVolumes = NULL;
+        }
+
         // If we use locking, we need to destroy the per-device mutex:
         if (uselocking && PsychDestroyMutex(&(audiodevices[id].mutex))) printf("PsychPortAudio: CRITICAL! Failed to release Mutex object for pahandle %i! Prepare for trouble!\n", id);
 
@@ -1731,7 +2185,7 @@ void InitializeSynopsis(void)
     synopsis[i++] = "count = PsychPortAudio('GetOpenDeviceCount');";
     synopsis[i++] = "devices = PsychPortAudio('GetDevices' [,devicetype] [, deviceIndex]);";
     synopsis[i++] = "\nGeneral settings:\n";
-    synopsis[i++] = "[oldyieldInterval, oldMutexEnable, lockToCore1, audioserver_autosuspend] = PsychPortAudio('EngineTunables' [, yieldInterval] [, MutexEnable] [, lockToCore1] [, audioserver_autosuspend]);";
+    synopsis[i++] = "[oldyieldInterval, oldMutexEnable, lockToCore1, audioserver_autosuspend, oldsimdLevel] = PsychPortAudio('EngineTunables' [, yieldInterval] [, MutexEnable] [, lockToCore1] [, audioserver_autosuspend] [, simdLevel]);";
     synopsis[i++] = "oldRunMode = PsychPortAudio('RunMode', pahandle [,runMode]);";
     synopsis[i++] = "\n\nDevice setup and shutdown:\n";
     synopsis[i++] = "pahandle = PsychPortAudio('Open' [, deviceid][, mode][, reqlatencyclass][, freq][, channels][, buffersize][, suggestedLatency][, selectchannels][, specialFlags=0]);";
@@ -1741,15 +2195,17 @@ void InitializeSynopsis(void)
     synopsis[i++] = "oldbias = PsychPortAudio('LatencyBias', pahandle [,biasSecs]);";
     synopsis[i++] = "[oldMasterVolume, oldChannelVolumes] = PsychPortAudio('Volume', pahandle [, masterVolume][, channelVolumes]);";
     synopsis[i++] = "enable = PsychPortAudio('DirectInputMonitoring', pahandle, enable [, inputChannel = -1][, outputChannel = 0][, gainLevel = 0.0][, stereoPan = 0.5]);";
-    synopsis[i++] = "[underflow, nextSampleStartIndex, nextSampleETASecs] = PsychPortAudio('FillBuffer', pahandle, bufferdata [, streamingrefill=0][, startIndex=Append]);";
-    synopsis[i++] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata);";
+    synopsis[i++] = "[oldSpeed, stats] = PsychPortAudio('OfflineSettings', pahandle [, speed][, outputFilename]);";
+    synopsis[i++] = "[underflow, nextSampleStartIndex, nextSampleETASecs] = PsychPortAudio('FillBuffer', pahandle, bufferdata [, streamingrefill=0][, startIndex=Append][, sampleRate]);";
+    synopsis[i++] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata [, sampleRate]);";
     synopsis[i++] = "PsychPortAudio('DeleteBuffer'[, bufferhandle] [, waitmode]);";
-    synopsis[i++] = "PsychPortAudio('RefillBuffer', pahandle [, bufferhandle=0], bufferdata [, startIndex=0]);";
+    synopsis[i++] = "PsychPortAudio('RefillBuffer', pahandle [, bufferhandle=0], bufferdata [, startIndex=0][, sampleRate]);";
     synopsis[i++] = "PsychPortAudio('SetLoop', pahandle[, startSample=0][, endSample=max][, UnitIsSeconds=0]);";
     synopsis[i++] = "startTime = PsychPortAudio('Start', pahandle [, repetitions=1] [, when=0] [, waitForStart=0] [, stopTime=inf] [, resume=0]);";
     synopsis[i++] = "startTime = PsychPortAudio('RescheduleStart', pahandle, when [, waitForStart=0] [, repetitions] [, stopTime]);";
     synopsis[i++] = "status = PsychPortAudio('GetStatus' pahandle);";
     synopsis[i++] = "[audiodata absrecposition overflow cstarttime] = PsychPortAudio('GetAudioData', pahandle [, amountToAllocateSecs][, minimumAmountToReturnSecs][, maximumAmountToReturnSecs][, singleType=0]);";
+    synopsis[i++] = "PsychPortAudio('RecordToFile', pahandle [, filename][, int16=0][, drainIntervalSecs=0.25]);";
     synopsis[i++] = "[startTime endPositionSecs xruns estStopTime] = PsychPortAudio('Stop', pahandle [,waitForEndOfPlayback=0] [, blockUntilStopped=1] [, repetitions] [, stopTime]);";
     synopsis[i++] = "PsychPortAudio('UseSchedule', pahandle, enableSchedule [, maxSize = 128]);";
     synopsis[i++] = "[success, freeslots] = PsychPortAudio('AddToSchedule', pahandle [, bufferHandle=0][, repetitions=1][, startSample=0][, endSample=max][, UnitIsSeconds=0][, specialFlags=0]);";
@@ -1831,6 +2287,9 @@ PsychError PsychPortAudioExit(void)
         // Release audiobufferlist mutex lock:
         PsychDestroyMutex(&bufferListmutex);
 
+        // Release cached filters of the sample rate converter:
+        PsychPAResamplerShutdown();
+
         // Shutdown PortAudio itself:
         err = Pa_Terminate();
         if (err) {
@@ -1926,6 +2385,9 @@ void PsychPortAudioInitialize(void)
         bufferList = NULL;
         PsychInitMutex(&bufferListmutex);
 
+        // Select best sample processing kernels for the mixer:
+        PsychPAInitKernels();
+
         // On Vista systems and later, we assume everything will be fine wrt. to timing and multi-core
         // systems, but still perform consistency checks at each call to PsychGetPrecisionTimerSeconds().
         // Therefore we don't lock our threads to a single core by default. On pre-Vista systems, we
@@ -2005,7 +2467,14 @@ PsychError PSYCHPORTAUDIOOpen(void)
     "audio quantization artifacts. Dithering can improve signal to noise ratio and quality of output sound, but it is more "
     "compute intense and it could change very low-level properties of the audio signal, because what you hear is not exactly "
     "what you specified.\n"
-    "16 = Never dither audio data, not even in normal mode.\n\n";
+    "16 = Never dither audio data, not even in normal mode.\n"
+    "32 = Open an offline device. Offline devices don't use any audio hardware, so they also work on machines without "
+    "sound cards. Instead a driver thread runs the audio engine on a virtual clock, either in realtime, at a multiple of "
+    "realtime, or as fast as possible. Rendered output can be written to a WAV file and is looped back into the capture "
+    "input of full-duplex devices, so it can be retrieved via 'GetAudioData'. Timestamps reported by offline devices "
+    "are in the time of the virtual clock. 'deviceid', 'reqlatencyclass' and 'suggestedLatency' are ignored, 'freq' "
+    "defaults to 48000 Hz and 'buffersize' defaults to 256 sample frames. See 'PsychPortAudio OfflineSettings?' for "
+    "setting speed and output file of offline devices.\n\n";
 
     static char seeAlsoString[] = "Close GetDeviceSettings ";
 
@@ -2022,6 +2491,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
     PaStreamFlags sflags;
     PaError err;
     PaStream *stream = NULL;
+    psych_bool offline;
 
     #if PSYCH_SYSTEM == PSYCH_OSX
     paMacCoreStreamInfo hostapisettings;
@@ -2056,8 +2526,12 @@ PsychError PSYCHPORTAUDIOOpen(void)
     // Make sure PortAudio is online:
     PsychPortAudioInitialize();
 
+    // Copy in optional specialFlags: Needed early, as they decide if this is an offline device without hardware:
+    PsychCopyInIntegerArg(9, kPsychArgOptional, &specialFlags);
+    offline = (specialFlags & 32) ? TRUE : FALSE;
+
     // Sanity check: Any hardware found?
-    if (Pa_GetDeviceCount() == 0) PsychErrorExitMsg(PsychError_user, "Could not find *any* audio hardware on your system! Either your machine doesn't have audio hardware, or somethings seriously screwed.");
+    if (!offline && (Pa_GetDeviceCount() == 0)) PsychErrorExitMsg(PsychError_user, "Could not find *any* audio hardware on your system! Either your machine doesn't have audio hardware, or somethings seriously screwed.");
 
     // We default to generic system settings for host api specific settings:
     outputParameters.hostApiSpecificStreamInfo = NULL;
@@ -2077,7 +2551,11 @@ PsychError PSYCHPORTAUDIOOpen(void)
     PsychCopyInIntegerArg(3, kPsychArgOptional, &latencyclass);
     if (latencyclass < 0 || latencyclass > 4) PsychErrorExitMsg(PsychError_user, "Invalid reqlatencyclass provided. Valid values are 0 to 4.");
 
-    if (deviceid == -1) {
+    if (offline) {
+        // Offline device: No audio hardware involved at all:
+        outputParameters.device = inputParameters.device = paNoDevice;
+    }
+    else if (deviceid == -1) {
         // Default devices requested:
         if ((latencyclass == 0) && (PSYCH_SYSTEM != PSYCH_LINUX)) {
             // High latency mode on non-Linux. Simply pick system default devices.
@@ -2154,9 +2632,9 @@ PsychError PSYCHPORTAUDIOOpen(void)
         inputParameters.device = (PaDeviceIndex) deviceid;
     }
 
-    // Query properties of selected device(s):
-    inputDevInfo  = Pa_GetDeviceInfo(inputParameters.device);
-    outputDevInfo = Pa_GetDeviceInfo(outputParameters.device);
+    // Query properties of selected device(s), if any:
+    inputDevInfo  = (offline) ? NULL : Pa_GetDeviceInfo(inputParameters.device);
+    outputDevInfo = (offline) ? NULL : Pa_GetDeviceInfo(outputParameters.device);
 
     // Select one of them as "reference" info devices: It's properties are used whenever
     // no more specialized info is available. We use the output device (if any) as reference,
@@ -2164,14 +2642,14 @@ PsychError PSYCHPORTAUDIOOpen(void)
     referenceDevInfo = (outputDevInfo) ? outputDevInfo : inputDevInfo;
 
     // Sanity check: Any hardware found?
-    if (referenceDevInfo == NULL) PsychErrorExitMsg(PsychError_user, "Could not find *any* audio hardware on your system - or at least not with the provided deviceid, if any!");
+    if (!offline && (referenceDevInfo == NULL)) PsychErrorExitMsg(PsychError_user, "Could not find *any* audio hardware on your system - or at least not with the provided deviceid, if any!");
 
     // Check if current set of selected/available devices is compatible with our playback mode:
-    if (((mode & kPortAudioPlayBack) || (mode & kPortAudioMonitoring)) && ((outputDevInfo == NULL) || (outputDevInfo && outputDevInfo->maxOutputChannels <= 0))) {
+    if (!offline && ((mode & kPortAudioPlayBack) || (mode & kPortAudioMonitoring)) && ((outputDevInfo == NULL) || (outputDevInfo && outputDevInfo->maxOutputChannels <= 0))) {
         PsychErrorExitMsg(PsychError_user, "Audio output requested, but there isn't any audio output device available or you provided a deviceid for something else than an output device!");
     }
 
-    if (((mode & kPortAudioCapture) || (mode & kPortAudioMonitoring)) && ((inputDevInfo == NULL) || (inputDevInfo && inputDevInfo->maxInputChannels <= 0))) {
+    if (!offline && ((mode & kPortAudioCapture) || (mode & kPortAudioMonitoring)) && ((inputDevInfo == NULL) || (inputDevInfo && inputDevInfo->maxInputChannels <= 0))) {
         PsychErrorExitMsg(PsychError_user, "Audio input requested, but there isn't any audio input device available or you provided a deviceid for something else than an input device!");
     }
 
@@ -2232,7 +2710,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
         // Basic check ok. Build ASIO host specific mapping structure:
         #if PSYCH_SYSTEM == PSYCH_WINDOWS
         // Check for ASIO: This only works for ASIO host API...
-        if (Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type == paASIO) {
+        if (referenceDevInfo && (Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type == paASIO)) {
             // MS-Windows and connected to an ASIO device. Good. Try to assign channel mapping:
             if (mode & kPortAudioPlayBack) {
                 // Playback mappings:
@@ -2279,9 +2757,6 @@ PsychError PSYCHPORTAUDIOOpen(void)
         #endif
     }
 
-    // Copy in optional specialFlags:
-    PsychCopyInIntegerArg(9, kPsychArgOptional, &specialFlags);
-
     // Set channel count:
     outputParameters.channelCount = mynrchannels[0];    // Number of output channels.
     inputParameters.channelCount = mynrchannels[1];        // Number of input channels.
@@ -2301,7 +2776,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
             buffersize = paFramesPerBufferUnspecified;
         }
         else {
-            if (Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type == paCoreAudio) {
+            if (referenceDevInfo && (Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type == paCoreAudio)) {
                 buffersize = 64; // Lowest setting that is safe on a fast MacBook-Pro.
             }
             else {
@@ -2314,6 +2789,9 @@ PsychError PSYCHPORTAUDIOOpen(void)
         }
     }
 
+    // Offline devices need a fixed buffersize, as there isn't any lower level driver to choose one:
+    if (offline && (buffersize == paFramesPerBufferUnspecified)) buffersize = 256;
+
     // Now we have auto-selected buffersize or user provided override...
 
     // Setup samplerate:
@@ -2321,7 +2799,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
         // No specific frequency requested:
         if (latencyclass < 3) {
             // At levels < 3, we select the device specific default.
-            freq = (int) referenceDevInfo->defaultSampleRate;
+            freq = (offline) ? 48000 : (int) referenceDevInfo->defaultSampleRate;
         }
         else {
             freq = 96000; // Go really high...
@@ -2333,7 +2811,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
     // Set requested latency: In class 0 we choose device recommendation for dropout-free operation, in
     // all higher (lowlat) classes we request zero latency. PortAudio will
     // clamp this request to something safe internally.
-    switch (Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type) {
+    switch ((offline) ? kPsychPAOfflineHostAPI : Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type) {
         case paCoreAudio:    // CoreAudio driver will automatically clamp to safe minimum. Around 0.7 msecs.
         case paWDMKS:        // dto. for Windows kernel streaming.
             lowlatency = 0.0;
@@ -2411,7 +2889,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
     if (specialFlags & 16) sflags |= paDitherOff;
 
     // Check if the requested sample format and settings are likely supported by Audio API:
-    err = Pa_IsFormatSupported(((mode & kPortAudioCapture) ?  &inputParameters : NULL), ((mode & kPortAudioPlayBack) ? &outputParameters : NULL), freq);
+    err = (offline) ? paNoError : Pa_IsFormatSupported(((mode & kPortAudioCapture) ?  &inputParameters : NULL), ((mode & kPortAudioPlayBack) ? &outputParameters : NULL), freq);
     if (err != paNoError && err != paDeviceUnavailable) {
         printf("PTB-ERROR: Desired audio parameters for device %i unsupported by audio device. PortAudio reports this error: %s \n", deviceid, Pa_GetErrorText(err));
         printf("PTB-ERROR: This could be, e.g., due to an unsupported combination of audio sample rate, audio channel allocation, or audio sample format.\n");
@@ -2420,8 +2898,11 @@ PsychError PSYCHPORTAUDIOOpen(void)
         PsychErrorExitMsg(PsychError_system, "Failed to open PortAudio audio device due to unsupported combination of audio parameters.");
     }
 
-    // Try to create & open stream:
-    if (err == paNoError)
+    // Try to create & open stream: Offline devices get a stream driven by our own driver thread instead of audio hardware:
+    if (offline)
+        err = PsychPAOfflineOpenStream(&stream, (mode & kPortAudioCapture) ? mynrchannels[1] : 0, (mode & kPortAudioPlayBack) ? mynrchannels[0] : 0,
+                                       (double) freq, (unsigned long) buffersize, paCallback, &audiodevices[audiodevicecount]);
+    else if (err == paNoError)
         err = Pa_OpenStream(
                             &stream,                                                        /* Return stream pointer here on success. */
                             ((mode & kPortAudioCapture) ?  &inputParameters : NULL),        /* Requested input settings, or NULL in pure playback case. */
@@ -2449,8 +2930,8 @@ PsychError PSYCHPORTAUDIOOpen(void)
     audiodevices[audiodevicecount].opmode = mode;
     audiodevices[audiodevicecount].runMode = 1; // Keep engine running by default. Minimal extra cpu-load for significant reduction in startup latency.
     audiodevices[audiodevicecount].stream = stream;
-    audiodevices[audiodevicecount].streaminfo = Pa_GetStreamInfo(stream);
-    audiodevices[audiodevicecount].hostAPI = Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type;
+    audiodevices[audiodevicecount].streaminfo = PsychPAStreamGetInfo(stream);
+    audiodevices[audiodevicecount].hostAPI = (offline) ? kPsychPAOfflineHostAPI : Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type;
     audiodevices[audiodevicecount].startTime = 0.0;
     audiodevices[audiodevicecount].reqStartTime = 0.0;
     audiodevices[audiodevicecount].reqStopTime = DBL_MAX;
@@ -2461,8 +2942,11 @@ PsychError PSYCHPORTAUDIOOpen(void)
     audiodevices[audiodevicecount].repeatCount = 1;
     audiodevices[audiodevicecount].outputbuffer = NULL;
     audiodevices[audiodevicecount].outputbuffersize = 0;
+    audiodevices[audiodevicecount].outputbuffercapacity = 0;
     audiodevices[audiodevicecount].inputbuffer = NULL;
     audiodevices[audiodevicecount].inputbuffersize = 0;
+    audiodevices[audiodevicecount].recorder = NULL;
+    audiodevices[audiodevicecount].resampler = NULL;
     audiodevices[audiodevicecount].outchannels = mynrchannels[0];
     audiodevices[audiodevicecount].inchannels = mynrchannels[1];
     audiodevices[audiodevicecount].latencyBias = 0.0;
@@ -2473,6 +2957,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
     audiodevices[audiodevicecount].outdeviceidx = (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) ? outputParameters.device : -1;
     audiodevices[audiodevicecount].indeviceidx  = (audiodevices[audiodevicecount].opmode & kPortAudioCapture)  ? inputParameters.device  : -1;
     audiodevices[audiodevicecount].outputmappings = NULL;
+    audiodevices[audiodevicecount].outputplan = NULL;
     audiodevices[audiodevicecount].inputmappings = NULL;
     audiodevices[audiodevicecount].slaveCount = 0;
     audiodevices[audiodevicecount].slaves = NULL;
@@ -2483,8 +2968,14 @@ PsychError PSYCHPORTAUDIOOpen(void)
     audiodevices[audiodevicecount].slaveInBuffer = NULL;
     audiodevices[audiodevicecount].outChannelVolumes = NULL;
     audiodevices[audiodevicecount].masterVolume = 1.0;
+    audiodevices[audiodevicecount].reqOutChannelVolumes = NULL;
+    audiodevices[audiodevicecount].reqMasterVolume = 1.0;
+    audiodevices[audiodevicecount].cmdWritePos = 0;
+    audiodevices[audiodevicecount].cmdReadPos = 0;
+    audiodevices[audiodevicecount].cmdOverflow = FALSE;
     audiodevices[audiodevicecount].playposition = 0;
     audiodevices[audiodevicecount].totalplaycount = 0;
+    PsychPAFillStatusSnapshot(&audiodevices[audiodevicecount], &audiodevices[audiodevicecount].statusSnapshot);
 
     // If this is a master, create a slave device list and init it to "empty":
     if (mode & kPortAudioIsMaster) {
@@ -2495,6 +2986,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
         if (mode & kPortAudioPlayBack) {
             // Allocate a dummy outputbuffer with one sampleframe:
             audiodevices[audiodevicecount].outputbuffersize = sizeof(float) * audiodevices[audiodevicecount].outchannels * 1;
+            audiodevices[audiodevicecount].outputbuffercapacity = audiodevices[audiodevicecount].outputbuffersize;
             audiodevices[audiodevicecount].outputbuffer = (float*) malloc((size_t) audiodevices[audiodevicecount].outputbuffersize);
             if (audiodevices[audiodevicecount].outputbuffer==NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of system memory when trying to allocate audio buffer.");
         }
@@ -2517,7 +3009,7 @@ PsychError PSYCHPORTAUDIOOpen(void)
     PsychPACreateSignal(&(audiodevices[audiodevicecount]));
 
     // Register the stream finished callback:
-    Pa_SetStreamFinishedCallback(audiodevices[audiodevicecount].stream, PAStreamFinishedCallback);
+    PsychPAStreamSetFinishedCallback(audiodevices[audiodevicecount].stream, PAStreamFinishedCallback);
 
     #if PSYCH_SYSTEM == PSYCH_OSX
     // Query low-level audio driver of the CoreAudio HAL for hardware latency:
@@ -2532,14 +3024,20 @@ PsychError PSYCHPORTAUDIOOpen(void)
     #endif
 
     if (verbosity > 3) {
-        printf("PTB-INFO: New audio device %i with handle %i opened as PortAudio stream:\n", deviceid, audiodevicecount);
+        printf("PTB-INFO: New audio device %i with handle %i opened as %s stream:\n", deviceid, audiodevicecount, (offline) ? "offline" : "PortAudio");
 
-        if (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) {
+        if (offline) {
+            printf("PTB-INFO: For %i channels Playback and %i channels Capture: Offline device without audio hardware, buffersize %i frames.\n",
+                   (mode & kPortAudioPlayBack) ? (int) audiodevices[audiodevicecount].outchannels : 0,
+                   (mode & kPortAudioCapture) ? (int) audiodevices[audiodevicecount].inchannels : 0, buffersize);
+        }
+
+        if (!offline && (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack)) {
             printf("PTB-INFO: For %i channels Playback: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].outchannels, Pa_GetHostApiInfo(outputDevInfo->hostApi)->name);
             printf("%s\n", outputDevInfo->name);
         }
 
-        if (audiodevices[audiodevicecount].opmode & kPortAudioCapture) {
+        if (!offline && (audiodevices[audiodevicecount].opmode & kPortAudioCapture)) {
             printf("PTB-INFO: For %i channels Capture: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].inchannels, Pa_GetHostApiInfo(inputDevInfo->hostApi)->name);
             printf("%s\n", inputDevInfo->name);
         }
@@ -2734,6 +3232,7 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
 
     // Get optional channel map:
     audiodevices[audiodevicecount].outputmappings = NULL;
+    audiodevices[audiodevicecount].outputplan = NULL;
     audiodevices[audiodevicecount].inputmappings = NULL;
     mychannelmap = NULL;
     PsychAllocInDoubleMatArg(4, kPsychArgOptional, &m, &n, &p, &mychannelmap);
@@ -2836,12 +3335,18 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
         }
     }
 
+    // Precompute mix plan for the output mapping into the channels of the parent device:
+    if (audiodevices[audiodevicecount].outputmappings) {
+        audiodevices[audiodevicecount].outputplan = PsychPACreateMixPlan(audiodevices[audiodevicecount].outputmappings, mynrchannels[0], audiodevices[pamaster].outchannels);
+        if (audiodevices[audiodevicecount].outputplan == NULL) PsychErrorExitMsg(PsychError_outofMemory, "Memory exhausted during audio channel mix plan setup.");
+    }
+
     // Setup our final device structure. Mostly settings from the master device, with
     // a few settings specific to the slave:
     audiodevices[audiodevicecount].opmode = mode;
     audiodevices[audiodevicecount].runMode = 1;
     audiodevices[audiodevicecount].stream = audiodevices[pamaster].stream;
-    audiodevices[audiodevicecount].streaminfo = Pa_GetStreamInfo(audiodevices[pamaster].stream);
+    audiodevices[audiodevicecount].streaminfo = PsychPAStreamGetInfo(audiodevices[pamaster].stream);
     audiodevices[audiodevicecount].hostAPI = audiodevices[pamaster].hostAPI;
     audiodevices[audiodevicecount].startTime = 0.0;
     audiodevices[audiodevicecount].reqStartTime = 0.0;
@@ -2853,8 +3358,11 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
     audiodevices[audiodevicecount].repeatCount = 1;
     audiodevices[audiodevicecount].outputbuffer = NULL;
     audiodevices[audiodevicecount].outputbuffersize = 0;
+    audiodevices[audiodevicecount].outputbuffercapacity = 0;
     audiodevices[audiodevicecount].inputbuffer = NULL;
     audiodevices[audiodevicecount].inputbuffersize = 0;
+    audiodevices[audiodevicecount].recorder = NULL;
+    audiodevices[audiodevicecount].resampler = NULL;
     audiodevices[audiodevicecount].outchannels = mynrchannels[0];
     audiodevices[audiodevicecount].inchannels = mynrchannels[1];
     audiodevices[audiodevicecount].latencyBias = 0.0;
@@ -2872,17 +3380,24 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
     audiodevices[audiodevicecount].slaveGainBuffer = NULL;
     audiodevices[audiodevicecount].slaveInBuffer = NULL;
     audiodevices[audiodevicecount].masterVolume = 1.0;
+    audiodevices[audiodevicecount].reqMasterVolume = 1.0;
+    audiodevices[audiodevicecount].cmdWritePos = 0;
+    audiodevices[audiodevicecount].cmdReadPos = 0;
+    audiodevices[audiodevicecount].cmdOverflow = FALSE;
     audiodevices[audiodevicecount].playposition = 0;
     audiodevices[audiodevicecount].totalplaycount = 0;
+    PsychPAFillStatusSnapshot(&audiodevices[audiodevicecount], &audiodevices[audiodevicecount].statusSnapshot);
 
     // Setup per-channel output volumes for slave: Each channel starts with a 1.0 setting, ie., max volume:
     if (audiodevices[audiodevicecount].outchannels > 0) {
         audiodevices[audiodevicecount].outChannelVolumes = (float*) malloc(sizeof(float) * (size_t) audiodevices[audiodevicecount].outchannels);
-        if (audiodevices[audiodevicecount].outChannelVolumes == NULL) PsychErrorExitMsg(PsychError_outofMemory, "Memory exhausted during audio volume vector allocation.");
-        for (i = 0; i < audiodevices[audiodevicecount].outchannels; i++) audiodevices[audiodevicecount].outChannelVolumes[i] = 1.0;
+        audiodevices[audiodevicecount].reqOutChannelVolumes = (float*) malloc(sizeof(float) * (size_t) audiodevices[audiodevicecount].outchannels);
+        if ((audiodevices[audiodevicecount].outChannelVolumes == NULL) || (audiodevices[audiodevicecount].reqOutChannelVolumes == NULL)) PsychErrorExitMsg(PsychError_outofMemory, "Memory exhausted during audio volume vector allocation.");
+        for (i = 0; i < audiodevices[audiodevicecount].outchannels; i++) audiodevices[audiodevicecount].outChannelVolumes[i] = audiodevices[audiodevicecount].reqOutChannelVolumes[i] = 1.0;
     }
     else {
         audiodevices[audiodevicecount].outChannelVolumes = NULL;
+        audiodevices[audiodevicecount].reqOutChannelVolumes = NULL;
     }
 
     // If we use locking, we need to initialize the per-device mutex:
@@ -3001,13 +3516,14 @@ PsychError PSYCHPORTAUDIOClose(void)
  */
 PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
 {
-    static char useString[] = "[underflow, nextSampleStartIndex, nextSampleETASecs] = PsychPortAudio('FillBuffer', pahandle, bufferdata [, streamingrefill=0][, startIndex=Append]);";
-    //                            1           2                     3                                                   1         2               3                    4
+    static char useString[] = "[underflow, nextSampleStartIndex, nextSampleETASecs] = PsychPortAudio('FillBuffer', pahandle, bufferdata [, streamingrefill=0][, startIndex=Append][, sampleRate]);";
+    //                            1           2                     3                                                   1         2               3                    4                    5
     static char synopsisString[] =
     "Fill audio data playback buffer of a PortAudio audio device. 'pahandle' is the handle of the device "
-    "whose buffer is to be filled. 'bufferdata' is usually a matrix with audio data in double() or single() format. Each "
-    "row of the matrix specifies one sound channel, each column one sample for each channel. Only floating point "
-    "values are supported. Samples need to be in range -1.0 to +1.0, with 0.0 for silence. This is "
+    "whose buffer is to be filled. 'bufferdata' is usually a matrix with audio data in double(), single() or int16() format. Each "
+    "row of the matrix specifies one sound channel, each column one sample for each channel. Floating point "
+    "samples need to be in range -1.0 to +1.0, with 0.0 for silence, int16 samples cover the full int16 range. "
+    "single() and int16() matrices need less memory and are converted faster than double() matrices. This is "
     "intentionally a very restricted interface. For lowest latency and best timing we want you to provide audio "
     "data exactly at the optimal format and sample rate, so the driver can safe computation time and latency for "
     "expensive sample rate conversion, sample format conversion, and bounds checking/clipping.\n"
@@ -3030,6 +3546,15 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
     "of the buffer will happen at the provided linear sample index 'startIndex'. If the argument is omitted, new data "
     "will be appended at the end of the current soundbuffers content. The 'startIndex' argument is ignored if no streaming "
     "refill is requested.\n"
+    "'sampleRate' optional: Sample rate of the sound data in Hz, if it differs from the sample rate of the device. "
+    "Such sound data is converted to the sample rate of the device by a high quality polyphase resampler while "
+    "filling the buffer, so playback itself doesn't need any extra computation, and playback timing and latency are "
+    "the same as for sound data at the device rate. 'n' sample frames convert into ceil(n * deviceRate / sampleRate) "
+    "sample frames. Rates are rounded to integer Hz, the reduced ratio deviceRate / sampleRate must have a numerator "
+    "of at most 4096, and downsampling is limited to a factor of 8. Streaming refills which append sound data at the "
+    "same 'sampleRate' continue the conversion seamlessly: The last few milliseconds of each refill are computed as if "
+    "the sound ended there, and get replaced by the following refill, so keep refilling ahead of playback. Conversion "
+    "costs computation time, so providing sound data at the device rate is still the most efficient option.\n"
     "\nOptionally the function returns the following values:\n"
     "'underflow' A flag: If 1 then the audio buffer underflowed because you didn't refill it in time, ie., some audible "
     "glitches were present in playback and your further playback timing is screwed.\n"
@@ -3045,25 +3570,29 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
 
     PsychPABuffer* inbuffer;
     int inbufferhandle = 0;
-    float*  indatafloat = NULL;
-    psych_bool userfloat = FALSE;
+    const void* indata = NULL;
+    int informat;
+    float ingain;
     psych_int64 inchannels, insamples, p;
+    psych_int64 ringsize, writeindex, count, chunk;
     size_t buffersize;
     psych_int64 totalplaycount;
-    double*    indata = NULL;
-    float*  outdata = NULL;
     int pahandle   = -1;
     int streamingrefill = 0;
+    psych_bool startIndexProvided = FALSE;
     int underrun = 0;
     double currentTime, etaSecs;
     psych_int64 startIndex = 0;
     double tBehind = 0.0;
+    double inRate = 0;
+    PsychPAResampler* resampler;
+    PsychPAStatusSnapshot snapshot;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
     if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
 
-    PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+    PsychErrorExit(PsychCapNumInputArgs(5));     // The maximum number of inputs
     PsychErrorExit(PsychRequireNumInputArgs(2)); // The required number of inputs
     PsychErrorExit(PsychCapNumOutputArgs(3));     // The maximum number of outputs
 
@@ -3083,15 +3612,15 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
         inchannels = inbuffer->outchannels;
         insamples  = inbuffer->outputbuffersize / sizeof(float) / inchannels;
         p = 1;
-        indatafloat = inbuffer->outputbuffer;
+
+        // Already in float format and premultiplied with anti-clamp gain, so a plain copy:
+        indata = inbuffer->outputbuffer;
+        informat = kPsychPASampleFloat32;
+        ingain = 1.0f;
     }
     else {
-        // Regular double matrix with sound data from runtime:
-        if (!PsychAllocInDoubleMatArg64(2, kPsychArgAnything, &inchannels, &insamples, &p, &indata)) {
-            // Or regular float matrix instead:
-            PsychAllocInFloatMatArg64(2, kPsychArgRequired, &inchannels, &insamples, &p, &indatafloat);
-            userfloat = TRUE;
-        }
+        // Regular double, single or int16 matrix with sound data from runtime:
+        PsychPAAllocInSampleMatArg(2, &inchannels, &insamples, &p, &indata, &informat, &ingain);
     }
 
     if (inchannels != audiodevices[pahandle].outchannels) {
@@ -3105,59 +3634,56 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
     // Get optional streaming refill flag:
     PsychCopyInIntegerArg(3, kPsychArgOptional, &streamingrefill);
 
+    // Get optional sample rate of the sound data. Zero if it is the sample rate of the device:
+    if (PsychCopyInDoubleArg(5, kPsychArgOptional, &inRate) && !PsychPANeedsResampling(&audiodevices[pahandle], inRate)) inRate = 0;
+
+    // Sound data at the device rate ends the conversion stream of previous fills:
+    if ((inRate == 0) && audiodevices[pahandle].resampler) {
+        PsychPAResamplerDestroy(audiodevices[pahandle].resampler);
+        audiodevices[pahandle].resampler = NULL;
+    }
+
     // Full refill or streaming refill?
     if (streamingrefill <= 0) {
         // Standard refill with possible buffer reallocation. Engine needs to be
         // stopped, full reset of engine at refill:
 
-        // Wait for playback on this stream to finish, before refilling it:
-        PsychPALockDeviceMutex(&audiodevices[pahandle]);
-        while (audiodevices[pahandle].state > 0) {
-            // Wait for a state-change before reevaluating the .state:
-            PsychPAWaitForChange(&audiodevices[pahandle]);
+        // Wait for playback on this stream to finish, before refilling it. We poll the published
+        // state instead of waiting with the device mutex held, so the engine never waits for us.
+        // The idle state gets published after the engine is done with the old buffer:
+        PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
+        while (snapshot.state > 0) {
+            PsychYieldIntervalSeconds(yieldInterval);
+            PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
         }
 
-        // Device is idle, we hold the lock. We can safely drop the lock here and still modify
-        // device data, as none of this will get touched by the engine in idle state:
-        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        // Device is idle. We can modify the sound buffer, as it won't get touched by the engine in idle state:
+
+        // Convert sound data at another sample rate, as start of a new stream for following streaming refills:
+        if (inRate > 0) PsychPAResampleSamples(PsychPAGetDeviceResampler(&audiodevices[pahandle], inRate, FALSE), inchannels, &insamples, &indata, &informat, &ingain);
 
-        // Ok, everything sane, fill the buffer:
+        // Ok, everything sane, fill the buffer. Reuse the existing allocation if it is big enough
+        // and doesn't waste more than half of its capacity, so repeated refills of similar size
+        // don't hit the allocator:
         buffersize = sizeof(float) * (size_t) (inchannels * insamples);
-        if (audiodevices[pahandle].outputbuffer && (audiodevices[pahandle].outputbuffersize != buffersize)) {
+        if (audiodevices[pahandle].outputbuffer && ((audiodevices[pahandle].outputbuffercapacity < (psych_int64) buffersize) ||
+                                                    (audiodevices[pahandle].outputbuffercapacity > 2 * (psych_int64) buffersize))) {
             free(audiodevices[pahandle].outputbuffer);
             audiodevices[pahandle].outputbuffer = NULL;
             audiodevices[pahandle].outputbuffersize = 0;
+            audiodevices[pahandle].outputbuffercapacity = 0;
         }
 
         if (audiodevices[pahandle].outputbuffer == NULL) {
-            audiodevices[pahandle].outputbuffersize = buffersize;
             audiodevices[pahandle].outputbuffer = (float*) malloc(buffersize);
             if (audiodevices[pahandle].outputbuffer==NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of system memory when trying to allocate audio buffer.");
+            audiodevices[pahandle].outputbuffercapacity = (psych_int64) buffersize;
         }
 
-        // Reset play position:
-        audiodevices[pahandle].playposition = 0;
+        audiodevices[pahandle].outputbuffersize = buffersize;
 
-        outdata = audiodevices[pahandle].outputbuffer;
-        if (indata || userfloat) {
-            if (indata) {
-                // Copy the data, convert it from double to float:
-                while(buffersize) {
-                    *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indata++));
-                    buffersize-=sizeof(float);
-                }
-            } else {
-                // Copy the data:
-                while(buffersize) {
-                    *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indatafloat++));
-                    buffersize-=sizeof(float);
-                }
-            }
-        }
-        else {
-            // Data copy from internal audio buffer (already in float format and premultiplied with anti-clamp gain):
-            memcpy(outdata, indatafloat, buffersize);
-        }
+        // Copy the data, convert it to float:
+        PsychPAConvertSamples(audiodevices[pahandle].outputbuffer, indata, informat, inchannels * insamples, ingain);
 
         // Reset write position to end of buffer:
         audiodevices[pahandle].writeposition = (psych_int64) inchannels * insamples;
@@ -3168,15 +3694,15 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
         // Current playout time undefined when playback is stopped:
         currentTime = PsychGetNanValue();
 
-        // Reset playback loop to full buffer:
-        audiodevices[pahandle].loopStartFrame = 0;
-        audiodevices[pahandle].loopEndFrame = (audiodevices[pahandle].outputbuffersize / sizeof(float) / audiodevices[pahandle].outchannels) - 1;
+        // Reset play position and playback loop to full buffer. The engine may keep running in runMode 1,
+        // so leave it to the consumer of the command queue, which also republishes the status snapshot:
+        PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdRewind, 0, 0, 0, (audiodevices[pahandle].outputbuffersize / sizeof(float) / audiodevices[pahandle].outchannels) - 1);
     }
     else {
         // Streaming refill while playback is running:
 
         // Get optional startIndex for new writePosition, if any:
-        if (PsychCopyInIntegerArg64(4, kPsychArgOptional, &startIndex)) {
+        if ((startIndexProvided = PsychCopyInIntegerArg64(4, kPsychArgOptional, &startIndex))) {
             // New writePosition provided:
             if (startIndex < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'startIndex' provided. Must be greater or equal to zero.");
 
@@ -3191,104 +3717,84 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
         // No buffer allocated? [No need to mutex-lock, see above]
         if (audiodevices[pahandle].outputbuffer == NULL) PsychErrorExitMsg(PsychError_user, "No audio buffer allocated! You must call this method once before start of playback to initially allocate a buffer of sufficient size.");
 
+        // Convert sound data at another sample rate. Appending continues the stream of the previous fill, overwriting
+        // its provisional trailing sample frames, which were computed without knowing the following sound data:
+        if (inRate > 0) {
+            resampler = PsychPAGetDeviceResampler(&audiodevices[pahandle], inRate, !startIndexProvided);
+            audiodevices[pahandle].writeposition -= PsychPAResamplerGetProvisionalFrames(resampler) * inchannels;
+            PsychPAResampleSamples(resampler, inchannels, &insamples, &indata, &informat, &ingain);
+        }
+
         // Buffer of sufficient size for a streaming refill of this amount?
         buffersize = sizeof(float) * (size_t) ((psych_int64) inchannels * (psych_int64) insamples);
         if (audiodevices[pahandle].outputbuffersize < (psych_int64) buffersize) PsychErrorExitMsg(PsychError_user, "Total capacity of audio buffer is too small for a refill of this size! Allocate an initial buffer of at least the size of the biggest refill.");
 
-        // Need to lock b'cause of 'playposition':
-        PsychPALockDeviceMutex(&audiodevices[pahandle]);
+        // We don't take the device mutex here, so the audio thread never has to wait for us while we
+        // copy potentially large amounts of sound data. Instead we get the play position from the status
+        // snapshot, which is published by the audio thread after each callback. That position is at most
+        // one callback behind the true position, which only makes our headroom estimate conservative:
+        PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
 
         // Check for buffer underrun:
-        if (audiodevices[pahandle].writeposition < audiodevices[pahandle].playposition) {
+        if (audiodevices[pahandle].writeposition < snapshot.playposition) {
             underrun = 1;
-            tBehind = (double) audiodevices[pahandle].playposition - (double) audiodevices[pahandle].writeposition;
+            tBehind = (double) snapshot.playposition - (double) audiodevices[pahandle].writeposition;
         }
 
         // Boundary conditions met. Can we refill immediately or do we need to wait for playback
         // position to progress far enough? We skip this test if the streamingrefill flag is > 1:
-        while ((streamingrefill < 2) && (audiodevices[pahandle].state > 0) && (!underrun) && (((audiodevices[pahandle].outputbuffersize / (psych_int64) sizeof(float)) - (audiodevices[pahandle].writeposition - audiodevices[pahandle].playposition) - (psych_int64) inchannels) <= (inchannels * insamples))) {
-            // Sleep a bit, drop the lock throughout sleep:
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        while ((streamingrefill < 2) && (audiodevices[pahandle].state > 0) && (!underrun) && (((audiodevices[pahandle].outputbuffersize / (psych_int64) sizeof(float)) - (audiodevices[pahandle].writeposition - snapshot.playposition) - (psych_int64) inchannels) <= (inchannels * insamples))) {
+            // Sleep a bit:
             // TODO: We could do better here by predicting how long it will take at least until we're ready to refill,
             // but a perfect solution would require quite a bit of effort... ...Something for a really boring afternoon.
             PsychYieldIntervalSeconds(yieldInterval);
-            PsychPALockDeviceMutex(&audiodevices[pahandle]);
+            PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
 
             // Recheck for buffer underrun:
-            if (audiodevices[pahandle].writeposition < audiodevices[pahandle].playposition) {
+            if (audiodevices[pahandle].writeposition < snapshot.playposition) {
                 underrun = 1;
-                tBehind = (double) audiodevices[pahandle].playposition - (double) audiodevices[pahandle].writeposition;
+                tBehind = (double) snapshot.playposition - (double) audiodevices[pahandle].writeposition;
             }
         }
 
-        // Exit with lock held...
-
         // Have we left the while-loop because the engine stopped? In that case we won't
         // be able to ever get the needed headroom and need to error-out:
         if (audiodevices[pahandle].state == 0) {
             // Ohoh...
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
             PsychErrorExitMsg(PsychError_user, "Audiodevice no longer in playback mode (Auto stopped?!?)! Can't continue a streaming buffer refill while stopped. Check your code!");
         }
 
-        // Ok, device locked and enough headroom for batch streaming refill:
-
-        // Copy the data, convert it from double to float, take ringbuffer wraparound into account:
-        if (indata || userfloat) {
-            if (indata) {
-                while(buffersize > 0) {
-                    // Fetch next sample and copy it to matrix:
-                    audiodevices[pahandle].outputbuffer[(audiodevices[pahandle].writeposition % (audiodevices[pahandle].outputbuffersize / sizeof(float)))] = (float) (PA_ANTICLAMPGAIN *  *(indata++));
-
-                    // Update sample write counter:
-                    audiodevices[pahandle].writeposition++;
-
-                    // Decrement copy counter:
-                    buffersize-=sizeof(float);
-                }
-            }
-            else {
-                while(buffersize > 0) {
-                    // Fetch next sample and copy it to matrix:
-                    audiodevices[pahandle].outputbuffer[(audiodevices[pahandle].writeposition % (audiodevices[pahandle].outputbuffersize / sizeof(float)))] = (float) (PA_ANTICLAMPGAIN *  *(indatafloat++));
-
-                    // Update sample write counter:
-                    audiodevices[pahandle].writeposition++;
-
-                    // Decrement copy counter:
-                    buffersize-=sizeof(float);
-                }
-            }
+        // Ok, enough headroom for batch streaming refill:
+
+        // Copy the data, convert it to float, take ringbuffer wraparound into account. This needs
+        // at most two contiguous chunks, as the refill is no bigger than the ringbuffer:
+        ringsize = audiodevices[pahandle].outputbuffersize / sizeof(float);
+        count = inchannels * insamples;
+        while (count > 0) {
+            writeindex = audiodevices[pahandle].writeposition % ringsize;
+            chunk = (count < ringsize - writeindex) ? count : ringsize - writeindex;
+            PsychPAConvertSamples(&(audiodevices[pahandle].outputbuffer[writeindex]), indata, informat, chunk, ingain);
+
+            // Advance source pointer and sample write counter:
+            indata = (const void*) ((const char*) indata + chunk * PsychPAGetSampleSize(informat));
+            audiodevices[pahandle].writeposition += chunk;
+            count -= chunk;
         }
-        else {
-            // Data copy from internal audio buffer (already in float format and premultiplied with anti-clamp gain):
-            while(buffersize > 0) {
-                // Fetch next sample and copy it to matrix:
-                audiodevices[pahandle].outputbuffer[(audiodevices[pahandle].writeposition % (audiodevices[pahandle].outputbuffersize / sizeof(float)))] = *(indatafloat++);
 
-                // Update sample write counter:
-                audiodevices[pahandle].writeposition++;
+        // Make the new sound data visible to the audio thread before it can get to play it:
+        PsychMemoryBarrier();
 
-                // Decrement copy counter:
-                buffersize-=sizeof(float);
-            }
-        }
-
-        // Retrieve total count of played out samples from engine:
-        totalplaycount = audiodevices[pahandle].totalplaycount;
-
-        // Retrieve corresponding timestamp of last playout:
-        currentTime = audiodevices[pahandle].currentTime;
+        // Retrieve total count of played out samples and corresponding timestamp of last playout:
+        PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
+        totalplaycount = snapshot.totalplaycount;
+        currentTime = snapshot.currentTime;
 
         // Check for buffer underrun:
-        if (audiodevices[pahandle].writeposition < audiodevices[pahandle].playposition) {
+        if (audiodevices[pahandle].writeposition < snapshot.playposition) {
             underrun = 1;
-            tBehind = (double) audiodevices[pahandle].playposition - (double) audiodevices[pahandle].writeposition;
+            tBehind = (double) snapshot.playposition - (double) audiodevices[pahandle].writeposition;
         }
 
-        // Drop lock here, no longer needed:
-        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
-
         if ((underrun > 0) && (verbosity > 1)) {
             printf("PsychPortAudio-WARNING: Underrun of audio playback buffer detected during streaming refill at approximate play position %f secs [%f msecs behind]. Sound will be skipped, timing may be wrong and audible glitches may occur!\n",
                    ((double) audiodevices[pahandle].playposition / ((double) audiodevices[pahandle].outchannels * (double) audiodevices[pahandle].streaminfo->sampleRate)) , tBehind / ((double) audiodevices[pahandle].outchannels * (double) audiodevices[pahandle].streaminfo->sampleRate) * 1000.0);
@@ -3313,13 +3819,13 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
  */
 PsychError PSYCHPORTAUDIORefillBuffer(void)
 {
-    static char useString[] = "PsychPortAudio('RefillBuffer', pahandle [, bufferhandle=0], bufferdata [, startIndex=0]);";
+    static char useString[] = "PsychPortAudio('RefillBuffer', pahandle [, bufferhandle=0], bufferdata [, startIndex=0][, sampleRate]);";
     static char synopsisString[] =
     "Refill part of an audio data playback buffer of a PortAudio audio device. 'pahandle' is the handle of the device "
     "whose buffer is to be filled. 'bufferhandle' is the handle of the buffer: Use a handle of zero for the standard "
-    "buffer created and accessed via 'FillBuffer'. 'bufferdata' is a matrix with audio data in double() or single() "
-    "format. Each row of the matrix specifies one sound channel, each column one sample for each channel. Only floating point "
-    "values are supported. Samples need to be in range -1.0 to +1.0, with 0.0 for silence. This is "
+    "buffer created and accessed via 'FillBuffer'. 'bufferdata' is a matrix with audio data in double(), single() or int16() "
+    "format. Each row of the matrix specifies one sound channel, each column one sample for each channel. Floating point "
+    "samples need to be in range -1.0 to +1.0, with 0.0 for silence, int16 samples cover the full int16 range. This is "
     "intentionally a very restricted interface. For lowest latency and best timing we want you to provide audio "
     "data exactly at the optimal format and sample rate, so the driver can safe computation time and latency for "
     "expensive sample rate conversion, sample format conversion, and bounds checking/clipping.\n"
@@ -3330,6 +3836,9 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
     "'startIndex' optional: Defines the first sample frame within the buffer where refill should start. "
     "By default, refilling starts at the beginning of the buffer - at sample frame 0. 'startIndex' allows to "
     "start refilling at some offset.\n"
+    "'sampleRate' optional: Sample rate of the sound data in Hz, if it differs from the sample rate of the device. "
+    "Such sound data is converted to the sample rate of the device, see 'FillBuffer' for details. 'startIndex' "
+    "counts sample frames at the sample rate of the device.\n"
     "Please note that 'RefillBuffer' can't resize an existing buffer - you can't fill in more data than the "
     "current buffer capacity permits. If you want to add more sound, you'll need to use 'FillBuffer' or "
     "create a new buffer of proper capacity.\n"
@@ -3345,20 +3854,22 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
 
     psych_int64 inchannels, insamples, p;
     size_t buffersize, outbuffersize;
-    double*    indata = NULL;
+    const void* indata = NULL;
+    int informat;
+    float ingain;
     int inbufferhandle = 0;
-    float*  indatafloat = NULL;
-    psych_bool userfloat = FALSE;
     float*  outdata = NULL;
     int pahandle   = -1;
     int bufferhandle = 0;
     psych_int64 startIndex = 0;
+    double inRate;
+    PsychPAResampler* resampler;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
     if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
 
-    PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+    PsychErrorExit(PsychCapNumInputArgs(5));     // The maximum number of inputs
     PsychErrorExit(PsychRequireNumInputArgs(3)); // The required number of inputs
     PsychErrorExit(PsychCapNumOutputArgs(0));     // The maximum number of outputs
 
@@ -3394,15 +3905,15 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
         inchannels = inbuffer->outchannels;
         insamples = inbuffer->outputbuffersize / sizeof(float) / inchannels;
         p = 1;
-        indatafloat = inbuffer->outputbuffer;
+
+        // Already in float format and premultiplied with anti-clamp gain, so a plain copy:
+        indata = inbuffer->outputbuffer;
+        informat = kPsychPASampleFloat32;
+        ingain = 1.0f;
     }
     else {
-        // Regular double matrix with sound data from runtime:
-        if (!PsychAllocInDoubleMatArg64(3, kPsychArgAnything, &inchannels, &insamples, &p, &indata)) {
-            // Or regular float matrix instead:
-            PsychAllocInFloatMatArg64(3, kPsychArgRequired, &inchannels, &insamples, &p, &indatafloat);
-            userfloat = TRUE;
-        }
+        // Regular double, single or int16 matrix with sound data from runtime:
+        PsychPAAllocInSampleMatArg(3, &inchannels, &insamples, &p, &indata, &informat, &ingain);
     }
 
     if (inchannels != audiodevices[pahandle].outchannels) {
@@ -3417,6 +3928,13 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
     PsychCopyInIntegerArg64(4, kPsychArgOptional, &startIndex);
     if (startIndex < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'startIndex' provided. Must be greater or equal to zero.");
 
+    // Convert sound data at another sample rate, if any:
+    if (PsychCopyInDoubleArg(5, kPsychArgOptional, &inRate) && PsychPANeedsResampling(&audiodevices[pahandle], inRate)) {
+        resampler = PsychPACreateResampler(&audiodevices[pahandle], inRate, NULL);
+        PsychPAResampleSamples(resampler, inchannels, &insamples, &indata, &informat, &ingain);
+        PsychPAResamplerDestroy(resampler);
+    }
+
     // Assign bufferpointer based on bufferhandle:
     if (bufferhandle > 0) {
         // Generic buffer:
@@ -3450,29 +3968,8 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
     // Map startIndex to offset in buffer:
     outdata += (size_t) inchannels * (size_t) startIndex;
 
-    // Ok, everything sane, fill the buffer: 'buffersize' iterations into 'outdata':
-    //fprintf(stderr, "buffersize = %i\n", buffersize);
-
-    if (indata || userfloat) {
-        if (indata) {
-            // Copy the data, convert it from double to float:
-            while(buffersize > 0) {
-                *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indata++));
-                buffersize-=sizeof(float);
-            }
-        }
-        else {
-            // Copy the data:
-            while(buffersize > 0) {
-                *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indatafloat++));
-                buffersize-=sizeof(float);
-            }
-        }
-    }
-    else {
-        // Data copy from internal audio buffer (already in float format and premultiplied with anti-clamp gain):
-        memcpy(outdata, indatafloat, buffersize);
-    }
+    // Ok, everything sane, fill the buffer: 'buffersize' bytes into 'outdata', converted to float:
+    PsychPAConvertSamples(outdata, indata, informat, (psych_int64) (buffersize / sizeof(float)), ingain);
 
     // Done.
     return(PsychError_none);
@@ -3553,16 +4050,29 @@ PsychError PSYCHPORTAUDIODeleteBuffer(void)
  */
 PsychError PSYCHPORTAUDIOCreateBuffer(void)
 {
-    static char useString[] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata);";
+    static char useString[] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata [, sampleRate]);";
     static char synopsisString[] =
     "Create a new dynamic audio data playback buffer for a PortAudio audio device and fill it with initial data.\n"
     "Return a 'bufferhandle' to the new buffer. 'pahandle' is the optional handle of the device "
-    "whose buffer is to be filled. 'bufferdata' is a matrix with audio data in double() or single() "
-    "format. Each row of the matrix specifies one sound channel, each column one sample for each channel. Only floating point "
-    "values are supported. Samples need to be in range -1.0 to +1.0, with 0.0 for silence. This is "
+    "whose buffer is to be filled. 'bufferdata' is a matrix with audio data in double(), single() or int16() "
+    "format. Each row of the matrix specifies one sound channel, each column one sample for each channel. Floating point "
+    "samples need to be in range -1.0 to +1.0, with 0.0 for silence, int16 samples cover the full int16 range. This is "
     "intentionally a very restricted interface. For lowest latency and best timing we want you to provide audio "
     "data exactly at the optimal format and sample rate, so the driver can safe computation time and latency for "
     "expensive sample rate conversion, sample format conversion, and bounds checking/clipping.\n\n"
+    "Instead of a matrix, 'bufferdata' can also be the filename of a sound file: Either a WAV file with 32 bit "
+    "floating point or 16 bit integer samples, or a raw file of interleaved 32 bit floating point samples with as "
+    "many channels as the device 'pahandle', which must be provided in that case. Floating point files are memory "
+    "mapped and used as buffer memory directly, without copying, so creating a buffer from even a huge file is fast. "
+    "The operating system loads the sound data on demand, which can cause delays during the first playback, so "
+    "play the buffer once silently, or use 16 bit files, if onset timing of the first playback is critical. "
+    "Mapped samples are used as they are in the file, ie. without the slight attenuation applied to matrices to "
+    "avoid clipping of +1.0 samples, so keep them in range -1.0 to just below +1.0. 'RefillBuffer' on such a buffer "
+    "changes the buffer, but not the file.\n\n"
+    "'sampleRate' optional: Sample rate of the sound data in Hz, if it differs from the sample rate of the device "
+    "'pahandle', which must be provided in that case. Such sound data is converted to the sample rate of the device, "
+    "see 'FillBuffer' for details. WAV files default to their own sample rate, so given a 'pahandle', WAV files at "
+    "other sample rates get converted automatically. Converted sound files are no longer memory mapped.\n\n"
     "You can refill the buffer anytime via the PsychPortAudio('RefillBuffer') call.\n"
     "You can delete the buffer via the PsychPortAudio('DeleteBuffer') call, once it is not used anymore. \n"
     "You can attach the buffer to an audio playback schedule for actual audio playback via the "
@@ -3573,38 +4083,65 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
     static char seeAlsoString[] = "Open FillBuffer GetStatus ";
 
     PsychPABuffer* buffer;
+    PsychPASoundFile soundfile;
     psych_int64 inchannels, insamples, p;
-    size_t buffersize, outbuffersize;
-    double*    indata = NULL;
-    float* indatafloat = NULL;
-    float*  outdata = NULL;
+    const void* indata = NULL;
+    int informat;
+    float ingain;
+    char* filename = NULL;
+    const char* errmsg;
     int pahandle   = -1;
     int bufferhandle = 0;
+    double inRate = 0;
+    psych_bool rateProvided;
+    PsychPAResampler* resampler;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
     if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
 
-    PsychErrorExit(PsychCapNumInputArgs(2));     // The maximum number of inputs
+    PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
     PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs
     PsychErrorExit(PsychCapNumOutputArgs(1));     // The maximum number of outputs
 
     // Make sure PortAudio is online:
     PsychPortAudioInitialize();
 
-    // Get data matrix with initial buffer content:
-    if (!PsychAllocInDoubleMatArg64(2, kPsychArgAnything, &inchannels, &insamples, &p, &indata)) {
-        // Or regular float matrix instead:
-        PsychAllocInFloatMatArg64(2, kPsychArgRequired, &inchannels, &insamples, &p, &indatafloat);
-    }
-
-    // If the optional pahandle is provided...
+    // Get optional pahandle for validation of the buffer against the requirements of that audiodevice:
     if (PsychCopyInIntegerArg(1, kPsychArgOptional, &pahandle)) {
-        // ...then we use it to validate the configuration of the datamatrix for the new
-        // buffer against the requirements of that audiodevice pahandle:
         if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
         if ((audiodevices[pahandle].opmode & kPortAudioPlayBack) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio playback, so this call doesn't make sense.");
+    }
+
+    // Get optional sample rate of the sound data. Conversion needs the device to know the target rate:
+    if ((rateProvided = PsychCopyInDoubleArg(3, kPsychArgOptional, &inRate))) {
+        if (pahandle < 0) PsychErrorExitMsg(PsychError_user, "Conversion of sound data at given 'sampleRate' requires the 'pahandle' of the target audio device.");
+        if (inRate <= 0) PsychErrorExitMsg(PsychError_user, "Invalid 'sampleRate' provided. Must be greater than zero.");
+    }
+
+    // Get initial buffer content: Filename of a sound file, or data matrix:
+    if ((PsychGetArgType(2) == PsychArgType_char) && PsychAllocInCharArg(2, kPsychArgRequired, &filename)) {
+        if ((errmsg = PsychPAMapSoundFile(filename, (pahandle >= 0) ? audiodevices[pahandle].outchannels : 0, &soundfile)) != NULL) {
+            if (verbosity > 0) printf("PsychPortAudio-ERROR: Failed to use sound file '%s' for 'CreateBuffer': %s\n", filename, errmsg);
+            PsychErrorExitMsg(PsychError_user, "Could not create audio buffer from given sound file.");
+        }
 
+        inchannels = soundfile.channels;
+        insamples = soundfile.frames;
+        p = 1;
+        indata = soundfile.samples;
+        informat = soundfile.format;
+        ingain = (informat == kPsychPASampleInt16) ? (float) (1.0 / 32768.0) : 1.0f;
+        if (!rateProvided) inRate = soundfile.sampleRate;
+
+        // Release mapping before erroring out below:
+        if ((pahandle >= 0) && (inchannels != audiodevices[pahandle].outchannels)) PsychPAUnmapSoundFile(soundfile.mapping, soundfile.mappingsize);
+    }
+    else {
+        PsychPAAllocInSampleMatArg(2, &inchannels, &insamples, &p, &indata, &informat, &ingain);
+    }
+
+    if (pahandle >= 0) {
         if (inchannels != audiodevices[pahandle].outchannels) {
             printf("PTB-ERROR: Audio device %i has %i output channels, but provided matrix has non-matching number of %i rows.\n", pahandle, (int) audiodevices[pahandle].outchannels, (int) inchannels);
             PsychErrorExitMsg(PsychError_user, "Number of rows of audio data matrix doesn't match number of output channels of selected audio device.\n");
@@ -3615,29 +4152,41 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
     if (insamples < 1) PsychErrorExitMsg(PsychError_user, "You must provide at least 1 sample for creation of your audio buffer!");
     if (p!=1) PsychErrorExitMsg(PsychError_user, "Audio data matrix must be a 2D matrix, but this one is not a 2D matrix!");
 
-    // Create buffer and assign bufferhandle:
-    bufferhandle = PsychPACreateAudioBuffer(inchannels, insamples);
+    // Convert sound data at another sample rate. A converted sound file is no longer needed:
+    if ((pahandle >= 0) && (inRate > 0) && PsychPANeedsResampling(&audiodevices[pahandle], inRate)) {
+        resampler = PsychPACreateResampler(&audiodevices[pahandle], inRate, (filename) ? &soundfile : NULL);
+        PsychPAResampleSamples(resampler, inchannels, &insamples, &indata, &informat, &ingain);
+        PsychPAResamplerDestroy(resampler);
 
-    // Deref bufferHandle:
-    buffer = PsychPAGetAudioBuffer(bufferhandle);
-    outdata = buffer->outputbuffer;
-    outbuffersize = (size_t) buffer->outputbuffersize;
-    buffersize = sizeof(float) * (size_t) inchannels * (size_t) insamples;
-
-    if (indata) {
-        // Copy the data, convert it from double to float:
-        while(buffersize > 0) {
-            *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indata++));
-            buffersize-=sizeof(float);
-        }
-    } else {
-        // Copy the float data:
-        while(buffersize > 0) {
-            *(outdata++) = (float) (PA_ANTICLAMPGAIN *  *(indatafloat++));
-            buffersize-=sizeof(float);
+        if (filename) {
+            PsychPAUnmapSoundFile(soundfile.mapping, soundfile.mappingsize);
+            filename = NULL;
         }
     }
 
+    if (filename && (informat == kPsychPASampleFloat32) && ((((size_t) indata) % sizeof(float)) == 0)) {
+        // Float sound file, properly aligned: Use the mapped file as buffer memory directly:
+        bufferhandle = PsychPAGetFreeAudioBufferSlot();
+        buffer = &bufferList[bufferhandle];
+        buffer->outchannels = inchannels;
+        buffer->outputbuffersize = inchannels * insamples * sizeof(float);
+        buffer->outputbuffercapacity = 0;
+        buffer->mapping = soundfile.mapping;
+        buffer->mappingsize = soundfile.mappingsize;
+        buffer->outputbuffer = (float*) indata;
+    }
+    else {
+        // Create buffer and assign bufferhandle:
+        bufferhandle = PsychPACreateAudioBuffer(inchannels, insamples);
+
+        // Deref bufferHandle and copy the data, convert it to float:
+        buffer = PsychPAGetAudioBuffer(bufferhandle);
+        PsychPAConvertSamples(buffer->outputbuffer, indata, informat, inchannels * insamples, ingain);
+
+        // Converted sound file no longer needed:
+        if (filename) PsychPAUnmapSoundFile(soundfile.mapping, soundfile.mappingsize);
+    }
+
     // Return bufferhandle:
     PsychCopyOutDoubleArg(1, FALSE, (double) bufferhandle);
 
@@ -3708,6 +4257,7 @@ PsychError PSYCHPORTAUDIOGetAudioData(void)
     double allocsize;
     double minSecs, maxSecs, minSamples;
     int overrun = 0;
+    PsychPAStatusSnapshot snapshot;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -3749,6 +4299,9 @@ PsychError PSYCHPORTAUDIOGetAudioData(void)
             // Test 2: Pending samples to read from current ringbuffer? Engine is idle, so we can safely access device data lock-free...
             if (audiodevices[pahandle].readposition < audiodevices[pahandle].recposition) PsychErrorExitMsg(PsychError_user, "Tried to resize internal buffer without emptying it beforehand. You must drain the buffer before resizing it!");
 
+            // Test 3: Buffer in use by disk recording?
+            if (audiodevices[pahandle].recorder) PsychErrorExitMsg(PsychError_user, "Tried to resize internal buffer while recording to a file! You must stop recording via 'RecordToFile' before resizing the buffer!");
+
             // Ok, reallocation allowed, as engine is idle. Delete old buffer:
             audiodevices[pahandle].inputbuffersize = 0;
             free(audiodevices[pahandle].inputbuffer);
@@ -3790,11 +4343,13 @@ PsychError PSYCHPORTAUDIOGetAudioData(void)
     PsychCopyInIntegerArg(5, kPsychArgOptional, &singleType);
     if (singleType < 0 || singleType > 1) PsychErrorExitMsg(PsychError_user, "'singleType' flag must be zero or one!");
 
-    // The engine is potentially running, so we need to mutex-lock our accesses...
-    PsychPALockDeviceMutex(&audiodevices[pahandle]);
+    // The engine is potentially running, so we get the record position from the status snapshot instead
+    // of the live values, without taking the device mutex. The snapshot gets published after the engine
+    // stored the captured sound data, so all data up to its record position is valid:
+    PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
 
     // How much samples are available in ringbuffer to fetch?
-    insamples = (psych_int64) (audiodevices[pahandle].recposition - audiodevices[pahandle].readposition);
+    insamples = (psych_int64) (snapshot.recposition - audiodevices[pahandle].readposition);
 
     // Convert amount of available data into seconds and check if our minimum
     // requirements are fulfilled:
@@ -3804,44 +4359,39 @@ PsychError PSYCHPORTAUDIOGetAudioData(void)
 
         // Bigger than buffersize? That would be a no no...
         if (((psych_int64) (minSamples * sizeof(float))) > audiodevices[pahandle].inputbuffersize) {
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
             PsychErrorExitMsg(PsychError_user, "Invalid 'minimumAmountToReturnSecs' parameter: The requested minimum is bigger than the whole capture buffer size!'");
         }
 
         // Loop until either request is fullfillable or the device gets stopped - in which
         // case we'll never be able to fullfill the request...
-        while (((double) insamples < minSamples) && (audiodevices[pahandle].state > 0)) {
+        while (((double) insamples < minSamples) && (snapshot.state > 0)) {
             // Compute amount of time to elapse before request could be fullfilled:
             minSecs = (minSamples - (double) insamples) / ((double) audiodevices[pahandle].inchannels) / ((double) audiodevices[pahandle].streaminfo->sampleRate);
-            // Ok, required data will be available earliest in 'minSecs' seconds. Sleep until then with lock dropped:
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+            // Ok, required data will be available earliest in 'minSecs' seconds. Sleep until then:
             PsychWaitIntervalSeconds(minSecs);
-            PsychPALockDeviceMutex(&audiodevices[pahandle]);
 
             // We've slept at least the estimated amount of required time. Recalculate amount
             // of available sound data and check again...
-            insamples = (psych_int64) (audiodevices[pahandle].recposition - audiodevices[pahandle].readposition);
+            PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
+            insamples = (psych_int64) (snapshot.recposition - audiodevices[pahandle].readposition);
         }
     }
 
-    // Lock held here...
-
     // Never ever fetch the samples for the last sampleframe. We do not want to fetch
     // a possibly not yet updated or incomplete sample frame. Leave this to next call
     // of this function. Well, unless state is zero == engine stopped. In that case we
     // know that the playhead won't move anymore and we can safely fetch all remaining
     // data.
-    if (audiodevices[pahandle].state > 0) {
+    if (snapshot.state > 0) {
         insamples = insamples - (insamples % audiodevices[pahandle].inchannels);
         insamples-= audiodevices[pahandle].inchannels;
     }
 
-    // Can unlock here: The remainder of the routine doesn't touch any critical device variables anymore,
+    // The remainder of the routine doesn't touch any critical device variables anymore,
     // only variables that aren't modified by the engine, or not used/touched by engine.
     // Well, theoretically the engine could overwrite the portion of the buffer we're going to
     // read out if we stall massively and the capturebuffer is way too "undersized", but in that
     // case the user code is screwed anyway and it (or the system) needs to be fixed...
-    PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 
     insamples = (insamples < 0) ? 0 : insamples;
     buffersize = (size_t) insamples * sizeof(float);
@@ -4007,11 +4557,14 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
     }
 
     // Audio engine running? That is the minimum requirement for this function to work:
-    if (!Pa_IsStreamActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Audio device not started. You need to call the 'Start' function first!");
+    if (!PsychPAStreamIsActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Audio device not started. You need to call the 'Start' function first!");
 
     // Lock the device:
     PsychPALockDeviceMutex(&audiodevices[pahandle]);
 
+    // Apply still queued commands first, so they can't override the settings below:
+    PsychPAExecuteCommands(&audiodevices[pahandle]);
+
     // Whatever the current scheduled starttime is, override it to be infinity:
     audiodevices[pahandle].reqStartTime = DBL_MAX;
 
@@ -4052,8 +4605,13 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
     audiodevices[pahandle].currentTime = 0;
     audiodevices[pahandle].schedule_pos = 0;
 
-    // Reset recorded samples counter:
+    // Reset recorded samples counter, start new capture session. The disk recorder writes out the rest
+    // of the previous session up to its final position, until the new session overwrites it:
+    audiodevices[pahandle].prevSessionRecposition = audiodevices[pahandle].recposition;
     audiodevices[pahandle].recposition = 0;
+    audiodevices[pahandle].captureLimit = 0;
+    PsychMemoryBarrier();
+    audiodevices[pahandle].captureSession++;
 
     // Reset read samples counter: This will discard possibly not yet fetched data.
     audiodevices[pahandle].readposition = 0;
@@ -4072,9 +4630,17 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
         audiodevices[pahandle].state = 1;
     }
 
+    // Write out the rest of the previous capture session to disk, without holding the device lock, so
+    // the audio thread never waits for file i/o. This happens before the new session can capture much:
+    if (audiodevices[pahandle].recorder) {
+        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        PsychPARecorderSync(audiodevices[pahandle].recorder);
+        PsychPALockDeviceMutex(&audiodevices[pahandle]);
+    }
+
     // Safety check for deadlock avoidance with waiting slaves:
     if ((waitForStart > 0) && (audiodevices[pahandle].opmode & kPortAudioIsSlave) &&
-        (!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream) ||
+        (!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream) ||
         audiodevices[audiodevices[pahandle].pamaster].state < 1)) {
         // We are a slave that shall wait for start, but the master audio device hasn't even
         // started its engine. This looks like a deadlock to avoid:
@@ -4088,7 +4654,7 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
         // Wait for real start of device: We enter the first while() loop iteration with
         // the device lock still held from above, so the while() loop will iterate at
         // least once...
-        while (audiodevices[pahandle].state == 1 && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+        while (audiodevices[pahandle].state == 1 && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
             // Wait for a state-change before reevaluating the .state:
             PsychPAWaitForChange(&audiodevices[pahandle]);
         }
@@ -4101,8 +4667,8 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
 
         // Ok, relevant audio buffer with real sound onset submitted to engine.
         // We now have an estimate of real sound onset in startTime, wait until
-        // then:
-        PsychWaitUntilSeconds(audiodevices[pahandle].startTime);
+        // then. Offline devices run on their own virtual clock, so there is nothing to wait for:
+        if (audiodevices[pahandle].hostAPI != kPsychPAOfflineHostAPI) PsychWaitUntilSeconds(audiodevices[pahandle].startTime);
 
         // Engine should run now. Return real onset time:
         PsychCopyOutDoubleArg(1, kPsychArgOptional, audiodevices[pahandle].startTime);
@@ -4204,20 +4770,23 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
     // Make sure current state is zero, aka fully stopped and engine is really stopped: Output a warning if this looks like an
     // unintended "too early" restart: [No need to mutex-lock here, as iff these .state setting is not met,
     // then we are good and they can't change by themselves behind our back -- paCallback() can't change .state to > 0]
-    if ((audiodevices[pahandle].state > 0) && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+    if ((audiodevices[pahandle].state > 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
         if (verbosity > 1) {
             printf("PsychPortAudio-WARNING: 'Start' method on audiodevice %i called, although playback on device not yet completely stopped.\nWill forcefully restart with possible audible artifacts or timing glitches.\nCheck your playback timing or use the 'Stop' function properly!\n", pahandle);
         }
     }
 
     // Safeguard: If the stream is not stopped in runMode 0, do it now:
-    if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) {
-        if (audiodevices[pahandle].runMode == 0) Pa_StopStream(audiodevices[pahandle].stream);
+    if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) {
+        if (audiodevices[pahandle].runMode == 0) PsychPAStreamStop(audiodevices[pahandle].stream);
     }
 
     // Mutex-lock here: Needed if engine already/still running in runMode1, doesn't hurt if engine is stopped
     PsychPALockDeviceMutex(&audiodevices[pahandle]);
 
+    // Apply still queued commands first, so they can't override the settings below:
+    PsychPAExecuteCommands(&audiodevices[pahandle]);
+
     // Reset statistics values:
     audiodevices[pahandle].batchsize = 0;
     audiodevices[pahandle].xruns = 0;
@@ -4230,8 +4799,13 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
     audiodevices[pahandle].currentTime = 0;
     if (!resume) audiodevices[pahandle].schedule_pos = 0;
 
-    // Reset recorded samples counter:
+    // Reset recorded samples counter, start new capture session. The disk recorder writes out the rest
+    // of the previous session up to its final position, until the new session overwrites it:
+    audiodevices[pahandle].prevSessionRecposition = audiodevices[pahandle].recposition;
     audiodevices[pahandle].recposition = 0;
+    audiodevices[pahandle].captureLimit = 0;
+    PsychMemoryBarrier();
+    audiodevices[pahandle].captureSession++;
 
     // Reset read samples counter: This will discard possibly not yet fetched data.
     audiodevices[pahandle].readposition = 0;
@@ -4256,7 +4830,7 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 
     if (!(audiodevices[pahandle].opmode & kPortAudioIsSlave)) {
         // Engine running?
-        if (!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream)) {
+        if (!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream)) {
             // Try to start stream if the engine isn't running, either because it is the very
             // first call to 'Start' in any runMode, or because the engine got stopped in
             // preparation for a restart in runMode zero. Need to drop the lock during
@@ -4264,10 +4838,10 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
             PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 
             // Safeguard: If the stream is not stopped, do it now:
-            if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+            if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 
             // Start engine:
-            if ((err=Pa_StartStream(audiodevices[pahandle].stream))!=paNoError) {
+            if ((err=PsychPAStreamStart(audiodevices[pahandle].stream))!=paNoError) {
                 printf("PTB-ERROR: Failed to start audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
                 PsychErrorExitMsg(PsychError_system, "Failed to start PortAudio audio device.");
             }
@@ -4279,9 +4853,17 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
     // From here on, the engine is running, and we have the mutex-lock. Unless we're a slave,
     // then we have the lock but the engine may not be running yet.
 
+    // Write out the rest of the previous capture session to disk, without holding the device lock, so
+    // the audio thread never waits for file i/o. This happens before the new session can capture much:
+    if (audiodevices[pahandle].recorder) {
+        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        PsychPARecorderSync(audiodevices[pahandle].recorder);
+        PsychPALockDeviceMutex(&audiodevices[pahandle]);
+    }
+
     // Safety check for deadlock avoidance with waiting slaves:
     if ((waitForStart > 0) && (audiodevices[pahandle].opmode & kPortAudioIsSlave) &&
-        (!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream) ||
+        (!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream) ||
         audiodevices[audiodevices[pahandle].pamaster].state < 1)) {
         // We are a slave that shall wait for start, but the master audio device hasn't even
         // started its engine. This looks like a deadlock to avoid:
@@ -4297,7 +4879,7 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
         // We need to enter the first while() loop iteration with
         // the device lock held from above, so the while() loop will iterate at
         // least once...
-        while (audiodevices[pahandle].state == 1 && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+        while (audiodevices[pahandle].state == 1 && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
             // Wait for a state-change before reevaluating the .state:
             PsychPAWaitForChange(&audiodevices[pahandle]);
         }
@@ -4310,8 +4892,8 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 
         // Ok, relevant audio buffer with real sound onset submit to engine.
         // We now have an estimate of real sound onset in startTime, wait until
-        // then:
-        PsychWaitUntilSeconds(audiodevices[pahandle].startTime);
+        // then. Offline devices run on their own virtual clock, so there is nothing to wait for:
+        if (audiodevices[pahandle].hostAPI != kPsychPAOfflineHostAPI) PsychWaitUntilSeconds(audiodevices[pahandle].startTime);
 
         // Engine should run now. Return real onset time:
         PsychCopyOutDoubleArg(1, kPsychArgOptional, audiodevices[pahandle].startTime);
@@ -4381,6 +4963,7 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
     int blockUntilStopped = 1;
     double stopTime = -1;
     double repetitions = -1;
+    PsychPAStatusSnapshot snapshot;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -4419,19 +5002,26 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
         stopTime = -1;
     }
 
-    // Lock device:
-    PsychPALockDeviceMutex(&audiodevices[pahandle]);
+    // All parameter changes and stop requests get queued for the audio processing thread, so we
+    // never block it by holding the device mutex while it is running:
 
     // New repetitions provided?
     if (repetitions >=0) {
         // Set number of requested repetitions: 0 means loop forever, default is 1 time.
-        audiodevices[pahandle].repeatCount = (repetitions == 0) ? -1 : repetitions;
+        repetitions = (repetitions == 0) ? -1 : repetitions;
+        PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdRepetitions, 0, repetitions, 0, 0);
+    }
+    else {
+        repetitions = audiodevices[pahandle].repeatCount;
     }
 
     // New stopTime provided?
     if (stopTime > 0) {
         // Yes. Quickly assign it:
-        audiodevices[pahandle].reqStopTime = stopTime;
+        PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdStopTime, 0, stopTime, 0, 0);
+    }
+    else {
+        stopTime = audiodevices[pahandle].reqStopTime;
     }
 
     // Wait for automatic stop of playback if requested: This only makes sense if we
@@ -4440,39 +5030,32 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
     // allowed if we have infinite repetitions set, but a finite stopTime is defined, so
     // the engine will eventually stop by itself. Same goes for an operative schedule which
     // will run empty if not regularly updated:
-    if ((waitforend == 1) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0) &&
-        (audiodevices[pahandle].opmode & kPortAudioPlayBack) && ((audiodevices[pahandle].repeatCount != -1) || (audiodevices[pahandle].schedule) || (audiodevices[pahandle].reqStopTime < DBL_MAX))) {
-        while ( ((audiodevices[pahandle].runMode == 0) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
-            ((audiodevices[pahandle].runMode == 1) && (audiodevices[pahandle].state > 0))) {
+    PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
+    if ((waitforend == 1) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (snapshot.state > 0) &&
+        (audiodevices[pahandle].opmode & kPortAudioPlayBack) && ((repetitions != -1) || (audiodevices[pahandle].schedule) || (stopTime < DBL_MAX))) {
+        while ( ((audiodevices[pahandle].runMode == 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (snapshot.state > 0)) ||
+            ((audiodevices[pahandle].runMode == 1) && (snapshot.state > 0))) {
 
-            // Wait for a state-change before reevaluating:
-            PsychPAWaitForChange(&audiodevices[pahandle]);
+            // Poll the published state, instead of waiting for a state-change with the device mutex held:
+            PsychYieldIntervalSeconds(yieldInterval);
+            PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
         }
     }
 
-        // Lock held here in any case...
-
     if (waitforend == 3) {
         // No immediate stop request: This was only either a query for end of playback,
         // or a call to simply set new 'stopTime' or 'repetitions' parameters on the fly.
-        // Unlock the device and skip stop requests...
-        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        // Skip stop requests...
     }
     else {
         // Some real immediate stop request wanted:
         // Soft stop requested (as opposed to fast stop)?
         if (waitforend!=2) {
-            // Softstop: Try to stop stream:
-            if (audiodevices[pahandle].state > 0) {
-                // Stream running. Request a stop of stream, to be honored by playback thread:
-                audiodevices[pahandle].reqstate = 0;
-            }
-
-            // Drop lock, so request can get through...
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+            // Softstop: Try to stop stream. Request a stop of stream, to be honored by playback thread if it is running:
+            PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdStop, 0, 0, 0, 0);
 
             // If blockUntilStopped is non-zero, then explicitely stop as well:
-            if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) && (err=Pa_StopStream(audiodevices[pahandle].stream))!=paNoError) {
+            if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) && (err=PsychPAStreamStop(audiodevices[pahandle].stream))!=paNoError) {
                 printf("PTB-ERROR: Failed to stop audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
                 PsychErrorExitMsg(PsychError_system, "Failed to stop PortAudio audio device.");
             }
@@ -4480,54 +5063,50 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
         else {
             // Faststop: Try to abort stream. Skip if already stopped/not yet started:
 
-            // Stream active?
-            if (audiodevices[pahandle].state > 0) {
-                // Yes. Set the 'state' flag to signal our IO-Thread not to push any audio
-                // data anymore, but only zeros for silence and to paAbort asap:
-                audiodevices[pahandle].reqstate = 3;
-            }
-
-            // Drop lock, so request can get through...
-            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+            // If the stream is active, set the 'state' flag to signal our IO-Thread not to push
+            // any audio data anymore, but only zeros for silence and to paAbort asap:
+            PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdStop, 0, 3, 0, 0);
 
             // If blockUntilStopped is non-zero, then send abort request to hardware:
-            if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) && ((err=Pa_AbortStream(audiodevices[pahandle].stream))!=paNoError)) {
+            if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) && ((err=PsychPAStreamAbort(audiodevices[pahandle].stream))!=paNoError)) {
                 printf("PTB-ERROR: Failed to abort audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
                 PsychErrorExitMsg(PsychError_system, "Failed to fast stop (abort) PortAudio audio device.");
             }
         }
     }
 
-    // No lock held here...
-
     // Wait for real stop:
     if (blockUntilStopped > 0) {
-        // Lock device:
-        PsychPALockDeviceMutex(&audiodevices[pahandle]);
-
-        // Wait for stop / idle:
-        if (Pa_IsStreamActive(audiodevices[pahandle].stream)) {
-            while ( ((audiodevices[pahandle].runMode == 0) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
-                ((audiodevices[pahandle].runMode == 1) && (audiodevices[pahandle].state > 0))) {
-
-                // Wait for a state-change before reevaluating:
-                PsychPAWaitForChange(&audiodevices[pahandle]);
+        // Wait for stop / idle, by polling the published state:
+        if (PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
+            PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
+            while ( ((audiodevices[pahandle].runMode == 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (snapshot.state > 0)) ||
+                ((audiodevices[pahandle].runMode == 1) && (snapshot.state > 0))) {
+
+                PsychYieldIntervalSeconds(yieldInterval);
+                PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
             }
         }
 
-        // We are stopped/idle, with lock held:
+        // We are stopped/idle:
 
         // Need to update stream state and reqstate manually here, as the Pa_Stop/AbortStream()
         // requests may have stopped the paCallback() thread before it could update/honor state/reqstate by himself.
+        // Only then the stream is inactive and the device mutex uncontended. An idle, but running engine did this already:
+        if (PsychPAStreamIsActive(audiodevices[pahandle].stream) != 1) {
+            PsychPALockDeviceMutex(&audiodevices[pahandle]);
 
-        // Mark state as stopped:
-        audiodevices[pahandle].state = 0;
+            // Apply still queued commands, so a pending stop request can't hit a later restart:
+            PsychPAExecuteCommands(&audiodevices[pahandle]);
 
-        // Reset request to none:
-        audiodevices[pahandle].reqstate = 255;
+            // Mark state as stopped:
+            audiodevices[pahandle].state = 0;
 
-        // Can unlock here, as the fields we're interested in will remain static with an idle/stopped engine:
-        PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+            // Reset request to none:
+            audiodevices[pahandle].reqstate = 255;
+
+            PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+        }
 
         // Copy out our estimate of when playback really started for the just stopped stream:
         PsychCopyOutDoubleArg(1, kPsychArgOptional, audiodevices[pahandle].startTime);
@@ -4615,16 +5194,21 @@ PsychError PSYCHPORTAUDIOGetStatus(void)
     "InDeviceIndex: Is the deviceindex of the capture device, or -1 if not opened for capture.\n"
     "RecordedSecs: Is the total amount of recorded sound data (in seconds) since start of capture.\n"
     "ReadSecs: Is the total amount of sound data (in seconds) that has been fetched from the internal buffer. "
-    "The difference between RecordedSecs and ReadSecs is the amount of recorded sound data pending for retrieval. ";
+    "The difference between RecordedSecs and ReadSecs is the amount of recorded sound data pending for retrieval. \n"
+    "FileRecordedSecs: Is the total amount of sound data (in seconds) written to the file of a recording started "
+    "via PsychPortAudio('RecordToFile'), including silence inserted for lost sound data.\n"
+    "FileOverflows: Is the number of gaps in that recording, because the internal buffer overflowed before its "
+    "content could be written to the file.\n"
+    "FileLostSecs: Is the total amount of sound data (in seconds) lost in these gaps. ";
 
     static char seeAlsoString[] = "Open GetDeviceSettings ";
     PsychGenericScriptType     *status;
-    double currentTime;
-    psych_int64 playposition, totalplaycount, recposition;
+    PsychPAStatusSnapshot snapshot;
 
     const char *FieldNames[]={    "Active", "State", "RequestedStartTime", "StartTime", "CaptureStartTime", "RequestedStopTime", "EstimatedStopTime", "CurrentStreamTime", "ElapsedOutSamples", "PositionSecs", "RecordedSecs", "ReadSecs", "SchedulePosition",
         "XRuns", "TotalCalls", "TimeFailed", "BufferSize", "CPULoad", "PredictedLatency", "LatencyBias", "SampleRate",
-        "OutDeviceIndex", "InDeviceIndex" };
+        "OutDeviceIndex", "InDeviceIndex", "FileRecordedSecs", "FileOverflows", "FileLostSecs" };
+    PsychPARecorderStats recorderStats;
     int pahandle = -1;
 
     // Setup online help:
@@ -4641,45 +5225,42 @@ PsychError PSYCHPORTAUDIOGetStatus(void)
     PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
     if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
 
-    PsychAllocOutStructArray(1, kPsychArgOptional, 1, 23, FieldNames, &status);
+    PsychAllocOutStructArray(1, kPsychArgOptional, 1, 26, FieldNames, &status);
 
-    // Ok, in a perfect world we should hold the device mutex while querying all the device state.
-    // However, we don't: This reduces lock contention at the price of a small chance that the
-    // fetched information is not 100% up to date / that this is not an atomic snapshot of state.
-    //
-    // Instead we only hold the lock to get the most crucial values atomically, then release and get the rest
-    // while not holding the lock:
-    PsychPALockDeviceMutex(&audiodevices[pahandle]);
-    currentTime = audiodevices[pahandle].currentTime;
-    totalplaycount = audiodevices[pahandle].totalplaycount;
-    playposition = audiodevices[pahandle].playposition;
-    recposition = audiodevices[pahandle].recposition;
-    PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+    // Fetch a consistent snapshot of the runtime state, as published by the audio processing thread
+    // at the end of its last callback. This doesn't need the device mutex, so polling the status can
+    // neither stall the audio thread, nor get stalled by it:
+    PsychPAGetStatusSnapshot(&audiodevices[pahandle], &snapshot);
 
-    // Atomic snapshot for remaining fields would only be needed for low-level debugging, so who cares?
     PsychSetStructArrayDoubleElement("Active", 0, (audiodevices[pahandle].state >= 2) ? 1 : 0, status);
     PsychSetStructArrayDoubleElement("State", 0, audiodevices[pahandle].state, status);
     PsychSetStructArrayDoubleElement("RequestedStartTime", 0, audiodevices[pahandle].reqStartTime, status);
-    PsychSetStructArrayDoubleElement("StartTime", 0, audiodevices[pahandle].startTime, status);
-    PsychSetStructArrayDoubleElement("CaptureStartTime", 0, audiodevices[pahandle].captureStartTime, status);
+    PsychSetStructArrayDoubleElement("StartTime", 0, snapshot.startTime, status);
+    PsychSetStructArrayDoubleElement("CaptureStartTime", 0, snapshot.captureStartTime, status);
     PsychSetStructArrayDoubleElement("RequestedStopTime", 0, audiodevices[pahandle].reqStopTime, status);
-    PsychSetStructArrayDoubleElement("EstimatedStopTime", 0, audiodevices[pahandle].estStopTime, status);
-    PsychSetStructArrayDoubleElement("CurrentStreamTime", 0, currentTime, status);
-    PsychSetStructArrayDoubleElement("ElapsedOutSamples", 0, ((double)(totalplaycount / audiodevices[pahandle].outchannels)), status);
-    PsychSetStructArrayDoubleElement("PositionSecs", 0, ((double)(playposition / audiodevices[pahandle].outchannels)) / (double) audiodevices[pahandle].streaminfo->sampleRate, status);
-    PsychSetStructArrayDoubleElement("RecordedSecs", 0, ((double)(recposition / audiodevices[pahandle].inchannels)) / (double) audiodevices[pahandle].streaminfo->sampleRate, status);
+    PsychSetStructArrayDoubleElement("EstimatedStopTime", 0, snapshot.estStopTime, status);
+    PsychSetStructArrayDoubleElement("CurrentStreamTime", 0, snapshot.currentTime, status);
+    PsychSetStructArrayDoubleElement("ElapsedOutSamples", 0, ((double)(snapshot.totalplaycount / audiodevices[pahandle].outchannels)), status);
+    PsychSetStructArrayDoubleElement("PositionSecs", 0, ((double)(snapshot.playposition / audiodevices[pahandle].outchannels)) / (double) audiodevices[pahandle].streaminfo->sampleRate, status);
+    PsychSetStructArrayDoubleElement("RecordedSecs", 0, ((double)(snapshot.recposition / audiodevices[pahandle].inchannels)) / (double) audiodevices[pahandle].streaminfo->sampleRate, status);
     PsychSetStructArrayDoubleElement("ReadSecs", 0, ((double)(audiodevices[pahandle].readposition / audiodevices[pahandle].inchannels)) / (double) audiodevices[pahandle].streaminfo->sampleRate, status);
-    PsychSetStructArrayDoubleElement("SchedulePosition", 0, audiodevices[pahandle].schedule_pos, status);
-    PsychSetStructArrayDoubleElement("XRuns", 0, audiodevices[pahandle].xruns, status);
-    PsychSetStructArrayDoubleElement("TotalCalls", 0, audiodevices[pahandle].paCalls, status);
-    PsychSetStructArrayDoubleElement("TimeFailed", 0, audiodevices[pahandle].noTime, status);
-    PsychSetStructArrayDoubleElement("BufferSize", 0, (double) audiodevices[pahandle].batchsize, status);
-    PsychSetStructArrayDoubleElement("CPULoad", 0, (Pa_IsStreamActive(audiodevices[pahandle].stream)) ? Pa_GetStreamCpuLoad(audiodevices[pahandle].stream) : 0.0, status);
-    PsychSetStructArrayDoubleElement("PredictedLatency", 0, audiodevices[pahandle].predictedLatency, status);
+    PsychSetStructArrayDoubleElement("SchedulePosition", 0, snapshot.schedule_pos, status);
+    PsychSetStructArrayDoubleElement("XRuns", 0, snapshot.xruns, status);
+    PsychSetStructArrayDoubleElement("TotalCalls", 0, snapshot.paCalls, status);
+    PsychSetStructArrayDoubleElement("TimeFailed", 0, snapshot.noTime, status);
+    PsychSetStructArrayDoubleElement("BufferSize", 0, (double) snapshot.batchsize, status);
+    PsychSetStructArrayDoubleElement("CPULoad", 0, (PsychPAStreamIsActive(audiodevices[pahandle].stream)) ? PsychPAStreamGetCpuLoad(audiodevices[pahandle].stream) : 0.0, status);
+    PsychSetStructArrayDoubleElement("PredictedLatency", 0, snapshot.predictedLatency, status);
     PsychSetStructArrayDoubleElement("LatencyBias", 0, audiodevices[pahandle].latencyBias, status);
     PsychSetStructArrayDoubleElement("SampleRate", 0, audiodevices[pahandle].streaminfo->sampleRate, status);
     PsychSetStructArrayDoubleElement("OutDeviceIndex", 0, audiodevices[pahandle].outdeviceidx, status);
     PsychSetStructArrayDoubleElement("InDeviceIndex", 0, audiodevices[pahandle].indeviceidx, status);
+
+    memset(&recorderStats, 0, sizeof(recorderStats));
+    if (audiodevices[pahandle].recorder) PsychPARecorderGetStats(audiodevices[pahandle].recorder, &recorderStats);
+    PsychSetStructArrayDoubleElement("FileRecordedSecs", 0, (double) recorderStats.framesWritten / audiodevices[pahandle].streaminfo->sampleRate, status);
+    PsychSetStructArrayDoubleElement("FileOverflows", 0, (double) recorderStats.overflows, status);
+    PsychSetStructArrayDoubleElement("FileLostSecs", 0, (double) recorderStats.framesLost / audiodevices[pahandle].streaminfo->sampleRate, status);
     return(PsychError_none);
 }
 
@@ -4787,7 +5368,7 @@ PsychError PSYCHPORTAUDIOLatencyBias(void)
     // Set new bias, if one was provided:
     if (bias!=DBL_MAX) {
         if (audiodevices[pahandle].opmode & kPortAudioIsSlave) PsychErrorExitMsg(PsychError_user, "Change of latency bias is not allowed on slave devices! Set it on associated master device.");
-        if (Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change 'biasSecs' while device is active! Forbidden!");
+        if (PsychPAStreamIsActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change 'biasSecs' while device is active! Forbidden!");
         audiodevices[pahandle].latencyBias = bias;
     }
 
@@ -4864,11 +5445,14 @@ PsychError PSYCHPORTAUDIOVolume(void)
     if ((audiodevices[pahandle].opmode & kPortAudioPlayBack) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio playback, so this call doesn't make sense.");
 
     // Return old masterVolume:
-    PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) audiodevices[pahandle].masterVolume);
+    PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) audiodevices[pahandle].reqMasterVolume);
 
-    // Copy in optional new masterVolume: We can assign this without locking, as a single scalar
-    // 32-bit float assignment is basically atomic:
-    if (PsychCopyInDoubleArg(2, kPsychArgOptional, &masterVolume)) audiodevices[pahandle].masterVolume = (float) masterVolume;
+    // Copy in optional new masterVolume: The change gets queued for the audio processing thread,
+    // so we never block on the device mutex while the engine is busy mixing:
+    if (PsychCopyInDoubleArg(2, kPsychArgOptional, &masterVolume)) {
+        audiodevices[pahandle].reqMasterVolume = (float) masterVolume;
+        PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdVolume, -1, (double) audiodevices[pahandle].reqMasterVolume, 0, 0);
+    }
 
     // Slaves can have per-channel volumes:
     if (audiodevices[pahandle].opmode & kPortAudioIsSlave) {
@@ -4876,18 +5460,19 @@ PsychError PSYCHPORTAUDIOVolume(void)
 
         // Copy out old settings:
         PsychAllocOutDoubleMatArg(2, kPsychArgOptional, 1, audiodevices[pahandle].outchannels, 1, &channelVolumes);
-        for (i = 0; i < audiodevices[pahandle].outchannels; i++) channelVolumes[i] = (double) audiodevices[pahandle].outChannelVolumes[i];
+        for (i = 0; i < audiodevices[pahandle].outchannels; i++) channelVolumes[i] = (double) audiodevices[pahandle].reqOutChannelVolumes[i];
 
         // Get optional new settings:
         if (PsychAllocInDoubleMatArg(3, kPsychArgOptional, &m, &n, &p, &channelVolumes)) {
             // Valid?
             if (m * n != audiodevices[pahandle].outchannels || p != 1) PsychErrorExitMsg(PsychError_user, "Invalid channelVolumes vector for audio slave device provided. Number of elements doesn't match number of audio output channels!");
 
-            // Assign, but with device mutex of master device held, so we don't update in
-            // the middle of a mix cycle for our slave device:
-            PsychPALockDeviceMutex(&audiodevices[audiodevices[pahandle].pamaster]);
-            for (i = 0; i < audiodevices[pahandle].outchannels; i++) audiodevices[pahandle].outChannelVolumes[i]  = (float) channelVolumes[i];
-            PsychPAUnlockDeviceMutex(&audiodevices[audiodevices[pahandle].pamaster]);
+            // Queue the changes. They get applied at the start of the next mix cycle for our slave
+            // device, so we don't update in the middle of one:
+            for (i = 0; i < audiodevices[pahandle].outchannels; i++) {
+                audiodevices[pahandle].reqOutChannelVolumes[i] = (float) channelVolumes[i];
+                PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdVolume, i, (double) audiodevices[pahandle].reqOutChannelVolumes[i], 0, 0);
+            }
         }
     }
     else {
@@ -5064,7 +5649,7 @@ PsychError PSYCHPORTAUDIORunMode(void)
         if (audiodevices[pahandle].opmode & kPortAudioIsSlave) PsychErrorExitMsg(PsychError_user, "Change of runmode is not allowed on slave devices!");
 
         // Stop engine if it is running:
-        if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+        if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 
         // Reset state:
         audiodevices[pahandle].state = 0;
@@ -5143,11 +5728,8 @@ PsychError PSYCHPORTAUDIOSetLoop(void)
 
     if (endSample < startSample) PsychErrorExitMsg(PsychError_user, "Invalid 'endSample' provided. Must be greater or equal than 'startSample'!");
 
-    // Ok, range is valid. Assign it:
-    PsychPALockDeviceMutex(&audiodevices[pahandle]);
-    audiodevices[pahandle].loopStartFrame = (psych_int64) startSample;
-    audiodevices[pahandle].loopEndFrame = (psych_int64) endSample;
-    PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+    // Ok, range is valid. Assign it, via the command queue, as playback may be running:
+    PsychPAEnqueueCommand(&audiodevices[pahandle], kPsychPACmdLoop, 0, 0, (psych_int64) startSample, (psych_int64) endSample);
 
     return(PsychError_none);
 }
@@ -5156,7 +5738,7 @@ PsychError PSYCHPORTAUDIOSetLoop(void)
  */
 PsychError PSYCHPORTAUDIOEngineTunables(void)
 {
-    static char useString[] = "[oldyieldInterval, oldMutexEnable, lockToCore1, audioserver_autosuspend] = PsychPortAudio('EngineTunables' [, yieldInterval] [, MutexEnable] [, lockToCore1] [, audioserver_autosuspend]);";
+    static char useString[] = "[oldyieldInterval, oldMutexEnable, lockToCore1, audioserver_autosuspend, oldsimdLevel] = PsychPortAudio('EngineTunables' [, yieldInterval] [, MutexEnable] [, lockToCore1] [, audioserver_autosuspend] [, simdLevel]);";
     static char synopsisString[] =
     "Return, and optionally set low-level tuneable driver parameters.\n"
     "The driver must be idle, ie., no audio device must be open, if you want to change tuneables! "
@@ -5185,23 +5767,31 @@ PsychError PSYCHPORTAUDIOEngineTunables(void)
     "can interfere with low level audio device access and low-latency / high-precision audio timing. "
     "For this reason it is a good idea to switch them to standby (suspend) while a PsychPortAudio "
     "session is active. Sometimes this isn't needed or not even desireable. Therefore this option "
-    "allows to inhibit this automatic suspending of audio servers.\n";
+    "allows to inhibit this automatic suspending of audio servers.\n"
+    "'simdLevel' - Select the sample processing kernels used by the mixer of master devices for mixing, "
+    "volume and gain application, channel mapping and amplitude modulation: -1 = Automatically select the "
+    "fastest kernels supported by the cpu. This is the default. 0 = Use plain scalar C code. 1 = Use 128 bit "
+    "SIMD vector instructions, ie. SSE2 on x86 or NEON on ARM. 2 = Use 256 bit AVX2 vector instructions on x86. "
+    "If the requested level is not supported by the cpu, the next lower supported level is used. The level "
+    "actually selected is returned in 'oldsimdLevel' on the next call. This setting can be changed at any time.\n";
 
     static char seeAlsoString[] = "Open ";
 
-    int mutexenable, mylockToCore1, mysuspend;
+    int mutexenable, mylockToCore1, mysuspend, mysimdlevel;
     double myyieldInterval;
 
     // Setup online help:
     PsychPushHelp(useString, synopsisString, seeAlsoString);
     if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
 
-    PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+    PsychErrorExit(PsychCapNumInputArgs(5));     // The maximum number of inputs
     PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs
-    PsychErrorExit(PsychCapNumOutputArgs(4));    // The maximum number of outputs
+    PsychErrorExit(PsychCapNumOutputArgs(5));    // The maximum number of outputs
 
-    // Make sure no settings are changed while an audio device is open:
-    if ((PsychGetNumInputArgs() > 0) && (audiodevicecount > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change low-level engine parameter while at least one audio device is open! Forbidden!");
+    // Make sure no settings are changed while an audio device is open. The kernel selection
+    // is an exception, as switching kernels is safe at any time:
+    if ((PsychIsArgPresent(PsychArgIn, 1) || PsychIsArgPresent(PsychArgIn, 2) || PsychIsArgPresent(PsychArgIn, 3) ||
+         PsychIsArgPresent(PsychArgIn, 4)) && (audiodevicecount > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change low-level engine parameter while at least one audio device is open! Forbidden!");
 
     // Return current/old audioserver_suspend:
     PsychCopyOutDoubleArg(4, kPsychArgOptional, (double) ((pulseaudio_autosuspend) ? 1 : 0));
@@ -5246,6 +5836,16 @@ PsychError PSYCHPORTAUDIOEngineTunables(void)
         if (verbosity > 3) printf("PsychPortAudio: INFO: Locking of all engine threads to cpu core 1 %s.\n", (lockToCore1) ? "enabled" : "disabled");
     }
 
+    // Return current/old simdLevel:
+    PsychCopyOutDoubleArg(5, kPsychArgOptional, (double) PsychPAGetKernelLevel());
+
+    // Get optional new simdLevel:
+    if (PsychCopyInIntegerArg(5, kPsychArgOptional, &mysimdlevel)) {
+        if (mysimdlevel < -1 || mysimdlevel > 2) PsychErrorExitMsg(PsychError_user, "Invalid setting for 'simdLevel' provided. Valid are -1, 0, 1 and 2.");
+        mysimdlevel = PsychPASetKernelLevel(mysimdlevel);
+        if (verbosity > 3) printf("PsychPortAudio: INFO: Mixer sample processing kernels set to level %i.\n", mysimdlevel);
+    }
+
     return(PsychError_none);
 }
 
@@ -5299,7 +5899,7 @@ PsychError PSYCHPORTAUDIOUseSchedule(void)
     // Make sure the device is fully idle: We can check without mutex held, as a device which is
     // already idle (state == 0) can't switch by itself out of idle state (state > 0), neither
     // can an inactive stream start itself.
-    if ((audiodevices[pahandle].state > 0) && Pa_IsStreamActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Tried to enable/disable audio schedule while audio device is active. Forbidden! Call 'Stop' first.");
+    if ((audiodevices[pahandle].state > 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Tried to enable/disable audio schedule while audio device is active. Forbidden! Call 'Stop' first.");
 
     // At this point the deivce is idle and will remain so during this routines execution,
     // so it won't touch any of the schedule related variables and we can manipulate them
@@ -5539,8 +6139,9 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
 
     // All settings validated and ready to initialize a slot in the schedule:
 
-    // Lock device:
-    PsychPALockDeviceMutex(&audiodevices[pahandle]);
+    // No need to lock the device: A slot is only touched by the audio thread while its mode marks it
+    // as pending, and only written by us while it is not pending. So we fill the slot first, then
+    // publish it by setting its mode as the very last step.
 
     // Map writepos to slotindex:
     slotid = audiodevices[pahandle].schedule_writepos % audiodevices[pahandle].schedule_size;
@@ -5549,7 +6150,6 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
     if ((audiodevices[pahandle].schedule[slotid].mode & 2) == 0) {
         // Fill slot:
         slot = (PsychPASchedule*) &(audiodevices[pahandle].schedule[slotid]);
-        slot->mode = 1 | 2 | ((specialFlags & 1) ? 4 : 0);
         slot->bufferhandle   = bufferHandle;
         slot->repetitions    = (commandCode == 0) ? ((repetitions == 0) ? -1 : repetitions) : 0.0;;
         slot->loopStartFrame = (psych_int64) startSample;
@@ -5557,6 +6157,10 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
         slot->command         = commandCode;
         slot->tWhen             = (commandCode > 0) ? repetitions : 0.0;
 
+        // Publish slot to the audio thread:
+        PsychMemoryBarrier();
+        slot->mode = 1 | 2 | ((specialFlags & 1) ? 4 : 0);
+
         // Advance write position for next update iteration:
         audiodevices[pahandle].schedule_writepos++;
 
@@ -5576,9 +6180,6 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
         freeslots = 0;
     }
 
-    // Unlock device:
-    PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
-
     // Return optional result code:
     PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) success);
 
@@ -5638,7 +6239,7 @@ PsychError PSYCHPORTAUDIOSetOpMode(void)
     // Set new opMode, if one was provided:
     if (opMode != -1) {
         // Stop engine if it is running:
-        if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+        if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 
         // Reset state:
         audiodevices[pahandle].state = 0;
@@ -5744,7 +6345,7 @@ PsychError PSYCHPORTAUDIODirectInputMonitoring(void)
     if (PsychCopyInIntegerArg(3, kPsychArgOptional, &inputChannel)) {
         // Find out how many real input channels the device has and check provided index against them:
         padev = Pa_GetDeviceInfo((PaDeviceIndex) audiodevices[pahandle].indeviceidx);
-        if (inputChannel < -1 || inputChannel >= (int) padev->maxInputChannels) PsychErrorExitMsg(PsychError_user, "Invalid inputChannel provided. No such input channel available on device!");
+        if (!padev || inputChannel < -1 || inputChannel >= (int) padev->maxInputChannels) PsychErrorExitMsg(PsychError_user, "Invalid inputChannel provided. No such input channel available on device!");
     }
     else {
         inputChannel = -1;
@@ -5754,7 +6355,7 @@ PsychError PSYCHPORTAUDIODirectInputMonitoring(void)
     if (PsychCopyInIntegerArg(4, kPsychArgOptional, &outputChannel)) {
         // Find out how many real output channels the device has and check provided index against them:
         padev = Pa_GetDeviceInfo((PaDeviceIndex) audiodevices[pahandle].outdeviceidx);
-        if (outputChannel < 0 || outputChannel >= (int) padev->maxOutputChannels) PsychErrorExitMsg(PsychError_user, "Invalid outputChannel provided. No such outputChannel channel available on device!");
+        if (!padev || outputChannel < 0 || outputChannel >= (int) padev->maxOutputChannels) PsychErrorExitMsg(PsychError_user, "Invalid outputChannel provided. No such outputChannel channel available on device!");
     }
     else {
         outputChannel = 0;
@@ -5841,3 +6442,182 @@ PsychError PSYCHPORTAUDIODirectInputMonitoring(void)
 
     return(PsychError_none);
 }
+
+/* PsychPortAudio('OfflineSettings') - Control offline devices and query their statistics.
+ */
+PsychError PSYCHPORTAUDIOOfflineSettings(void)
+{
+    static char useString[] = "[oldSpeed, stats] = PsychPortAudio('OfflineSettings', pahandle [, speed][, outputFilename]);";
+    //                                                                                1            2          3
+    static char synopsisString[] =
+    "Change settings of an offline device 'pahandle' and query its statistics.\n"
+    "Offline devices are opened via PsychPortAudio('Open') with the 'specialFlags' setting 32. They do not use any "
+    "audio hardware. Instead a driver thread calls the audio engine on a virtual clock, which advances by one buffer "
+    "duration per processed buffer. This allows to render audio faster than realtime, to benchmark the audio engine "
+    "and to run audio scripts deterministically on machines without sound hardware.\n"
+    "'speed' Optional new pacing of the virtual clock: A value of 1 (the default) runs in realtime, values greater than "
+    "zero run at that multiple of realtime, a value of 0 runs as fast as possible. Can be changed at any time.\n"
+    "'outputFilename' Optional name of a WAV file to write all rendered output to, as 32 bit floating point samples. "
+    "An existing file of that name will be overwritten. An empty name '' closes the current output file. The output "
+    "file can only be changed while the device is stopped, ie. after 'Stop' in the default runMode 0, otherwise the "
+    "call fails without changing any setting. Closing the device also closes its output file.\n"
+    "Returns the 'oldSpeed' setting before this call, and a struct 'stats' with the following fields:\n"
+    "VirtualTime: Current time of the virtual clock in seconds. It is initialized to the GetSecs time on 'Start', "
+    "unless it is already ahead of GetSecs time from a previous faster than realtime run.\n"
+    "Callbacks: Total number of buffers processed by the engine.\n"
+    "Frames: Total number of sample frames processed.\n"
+    "FramesWritten: Total number of sample frames written to output files.\n"
+    "CallbackSecsTotal: Total time spent in the audio engine in seconds.\n"
+    "CallbackSecsMax: Maximum time spent in the audio engine for a single buffer.\n"
+    "CallbacksPerSec: Average number of buffers processed per second of real time while the device was running.\n"
+    "RealtimeFactor: Average ratio of processed audio duration to real time while the device was running.\n"
+    "DeadlineMisses: Number of buffers which were processed more than one buffer duration too late at a 'speed' "
+    "greater than zero, e.g., because the audio engine was stalled. Each miss is also counted as an underrun in the "
+    "'XRuns' field of PsychPortAudio('GetStatus'), and the virtual clock gets resynchronized to the system clock.\n";
+
+    static char seeAlsoString[] = "Open GetStatus ";
+
+    PsychGenericScriptType *stats;
+    const char *FieldNames[] = { "VirtualTime", "Callbacks", "Frames", "FramesWritten", "CallbackSecsTotal", "CallbackSecsMax", "CallbacksPerSec", "RealtimeFactor", "DeadlineMisses" };
+    PsychPAOfflineStats offlineStats;
+    int pahandle = -1;
+    double speed;
+    char* filename = NULL;
+    const char* errmsg;
+
+    // Setup online help:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
+    PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs
+    PsychErrorExit(PsychCapNumOutputArgs(2));    // The maximum number of outputs
+
+    // Make sure PortAudio is online:
+    PsychPortAudioInitialize();
+
+    PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+    if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+    if (!PsychPAIsOfflineStream(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Audio device is not an offline device. Open it with 'specialFlags' 32 for offline operation.");
+
+    // Reject a new output file upfront, before any other setting gets changed. The engine keeps
+    // running between 'Stop' and 'Start' in runMode 1, so the device must be stopped via runMode 0:
+    if (PsychAllocInCharArg(3, kPsychArgOptional, &filename) && !PsychPAStreamIsStopped(audiodevices[pahandle].stream))
+        PsychErrorExitMsg(PsychError_user, "Tried to change 'outputFilename' while device is running. Stop it first!");
+
+    PsychPAOfflineGetStats(audiodevices[pahandle].stream, &offlineStats);
+
+    // Return old speed:
+    PsychCopyOutDoubleArg(1, kPsychArgOptional, offlineStats.speed);
+
+    // Return stats:
+    PsychAllocOutStructArray(2, kPsychArgOptional, 1, 9, FieldNames, &stats);
+    PsychSetStructArrayDoubleElement("VirtualTime", 0, offlineStats.virtualTime, stats);
+    PsychSetStructArrayDoubleElement("Callbacks", 0, (double) offlineStats.callbacks, stats);
+    PsychSetStructArrayDoubleElement("Frames", 0, (double) offlineStats.frames, stats);
+    PsychSetStructArrayDoubleElement("FramesWritten", 0, (double) offlineStats.framesWritten, stats);
+    PsychSetStructArrayDoubleElement("CallbackSecsTotal", 0, offlineStats.callbackSecsTotal, stats);
+    PsychSetStructArrayDoubleElement("CallbackSecsMax", 0, offlineStats.callbackSecsMax, stats);
+    PsychSetStructArrayDoubleElement("CallbacksPerSec", 0, (offlineStats.wallSecsTotal > 0) ? (double) offlineStats.callbacks / offlineStats.wallSecsTotal : 0.0, stats);
+    PsychSetStructArrayDoubleElement("RealtimeFactor", 0, (offlineStats.wallSecsTotal > 0) ?
+                                     (double) offlineStats.frames / audiodevices[pahandle].streaminfo->sampleRate / offlineStats.wallSecsTotal : 0.0, stats);
+    PsychSetStructArrayDoubleElement("DeadlineMisses", 0, (double) offlineStats.deadlineMisses, stats);
+
+    // Get optional new speed:
+    if (PsychCopyInDoubleArg(2, kPsychArgOptional, &speed)) {
+        if (speed < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'speed' provided. Must be zero for 'as fast as possible' or greater than zero.");
+        PsychPAOfflineSetSpeed(audiodevices[pahandle].stream, speed);
+    }
+
+    // Set optional new output file:
+    if (filename && ((errmsg = PsychPAOfflineSetOutputFile(audiodevices[pahandle].stream, filename)) != NULL)) {
+        printf("PsychPortAudio('OfflineSettings'): Failed to set output file '%s': %s\n", filename, errmsg);
+        PsychErrorExitMsg(PsychError_user, "Could not set output file.");
+    }
+
+    return(PsychError_none);
+}
+
+/* PsychPortAudio('RecordToFile') - Stream captured sound data of a device to a file in the background.
+ */
+PsychError PSYCHPORTAUDIORecordToFile(void)
+{
+    static char useString[] = "PsychPortAudio('RecordToFile', pahandle [, filename][, int16=0][, drainIntervalSecs=0.25]);";
+    //                                                        1           2           3          4
+    static char synopsisString[] =
+    "Start or stop recording of all captured sound data of device 'pahandle' to a file.\n"
+    "A background thread periodically drains the internal capture buffer of the device into the file, so recordings "
+    "of arbitrary length, e.g., multi-hour sessions, only need a capture buffer of a few seconds, and your script "
+    "doesn't need to call PsychPortAudio('GetAudioData') at all. The capture buffer must be allocated via "
+    "PsychPortAudio('GetAudioData', pahandle, amountToAllocateSecs) before the recording is started, and can't "
+    "be resized while recording. A buffer of at least 10 times 'drainIntervalSecs' is recommended. Recording to "
+    "a file doesn't interfere with 'GetAudioData', so you can still fetch captured sound data for online analysis.\n"
+    "'filename' is the name of the file to write. An existing file of that name will be overwritten. If the name "
+    "ends with .wav, a WAV file is written, which is turned into a RF64 file if it grows beyond 4 GB. Otherwise a "
+    "raw file of interleaved 32 bit floating point samples is written. If 'filename' is omitted or empty, the "
+    "current recording is stopped after writing all remaining sound data, and the file is closed. Closing the "
+    "device also stops its recording.\n"
+    "'int16' if set to 1 writes 16 bit integer samples to WAV files instead of 32 bit floating point samples.\n"
+    "'drainIntervalSecs' is the interval in seconds at which the capture buffer is drained into the file.\n"
+    "Recording starts with the sound data captured after this call and continues across multiple starts and stops "
+    "of capture. Each start of capture via 'Start' or 'RescheduleStart' starts a new capture session. The file "
+    "'filename'.timestamps is a text file which records the position in the file, in sample frames, and the "
+    "capture start time, in GetSecs time, of each session, as 'start,position,time' lines. If the capture buffer "
+    "overflows, because the recording thread couldn't keep up, e.g., due to a slow disk, the lost sound data is "
+    "replaced by silence, so positions in the file always correspond to capture positions, and the position and "
+    "length of the gap is recorded as 'gap,position,lostframes' line. PsychPortAudio('GetStatus') reports the "
+    "number of such overflows and the amount of lost sound data.\n";
+
+    static char seeAlsoString[] = "GetAudioData GetStatus Start ";
+
+    PsychPADevice* dev;
+    char* filename = NULL;
+    const char* errmsg;
+    int pahandle = -1;
+    int int16 = 0;
+    double drainInterval = 0.25;
+
+    // Setup online help:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+    PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs
+    PsychErrorExit(PsychCapNumOutputArgs(0));    // The maximum number of outputs
+
+    // Make sure PortAudio is online:
+    PsychPortAudioInitialize();
+
+    PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+    if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+    if ((audiodevices[pahandle].opmode & kPortAudioCapture) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio capture, so this call doesn't make sense.");
+    dev = &audiodevices[pahandle];
+
+    PsychAllocInCharArg(2, kPsychArgOptional, &filename);
+
+    PsychCopyInIntegerArg(3, kPsychArgOptional, &int16);
+    if (int16 < 0 || int16 > 1) PsychErrorExitMsg(PsychError_user, "'int16' flag must be zero or one!");
+
+    PsychCopyInDoubleArg(4, kPsychArgOptional, &drainInterval);
+    if (drainInterval <= 0) PsychErrorExitMsg(PsychError_user, "Invalid 'drainIntervalSecs' provided. Must be greater than zero.");
+
+    // Stop current recording, if any:
+    if (dev->recorder) {
+        PsychPARecorderDestroy(dev->recorder);
+        dev->recorder = NULL;
+    }
+
+    // Only stop requested?
+    if ((filename == NULL) || (strlen(filename) == 0)) return(PsychError_none);
+
+    if ((dev->inputbuffer == NULL) || (dev->inputbuffersize == 0)) PsychErrorExitMsg(PsychError_user, "Capture buffer not yet allocated. Allocate it via PsychPortAudio('GetAudioData', pahandle, amountToAllocateSecs) first!");
+
+    errmsg = PsychPARecorderCreate(&dev->recorder, filename, (int16) ? TRUE : FALSE, (int) dev->inchannels, dev->streaminfo->sampleRate,
+                                   dev->inputbuffer, dev->inputbuffersize / sizeof(float), drainInterval, PsychPAGetRecorderPosition, (void*) dev);
+    if (errmsg) {
+        if (verbosity > 0) printf("PsychPortAudio-ERROR: Failed to start recording to file '%s': %s\n", filename, errmsg);
+        PsychErrorExitMsg(PsychError_user, "Could not start recording to file.");
+    }
+
+    return(PsychError_none);
+}
@@ -91,5 +91,9 @@ PsychError PSYCHPORTAUDIOSetOpMode(void);
 PsychError PSYCHPORTAUDIODirectInputMonitoring(void);
 // Set per-device volume:
 PsychError PSYCHPORTAUDIOVolume(void);
+// Control offline devices:
+PsychError PSYCHPORTAUDIOOfflineSettings(void);
+// Stream captured sound data to a file:
+PsychError PSYCHPORTAUDIORecordToFile(void);
 //end include once
 #endif
@@ -0,0 +1,746 @@
+/*
+ *        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioKernels.c
+ *
+ *        PLATFORMS:        All
+ *
+ *        DESCRIPTION:
+ *
+ *        Sample processing kernels for the mixer in the paCallback() of PsychPortAudio master devices,
+ *        and sample format converters for filling audio buffers from the runtime environment.
+ *
+ *        All kernels come in a scalar reference version and SIMD versions: SSE2 and AVX2 on x86, NEON on ARM.
+ *        The best supported version is selected at runtime. Channel mappings are turned into a mix plan via
+ *        PsychPACreateMixPlan() once when the mapping is set up, not inside the realtime callback: Identity
+ *        mappings of 1, 2, 4 or 8 channels mix the buffers as flat arrays. Other mappings which cover at least
+ *        half of the destination channels, without mapping two source channels to the same destination, mix
+ *        blocks of kPsychPAPlanFrames frames at once: For each destination sample of a block, the plan has the
+ *        index of its source sample in the source block, so the SIMD kernels gather source samples and process
+ *        whole destination blocks, across frames. Sparse mappings and remainder frames are mixed by a scalar
+ *        scatter loop.
+ *
+ *        These kernels run inside the realtime audio callback, so they must not allocate memory, take locks
+ *        or do anything else with unbounded execution time.
+ */
+
+#include "PsychPortAudioKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PSYCHPA_KERNELS_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PSYCHPA_TARGET_SSE2
+#define PSYCHPA_TARGET_AVX2
+#else
+#define PSYCHPA_TARGET_SSE2 __attribute__((target("sse2")))
+#define PSYCHPA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define PSYCHPA_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Number of frames in a block of a blockwise mix plan. Makes the number of samples in a block of destination frames
+// a multiple of all SIMD vector widths:
+#define kPsychPAPlanFrames 8
+
+struct PsychPAMixPlan {
+    psych_int64     srcChannels;    // Number of interleaved source channels.
+    psych_int64     dstChannels;    // Number of interleaved destination channels.
+    int*            mapping;        // Destination channel of each source channel.
+    psych_bool      flat;           // Identity mapping of 1, 2, 4 or 8 channels: Mix as flat arrays.
+    psych_int64     blockSize;      // Number of destination samples in a block of kPsychPAPlanFrames frames. Zero if not mixed blockwise.
+    int*            srcIndex;       // For each destination sample of a block: Index of its source sample in the source block, 0 if unmapped.
+    psych_uint32*   mask;           // For each destination sample of a block: All bits set if mapped, zero otherwise.
+    float*          blockGains;     // For each destination sample of a block: Gain of its source channel, zero if unmapped.
+    float*          lastGains;      // Per source channel gains 'blockGains' was set up for.
+    psych_bool      gainsValid;     // Is 'blockGains' set up?
+};
+
+typedef void (*PsychPAFillFunc)(float* buffer, float value, psych_int64 count);
+typedef void (*PsychPAMixBlocksFunc)(float* dst, const float* src, const PsychPAMixPlan* plan, psych_int64 blocks, int op);
+typedef void (*PsychPAMixFlatFunc)(float* dst, const float* src, const float* gainpattern, psych_int64 count, int op);
+typedef void (*PsychPAConvertFunc)(float* dst, const void* src, psych_int64 count, float gain);
+typedef float (*PsychPADotFunc)(const float* a, const float* b, psych_int64 count);
+
+static int maxKernelLevel = kPsychPAKernelScalar;
+static int kernelLevel = kPsychPAKernelScalar;
+static PsychPAFillFunc fillFunc = NULL;
+static PsychPAMixBlocksFunc mixBlocksFunc = NULL;
+static PsychPAMixFlatFunc mixFlatFunc = NULL;
+static PsychPAConvertFunc convertFuncs[3] = { NULL, NULL, NULL };
+static PsychPADotFunc dotFunc = NULL;
+
+// Scalar reference implementations:
+
+static void PsychPAFillScalar(float* buffer, float value, psych_int64 count)
+{
+    psych_int64 i;
+    for (i = 0; i < count; i++) buffer[i] = value;
+}
+
+// Mix 'frames' frames from src into dst, scattering each source channel to its destination channel in plan->mapping:
+static void PsychPAMixScatterScalar(float* dst, const float* src, const PsychPAMixPlan* plan, const float* gains, psych_int64 frames, int op)
+{
+    psych_int64 j, k, srcChannels = plan->srcChannels, dstChannels = plan->dstChannels;
+    const int* mapping = plan->mapping;
+
+    switch (op) {
+        case kPsychPAMixAssign:
+            for (j = 0; j < frames; j++, dst += dstChannels, src += srcChannels) {
+                for (k = 0; k < srcChannels; k++) dst[mapping[k]] = src[k] * gains[k];
+            }
+            break;
+        case kPsychPAMixAdd:
+            for (j = 0; j < frames; j++, dst += dstChannels, src += srcChannels) {
+                for (k = 0; k < srcChannels; k++) dst[mapping[k]] += src[k] * gains[k];
+            }
+            break;
+        case kPsychPAMixMultiply:
+            for (j = 0; j < frames; j++, dst += dstChannels, src += srcChannels) {
+                for (k = 0; k < srcChannels; k++) dst[mapping[k]] *= src[k] * gains[k];
+            }
+            break;
+    }
+}
+
+// Mix 'count' samples from src into dst, with gains repeating with a period of 8 samples:
+static void PsychPAMixFlatScalar(float* dst, const float* src, const float* gainpattern, psych_int64 count, int op)
+{
+    psych_int64 i;
+
+    switch (op) {
+        case kPsychPAMixAssign:
+            for (i = 0; i < count; i++) dst[i] = src[i] * gainpattern[i & 7];
+            break;
+        case kPsychPAMixAdd:
+            for (i = 0; i < count; i++) dst[i] += src[i] * gainpattern[i & 7];
+            break;
+        case kPsychPAMixMultiply:
+            for (i = 0; i < count; i++) dst[i] *= src[i] * gainpattern[i & 7];
+            break;
+    }
+}
+
+static void PsychPAConvertFloat64Scalar(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const double* in = (const double*) src;
+    psych_int64 i;
+    for (i = 0; i < count; i++) dst[i] = (float) (in[i] * gain);
+}
+
+static void PsychPAConvertFloat32Scalar(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const float* in = (const float*) src;
+    psych_int64 i;
+    for (i = 0; i < count; i++) dst[i] = in[i] * gain;
+}
+
+static void PsychPAConvertInt16Scalar(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const short* in = (const short*) src;
+    psych_int64 i;
+    for (i = 0; i < count; i++) dst[i] = (float) in[i] * gain;
+}
+
+static float PsychPADotScalar(const float* a, const float* b, psych_int64 count)
+{
+    psych_int64 i;
+    float sum = 0.0f;
+
+    for (i = 0; i < count; i++) sum += a[i] * b[i];
+
+    return(sum);
+}
+
+#ifdef PSYCHPA_KERNELS_X86
+
+// SSE2 implementations:
+
+PSYCHPA_TARGET_SSE2 static void PsychPAFillSSE2(float* buffer, float value, psych_int64 count)
+{
+    psych_int64 i;
+    __m128 v = _mm_set1_ps(value);
+
+    for (i = 0; i + 4 <= count; i += 4) _mm_storeu_ps(buffer + i, v);
+    for (; i < count; i++) buffer[i] = value;
+}
+
+// Mix 'blocks' blocks of kPsychPAPlanFrames frames from src into dst. SSE2 has no gather instruction, so the source
+// samples get gathered by scalar loads:
+PSYCHPA_TARGET_SSE2 static void PsychPAMixBlocksSSE2(float* dst, const float* src, const PsychPAMixPlan* plan, psych_int64 blocks, int op)
+{
+    psych_int64 b, i, srcBlockSize = plan->srcChannels * kPsychPAPlanFrames;
+    const int* idx;
+    __m128 p, d, m, one = _mm_set1_ps(1.0f);
+
+    for (b = 0; b < blocks; b++, dst += plan->blockSize, src += srcBlockSize) {
+        for (i = 0; i < plan->blockSize; i += 4) {
+            idx = plan->srcIndex + i;
+            p = _mm_mul_ps(_mm_set_ps(src[idx[3]], src[idx[2]], src[idx[1]], src[idx[0]]), _mm_loadu_ps(plan->blockGains + i));
+            m = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) (plan->mask + i)));
+            d = _mm_loadu_ps(dst + i);
+
+            // Unmapped destination samples stay as they are:
+            if (op == kPsychPAMixAdd) p = _mm_add_ps(d, _mm_and_ps(m, p));
+            else if (op == kPsychPAMixMultiply) p = _mm_mul_ps(d, _mm_or_ps(_mm_and_ps(m, p), _mm_andnot_ps(m, one)));
+            else p = _mm_or_ps(_mm_and_ps(m, p), _mm_andnot_ps(m, d));
+            _mm_storeu_ps(dst + i, p);
+        }
+    }
+}
+
+PSYCHPA_TARGET_SSE2 static void PsychPAMixFlatSSE2(float* dst, const float* src, const float* gainpattern, psych_int64 count, int op)
+{
+    psych_int64 i;
+    __m128 p, g0, g1;
+
+    g0 = _mm_loadu_ps(gainpattern);
+    g1 = _mm_loadu_ps(gainpattern + 4);
+    for (i = 0; i + 8 <= count; i += 8) {
+        p = _mm_mul_ps(_mm_loadu_ps(src + i), g0);
+        if (op == kPsychPAMixAdd) p = _mm_add_ps(_mm_loadu_ps(dst + i), p);
+        else if (op == kPsychPAMixMultiply) p = _mm_mul_ps(_mm_loadu_ps(dst + i), p);
+        _mm_storeu_ps(dst + i, p);
+
+        p = _mm_mul_ps(_mm_loadu_ps(src + i + 4), g1);
+        if (op == kPsychPAMixAdd) p = _mm_add_ps(_mm_loadu_ps(dst + i + 4), p);
+        else if (op == kPsychPAMixMultiply) p = _mm_mul_ps(_mm_loadu_ps(dst + i + 4), p);
+        _mm_storeu_ps(dst + i + 4, p);
+    }
+
+    // i is a multiple of 8 here, so the gain pattern stays in phase for the remainder:
+    PsychPAMixFlatScalar(dst + i, src + i, gainpattern, count - i, op);
+}
+
+PSYCHPA_TARGET_SSE2 static void PsychPAConvertFloat64SSE2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const double* in = (const double*) src;
+    psych_int64 i;
+    __m128 g = _mm_set1_ps(gain);
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(in + i)), _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2))), g));
+    }
+
+    PsychPAConvertFloat64Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_SSE2 static void PsychPAConvertFloat32SSE2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const float* in = (const float*) src;
+    psych_int64 i;
+    __m128 g = _mm_set1_ps(gain);
+
+    for (i = 0; i + 4 <= count; i += 4) _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(in + i), g));
+
+    PsychPAConvertFloat32Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_SSE2 static void PsychPAConvertInt16SSE2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const short* in = (const short*) src;
+    psych_int64 i;
+    __m128i v;
+    __m128 g = _mm_set1_ps(gain);
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        // Sign extend to 32 bit by unpacking into the high halves, then arithmetic shift down:
+        v = _mm_loadu_si128((const __m128i*) (in + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), g));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), g));
+    }
+
+    PsychPAConvertInt16Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_SSE2 static float PsychPADotSSE2(const float* a, const float* b, psych_int64 count)
+{
+    psych_int64 i;
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    float partial[4];
+
+    // Two accumulators to hide the latency of the additions:
+    for (i = 0; i + 8 <= count; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    _mm_storeu_ps(partial, _mm_add_ps(sum0, sum1));
+
+    return(partial[0] + partial[1] + partial[2] + partial[3] + PsychPADotScalar(a + i, b + i, count - i));
+}
+
+// AVX2 implementations:
+
+PSYCHPA_TARGET_AVX2 static void PsychPAFillAVX2(float* buffer, float value, psych_int64 count)
+{
+    psych_int64 i;
+    __m256 v = _mm256_set1_ps(value);
+
+    for (i = 0; i + 8 <= count; i += 8) _mm256_storeu_ps(buffer + i, v);
+    for (; i < count; i++) buffer[i] = value;
+}
+
+PSYCHPA_TARGET_AVX2 static void PsychPAMixBlocksAVX2(float* dst, const float* src, const PsychPAMixPlan* plan, psych_int64 blocks, int op)
+{
+    psych_int64 b, i, srcBlockSize = plan->srcChannels * kPsychPAPlanFrames;
+    __m256 p, d, m, one = _mm256_set1_ps(1.0f);
+
+    for (b = 0; b < blocks; b++, dst += plan->blockSize, src += srcBlockSize) {
+        for (i = 0; i < plan->blockSize; i += 8) {
+            p = _mm256_mul_ps(_mm256_i32gather_ps(src, _mm256_loadu_si256((const __m256i*) (plan->srcIndex + i)), 4), _mm256_loadu_ps(plan->blockGains + i));
+            m = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*) (plan->mask + i)));
+            d = _mm256_loadu_ps(dst + i);
+
+            // Unmapped destination samples stay as they are:
+            if (op == kPsychPAMixAdd) p = _mm256_add_ps(d, _mm256_and_ps(m, p));
+            else if (op == kPsychPAMixMultiply) p = _mm256_mul_ps(d, _mm256_blendv_ps(one, p, m));
+            else p = _mm256_blendv_ps(d, p, m);
+            _mm256_storeu_ps(dst + i, p);
+        }
+    }
+}
+
+PSYCHPA_TARGET_AVX2 static void PsychPAMixFlatAVX2(float* dst, const float* src, const float* gainpattern, psych_int64 count, int op)
+{
+    psych_int64 i;
+    __m256 p, g;
+
+    g = _mm256_loadu_ps(gainpattern);
+    for (i = 0; i + 8 <= count; i += 8) {
+        p = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+        if (op == kPsychPAMixAdd) p = _mm256_add_ps(_mm256_loadu_ps(dst + i), p);
+        else if (op == kPsychPAMixMultiply) p = _mm256_mul_ps(_mm256_loadu_ps(dst + i), p);
+        _mm256_storeu_ps(dst + i, p);
+    }
+
+    PsychPAMixFlatScalar(dst + i, src + i, gainpattern, count - i, op);
+}
+
+PSYCHPA_TARGET_AVX2 static void PsychPAConvertFloat64AVX2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const double* in = (const double*) src;
+    psych_int64 i;
+    __m256 g = _mm256_set1_ps(gain);
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(in + i))), _mm256_cvtpd_ps(_mm256_loadu_pd(in + i + 4)), 1), g));
+    }
+
+    PsychPAConvertFloat64Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_AVX2 static void PsychPAConvertFloat32AVX2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const float* in = (const float*) src;
+    psych_int64 i;
+    __m256 g = _mm256_set1_ps(gain);
+
+    for (i = 0; i + 8 <= count; i += 8) _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), g));
+
+    PsychPAConvertFloat32Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_AVX2 static void PsychPAConvertInt16AVX2(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const short* in = (const short*) src;
+    psych_int64 i;
+    __m256 g = _mm256_set1_ps(gain);
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) (in + i)))), g));
+    }
+
+    PsychPAConvertInt16Scalar(dst + i, in + i, count - i, gain);
+}
+
+PSYCHPA_TARGET_AVX2 static float PsychPADotAVX2(const float* a, const float* b, psych_int64 count)
+{
+    psych_int64 i;
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    __m128 sum;
+    float partial[4];
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+
+    sum0 = _mm256_add_ps(sum0, sum1);
+    sum = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+    _mm_storeu_ps(partial, sum);
+
+    return(partial[0] + partial[1] + partial[2] + partial[3] + PsychPADotScalar(a + i, b + i, count - i));
+}
+
+static psych_bool PsychPACPUHasAVX2(void)
+{
+    #ifdef _MSC_VER
+    int regs[4];
+
+    // Need OS support for saving ymm registers (OSXSAVE + XCR0 bits 1 and 2), and the AVX2 feature bit:
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return(FALSE);
+    __cpuid(regs, 1);
+    if (!(regs[2] & (1 << 27)) || !(regs[2] & (1 << 28))) return(FALSE);
+    if ((_xgetbv(0) & 6) != 6) return(FALSE);
+    __cpuidex(regs, 7, 0);
+    return((regs[1] & (1 << 5)) ? TRUE : FALSE);
+    #else
+    __builtin_cpu_init();
+    return(__builtin_cpu_supports("avx2") ? TRUE : FALSE);
+    #endif
+}
+
+#endif
+
+#ifdef PSYCHPA_KERNELS_NEON
+
+// NEON implementations:
+
+static void PsychPAFillNEON(float* buffer, float value, psych_int64 count)
+{
+    psych_int64 i;
+    float32x4_t v = vdupq_n_f32(value);
+
+    for (i = 0; i + 4 <= count; i += 4) vst1q_f32(buffer + i, v);
+    for (; i < count; i++) buffer[i] = value;
+}
+
+// NEON has no gather instruction, so the source samples get gathered by lane loads:
+static void PsychPAMixBlocksNEON(float* dst, const float* src, const PsychPAMixPlan* plan, psych_int64 blocks, int op)
+{
+    psych_int64 b, i, srcBlockSize = plan->srcChannels * kPsychPAPlanFrames;
+    const int* idx;
+    float32x4_t p, d, one = vdupq_n_f32(1.0f);
+    uint32x4_t m;
+
+    for (b = 0; b < blocks; b++, dst += plan->blockSize, src += srcBlockSize) {
+        for (i = 0; i < plan->blockSize; i += 4) {
+            idx = plan->srcIndex + i;
+            p = vld1q_dup_f32(src + idx[0]);
+            p = vld1q_lane_f32(src + idx[1], p, 1);
+            p = vld1q_lane_f32(src + idx[2], p, 2);
+            p = vld1q_lane_f32(src + idx[3], p, 3);
+            p = vmulq_f32(p, vld1q_f32(plan->blockGains + i));
+            m = vld1q_u32(plan->mask + i);
+            d = vld1q_f32(dst + i);
+
+            // Unmapped destination samples stay as they are:
+            if (op == kPsychPAMixAdd) p = vaddq_f32(d, vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(p))));
+            else if (op == kPsychPAMixMultiply) p = vmulq_f32(d, vbslq_f32(m, p, one));
+            else p = vbslq_f32(m, p, d);
+            vst1q_f32(dst + i, p);
+        }
+    }
+}
+
+static void PsychPAMixFlatNEON(float* dst, const float* src, const float* gainpattern, psych_int64 count, int op)
+{
+    psych_int64 i;
+    float32x4_t p, g0, g1;
+
+    g0 = vld1q_f32(gainpattern);
+    g1 = vld1q_f32(gainpattern + 4);
+    for (i = 0; i + 8 <= count; i += 8) {
+        p = vmulq_f32(vld1q_f32(src + i), g0);
+        if (op == kPsychPAMixAdd) p = vaddq_f32(vld1q_f32(dst + i), p);
+        else if (op == kPsychPAMixMultiply) p = vmulq_f32(vld1q_f32(dst + i), p);
+        vst1q_f32(dst + i, p);
+
+        p = vmulq_f32(vld1q_f32(src + i + 4), g1);
+        if (op == kPsychPAMixAdd) p = vaddq_f32(vld1q_f32(dst + i + 4), p);
+        else if (op == kPsychPAMixMultiply) p = vmulq_f32(vld1q_f32(dst + i + 4), p);
+        vst1q_f32(dst + i + 4, p);
+    }
+
+    PsychPAMixFlatScalar(dst + i, src + i, gainpattern, count - i, op);
+}
+
+#ifdef __aarch64__
+static void PsychPAConvertFloat64NEON(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const double* in = (const double*) src;
+    psych_int64 i;
+    float32x4_t g = vdupq_n_f32(gain);
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vmulq_f32(vcombine_f32(vcvt_f32_f64(vld1q_f64(in + i)), vcvt_f32_f64(vld1q_f64(in + i + 2))), g));
+    }
+
+    PsychPAConvertFloat64Scalar(dst + i, in + i, count - i, gain);
+}
+#else
+// No double precision vector support on 32-Bit ARM:
+#define PsychPAConvertFloat64NEON PsychPAConvertFloat64Scalar
+#endif
+
+static void PsychPAConvertFloat32NEON(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const float* in = (const float*) src;
+    psych_int64 i;
+    float32x4_t g = vdupq_n_f32(gain);
+
+    for (i = 0; i + 4 <= count; i += 4) vst1q_f32(dst + i, vmulq_f32(vld1q_f32(in + i), g));
+
+    PsychPAConvertFloat32Scalar(dst + i, in + i, count - i, gain);
+}
+
+static void PsychPAConvertInt16NEON(float* dst, const void* src, psych_int64 count, float gain)
+{
+    const short* in = (const short*) src;
+    psych_int64 i;
+    int16x8_t v;
+    float32x4_t g = vdupq_n_f32(gain);
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        v = vld1q_s16(in + i);
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), g));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), g));
+    }
+
+    PsychPAConvertInt16Scalar(dst + i, in + i, count - i, gain);
+}
+
+static float PsychPADotNEON(const float* a, const float* b, psych_int64 count)
+{
+    psych_int64 i;
+    float32x4_t sum0 = vdupq_n_f32(0.0f), sum1 = vdupq_n_f32(0.0f);
+    float partial[4];
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        sum0 = vmlaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+        sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+
+    vst1q_f32(partial, vaddq_f32(sum0, sum1));
+
+    return(partial[0] + partial[1] + partial[2] + partial[3] + PsychPADotScalar(a + i, b + i, count - i));
+}
+
+#endif
+
+int PsychPAInitKernels(void)
+{
+    maxKernelLevel = kPsychPAKernelScalar;
+
+    #ifdef PSYCHPA_KERNELS_X86
+    // SSE2 is part of the x86-64 baseline, and required by any cpu supported by our 32-Bit builds:
+    maxKernelLevel = kPsychPAKernelSIMD128;
+    if (PsychPACPUHasAVX2()) maxKernelLevel = kPsychPAKernelSIMD256;
+    #endif
+
+    #ifdef PSYCHPA_KERNELS_NEON
+    maxKernelLevel = kPsychPAKernelSIMD128;
+    #endif
+
+    return(PsychPASetKernelLevel(kPsychPAKernelAuto));
+}
+
+int PsychPASetKernelLevel(int level)
+{
+    if ((level < 0) || (level > maxKernelLevel)) level = maxKernelLevel;
+
+    // Scalar reference as fallback, which mixes blockwise plans with the scatter loop:
+    fillFunc = PsychPAFillScalar;
+    mixBlocksFunc = NULL;
+    mixFlatFunc = PsychPAMixFlatScalar;
+    convertFuncs[kPsychPASampleFloat64] = PsychPAConvertFloat64Scalar;
+    convertFuncs[kPsychPASampleFloat32] = PsychPAConvertFloat32Scalar;
+    convertFuncs[kPsychPASampleInt16] = PsychPAConvertInt16Scalar;
+    dotFunc = PsychPADotScalar;
+
+    #ifdef PSYCHPA_KERNELS_X86
+    if (level == kPsychPAKernelSIMD128) {
+        fillFunc = PsychPAFillSSE2;
+        mixBlocksFunc = PsychPAMixBlocksSSE2;
+        mixFlatFunc = PsychPAMixFlatSSE2;
+        convertFuncs[kPsychPASampleFloat64] = PsychPAConvertFloat64SSE2;
+        convertFuncs[kPsychPASampleFloat32] = PsychPAConvertFloat32SSE2;
+        convertFuncs[kPsychPASampleInt16] = PsychPAConvertInt16SSE2;
+        dotFunc = PsychPADotSSE2;
+    }
+
+    if (level == kPsychPAKernelSIMD256) {
+        fillFunc = PsychPAFillAVX2;
+        mixBlocksFunc = PsychPAMixBlocksAVX2;
+        mixFlatFunc = PsychPAMixFlatAVX2;
+        convertFuncs[kPsychPASampleFloat64] = PsychPAConvertFloat64AVX2;
+        convertFuncs[kPsychPASampleFloat32] = PsychPAConvertFloat32AVX2;
+        convertFuncs[kPsychPASampleInt16] = PsychPAConvertInt16AVX2;
+        dotFunc = PsychPADotAVX2;
+    }
+    #endif
+
+    #ifdef PSYCHPA_KERNELS_NEON
+    if (level == kPsychPAKernelSIMD128) {
+        fillFunc = PsychPAFillNEON;
+        mixBlocksFunc = PsychPAMixBlocksNEON;
+        mixFlatFunc = PsychPAMixFlatNEON;
+        convertFuncs[kPsychPASampleFloat64] = PsychPAConvertFloat64NEON;
+        convertFuncs[kPsychPASampleFloat32] = PsychPAConvertFloat32NEON;
+        convertFuncs[kPsychPASampleInt16] = PsychPAConvertInt16NEON;
+        dotFunc = PsychPADotNEON;
+    }
+    #endif
+
+    kernelLevel = level;
+
+    return(kernelLevel);
+}
+
+int PsychPAGetKernelLevel(void)
+{
+    return(kernelLevel);
+}
+
+PsychPAMixPlan* PsychPACreateMixPlan(const int* mapping, psych_int64 srcChannels, psych_int64 dstChannels)
+{
+    PsychPAMixPlan* plan;
+    psych_int64 i, j, k;
+    psych_bool blockwise = TRUE;
+
+    if ((mapping == NULL) || (srcChannels < 1) || (dstChannels < 1)) return(NULL);
+
+    plan = (PsychPAMixPlan*) calloc(1, sizeof(PsychPAMixPlan));
+    if (plan == NULL) return(NULL);
+
+    plan->srcChannels = srcChannels;
+    plan->dstChannels = dstChannels;
+    plan->mapping = (int*) malloc(sizeof(int) * (size_t) srcChannels);
+    plan->lastGains = (float*) malloc(sizeof(float) * (size_t) srcChannels);
+    if ((plan->mapping == NULL) || (plan->lastGains == NULL)) {
+        PsychPADestroyMixPlan(plan);
+        return(NULL);
+    }
+
+    plan->flat = (srcChannels == dstChannels) && ((8 % srcChannels) == 0);
+    for (k = 0; k < srcChannels; k++) {
+        plan->mapping[k] = mapping[k];
+        if (mapping[k] != k) plan->flat = FALSE;
+        if ((mapping[k] < 0) || (mapping[k] >= dstChannels)) blockwise = FALSE;
+    }
+
+    // Blockwise mixing processes all destination samples of a block, so it only pays off if at least half of them
+    // are mapped. A destination channel can only have one source channel:
+    if (plan->flat || (2 * srcChannels < dstChannels)) blockwise = FALSE;
+    for (k = 0; blockwise && (k < srcChannels); k++) {
+        for (j = 0; j < k; j++) if (mapping[j] == mapping[k]) blockwise = FALSE;
+    }
+
+    if (blockwise) {
+        plan->blockSize = dstChannels * kPsychPAPlanFrames;
+        plan->srcIndex = (int*) calloc((size_t) plan->blockSize, sizeof(int));
+        plan->mask = (psych_uint32*) calloc((size_t) plan->blockSize, sizeof(psych_uint32));
+        plan->blockGains = (float*) calloc((size_t) plan->blockSize, sizeof(float));
+        if ((plan->srcIndex == NULL) || (plan->mask == NULL) || (plan->blockGains == NULL)) {
+            PsychPADestroyMixPlan(plan);
+            return(NULL);
+        }
+
+        for (i = 0; i < kPsychPAPlanFrames; i++) {
+            for (k = 0; k < srcChannels; k++) {
+                plan->srcIndex[(i * dstChannels) + mapping[k]] = (int) ((i * srcChannels) + k);
+                plan->mask[(i * dstChannels) + mapping[k]] = 0xffffffff;
+            }
+        }
+    }
+
+    return(plan);
+}
+
+void PsychPADestroyMixPlan(PsychPAMixPlan* plan)
+{
+    if (plan == NULL) return;
+
+    free(plan->mapping);
+    free(plan->lastGains);
+    free(plan->srcIndex);
+    free(plan->mask);
+    free(plan->blockGains);
+    free(plan);
+}
+
+// Expand per source channel 'gains' into per destination sample gains of a block, unless they didn't change:
+static void PsychPAUpdateBlockGains(PsychPAMixPlan* plan, const float* gains)
+{
+    psych_int64 i;
+
+    if (plan->gainsValid && (memcmp(plan->lastGains, gains, sizeof(float) * (size_t) plan->srcChannels) == 0)) return;
+
+    for (i = 0; i < plan->blockSize; i++) {
+        plan->blockGains[i] = (plan->mask[i]) ? gains[plan->srcIndex[i] % plan->srcChannels] : 0.0f;
+    }
+
+    memcpy(plan->lastGains, gains, sizeof(float) * (size_t) plan->srcChannels);
+    plan->gainsValid = TRUE;
+}
+
+void PsychPAFillSamples(float* buffer, float value, psych_int64 count)
+{
+    if (fillFunc == NULL) PsychPAInitKernels();
+    fillFunc(buffer, value, count);
+}
+
+void PsychPAMixChannels(float* dst, const float* src, PsychPAMixPlan* plan, const float* gains, psych_int64 frames, int op)
+{
+    float gainpattern[8];
+    psych_int64 k, blocks;
+
+    if (mixFlatFunc == NULL) PsychPAInitKernels();
+
+    if (plan->flat) {
+        // Identity mapping with 1, 2, 4 or 8 channels: Treat buffers as one flat array of samples,
+        // whose gains repeat with a period of 8 samples:
+        for (k = 0; k < 8; k++) gainpattern[k] = gains[k % plan->srcChannels];
+        mixFlatFunc(dst, src, gainpattern, frames * plan->srcChannels, op);
+        return;
+    }
+
+    // Dense mapping and SIMD kernels available? Process whole blocks of frames at once:
+    blocks = (plan->blockSize > 0 && mixBlocksFunc) ? frames / kPsychPAPlanFrames : 0;
+    if (blocks > 0) {
+        PsychPAUpdateBlockGains(plan, gains);
+        mixBlocksFunc(dst, src, plan, blocks, op);
+        dst += blocks * plan->blockSize;
+        src += blocks * kPsychPAPlanFrames * plan->srcChannels;
+        frames -= blocks * kPsychPAPlanFrames;
+    }
+
+    // Sparse mapping, scalar kernels, or remainder of less than a block:
+    PsychPAMixScatterScalar(dst, src, plan, gains, frames, op);
+
+    return;
+}
+
+void PsychPAConvertSamples(float* dst, const void* src, int format, psych_int64 count, float gain)
+{
+    // Data already in our format? Then it is a plain copy:
+    if ((format == kPsychPASampleFloat32) && (gain == 1.0f)) {
+        memcpy(dst, src, (size_t) count * sizeof(float));
+        return;
+    }
+
+    if (convertFuncs[0] == NULL) PsychPAInitKernels();
+    convertFuncs[format](dst, src, count, gain);
+}
+
+size_t PsychPAGetSampleSize(int format)
+{
+    switch (format) {
+        case kPsychPASampleFloat64:
+            return(sizeof(double));
+        case kPsychPASampleInt16:
+            return(sizeof(short));
+        default:
+            return(sizeof(float));
+    }
+}
+
+float PsychPADotProduct(const float* a, const float* b, psych_int64 count)
+{
+    if (dotFunc == NULL) PsychPAInitKernels();
+    return(dotFunc(a, b, count));
+}
@@ -0,0 +1,71 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioKernels.h
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Sample processing kernels for the mixer of PsychPortAudio master devices: Buffer
+        fill, mix-add and multiply-modulate with per channel gain and channel remapping.
+        Also sample format conversion of double, single and int16 input data into the
+        internal float sample format of audio buffers, and dot products for the FIR filters
+        of the resampler. Each kernel has a scalar reference implementation and SIMD
+        implementations for SSE2 and AVX2 on x86 and NEON on ARM, selected at runtime by
+        cpu feature detection.
+*/
+
+//begin include once
+#ifndef PSYCH_IS_INCLUDED_PsychPortAudioKernels
+#define PSYCH_IS_INCLUDED_PsychPortAudioKernels
+
+#include "Psych.h"
+
+// SIMD levels for PsychPASetKernelLevel():
+#define kPsychPAKernelAuto      -1
+#define kPsychPAKernelScalar     0
+#define kPsychPAKernelSIMD128    1  // SSE2 on x86, NEON on ARM.
+#define kPsychPAKernelSIMD256    2  // AVX2 on x86.
+
+// Mix operations for PsychPAMixChannels():
+#define kPsychPAMixAssign        0  // dst = src * gain
+#define kPsychPAMixAdd           1  // dst += src * gain
+#define kPsychPAMixMultiply      2  // dst *= src * gain
+
+// Sample formats for PsychPAConvertSamples():
+#define kPsychPASampleFloat64    0  // double
+#define kPsychPASampleFloat32    1  // float
+#define kPsychPASampleInt16      2  // 16 bit signed integer
+
+// Detect cpu features and select best kernels. Returns selected level.
+int  PsychPAInitKernels(void);
+// Select kernel level: kPsychPAKernelAuto for best available. Returns selected level, which may be lower than requested.
+int  PsychPASetKernelLevel(int level);
+// Return currently selected kernel level:
+int  PsychPAGetKernelLevel(void);
+
+// Mix plan for PsychPAMixChannels(), precomputed from a channel mapping when the mapping is set up:
+typedef struct PsychPAMixPlan PsychPAMixPlan;
+
+// Create mix plan for mixing 'srcChannels' interleaved channels into 'dstChannels' interleaved channels, source channel k
+// going to destination channel mapping[k]. Returns NULL if 'mapping' is NULL:
+PsychPAMixPlan* PsychPACreateMixPlan(const int* mapping, psych_int64 srcChannels, psych_int64 dstChannels);
+// Destroy mix plan, if any:
+void PsychPADestroyMixPlan(PsychPAMixPlan* plan);
+
+// Fill 'count' samples in 'buffer' with 'value':
+void PsychPAFillSamples(float* buffer, float value, psych_int64 count);
+
+// Mix 'frames' frames of interleaved channels in 'src' into the interleaved channels of 'dst', according to 'plan',
+// applying per source channel 'gains'. A plan must only be used by one thread at a time:
+void PsychPAMixChannels(float* dst, const float* src, PsychPAMixPlan* plan, const float* gains, psych_int64 frames, int op);
+
+// Convert 'count' samples of 'format' from 'src' into float samples in 'dst', multiplying each by 'gain':
+void PsychPAConvertSamples(float* dst, const void* src, int format, psych_int64 count, float gain);
+// Return size of one sample of 'format' in bytes:
+size_t PsychPAGetSampleSize(int format);
+
+// Return sum of products of the 'count' samples in 'a' and 'b', eg. for FIR filtering:
+float PsychPADotProduct(const float* a, const float* b, psych_int64 count);
+
+//end include once
+#endif
@@ -0,0 +1,425 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioOffline.c
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Offline "virtual sound card" backend for PsychPortAudio. See PsychPortAudioOffline.h
+        for an overview.
+
+        Timing model: Each offline stream has a virtual clock, which is advanced by the duration
+        of one buffer, ie. framesPerBuffer / sampleRate seconds, per callback invocation. On start
+        of a stream, the virtual clock is set to the current GetSecs time, unless it is already
+        ahead of it from a previous run, so it is always monotonic. Virtual output latency and
+        input latency are one buffer duration each. At 'speed' s > 0, the driver thread paces
+        callbacks, so the virtual clock advances at s times the speed of the system clock. At
+        speed zero, callbacks are executed back to back as fast as possible. A paced callback which
+        starts more than one buffer duration after its due time, e.g., because the previous callback
+        was stalled, gets a paOutputUnderflow status flag, like a real sound card would report a
+        dropout, and pacing gets re-anchored at the current time.
+*/
+
+#include "PsychPortAudioOffline.h"
+
+typedef struct PsychPAOfflineStream {
+    struct PsychPAOfflineStream* next;              // Next stream in list of all open offline streams.
+    PaStreamCallback*           callback;           // Stream callback.
+    PaStreamFinishedCallback*   finishedCallback;   // Stream finished callback, or NULL if none.
+    void*                       userData;           // User data for callbacks.
+    PaStreamInfo                streamInfo;         // Returned by PsychPAStreamGetInfo().
+    int                         inchannels;         // Number of input channels, 0 if none.
+    int                         outchannels;        // Number of output channels, 0 if none.
+    unsigned long               framesPerBuffer;    // Fixed number of frames per callback invocation.
+    float*                      inBuffer;           // Input buffer for callback, or NULL.
+    float*                      outBuffer;          // Output buffer for callback, or NULL.
+    psych_mutex                 mutex;              // Protects 'stats' and 'speed'. 'outFile' only changes while stopped.
+    psych_thread                thread;             // Driver thread while started.
+    volatile int                active;             // Driver thread calls the callback.
+    volatile int                stopped;            // Stream is stopped, ie. not started or stopped/aborted after start.
+    volatile int                stopRequest;        // 0 = None, 1 = Stop, 2 = Abort requested by PsychPAStreamStop/Abort().
+    double                      speed;              // Pacing speed: 0 = As fast as possible, > 0 = Multiple of realtime.
+    double                      cpuLoad;            // Running estimate of cpu load of the callback.
+    double                      tRunStart;          // System time of start of current run of driver thread.
+    FILE*                       outFile;            // WAV output file, or NULL.
+    psych_uint64                outFileDataBytes;   // Bytes of sample data written to the WAV file so far.
+    PsychPAOfflineStats         stats;              // Statistics, including current virtual time.
+} PsychPAOfflineStream;
+
+// List of all open offline streams. Only touched from the main thread:
+static PsychPAOfflineStream* offlineStreams = NULL;
+
+psych_bool PsychPAIsOfflineStream(PaStream* stream)
+{
+    PsychPAOfflineStream* s;
+
+    for (s = offlineStreams; s; s = s->next) if ((PaStream*) s == stream) return(TRUE);
+
+    return(FALSE);
+}
+
+static unsigned char* PsychPAOfflinePutLE(unsigned char* p, psych_uint64 value, int nbytes)
+{
+    int i;
+
+    for (i = 0; i < nbytes; i++) *(p++) = (unsigned char) ((value >> (8 * i)) & 0xff);
+
+    return(p);
+}
+
+// Write or rewrite header of a 32 bit float WAV file with 'dataBytes' bytes of sample data:
+static void PsychPAOfflineWriteWAVHeader(PsychPAOfflineStream* s, psych_uint64 dataBytes)
+{
+    FILE* f = s->outFile;
+    int channels = (s->outchannels > 0) ? s->outchannels : s->inchannels;
+    int rate = (int) s->streamInfo.sampleRate;
+    unsigned char header[44], *p = header;
+
+    // WAV files are limited to 4 GB. We keep writing beyond, but the header will be saturated:
+    if (dataBytes > 0xffffffff - 36) dataBytes = 0xffffffff - 36;
+
+    // Assemble header, so it can be written in one go:
+    memcpy(p, "RIFF", 4); p += 4;
+    p = PsychPAOfflinePutLE(p, 36 + dataBytes, 4);
+    memcpy(p, "WAVEfmt ", 8); p += 8;
+    p = PsychPAOfflinePutLE(p, 16, 4);                            // fmt chunk size.
+    p = PsychPAOfflinePutLE(p, 3, 2);                             // WAVE_FORMAT_IEEE_FLOAT.
+    p = PsychPAOfflinePutLE(p, channels, 2);
+    p = PsychPAOfflinePutLE(p, rate, 4);
+    p = PsychPAOfflinePutLE(p, (psych_uint64) rate * channels * sizeof(float), 4);
+    p = PsychPAOfflinePutLE(p, channels * sizeof(float), 2);     // Block align.
+    p = PsychPAOfflinePutLE(p, 32, 2);                            // Bits per sample.
+    memcpy(p, "data", 4); p += 4;
+    PsychPAOfflinePutLE(p, dataBytes, 4);
+
+    fseek(f, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), f);
+    fseek(f, 0, SEEK_END);
+}
+
+static void PsychPAOfflineCloseOutputFile(PsychPAOfflineStream* s)
+{
+    if (s->outFile) {
+        PsychPAOfflineWriteWAVHeader(s, s->outFileDataBytes);
+        fclose(s->outFile);
+        s->outFile = NULL;
+    }
+}
+
+// Main routine of the driver thread of a started offline stream:
+static void* PsychPAOfflineThreadMain(void* arg)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) arg;
+    PaStreamCallbackTimeInfo timeInfo;
+    double bufferSecs = (double) s->framesPerBuffer / s->streamInfo.sampleRate;
+    double tRunStart, tAnchor, vAnchor, speed, tDue, tBefore, tAfter, dt;
+    PaStreamCallbackFlags statusFlags;
+    unsigned long i, written;
+    int c, rc = paContinue;
+
+    PsychSetThreadName("PsychPAOffline");
+
+    PsychGetAdjustedPrecisionTimerSeconds(&tRunStart);
+    tAnchor = tRunStart;
+
+    PsychLockMutex(&s->mutex);
+    speed = s->speed;
+    vAnchor = s->stats.virtualTime;
+    s->tRunStart = tRunStart;
+    PsychUnlockMutex(&s->mutex);
+
+    while ((s->stopRequest == 0) && (rc == paContinue)) {
+        // Pacing: Wait until the virtual clock is due, relative to the last (re-)anchoring:
+        statusFlags = 0;
+        if (speed > 0) {
+            tDue = tAnchor + (s->stats.virtualTime - vAnchor) / speed;
+            PsychWaitUntilSeconds(tDue);
+
+            // More than one buffer late? That would be a dropout on real hardware:
+            PsychGetAdjustedPrecisionTimerSeconds(&tBefore);
+            if (tBefore > tDue + bufferSecs / speed) {
+                statusFlags = (s->outBuffer) ? paOutputUnderflow : paInputOverflow;
+                tAnchor = tBefore;
+                vAnchor = s->stats.virtualTime;
+            }
+        }
+
+        // Input is the output of the previous callback for full-duplex streams, silence otherwise:
+        if (s->inBuffer) {
+            for (i = 0; i < s->framesPerBuffer; i++) {
+                for (c = 0; c < s->inchannels; c++) {
+                    s->inBuffer[i * s->inchannels + c] = (c < s->outchannels) ? s->outBuffer[i * s->outchannels + c] : 0.0f;
+                }
+            }
+        }
+
+        timeInfo.currentTime = s->stats.virtualTime;
+        timeInfo.outputBufferDacTime = s->stats.virtualTime + s->streamInfo.outputLatency;
+        timeInfo.inputBufferAdcTime = s->stats.virtualTime - s->streamInfo.inputLatency;
+
+        PsychGetAdjustedPrecisionTimerSeconds(&tBefore);
+        rc = s->callback((const void*) s->inBuffer, (void*) s->outBuffer, s->framesPerBuffer, &timeInfo, statusFlags, s->userData);
+        PsychGetAdjustedPrecisionTimerSeconds(&tAfter);
+        dt = tAfter - tBefore;
+
+        // Write output without holding the mutex, so other threads don't stall on file i/o. The output
+        // buffer is only touched by this thread, and the output file only changes while stopped:
+        written = 0;
+        if (s->outFile && s->outBuffer &&
+            (fwrite(s->outBuffer, sizeof(float) * s->outchannels, s->framesPerBuffer, s->outFile) == s->framesPerBuffer)) {
+            written = s->framesPerBuffer;
+        }
+
+        PsychLockMutex(&s->mutex);
+
+        s->outFileDataBytes += sizeof(float) * s->outchannels * written;
+        s->stats.framesWritten += written;
+
+        s->stats.virtualTime += bufferSecs;
+        s->stats.callbacks++;
+        if (statusFlags) s->stats.deadlineMisses++;
+        s->stats.frames += s->framesPerBuffer;
+        s->stats.callbackSecsTotal += dt;
+        if (dt > s->stats.callbackSecsMax) s->stats.callbackSecsMax = dt;
+        s->cpuLoad = 0.9 * s->cpuLoad + 0.1 * (dt / bufferSecs);
+
+        // Speed changed? Re-anchor pacing:
+        if (s->speed != speed) {
+            speed = s->speed;
+            vAnchor = s->stats.virtualTime;
+            tAnchor = tAfter;
+        }
+
+        PsychUnlockMutex(&s->mutex);
+    }
+
+    // Done: paComplete or paAbort from callback, or stop/abort request.
+    PsychGetAdjustedPrecisionTimerSeconds(&tAfter);
+    PsychLockMutex(&s->mutex);
+    s->stats.wallSecsTotal += tAfter - tRunStart;
+    s->active = 0;
+    PsychUnlockMutex(&s->mutex);
+
+    if (s->finishedCallback) s->finishedCallback(s->userData);
+
+    return(NULL);
+}
+
+PaError PsychPAOfflineOpenStream(PaStream** stream, int inchannels, int outchannels, double sampleRate, unsigned long framesPerBuffer,
+                                 PaStreamCallback* callback, void* userData)
+{
+    PsychPAOfflineStream* s;
+
+    *stream = NULL;
+    if ((inchannels < 0) || (outchannels < 0) || (inchannels + outchannels == 0)) return(paInvalidChannelCount);
+    if (sampleRate <= 0) return(paInvalidSampleRate);
+    if ((framesPerBuffer == 0) || (callback == NULL)) return(paBadStreamPtr);
+
+    s = (PsychPAOfflineStream*) calloc(1, sizeof(PsychPAOfflineStream));
+    if (NULL == s) return(paInsufficientMemory);
+
+    s->inBuffer = (inchannels > 0) ? (float*) calloc((size_t) inchannels * framesPerBuffer, sizeof(float)) : NULL;
+    s->outBuffer = (outchannels > 0) ? (float*) calloc((size_t) outchannels * framesPerBuffer, sizeof(float)) : NULL;
+    if (((inchannels > 0) && (NULL == s->inBuffer)) || ((outchannels > 0) && (NULL == s->outBuffer)) || PsychInitMutex(&s->mutex)) {
+        free(s->inBuffer);
+        free(s->outBuffer);
+        free(s);
+        return(paInsufficientMemory);
+    }
+
+    s->callback = callback;
+    s->userData = userData;
+    s->inchannels = inchannels;
+    s->outchannels = outchannels;
+    s->framesPerBuffer = framesPerBuffer;
+    s->stopped = 1;
+    s->speed = 1.0;
+
+    s->streamInfo.structVersion = 1;
+    s->streamInfo.sampleRate = sampleRate;
+    s->streamInfo.inputLatency = (inchannels > 0) ? (double) framesPerBuffer / sampleRate : 0.0;
+    s->streamInfo.outputLatency = (outchannels > 0) ? (double) framesPerBuffer / sampleRate : 0.0;
+
+    s->stats.speed = s->speed;
+
+    // Enqueue:
+    s->next = offlineStreams;
+    offlineStreams = s;
+
+    *stream = (PaStream*) s;
+
+    return(paNoError);
+}
+
+void PsychPAOfflineSetSpeed(PaStream* stream, double speed)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+
+    PsychLockMutex(&s->mutex);
+    s->speed = (speed > 0) ? speed : 0;
+    PsychUnlockMutex(&s->mutex);
+}
+
+const char* PsychPAOfflineSetOutputFile(PaStream* stream, const char* filename)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+    const char* errmsg = NULL;
+
+    // Switching files in the middle of a run would split the rendered output across files:
+    if (!s->stopped) return("Output file can't be changed while the device is running. Stop it first!");
+
+    PsychLockMutex(&s->mutex);
+
+    PsychPAOfflineCloseOutputFile(s);
+
+    if (filename && (strlen(filename) > 0)) {
+        s->outFile = fopen(filename, "wb");
+        if (s->outFile) {
+            s->outFileDataBytes = 0;
+            PsychPAOfflineWriteWAVHeader(s, 0);
+        }
+        else {
+            errmsg = "Could not create output file.";
+        }
+    }
+
+    PsychUnlockMutex(&s->mutex);
+
+    return(errmsg);
+}
+
+void PsychPAOfflineGetStats(PaStream* stream, PsychPAOfflineStats* stats)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+    double now;
+
+    PsychGetAdjustedPrecisionTimerSeconds(&now);
+
+    PsychLockMutex(&s->mutex);
+    *stats = s->stats;
+    stats->speed = s->speed;
+
+    // Include the current run of a still running driver thread:
+    if (s->active) stats->wallSecsTotal += now - s->tRunStart;
+    PsychUnlockMutex(&s->mutex);
+}
+
+PaError PsychPAStreamStart(PaStream* stream)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+    double now;
+
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_StartStream(stream));
+
+    if (!s->stopped) return(paStreamIsNotStopped);
+
+    // Virtual clock resyncs to system clock, unless it is already ahead of it:
+    PsychGetAdjustedPrecisionTimerSeconds(&now);
+    PsychLockMutex(&s->mutex);
+    if (s->stats.virtualTime < now) s->stats.virtualTime = now;
+    PsychUnlockMutex(&s->mutex);
+
+    s->stopRequest = 0;
+    s->stopped = 0;
+    s->active = 1;
+    if (PsychCreateThread(&s->thread, NULL, PsychPAOfflineThreadMain, (void*) s)) {
+        s->active = 0;
+        s->stopped = 1;
+        return(paInternalError);
+    }
+
+    return(paNoError);
+}
+
+static PaError PsychPAOfflineStopStream(PsychPAOfflineStream* s, int how)
+{
+    if (s->stopped) return(paStreamIsStopped);
+
+    // Request stop and wait for driver thread to finish its current callback and exit:
+    s->stopRequest = how;
+    PsychDeleteThread(&s->thread);
+    s->stopped = 1;
+
+    // Keep output file header up to date, so the file is valid even if the stream is never closed:
+    PsychLockMutex(&s->mutex);
+    if (s->outFile) PsychPAOfflineWriteWAVHeader(s, s->outFileDataBytes);
+    PsychUnlockMutex(&s->mutex);
+
+    return(paNoError);
+}
+
+PaError PsychPAStreamStop(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_StopStream(stream));
+
+    return(PsychPAOfflineStopStream((PsychPAOfflineStream*) stream, 1));
+}
+
+PaError PsychPAStreamAbort(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_AbortStream(stream));
+
+    return(PsychPAOfflineStopStream((PsychPAOfflineStream*) stream, 2));
+}
+
+PaError PsychPAStreamClose(PaStream* stream)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+    PsychPAOfflineStream** prev;
+
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_CloseStream(stream));
+
+    if (!s->stopped) PsychPAOfflineStopStream(s, 2);
+
+    // Dequeue:
+    for (prev = &offlineStreams; *prev != s; prev = &((*prev)->next));
+    *prev = s->next;
+
+    PsychPAOfflineCloseOutputFile(s);
+    PsychDestroyMutex(&s->mutex);
+    free(s->inBuffer);
+    free(s->outBuffer);
+    free(s);
+
+    return(paNoError);
+}
+
+PaError PsychPAStreamIsActive(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_IsStreamActive(stream));
+
+    return((((PsychPAOfflineStream*) stream)->active) ? 1 : 0);
+}
+
+PaError PsychPAStreamIsStopped(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_IsStreamStopped(stream));
+
+    return((((PsychPAOfflineStream*) stream)->stopped) ? 1 : 0);
+}
+
+double PsychPAStreamGetCpuLoad(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_GetStreamCpuLoad(stream));
+
+    return(((PsychPAOfflineStream*) stream)->cpuLoad);
+}
+
+const PaStreamInfo* PsychPAStreamGetInfo(PaStream* stream)
+{
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_GetStreamInfo(stream));
+
+    return(&(((PsychPAOfflineStream*) stream)->streamInfo));
+}
+
+PaError PsychPAStreamSetFinishedCallback(PaStream* stream, PaStreamFinishedCallback* streamFinishedCallback)
+{
+    PsychPAOfflineStream* s = (PsychPAOfflineStream*) stream;
+
+    if (!PsychPAIsOfflineStream(stream)) return(Pa_SetStreamFinishedCallback(stream, streamFinishedCallback));
+
+    if (!s->stopped) return(paStreamIsNotStopped);
+    s->finishedCallback = streamFinishedCallback;
+
+    return(paNoError);
+}
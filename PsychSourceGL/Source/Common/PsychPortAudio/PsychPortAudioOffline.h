@@ -0,0 +1,67 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioOffline.h
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Offline "virtual sound card" backend for PsychPortAudio. An offline stream mimics a
+        PortAudio callback stream, but without any audio hardware: A driver thread calls the
+        stream callback with synthetic PaStreamCallbackTimeInfo timestamps derived from a
+        virtual clock, either paced at a multiple of realtime or as fast as possible. Output
+        can be written to a WAV file and is looped back into the input for full-duplex streams.
+
+        The PsychPAStream... functions are drop-in replacements for the corresponding Pa_...
+        functions which work for both regular PortAudio streams and offline streams.
+*/
+
+//begin include once
+#ifndef PSYCH_IS_INCLUDED_PsychPortAudioOffline
+#define PSYCH_IS_INCLUDED_PsychPortAudioOffline
+
+#include "Psych.h"
+#include "PsychTimeGlue.h"
+#include "portaudio.h"
+
+// Pseudo host api type id of offline streams. Outside the range of PortAudio's PaHostApiTypeId:
+#define kPsychPAOfflineHostAPI ((PaHostApiTypeId) 1000)
+
+// Statistics of an offline stream:
+typedef struct PsychPAOfflineStats {
+    double          speed;              // Pacing: 0 = As fast as possible, otherwise multiple of realtime.
+    double          virtualTime;        // Current time of the virtual clock in seconds.
+    psych_uint64    callbacks;          // Total number of callback invocations.
+    psych_uint64    frames;             // Total number of sample frames processed.
+    psych_uint64    framesWritten;      // Total number of sample frames written to the output file.
+    double          callbackSecsTotal;  // Total cpu time spent in the callback.
+    double          callbackSecsMax;    // Maximum duration of a single callback invocation.
+    double          wallSecsTotal;      // Total realtime duration of running the stream.
+    psych_uint64    deadlineMisses;     // Number of callbacks started more than one buffer duration late while paced.
+} PsychPAOfflineStats;
+
+// Create an offline stream with the given parameters, calling 'callback' with 'userData':
+PaError PsychPAOfflineOpenStream(PaStream** stream, int inchannels, int outchannels, double sampleRate, unsigned long framesPerBuffer,
+                                 PaStreamCallback* callback, void* userData);
+// Is 'stream' an offline stream?
+psych_bool PsychPAIsOfflineStream(PaStream* stream);
+// Set pacing speed of offline stream: 0 = As fast as possible, > 0 = Multiple of realtime:
+void PsychPAOfflineSetSpeed(PaStream* stream, double speed);
+// Set output WAV file for stopped offline stream. NULL or empty name closes the current file.
+// Returns NULL on success, an error message otherwise:
+const char* PsychPAOfflineSetOutputFile(PaStream* stream, const char* filename);
+// Retrieve statistics of offline stream:
+void PsychPAOfflineGetStats(PaStream* stream, PsychPAOfflineStats* stats);
+
+// Replacements for Pa_... functions, which handle both offline and regular PortAudio streams:
+PaError PsychPAStreamStart(PaStream* stream);
+PaError PsychPAStreamStop(PaStream* stream);
+PaError PsychPAStreamAbort(PaStream* stream);
+PaError PsychPAStreamClose(PaStream* stream);
+PaError PsychPAStreamIsActive(PaStream* stream);
+PaError PsychPAStreamIsStopped(PaStream* stream);
+double  PsychPAStreamGetCpuLoad(PaStream* stream);
+const PaStreamInfo* PsychPAStreamGetInfo(PaStream* stream);
+PaError PsychPAStreamSetFinishedCallback(PaStream* stream, PaStreamFinishedCallback* streamFinishedCallback);
+
+//end include once
+#endif
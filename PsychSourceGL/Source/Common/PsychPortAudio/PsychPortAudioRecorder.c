@@ -0,0 +1,421 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioRecorder.c
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Streaming disk recorder for PsychPortAudio capture devices. See PsychPortAudioRecorder.h
+        for an overview.
+
+        Consistency model: The audio thread writes captured sample k into ring[k % ringsamples] and
+        then advances the capture position. The recorder copies a chunk of samples out of the ring
+        into its staging buffer, then queries the capture position again: If the audio thread got
+        more than one ring length ahead of the start of the chunk in the meantime, parts of the chunk
+        were overwritten during the copy, and the chunk is treated as lost. The capture position
+        reported to us can lag behind the true one by up to one audio callback, so the last 1/16th
+        of the ring is treated as guard band and counts as overflow already.
+
+        A new capture session restarts writing at the beginning of the ring. The rest of the previous
+        session, up to its final capture position, is still written out, as long as the audio thread
+        didn't overwrite it yet. For this, the audio thread publishes an upper bound of the part of
+        the ring it writes in the new session, before it writes there.
+
+        The WAV header reserves a JUNK chunk, which turns into a ds64 chunk of a RF64 file if the
+        recording exceeds the 4 GB limit of WAV files. The header is rewritten at each start of a
+        new capture session and at the end of recording, so the file is valid after each session.
+*/
+
+#include "PsychPortAudioRecorder.h"
+#include <ctype.h>
+
+// Minimum size of staging buffer and granularity of writes to file:
+#define PSYCH_PA_RECORDER_WRITEGRANULE (64 * 1024)
+
+// Size of WAV header: RIFF/WAVE, JUNK/ds64 chunk, fmt chunk and data chunk header:
+#define PSYCH_PA_RECORDER_WAVHEADERSIZE (12 + 36 + 24 + 8)
+
+struct PsychPARecorder {
+    FILE*                       file;               // Sound file.
+    FILE*                       stampFile;          // Timestamps sidecar file.
+    psych_bool                  wav;                // Write WAV file with header, instead of raw file.
+    psych_bool                  int16;              // Write 16 bit integer samples, instead of 32 bit float.
+    int                         channels;           // Number of interleaved channels.
+    double                      sampleRate;         // Sample rate in Hz.
+    const float*                ring;               // Capture ringbuffer of the device.
+    psych_int64                 ringsamples;        // Size of ringbuffer in samples.
+    psych_int64                 ringlimit;          // Maximum safe fill level of ringbuffer in samples, excluding the guard band.
+    void*                       staging;            // Staging buffer for conversion and writes to file.
+    psych_int64                 stagingsamples;     // Size of staging buffer in samples.
+    double                      chunkSecs;          // Drain interval in seconds.
+    PsychPARecorderPositionFunc getPosition;        // Query function for capture position.
+    void*                       userData;           // User data for 'getPosition'.
+    unsigned int                session;            // Capture session we are currently recording.
+    psych_int64                 readposition;       // Our read position in samples since start of 'session'.
+    psych_bool                  sessionLogged;      // Start of 'session' already logged to timestamps file?
+    psych_uint64                sessionStartFrame;  // File position of start of 'session' in sample frames.
+    psych_uint64                dataBytes;          // Bytes of sound data written to file so far.
+    PsychPARecorderStats        stats;              // Statistics.
+    psych_mutex                 mutex;              // Protects all of the above against concurrent draining.
+    PsychPARecorderStats        publishedStats;     // Copy of 'stats' after last drain, for PsychPARecorderGetStats().
+    psych_mutex                 statsMutex;         // Protects 'publishedStats', so queries never wait for file writes.
+    psych_condition             condition;          // Signalled to wake up the recorder thread for shutdown.
+    psych_thread                thread;             // Recorder thread.
+    volatile int                stopRequest;        // Recorder thread shall exit.
+};
+
+// Store 4 character code 'id' at 'p', return pointer behind it:
+static unsigned char* PsychPARecorderPutID(unsigned char* p, const char* id)
+{
+    memcpy(p, id, 4);
+    return(p + 4);
+}
+
+// Store 'value' as 'nbytes' bytes little endian integer at 'p', return pointer behind it:
+static unsigned char* PsychPARecorderPutLE(unsigned char* p, psych_uint64 value, int nbytes)
+{
+    int i;
+
+    for (i = 0; i < nbytes; i++) *(p++) = (unsigned char) ((value >> (8 * i)) & 0xff);
+    return(p);
+}
+
+// Write or rewrite WAV header for 'dataBytes' bytes of sound data, switch to RF64 if needed. The
+// file is unbuffered, so the header is assembled in memory and written with a single fwrite():
+static void PsychPARecorderWriteWAVHeader(PsychPARecorder* r)
+{
+    unsigned char header[PSYCH_PA_RECORDER_WAVHEADERSIZE];
+    unsigned char* p = header;
+    int bytesPerSample = (r->int16) ? 2 : 4;
+    int rate = (int) r->sampleRate;
+    psych_bool rf64 = (r->dataBytes + PSYCH_PA_RECORDER_WAVHEADERSIZE - 8 > 0xffffffff);
+
+    p = PsychPARecorderPutID(p, (rf64) ? "RF64" : "RIFF");
+    p = PsychPARecorderPutLE(p, (rf64) ? 0xffffffff : PSYCH_PA_RECORDER_WAVHEADERSIZE - 8 + r->dataBytes, 4);
+    p = PsychPARecorderPutID(p, "WAVE");
+
+    // Placeholder for, or actual ds64 chunk with 64 bit RIFF size, data size and sample count:
+    p = PsychPARecorderPutID(p, (rf64) ? "ds64" : "JUNK");
+    p = PsychPARecorderPutLE(p, 28, 4);
+    p = PsychPARecorderPutLE(p, (rf64) ? PSYCH_PA_RECORDER_WAVHEADERSIZE - 8 + r->dataBytes : 0, 8);
+    p = PsychPARecorderPutLE(p, (rf64) ? r->dataBytes : 0, 8);
+    p = PsychPARecorderPutLE(p, (rf64) ? r->dataBytes / (bytesPerSample * r->channels) : 0, 8);
+    p = PsychPARecorderPutLE(p, 0, 4);
+
+    p = PsychPARecorderPutID(p, "fmt ");
+    p = PsychPARecorderPutLE(p, 16, 4);
+    p = PsychPARecorderPutLE(p, (r->int16) ? 1 : 3, 2);           // WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT.
+    p = PsychPARecorderPutLE(p, r->channels, 2);
+    p = PsychPARecorderPutLE(p, rate, 4);
+    p = PsychPARecorderPutLE(p, (psych_uint64) rate * r->channels * bytesPerSample, 4);
+    p = PsychPARecorderPutLE(p, r->channels * bytesPerSample, 2);  // Block align.
+    p = PsychPARecorderPutLE(p, 8 * bytesPerSample, 2);            // Bits per sample.
+
+    p = PsychPARecorderPutID(p, "data");
+    p = PsychPARecorderPutLE(p, (rf64) ? 0xffffffff : r->dataBytes, 4);
+
+    fseek(r->file, 0, SEEK_SET);
+    if (fwrite(header, 1, sizeof(header), r->file) != sizeof(header)) r->stats.writeErrors++;
+    fseek(r->file, 0, SEEK_END);
+}
+
+// Write 'count' samples from the staging buffer to the file:
+static void PsychPARecorderWrite(PsychPARecorder* r, psych_int64 count)
+{
+    size_t bytes = (size_t) count * ((r->int16) ? sizeof(short) : sizeof(float));
+
+    if (fwrite(r->staging, 1, bytes, r->file) == bytes) {
+        r->dataBytes += bytes;
+    }
+    else {
+        r->stats.writeErrors++;
+    }
+
+    // Also count frames which failed to write, so positions in the timestamps file stay consistent:
+    r->stats.framesWritten += (psych_uint64) (count / r->channels);
+}
+
+// Write 'count' samples of silence for lost sound data, and log the gap:
+static void PsychPARecorderWriteSilence(PsychPARecorder* r, psych_int64 count)
+{
+    psych_int64 chunk;
+
+    if (r->stampFile) fprintf(r->stampFile, "gap,%lld,%lld\n", (long long) r->stats.framesWritten, (long long) (count / r->channels));
+    r->stats.overflows++;
+    r->stats.framesLost += (psych_uint64) (count / r->channels);
+
+    memset(r->staging, 0, (size_t) r->stagingsamples * ((r->int16) ? sizeof(short) : sizeof(float)));
+    while (count > 0) {
+        chunk = (count < r->stagingsamples) ? count : r->stagingsamples;
+        PsychPARecorderWrite(r, chunk);
+        count -= chunk;
+    }
+}
+
+// Copy 'count' samples starting at sample index 'start' out of the ring into the staging buffer, converting if needed:
+static void PsychPARecorderCopyFromRing(PsychPARecorder* r, psych_int64 start, psych_int64 count)
+{
+    psych_int64 i, index, chunk, done = 0;
+    short* dst;
+    float v;
+
+    while (done < count) {
+        index = (start + done) % r->ringsamples;
+        chunk = (count - done < r->ringsamples - index) ? count - done : r->ringsamples - index;
+
+        if (r->int16) {
+            dst = ((short*) r->staging) + done;
+            for (i = 0; i < chunk; i++) {
+                v = r->ring[index + i] * 32767.0f;
+                dst[i] = (short) ((v >= 32767.0f) ? 32767 : ((v <= -32768.0f) ? -32768 : ((v >= 0) ? (int) (v + 0.5f) : (int) (v - 0.5f))));
+            }
+        }
+        else {
+            memcpy(((float*) r->staging) + done, &(r->ring[index]), (size_t) chunk * sizeof(float));
+        }
+
+        done += chunk;
+    }
+}
+
+// Write sound data of the current session up to sample 'endposition'. If the session has 'ended', the
+// next session overwrites the ring from its beginning, so data is only intact behind its capture limit:
+static void PsychPARecorderDrainSession(PsychPARecorder* r, psych_int64 endposition, psych_bool ended)
+{
+    PsychPARecorderPosition pos;
+    psych_int64 avail, count, index;
+    psych_bool lost;
+    double fill;
+
+    // Only write complete sample frames:
+    avail = endposition - (endposition % r->channels) - r->readposition;
+
+    fill = (double) avail / (double) r->ringsamples;
+    if (fill > r->stats.maxFillLevel) r->stats.maxFillLevel = fill;
+
+    // Overflow? Replace what is lost by silence:
+    if (avail > r->ringlimit) {
+        count = avail - r->ringlimit;
+        count += (r->channels - (count % r->channels)) % r->channels;
+        PsychPARecorderWriteSilence(r, count);
+        r->readposition += count;
+        avail -= count;
+    }
+
+    while (avail > 0) {
+        count = (avail < r->stagingsamples) ? avail : r->stagingsamples;
+
+        // Chunks of an ended session must not wrap around to the beginning of the ring:
+        index = r->readposition % r->ringsamples;
+        if (ended && (count > r->ringsamples - index)) count = r->ringsamples - index;
+
+        PsychPARecorderCopyFromRing(r, r->readposition, count);
+
+        // Did the audio thread overwrite parts of the chunk while we copied it?
+        r->getPosition(r->userData, &pos);
+        if (ended) {
+            lost = (pos.limitsession != r->session + 1) || (pos.capturelimit > index);
+        }
+        else {
+            lost = (pos.session != r->session) || (pos.recposition - r->readposition > r->ringlimit);
+        }
+
+        if (lost) {
+            PsychPARecorderWriteSilence(r, count);
+        }
+        else {
+            PsychPARecorderWrite(r, count);
+        }
+
+        r->readposition += count;
+        avail -= count;
+    }
+}
+
+// Write all captured sound data which is not yet written. Must be called with r->mutex held:
+static void PsychPARecorderDrain(PsychPARecorder* r)
+{
+    PsychPARecorderPosition pos;
+
+    r->getPosition(r->userData, &pos);
+
+    // Start of a new capture session? Write out the rest of the previous one, if it was the one we
+    // recorded so far, then start reading at the beginning of the new one:
+    if (pos.session != r->session) {
+        if (pos.session == r->session + 1) PsychPARecorderDrainSession(r, pos.prevrecposition, TRUE);
+
+        r->session = pos.session;
+        r->readposition = 0;
+        r->sessionLogged = FALSE;
+        r->sessionStartFrame = r->stats.framesWritten;
+    }
+
+    // Log file position of session start, once its capture start time is known:
+    if (!r->sessionLogged && (pos.captureStartTime > 0)) {
+        if (r->stampFile) fprintf(r->stampFile, "start,%lld,%.9f\n", (long long) r->sessionStartFrame, pos.captureStartTime);
+        r->sessionLogged = TRUE;
+    }
+
+    PsychPARecorderDrainSession(r, pos.recposition, FALSE);
+
+    PsychLockMutex(&r->statsMutex);
+    r->publishedStats = r->stats;
+    PsychUnlockMutex(&r->statsMutex);
+}
+
+// Main routine of the recorder thread:
+static void* PsychPARecorderThreadMain(void* arg)
+{
+    PsychPARecorder* r = (PsychPARecorder*) arg;
+
+    PsychSetThreadName("PsychPARecorder");
+
+    PsychLockMutex(&r->mutex);
+    while (!r->stopRequest) {
+        PsychPARecorderDrain(r);
+
+        // Sleep until next drain, or until woken up for shutdown:
+        PsychTimedWaitCondition(&r->condition, &r->mutex, r->chunkSecs);
+    }
+    PsychUnlockMutex(&r->mutex);
+
+    return(NULL);
+}
+
+const char* PsychPARecorderCreate(PsychPARecorder** recorder, const char* filename, psych_bool int16, int channels, double sampleRate,
+                                  const float* ring, psych_int64 ringsamples, double chunkSecs,
+                                  PsychPARecorderPositionFunc getPosition, void* userData)
+{
+    PsychPARecorder* r;
+    PsychPARecorderPosition pos;
+    const char* ext;
+    const char* errmsg;
+    char* stampname;
+
+    *recorder = NULL;
+
+    if ((channels < 1) || (ringsamples < channels) || (NULL == ring)) return("Invalid capture buffer for recording.");
+
+    r = (PsychPARecorder*) calloc(1, sizeof(PsychPARecorder));
+    if (NULL == r) return("Out of memory.");
+
+    ext = strrchr(filename, '.');
+    r->wav = (ext && (strlen(ext) == 4) && (tolower(ext[1]) == 'w') && (tolower(ext[2]) == 'a') && (tolower(ext[3]) == 'v'));
+    r->int16 = (r->wav && int16) ? TRUE : FALSE;
+    r->channels = channels;
+    r->sampleRate = sampleRate;
+    r->ring = ring;
+    r->ringsamples = ringsamples;
+    r->ringlimit = ringsamples - ringsamples / 16;
+    r->ringlimit -= r->ringlimit % channels;
+    r->chunkSecs = (chunkSecs > 0) ? chunkSecs : 0.25;
+    r->getPosition = getPosition;
+    r->userData = userData;
+
+    // Staging buffer for one drain interval, in whole sample frames, at least one write granule:
+    r->stagingsamples = (psych_int64) (r->chunkSecs * sampleRate) * channels;
+    if (r->stagingsamples * (psych_int64) sizeof(float) < PSYCH_PA_RECORDER_WRITEGRANULE) r->stagingsamples = PSYCH_PA_RECORDER_WRITEGRANULE / sizeof(float);
+    if (r->stagingsamples > r->ringlimit) r->stagingsamples = r->ringlimit;
+    r->stagingsamples -= r->stagingsamples % channels;
+    r->staging = malloc((size_t) r->stagingsamples * sizeof(float));
+
+    r->file = fopen(filename, "wb");
+    stampname = (char*) malloc(strlen(filename) + 12);
+    if (stampname) {
+        sprintf(stampname, "%s.timestamps", filename);
+        r->stampFile = fopen(stampname, "w");
+        free(stampname);
+    }
+
+    if ((NULL == r->staging) || (NULL == r->file) || (NULL == r->stampFile)) {
+        errmsg = "Could not create sound file or timestamps file for recording.";
+        goto recorder_out_files;
+    }
+
+    if (PsychInitMutex(&r->mutex)) {
+        errmsg = "Could not create mutex for recorder.";
+        goto recorder_out_files;
+    }
+
+    if (PsychInitMutex(&r->statsMutex)) {
+        errmsg = "Could not create mutex for recorder.";
+        goto recorder_out_mutex;
+    }
+
+    if (PsychInitCondition(&r->condition, NULL)) {
+        errmsg = "Could not create condition variable for recorder.";
+        goto recorder_out_statsmutex;
+    }
+
+    // We write in big chunks from our own staging buffer, so no need for stdio buffering:
+    setvbuf(r->file, NULL, _IONBF, 0);
+
+    if (r->wav) PsychPARecorderWriteWAVHeader(r);
+    fprintf(r->stampFile, "# event,fileframe,value: start = capture start time of session in secs, gap = number of lost frames.\n");
+
+    // Start recording at the current capture position. The file doesn't start at the beginning
+    // of the current session, so only later sessions get logged:
+    getPosition(userData, &pos);
+    r->session = pos.session;
+    r->readposition = pos.recposition - (pos.recposition % channels);
+    r->sessionLogged = TRUE;
+
+    if (PsychCreateThread(&r->thread, NULL, PsychPARecorderThreadMain, (void*) r)) {
+        errmsg = "Could not create recorder thread.";
+        goto recorder_out_condition;
+    }
+
+    *recorder = r;
+    return(NULL);
+
+    // Error handling: Undo all initialization steps done so far, in reverse order:
+recorder_out_condition:
+    PsychDestroyCondition(&r->condition);
+recorder_out_statsmutex:
+    PsychDestroyMutex(&r->statsMutex);
+recorder_out_mutex:
+    PsychDestroyMutex(&r->mutex);
+recorder_out_files:
+    if (r->file) fclose(r->file);
+    if (r->stampFile) fclose(r->stampFile);
+    free(r->staging);
+    free(r);
+    return(errmsg);
+}
+
+void PsychPARecorderSync(PsychPARecorder* r)
+{
+    PsychLockMutex(&r->mutex);
+    PsychPARecorderDrain(r);
+    if (r->wav) PsychPARecorderWriteWAVHeader(r);
+    fflush(r->stampFile);
+    PsychUnlockMutex(&r->mutex);
+}
+
+void PsychPARecorderDestroy(PsychPARecorder* r)
+{
+    // Stop recorder thread:
+    PsychLockMutex(&r->mutex);
+    r->stopRequest = 1;
+    PsychSignalCondition(&r->condition);
+    PsychUnlockMutex(&r->mutex);
+    PsychDeleteThread(&r->thread);
+
+    // Final drain and header update:
+    PsychPARecorderSync(r);
+
+    fclose(r->file);
+    fclose(r->stampFile);
+    PsychDestroyCondition(&r->condition);
+    PsychDestroyMutex(&r->mutex);
+    PsychDestroyMutex(&r->statsMutex);
+    free(r->staging);
+    free(r);
+}
+
+void PsychPARecorderGetStats(PsychPARecorder* r, PsychPARecorderStats* stats)
+{
+    PsychLockMutex(&r->statsMutex);
+    *stats = r->publishedStats;
+    PsychUnlockMutex(&r->statsMutex);
+}
@@ -0,0 +1,69 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioRecorder.h
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Streaming disk recorder for PsychPortAudio capture devices. A recorder owns a background
+        thread which periodically drains the capture ringbuffer of a device into a sound file, so
+        recordings of unlimited length only need a capture buffer of a few seconds, and no calls to
+        'GetAudioData' by the script. The recorder keeps its own read position, independent of the
+        one of 'GetAudioData', and only reads the ringbuffer, so the audio thread never waits for it.
+
+        Sound data is written as 32 bit float or 16 bit integer WAV file, switching to RF64 for
+        files bigger than 4 GB, or as raw file of interleaved 32 bit float samples. A timestamps
+        sidecar file logs the file position and capture start time of each capture session, and
+        the position and length of gaps due to ringbuffer overflows. Lost sound data is replaced
+        by silence, so file positions always correspond to capture positions.
+*/
+
+//begin include once
+#ifndef PSYCH_IS_INCLUDED_PsychPortAudioRecorder
+#define PSYCH_IS_INCLUDED_PsychPortAudioRecorder
+
+#include "Psych.h"
+#include "PsychTimeGlue.h"
+
+// Capture state of a device, as queried by the recorder:
+typedef struct PsychPARecorderPosition {
+    psych_int64     recposition;        // Number of samples captured in the current capture session.
+    double          captureStartTime;   // Capture start time of the current session, or 0 if not yet known.
+    unsigned int    session;            // Capture session counter, incremented by each start of capture.
+    psych_int64     prevrecposition;    // Final number of samples captured in the previous capture session.
+    unsigned int    limitsession;       // Capture session of 'capturelimit', possibly newer than 'session'.
+    psych_int64     capturelimit;       // Upper bound of samples of 'limitsession' written to the ringbuffer so far.
+} PsychPARecorderPosition;
+
+// Query function for the capture state of a device. Called from the recorder thread:
+typedef void (*PsychPARecorderPositionFunc)(void* userData, PsychPARecorderPosition* position);
+
+// Statistics of a recorder:
+typedef struct PsychPARecorderStats {
+    psych_uint64    framesWritten;      // Sample frames written to the file, including silence for lost frames.
+    psych_uint64    overflows;          // Number of ringbuffer overflows, ie. of gaps in the recording.
+    psych_uint64    framesLost;         // Total number of sample frames lost due to overflows.
+    psych_uint64    writeErrors;        // Number of failed writes to the file.
+    double          maxFillLevel;       // Maximum observed fill level of the ringbuffer, 1.0 = full.
+} PsychPARecorderStats;
+
+typedef struct PsychPARecorder PsychPARecorder;
+
+// Start recording the capture ringbuffer 'ring' of 'ringsamples' samples of a device with 'channels' channels
+// into 'filename'. Files with extension .wav are WAV files, others raw files. 'int16' selects 16 bit integer
+// WAV files. The ringbuffer is drained every 'chunkSecs' seconds. Recording starts at the current capture
+// position. Returns NULL on success, an error message otherwise:
+const char* PsychPARecorderCreate(PsychPARecorder** recorder, const char* filename, psych_bool int16, int channels, double sampleRate,
+                                  const float* ring, psych_int64 ringsamples, double chunkSecs,
+                                  PsychPARecorderPositionFunc getPosition, void* userData);
+// Write all sound data captured so far and update the file header. Called after the capture position
+// got reset for a new capture session, without the device mutex held, to write out the rest of the
+// previous session before the new one overwrites it:
+void PsychPARecorderSync(PsychPARecorder* recorder);
+// Write all remaining sound data, stop the recorder thread and close the files:
+void PsychPARecorderDestroy(PsychPARecorder* recorder);
+// Retrieve statistics of recorder:
+void PsychPARecorderGetStats(PsychPARecorder* recorder, PsychPARecorderStats* stats);
+
+//end include once
+#endif
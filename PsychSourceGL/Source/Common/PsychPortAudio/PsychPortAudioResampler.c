@@ -0,0 +1,358 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioResampler.c
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Polyphase sample rate converter for PsychPortAudio. See PsychPortAudioResampler.h for
+        an overview.
+
+        Output frame j is the dot product of filter phase p = (j * M) mod L with the K input
+        frames n0 - K/2 + 1 ... n0 + K/2 around n0 = floor(j * M / L). The filters are Kaiser
+        windowed sinc lowpass filters with a cutoff just below the Nyquist frequency of the lower
+        of both sample rates, so upsampling suppresses the spectral images and downsampling the
+        aliases. For downsampling the filters get longer by M / L, to keep the same transition
+        band relative to the output rate. Each phase is normalized to unity DC gain.
+
+        Input samples are converted to float and deinterleaved into per channel history buffers
+        in blocks, so each dot product runs over contiguous memory.
+*/
+
+#include "PsychPortAudioResampler.h"
+#include "PsychPortAudioKernels.h"
+#include <math.h>
+
+// Number of filter taps for upsampling. Downsampling uses more, see above:
+#define kPsychPAResamplerTaps           128
+// Kaiser window parameter: About 100 dB stopband attenuation:
+#define kPsychPAResamplerBeta           10.0
+// Cutoff frequency relative to the Nyquist frequency of the lower sample rate:
+#define kPsychPAResamplerCutoff         0.95
+// Maximum upsampling factor L of the reduced ratio L/M and maximum downsampling ratio M/L:
+#define kPsychPAResamplerMaxPhases      4096
+#define kPsychPAResamplerMaxDecimation  8
+// Number of input frames converted and deinterleaved at once:
+#define kPsychPAResamplerBlockFrames    4096
+// Number of cached filter banks:
+#define kPsychPAResamplerCacheSize      8
+
+typedef struct PsychPAFilterBank {
+    psych_int64     L;          // Upsampling factor, ie. number of phases.
+    psych_int64     M;          // Downsampling factor.
+    psych_int64     K;          // Number of taps per phase.
+    int             refcount;   // Number of resamplers using this bank, -1 for an uncached bank.
+    float*          taps;       // L phases of K taps each.
+} PsychPAFilterBank;
+
+struct PsychPAResampler {
+    PsychPAFilterBank*  bank;
+    psych_int64         channels;
+    psych_int64         capacity;       // Capacity of history buffer of each channel in frames.
+    float*              history;        // History buffers of all channels, 'capacity' frames each.
+    float*              scratch;        // Interleaved float samples of one input block.
+    psych_int64         histStart;      // Input frame index of first frame in history buffers.
+    psych_int64         histFrames;     // Number of frames in history buffers.
+    psych_int64         inTotal;        // Number of input frames received since reset.
+    psych_int64         outCommitted;   // Number of final output frames produced since reset.
+    psych_int64         provisional;    // Number of provisional output frames of last call.
+};
+
+static PsychPAFilterBank bankCache[kPsychPAResamplerCacheSize];
+
+const char PsychPAResamplerOutOfMemory[] = "Out of memory for sample rate conversion.";
+
+// Modified Bessel function of first kind and order zero, for the Kaiser window:
+static double PsychPABesselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 50 && term > 1e-12 * sum; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return(sum);
+}
+
+static psych_int64 PsychPAGCD(psych_int64 a, psych_int64 b)
+{
+    psych_int64 t;
+
+    while (b) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return(a);
+}
+
+// Compute L phases of K taps each for ratio L/M into 'taps'. Returns FALSE if out of memory:
+static psych_bool PsychPAComputeFilterBank(float* taps, psych_int64 L, psych_int64 M, psych_int64 K)
+{
+    psych_int64 p, k, half = K / 2;
+    double cutoff = kPsychPAResamplerCutoff * ((L < M) ? (double) L / (double) M : 1.0);
+    double i0beta = PsychPABesselI0(kPsychPAResamplerBeta);
+    double d, x, h, sum;
+    double* phase = (double*) malloc((size_t) K * sizeof(double));
+
+    if (NULL == phase) return(FALSE);
+
+    for (p = 0; p < L; p++) {
+        sum = 0.0;
+        for (k = 0; k < K; k++) {
+            // Distance of output instant n0 + p/L from input frame n0 - half + 1 + k:
+            d = (double) (half - 1 - k) + (double) p / (double) L;
+            x = d / (double) half;
+            h = (d == 0.0) ? cutoff : sin(M_PI * cutoff * d) / (M_PI * d);
+            h *= (fabs(x) < 1.0) ? PsychPABesselI0(kPsychPAResamplerBeta * sqrt(1.0 - x * x)) / i0beta : 0.0;
+            phase[k] = h;
+            sum += h;
+        }
+
+        for (k = 0; k < K; k++) taps[p * K + k] = (float) (phase[k] / sum);
+    }
+
+    free(phase);
+
+    return(TRUE);
+}
+
+// Get filter bank for ratio L/M from cache, or compute it. Returns NULL if out of memory:
+static PsychPAFilterBank* PsychPAAcquireFilterBank(psych_int64 L, psych_int64 M)
+{
+    PsychPAFilterBank* bank = NULL;
+    psych_int64 K;
+    int i;
+
+    for (i = 0; i < kPsychPAResamplerCacheSize; i++) {
+        if (bankCache[i].taps && (bankCache[i].L == L) && (bankCache[i].M == M)) {
+            bankCache[i].refcount++;
+            return(&bankCache[i]);
+        }
+    }
+
+    // Longer filters for downsampling, rounded up to a multiple of 8 for the SIMD kernels:
+    K = (L < M) ? ((kPsychPAResamplerTaps * M + 8 * L - 1) / (8 * L)) * 8 : kPsychPAResamplerTaps;
+
+    // Use a free cache slot, or evict an unused bank. If all slots are in use, make an uncached bank:
+    for (i = 0; i < kPsychPAResamplerCacheSize && !bank; i++) {
+        if (bankCache[i].taps == NULL) bank = &bankCache[i];
+    }
+
+    for (i = 0; i < kPsychPAResamplerCacheSize && !bank; i++) {
+        if (bankCache[i].refcount == 0) {
+            free(bankCache[i].taps);
+            bankCache[i].taps = NULL;
+            bank = &bankCache[i];
+        }
+    }
+
+    if (bank) {
+        bank->refcount = 1;
+    }
+    else {
+        if (NULL == (bank = (PsychPAFilterBank*) calloc(1, sizeof(PsychPAFilterBank)))) return(NULL);
+        bank->refcount = -1;
+    }
+
+    if (NULL == (bank->taps = (float*) malloc((size_t) (L * K) * sizeof(float)))) {
+        if (bank->refcount < 0) free(bank);
+        return(NULL);
+    }
+
+    if (!PsychPAComputeFilterBank(bank->taps, L, M, K)) {
+        free(bank->taps);
+        bank->taps = NULL;
+        if (bank->refcount < 0) free(bank);
+        return(NULL);
+    }
+
+    bank->L = L;
+    bank->M = M;
+    bank->K = K;
+
+    return(bank);
+}
+
+static void PsychPAReleaseFilterBank(PsychPAFilterBank* bank)
+{
+    if (bank->refcount < 0) {
+        free(bank->taps);
+        free(bank);
+    }
+    else {
+        // Keep cached for reuse:
+        bank->refcount--;
+    }
+}
+
+void PsychPAResamplerShutdown(void)
+{
+    int i;
+
+    for (i = 0; i < kPsychPAResamplerCacheSize; i++) {
+        if (bankCache[i].taps && (bankCache[i].refcount == 0)) {
+            free(bankCache[i].taps);
+            bankCache[i].taps = NULL;
+        }
+    }
+}
+
+const char* PsychPAResamplerCreate(PsychPAResampler** resampler, psych_int64 channels, double inRate, double outRate)
+{
+    PsychPAResampler* r;
+    psych_int64 L, M, g;
+
+    *resampler = NULL;
+
+    L = (psych_int64) floor(outRate + 0.5);
+    M = (psych_int64) floor(inRate + 0.5);
+    if ((L < 1) || (M < 1)) return("Invalid sample rate for sample rate conversion.");
+
+    g = PsychPAGCD(L, M);
+    L /= g;
+    M /= g;
+
+    if (L > kPsychPAResamplerMaxPhases) return("Unsupported ratio of sample rates for sample rate conversion: Reduced ratio has too big numerator.");
+    if (M > kPsychPAResamplerMaxDecimation * L) return("Unsupported ratio of sample rates for sample rate conversion: Downsampling by more than a factor of 8.");
+
+    if (NULL == (r = (PsychPAResampler*) calloc(1, sizeof(PsychPAResampler)))) return(PsychPAResamplerOutOfMemory);
+
+    if (NULL == (r->bank = PsychPAAcquireFilterBank(L, M))) {
+        free(r);
+        return(PsychPAResamplerOutOfMemory);
+    }
+
+    // Room for one filter window plus slack of the last output, one input block, and zero padding:
+    r->channels = channels;
+    r->capacity = 2 * r->bank->K + kPsychPAResamplerMaxDecimation + kPsychPAResamplerBlockFrames;
+    r->history = (float*) malloc((size_t) (channels * r->capacity) * sizeof(float));
+    r->scratch = (float*) malloc((size_t) (channels * kPsychPAResamplerBlockFrames) * sizeof(float));
+    if ((NULL == r->history) || (NULL == r->scratch)) {
+        PsychPAResamplerDestroy(r);
+        return(PsychPAResamplerOutOfMemory);
+    }
+
+    PsychPAResamplerReset(r);
+    *resampler = r;
+
+    return(NULL);
+}
+
+void PsychPAResamplerDestroy(PsychPAResampler* resampler)
+{
+    if (NULL == resampler) return;
+
+    if (resampler->bank) PsychPAReleaseFilterBank(resampler->bank);
+    free(resampler->history);
+    free(resampler->scratch);
+    free(resampler);
+}
+
+void PsychPAResamplerReset(PsychPAResampler* resampler)
+{
+    psych_int64 c, half = resampler->bank->K / 2;
+
+    // Silence before start of stream, as history for the first output frames:
+    for (c = 0; c < resampler->channels; c++) memset(resampler->history + c * resampler->capacity, 0, (size_t) half * sizeof(float));
+
+    resampler->histStart = -half;
+    resampler->histFrames = half;
+    resampler->inTotal = 0;
+    resampler->outCommitted = 0;
+    resampler->provisional = 0;
+}
+
+// Return ceil(frames * L / M) for frames >= 0, or 0 for negative frames:
+static psych_int64 PsychPAResamplerOutputIndex(PsychPAResampler* resampler, psych_int64 frames)
+{
+    if (frames <= 0) return(0);
+    return((frames * resampler->bank->L + resampler->bank->M - 1) / resampler->bank->M);
+}
+
+psych_int64 PsychPAResamplerGetOutputFrames(PsychPAResampler* resampler, psych_int64 inFrames)
+{
+    return(PsychPAResamplerOutputIndex(resampler, resampler->inTotal + inFrames) - resampler->outCommitted);
+}
+
+psych_int64 PsychPAResamplerGetProvisionalFrames(PsychPAResampler* resampler)
+{
+    return(resampler->provisional);
+}
+
+// Compute output frames 'first' to 'last' - 1 into 'out' from the history buffers:
+static void PsychPAResamplerRun(PsychPAResampler* resampler, float* out, psych_int64 first, psych_int64 last)
+{
+    psych_int64 j, c, n0, phase, offset;
+    psych_int64 L = resampler->bank->L, M = resampler->bank->M, K = resampler->bank->K;
+    const float* taps;
+
+    for (j = first; j < last; j++) {
+        n0 = (j * M) / L;
+        phase = (j * M) - n0 * L;
+        taps = resampler->bank->taps + phase * K;
+        offset = n0 - K / 2 + 1 - resampler->histStart;
+
+        for (c = 0; c < resampler->channels; c++) {
+            *(out++) = PsychPADotProduct(taps, resampler->history + c * resampler->capacity + offset, K);
+        }
+    }
+}
+
+psych_int64 PsychPAResamplerProcess(PsychPAResampler* resampler, float* out, const void* in, int informat, float gain, psych_int64 inFrames)
+{
+    psych_int64 channels = resampler->channels, half = resampler->bank->K / 2;
+    psych_int64 block, c, i, keepFrom, shift, last, written = 0;
+    const char* src = (const char*) in;
+    float* history;
+
+    while (inFrames > 0) {
+        block = (inFrames < kPsychPAResamplerBlockFrames) ? inFrames : kPsychPAResamplerBlockFrames;
+
+        // Drop history no longer needed by the next output frame:
+        keepFrom = (resampler->outCommitted * resampler->bank->M) / resampler->bank->L - half + 1;
+        shift = keepFrom - resampler->histStart;
+        if (shift > resampler->histFrames) shift = resampler->histFrames;
+        if (shift > 0) {
+            for (c = 0; c < channels; c++) {
+                history = resampler->history + c * resampler->capacity;
+                memmove(history, history + shift, (size_t) (resampler->histFrames - shift) * sizeof(float));
+            }
+
+            resampler->histStart += shift;
+            resampler->histFrames -= shift;
+        }
+
+        // Convert to float, then deinterleave into history buffers:
+        PsychPAConvertSamples(resampler->scratch, src, informat, block * channels, gain);
+        for (c = 0; c < channels; c++) {
+            history = resampler->history + c * resampler->capacity + resampler->histFrames;
+            for (i = 0; i < block; i++) history[i] = resampler->scratch[i * channels + c];
+        }
+
+        resampler->histFrames += block;
+        resampler->inTotal += block;
+        src += block * channels * PsychPAGetSampleSize(informat);
+        inFrames -= block;
+
+        // Final output frames are those with full lookahead, ie. floor(j * M / L) + half <= inTotal - 1:
+        last = PsychPAResamplerOutputIndex(resampler, resampler->inTotal - half);
+        if (last > resampler->outCommitted) {
+            PsychPAResamplerRun(resampler, out + written * channels, resampler->outCommitted, last);
+            written += last - resampler->outCommitted;
+            resampler->outCommitted = last;
+        }
+    }
+
+    // Provisional output frames up to the end of the input, with silence as lookahead:
+    for (c = 0; c < channels; c++) memset(resampler->history + c * resampler->capacity + resampler->histFrames, 0, (size_t) half * sizeof(float));
+
+    last = PsychPAResamplerOutputIndex(resampler, resampler->inTotal);
+    PsychPAResamplerRun(resampler, out + written * channels, resampler->outCommitted, last);
+    resampler->provisional = last - resampler->outCommitted;
+
+    return(written + resampler->provisional);
+}
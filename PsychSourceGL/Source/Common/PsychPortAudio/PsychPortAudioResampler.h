@@ -0,0 +1,53 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioResampler.h
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Polyphase sample rate converter for sound data provided at a different sample rate than
+        the one of the audio device. Converts between integer sample rates with a rational ratio
+        L/M, upsampling by L and downsampling by M, via a bank of L windowed sinc FIR filters of
+        K taps each. Filter banks are computed once per ratio and cached, the filters run on the
+        SIMD dot product kernel of PsychPortAudioKernels.
+
+        The filters are zero phase, ie. output frame j corresponds exactly to input time j * M / L,
+        without any delay, so sound onset timing is the same as for sound data at the device rate.
+        Conversion of 'n' input frames yields ceil(n * L / M) output frames. Each output frame needs
+        K/2 input frames of lookahead, so the trailing output frames of a conversion are computed as
+        if the input ended there. For streaming, those 'provisional' frames are recomputed with the
+        real continuation of the input by the next conversion, see PsychPAResamplerProcess().
+*/
+
+//begin include once
+#ifndef PSYCH_IS_INCLUDED_PsychPortAudioResampler
+#define PSYCH_IS_INCLUDED_PsychPortAudioResampler
+
+#include "Psych.h"
+
+typedef struct PsychPAResampler PsychPAResampler;
+
+// Error message returned by PsychPAResamplerCreate() if it ran out of memory:
+extern const char PsychPAResamplerOutOfMemory[];
+
+// Create resampler for 'channels' channels from 'inRate' to 'outRate' Hz. Rates are rounded to
+// integer Hz. Returns NULL on success, an error message otherwise:
+const char* PsychPAResamplerCreate(PsychPAResampler** resampler, psych_int64 channels, double inRate, double outRate);
+// Destroy resampler:
+void PsychPAResamplerDestroy(PsychPAResampler* resampler);
+// Reset resampler to the start of a new stream, with silence as history:
+void PsychPAResamplerReset(PsychPAResampler* resampler);
+// Return number of output frames the next PsychPAResamplerProcess() of 'inFrames' input frames will write:
+psych_int64 PsychPAResamplerGetOutputFrames(PsychPAResampler* resampler, psych_int64 inFrames);
+// Return number of provisional output frames at the end of the last PsychPAResamplerProcess():
+psych_int64 PsychPAResamplerGetProvisionalFrames(PsychPAResampler* resampler);
+// Convert 'inFrames' frames of interleaved samples 'in' of sample format 'informat', multiplied by 'gain', into
+// interleaved float samples in 'out'. Writes PsychPAResamplerGetOutputFrames() frames and returns their number.
+// The first written frame replaces the first provisional frame of the previous call, so when appending the
+// output to the output of the previous call, rewind by PsychPAResamplerGetProvisionalFrames() beforehand:
+psych_int64 PsychPAResamplerProcess(PsychPAResampler* resampler, float* out, const void* in, int informat, float gain, psych_int64 inFrames);
+// Release all cached filter banks which are not in use by a resampler:
+void PsychPAResamplerShutdown(void);
+
+//end include once
+#endif
@@ -0,0 +1,188 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioSoundFile.c
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Memory mapped sound files as sources for PsychPortAudio audio buffers. See
+        PsychPortAudioSoundFile.h for an overview.
+
+        Files are mapped private and copy-on-write, so 'RefillBuffer' on a buffer backed
+        by a file modifies the buffer, but never the file itself.
+*/
+
+#include "PsychPortAudioSoundFile.h"
+
+#if PSYCH_SYSTEM != PSYCH_WINDOWS
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Read little endian unsigned integer of 'nbytes' bytes at 'p':
+static psych_int64 PsychPAGetLE(const unsigned char* p, int nbytes)
+{
+    psych_int64 value = 0;
+
+    while (nbytes > 0) value = (value << 8) | p[--nbytes];
+
+    return(value);
+}
+
+static const char* PsychPAMapFile(const char* filename, void** mapping, size_t* mappingsize)
+{
+    #if PSYCH_SYSTEM == PSYCH_WINDOWS
+    HANDLE file, filemapping;
+    LARGE_INTEGER size;
+
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return("Could not open sound file.");
+
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0) || ((ULONGLONG) size.QuadPart > (ULONGLONG) ((size_t) -1))) {
+        CloseHandle(file);
+        return("Sound file is empty or too big to map.");
+    }
+
+    // The view keeps the mapping alive, so we can close both handles right away:
+    filemapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    *mapping = (filemapping) ? MapViewOfFile(filemapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (filemapping) CloseHandle(filemapping);
+    CloseHandle(file);
+
+    if (NULL == *mapping) return("Could not map sound file into memory.");
+    *mappingsize = (size_t) size.QuadPart;
+    #else
+    struct stat st;
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) return("Could not open sound file.");
+
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0) || ((psych_uint64) st.st_size > (psych_uint64) ((size_t) -1))) {
+        close(fd);
+        return("Sound file is empty or too big to map.");
+    }
+
+    // The mapping stays valid after close() of the file descriptor:
+    *mapping = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (*mapping == MAP_FAILED) {
+        *mapping = NULL;
+        return("Could not map sound file into memory.");
+    }
+
+    *mappingsize = (size_t) st.st_size;
+
+    // Sound data is usually played front to back, so ask for aggressive read-ahead:
+    madvise(*mapping, *mappingsize, MADV_SEQUENTIAL);
+    #endif
+
+    return(NULL);
+}
+
+void PsychPAUnmapSoundFile(void* mapping, size_t mappingsize)
+{
+    if (NULL == mapping) return;
+
+    #if PSYCH_SYSTEM == PSYCH_WINDOWS
+    UnmapViewOfFile(mapping);
+    #else
+    munmap(mapping, mappingsize);
+    #endif
+}
+
+// Parse RIFF/WAVE header of mapped 'file'. Returns NULL on success, an error message otherwise:
+static const char* PsychPAParseWAV(PsychPASoundFile* file)
+{
+    const unsigned char* base = (const unsigned char*) file->mapping;
+    const unsigned char* fmt = NULL;
+    size_t pos = 12, chunksize, fmtsize = 0, datasize = 0, dataoffset = 0;
+    int formattag, bits;
+
+    // Walk the chunks, find 'fmt ' and 'data':
+    while (pos + 8 <= file->mappingsize) {
+        chunksize = (size_t) PsychPAGetLE(base + pos + 4, 4);
+
+        if (memcmp(base + pos, "fmt ", 4) == 0) {
+            if ((chunksize < 16) || (pos + 8 + chunksize > file->mappingsize)) return("Corrupt WAV file format chunk.");
+            fmt = base + pos + 8;
+            fmtsize = chunksize;
+        }
+
+        if (memcmp(base + pos, "data", 4) == 0) {
+            dataoffset = pos + 8;
+            // Truncated files are common after crashed recordings, so clamp to what is there:
+            datasize = (dataoffset + chunksize > file->mappingsize) ? file->mappingsize - dataoffset : chunksize;
+            break;
+        }
+
+        // Chunks are padded to even size:
+        pos += 8 + chunksize + (chunksize & 1);
+    }
+
+    if ((NULL == fmt) || (0 == dataoffset)) return("WAV file lacks format or data chunk.");
+
+    formattag = (int) PsychPAGetLE(fmt, 2);
+    file->channels = PsychPAGetLE(fmt + 2, 2);
+    file->sampleRate = (double) PsychPAGetLE(fmt + 4, 4);
+    bits = (int) PsychPAGetLE(fmt + 14, 2);
+
+    // WAVE_FORMAT_EXTENSIBLE: Real format tag is the start of the subformat GUID, which ends the 40 byte chunk:
+    if (formattag == 0xFFFE) {
+        if ((fmtsize < 40) || (PsychPAGetLE(fmt + 16, 2) < 22)) return("Corrupt WAV file format chunk.");
+        formattag = (int) PsychPAGetLE(fmt + 24, 2);
+    }
+
+    if ((formattag == 3) && (bits == 32)) {
+        file->format = kPsychPASampleFloat32;
+    }
+    else if ((formattag == 1) && (bits == 16)) {
+        file->format = kPsychPASampleInt16;
+    }
+    else {
+        return("Unsupported WAV sample format. Only 32 bit floating point and 16 bit integer samples are supported.");
+    }
+
+    if (file->channels < 1) return("WAV file with invalid number of channels.");
+
+    file->samples = (const void*) (base + dataoffset);
+    file->frames = (psych_int64) (datasize / ((size_t) file->channels * PsychPAGetSampleSize(file->format)));
+
+    return(NULL);
+}
+
+const char* PsychPAMapSoundFile(const char* filename, psych_int64 rawChannels, PsychPASoundFile* file)
+{
+    const char* errmsg;
+
+    memset(file, 0, sizeof(PsychPASoundFile));
+
+    if ((errmsg = PsychPAMapFile(filename, &file->mapping, &file->mappingsize)) != NULL) return(errmsg);
+
+    if ((file->mappingsize >= 12) && (memcmp(file->mapping, "RIFF", 4) == 0) && (memcmp((const char*) file->mapping + 8, "WAVE", 4) == 0)) {
+        errmsg = PsychPAParseWAV(file);
+    }
+    else if (rawChannels > 0) {
+        // Raw file of interleaved float samples:
+        file->samples = file->mapping;
+        file->format = kPsychPASampleFloat32;
+        file->channels = rawChannels;
+        file->frames = (psych_int64) (file->mappingsize / ((size_t) rawChannels * sizeof(float)));
+    }
+    else {
+        errmsg = "Sound file is not a WAV file, and the number of channels of raw sound data is unknown.";
+    }
+
+    if ((NULL == errmsg) && (file->frames < 1)) errmsg = "Sound file doesn't contain any sound data.";
+
+    if (errmsg) {
+        PsychPAUnmapSoundFile(file->mapping, file->mappingsize);
+        memset(file, 0, sizeof(PsychPASoundFile));
+    }
+
+    return(errmsg);
+}
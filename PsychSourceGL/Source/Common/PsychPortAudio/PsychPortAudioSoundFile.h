@@ -0,0 +1,40 @@
+/*
+        PsychToolbox3/Source/Common/PsychPortAudio/PsychPortAudioSoundFile.h
+
+        PLATFORMS:    All
+
+        DESCRIPTION:
+
+        Memory mapped sound files as sources for PsychPortAudio audio buffers. A WAV file with
+        32 bit floating point samples, or a raw file of interleaved 32 bit floating point samples,
+        can be used directly as the sample memory of an audio buffer, so the operating system
+        pages the sound data in on demand instead of us copying the whole file. WAV files with
+        16 bit integer samples are also mapped, but need conversion into float by the caller.
+*/
+
+//begin include once
+#ifndef PSYCH_IS_INCLUDED_PsychPortAudioSoundFile
+#define PSYCH_IS_INCLUDED_PsychPortAudioSoundFile
+
+#include "Psych.h"
+#include "PsychPortAudioKernels.h"
+
+// A mapped sound file:
+typedef struct PsychPASoundFile {
+    void*           mapping;        // Base address of the private, copy-on-write file mapping.
+    size_t          mappingsize;    // Size of the mapping in bytes.
+    const void*     samples;        // Start of interleaved sample data inside the mapping.
+    int             format;         // Sample format of 'samples': kPsychPASampleFloat32 or kPsychPASampleInt16.
+    psych_int64     channels;       // Number of interleaved channels.
+    psych_int64     frames;         // Number of sample frames.
+    double          sampleRate;     // Sample rate in Hz of WAV files, 0 for raw files.
+} PsychPASoundFile;
+
+// Map sound file 'filename'. Files which don't start with a RIFF/WAVE header are treated as raw files
+// of 32 bit float samples with 'rawChannels' channels. Returns NULL on success, an error message otherwise:
+const char* PsychPAMapSoundFile(const char* filename, psych_int64 rawChannels, PsychPASoundFile* file);
+// Release a mapping established by PsychPAMapSoundFile():
+void PsychPAUnmapSoundFile(void* mapping, size_t mappingsize);
+
+//end include once
+#endif
@@ -58,6 +58,8 @@ PsychError PsychModuleInit(void)
     PsychErrorExit(PsychRegister("SetOpMode", &PSYCHPORTAUDIOSetOpMode));
     PsychErrorExit(PsychRegister("DirectInputMonitoring", &PSYCHPORTAUDIODirectInputMonitoring));
     PsychErrorExit(PsychRegister("Volume", &PSYCHPORTAUDIOVolume));
+    PsychErrorExit(PsychRegister("OfflineSettings", &PSYCHPORTAUDIOOfflineSettings));
+    PsychErrorExit(PsychRegister("RecordToFile", &PSYCHPORTAUDIORecordToFile));
 
     // Setup synopsis help strings:
     InitializeSynopsis();   //Scripting glue won't require this if the function takes no arguments.
@@ -0,0 +1,270 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychDeferredDrawing.c
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Recording and batched execution of drawing commands in deferred drawing mode. See
+		PsychDeferredDrawing.h for an overview.
+
+		Commands are executed in the order they were recorded, because the result of drawing
+		overlapping primitives depends on it, e.g., with alpha blending. Runs of consecutive
+		rects, lines of equal width, or textures drawn from the same texture - or from the
+		same page of the texture pool - with the same filterMode are drawn as one batch each: Rects and lines as vertex arrays with per
+		vertex colors, sourced from the streaming vertex buffer of the window if possible,
+		textures via the batch blitter PsychBatchBlitTexturesToDisplay(), which is also used by
+		Screen('DrawTextures').
+*/
+
+#include "Screen.h"
+
+// The window with pending commands, or NULL if there aren't any:
+static PsychWindowRecordType *pendingWindow = NULL;
+
+/* PsychIsDeferredDrawingActive()
+ *
+ * Returns TRUE if drawing commands for 'windowRecord' should be recorded for deferred execution.
+ * Commands are drawn immediately in the usual way if deferred drawing isn't enabled for the window,
+ * or if immediate drawing is needed for some other reason: Single buffered drawing in EmulateOldPTB
+ * mode, userspace OpenGL rendering or async flips in progress, where the usual checks in drawing
+ * target switches must error-abort the drawing command which causes the error.
+ */
+psych_bool PsychIsDeferredDrawingActive(PsychWindowRecordType *windowRecord)
+{
+    PsychWindowRecordType *parentRecord;
+
+    if (!windowRecord->deferredDrawing || !PsychIsMasterThread() || PsychIsUserspaceRendering() || PsychPrefStateGet_EmulateOldPTB()) return(FALSE);
+
+    parentRecord = PsychGetParentWindow(windowRecord);
+    if (parentRecord->flipInfo && (parentRecord->flipInfo->asyncstate != 0)) return(FALSE);
+
+    return(TRUE);
+}
+
+/* PsychAddDeferredDrawCommand()
+ *
+ * Append a new command of 'type' to the pending commands of 'windowRecord' and return it. The command
+ * is zero-initialized, except for its type. Caller must validate all parameters before calling this,
+ * so a command is either completely recorded or not at all.
+ */
+PsychDeferredDrawCommand* PsychAddDeferredDrawCommand(PsychWindowRecordType *windowRecord, int type)
+{
+    PsychDeferredDrawCommand *cmd;
+    int capacity;
+
+    // Only one window can have pending commands. Execute commands of other windows first, as well as
+    // our own commands if the list is full:
+    if ((pendingWindow && (pendingWindow != windowRecord)) || (windowRecord->deferredCount >= kPsychMaxDeferredCommands)) PsychFlushDeferredDrawing();
+
+    if (windowRecord->deferredCount >= windowRecord->deferredCapacity) {
+        capacity = (windowRecord->deferredCapacity > 0) ? windowRecord->deferredCapacity * 2 : 256;
+        cmd = (PsychDeferredDrawCommand*) realloc(windowRecord->deferredCommands, (size_t) capacity * sizeof(PsychDeferredDrawCommand));
+        if (NULL == cmd) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory while recording a drawing command in deferred drawing mode!");
+
+        windowRecord->deferredCommands = cmd;
+        windowRecord->deferredCapacity = capacity;
+    }
+
+    cmd = &(windowRecord->deferredCommands[windowRecord->deferredCount++]);
+    memset(cmd, 0, sizeof(PsychDeferredDrawCommand));
+    cmd->type = type;
+
+    pendingWindow = windowRecord;
+
+    return(cmd);
+}
+
+/* Can command 'b' be drawn in the same batch as command 'a'? */
+static psych_bool PsychCanBatchDeferredCommands(PsychDeferredDrawCommand *a, PsychDeferredDrawCommand *b)
+{
+    if (a->type != b->type) return(FALSE);
+
+    switch (a->type) {
+        case kPsychDeferredDrawLine:
+            return(a->param == b->param);
+
+        case kPsychDeferredDrawTexture:
+            return(PsychCanBatchBlitTextures(a->source, b->source) && (a->filterMode == b->filterMode));
+    }
+
+    return(TRUE);
+}
+
+/* Draw 'count' rect or line commands 'cmds' as one batch of primitives 'mode', GL_QUADS or GL_LINES, with per vertex colors: */
+static void PsychDrawDeferredPrimitives(PsychWindowRecordType *windowRecord, PsychDeferredDrawCommand *cmds, int count, GLenum mode)
+{
+    int             nverts = (mode == GL_QUADS) ? 4 : 2;
+    size_t          xybytes = (size_t) count * nverts * 2 * sizeof(double);
+    size_t          colorbytes = (size_t) count * nverts * 4 * sizeof(double);
+    double          *xy, *colors, *r;
+    const GLvoid    *xyptr, *colorptr;
+    psych_bool      streamed;
+    int             i, j;
+
+    xy = (double*) PsychMallocTemp(xybytes);
+    colors = (double*) PsychMallocTemp(colorbytes);
+
+    for (i = 0; i < count; i++) {
+        r = cmds[i].rect;
+        if (mode == GL_QUADS) {
+            // The 4 vertices of each rect, in the same order as glRectd():
+            xy[i*8 + 0] = r[kPsychLeft];  xy[i*8 + 1] = r[kPsychTop];
+            xy[i*8 + 2] = r[kPsychRight]; xy[i*8 + 3] = r[kPsychTop];
+            xy[i*8 + 4] = r[kPsychRight]; xy[i*8 + 5] = r[kPsychBottom];
+            xy[i*8 + 6] = r[kPsychLeft];  xy[i*8 + 7] = r[kPsychBottom];
+        }
+        else {
+            // Start and end point of each line:
+            memcpy(&xy[i*4], r, 4 * sizeof(double));
+        }
+
+        for (j = 0; j < nverts; j++) memcpy(&colors[(i * nverts + j) * 4], cmds[i].color, 4 * sizeof(double));
+    }
+
+    PsychSetShader(windowRecord, -1);
+    if (mode == GL_LINES) glLineWidth((GLfloat) cmds[0].param);
+
+    streamed = PsychVertexStreamBegin(windowRecord, xybytes + colorbytes);
+    if (streamed) {
+        xyptr = PsychVertexStreamPush(windowRecord, xy, xybytes);
+        colorptr = PsychVertexStreamPush(windowRecord, colors, colorbytes);
+    }
+    else {
+        xyptr = xy;
+        colorptr = colors;
+    }
+
+    PsychSetupVertexColorArrays(windowRecord, TRUE, 4, (double*) colorptr, NULL);
+    glVertexPointer(2, GL_DOUBLE, 0, xyptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    if (streamed) PsychVertexStreamEnd(windowRecord);
+
+    glDrawArrays(mode, 0, count * nverts);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_DOUBLE, 0, NULL);
+    PsychSetupVertexColorArrays(windowRecord, FALSE, 0, NULL, NULL);
+
+    if (mode == GL_LINES) glLineWidth((GLfloat) 1);
+
+    // Leave color of last primitive as current color, as immediate drawing would:
+    memcpy(windowRecord->currentColor, cmds[count - 1].color, 4 * sizeof(double));
+}
+
+/* Draw 'count' texture commands 'cmds', all with the same texture or texture pool page and filterMode, as one batch: */
+static void PsychDrawDeferredTextures(PsychWindowRecordType *windowRecord, PsychDeferredDrawCommand *cmds, int count)
+{
+    int i;
+
+    PsychBatchBlitTexturesToDisplay(0, count, cmds[0].source, windowRecord, NULL, NULL, 0, cmds[0].filterMode, 1.0);
+
+    for (i = 0; i < count; i++) {
+        // The batch blitter takes the modulateColor from the current color:
+        if (cmds[i].globalAlpha == DBL_MAX) memcpy(windowRecord->currentColor, cmds[i].color, 4 * sizeof(double));
+        PsychBatchBlitTexturesToDisplay(2, count, cmds[i].source, windowRecord, cmds[i].srcRect, cmds[i].rect, cmds[i].param, cmds[i].filterMode, cmds[i].globalAlpha);
+    }
+
+    PsychBatchBlitTexturesToDisplay(1, count, cmds[0].source, windowRecord, NULL, NULL, 0, cmds[0].filterMode, 1.0);
+}
+
+/* PsychFlushDeferredDrawing()
+ *
+ * Execute all pending commands, if any. Called whenever the drawing target or OpenGL context gets
+ * switched, so any drawing into or readback from any window sees the result of all commands
+ * recorded before, and at Flip time. This is a no-op if there aren't any pending commands.
+ */
+void PsychFlushDeferredDrawing(void)
+{
+    PsychWindowRecordType       *windowRecord = pendingWindow;
+    PsychDeferredDrawCommand    *cmds;
+    int                         count, i, j;
+
+    if ((NULL == windowRecord) || !PsychIsMasterThread()) return;
+
+    // Take the commands off the list first, so the drawing target switch below doesn't recurse
+    // into us, and an error abort during execution doesn't leave stale commands behind:
+    pendingWindow = NULL;
+    cmds = windowRecord->deferredCommands;
+    count = windowRecord->deferredCount;
+    windowRecord->deferredCount = 0;
+
+    PsychSetDrawingTarget(windowRecord);
+    PsychUpdateAlphaBlendingFactorLazily(windowRecord);
+
+    for (i = 0; i < count; i = j) {
+        // Find run of commands which can be drawn as one batch:
+        for (j = i + 1; (j < count) && PsychCanBatchDeferredCommands(&cmds[i], &cmds[j]); j++);
+
+        switch (cmds[i].type) {
+            case kPsychDeferredFillRect:
+                PsychDrawDeferredPrimitives(windowRecord, &cmds[i], j - i, GL_QUADS);
+                break;
+
+            case kPsychDeferredDrawLine:
+                PsychDrawDeferredPrimitives(windowRecord, &cmds[i], j - i, GL_LINES);
+                break;
+
+            case kPsychDeferredDrawTexture:
+                PsychDrawDeferredTextures(windowRecord, &cmds[i], j - i);
+                break;
+
+            default:
+                PsychErrorExitMsg(PsychError_internal, "Unknown type of deferred drawing command!");
+        }
+    }
+
+    // Mark end of drawing op. This is needed for single buffered drawing:
+    PsychFlushGL(windowRecord);
+}
+
+/* PsychSetDeferredDrawing()
+ *
+ * Enable or disable deferred drawing mode for 'windowRecord'. Disabling executes pending commands.
+ * Deferred drawing is only supported on classic desktop OpenGL, and silently stays disabled elsewhere.
+ */
+void PsychSetDeferredDrawing(PsychWindowRecordType *windowRecord, psych_bool enable)
+{
+    if (enable) {
+        if (!PsychIsGLClassic(windowRecord)) {
+            if (PsychPrefStateGet_Verbosity() > 2) printf("PTB-INFO: Screen('DeferredDrawing') is not supported on OpenGL-ES. Drawing commands will be executed immediately.\n");
+            return;
+        }
+
+        // Line widths are validated at recording time, without access to OpenGL:
+        PsychSetGLContext(windowRecord);
+        glGetFloatv(GL_LINE_WIDTH_RANGE, windowRecord->lineWidthRange);
+        windowRecord->deferredDrawing = TRUE;
+    }
+    else {
+        if (pendingWindow == windowRecord) PsychFlushDeferredDrawing();
+        windowRecord->deferredDrawing = FALSE;
+    }
+}
+
+/* PsychReleaseDeferredDrawing()
+ *
+ * Called at close of 'windowRecord'. Discards pending commands for drawing into the window or any of
+ * its offscreen windows and textures if it is an onscreen window, or executes pending commands for
+ * other windows, as they may draw the window as texture.
+ */
+void PsychReleaseDeferredDrawing(PsychWindowRecordType *windowRecord)
+{
+    if (pendingWindow) {
+        if ((pendingWindow == windowRecord) || (PsychGetParentWindow(pendingWindow) == windowRecord)) {
+            pendingWindow->deferredCount = 0;
+            pendingWindow = NULL;
+        }
+        else {
+            PsychFlushDeferredDrawing();
+        }
+    }
+
+    free(windowRecord->deferredCommands);
+    windowRecord->deferredCommands = NULL;
+    windowRecord->deferredCount = 0;
+    windowRecord->deferredCapacity = 0;
+    windowRecord->deferredDrawing = FALSE;
+}
@@ -0,0 +1,44 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychDeferredDrawing.h
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Deferred drawing mode of Screen('DeferredDrawing'): Instead of drawing immediately,
+		Screen('FillRect'), Screen('DrawLine') and Screen('DrawTexture') append a compact
+		command to a list in the window record of their target window. The list is executed
+		later in one go, with consecutive commands of the same kind and state merged into one
+		batch, so a frame of many small primitives pays the cost of drawing target switches,
+		shader and blend state validation once per batch instead of once per primitive.
+
+		At most one window has pending commands at any time. They are executed before any
+		other drawing into or readback from any window, i.e., whenever the drawing target or
+		the OpenGL context gets switched, and at Screen('DrawingFinished') and Screen('Flip').
+*/
+
+//include once
+#ifndef PSYCH_IS_INCLUDED_PsychDeferredDrawing
+#define PSYCH_IS_INCLUDED_PsychDeferredDrawing
+
+#include "Screen.h"
+
+// Can drawing commands for 'windowRecord' be recorded for deferred execution at the moment?
+psych_bool PsychIsDeferredDrawingActive(PsychWindowRecordType *windowRecord);
+
+// Append a new command of 'type' to the pending commands of 'windowRecord' and return it for filling in:
+PsychDeferredDrawCommand* PsychAddDeferredDrawCommand(PsychWindowRecordType *windowRecord, int type);
+
+// Execute all pending commands, if any:
+void PsychFlushDeferredDrawing(void);
+
+// Enable or disable deferred drawing mode for 'windowRecord':
+void PsychSetDeferredDrawing(PsychWindowRecordType *windowRecord, psych_bool enable);
+
+// Release all deferred drawing ressources of 'windowRecord' at window close:
+void PsychReleaseDeferredDrawing(PsychWindowRecordType *windowRecord);
+
+//end include once
+#endif
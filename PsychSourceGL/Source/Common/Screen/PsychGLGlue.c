@@ -393,6 +393,71 @@ GLdouble *PsychExtractQuadVertexFromRect(double *rect, int vertexNumber, GLdoubl
     return(vertex);
 }
 
+/* PsychAllocInVertexAttribArg()
+ *
+ * Helper for PsychPrepareRenderBatch(): Alloc-in a mandatory matrix of vertex attributes at 'position'.
+ * If 'gltype' is non-NULL and the matrix is of one of the types in 'nativeTypes', or double on desktop
+ * OpenGL, then the matrix is returned as is, without any conversion or copy, and *gltype is set to the
+ * OpenGL data type of the matrix, for direct use in gl*Pointer() calls. uint16 matrices are converted
+ * into a temporary float matrix, as GL_UNSIGNED_SHORT is not a valid type for glVertexPointer().
+ * Otherwise the matrix is taken as double matrix, or as float matrix if 'usefloat' is set, e.g., for
+ * OpenGL-ES, converted from double if needed.
+ */
+static void PsychAllocInVertexAttribArg(int position, psych_bool usefloat, PsychArgFormatType nativeTypes, int *m, int *n, int *p, void **array, GLenum *gltype)
+{
+    psych_int64 mb, nb, pb, i;
+    PsychArgFormatType type;
+    psych_uint16 *arrayU;
+    float *arrayF;
+
+    if (gltype) {
+        if (!usefloat) nativeTypes |= PsychArgType_double;
+        nativeTypes |= PsychArgType_uint16;
+
+        if (PsychAllocInNumericMatArg64(position, kPsychArgAnything, nativeTypes, &mb, &nb, &pb, array, &type)) {
+            if (mb * nb * pb >= INT_MAX) PsychErrorExitMsg(PsychError_user, "Too many vertices in a single batch. Maximum is 2^31 - 1 values.");
+
+            *m = (int) mb;
+            *n = (int) nb;
+            *p = (int) pb;
+
+            switch (type) {
+                case PsychArgType_double:
+                    *gltype = GL_DOUBLE;
+                    break;
+                case PsychArgType_single:
+                    *gltype = GL_FLOAT;
+                    break;
+                case PsychArgType_int16:
+                    *gltype = GL_SHORT;
+                    break;
+                case PsychArgType_uint16:
+                    // Not a valid glVertexPointer() type, so convert into a temporary float matrix:
+                    arrayU = (psych_uint16*) *array;
+                    arrayF = (float*) PsychMallocTemp(sizeof(float) * mb * nb * pb);
+                    *array = arrayF;
+                    for (i = mb * nb * pb; i > 0; i--) *(arrayF++) = (float) *(arrayU++);
+                    *gltype = GL_FLOAT;
+                    break;
+                default:
+                    PsychErrorExitMsg(PsychError_internal, "Unhandled vertex attribute data type!");
+            }
+
+            return;
+        }
+    }
+
+    // Conversion path, which also reports invalid arguments:
+    if (usefloat) {
+        PsychAllocInFloatMatArg(position, TRUE, m, n, p, (float**) array);
+        if (gltype) *gltype = GL_FLOAT;
+    }
+    else {
+        PsychAllocInDoubleMatArg(position, TRUE, m, n, p, (double**) array);
+        if (gltype) *gltype = GL_DOUBLE;
+    }
+}
+
 /* PsychPrepareRenderBatch()
  *
  * Perform setup for a batch of render requests for a specific primitive. Some 2D Screen
@@ -402,8 +467,15 @@ GLdouble *PsychExtractQuadVertexFromRect(double *rect, int vertexNumber, GLdoubl
  * are provided and if its a single one or multiple ones. It sets up the rendering pipe accordingly,
  * performing required conversion steps. The actual drawing routine just needs to perform primitive
  * specific code.
+ *
+ * Callers which pass the coordinates and sizes to OpenGL as vertex arrays can pass non-NULL 'xytype'
+ * and 'sizetype'. Then *xy and *size are returned in their native data type if possible, without any
+ * conversion, and *xytype and *sizetype return the OpenGL data type of *xy and *size: Coordinates can
+ * be double, single or int16 matrices, sizes double or single matrices. uint16 coordinates are accepted,
+ * but converted to float. Callers which pass
+ * NULL always get double matrices, or float matrices if 'usefloat' is set.
  */
-void PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos, int* coords_count, double** xy, int colors_pos, int* colors_count, int* colorcomponent_count, double** colors, unsigned char** bytecolors, int sizes_pos, int* sizes_count, double** size, psych_bool usefloat)
+void PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos, int* coords_count, double** xy, int colors_pos, int* colors_count, int* colorcomponent_count, double** colors, unsigned char** bytecolors, int sizes_pos, int* sizes_count, double** size, psych_bool usefloat, GLenum* xytype, GLenum* sizetype)
 {
     PsychColorType      color;
     int                 m,n,p,mc,nc,pc;
@@ -427,12 +499,7 @@ void PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos
     }
 
     if (isArgThere) {
-        if (usefloat) {
-            PsychAllocInFloatMatArg(coords_pos, TRUE, &m, &n, &p, (float**) xy);
-        }
-        else {
-            PsychAllocInDoubleMatArg(coords_pos, TRUE, &m, &n, &p, xy);
-        }
+        PsychAllocInVertexAttribArg(coords_pos, usefloat, PsychArgType_single | PsychArgType_int16, &m, &n, &p, (void**) xy, xytype);
 
         if (p!=1 || (m!=*coords_count && (m*n)!=*coords_count)) {
             printf("PTB-ERROR: Coordinates must be a %i tuple or a %i rows vector.\n", *coords_count, *coords_count);
@@ -460,15 +527,16 @@ void PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos
         if (!isArgThere) {
                 // No size provided: Use a default size of 1.0:
                 *size = (double *) PsychMallocTemp(sizeof(double));
-                *size[0] = 1;
+                if (usefloat) {
+                    *((float*) *size) = 1;
+                }
+                else {
+                    *size[0] = 1;
+                }
+                if (sizetype) *sizetype = (usefloat) ? GL_FLOAT : GL_DOUBLE;
                 nrsize=1;
         } else {
-            if (usefloat) {
-                PsychAllocInFloatMatArg(sizes_pos, TRUE, &m, &n, &p, (float**) size);
-            }
-            else {
-                PsychAllocInDoubleMatArg(sizes_pos, TRUE, &m, &n, &p, size);
-            }
+            PsychAllocInVertexAttribArg(sizes_pos, usefloat, PsychArgType_single, &m, &n, &p, (void**) size, sizetype);
 
             if (p!=1) PsychErrorExitMsg(PsychError_user, "Size must be a scalar or a vector with one column or row");
             nrsize=m*n;
@@ -624,6 +692,203 @@ void PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos
     return;
 }
 
+/* PsychGLTypeSize()
+ *
+ * Return size in bytes of one value of OpenGL data type 'type', as used for vertex arrays. Only the
+ * types which PsychPrepareRenderBatch() can return for vertex and color arrays are handled, so that a
+ * type which is not valid for glVertexPointer(), e.g., GL_UNSIGNED_SHORT, can not sneak into the
+ * vertex stream unnoticed.
+ */
+size_t PsychGLTypeSize(GLenum type)
+{
+    switch (type) {
+        case GL_DOUBLE:
+            return(sizeof(GLdouble));
+        case GL_FLOAT:
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+            return(sizeof(GLfloat));
+        case GL_SHORT:
+            return(sizeof(GLshort));
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return(sizeof(GLubyte));
+    }
+
+    PsychErrorExitMsg(PsychError_internal, "Unhandled OpenGL data type in PsychGLTypeSize()!");
+    return(0);
+}
+
+/* Maximum number of arrays pushed per batch into the vertex stream, for the alignment reserve: */
+#define kPsychVertexStreamMaxArrays 4
+#define kPsychVertexStreamAlign     16
+
+/* Wait for completion of all draws from segment 'i' of the vertex stream, then release its fence: */
+static void PsychVertexStreamWaitSegment(PsychVertexStream *stream, int i)
+{
+    if (!stream->fences[i]) return;
+
+    while (glClientWaitSync(stream->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(stream->fences[i]);
+    stream->fences[i] = NULL;
+}
+
+/* PsychVertexStreamBegin()
+ *
+ * Start streaming a batch of vertex arrays of at most 'nbytes' bytes in total, and at most
+ * kPsychVertexStreamMaxArrays arrays, into the streaming vertex buffer object of the window.
+ * Returns TRUE and binds the VBO as GL_ARRAY_BUFFER on success. Then each array must be copied
+ * into the VBO via PsychVertexStreamPush(), and the offset returned by it used as pointer for
+ * the gl*Pointer() calls, followed by PsychVertexStreamEnd() to unbind the VBO again. The array
+ * pointers remain bound to the VBO after that, for the following draw calls, until they are reset.
+ *
+ * Returns FALSE if streaming is not possible, e.g., because VBO's are unsupported, or the batch
+ * is too big. Then the caller should use its client memory arrays as usual.
+ *
+ * The VBO is shared by the onscreen window and all its offscreen windows and textures, as they
+ * share the same OpenGL context. It is used as a ring buffer: If the persistently mapped buffers
+ * of OpenGL 4.4 or ARB_buffer_storage are supported, the VBO is mapped once and written to as a
+ * ring of kPsychVertexStreamSegments segments, with a fence after the last draw from a segment, so
+ * the GPU only needs to wait when it lags a whole ring behind. Otherwise new data is uploaded via
+ * glBufferSubData(), and the VBO storage is orphaned whenever the end of the ring is reached.
+ */
+psych_bool PsychVertexStreamBegin(PsychWindowRecordType *windowRecord, size_t nbytes)
+{
+    PsychVertexStream *stream = &(PsychGetParentWindow(windowRecord)->vertexStream);
+    const size_t segmentSize = kPsychVertexStreamSize / kPsychVertexStreamSegments;
+    size_t offset;
+    int lastsegment;
+    psych_bool wrapped;
+
+    // Only supported on classic OpenGL with VBO's, and only for batches which fit into one segment:
+    nbytes += kPsychVertexStreamMaxArrays * kPsychVertexStreamAlign;
+    if (stream->unsupported || (nbytes > segmentSize) || !PsychIsGLClassic(windowRecord) || !glBindBuffer ||
+        (PsychPrefStateGet_ConserveVRAM() & kPsychDontUseVertexStreaming))
+        return(FALSE);
+
+    // Create VBO at first use:
+    if (!stream->vbo) {
+        while (glGetError());
+        glGenBuffers(1, &stream->vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, stream->vbo);
+
+        if (glBufferStorage && glMapBufferRange && glFenceSync) {
+            // Persistently and coherently mapped VBO:
+            glBufferStorage(GL_ARRAY_BUFFER, kPsychVertexStreamSize, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+            stream->mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, kPsychVertexStreamSize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+        }
+        else {
+            // Classic VBO, updated via glBufferSubData():
+            glBufferData(GL_ARRAY_BUFFER, kPsychVertexStreamSize, NULL, GL_STREAM_DRAW);
+        }
+
+        if (glGetError() || (glBufferStorage && glMapBufferRange && glFenceSync && !stream->mapped)) {
+            // Failed. Use client memory arrays from now on:
+            if (PsychPrefStateGet_Verbosity() > 2) printf("PTB-INFO: Failed to create streaming vertex buffer object. Drawing batches of primitives may be slower.\n");
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glDeleteBuffers(1, &stream->vbo);
+            stream->vbo = 0;
+            stream->mapped = NULL;
+            stream->unsupported = TRUE;
+            while (glGetError());
+            return(FALSE);
+        }
+
+        stream->offset = 0;
+        stream->segment = 0;
+    }
+    else {
+        glBindBuffer(GL_ARRAY_BUFFER, stream->vbo);
+    }
+
+    // Does the batch fit into the rest of the ring?
+    offset = stream->offset;
+    wrapped = FALSE;
+    if (offset + nbytes > kPsychVertexStreamSize) {
+        // No. Start over at the beginning of the ring:
+        offset = 0;
+        wrapped = TRUE;
+
+        // Orphan old storage of a non-mapped VBO, so we do not have to wait for the draws from it:
+        if (!stream->mapped) glBufferData(GL_ARRAY_BUFFER, kPsychVertexStreamSize, NULL, GL_STREAM_DRAW);
+    }
+
+    if (stream->mapped) {
+        // Advance through all segments which get touched by this batch. Fence the draws from
+        // each segment we leave, and wait for the GPU to be done with each segment we enter:
+        lastsegment = (int) ((offset + nbytes - 1) / segmentSize);
+        while (wrapped || (stream->segment != lastsegment)) {
+            if (!stream->fences[stream->segment]) stream->fences[stream->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            stream->segment = (stream->segment + 1) % kPsychVertexStreamSegments;
+            if (stream->segment == 0) wrapped = FALSE;
+            PsychVertexStreamWaitSegment(stream, stream->segment);
+        }
+    }
+
+    stream->offset = offset;
+
+    return(TRUE);
+}
+
+/* PsychVertexStreamPush()
+ *
+ * Copy 'nbytes' of vertex array 'data' into the streaming VBO, after a successful PsychVertexStreamBegin().
+ * Returns the offset of the data in the VBO, to be passed as pointer to the gl*Pointer() functions.
+ */
+const GLvoid* PsychVertexStreamPush(PsychWindowRecordType *windowRecord, const void* data, size_t nbytes)
+{
+    PsychVertexStream *stream = &(PsychGetParentWindow(windowRecord)->vertexStream);
+    size_t offset;
+
+    offset = (stream->offset + kPsychVertexStreamAlign - 1) & ~((size_t) kPsychVertexStreamAlign - 1);
+    if (stream->mapped) {
+        memcpy((unsigned char*) stream->mapped + offset, data, nbytes);
+    }
+    else {
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) offset, (GLsizeiptr) nbytes, data);
+    }
+
+    stream->offset = offset + nbytes;
+
+    return((const GLvoid*) offset);
+}
+
+/* PsychVertexStreamEnd()
+ *
+ * Finish streaming of a batch of vertex arrays: Unbind the VBO. Array pointers which were setup
+ * while the VBO was bound keep sourcing their data from it.
+ */
+void PsychVertexStreamEnd(PsychWindowRecordType *windowRecord)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* PsychVertexStreamDestroy()
+ *
+ * Release the streaming VBO of an onscreen window. Called at window close, with its OpenGL context bound.
+ */
+void PsychVertexStreamDestroy(PsychWindowRecordType *windowRecord)
+{
+    PsychVertexStream *stream = &(windowRecord->vertexStream);
+    int i;
+
+    for (i = 0; i < kPsychVertexStreamSegments; i++) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+    }
+
+    if (stream->vbo) {
+        if (stream->mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, stream->vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        glDeleteBuffers(1, &stream->vbo);
+    }
+
+    memset(stream, 0, sizeof(PsychVertexStream));
+}
+
 /* Emit a single pixel in top-left corner of window and wait for its rendering
 * to complete. Our classic trick to wait for double-buffer swap completion on
 * systems where we don't have better system-provided timestamping and syncing
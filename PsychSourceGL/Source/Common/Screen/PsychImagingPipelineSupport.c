@@ -2218,6 +2218,13 @@ void PsychCreateShadowFBOForTexture(PsychWindowRecordType *textureRecord, psych_
 {
     GLenum fboInternalFormat;
 
+    // Pooled textures share their OpenGL texture with other textures, so can't get a FBO of their own:
+    PsychTexturePoolCheckUnsupported(textureRecord, "draw into or transform");
+
+    // Texture must be complete before it gets attached to a FBO or used as image source:
+    PsychSetGLContext(textureRecord);
+    PsychTextureUploadWait(textureRecord);
+
     // Do we already have a framebuffer object for this texture? All textures start off without one,
     // because most textures are just used for drawing them, not drawing *into* them. Therefore we
     // only create a full blown FBO on demand here.
@@ -2311,6 +2318,8 @@ void PsychNormalizeTextureOrientation(PsychWindowRecordType *sourceRecord)
     // step to transform the texture into normalized orientation. Non-planar textures would also
     // wreak havoc if not converted into standard pixel-interleaved format:
     if (sourceRecord->textureOrientation != 2 || isplanar) {
+        PsychTexturePoolCheckUnsupported(sourceRecord, "convert the orientation of");
+
         if (PsychPrefStateGet_Verbosity()>5) printf("PTB-DEBUG: In PsychNormalizeTextureOrientation(): Performing GPU renderswap or format conversion for source gl-texture %i --> ", sourceRecord->textureNumber);
 
         // Soft-reset drawing engine in a safe way:
@@ -0,0 +1,934 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTextureConversion.c
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Conversion of Matlab/Octave image matrices into texel buffers for OpenGL textures. See
+		PsychTextureConversion.h for an overview.
+
+		Each conversion has a scalar implementation, which also handles the leftover pixels of
+		the SIMD implementations. Double to uint8 conversion truncates, like the C cast used by
+		the scalar code, and keeps the low 8 bits of out of range values, like the C cast does on
+		x86, so SIMD and scalar results are identical.
+
+		Conversions of big images are split into chunks of pixels, which are processed by the
+		calling thread and the worker threads of a pool. The pool is created on first use and
+		lives until Screen exits.
+*/
+
+#include "Screen.h"
+#include <stddef.h>
+
+#if PSYCH_SYSTEM != PSYCH_WINDOWS
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PSYCH_TEXCONV_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define PSYCH_TEXCONV_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Minimum number of texel components of a conversion for use of worker threads:
+#define kPsychTexConvParallelThreshold  (1 << 20)
+// Maximum number of threads for one conversion, including the calling thread:
+#define kPsychTexConvMaxThreads         8
+// Number of chunks per thread, for load balancing:
+#define kPsychTexConvChunksPerThread    4
+
+// Type of conversion:
+#define kPsychTexConvToFloat            0
+#define kPsychTexConvToUByte            1
+#define kPsychTexConvInterleave         2
+#define kPsychTexConvReadbackUByte      3
+#define kPsychTexConvReadbackDouble     4
+
+// Edge length in pixels of the square tiles of readback conversion:
+#define kPsychTexConvTileSize           32
+
+typedef struct PsychTexConvJob {
+    int             type;
+    void*           dst;
+    const void*     planes[4];
+    int             nplanes;
+    size_t          npixels;
+    double          scale;
+    psych_bool      flushTiny;
+    // Only for readback conversions, which process 'npixels' columns of 'rows' rows:
+    const void*     src;
+    size_t          rows;
+    int             stride;
+} PsychTexConvJob;
+
+// Worker thread pool:
+static psych_bool       texConvPoolInitialized = FALSE;
+static psych_bool       texConvPoolShutdown = FALSE;
+static psych_bool       texConvSyncInitialized = FALSE;
+static int              texConvNumWorkers = 0;
+static psych_thread     texConvWorkers[kPsychTexConvMaxThreads];
+static psych_mutex      texConvMutex;
+static psych_condition  texConvWorkSignal;
+static psych_condition  texConvDoneSignal;
+
+// Current job, protected by texConvMutex:
+static PsychTexConvJob  texConvJob;
+static size_t           texConvChunkPixels;
+static int              texConvNumChunks = 0;
+static int              texConvNextChunk = 0;
+static int              texConvChunksDone = 0;
+
+// Scalar reference implementations:
+
+static void PsychTexConvToFloatScalar(GLfloat* dst, const double** planes, int nplanes, size_t n, psych_bool flushTiny)
+{
+    size_t i;
+    int k;
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nplanes; k++) {
+            *dst = (GLfloat) planes[k][i];
+            if (flushTiny && (fabs((double) *dst) < 1e-9)) *dst = 0.0;
+            dst++;
+        }
+    }
+}
+
+static void PsychTexConvToUByteScalar(GLubyte* dst, const double** planes, int nplanes, size_t n, double scale)
+{
+    size_t i;
+    int k;
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nplanes; k++) *(dst++) = (GLubyte) (scale * planes[k][i]);
+    }
+}
+
+static void PsychInterleaveTexelsScalar(GLubyte* dst, const GLubyte** planes, int nplanes, size_t n)
+{
+    size_t i;
+    int k;
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nplanes; k++) *(dst++) = planes[k][i];
+    }
+}
+
+#ifdef PSYCH_TEXCONV_SSE2
+
+// Load 4 doubles from 'src' as 4 floats, optionally flushing tiny values to zero:
+static __m128 PsychTexConvLoadFloat4(const double* src, psych_bool flushTiny)
+{
+    __m128 v = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(src)), _mm_cvtpd_ps(_mm_loadu_pd(src + 2)));
+
+    // |v| <= 1e-9f is the same as |(double) v| < 1e-9, as 1e-9f is the biggest float below 1e-9:
+    if (flushTiny) v = _mm_andnot_ps(_mm_cmple_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), v), _mm_set1_ps(1e-9f)), v);
+
+    return(v);
+}
+
+// Load 8 doubles from 'src', multiply by 'scale' and truncate to the low 8 bits of their integer
+// values. Returns them as 8 16 bit integers:
+static __m128i PsychTexConvLoadUByte8(const double* src, __m128d scale)
+{
+    __m128i a = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(src), scale)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(src + 2), scale)));
+    __m128i b = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(src + 4), scale)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(src + 6), scale)));
+    __m128i mask = _mm_set1_epi32(0xff);
+
+    return(_mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask)));
+}
+
+static void PsychTexConvToFloat(GLfloat* dst, const double** planes, int nplanes, size_t n, psych_bool flushTiny)
+{
+    __m128 r, g, b, a;
+    size_t i = 0;
+
+    switch (nplanes) {
+        case 1:
+            for (; i + 4 <= n; i += 4, dst += 4) _mm_storeu_ps(dst, PsychTexConvLoadFloat4(planes[0] + i, flushTiny));
+            break;
+
+        case 2:
+            for (; i + 4 <= n; i += 4, dst += 8) {
+                r = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                a = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                _mm_storeu_ps(dst, _mm_unpacklo_ps(r, a));
+                _mm_storeu_ps(dst + 4, _mm_unpackhi_ps(r, a));
+            }
+            break;
+
+        case 3:
+            // Each store writes one float too much, which the following store overwrites. The last store
+            // writes into the first texel of the next pixel, so one more pixel must follow:
+            for (; i + 5 <= n; i += 4, dst += 12) {
+                r = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                g = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                b = PsychTexConvLoadFloat4(planes[2] + i, flushTiny);
+                a = _mm_setzero_ps();
+                _MM_TRANSPOSE4_PS(r, g, b, a);
+                _mm_storeu_ps(dst, r);
+                _mm_storeu_ps(dst + 3, g);
+                _mm_storeu_ps(dst + 6, b);
+                _mm_storeu_ps(dst + 9, a);
+            }
+            break;
+
+        case 4:
+            for (; i + 4 <= n; i += 4, dst += 16) {
+                r = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                g = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                b = PsychTexConvLoadFloat4(planes[2] + i, flushTiny);
+                a = PsychTexConvLoadFloat4(planes[3] + i, flushTiny);
+                _MM_TRANSPOSE4_PS(r, g, b, a);
+                _mm_storeu_ps(dst, r);
+                _mm_storeu_ps(dst + 4, g);
+                _mm_storeu_ps(dst + 8, b);
+                _mm_storeu_ps(dst + 12, a);
+            }
+            break;
+    }
+
+    // Remaining pixels:
+    if (i < n) {
+        const double* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychTexConvToFloatScalar(dst, rest, nplanes, n - i, flushTiny);
+    }
+}
+
+static void PsychTexConvToUByte(GLubyte* dst, const double** planes, int nplanes, size_t n, double scale)
+{
+    __m128d vscale = _mm_set1_pd(scale);
+    __m128i p0, p1, p2, p3, lo, hi;
+    GLubyte t[3][8];
+    size_t i = 0;
+    int j;
+
+    switch (nplanes) {
+        case 1:
+            for (; i + 8 <= n; i += 8, dst += 8) {
+                p0 = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                _mm_storel_epi64((__m128i*) dst, _mm_packus_epi16(p0, p0));
+            }
+            break;
+
+        case 2:
+            for (; i + 8 <= n; i += 8, dst += 16) {
+                p0 = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                p1 = PsychTexConvLoadUByte8(planes[1] + i, vscale);
+                _mm_storeu_si128((__m128i*) dst, _mm_unpacklo_epi8(_mm_packus_epi16(p0, p0), _mm_packus_epi16(p1, p1)));
+            }
+            break;
+
+        case 3:
+            // No 3-way byte interleave in SSE2, so only the conversion is vectorized:
+            for (; i + 8 <= n; i += 8) {
+                for (j = 0; j < 3; j++) {
+                    p0 = PsychTexConvLoadUByte8(planes[j] + i, vscale);
+                    _mm_storel_epi64((__m128i*) t[j], _mm_packus_epi16(p0, p0));
+                }
+
+                for (j = 0; j < 8; j++) {
+                    *(dst++) = t[0][j];
+                    *(dst++) = t[1][j];
+                    *(dst++) = t[2][j];
+                }
+            }
+            break;
+
+        case 4:
+            for (; i + 8 <= n; i += 8, dst += 32) {
+                p0 = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                p1 = PsychTexConvLoadUByte8(planes[1] + i, vscale);
+                p2 = PsychTexConvLoadUByte8(planes[2] + i, vscale);
+                p3 = PsychTexConvLoadUByte8(planes[3] + i, vscale);
+                lo = _mm_unpacklo_epi8(_mm_packus_epi16(p0, p0), _mm_packus_epi16(p1, p1));
+                hi = _mm_unpacklo_epi8(_mm_packus_epi16(p2, p2), _mm_packus_epi16(p3, p3));
+                _mm_storeu_si128((__m128i*) dst, _mm_unpacklo_epi16(lo, hi));
+                _mm_storeu_si128((__m128i*) (dst + 16), _mm_unpackhi_epi16(lo, hi));
+            }
+            break;
+    }
+
+    if (i < n) {
+        const double* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychTexConvToUByteScalar(dst, rest, nplanes, n - i, scale);
+    }
+}
+
+static void PsychTexConvInterleave(GLubyte* dst, const GLubyte** planes, int nplanes, size_t n)
+{
+    __m128i p0, p1, p2, p3, lo01, hi01, lo23, hi23;
+    size_t i = 0;
+
+    switch (nplanes) {
+        case 2:
+            for (; i + 16 <= n; i += 16, dst += 32) {
+                p0 = _mm_loadu_si128((const __m128i*) (planes[0] + i));
+                p1 = _mm_loadu_si128((const __m128i*) (planes[1] + i));
+                _mm_storeu_si128((__m128i*) dst, _mm_unpacklo_epi8(p0, p1));
+                _mm_storeu_si128((__m128i*) (dst + 16), _mm_unpackhi_epi8(p0, p1));
+            }
+            break;
+
+        case 4:
+            for (; i + 16 <= n; i += 16, dst += 64) {
+                p0 = _mm_loadu_si128((const __m128i*) (planes[0] + i));
+                p1 = _mm_loadu_si128((const __m128i*) (planes[1] + i));
+                p2 = _mm_loadu_si128((const __m128i*) (planes[2] + i));
+                p3 = _mm_loadu_si128((const __m128i*) (planes[3] + i));
+                lo01 = _mm_unpacklo_epi8(p0, p1);
+                hi01 = _mm_unpackhi_epi8(p0, p1);
+                lo23 = _mm_unpacklo_epi8(p2, p3);
+                hi23 = _mm_unpackhi_epi8(p2, p3);
+                _mm_storeu_si128((__m128i*) dst, _mm_unpacklo_epi16(lo01, lo23));
+                _mm_storeu_si128((__m128i*) (dst + 16), _mm_unpackhi_epi16(lo01, lo23));
+                _mm_storeu_si128((__m128i*) (dst + 32), _mm_unpacklo_epi16(hi01, hi23));
+                _mm_storeu_si128((__m128i*) (dst + 48), _mm_unpackhi_epi16(hi01, hi23));
+            }
+            break;
+    }
+
+    // Remaining pixels, or all pixels for 1 or 3 planes:
+    if (i < n) {
+        const GLubyte* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychInterleaveTexelsScalar(dst, rest, nplanes, n - i);
+    }
+}
+
+#elif defined(PSYCH_TEXCONV_NEON)
+
+static float32x4_t PsychTexConvLoadFloat4(const double* src, psych_bool flushTiny)
+{
+    float32x4_t v = vcombine_f32(vcvt_f32_f64(vld1q_f64(src)), vcvt_f32_f64(vld1q_f64(src + 2)));
+
+    // |v| <= 1e-9f is the same as |(double) v| < 1e-9, as 1e-9f is the biggest float below 1e-9:
+    if (flushTiny) v = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(v), vcaleq_f32(v, vdupq_n_f32(1e-9f))));
+
+    return(v);
+}
+
+// Load 8 doubles from 'src', multiply by 'scale' and truncate to the low 8 bits of their integer values:
+static uint8x8_t PsychTexConvLoadUByte8(const double* src, float64x2_t scale)
+{
+    int32x4_t a = vcombine_s32(vmovn_s64(vcvtq_s64_f64(vmulq_f64(vld1q_f64(src), scale))), vmovn_s64(vcvtq_s64_f64(vmulq_f64(vld1q_f64(src + 2), scale))));
+    int32x4_t b = vcombine_s32(vmovn_s64(vcvtq_s64_f64(vmulq_f64(vld1q_f64(src + 4), scale))), vmovn_s64(vcvtq_s64_f64(vmulq_f64(vld1q_f64(src + 6), scale))));
+
+    return(vmovn_u16(vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b)))));
+}
+
+static void PsychTexConvToFloat(GLfloat* dst, const double** planes, int nplanes, size_t n, psych_bool flushTiny)
+{
+    float32x4x2_t v2;
+    float32x4x3_t v3;
+    float32x4x4_t v4;
+    size_t i = 0;
+
+    switch (nplanes) {
+        case 1:
+            for (; i + 4 <= n; i += 4, dst += 4) vst1q_f32(dst, PsychTexConvLoadFloat4(planes[0] + i, flushTiny));
+            break;
+
+        case 2:
+            for (; i + 4 <= n; i += 4, dst += 8) {
+                v2.val[0] = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                v2.val[1] = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                vst2q_f32(dst, v2);
+            }
+            break;
+
+        case 3:
+            for (; i + 4 <= n; i += 4, dst += 12) {
+                v3.val[0] = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                v3.val[1] = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                v3.val[2] = PsychTexConvLoadFloat4(planes[2] + i, flushTiny);
+                vst3q_f32(dst, v3);
+            }
+            break;
+
+        case 4:
+            for (; i + 4 <= n; i += 4, dst += 16) {
+                v4.val[0] = PsychTexConvLoadFloat4(planes[0] + i, flushTiny);
+                v4.val[1] = PsychTexConvLoadFloat4(planes[1] + i, flushTiny);
+                v4.val[2] = PsychTexConvLoadFloat4(planes[2] + i, flushTiny);
+                v4.val[3] = PsychTexConvLoadFloat4(planes[3] + i, flushTiny);
+                vst4q_f32(dst, v4);
+            }
+            break;
+    }
+
+    if (i < n) {
+        const double* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychTexConvToFloatScalar(dst, rest, nplanes, n - i, flushTiny);
+    }
+}
+
+static void PsychTexConvToUByte(GLubyte* dst, const double** planes, int nplanes, size_t n, double scale)
+{
+    float64x2_t vscale = vdupq_n_f64(scale);
+    uint8x8x2_t v2;
+    uint8x8x3_t v3;
+    uint8x8x4_t v4;
+    size_t i = 0;
+
+    switch (nplanes) {
+        case 1:
+            for (; i + 8 <= n; i += 8, dst += 8) vst1_u8(dst, PsychTexConvLoadUByte8(planes[0] + i, vscale));
+            break;
+
+        case 2:
+            for (; i + 8 <= n; i += 8, dst += 16) {
+                v2.val[0] = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                v2.val[1] = PsychTexConvLoadUByte8(planes[1] + i, vscale);
+                vst2_u8(dst, v2);
+            }
+            break;
+
+        case 3:
+            for (; i + 8 <= n; i += 8, dst += 24) {
+                v3.val[0] = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                v3.val[1] = PsychTexConvLoadUByte8(planes[1] + i, vscale);
+                v3.val[2] = PsychTexConvLoadUByte8(planes[2] + i, vscale);
+                vst3_u8(dst, v3);
+            }
+            break;
+
+        case 4:
+            for (; i + 8 <= n; i += 8, dst += 32) {
+                v4.val[0] = PsychTexConvLoadUByte8(planes[0] + i, vscale);
+                v4.val[1] = PsychTexConvLoadUByte8(planes[1] + i, vscale);
+                v4.val[2] = PsychTexConvLoadUByte8(planes[2] + i, vscale);
+                v4.val[3] = PsychTexConvLoadUByte8(planes[3] + i, vscale);
+                vst4_u8(dst, v4);
+            }
+            break;
+    }
+
+    if (i < n) {
+        const double* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychTexConvToUByteScalar(dst, rest, nplanes, n - i, scale);
+    }
+}
+
+static void PsychTexConvInterleave(GLubyte* dst, const GLubyte** planes, int nplanes, size_t n)
+{
+    uint8x16x2_t v2;
+    uint8x16x3_t v3;
+    uint8x16x4_t v4;
+    size_t i = 0;
+
+    switch (nplanes) {
+        case 2:
+            for (; i + 16 <= n; i += 16, dst += 32) {
+                v2.val[0] = vld1q_u8(planes[0] + i);
+                v2.val[1] = vld1q_u8(planes[1] + i);
+                vst2q_u8(dst, v2);
+            }
+            break;
+
+        case 3:
+            for (; i + 16 <= n; i += 16, dst += 48) {
+                v3.val[0] = vld1q_u8(planes[0] + i);
+                v3.val[1] = vld1q_u8(planes[1] + i);
+                v3.val[2] = vld1q_u8(planes[2] + i);
+                vst3q_u8(dst, v3);
+            }
+            break;
+
+        case 4:
+            for (; i + 16 <= n; i += 16, dst += 64) {
+                v4.val[0] = vld1q_u8(planes[0] + i);
+                v4.val[1] = vld1q_u8(planes[1] + i);
+                v4.val[2] = vld1q_u8(planes[2] + i);
+                v4.val[3] = vld1q_u8(planes[3] + i);
+                vst4q_u8(dst, v4);
+            }
+            break;
+    }
+
+    if (i < n) {
+        const GLubyte* rest[4] = { planes[0] + i, (nplanes > 1) ? planes[1] + i : NULL, (nplanes > 2) ? planes[2] + i : NULL, (nplanes > 3) ? planes[3] + i : NULL };
+        PsychInterleaveTexelsScalar(dst, rest, nplanes, n - i);
+    }
+}
+
+#else
+
+// No SIMD available: Use the scalar implementations.
+#define PsychTexConvToFloat     PsychTexConvToFloatScalar
+#define PsychTexConvToUByte     PsychTexConvToUByteScalar
+#define PsychTexConvInterleave  PsychInterleaveTexelsScalar
+
+#endif
+
+// Readback conversions: Pixels 'src' from glReadPixels() are stored row by row, starting with
+// the bottom row, and with interleaved color components. Matlab/Octave matrices are stored
+// column by column, starting with the top row, with separate color planes. Conversion therefore
+// transposes and flips the image. It is done in tiles which fit into the cpu caches.
+
+#ifdef PSYCH_TEXCONV_SSE2
+
+// Transpose 16 x 16 bytes: Writes column i of the 16 rows 'srcStride' bytes apart in 'src' to
+// row i, 'dstStride' bytes apart, of 'dst'. Each round interleaves row i with row i + 8, four
+// rounds of this perfect shuffle transpose the block:
+static void PsychTexConvTranspose16x16(GLubyte* dst, size_t dstStride, const GLubyte* src, ptrdiff_t srcStride)
+{
+    __m128i a[16], b[16];
+    int i;
+
+    for (i = 0; i < 16; i++) a[i] = _mm_loadu_si128((const __m128i*) (src + i * srcStride));
+
+    for (i = 0; i < 8; i++) {
+        b[2 * i] = _mm_unpacklo_epi8(a[i], a[i + 8]);
+        b[2 * i + 1] = _mm_unpackhi_epi8(a[i], a[i + 8]);
+    }
+
+    for (i = 0; i < 8; i++) {
+        a[2 * i] = _mm_unpacklo_epi8(b[i], b[i + 8]);
+        a[2 * i + 1] = _mm_unpackhi_epi8(b[i], b[i + 8]);
+    }
+
+    for (i = 0; i < 8; i++) {
+        b[2 * i] = _mm_unpacklo_epi8(a[i], a[i + 8]);
+        b[2 * i + 1] = _mm_unpackhi_epi8(a[i], a[i + 8]);
+    }
+
+    for (i = 0; i < 8; i++) {
+        a[2 * i] = _mm_unpacklo_epi8(b[i], b[i + 8]);
+        a[2 * i + 1] = _mm_unpackhi_epi8(b[i], b[i + 8]);
+    }
+
+    for (i = 0; i < 16; i++) _mm_storeu_si128((__m128i*) (dst + i * dstStride), a[i]);
+}
+
+// Deinterleave 16 pixels of 'stride' 2 or 4 byte components each in v[0] to v[stride - 1], so that
+// v[c] contains component c of all 16 pixels. Same perfect shuffle as PsychTexConvTranspose16x16:
+static void PsychTexConvDeinterleave16(__m128i* v, int stride)
+{
+    __m128i t0, t1, t2, t3;
+    int round;
+
+    if (stride == 2) {
+        for (round = 0; round < 4; round++) {
+            t0 = _mm_unpacklo_epi8(v[0], v[1]);
+            t1 = _mm_unpackhi_epi8(v[0], v[1]);
+            v[0] = t0;
+            v[1] = t1;
+        }
+    }
+    else {
+        for (round = 0; round < 4; round++) {
+            t0 = _mm_unpacklo_epi8(v[0], v[2]);
+            t1 = _mm_unpackhi_epi8(v[0], v[2]);
+            t2 = _mm_unpacklo_epi8(v[1], v[3]);
+            t3 = _mm_unpackhi_epi8(v[1], v[3]);
+            v[0] = t0;
+            v[1] = t1;
+            v[2] = t2;
+            v[3] = t3;
+        }
+    }
+}
+
+// Store 4 floats as doubles:
+static void PsychTexConvStoreDouble4(double* dst, __m128 v)
+{
+    _mm_storeu_pd(dst, _mm_cvtps_pd(v));
+    _mm_storeu_pd(dst + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+}
+
+// Transpose 4 x 4 floats into doubles, like PsychTexConvTranspose16x16:
+static void PsychTexConvTranspose4x4(double* dst, size_t dstStride, const GLfloat* src, ptrdiff_t srcStride)
+{
+    __m128 r0 = _mm_loadu_ps(src);
+    __m128 r1 = _mm_loadu_ps(src + srcStride);
+    __m128 r2 = _mm_loadu_ps(src + 2 * srcStride);
+    __m128 r3 = _mm_loadu_ps(src + 3 * srcStride);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    PsychTexConvStoreDouble4(dst, r0);
+    PsychTexConvStoreDouble4(dst + dstStride, r1);
+    PsychTexConvStoreDouble4(dst + 2 * dstStride, r2);
+    PsychTexConvStoreDouble4(dst + 3 * dstStride, r3);
+}
+
+#endif
+
+// Convert columns 'x0' to 'x1' - 1 of a readback of 'width' x 'height' pixels:
+static void PsychTexConvReadbackUByte(GLubyte* dst, const GLubyte* src, int nrchannels, int stride, size_t width, size_t height, size_t x0, size_t x1)
+{
+    const ptrdiff_t rowStride = -((ptrdiff_t) width * stride);
+    const GLubyte* s;
+    GLubyte* d[4];
+    size_t tx, ty, tx1, ty1, ix, iy;
+    int c;
+    #ifdef PSYCH_TEXCONV_SSE2
+    __m128i v[4], planes[4][16];
+    int r;
+    #endif
+
+    for (tx = x0; tx < x1; tx += kPsychTexConvTileSize) {
+        tx1 = (tx + kPsychTexConvTileSize < x1) ? tx + kPsychTexConvTileSize : x1;
+        for (ty = 0; ty < height; ty += kPsychTexConvTileSize) {
+            ty1 = (ty + kPsychTexConvTileSize < height) ? ty + kPsychTexConvTileSize : height;
+
+            #ifdef PSYCH_TEXCONV_SSE2
+            // Single channel full tiles: Transpose in blocks of 16 x 16 pixels:
+            if ((stride == 1) && (tx1 - tx == kPsychTexConvTileSize) && (ty1 - ty == kPsychTexConvTileSize)) {
+                for (ix = tx; ix < tx1; ix += 16) {
+                    for (iy = ty; iy < ty1; iy += 16) {
+                        PsychTexConvTranspose16x16(dst + ix * height + iy, height, src + (height - 1 - iy) * width + ix, rowStride);
+                    }
+                }
+
+                continue;
+            }
+
+            // Two or four channel full tiles: Deinterleave rows of 16 pixels into planes, then transpose each plane:
+            if (((stride == 2) || (stride == 4)) && (tx1 - tx == kPsychTexConvTileSize) && (ty1 - ty == kPsychTexConvTileSize)) {
+                for (ix = tx; ix < tx1; ix += 16) {
+                    for (iy = ty; iy < ty1; iy += 16) {
+                        for (r = 0; r < 16; r++) {
+                            s = src + ((height - 1 - iy - r) * width + ix) * (size_t) stride;
+                            for (c = 0; c < stride; c++) v[c] = _mm_loadu_si128((const __m128i*) (s + 16 * c));
+                            PsychTexConvDeinterleave16(v, stride);
+                            for (c = 0; c < nrchannels; c++) planes[c][r] = v[c];
+                        }
+
+                        for (c = 0; c < nrchannels; c++) {
+                            PsychTexConvTranspose16x16(dst + (size_t) c * width * height + ix * height + iy, height, (const GLubyte*) planes[c], 16);
+                        }
+                    }
+                }
+
+                continue;
+            }
+            #endif
+
+            for (ix = tx; ix < tx1; ix++) {
+                for (c = 0; c < nrchannels; c++) d[c] = dst + (size_t) c * width * height + ix * height;
+                for (iy = ty; iy < ty1; iy++) {
+                    s = src + ((height - 1 - iy) * width + ix) * (size_t) stride;
+                    for (c = 0; c < nrchannels; c++) d[c][iy] = s[c];
+                }
+            }
+        }
+    }
+}
+
+static void PsychTexConvReadbackDouble(double* dst, const GLfloat* src, int nrchannels, int stride, size_t width, size_t height, size_t x0, size_t x1)
+{
+    const ptrdiff_t rowStride = -((ptrdiff_t) width * stride);
+    const GLfloat* s;
+    double* d[4];
+    size_t tx, ty, tx1, ty1, ix, iy;
+    int c;
+    #ifdef PSYCH_TEXCONV_SSE2
+    __m128 p[4];
+    #endif
+
+    for (tx = x0; tx < x1; tx += kPsychTexConvTileSize) {
+        tx1 = (tx + kPsychTexConvTileSize < x1) ? tx + kPsychTexConvTileSize : x1;
+        for (ty = 0; ty < height; ty += kPsychTexConvTileSize) {
+            ty1 = (ty + kPsychTexConvTileSize < height) ? ty + kPsychTexConvTileSize : height;
+
+            #ifdef PSYCH_TEXCONV_SSE2
+            // Single channel full tiles: Transpose in blocks of 4 x 4 pixels:
+            if ((stride == 1) && (tx1 - tx == kPsychTexConvTileSize) && (ty1 - ty == kPsychTexConvTileSize)) {
+                for (ix = tx; ix < tx1; ix += 4) {
+                    for (iy = ty; iy < ty1; iy += 4) {
+                        PsychTexConvTranspose4x4(dst + ix * height + iy, height, src + (height - 1 - iy) * width + ix, rowStride);
+                    }
+                }
+
+                continue;
+            }
+
+            // Four channel full tiles: Transpose the pixels of 4 rows in a column into 4 rows of planes:
+            if ((stride == 4) && (tx1 - tx == kPsychTexConvTileSize) && (ty1 - ty == kPsychTexConvTileSize)) {
+                for (ix = tx; ix < tx1; ix++) {
+                    for (iy = ty; iy < ty1; iy += 4) {
+                        s = src + ((height - 1 - iy) * width + ix) * 4;
+                        p[0] = _mm_loadu_ps(s);
+                        p[1] = _mm_loadu_ps(s + rowStride);
+                        p[2] = _mm_loadu_ps(s + 2 * rowStride);
+                        p[3] = _mm_loadu_ps(s + 3 * rowStride);
+                        _MM_TRANSPOSE4_PS(p[0], p[1], p[2], p[3]);
+                        for (c = 0; c < nrchannels; c++) PsychTexConvStoreDouble4(dst + (size_t) c * width * height + ix * height + iy, p[c]);
+                    }
+                }
+
+                continue;
+            }
+            #endif
+
+            for (ix = tx; ix < tx1; ix++) {
+                for (c = 0; c < nrchannels; c++) d[c] = dst + (size_t) c * width * height + ix * height;
+                for (iy = ty; iy < ty1; iy++) {
+                    s = src + ((height - 1 - iy) * width + ix) * (size_t) stride;
+                    for (c = 0; c < nrchannels; c++) d[c][iy] = (double) s[c];
+                }
+            }
+        }
+    }
+}
+
+// Execute pixels 'first' to 'last' - 1 of 'job':
+static void PsychTexConvRunJob(const PsychTexConvJob* job, size_t first, size_t last)
+{
+    const void* planes[4] = { NULL, NULL, NULL, NULL };
+    int k;
+
+    for (k = 0; k < job->nplanes; k++) planes[k] = (const void*) ((const char*) job->planes[k] + first * ((job->type == kPsychTexConvInterleave) ? sizeof(GLubyte) : sizeof(double)));
+
+    switch (job->type) {
+        case kPsychTexConvToFloat:
+            PsychTexConvToFloat((GLfloat*) job->dst + first * job->nplanes, (const double**) planes, job->nplanes, last - first, job->flushTiny);
+            break;
+
+        case kPsychTexConvToUByte:
+            PsychTexConvToUByte((GLubyte*) job->dst + first * job->nplanes, (const double**) planes, job->nplanes, last - first, job->scale);
+            break;
+
+        case kPsychTexConvInterleave:
+            PsychTexConvInterleave((GLubyte*) job->dst + first * job->nplanes, (const GLubyte**) planes, job->nplanes, last - first);
+            break;
+
+        case kPsychTexConvReadbackUByte:
+            PsychTexConvReadbackUByte((GLubyte*) job->dst, (const GLubyte*) job->src, job->nplanes, job->stride, job->npixels, job->rows, first, last);
+            break;
+
+        case kPsychTexConvReadbackDouble:
+            PsychTexConvReadbackDouble((double*) job->dst, (const GLfloat*) job->src, job->nplanes, job->stride, job->npixels, job->rows, first, last);
+            break;
+    }
+}
+
+// Grab and process chunks of the current job until none are left. Called with texConvMutex held:
+static void PsychTexConvProcessChunks(void)
+{
+    size_t first, last;
+    int chunk;
+
+    while (texConvNextChunk < texConvNumChunks) {
+        chunk = texConvNextChunk++;
+        PsychUnlockMutex(&texConvMutex);
+
+        first = (size_t) chunk * texConvChunkPixels;
+        last = (chunk == texConvNumChunks - 1) ? texConvJob.npixels : first + texConvChunkPixels;
+        PsychTexConvRunJob(&texConvJob, first, last);
+
+        PsychLockMutex(&texConvMutex);
+        if (++texConvChunksDone == texConvNumChunks) PsychSignalCondition(&texConvDoneSignal);
+    }
+}
+
+static void* PsychTexConvWorkerMain(void* arg)
+{
+    (void) arg;
+
+    PsychSetThreadName("PTB texconv");
+
+    PsychLockMutex(&texConvMutex);
+    while (!texConvPoolShutdown) {
+        PsychTexConvProcessChunks();
+        if (!texConvPoolShutdown) PsychWaitCondition(&texConvWorkSignal, &texConvMutex);
+    }
+    PsychUnlockMutex(&texConvMutex);
+
+    return(NULL);
+}
+
+static int PsychTexConvGetNumCPUs(void)
+{
+    #if PSYCH_SYSTEM == PSYCH_WINDOWS
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return((int) info.dwNumberOfProcessors);
+    #else
+    return((int) sysconf(_SC_NPROCESSORS_ONLN));
+    #endif
+}
+
+// Create worker pool with one thread less than the number of cpu cores, up to kPsychTexConvMaxThreads - 1:
+static void PsychTexConvInitPool(void)
+{
+    int i, numWorkers;
+
+    texConvPoolInitialized = TRUE;
+    texConvPoolShutdown = FALSE;
+    texConvNumWorkers = 0;
+
+    numWorkers = PsychTexConvGetNumCPUs() - 1;
+    if (numWorkers > kPsychTexConvMaxThreads - 1) numWorkers = kPsychTexConvMaxThreads - 1;
+    if (numWorkers < 1) return;
+
+    PsychInitMutex(&texConvMutex);
+    PsychInitCondition(&texConvWorkSignal, NULL);
+    PsychInitCondition(&texConvDoneSignal, NULL);
+    texConvSyncInitialized = TRUE;
+
+    for (i = 0; i < numWorkers; i++) {
+        if (PsychCreateThread(&texConvWorkers[i], NULL, PsychTexConvWorkerMain, NULL)) {
+            if (PsychPrefStateGet_Verbosity() > 1) printf("PTB-WARNING: Could not create worker thread for texture conversion. Using %i worker threads.\n", i);
+            break;
+        }
+
+        texConvNumWorkers++;
+    }
+
+    if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Using %i worker threads for texture conversion.\n", texConvNumWorkers);
+}
+
+void PsychExitTextureConversion(void)
+{
+    int i;
+
+    if (!texConvPoolInitialized) return;
+
+    if (texConvNumWorkers > 0) {
+        PsychLockMutex(&texConvMutex);
+        texConvPoolShutdown = TRUE;
+        PsychBroadcastCondition(&texConvWorkSignal);
+        PsychUnlockMutex(&texConvMutex);
+
+        for (i = 0; i < texConvNumWorkers; i++) PsychDeleteThread(&texConvWorkers[i]);
+    }
+
+    if (texConvSyncInitialized) {
+        PsychDestroyCondition(&texConvDoneSignal);
+        PsychDestroyCondition(&texConvWorkSignal);
+        PsychDestroyMutex(&texConvMutex);
+        texConvSyncInitialized = FALSE;
+    }
+
+    texConvNumWorkers = 0;
+    texConvPoolInitialized = FALSE;
+}
+
+// Execute 'job', split across the worker pool if it is big enough. Readback conversions
+// are split into chunks of columns:
+static void PsychTexConvExecute(PsychTexConvJob* job)
+{
+    size_t chunkPixels;
+    int numThreads;
+    char* env;
+
+    if (job->npixels * job->rows * (size_t) job->nplanes >= kPsychTexConvParallelThreshold) {
+        if (!texConvPoolInitialized) PsychTexConvInitPool();
+        numThreads = texConvNumWorkers + 1;
+
+        // Optional limit on number of threads, e.g., for benchmarking:
+        if ((env = getenv("PSYCH_TEXCONV_THREADS")) && (atoi(env) > 0) && (atoi(env) < numThreads)) numThreads = atoi(env);
+    }
+    else {
+        numThreads = 1;
+    }
+
+    // Chunks are a multiple of 32 pixels, so only the last chunk has leftover pixels for the scalar code,
+    // or partial tiles for readback conversions:
+    chunkPixels = (job->npixels / (size_t) (numThreads * kPsychTexConvChunksPerThread)) & ~((size_t) (kPsychTexConvTileSize - 1));
+
+    if ((numThreads <= 1) || (chunkPixels == 0)) {
+        PsychTexConvRunJob(job, 0, job->npixels);
+        return;
+    }
+
+    PsychLockMutex(&texConvMutex);
+    texConvJob = *job;
+    texConvNumChunks = numThreads * kPsychTexConvChunksPerThread;
+    texConvChunkPixels = chunkPixels;
+    texConvNextChunk = 0;
+    texConvChunksDone = 0;
+    PsychBroadcastCondition(&texConvWorkSignal);
+
+    // Help out, then wait for the workers to finish their last chunks:
+    PsychTexConvProcessChunks();
+    while (texConvChunksDone < texConvNumChunks) PsychWaitCondition(&texConvDoneSignal, &texConvMutex);
+    texConvNumChunks = 0;
+    PsychUnlockMutex(&texConvMutex);
+}
+
+void PsychConvertTexelsToFloat(GLfloat* dst, const double** planes, int nplanes, size_t npixels, psych_bool flushTiny)
+{
+    PsychTexConvJob job;
+
+    memset(&job, 0, sizeof(job));
+    job.type = kPsychTexConvToFloat;
+    job.dst = dst;
+    memcpy(job.planes, planes, (size_t) nplanes * sizeof(planes[0]));
+    job.nplanes = nplanes;
+    job.npixels = npixels;
+    job.rows = 1;
+    job.flushTiny = flushTiny;
+
+    PsychTexConvExecute(&job);
+}
+
+void PsychConvertTexelsToUByte(GLubyte* dst, const double** planes, int nplanes, size_t npixels, double scale)
+{
+    PsychTexConvJob job;
+
+    memset(&job, 0, sizeof(job));
+    job.type = kPsychTexConvToUByte;
+    job.dst = dst;
+    memcpy(job.planes, planes, (size_t) nplanes * sizeof(planes[0]));
+    job.nplanes = nplanes;
+    job.npixels = npixels;
+    job.rows = 1;
+    job.scale = scale;
+
+    PsychTexConvExecute(&job);
+}
+
+void PsychInterleaveTexels(GLubyte* dst, const GLubyte** planes, int nplanes, size_t npixels)
+{
+    PsychTexConvJob job;
+
+    memset(&job, 0, sizeof(job));
+    job.type = kPsychTexConvInterleave;
+    job.dst = dst;
+    memcpy(job.planes, planes, (size_t) nplanes * sizeof(planes[0]));
+    job.nplanes = nplanes;
+    job.npixels = npixels;
+    job.rows = 1;
+
+    PsychTexConvExecute(&job);
+}
+
+void PsychReadbackTexelsToUByte(GLubyte* dst, const GLubyte* src, int nrchannels, int stride, size_t width, size_t height)
+{
+    PsychTexConvJob job;
+
+    memset(&job, 0, sizeof(job));
+    job.type = kPsychTexConvReadbackUByte;
+    job.dst = dst;
+    job.src = src;
+    job.nplanes = nrchannels;
+    job.stride = stride;
+    job.npixels = width;
+    job.rows = height;
+
+    PsychTexConvExecute(&job);
+}
+
+void PsychReadbackTexelsToDouble(double* dst, const GLfloat* src, int nrchannels, int stride, size_t width, size_t height)
+{
+    PsychTexConvJob job;
+
+    memset(&job, 0, sizeof(job));
+    job.type = kPsychTexConvReadbackDouble;
+    job.dst = dst;
+    job.src = src;
+    job.nplanes = nrchannels;
+    job.stride = stride;
+    job.npixels = width;
+    job.rows = height;
+
+    PsychTexConvExecute(&job);
+}
@@ -0,0 +1,48 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTextureConversion.h
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Conversion of Matlab/Octave image matrices into texel buffers for OpenGL textures, as used
+		by Screen('MakeTexture'): Casting of double matrices to float or to scaled uint8 texels,
+		and interleaving of the separate color planes of column-major matrices into interleaved
+		texels. Also the reverse direction for Screen('GetImage'), which transposes and flips the
+		pixels read back from OpenGL into a Matlab/Octave matrix. Uses SSE2 on x86 and NEON on 64
+		bit ARM, and splits big images across a small pool of worker threads.
+
+		The environment variable PSYCH_TEXCONV_THREADS limits the number of threads used for one
+		conversion, e.g., a setting of 1 disables multi-threading.
+*/
+
+//include once
+#ifndef PSYCH_IS_INCLUDED_PsychTextureConversion
+#define PSYCH_IS_INCLUDED_PsychTextureConversion
+
+#include "Screen.h"
+
+// Convert 'npixels' pixels of the 'nplanes' double planes 'planes' into interleaved float texels in 'dst'.
+// If 'flushTiny' is set, values with a magnitude smaller than 1e-9 are flushed to zero:
+void PsychConvertTexelsToFloat(GLfloat* dst, const double** planes, int nplanes, size_t npixels, psych_bool flushTiny);
+
+// Convert 'npixels' pixels of the 'nplanes' double planes 'planes', multiplied by 'scale', into interleaved uint8 texels in 'dst':
+void PsychConvertTexelsToUByte(GLubyte* dst, const double** planes, int nplanes, size_t npixels, double scale);
+
+// Interleave 'npixels' pixels of the 'nplanes' uint8 planes 'planes' into texels in 'dst':
+void PsychInterleaveTexels(GLubyte* dst, const GLubyte** planes, int nplanes, size_t npixels);
+
+// Copy 'width' x 'height' pixels with 'nrchannels' components each from the pixel buffer 'src' returned by glReadPixels(),
+// with pixels 'stride' components apart, into the Matlab/Octave matrix 'dst':
+void PsychReadbackTexelsToUByte(GLubyte* dst, const GLubyte* src, int nrchannels, int stride, size_t width, size_t height);
+
+// Same for float pixels in 'src' into a double matrix 'dst':
+void PsychReadbackTexelsToDouble(double* dst, const GLfloat* src, int nrchannels, int stride, size_t width, size_t height);
+
+// Shutdown worker threads. Called at Screen exit:
+void PsychExitTextureConversion(void);
+
+//end include once
+#endif
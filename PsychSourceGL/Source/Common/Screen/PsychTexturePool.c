@@ -0,0 +1,362 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTexturePool.c
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Texture pool for many small textures. See PsychTexturePool.h for an overview.
+
+		Each onscreen window has a list of pages. A page is a rectangle texture of
+		kPsychTexturePoolPageSize texels squared, either of GL_LUMINANCE8 format for
+		luminance textures, or of GL_RGBA8 format for all other 8 bpc textures, as used by
+		PsychCreateTexture() for standalone textures. Slots are allocated in shelves: Rows
+		of slots of similar height, filled from left to right, stacked from top to bottom.
+		Slots of closed textures go into a free-list of the page for reuse by textures of
+		similar size, and a page gets deleted once its last texture is closed.
+
+		Each slot holds the texture plus a border of kPsychTexturePoolBorder texels, which
+		replicates the outermost texels of the texture, so bilinear filtering at the edges
+		of a texture samples the same values as with a standalone texture in clamp-to-edge
+		mode, instead of texels of its neighbours.
+*/
+
+#include "Screen.h"
+
+/* Allocate a slot of 'width' x 'height' texels in 'page'. Returns FALSE if the page is full. */
+static psych_bool PsychTexturePoolAllocSlot(PsychTexturePoolPage *page, int width, int height, PsychTexturePoolSlot *slot)
+{
+    int i, best, area, bestArea;
+
+    // Reuse the smallest free slot which fits, unless it would waste more than half of its area:
+    best = -1;
+    bestArea = 2 * width * height + 1;
+    for (i = 0; i < page->freeCount; i++) {
+        area = page->freeSlots[i].width * page->freeSlots[i].height;
+        if ((page->freeSlots[i].width >= width) && (page->freeSlots[i].height >= height) && (area < bestArea)) {
+            best = i;
+            bestArea = area;
+        }
+    }
+
+    if (best >= 0) {
+        *slot = page->freeSlots[best];
+        page->freeSlots[best] = page->freeSlots[--page->freeCount];
+        return(TRUE);
+    }
+
+    // Find the lowest shelf with enough room, which is less than twice as high as needed:
+    best = -1;
+    for (i = 0; i < page->shelfCount; i++) {
+        if ((page->shelfHeight[i] >= height) && (page->shelfHeight[i] < 2 * height) && (page->shelfX[i] + width <= page->width) &&
+            ((best < 0) || (page->shelfHeight[i] < page->shelfHeight[best]))) best = i;
+    }
+
+    // None? Start a new shelf if there is room left, otherwise settle for any shelf with enough room:
+    if ((best < 0) && (page->shelfCount < kPsychTexturePoolMaxShelves) && (page->usedHeight + height <= page->height)) {
+        best = page->shelfCount++;
+        page->shelfY[best] = page->usedHeight;
+        page->shelfHeight[best] = height;
+        page->shelfX[best] = 0;
+        page->usedHeight += height;
+    }
+
+    for (i = 0; (best < 0) && (i < page->shelfCount); i++) {
+        if ((page->shelfHeight[i] >= height) && (page->shelfX[i] + width <= page->width)) best = i;
+    }
+
+    if (best < 0) return(FALSE);
+
+    slot->x = page->shelfX[best];
+    slot->y = page->shelfY[best];
+    slot->width = width;
+    slot->height = page->shelfHeight[best];
+    page->shelfX[best] += width;
+
+    return(TRUE);
+}
+
+/* Create a new empty page of 'internalFormat' for the pool of onscreen window 'parentRecord'. Returns NULL on failure. */
+static PsychTexturePoolPage* PsychTexturePoolCreatePage(PsychWindowRecordType *parentRecord, GLint internalFormat)
+{
+    PsychTexturePoolPage *page;
+
+    page = (PsychTexturePoolPage*) calloc(1, sizeof(PsychTexturePoolPage));
+    if (NULL == page) return(NULL);
+
+    page->internalFormat = internalFormat;
+    page->width = page->height = (parentRecord->maxTextureSize > 0 && parentRecord->maxTextureSize < kPsychTexturePoolPageSize) ? parentRecord->maxTextureSize : kPsychTexturePoolPageSize;
+
+    // Make sure we don't have any dangling GL errors from other operations, as we check for errors below:
+    while (glGetError() != GL_NO_ERROR);
+
+    glGenTextures(1, &page->textureNumber);
+    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, page->textureNumber);
+    glTexImage2D(GL_TEXTURE_RECTANGLE_EXT, 0, internalFormat, page->width, page->height, 0, (internalFormat == GL_LUMINANCE8) ? GL_LUMINANCE : GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
+
+    // Out of memory or other failure? Caller will create a standalone texture instead:
+    if (glGetError() != GL_NO_ERROR) {
+        if (PsychPrefStateGet_Verbosity() > 3) printf("PTB-INFO: Failed to create a new %i x %i texels page for the texture pool. Creating a standalone texture instead.\n", page->width, page->height);
+        glDeleteTextures(1, &page->textureNumber);
+        free(page);
+        return(NULL);
+    }
+
+    if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Created new %i x %i texels %s page for the texture pool.\n", page->width, page->height, (internalFormat == GL_LUMINANCE8) ? "LUMINANCE8" : "RGBA8");
+
+    page->next = parentRecord->texturePool;
+    parentRecord->texturePool = page;
+
+    return(page);
+}
+
+/* Upload image data of texture 'win' of 'width' x 'height' texels into its slot, including the replicated border. */
+static void PsychTexturePoolUpload(PsychWindowRecordType *win, int width, int height)
+{
+    unsigned char *src, *dst, *row;
+    size_t bpp, srcStride, dstStride;
+    int y, srcY, b;
+    GLenum format, type;
+
+    bpp = (size_t) win->depth / 8;
+    srcStride = (size_t) width * bpp;
+    if (win->textureByteAligned > 1) srcStride = (srcStride + win->textureByteAligned - 1) / win->textureByteAligned * win->textureByteAligned;
+    // Only texture plus border gets uploaded, even if the texture got a wider recycled slot:
+    dstStride = (size_t) (width + 2 * kPsychTexturePoolBorder) * bpp;
+
+    // Build the image with border in temporary memory, so the whole slot gets uploaded in one go:
+    src = (unsigned char*) win->textureMemory;
+    dst = (unsigned char*) PsychMallocTemp(dstStride * (size_t) (height + 2 * kPsychTexturePoolBorder));
+    for (y = 0; y < height + 2 * kPsychTexturePoolBorder; y++) {
+        srcY = y - kPsychTexturePoolBorder;
+        if (srcY < 0) srcY = 0;
+        if (srcY >= height) srcY = height - 1;
+
+        row = &dst[(size_t) y * dstStride];
+        memcpy(&row[kPsychTexturePoolBorder * bpp], &src[(size_t) srcY * srcStride], (size_t) width * bpp);
+        for (b = 0; b < kPsychTexturePoolBorder; b++) {
+            memcpy(&row[b * bpp], &src[(size_t) srcY * srcStride], bpp);
+            memcpy(&row[(kPsychTexturePoolBorder + width + b) * bpp], &src[(size_t) srcY * srcStride + (size_t) (width - 1) * bpp], bpp);
+        }
+    }
+
+    // Same external formats and types as in PsychCreateTexture():
+    type = GL_UNSIGNED_BYTE;
+    switch (win->depth) {
+        case 8:
+            format = GL_LUMINANCE;
+            break;
+
+        case 16:
+            format = GL_LUMINANCE_ALPHA;
+            break;
+
+        case 24:
+            format = GL_RGB;
+            break;
+
+        default:
+            format = GL_BGRA;
+            if (!(win->gfxcaps & kPsychGfxCapNeedsUnsignedByteRGBATextureUpload)) type = GL_UNSIGNED_INT_8_8_8_8_REV;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, win->textureNumber);
+    glTexSubImage2D(GL_TEXTURE_RECTANGLE_EXT, 0, win->texturePoolSlot.x, win->texturePoolSlot.y, width + 2 * kPsychTexturePoolBorder,
+                    height + 2 * kPsychTexturePoolBorder, format, type, dst);
+    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
+
+    return;
+}
+
+/* PsychTexturePoolCreateTexture()
+ *
+ * Store the image data of the texture 'win', as prepared by Screen('MakeTexture') for PsychCreateTexture(),
+ * in a slot of a page of the texture pool of its onscreen window, creating a new page if needed. Only
+ * possible for small 8 bpc textures without special format, on desktop OpenGL with rectangle textures,
+ * and if textures aren't stored in client memory. Returns FALSE if the texture can't be pooled, so the
+ * caller must create a standalone texture via PsychCreateTexture().
+ */
+psych_bool PsychTexturePoolCreateTexture(PsychWindowRecordType *win)
+{
+    PsychWindowRecordType *parentRecord;
+    PsychTexturePoolPage *page;
+    PsychTexturePoolSlot slot;
+    GLint internalFormat;
+    int width, height;
+
+    PsychSetGLContext(win);
+
+    if (!PsychIsGLClassic(win) || PsychIsGLES(win) || (PsychGetTextureTarget(win) != GL_TEXTURE_RECTANGLE_EXT) || (win->textureNumber != 0) ||
+        (win->textureinternalformat != 0) || (PsychPrefStateGet_ConserveVRAM() & kPsychDontCacheTextures) ||
+        ((win->depth != 8) && (win->depth != 16) && (win->depth != 24) && (win->depth != 32))) return(FALSE);
+
+    // Size of the texture in internal storage, transposed as in PsychCreateTexture():
+    if (win->textureOrientation == 0 || win->textureOrientation == 1) {
+        width = (int) PsychGetHeightFromRect(win->rect);
+        height = (int) PsychGetWidthFromRect(win->rect);
+    }
+    else {
+        width = (int) PsychGetWidthFromRect(win->rect);
+        height = (int) PsychGetHeightFromRect(win->rect);
+    }
+
+    if ((width < 1) || (height < 1) || (width > kPsychTexturePoolMaxTextureSize) || (height > kPsychTexturePoolMaxTextureSize)) return(FALSE);
+
+    internalFormat = (win->depth == 8) ? GL_LUMINANCE8 : GL_RGBA8;
+    parentRecord = PsychGetParentWindow(win);
+
+    // First page of matching format with room for the texture, or a new page:
+    for (page = parentRecord->texturePool; page; page = page->next) {
+        if ((page->internalFormat == internalFormat) &&
+            PsychTexturePoolAllocSlot(page, width + 2 * kPsychTexturePoolBorder, height + 2 * kPsychTexturePoolBorder, &slot)) break;
+    }
+
+    if (NULL == page) {
+        page = PsychTexturePoolCreatePage(parentRecord, internalFormat);
+        if (NULL == page) return(FALSE);
+
+        // Texture doesn't fit even into an empty page? Delete the page again, it is still first in the list:
+        if (!PsychTexturePoolAllocSlot(page, width + 2 * kPsychTexturePoolBorder, height + 2 * kPsychTexturePoolBorder, &slot)) {
+            parentRecord->texturePool = page->next;
+            glDeleteTextures(1, &page->textureNumber);
+            free(page);
+            return(FALSE);
+        }
+    }
+
+    page->refCount++;
+    win->texturePoolPage = page;
+    win->texturePoolSlot = slot;
+    win->textureNumber = page->textureNumber;
+    win->texturetarget = GL_TEXTURE_RECTANGLE_EXT;
+    win->bpc = 8;
+
+    PsychTexturePoolUpload(win, width, height);
+
+    // Accounting: Only the share of the page used by this texture:
+    win->surfaceSizeBytes = ((size_t) ((internalFormat == GL_RGBA8) ? 4 : 1)) * (size_t) slot.width * (size_t) slot.height;
+
+    // Free system RAM backing memory buffer, as PsychCreateTexture() does:
+    if (win->textureMemory && (win->textureMemorySizeBytes > 0)) free(win->textureMemory);
+    win->textureMemory = NULL;
+    win->textureMemorySizeBytes = 0;
+
+    // Client rect of a texture is always == rect of it:
+    PsychCopyRect(win->clientrect, win->rect);
+
+    return(TRUE);
+}
+
+/* PsychTexturePoolReleaseTexture()
+ *
+ * Put the slot of pooled texture 'win' into the free-list of its page, and delete the page if this
+ * was its last texture. Called with the OpenGL context of 'win' bound.
+ */
+void PsychTexturePoolReleaseTexture(PsychWindowRecordType *win)
+{
+    PsychWindowRecordType *parentRecord;
+    PsychTexturePoolPage *page, **link;
+
+    page = win->texturePoolPage;
+    win->texturePoolPage = NULL;
+    win->textureNumber = 0;
+
+    if (--page->refCount > 0) {
+        // Slots beyond the capacity of the free-list stay unused until the page gets deleted:
+        if (page->freeCount < kPsychTexturePoolMaxFreeSlots) page->freeSlots[page->freeCount++] = win->texturePoolSlot;
+        return;
+    }
+
+    // Last texture of this page: Unlink and delete page:
+    parentRecord = PsychGetParentWindow(win);
+    for (link = &parentRecord->texturePool; *link; link = &((*link)->next)) {
+        if (*link == page) {
+            *link = page->next;
+            break;
+        }
+    }
+
+    glDeleteTextures(1, &page->textureNumber);
+    free(page);
+
+    return;
+}
+
+/* PsychTexturePoolDestroy()
+ *
+ * Delete all pages of the texture pool of onscreen window 'windowRecord'. Called at window close time
+ * with the OpenGL context of the window bound. Textures stored in them become invalid and get detached
+ * from their pages by the caller.
+ */
+void PsychTexturePoolDestroy(PsychWindowRecordType *windowRecord)
+{
+    PsychTexturePoolPage *page;
+
+    while ((page = windowRecord->texturePool)) {
+        windowRecord->texturePool = page->next;
+        glDeleteTextures(1, &page->textureNumber);
+        free(page);
+    }
+
+    return;
+}
+
+/* PsychTexturePoolGetStats()
+ *
+ * Return number of pages 'numPages' and their approximate memory consumption 'numBytes' for the
+ * texture pool of the onscreen window of 'windowRecord'.
+ */
+void PsychTexturePoolGetStats(PsychWindowRecordType *windowRecord, int *numPages, double *numBytes)
+{
+    PsychTexturePoolPage *page;
+
+    *numPages = 0;
+    *numBytes = 0;
+
+    for (page = PsychGetParentWindow(windowRecord)->texturePool; page; page = page->next) {
+        *numPages += 1;
+        *numBytes += (double) page->width * (double) page->height * ((page->internalFormat == GL_RGBA8) ? 4 : 1);
+    }
+
+    return;
+}
+
+/* PsychTexturePoolCheckUnsupported()
+ *
+ * Pooled textures don't have an OpenGL texture of their own, so they can't be drawn into, transformed,
+ * or handed out to external OpenGL code. Error-abort with a message about 'operation' if 'win' is one.
+ */
+void PsychTexturePoolCheckUnsupported(PsychWindowRecordType *win, const char *operation)
+{
+    if (win->texturePoolPage) {
+        printf("PTB-ERROR: Tried to %s a texture which was created via Screen('MakeTexture') with specialFlags 64, and is therefore\n", operation);
+        printf("PTB-ERROR: stored in the texture pool for small textures. This is not supported for such textures. Create the texture\n");
+        printf("PTB-ERROR: without specialFlags 64 if you need this.\n");
+        PsychErrorExitMsg(PsychError_user, "Operation not supported on texture from the texture pool for small textures.");
+    }
+
+    return;
+}
+
+/* PsychCanBatchBlitTextures()
+ *
+ * Returns TRUE if textures 'a' and 'b' can be drawn in one batch by PsychBatchBlitTexturesToDisplay(),
+ * i.e., if they are the same texture, or pooled textures in the same page with the same orientation and
+ * shaders, so they only differ in texture coordinates.
+ */
+psych_bool PsychCanBatchBlitTextures(PsychWindowRecordType *a, PsychWindowRecordType *b)
+{
+    if (a == b) return(TRUE);
+
+    return((a->texturePoolPage != NULL) && (a->texturePoolPage == b->texturePoolPage) && (a->textureOrientation == b->textureOrientation) &&
+           (a->textureFilterShader == b->textureFilterShader) && (a->textureLookupShader == b->textureLookupShader));
+}
@@ -0,0 +1,44 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTexturePool.h
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Texture pool for many small textures: Textures created via Screen('MakeTexture') with
+		specialFlags 64 don't get their own OpenGL texture object, but are packed into a slot of
+		a large rectangle texture, a page of the pool of their onscreen window. All pooled
+		textures of the same internal format share pages, so drawing many of them via
+		Screen('DrawTextures') or in deferred drawing mode is one batch with one texture bind,
+		instead of one batch per texture. Texture coordinates are remapped into the slot by
+		the texture blitters in PsychTextureSupport.c.
+*/
+
+//include once
+#ifndef PSYCH_IS_INCLUDED_PsychTexturePool
+#define PSYCH_IS_INCLUDED_PsychTexturePool
+
+#include "Screen.h"
+
+// Store texture 'win' in the texture pool instead of creating an OpenGL texture. Returns FALSE if not possible:
+psych_bool PsychTexturePoolCreateTexture(PsychWindowRecordType *win);
+
+// Release the slot of pooled texture 'win' in its page:
+void PsychTexturePoolReleaseTexture(PsychWindowRecordType *win);
+
+// Delete all pages of the texture pool of onscreen window 'windowRecord' at window close:
+void PsychTexturePoolDestroy(PsychWindowRecordType *windowRecord);
+
+// Return number of pages and their memory consumption in bytes for the texture pool of the onscreen window of 'windowRecord':
+void PsychTexturePoolGetStats(PsychWindowRecordType *windowRecord, int *numPages, double *numBytes);
+
+// Error-abort if 'win' is a pooled texture, for operations unsupported on pooled textures:
+void PsychTexturePoolCheckUnsupported(PsychWindowRecordType *win, const char *operation);
+
+// Can textures 'a' and 'b' be drawn in one batch by PsychBatchBlitTexturesToDisplay()?
+psych_bool PsychCanBatchBlitTextures(PsychWindowRecordType *a, PsychWindowRecordType *b);
+
+//end include once
+#endif
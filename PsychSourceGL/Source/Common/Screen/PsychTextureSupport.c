@@ -620,6 +620,18 @@ void PsychCreateTexture(PsychWindowRecordType *win)
     return;
 }
 
+/*
+ *    PsychAddTextureMemoryEstimate()
+ *
+ *    Account for the memory of texture 'win' if its OpenGL texture was created outside of PsychCreateTexture(),
+ *    e.g., for a background upload, so PsychFreeTextureForWindowRecord() can subtract it again.
+ *
+ */
+void PsychAddTextureMemoryEstimate(PsychWindowRecordType *win)
+{
+    texmemguesstimate+= win->surfaceSizeBytes;
+}
+
 /*
  *    PsychFreeTextureForWindowRecord()
  *
@@ -649,6 +661,12 @@ void PsychFreeTextureForWindowRecord(PsychWindowRecordType *win)
         // work for some strange reason :(
         if ((win->textureMemory) && (win->textureNumber > 0)) glFinish(); // FinishObjectAPPLE(GL_TEXTURE_2D, win->textureNumber);
 
+        // Upload thread must be done with a pending background upload before the texture can be deleted:
+        PsychTextureUploadCancel(win);
+
+        // Pooled textures only release their slot in the shared page of the texture pool:
+        if (win->texturePoolPage) PsychTexturePoolReleaseTexture(win);
+
         // Perform standard OpenGL texture cleanup if needed:
         if (win->textureNumber != 0) {
             glDeleteTextures(1, &win->textureNumber);
@@ -693,6 +711,9 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
         PsychSetGLContext(target);
     }
 
+    // Wait for completion of a pending background upload of the texture:
+    PsychTextureUploadWait(source);
+
     // Setup texture-target if not already done:
     PsychDetectTextureTarget(target);
 
@@ -743,6 +764,14 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
         sourceYEnd=sourceHeight - sourceRect[kPsychTop];
     }
 
+    // Pooled textures are stored in a slot of a page of the texture pool. Shift texture coordinates into the slot:
+    if (source->texturePoolPage) {
+        sourceX+=source->texturePoolSlot.x + kPsychTexturePoolBorder;
+        sourceXEnd+=source->texturePoolSlot.x + kPsychTexturePoolBorder;
+        sourceY+=source->texturePoolSlot.y + kPsychTexturePoolBorder;
+        sourceYEnd+=source->texturePoolSlot.y + kPsychTexturePoolBorder;
+    }
+
     // Special case handling for GL_TEXTURE_2D textures. We need to map the
     // absolute texture coordinates (in pixels) to the interval 0.0 - 1.0 where
     // 1.0 == full extent of power of two texture...
@@ -1281,6 +1310,12 @@ void PsychMapTexCoord(PsychWindowRecordType *tex, double* tx, double* ty)
         sourceY=*ty;
     }
 
+    // Pooled textures are stored in a slot of a page of the texture pool:
+    if (tex->texturePoolPage) {
+        sourceX+=tex->texturePoolSlot.x + kPsychTexturePoolBorder;
+        sourceY+=tex->texturePoolSlot.y + kPsychTexturePoolBorder;
+    }
+
     // Special case handling for GL_TEXTURE_2D textures. We need to map the
     // absolute texture coordinates (in pixels) to the interval 0.0 - 1.0 where
     // 1.0 == full extent of power of two texture...
@@ -1326,7 +1361,70 @@ static float transX, transY;
 static float crt, srt;
 static unsigned int useXForm = 0;
 
-static inline void glVertexXform(GLfloat x, GLfloat y)
+// State of the current batch of PsychBatchBlitTexturesToDisplay(): Vertex data of all items of
+// the batch, allocated at the first item. In instanced mode it holds kPsychInstanceFloats floats
+// of per instance attributes for each item, otherwise 4 vertices of batchStride floats each:
+#define kPsychInstanceFloats 16
+static GLfloat *batchData = NULL;
+static unsigned int batchCapacity = 0;
+static unsigned int batchAllocated = 0;
+static int batchStride = 0;
+static psych_bool batchInstanced = FALSE;
+static GLint instanceAttribs[4];
+static int attribOffsets[12];
+static GLfloat attribValues[12][4];
+
+// Shaders for instanced drawing of texture batches: Each texture is drawn as one instance of the
+// unit square in gl_Vertex, mapped to its 'dstRect' target rectangle. 'texRect' encodes the texture
+// coordinates of the corners of the source rectangle, as left, top, right, bottom, but swapped for
+// textures in transposed orientation. 'rotation' encodes cosine and sine of the rotation angle for
+// rotation of the quad in .xy, or of the texture coordinates in .zw:
+static char instancedBlitVertexShaderSrc[] =
+"\n"
+"uniform float swapTexCoords;\n"
+"attribute vec4 dstRect;\n"
+"attribute vec4 texRect;\n"
+"attribute vec4 rotation;\n"
+"attribute vec4 modulateColor;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    vec2 corner = gl_Vertex.xy;\n"
+"    vec2 pos = mix(dstRect.xy, dstRect.zw, corner);\n"
+"    vec2 tc = mix(vec2(mix(texRect.x, texRect.z, corner.x), mix(texRect.w, texRect.y, corner.y)),\n"
+"                  vec2(mix(texRect.x, texRect.z, corner.y), mix(texRect.y, texRect.w, corner.x)), swapTexCoords);\n"
+"    vec2 center = 0.5 * (dstRect.xy + dstRect.zw);\n"
+"\n"
+"    pos = center + mat2(rotation.x, rotation.y, -rotation.y, rotation.x) * (pos - center);\n"
+"    center = 0.5 * (texRect.xy + texRect.zw);\n"
+"    tc = center + mat2(rotation.z, rotation.w, -rotation.w, rotation.z) * (tc - center);\n"
+"\n"
+"    gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 0.0, 1.0);\n"
+"    gl_TexCoord[0] = gl_TextureMatrix[0] * vec4(tc, 0.0, 1.0);\n"
+"    gl_FrontColor = modulateColor;\n"
+"}\n";
+
+static char instancedBlitRectFragmentShaderSrc[] =
+"\n"
+"#extension GL_ARB_texture_rectangle : enable\n"
+"\n"
+"uniform sampler2DRect Image;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    gl_FragColor = texture2DRect(Image, gl_TexCoord[0].st) * gl_Color;\n"
+"}\n";
+
+static char instancedBlit2DFragmentShaderSrc[] =
+"\n"
+"uniform sampler2D Image;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    gl_FragColor = texture2D(Image, gl_TexCoord[0].st) * gl_Color;\n"
+"}\n";
+
+static inline void PsychVertexXform(GLfloat x, GLfloat y, GLfloat *xy)
 {
     GLfloat xo, yo;
 
@@ -1345,10 +1443,11 @@ static inline void glVertexXform(GLfloat x, GLfloat y)
         yo = y;
     }
 
-    glVertex2f(xo, yo);
+    xy[0] = xo;
+    xy[1] = yo;
 }
 
-static inline void glTexCoordXform(GLfloat x, GLfloat y)
+static inline void PsychTexCoordXform(GLfloat x, GLfloat y, GLfloat *xy)
 {
     GLfloat xo, yo;
 
@@ -1367,36 +1466,176 @@ static inline void glTexCoordXform(GLfloat x, GLfloat y)
         yo = y;
     }
 
-    glTexCoord2f(xo, yo);
+    xy[0] = xo;
+    xy[1] = yo;
+}
+
+/* Setup instanced drawing of a batch of textures from 'source' of type 'texturetarget' into 'target':
+ * Binds the instanced drawing shader and returns TRUE on success, or returns FALSE if instanced drawing
+ * is unsupported, disabled via ConserveVRAM setting kPsychDontUseInstancedTextureBlits, or the texture
+ * type can't be handled.
+ */
+static psych_bool PsychSetupInstancedBlit(PsychWindowRecordType *target, PsychWindowRecordType *source, GLenum texturetarget)
+{
+    PsychWindowRecordType *parentRecord = PsychGetParentWindow(target);
+    int i = (texturetarget == GL_TEXTURE_2D) ? 1 : 0;
+    GLuint shader;
+
+    if (parentRecord->instancedBlitUnsupported || (source->textureNumber <= 0) || !PsychIsGLClassic(target) ||
+        ((texturetarget != GL_TEXTURE_2D) && (texturetarget != GL_TEXTURE_RECTANGLE_EXT)) ||
+        (PsychPrefStateGet_ConserveVRAM() & kPsychDontUseInstancedTextureBlits))
+        return(FALSE);
+
+    // Create shader at first use:
+    if (0 == parentRecord->instancedBlitShader[i]) {
+        shader = 0;
+        if (glUseProgram && glDrawArraysInstancedARB && glVertexAttribDivisorARB && glGetAttribLocationARB)
+            shader = PsychCreateGLSLProgram((i == 1) ? instancedBlit2DFragmentShaderSrc : instancedBlitRectFragmentShaderSrc, instancedBlitVertexShaderSrc, NULL);
+
+        if (0 == shader) {
+            if (PsychPrefStateGet_Verbosity() > 2) printf("PTB-INFO: Instanced drawing of textures unsupported. Screen('DrawTextures') may be slower for many textures.\n");
+            parentRecord->instancedBlitUnsupported = TRUE;
+            return(FALSE);
+        }
+
+        glUseProgram(shader);
+        glUniform1i(glGetUniformLocation(shader, "Image"), 0);
+        parentRecord->instancedBlitShader[i] = shader;
+    }
+
+    shader = parentRecord->instancedBlitShader[i];
+    PsychSetShader(target, (int) shader);
+
+    instanceAttribs[0] = glGetAttribLocationARB(shader, "dstRect");
+    instanceAttribs[1] = glGetAttribLocationARB(shader, "texRect");
+    instanceAttribs[2] = glGetAttribLocationARB(shader, "rotation");
+    instanceAttribs[3] = glGetAttribLocationARB(shader, "modulateColor");
+    if ((instanceAttribs[0] < 0) || (instanceAttribs[1] < 0) || (instanceAttribs[2] < 0) || (instanceAttribs[3] < 0)) {
+        PsychSetShader(target, 0);
+        return(FALSE);
+    }
+
+    // Texture coordinate assignment depends on internal texture orientation, as in PsychBatchBlitTexturesToDisplay():
+    glUniform1f(glGetUniformLocation(shader, "swapTexCoords"), (source->textureOrientation >= 2 && source->textureOrientation <= 4) ? 0.0f : 1.0f);
+
+    return(TRUE);
+}
+
+/* Draw the current batch of 'index' textures into 'target' with one instanced draw call: */
+static void PsychDrawInstancedBlitBatch(PsychWindowRecordType *target, unsigned int index)
+{
+    static const GLfloat corners[8] = { 0, 0, 0, 1, 1, 1, 1, 0 };
+    size_t nbytes = (size_t) index * kPsychInstanceFloats * sizeof(GLfloat);
+    const GLvoid *cornerptr;
+    const unsigned char *dataptr;
+    psych_bool streamed;
+    int i;
+
+    streamed = PsychVertexStreamBegin(target, sizeof(corners) + nbytes);
+    if (streamed) {
+        cornerptr = PsychVertexStreamPush(target, corners, sizeof(corners));
+        dataptr = (const unsigned char*) PsychVertexStreamPush(target, batchData, nbytes);
+    }
+    else {
+        cornerptr = corners;
+        dataptr = (const unsigned char*) batchData;
+    }
+
+    // Corners of the unit square as per vertex data, everything else as per instance data:
+    glVertexPointer(2, GL_FLOAT, 0, cornerptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    for (i = 0; i < 4; i++) {
+        glVertexAttribPointerARB(instanceAttribs[i], 4, GL_FLOAT, GL_FALSE, kPsychInstanceFloats * sizeof(GLfloat), dataptr + i * 4 * sizeof(GLfloat));
+        glEnableVertexAttribArrayARB(instanceAttribs[i]);
+        glVertexAttribDivisorARB(instanceAttribs[i], 1);
+    }
+    if (streamed) PsychVertexStreamEnd(target);
+
+    glDrawArraysInstancedARB(GL_TRIANGLE_FAN, 0, 4, (GLsizei) index);
+
+    for (i = 0; i < 4; i++) {
+        glVertexAttribDivisorARB(instanceAttribs[i], 0);
+        glDisableVertexAttribArrayARB(instanceAttribs[i]);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, NULL);
+
+    // Leave color of last texture as current color, as immediate mode drawing would:
+    glColor4fv(&batchData[(index - 1) * kPsychInstanceFloats + 12]);
+
+    PsychSetShader(target, 0);
+}
+
+/* Draw the current batch of 'index' textures into 'target' as one vertex array of quads: */
+static void PsychDrawBlitBatch(PsychWindowRecordType *target, unsigned int index, GLint *attribs)
+{
+    size_t nbytes = (size_t) index * 4 * batchStride * sizeof(GLfloat);
+    GLsizei stride = batchStride * sizeof(GLfloat);
+    const unsigned char *dataptr;
+    const GLfloat *lastvertex;
+    psych_bool streamed;
+    int i;
+
+    streamed = PsychVertexStreamBegin(target, nbytes);
+    dataptr = (streamed) ? (const unsigned char*) PsychVertexStreamPush(target, batchData, nbytes) : (const unsigned char*) batchData;
+
+    glVertexPointer(2, GL_FLOAT, stride, dataptr);
+    glTexCoordPointer(2, GL_FLOAT, stride, dataptr + 2 * sizeof(GLfloat));
+    glColorPointer(4, GL_FLOAT, stride, dataptr + 4 * sizeof(GLfloat));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    for (i = 0; i < 12; i++) {
+        if (attribs[i] < 0) continue;
+        glVertexAttribPointerARB(attribs[i], 4, GL_FLOAT, GL_FALSE, stride, dataptr + attribOffsets[i] * sizeof(GLfloat));
+        glEnableVertexAttribArrayARB(attribs[i]);
+    }
+    if (streamed) PsychVertexStreamEnd(target);
+
+    glDrawArrays(GL_QUADS, 0, (GLsizei) index * 4);
+
+    for (i = 0; i < 12; i++) {
+        if (attribs[i] >= 0) glDisableVertexAttribArrayARB(attribs[i]);
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glColorPointer(4, GL_FLOAT, 0, NULL);
+    glTexCoordPointer(2, GL_FLOAT, 0, NULL);
+    glVertexPointer(2, GL_FLOAT, 0, NULL);
+
+    // Leave color and vertex attributes of last texture as current values, as immediate mode drawing would:
+    lastvertex = &batchData[(index * 4 - 1) * batchStride];
+    glColor4fv(&lastvertex[4]);
+    for (i = 0; i < 12; i++) {
+        if (attribs[i] >= 0) glVertexAttrib4fvARB(attribs[i], &lastvertex[attribOffsets[i]]);
+    }
 }
 
 void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, PsychWindowRecordType *source, PsychWindowRecordType *target, double *sourceRect, double *targetRect,
                                      double rotationAngle, int filterMode, double globalAlpha)
 {
     static unsigned int index = 0;
-    static float *vertices, *colors, *texcoords;
 
-    static GLint attribs[11];
+    static GLint attribs[12];
     static GLenum texturetarget;
     static GLint textureNumber = -1;
-    static GLint mattrib = -1;
     static GLuint shader = 0;
     static int tWidth = 0, tHeight = 0;
     static double oldRotationAngle;
     static GLdouble sourceWidth, sourceHeight;
     GLdouble sourceX, sourceY, sourceXEnd, sourceYEnd;
-
-    (void) count;
+    GLfloat tc[4][2], pos[4][2], color[4], *v;
+    int i, j;
 
     if (opMode == 0) {
-        // Start new batch:
-        if (vertices || colors || texcoords)
-            PsychErrorExitMsg(PsychError_internal, "Non-NULL arrays at start of batch for opMode 0!\n");
-
+        // Start new batch of at most 'count' textures. Vertex data gets allocated at the first item,
+        // and grown as needed, as 'count' is only an upper bound for the length of the batch:
         index = 0;
-        //vertices = malloc(count * 2 *sizeof(float));
-        //colors = malloc(count * 4 * sizeof(float));
-        //texcoords = malloc(count * 2 * sizeof(float));
+        batchData = NULL;
+        batchCapacity = count;
+        batchAllocated = 0;
+        textureNumber = -1;
 
         // Enable targets framebuffer as current drawingtarget, except if this is a
         // blit operation from a window into itself and the imaging pipe is on:
@@ -1420,8 +1659,14 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
         // Finalize this batch:
 
         // DRAW DRAW DRAW DRAW!
-
-        glEnd();
+        if (index > 0) {
+            if (batchInstanced) {
+                PsychDrawInstancedBlitBatch(target, index);
+            }
+            else {
+                PsychDrawBlitBatch(target, index, attribs);
+            }
+        }
 
         // Disable Transform:
         useXForm = 0;
@@ -1446,17 +1691,19 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
             glDisable(texturetarget);
         }
 
-        //free(vertices);
-        vertices = NULL;
-        //free(colors);
-        colors = NULL;
-        //free(texcoords);
-        texcoords = NULL;
+        // Release vertex data, so a Screen call with many batches doesn't accumulate temporary memory:
+        if (batchData) PsychFreeTemp(batchData);
+        batchData = NULL;
+        batchAllocated = 0;
 
         return;
     }
 
     // opMode 2: Add a new texture to buffers:
+    if (index >= batchCapacity) PsychErrorExitMsg(PsychError_internal, "Too many textures added to batch in opMode 2!\n");
+
+    // Wait for completion of a pending background upload of the texture:
+    PsychTextureUploadWait(source);
 
     // First element to draw? Need some more setup from information derived from
     // first item:
@@ -1669,17 +1916,20 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
             attribs[9] = glGetAttribLocationARB(shader, "auxParameters6");
             attribs[10] = glGetAttribLocationARB(shader, "auxParameters7");
         }
+        else {
+            for (i = 0; i < 11; i++) attribs[i] = -1;
+        }
 
         if (shader > 0) {
             // In case our texture (filter)/(lookup) shader also requests/defines a 'modulateColor'
             // attribute in its vertex shader part, this attribute is assigned the
             // unclamped RGBA 'modulateColor' after normalization via the colorrange
             // value of Screen('ColorRange'), or the unclamped globalAlpha value:
-            mattrib = glGetAttribLocationARB(shader, "modulateColor");
+            attribs[11] = glGetAttribLocationARB(shader, "modulateColor");
         }
         else {
             // Not needed:
-            mattrib = -1;
+            attribs[11] = -1;
         }
 
         // Setup texture wrap-mode: We usually default to clamping - the best we can do
@@ -1704,11 +1954,16 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
         // global blending without need for a texture alpha-channel...
         glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
-        // Test for standard case: No shader requested for this texture. In that case we make sure that really no shader is bound.
+        // Test for standard case: No shader requested for this texture. In that case we draw the whole
+        // batch via instanced drawing with our own minimal shader if possible, or make sure that really
+        // no shader is bound.
         if (shader == 0) {
-            PsychSetShader(target, 0);
+            batchInstanced = PsychSetupInstancedBlit(target, source, texturetarget);
+            if (!batchInstanced) PsychSetShader(target, 0);
         }
         else {
+            batchInstanced = FALSE;
+
             #if PSYCH_SYSTEM == PSYCH_OSX
             // On OS-X we can query the OS if the bound shader is running on the GPU or if it is running in emulation mode on the CPU.
             // This is an expensive operation - it triggers OpenGL internal state revalidation. Only use for debugging and testing!
@@ -1723,11 +1978,54 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
 
         textureNumber = source->textureNumber;
 
-        glBegin(GL_QUADS);
+        // Vertex data layout of the batch. Without instancing, each item is a quad of 4 vertices
+        // with position, texture coordinates, color and all used generic attributes:
+        if (batchInstanced) {
+            batchStride = kPsychInstanceFloats;
+        }
+        else {
+            batchStride = 8;
+            for (i = 0; i < 12; i++) {
+                if (attribs[i] < 0) continue;
+                attribOffsets[i] = batchStride;
+                batchStride += 4;
+
+                // Items without 'auxParameters' keep the current values, as in immediate mode:
+                glGetVertexAttribfvARB(attribs[i], GL_CURRENT_VERTEX_ATTRIB_ARB, attribValues[i]);
+            }
+        }
 
         // End of prep for first texture quad.
     }
 
+    // Vertex data full? Allocate for up to twice as many items, at most the remaining capacity:
+    if (index >= batchAllocated) {
+        GLfloat *newData;
+        unsigned int itemFloats = (batchInstanced) ? kPsychInstanceFloats : 4 * batchStride;
+
+        batchAllocated = (batchAllocated > 0) ? 2 * batchAllocated : 64;
+        if (batchAllocated > batchCapacity) batchAllocated = batchCapacity;
+
+        newData = (GLfloat*) PsychMallocTemp((size_t) batchAllocated * itemFloats * sizeof(GLfloat));
+        if (batchData) {
+            memcpy(newData, batchData, (size_t) index * itemFloats * sizeof(GLfloat));
+            PsychFreeTemp(batchData);
+        }
+        batchData = newData;
+    }
+
+    // Pooled textures in the same page of the texture pool can share a batch, but differ in size:
+    if (source->texturePoolPage) {
+        if (source->textureOrientation == 2) {
+            sourceHeight=PsychGetHeightFromRect(source->rect);
+            sourceWidth=PsychGetWidthFromRect(source->rect);
+        }
+        else {
+            sourceHeight=PsychGetWidthFromRect(source->rect);
+            sourceWidth=PsychGetHeightFromRect(source->rect);
+        }
+    }
+
     // 0 == Transposed as from Matlab image array. 2 == Offscreen window in normal orientation.
     if (source->textureOrientation == 2) {
         sourceX=sourceRect[kPsychLeft];
@@ -1758,6 +2056,14 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
         sourceYEnd=sourceHeight - sourceRect[kPsychTop];
     }
 
+    // Shift texture coordinates of pooled textures into their slot:
+    if (source->texturePoolPage) {
+        sourceX+=source->texturePoolSlot.x + kPsychTexturePoolBorder;
+        sourceXEnd+=source->texturePoolSlot.x + kPsychTexturePoolBorder;
+        sourceY+=source->texturePoolSlot.y + kPsychTexturePoolBorder;
+        sourceYEnd+=source->texturePoolSlot.y + kPsychTexturePoolBorder;
+    }
+
     // Special case handling for GL_TEXTURE_2D textures. We need to map the
     // absolute texture coordinates (in pixels) to the interval 0.0 - 1.0 where
     // 1.0 == full extent of power of two texture...
@@ -1778,26 +2084,20 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
         sourceYEnd=sourceYEnd / (double) tHeight;
     }
 
-    // Any automatic shader assigned yet?
-    if (shader > 0 && mattrib >= 0) {
-        if (globalAlpha == DBL_MAX) {
-            // globalAlpha disabled: Pass the 'modulateColor' vector:
-            glVertexAttrib4dvARB(mattrib, target->currentColor);
-        }
-        else {
-            // modulateColor disabled: Pass (1,1,1) as RGB color and globalAlpha as alpha:
-            glVertexAttrib4fARB(mattrib, 1.0, 1.0, 1.0, (GLfloat) globalAlpha);
-        }
-    }
-
-    // Fixed function pipeline color assignment:
+    // Vertex color for fixed function pipeline, and 'modulateColor' attribute for any automatic
+    // shader assigned:
     if (globalAlpha == DBL_MAX) {
-        glColor4dv(target->currentColor);
+        // globalAlpha disabled: Pass the 'modulateColor' vector:
+        for (i = 0; i < 4; i++) color[i] = (GLfloat) target->currentColor[i];
     }
     else {
-        glColor4f(1, 1, 1, (GLfloat) globalAlpha);
+        // modulateColor disabled: Pass (1,1,1) as RGB color and globalAlpha as alpha:
+        color[0] = color[1] = color[2] = 1;
+        color[3] = (GLfloat) globalAlpha;
     }
 
+    if (attribs[11] >= 0) memcpy(attribValues[11], color, sizeof(color));
+
     if ((rotationAngle != 0) && !(source->specialflags & kPsychDontDoRotation)) {
         // Apply a rotation transform for rotated drawing, either to modelview-,
         // or texture matrix.
@@ -1831,6 +2131,28 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
 
     oldRotationAngle = rotationAngle;
 
+    if (batchInstanced) {
+        // Instanced drawing: Encode all parameters of the blit operation as per instance attributes,
+        // the shader computes the corners of the quad and its texture coordinates from them:
+        v = &batchData[index * kPsychInstanceFloats];
+        v[0] = (GLfloat) targetRect[kPsychLeft];
+        v[1] = (GLfloat) targetRect[kPsychTop];
+        v[2] = (GLfloat) targetRect[kPsychRight];
+        v[3] = (GLfloat) targetRect[kPsychBottom];
+        v[4] = (GLfloat) sourceX;
+        v[5] = (GLfloat) sourceY;
+        v[6] = (GLfloat) sourceXEnd;
+        v[7] = (GLfloat) sourceYEnd;
+        v[8] = (useXForm == 1) ? crt : 1;
+        v[9] = (useXForm == 1) ? srt : 0;
+        v[10] = (useXForm == 2) ? crt : 1;
+        v[11] = (useXForm == 2) ? srt : 0;
+        memcpy(&v[12], color, sizeof(color));
+
+        index++;
+        return;
+    }
+
     // Support for basic shading during texture blitting: Useful for very simple
     // single-pass isotropic image processing and for procedural texture mapping:
     if (source->textureFilterShader < 0) {
@@ -1841,77 +2163,72 @@ void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, Ps
         // Now need parameter transfer for advanced procedural shading:
         // We encode all parameters about the blit operation into additional
         // vertex attributes so a complex shader can derive useful information.
+        // They get replicated into all 4 vertices of the quad below.
 
-        // 'srcRect' parameter: The glTexCoord() calls below encode texture coordinates
+        // 'srcRect' parameter: The texture coordinates below encode texture coordinates
         // - and thereby the corners of 'srcRect' - into each vertex, however this
         // info gets potentially transformed by the texture matrix, also each vertex
         // only sees one corner of the srcRect: Therefore we encode srcrect = [left top right bottom]
         // on demand:
-        if (attribs[0] >= 0) glVertexAttrib4fARB(attribs[0], (GLfloat) sourceRect[kPsychLeft], (GLfloat) sourceRect[kPsychTop], (GLfloat) sourceRect[kPsychRight], (GLfloat) sourceRect[kPsychBottom]);
+        for (i = 0; i < 4; i++) attribValues[0][i] = (GLfloat) sourceRect[i];
 
-        // 'dstRect' parameter: The glVertex() calls below encode target pixel coordinates
+        // 'dstRect' parameter: The vertex positions below encode target pixel coordinates
         // - and thereby the corners of 'dstRect' - into each vertex, however this
         // info gets potentially transformed by the modelview/proj. matrix, also each vertex
         // only sees one corner of the dstRect: Therefore we encode dstrect = [left top right bottom]
         // on demand:
-        if (attribs[1] >= 0) glVertexAttrib4fARB(attribs[1], (GLfloat) targetRect[kPsychLeft], (GLfloat) targetRect[kPsychTop], (GLfloat) targetRect[kPsychRight], (GLfloat) targetRect[kPsychBottom]);
+        for (i = 0; i < 4; i++) attribValues[1][i] = (GLfloat) targetRect[i];
 
         // 'sizeAngleFilterMode' - if requested - encodes texture width in .x component, height in .y
         // requested rotationAngle in .z and the 'filterMode' flags in .w:
-        if (attribs[2] >= 0) glVertexAttrib4fARB(attribs[2], (GLfloat) sourceWidth, (GLfloat) sourceHeight, (GLfloat) rotationAngle, (GLfloat) filterMode);
+        attribValues[2][0] = (GLfloat) sourceWidth;
+        attribValues[2][1] = (GLfloat) sourceHeight;
+        attribValues[2][2] = (GLfloat) rotationAngle;
+        attribValues[2][3] = (GLfloat) filterMode;
 
-        // 'auxParameters0' is the first for components (rows) of the 'auxParameters' argument
-        // of Screen('DrawTexture(s)') - if such an argument was spec'd:
+        // 'auxParameters0' to 'auxParameters7' are the groups of four components (rows) of the 'auxParameters'
+        // argument of Screen('DrawTexture(s)') - if such an argument was spec'd:
         if (target->auxShaderParams) {
-            if ((target->auxShaderParamsCount >=4) && (attribs[3] >= 0)) glVertexAttrib4dvARB(attribs[3], target->auxShaderParams);
-            if ((target->auxShaderParamsCount >=8) && (attribs[4] >= 0)) glVertexAttrib4dvARB(attribs[4], &(target->auxShaderParams[4]));
-            if ((target->auxShaderParamsCount >=12) && (attribs[5] >= 0)) glVertexAttrib4dvARB(attribs[5], &(target->auxShaderParams[8]));
-            if ((target->auxShaderParamsCount >=16) && (attribs[6] >= 0)) glVertexAttrib4dvARB(attribs[6], &(target->auxShaderParams[12]));
-            if ((target->auxShaderParamsCount >=20) && (attribs[7] >= 0)) glVertexAttrib4dvARB(attribs[7], &(target->auxShaderParams[16]));
-            if ((target->auxShaderParamsCount >=24) && (attribs[8] >= 0)) glVertexAttrib4dvARB(attribs[8], &(target->auxShaderParams[20]));
-            if ((target->auxShaderParamsCount >=28) && (attribs[9] >= 0)) glVertexAttrib4dvARB(attribs[9], &(target->auxShaderParams[24]));
-            if ((target->auxShaderParamsCount >=32) && (attribs[10] >= 0)) glVertexAttrib4dvARB(attribs[10], &(target->auxShaderParams[28]));
+            for (i = 0; i < 8; i++) {
+                if (target->auxShaderParamsCount < 4 * (i + 1)) break;
+                for (j = 0; j < 4; j++) attribValues[3 + i][j] = (GLfloat) target->auxShaderParams[i * 4 + j];
+            }
         }
     }
 
     // Coordinate assignments depend on internal texture orientation...
     if (source->textureOrientation == 2 ||
         source->textureOrientation == 3 || source->textureOrientation == 4) {
-        // Use "normal" coordinate assignments, so that the rotation == 0 deg. case
-        // is the fastest case --> Most common orientation has highest performance.
-        //lower left
-        glTexCoordXform((GLfloat)sourceX, (GLfloat)sourceYEnd);
-        glVertexXform((GLfloat)(targetRect[kPsychLeft]), (GLfloat)(targetRect[kPsychTop]));        //upper left vertex in window
-
-        //upper left
-        glTexCoordXform((GLfloat)sourceX, (GLfloat)sourceY);
-        glVertexXform((GLfloat)(targetRect[kPsychLeft]), (GLfloat)(targetRect[kPsychBottom]));     //lower left vertex in window
-
-        //upper right
-        glTexCoordXform((GLfloat)sourceXEnd, (GLfloat)sourceY);
-        glVertexXform((GLfloat)(targetRect[kPsychRight]), (GLfloat)(targetRect[kPsychBottom]) );   //lower right  vertex in window
-
-        //lower right
-        glTexCoordXform((GLfloat)sourceXEnd, (GLfloat)sourceYEnd);
-        glVertexXform((GLfloat)(targetRect[kPsychRight]), (GLfloat)(targetRect[kPsychTop]));       //upper right in window
+        // Use "normal" coordinate assignments:
+        tc[0][0] = (GLfloat) sourceX;    tc[0][1] = (GLfloat) sourceYEnd;   // lower left
+        tc[1][0] = (GLfloat) sourceX;    tc[1][1] = (GLfloat) sourceY;      // upper left
+        tc[2][0] = (GLfloat) sourceXEnd; tc[2][1] = (GLfloat) sourceY;      // upper right
+        tc[3][0] = (GLfloat) sourceXEnd; tc[3][1] = (GLfloat) sourceYEnd;   // lower right
     }
     else {
         // Use swapped texture coordinates....
-        //lower left
-        glTexCoordXform((GLfloat)sourceX, (GLfloat)sourceY);                                       //lower left vertex in  window
-        glVertexXform((GLfloat)(targetRect[kPsychLeft]), (GLfloat)(targetRect[kPsychTop]));        //upper left vertex in window
-
-        //upper left
-        glTexCoordXform((GLfloat)sourceXEnd, (GLfloat)sourceY);                                    //upper left vertex in texture
-        glVertexXform((GLfloat)(targetRect[kPsychLeft]), (GLfloat)(targetRect[kPsychBottom]));     //lower left vertex in window
+        tc[0][0] = (GLfloat) sourceX;    tc[0][1] = (GLfloat) sourceY;      // lower left
+        tc[1][0] = (GLfloat) sourceXEnd; tc[1][1] = (GLfloat) sourceY;      // upper left
+        tc[2][0] = (GLfloat) sourceXEnd; tc[2][1] = (GLfloat) sourceYEnd;   // upper right
+        tc[3][0] = (GLfloat) sourceX;    tc[3][1] = (GLfloat) sourceYEnd;   // lower right
+    }
 
-        //upper right
-        glTexCoordXform((GLfloat)sourceXEnd, (GLfloat)sourceYEnd);                                 //upper right vertex in texture
-        glVertexXform((GLfloat)(targetRect[kPsychRight]), (GLfloat)(targetRect[kPsychBottom]) );   //lower right  vertex in window
+    pos[0][0] = (GLfloat) targetRect[kPsychLeft];  pos[0][1] = (GLfloat) targetRect[kPsychTop];      // upper left vertex in window
+    pos[1][0] = (GLfloat) targetRect[kPsychLeft];  pos[1][1] = (GLfloat) targetRect[kPsychBottom];   // lower left vertex in window
+    pos[2][0] = (GLfloat) targetRect[kPsychRight]; pos[2][1] = (GLfloat) targetRect[kPsychBottom];   // lower right vertex in window
+    pos[3][0] = (GLfloat) targetRect[kPsychRight]; pos[3][1] = (GLfloat) targetRect[kPsychTop];      // upper right vertex in window
+
+    // Append the 4 vertices of the quad to the vertex data of the batch:
+    v = &batchData[index * 4 * batchStride];
+    for (j = 0; j < 4; j++) {
+        PsychVertexXform(pos[j][0], pos[j][1], &v[0]);
+        PsychTexCoordXform(tc[j][0], tc[j][1], &v[2]);
+        memcpy(&v[4], color, sizeof(color));
+        for (i = 0; i < 12; i++) {
+            if (attribs[i] >= 0) memcpy(&v[attribOffsets[i]], attribValues[i], 4 * sizeof(GLfloat));
+        }
 
-        //lower right
-        glTexCoordXform((GLfloat)sourceX, (GLfloat)sourceYEnd);                                    //lower right in texture
-        glVertexXform((GLfloat)(targetRect[kPsychRight]), (GLfloat)(targetRect[kPsychTop]));       //upper right in window
+        v += batchStride;
     }
 
     index++;
@@ -29,6 +29,7 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 GLenum PsychGetTextureTarget(PsychWindowRecordType *win);
 void PsychMapTexCoord(PsychWindowRecordType *tex, double* tx, double* ty);
 void PsychDetectTextureTarget(PsychWindowRecordType *win);
+void PsychAddTextureMemoryEstimate(PsychWindowRecordType *win);
 void PsychBatchBlitTexturesToDisplay(unsigned int opMode, unsigned int count, PsychWindowRecordType *source, PsychWindowRecordType *target, double *sourceRect, double *targetRect,
                                      double rotationAngle, int filterMode, double globalAlpha);
 //end include once
@@ -0,0 +1,447 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTextureUpload.c
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Background texture uploads. See PsychTextureUpload.h for an overview.
+
+		Conversion of the Matlab/Octave image matrix into texel data still happens on the calling
+		thread inside Screen('MakeTexture'), as the input matrix is only valid during the call, and
+		conversion is already SIMD optimized and multi-threaded for big images. Only the upload of
+		the texel data into the OpenGL texture, the part which can block in the graphics driver, is
+		moved to the background thread.
+
+		Each onscreen window has at most one upload thread, created on first use, which processes
+		queued jobs in order. It binds the dedicated gluploadcontextObject of its window, which is
+		also only created on first use, uploads each job via a pixel buffer object, inserts a fence
+		and flushes. The main thread waits for the job to be done, then makes its own context wait
+		on the fence via glWaitSync(), which doesn't block the cpu, before the texture is used. If
+		the upload thread fails to upload, the texel data is kept and the main thread uploads it
+		synchronously instead.
+*/
+
+#include "Screen.h"
+
+/* Upload texel data of 'job' into its texture, via a pixel buffer object if 'usePBO' is set. Returns FALSE on error. */
+static psych_bool PsychTextureUploadExecute(PsychTextureUploadJob *job, psych_bool usePBO)
+{
+    GLuint pbo = 0;
+
+    if (usePBO) {
+        glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) job->size, job->data, GL_STREAM_DRAW);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, job->alignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, job->width);
+    glBindTexture(job->target, job->textureNumber);
+    glTexImage2D(job->target, 0, job->internalFormat, (GLsizei) job->width, (GLsizei) job->height, 0, job->format, job->type, (pbo) ? NULL : job->data);
+    glBindTexture(job->target, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (pbo) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &pbo);
+    }
+
+    return((glGetError() == GL_NO_ERROR) ? TRUE : FALSE);
+}
+
+/* Main routine of the upload thread of onscreen window 'windowRecordToCast'. */
+static void* PsychTextureUploadThreadMain(void* windowRecordToCast)
+{
+    PsychWindowRecordType *windowRecord = (PsychWindowRecordType*) windowRecordToCast;
+    PsychTextureUploader *uploader = windowRecord->textureUploader;
+    PsychTextureUploadJob *job;
+    psych_bool bound = FALSE, success;
+
+    // Assign a name to ourselves, for debugging:
+    PsychSetThreadName("ScreenTexUpload");
+
+    // Attach to our dedicated OpenGL context permanently, until the thread exits. As for the async flip
+    // thread in PsychWindowSupport.c, the os-specific binding is done directly here:
+    #if PSYCH_SYSTEM == PSYCH_OSX
+        bound = (CGLSetCurrentContext(windowRecord->targetSpecific.gluploadcontextObject) == kCGLNoError) ? TRUE : FALSE;
+    #endif
+
+    #if PSYCH_SYSTEM == PSYCH_LINUX
+        PsychLockDisplay();
+        #ifndef PTB_USE_WAFFLE
+            bound = glXMakeCurrent(windowRecord->targetSpecific.deviceContext, windowRecord->targetSpecific.windowHandle, windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE;
+        #else
+            bound = waffle_make_current(windowRecord->targetSpecific.deviceContext, windowRecord->targetSpecific.windowHandle, windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE;
+        #endif
+        PsychUnlockDisplay();
+    #endif
+
+    #if PSYCH_SYSTEM == PSYCH_WINDOWS
+        bound = wglMakeCurrent(windowRecord->targetSpecific.deviceContext, windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE;
+    #endif
+
+    PsychLockMutex(&uploader->mutex);
+    uploader->contextFailed = !bound;
+
+    while (TRUE) {
+        // Sleep until there is work, or until shutdown is requested and all queued work is done:
+        while (!uploader->head && !uploader->shutdown) PsychWaitCondition(&uploader->workCondition, &uploader->mutex);
+        if (!uploader->head) break;
+
+        job = uploader->head;
+        uploader->head = job->next;
+        if (!uploader->head) uploader->tail = NULL;
+
+        // The main thread doesn't touch a job until it is done, so we can upload without holding the lock:
+        PsychUnlockMutex(&uploader->mutex);
+
+        success = FALSE;
+        if (bound && PsychTextureUploadExecute(job, TRUE)) {
+            // Fence behind the upload for the main context to wait on, flushed so it can signal:
+            job->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            // Texel data is in the pixel buffer object or texture now:
+            free(job->data);
+            job->data = NULL;
+            success = (job->fence) ? TRUE : FALSE;
+        }
+
+        PsychLockMutex(&uploader->mutex);
+        job->failed = !success;
+        job->done = TRUE;
+        PsychBroadcastCondition(&uploader->doneCondition);
+    }
+
+    PsychUnlockMutex(&uploader->mutex);
+
+    // Make sure our thread detaches from its private OpenGL context before it dies:
+    if (bound) PsychOSUnsetGLContext(windowRecord);
+
+    return(NULL);
+}
+
+/* Return upload thread of onscreen window 'parentRecord', starting it if needed. Returns NULL on failure. */
+static PsychTextureUploader* PsychTextureUploadGetUploader(PsychWindowRecordType *parentRecord)
+{
+    PsychTextureUploader *uploader;
+    int rc;
+
+    if (parentRecord->textureUploader) return(parentRecord->textureUploader);
+
+    // Setup failed before? Then don't retry on each Screen('MakeTexture'):
+    if (parentRecord->textureUploadUnsupported) return(NULL);
+
+    if (!PsychOSCreateUploadContext(parentRecord)) {
+        parentRecord->textureUploadUnsupported = TRUE;
+        return(NULL);
+    }
+
+    uploader = (PsychTextureUploader*) calloc(1, sizeof(PsychTextureUploader));
+    if (NULL == uploader) return(NULL);
+
+    if (PsychInitMutex(&uploader->mutex)) {
+        free(uploader);
+        parentRecord->textureUploadUnsupported = TRUE;
+        return(NULL);
+    }
+
+    if (PsychInitCondition(&uploader->workCondition, NULL)) {
+        PsychDestroyMutex(&uploader->mutex);
+        free(uploader);
+        parentRecord->textureUploadUnsupported = TRUE;
+        return(NULL);
+    }
+
+    if (PsychInitCondition(&uploader->doneCondition, NULL)) {
+        PsychDestroyCondition(&uploader->workCondition);
+        PsychDestroyMutex(&uploader->mutex);
+        free(uploader);
+        parentRecord->textureUploadUnsupported = TRUE;
+        return(NULL);
+    }
+
+    // Thread picks up its uploader from the window record:
+    parentRecord->textureUploader = uploader;
+
+    if ((rc = PsychCreateThread(&uploader->thread, NULL, PsychTextureUploadThreadMain, (void*) parentRecord))) {
+        if (PsychPrefStateGet_Verbosity() > 1) printf("PTB-WARNING: Could not create background texture upload thread [%s]. Asynchronous Screen('MakeTexture') will be synchronous.\n", strerror(rc));
+        parentRecord->textureUploader = NULL;
+        PsychDestroyCondition(&uploader->workCondition);
+        PsychDestroyCondition(&uploader->doneCondition);
+        PsychDestroyMutex(&uploader->mutex);
+        free(uploader);
+        parentRecord->textureUploadUnsupported = TRUE;
+        return(NULL);
+    }
+
+    return(uploader);
+}
+
+/* PsychTextureUploadCreateTexture()
+ *
+ * Create the OpenGL texture for texture 'win', prepared as for PsychCreateTexture(), and queue the
+ * upload of its texel data to the background upload thread of its onscreen window. Takes over the
+ * texel data in win->textureMemory. Returns FALSE, without changing 'win', if this is not possible
+ * for the texture or system, in which case the caller must create it via PsychCreateTexture().
+ */
+psych_bool PsychTextureUploadCreateTexture(PsychWindowRecordType *win)
+{
+    PsychWindowRecordType *parentRecord;
+    PsychTextureUploader *uploader;
+    PsychTextureUploadJob *job;
+    GLenum texturetarget;
+    int width, height, bytesPerTexel;
+
+    PsychSetGLContext(win);
+    PsychDetectTextureTarget(win);
+    texturetarget = PsychGetTextureTarget(win);
+    parentRecord = PsychGetParentWindow(win);
+
+    // Only standard 8 bpc textures on desktop OpenGL with fences, pixel buffer objects and a working upload context:
+    if (!PsychIsGLClassic(win) || PsychIsGLES(win) || (parentRecord->specialflags & kPsychIsEGLWindow) ||
+        parentRecord->textureUploadUnsupported || (NULL == glFenceSync) || (NULL == glWaitSync) ||
+        !(GLEW_VERSION_2_1 || glewIsSupported("GL_ARB_pixel_buffer_object")) || (win->textureNumber != 0) || (win->textureMemory == NULL) ||
+        (win->textureinternalformat != 0) || (PsychPrefStateGet_ConserveVRAM() & kPsychDontCacheTextures) ||
+        ((texturetarget == GL_TEXTURE_2D) && !(win->gfxcaps & kPsychGfxCapNPOTTex)) ||
+        ((win->depth != 8) && (win->depth != 16) && (win->depth != 24) && (win->depth != 32))) return(FALSE);
+
+    // Size of the texture in internal storage, transposed as in PsychCreateTexture():
+    if (win->textureOrientation == 0 || win->textureOrientation == 1) {
+        width = (int) PsychGetHeightFromRect(win->rect);
+        height = (int) PsychGetWidthFromRect(win->rect);
+    }
+    else {
+        width = (int) PsychGetWidthFromRect(win->rect);
+        height = (int) PsychGetHeightFromRect(win->rect);
+    }
+
+    if ((width < 1) || (height < 1)) return(FALSE);
+
+    uploader = PsychTextureUploadGetUploader(parentRecord);
+    if (NULL == uploader) return(FALSE);
+
+    // Upload thread failed to bind its context? Then all its jobs would fail:
+    PsychLockMutex(&uploader->mutex);
+    if (uploader->contextFailed) {
+        PsychUnlockMutex(&uploader->mutex);
+        return(FALSE);
+    }
+    PsychUnlockMutex(&uploader->mutex);
+
+    job = (PsychTextureUploadJob*) calloc(1, sizeof(PsychTextureUploadJob));
+    if (NULL == job) return(FALSE);
+
+    // Same formats as PsychCreateTexture() uses for standard textures on desktop OpenGL:
+    job->target = texturetarget;
+    job->width = width;
+    job->height = height;
+    job->alignment = (win->textureByteAligned > 1) ? win->textureByteAligned : 1;
+    job->type = GL_UNSIGNED_BYTE;
+    bytesPerTexel = win->depth / 8;
+
+    switch (win->depth) {
+        case 8:
+            job->internalFormat = GL_LUMINANCE8;
+            job->format = GL_LUMINANCE;
+            break;
+
+        case 16:
+            job->internalFormat = GL_RGBA8;
+            job->format = GL_LUMINANCE_ALPHA;
+            break;
+
+        case 24:
+            job->internalFormat = GL_RGBA8;
+            job->format = GL_RGB;
+            break;
+
+        case 32:
+            job->internalFormat = GL_RGBA8;
+            job->format = GL_BGRA;
+            if (!(win->gfxcaps & kPsychGfxCapNeedsUnsignedByteRGBATextureUpload)) job->type = GL_UNSIGNED_INT_8_8_8_8_REV;
+            break;
+    }
+
+    // Take over the texel data. Zero-copy input from the runtime is only valid during this call, so copy it:
+    if (win->textureMemorySizeBytes > 0) {
+        job->data = win->textureMemory;
+        job->size = win->textureMemorySizeBytes;
+    }
+    else {
+        job->size = (size_t) bytesPerTexel * (size_t) width * (size_t) height;
+        job->data = malloc(job->size);
+        if (NULL == job->data) {
+            free(job);
+            return(FALSE);
+        }
+        memcpy(job->data, win->textureMemory, job->size);
+    }
+
+    win->textureMemory = NULL;
+    win->textureMemorySizeBytes = 0;
+
+    // Texture name is created here, so the texture has its final handle from the start:
+    glGenTextures(1, &win->textureNumber);
+    job->textureNumber = win->textureNumber;
+    win->textureUploadJob = job;
+    win->bpc = 8;
+
+    // Accounting... ...this is only a rough guesstimate, as in PsychCreateTexture():
+    win->surfaceSizeBytes = ((size_t) ((job->internalFormat == GL_RGBA8) ? 4 : 1)) * (size_t) width * (size_t) height;
+    PsychAddTextureMemoryEstimate(win);
+
+    // Client rect of a texture is always == rect of it:
+    PsychCopyRect(win->clientrect, win->rect);
+
+    // Queue job and wake up upload thread:
+    PsychLockMutex(&uploader->mutex);
+    if (uploader->tail) uploader->tail->next = job;
+    else uploader->head = job;
+    uploader->tail = job;
+    PsychSignalCondition(&uploader->workCondition);
+    PsychUnlockMutex(&uploader->mutex);
+
+    return(TRUE);
+}
+
+/* Release completed upload job of texture 'win'. Uploads failed jobs synchronously if 'execute' is set. */
+static void PsychTextureUploadFinalize(PsychWindowRecordType *win, psych_bool execute)
+{
+    PsychTextureUploadJob *job = win->textureUploadJob;
+    psych_bool success = TRUE;
+
+    win->textureUploadJob = NULL;
+
+    if (!job->failed) {
+        // Make our context wait on the gpu for completion of the upload. This does not block the cpu:
+        glWaitSync(job->fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(job->fence);
+    }
+    else if (execute) {
+        // Upload thread failed. Upload synchronously in our own context instead:
+        if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Background upload of texture %i failed. Uploading synchronously.\n", win->windowIndex);
+        while (glGetError());
+        success = PsychTextureUploadExecute(job, FALSE);
+    }
+
+    if (job->data) free(job->data);
+    free(job);
+
+    if (!success) PsychErrorExitMsg(PsychError_user, "Texture creation failed, most likely due to unsupported precision or insufficient free memory.");
+
+    return;
+}
+
+/* Wait until the upload thread is done with the job of texture 'win', then release it via PsychTextureUploadFinalize(). */
+static void PsychTextureUploadWaitJob(PsychWindowRecordType *win, psych_bool execute)
+{
+    PsychTextureUploader *uploader;
+    PsychTextureUploadJob *job = win->textureUploadJob;
+
+    // Fast path: No pending upload:
+    if (NULL == job) return;
+
+    uploader = PsychGetParentWindow(win)->textureUploader;
+
+    PsychLockMutex(&uploader->mutex);
+    while (!job->done) PsychWaitCondition(&uploader->doneCondition, &uploader->mutex);
+    PsychUnlockMutex(&uploader->mutex);
+
+    PsychTextureUploadFinalize(win, execute);
+
+    return;
+}
+
+/* PsychTextureUploadWait()
+ *
+ * Wait for completion of a pending background upload of texture 'win', if any. Must be called with the
+ * OpenGL context of 'win' bound, before the texture gets bound or its OpenGL texture gets accessed.
+ */
+void PsychTextureUploadWait(PsychWindowRecordType *win)
+{
+    PsychTextureUploadWaitJob(win, TRUE);
+}
+
+/* PsychTextureUploadCancel()
+ *
+ * Release a pending background upload of texture 'win', if any, before the texture gets deleted. The
+ * upload thread may still use the texture, so this waits for it to be done with it, but doesn't upload
+ * texel data if it failed to. Must be called with the OpenGL context of 'win' bound.
+ */
+void PsychTextureUploadCancel(PsychWindowRecordType *win)
+{
+    PsychTextureUploadWaitJob(win, FALSE);
+}
+
+/* PsychTextureUploadIsReady()
+ *
+ * Return TRUE if texture 'win' can be used without waiting for its background upload, i.e., there is
+ * no pending upload, or the upload thread is done with it and its fence is signalled. Must be called
+ * with the OpenGL context of 'win' bound.
+ */
+psych_bool PsychTextureUploadIsReady(PsychWindowRecordType *win)
+{
+    PsychTextureUploader *uploader;
+    PsychTextureUploadJob *job = win->textureUploadJob;
+    psych_bool done;
+
+    if (NULL == job) return(TRUE);
+
+    uploader = PsychGetParentWindow(win)->textureUploader;
+
+    PsychLockMutex(&uploader->mutex);
+    done = job->done;
+    PsychUnlockMutex(&uploader->mutex);
+
+    if (!done || (job->fence && (glClientWaitSync(job->fence, 0, 0) == GL_TIMEOUT_EXPIRED))) return(FALSE);
+
+    // Completed. Release job now, so later use of the texture doesn't need to check again:
+    PsychTextureUploadFinalize(win, TRUE);
+
+    return(TRUE);
+}
+
+/* PsychTextureUploadShutdown()
+ *
+ * Stop the upload thread of onscreen window 'windowRecord', after it processed all queued jobs, and
+ * release the jobs of all its textures. Called at window close time with the OpenGL context of the
+ * window bound, before the upload context gets destroyed.
+ */
+void PsychTextureUploadShutdown(PsychWindowRecordType *windowRecord)
+{
+    PsychTextureUploader *uploader = windowRecord->textureUploader;
+    PsychWindowRecordType **windowRecordArray;
+    int i, numWindows;
+
+    if (NULL == uploader) return;
+
+    PsychLockMutex(&uploader->mutex);
+    uploader->shutdown = TRUE;
+    PsychSignalCondition(&uploader->workCondition);
+    PsychUnlockMutex(&uploader->mutex);
+
+    PsychDeleteThread(&uploader->thread);
+
+    // All jobs are done now. Release them without uploading failed ones, as their textures are about to die:
+    PsychCreateVolatileWindowRecordPointerList(&numWindows, &windowRecordArray);
+    for (i = 0; i < numWindows; i++) {
+        if (windowRecordArray[i]->textureUploadJob && (windowRecordArray[i]->windowType == kPsychTexture) &&
+            (windowRecordArray[i]->targetSpecific.contextObject == windowRecord->targetSpecific.contextObject)) {
+            PsychTextureUploadFinalize(windowRecordArray[i], FALSE);
+        }
+    }
+    PsychDestroyVolatileWindowRecordPointerList(windowRecordArray);
+
+    windowRecord->textureUploader = NULL;
+    PsychDestroyCondition(&uploader->workCondition);
+    PsychDestroyCondition(&uploader->doneCondition);
+    PsychDestroyMutex(&uploader->mutex);
+    free(uploader);
+
+    return;
+}
@@ -0,0 +1,40 @@
+/*
+	PsychToolbox3/Source/Common/Screen/PsychTextureUpload.h
+
+	PLATFORMS:
+
+		All.
+
+	DESCRIPTION:
+
+		Background texture uploads: Textures created via Screen('MakeTexture') with specialFlags 128
+		get their OpenGL texture name and return their handle immediately, while the upload of their
+		texel data happens on a background thread of their onscreen window, with its own OpenGL context
+		which shares all ressources with the onscreen windows context. The upload goes through a pixel
+		buffer object and is followed by a fence. Any use of the texture waits for completion of its
+		upload first, and Screen('IsTextureReady') allows to poll for completion.
+*/
+
+//include once
+#ifndef PSYCH_IS_INCLUDED_PsychTextureUpload
+#define PSYCH_IS_INCLUDED_PsychTextureUpload
+
+#include "Screen.h"
+
+// Queue upload of texture 'win' to the background upload thread instead of uploading it synchronously. Returns FALSE if not possible:
+psych_bool PsychTextureUploadCreateTexture(PsychWindowRecordType *win);
+
+// Wait for completion of a pending background upload of texture 'win', if any. Must be called before any use of the texture:
+void PsychTextureUploadWait(PsychWindowRecordType *win);
+
+// Release a pending background upload of texture 'win', if any, before the texture gets deleted:
+void PsychTextureUploadCancel(PsychWindowRecordType *win);
+
+// Is texture 'win' ready for use without waiting, i.e., no background upload pending or its upload completed?
+psych_bool PsychTextureUploadIsReady(PsychWindowRecordType *win);
+
+// Stop background upload thread of onscreen window 'windowRecord' and finalize all its uploads at window close:
+void PsychTextureUploadShutdown(PsychWindowRecordType *windowRecord);
+
+//end include once
+#endif
@@ -1467,6 +1467,11 @@ void PsychDCUpdateCameraFrameTimestamp(PsychVidcapRecordType* capdev)
         PsychGetAdjustedPrecisionTimerSeconds(&tRef);
         capdev->current_pts -= (((double) ((psych_uint64) tv.tv_sec * 1000000 + (psych_uint64) tv.tv_usec)) / 1000000.0f) - tRef;
         #endif
+
+        // On Linux, GetSecs may use a different time base than gettimeofday(), if selected via PSYCH_TIMEBASE:
+        #if PSYCH_SYSTEM == PSYCH_LINUX
+        capdev->current_pts = PsychOSMonotonicToRefTime(capdev->current_pts);
+        #endif
     }
 }
 
@@ -3426,7 +3431,11 @@ double PsychDCVideoCaptureSetParameter(int capturehandle, const char* pname, dou
         PsychCopyOutDoubleArg(1, FALSE, PsychDCBusCycleTimeToSecs(ct.cycle_time_stamp.unstructured.value));
 
         // System time is CLOCK_REALTIME time in microseconds, so convert to GetSecs() seconds:
+        #if PSYCH_SYSTEM == PSYCH_LINUX
+        PsychCopyOutDoubleArg(2, FALSE, PsychOSMonotonicToRefTime(((double) ((psych_uint64) systemtime)) / 1000000.0f));
+        #else
         PsychCopyOutDoubleArg(2, FALSE, ((double) ((psych_uint64) systemtime)) / 1000000.0f);
+        #endif
 
         // Copy out Firewire bus time in seconds:
         PsychCopyOutDoubleArg(3, FALSE, (double) ct.cycle_time_stamp.structured.second_count);
@@ -1850,6 +1850,9 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
         return;
     }
 
+    // Execute or discard pending commands of deferred drawing mode and release its ressources:
+    PsychReleaseDeferredDrawing(windowRecord);
+
     // If our to-be-destroyed windowRecord is currently bound as drawing target,
     // e.g. as onscreen window or offscreen window, then we need to safe-reset
     // our drawing engine - Unbind its FBO (if any) and reset current target to
@@ -1908,6 +1911,28 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
             windowRecord->gpuRenderTimeQuery = 0;
         }
 
+        // Destroy pixel buffers and fences of asynchronous image readbacks via Screen('GetImageAsyncBegin'):
+        for (i = 0; i < kPsychMaxAsyncReadbacks; i++) {
+            if (windowRecord->asyncReadbacks[i].fence) glDeleteSync(windowRecord->asyncReadbacks[i].fence);
+            if (windowRecord->asyncReadbacks[i].pbo) glDeleteBuffers(1, &windowRecord->asyncReadbacks[i].pbo);
+            memset(&windowRecord->asyncReadbacks[i], 0, sizeof(windowRecord->asyncReadbacks[i]));
+        }
+
+        // Destroy streaming vertex buffer of batch drawing commands:
+        PsychVertexStreamDestroy(windowRecord);
+
+        // Delete shaders for instanced drawing of texture batches:
+        for (i = 0; i < 2; i++) {
+            if (windowRecord->instancedBlitShader[i]) glDeleteProgram(windowRecord->instancedBlitShader[i]);
+            windowRecord->instancedBlitShader[i] = 0;
+        }
+
+        // Stop background texture upload thread, if any, while its OpenGL context still exists:
+        PsychTextureUploadShutdown(windowRecord);
+
+        // Delete pages of the texture pool for small textures:
+        PsychTexturePoolDestroy(windowRecord);
+
         // Sync and idle the pipeline again:
         glFinish();
 
@@ -1918,6 +1943,7 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
                 (windowRecordArray[i]->windowType==kPsychTexture || windowRecordArray[i]->windowType==kPsychProxyWindow)) {
                 windowRecordArray[i]->targetSpecific.contextObject = NULL;
                 windowRecordArray[i]->targetSpecific.glusercontextObject = NULL;
+                windowRecordArray[i]->texturePoolPage = NULL;
             }
         }
         PsychDestroyVolatileWindowRecordPointerList(windowRecordArray);
@@ -2877,6 +2903,9 @@ psych_bool PsychFlipWindowBuffersIndirect(PsychWindowRecordType *windowRecord)
     flipRequest = windowRecord->flipInfo;
     if (NULL == flipRequest) PsychErrorExitMsg(PsychError_internal, "NULL-Ptr for 'flipRequest' field of windowRecord passed in PsychFlipWindowsIndirect()!!");
 
+    // Execute pending commands of deferred drawing mode, if any, before the flip:
+    PsychFlushDeferredDrawing();
+
     // Synchronous flip requested?
     if ((flipRequest->opmode == 0) && (windowRecord->stereomode != kPsychFrameSequentialStereo)) {
         // Yes. Any pending operation in progress?
@@ -4497,6 +4526,10 @@ void PsychSetGLContext(PsychWindowRecordType *windowRecord)
     // subroutine to execute, at least not with the new-style async flip method:
     if (!oldStyle && !PsychIsMasterThread()) return;
 
+    // Execute pending commands of deferred drawing mode, if any, as the caller may
+    // be about to use their results, or modify ressources they use:
+    PsychFlushDeferredDrawing();
+
     // Check if any async flip on any onscreen window in progress: In that case only the async flip worker thread is allowed to call PsychSetGLContext()
     // on async-flipping onscreen windows, and none of the threads is allowed to attach to non-onscreen-window ressources.
     // asyncFlipOpsActive is a count of currently async-flipping onscreen windows...
@@ -5851,6 +5884,11 @@ void PsychSetDrawingTarget(PsychWindowRecordType *windowRecord)
 
     // Called from main thread --> Work to do.
 
+    // Execute pending commands of deferred drawing mode, if any, before anything else
+    // gets drawn or read back. Must happen before recursion tracking, as execution
+    // sets its own drawing target:
+    if (recursionLevel == 0) PsychFlushDeferredDrawing();
+
     // Increase recursion level count:
     recursionLevel++;
 
@@ -203,6 +203,8 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("WaitUntilAsyncFlipCertain" , &SCREENWaitUntilAsyncFlipCertain));
 	PsychErrorExit(PsychRegister("FillRect", &SCREENFillRect));
 	PsychErrorExit(PsychRegister("GetImage", &SCREENGetImage));
+	PsychErrorExit(PsychRegister("GetImageAsyncBegin", &SCREENGetImage));
+	PsychErrorExit(PsychRegister("GetImageAsyncEnd", &SCREENGetImageAsyncEnd));
 	PsychErrorExit(PsychRegister("PutImage", &SCREENPutImage));
 	PsychErrorExit(PsychRegister("HideCursorHelper", &SCREENHideCursorHelper));
 	PsychErrorExit(PsychRegister("ShowCursorHelper", &SCREENShowCursorHelper));
@@ -239,6 +241,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("DrawDots", &SCREENDrawDots));
 	PsychErrorExit(PsychRegister("GetTimeList", &SCREENGetTimeList));
 	PsychErrorExit(PsychRegister("ClearTimeList", &SCREENClearTimeList));
+	PsychErrorExit(PsychRegister("GetTimeListStats", &SCREENGetTimeListStats));
 	PsychErrorExit(PsychRegister("BlendFunction", &SCREENBlendFunction));
 	PsychErrorExit(PsychRegister("WindowSize", &SCREENWindowSize));
 	PsychErrorExit(PsychRegister("GetMouseHelper", &SCREENGetMouseHelper));
@@ -246,6 +249,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("LineStipple", &SCREENLineStipple));  
 	PsychErrorExit(PsychRegister("SelectStereoDrawBuffer", &SCREENSelectStereoDrawBuffer));
 	PsychErrorExit(PsychRegister("DrawingFinished", &SCREENDrawingFinished));
+	PsychErrorExit(PsychRegister("DeferredDrawing", &SCREENDeferredDrawing));
 	PsychErrorExit(PsychRegister("DrawLines", &SCREENDrawLines));
 	PsychErrorExit(PsychRegister("GetFlipInterval", &SCREENGetFlipInterval));
 	PsychErrorExit(PsychRegister("CloseMovie", &SCREENCloseMovie));
@@ -261,6 +265,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("glScale", &SCREENglScale));
 	PsychErrorExit(PsychRegister("glRotate", &SCREENglRotate));
 	PsychErrorExit(PsychRegister("PreloadTextures", &SCREENPreloadTextures));
+	PsychErrorExit(PsychRegister("IsTextureReady", &SCREENIsTextureReady));
 	PsychErrorExit(PsychRegister("FillArc", &SCREENFillArc));
 	PsychErrorExit(PsychRegister("DrawArc", &SCREENDrawArc));
 	PsychErrorExit(PsychRegister("FrameArc", &SCREENFrameArc));
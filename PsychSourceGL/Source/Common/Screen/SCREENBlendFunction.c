@@ -123,6 +123,9 @@ PsychError SCREENBlendFunction(void)
 		if(!isDestinationChoiceValid) PsychErrorExitMsg(PsychError_user, "The blending factor supplied for the destination is only valid only for the source");
 	}
 
+	// Pending commands of deferred drawing mode must be executed with the old blending settings:
+	PsychFlushDeferredDrawing();
+
 	PsychStoreAlphaBlendingFactorsForWindow(windowRecord, newSource, newDestination);
 
 	// Check if alpha blending is possible for this windowRecord:
@@ -27,28 +27,41 @@
 #include "Screen.h"
 
 // If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
-static char useString[] = "Screen('ClearTimelist');";
+static char useString[] = "Screen('ClearTimelist' [, capacity=0][, ringMode=0]);";
 //                          
 static char synopsisString[] = 
 		"Clears the list of times held by Screen.  Time values, as returned by GetSecs, are added to the time list by " 
-		"internal debugging routines using Screen preferences. Time values are read out of Screen using GetTimeList. ";  
-static char seeAlsoString[] = "GetTimeList";
+		"internal debugging routines using Screen preferences. Time values are read out of Screen using GetTimeList.\n"
+		"The optional 'capacity' preallocates storage for that many time values, so storing a time value doesn't need "
+		"to allocate memory and has minimal overhead. By default, no storage is preallocated.\n"
+		"If the optional 'ringMode' is set to 1, the list won't grow beyond 'capacity', but instead overwrite the oldest "
+		"values with new ones, so only the most recent 'capacity' values are kept. By default, the list grows as needed.";
+static char seeAlsoString[] = "GetTimeList GetTimeListStats";
 	 
 
 PsychError SCREENClearTimeList(void) 
 {
-	
+	int capacity, ringMode;
 	
 	//all subfunctions should have these two lines.  
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
 	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
 	
 	//cap the numbers of inputs and outputs
-	PsychErrorExit(PsychCapNumInputArgs(0));   //The maximum number of inputs
+	PsychErrorExit(PsychCapNumInputArgs(2));   //The maximum number of inputs
 	PsychErrorExit(PsychCapNumOutputArgs(0));  //The maximum number of outputs
 	
-	//return the array
-	ClearTimingArray();
+	capacity = 0;
+	PsychCopyInIntegerArg(1, kPsychArgOptional, &capacity);
+	if (capacity < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'capacity' specified. Must be zero or a positive number.");
+
+	ringMode = 0;
+	PsychCopyInIntegerArg(2, kPsychArgOptional, &ringMode);
+	if ((ringMode != 0) && (capacity == 0)) PsychErrorExitMsg(PsychError_user, "'ringMode' requires a non-zero 'capacity'.");
+
+	//clear the array and set up its storage
+	if (!SetTimeListCapacity((unsigned int) capacity, (ringMode != 0) ? TRUE : FALSE))
+		PsychErrorExitMsg(PsychError_outofMemory, "Out of memory while trying to preallocate the time list.");
 	
 	return(PsychError_none);
 	
@@ -265,10 +265,16 @@ PsychError SCREENCopyWindow(void)
             PsychErrorExitMsg(PsychError_user, "Size mismatch of sourceRect and targetRect. Matching size is required for Onscreen to Offscreen copies. Sorry.");
         }
 
+        // Pooled textures share their OpenGL texture with other textures, so can't be copied into:
+        PsychTexturePoolCheckUnsupported(targetWin, "copy into");
+
         // Update selected textures content:
         // Looks weird but we need the framebuffer of sourceWin:
         PsychSetDrawingTarget(sourceWin);
 
+        // A pending background upload into the texture must complete first, so it doesn't overwrite the copy:
+        PsychTextureUploadWait(targetWin);
+
         // Disable alpha-blending:
         glDisable(GL_BLEND);
 
@@ -0,0 +1,69 @@
+/*
+    SCREENDeferredDrawing.c
+
+    PLATFORMS:
+
+        All.
+
+    DESCRIPTION:
+
+        Enable or disable deferred drawing mode for a window. See PsychDeferredDrawing.c
+        for the implementation.
+*/
+
+#include "Screen.h"
+
+// If you change useString then also change the corresponding synopsis string in ScreenSynopsis.c
+static char useString[] = "oldEnable = Screen('DeferredDrawing', windowPtr [, enable]);";
+//                                                               1            2
+static char synopsisString[] =
+    "Enable or disable deferred drawing mode for onscreen window, offscreen window or texture 'windowPtr'.\n"
+    "Returns the previous setting 'oldEnable': 1 if deferred drawing was enabled, 0 otherwise. If the optional "
+    "'enable' flag is provided, it enables deferred drawing if set to 1, or disables it if set to 0. "
+    "Deferred drawing is disabled by default.\n"
+    "In deferred drawing mode, calls to Screen('FillRect') with a single rect and single color, "
+    "Screen('DrawLine'), and Screen('DrawTexture') without 'textureShader', 'specialFlags' or "
+    "'auxParameters', don't draw immediately. Instead they get recorded into a list of pending drawing "
+    "commands for the window. The pending commands get executed all at once before any other drawing "
+    "into, or readback from, any window, before Screen('DrawingFinished') and Screen('Flip'), and when "
+    "deferred drawing gets disabled. Consecutive rects, consecutive lines of the same 'penWidth', and "
+    "consecutive draws of the same texture with the same 'filterMode' get executed as one batch each, "
+    "which saves a lot of per-command overhead if a stimulus is composed of many small primitives. The "
+    "order of drawing is not changed. If possible, use the batch drawing commands like Screen('FillRect') "
+    "with multiple rects, Screen('DrawLines') or Screen('DrawTextures') instead, which are even faster. "
+    "Deferred drawing mode is meant for code that can't easily be restructured to use them.\n"
+    "Errors in arguments are reported by the drawing command itself, but errors which can only be detected "
+    "at execution time, e.g., use of mip-mapped 'filterMode' on a texture which doesn't support it, are "
+    "reported by the command that causes the execution of the pending commands. Textures must not be "
+    "modified by code outside of Screen, e.g., by Matlab/Octave OpenGL commands without "
+    "Screen('BeginOpenGL'), while they are used by pending commands.\n"
+    "Deferred drawing is not supported on OpenGL-ES, and drawing commands get executed immediately if "
+    "the Preference 'EmulateOldPTB' is enabled, or while an async flip is in progress.";
+static char seeAlsoString[] = "FillRect DrawLine DrawTexture DrawTextures DrawingFinished Flip";
+
+PsychError SCREENDeferredDrawing(void)
+{
+    PsychWindowRecordType *windowRecord;
+    int enable;
+
+    // All subfunctions should have these two lines:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if (PsychIsGiveHelp()) { PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(2));
+    PsychErrorExit(PsychRequireNumInputArgs(1));
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+
+    PsychAllocInWindowRecordArg(1, kPsychArgRequired, &windowRecord);
+
+    // Return old setting:
+    PsychCopyOutDoubleArg(1, kPsychArgOptional, (windowRecord->deferredDrawing) ? 1 : 0);
+
+    // Get optional new setting:
+    if (PsychCopyInIntegerArg(2, kPsychArgOptional, &enable)) {
+        if (enable < 0 || enable > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'enable' flag provided. Must be 0 or 1.");
+        PsychSetDeferredDrawing(windowRecord, (enable > 0) ? TRUE : FALSE);
+    }
+
+    return(PsychError_none);
+}
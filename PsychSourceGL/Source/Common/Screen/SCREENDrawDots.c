@@ -117,7 +117,9 @@ static char useString[] = "[minSmoothPointSize, maxSmoothPointSize, minAliasedPo
 static char synopsisString[] =
 "Quickly draw an array of dots.  "
 "\"xy\" is a two-row vector containing the x and y coordinates of the dot centers, "
-"relative to \"center\" (default center is [0 0]).\n"
+"relative to \"center\" (default center is [0 0]). \"xy\" can be a double, single, int16 or uint16 "
+"matrix. Coordinates of type single or int16 are passed to the graphics hardware as they are, without "
+"any conversion, which is more efficient for big numbers of dots, as is single for \"size\".\n"
 "\"size\" is the diameter of each dot in pixels (default is 1). "
 "Instead of a common size for all dots you can also provide a "
 "vector which defines a different dot size for each dot. Different graphics cards do "
@@ -153,6 +155,10 @@ PsychError SCREENDrawDots(void)
     psych_bool                              isArgThere, usecolorvector;
     double                                  *xy, *size, *center, *dot_type, *colors;
     float                                   *sizef;
+    GLenum                                  xytype, sizetype;
+    const GLvoid                            *xyptr, *colorptr, *sizeptr;
+    size_t                                  xybytes, colorbytes, sizebytes;
+    psych_bool                              streamed;
     unsigned char                           *bytecolors;
     GLfloat                                 pointsizerange[2];
     psych_bool                              lenient = FALSE;
@@ -215,11 +221,11 @@ PsychError SCREENDrawDots(void)
     colors = NULL;
     bytecolors = NULL;
 
-    PsychPrepareRenderBatch(windowRecord, 2, &nrpoints, &xy, 4, &nc, &mc, &colors, &bytecolors, 3, &nrsize, &size, (GL_FLOAT == PsychGLFloatType(windowRecord)));
+    PsychPrepareRenderBatch(windowRecord, 2, &nrpoints, &xy, 4, &nc, &mc, &colors, &bytecolors, 3, &nrsize, &size, (GL_FLOAT == PsychGLFloatType(windowRecord)), &xytype, &sizetype);
     usecolorvector = (nc>1) ? TRUE:FALSE;
 
-    // Assign sizef as float-type array of sizes, if float mode active, NULL otherwise:
-    sizef = (GL_FLOAT == PsychGLFloatType(windowRecord)) ? (float*) size : NULL;
+    // Assign sizef as float-type array of sizes, if sizes are float, NULL otherwise:
+    sizef = (sizetype == GL_FLOAT) ? (float*) size : NULL;
 
     // Get center argument
     isArgThere = PsychIsArgPresent(PsychArgIn, 5);
@@ -326,6 +332,18 @@ PsychError SCREENDrawDots(void)
     if (!usePointSizeArray) glPointSize((sizef) ? sizef[0] : (float) size[0]);
     if (usePointSizeArray) glMultiTexCoord1f(GL_TEXTURE2, (sizef) ? sizef[0] : (float) size[0]);
 
+    // Validate individual sizes for each dot, if any:
+    if (nrsize > 1) {
+        for (i = 0; i < nrpoints; i++) {
+            if (!lenient && ((sizef && (sizef[i] > pointsizerange[1] || sizef[i] < pointsizerange[0])) ||
+                (!sizef && (size[i] > pointsizerange[1] || size[i] < pointsizerange[0])))) {
+                printf("PTB-ERROR: You requested a point size of %f units, which is not in the range (%f to %f) supported by your graphics hardware.\n",
+                       (sizef) ? sizef[i] : size[i], pointsizerange[0], pointsizerange[1]);
+                PsychErrorExitMsg(PsychError_user, "Unsupported point size requested in Screen('DrawDots').");
+            }
+        }
+    }
+
     // Setup modelview matrix to perform translation by 'center':
     glMatrixMode(GL_MODELVIEW);
 
@@ -341,14 +359,34 @@ PsychError SCREENDrawDots(void)
     // associated with the original implementation below and is potentially
     // optimized in specific OpenGL implementations.
 
-    // Pass a pointer to the start of the point-coordinate array:
-    glVertexPointer(2, PSYCHGLFLOAT, 0, &xy[0]);
+    // Copy all arrays into the streaming vertex buffer if possible. Then the driver
+    // neither has to copy nor synchronize on our client memory at each draw call. The
+    // pointers are then offsets into the bound vertex buffer:
+    xyptr = (const GLvoid*) xy;
+    colorptr = (usecolorvector) ? ((colors) ? (const GLvoid*) colors : (const GLvoid*) bytecolors) : NULL;
+    sizeptr = (sizef) ? (const GLvoid*) sizef : (const GLvoid*) size;
+
+    xybytes = (size_t) nrpoints * 2 * PsychGLTypeSize(xytype);
+    colorbytes = (usecolorvector) ? (size_t) nrpoints * mc * ((colors) ? PsychGLTypeSize(PSYCHGLFLOAT) : 1) : 0;
+    sizebytes = (nrsize > 1 && usePointSizeArray) ? (size_t) nrpoints * PsychGLTypeSize(sizetype) : 0;
+
+    streamed = PsychVertexStreamBegin(windowRecord, xybytes + colorbytes + sizebytes);
+    if (streamed) {
+        xyptr = PsychVertexStreamPush(windowRecord, xyptr, xybytes);
+        if (colorbytes) colorptr = PsychVertexStreamPush(windowRecord, colorptr, colorbytes);
+        if (sizebytes) sizeptr = PsychVertexStreamPush(windowRecord, sizeptr, sizebytes);
+    }
+
+    // Pass a pointer to the start of the point-coordinate array. It is in the
+    // data type provided by usercode, e.g., single() or int16(), so no copy
+    // or conversion of big dot fields is needed:
+    glVertexPointer(2, xytype, 0, xyptr);
 
     // Enable fast rendering of arrays:
     glEnableClientState(GL_VERTEX_ARRAY);
 
     if (usecolorvector) {
-        PsychSetupVertexColorArrays(windowRecord, TRUE, mc, colors, bytecolors);
+        PsychSetupVertexColorArrays(windowRecord, TRUE, mc, (colors) ? (double*) colorptr : NULL, (bytecolors) ? (unsigned char*) colorptr : NULL);
     }
 
     // Render all n points, starting at point 0, render them as POINTS:
@@ -360,28 +398,21 @@ PsychError SCREENDrawDots(void)
         if (nrsize > 1) {
             // Individual size for each dot provided. Setup texture unit 2
             // with a 1D texcoord array that stores per point size info in
-            // texture coordinate set 2. But first validate point sizes:
-            for (i = 0; i < nrpoints; i++) {
-                if (!lenient && ((sizef && (sizef[i] > pointsizerange[1] || sizef[i] < pointsizerange[0])) ||
-                    (!sizef && (size[i] > pointsizerange[1] || size[i] < pointsizerange[0])))) {
-                    printf("PTB-ERROR: You requested a point size of %f units, which is not in the range (%f to %f) supported by your graphics hardware.\n",
-                           (sizef) ? sizef[i] : size[i], pointsizerange[0], pointsizerange[1]);
-                    PsychErrorExitMsg(PsychError_user, "Unsupported point size requested in Screen('DrawDots').");
-                }
-            }
-
-            // Sizes are fine, setup texunit 2:
+            // texture coordinate set 2:
             glClientActiveTexture(GL_TEXTURE2);
             glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-            glTexCoordPointer(1, (sizef) ? GL_FLOAT : GL_DOUBLE, 0, (sizef) ? (const GLvoid*) sizef : (const GLvoid*) size);
+            glTexCoordPointer(1, sizetype, 0, sizeptr);
         }
 
+        // Array pointers are setup, so the vertex buffer can be unbound:
+        if (streamed) PsychVertexStreamEnd(windowRecord);
+
         // Draw all points:
         glDrawArrays(GL_POINTS, 0, nrpoints);
 
         if (nrsize > 1) {
             // Individual size for each dot provided. Reset texture unit 2:
-            glTexCoordPointer(1, (sizef) ? GL_FLOAT : GL_DOUBLE, 0, (const GLvoid*) NULL);
+            glTexCoordPointer(1, sizetype, 0, (const GLvoid*) NULL);
             glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
             // Back to default texunit 0:
@@ -391,14 +422,9 @@ PsychError SCREENDrawDots(void)
     else {
         // Different size for each dot provided and we can't use our shader based implementation:
         // We have to do One GL - call per dot:
-        for (i=0; i<nrpoints; i++) {
-            if (!lenient && ((sizef && (sizef[i] > pointsizerange[1] || sizef[i] < pointsizerange[0])) ||
-                (!sizef && (size[i] > pointsizerange[1] || size[i] < pointsizerange[0])))) {
-                printf("PTB-ERROR: You requested a point size of %f units, which is not in the range (%f to %f) supported by your graphics hardware.\n",
-                        (sizef) ? sizef[i] : size[i], pointsizerange[0], pointsizerange[1]);
-                PsychErrorExitMsg(PsychError_user, "Unsupported point size requested in Screen('DrawDots').");
-            }
+        if (streamed) PsychVertexStreamEnd(windowRecord);
 
+        for (i=0; i<nrpoints; i++) {
             // Setup point size for this point:
             if (!usePointSizeArray) glPointSize((sizef) ? sizef[i] : (float) size[i]);
 
@@ -409,7 +435,7 @@ PsychError SCREENDrawDots(void)
 
     // Disable fast rendering of arrays:
     glDisableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(2, PSYCHGLFLOAT, 0, NULL);
+    glVertexPointer(2, xytype, 0, NULL);
 
     if (usecolorvector) PsychSetupVertexColorArrays(windowRecord, FALSE, 0, NULL, NULL);
 
@@ -44,6 +44,7 @@ PsychError SCREENDrawLine(void)
 	psych_bool						isArgThere;
 	double							sX, sY, dX, dY, penSize;
 	float                           linesizerange[2];
+	PsychDeferredDrawCommand		*cmd;
 
 	//all sub functions should have these two lines
 	PsychPushHelp(useString, synopsisString,seeAlsoString);
@@ -74,7 +75,27 @@ PsychError SCREENDrawLine(void)
 	//get and set the pen size
 	penSize=1;
 	PsychCopyInDoubleArg(7, kPsychArgOptional, &penSize);
-	
+
+	// In deferred drawing mode, only record the line for drawing later. Validate the pen size
+	// against the range queried when deferred drawing was enabled:
+	if (PsychIsDeferredDrawingActive(windowRecord)) {
+		if (penSize < windowRecord->lineWidthRange[0] || penSize > windowRecord->lineWidthRange[1]) {
+			printf("PTB-ERROR: You requested a line width of %f units, which is not in the range (%f to %f) supported by your graphics hardware.\n",
+				   penSize, windowRecord->lineWidthRange[0], windowRecord->lineWidthRange[1]);
+			PsychErrorExitMsg(PsychError_user, "Unsupported line width requested.");
+		}
+
+		cmd = PsychAddDeferredDrawCommand(windowRecord, kPsychDeferredDrawLine);
+		PsychConvertColorToDoubleVector(&color, windowRecord, cmd->color);
+		cmd->rect[0] = sX;
+		cmd->rect[1] = sY;
+		cmd->rect[2] = dX;
+		cmd->rect[3] = dY;
+		cmd->param = penSize;
+
+		return(PsychError_none);
+	}
+
 	// Enable this windowRecords framebuffer as current drawingtarget:
 	PsychSetDrawingTarget(windowRecord);
 
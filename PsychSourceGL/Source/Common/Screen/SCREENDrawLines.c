@@ -61,7 +61,8 @@ static char synopsisString[] =
 "Quickly draw an array of lines into the specified window \"windowPtr\".\n"
 "\"xy\" is a two-row vector containing the x and y coordinates of the line segments: Pairs of consecutive "
 "columns define (x,y) positions of the starts and ends of line segments. All positions are relative "
-"to \"center\" (default center is [0 0]). \"width\" is either a scalar with the global width for "
+"to \"center\" (default center is [0 0]). \"xy\" can be a double, single, int16 or uint16 matrix, and "
+"is passed to the graphics hardware without conversion if it is single or int16. \"width\" is either a scalar with the global width for "
 "all lines in pixels (default is 1), or a vector with one separate width value for each separate line. "
 "\"colors\" is either a single global color argument for all lines, or an array of rgb or rgba "
 "color values for each line, where each column corresponds to the color of the corresponding line start or "
@@ -89,6 +90,10 @@ PsychError SCREENDrawLines(void)
     unsigned char               *bytecolors;
     float                       linesizerange[2];
     float                       *sizef;
+    GLenum                      xytype, sizetype;
+    const GLvoid                *xyptr, *colorptr;
+    size_t                      xybytes, colorbytes;
+    psych_bool                  streamed;
     psych_bool                  lenient = FALSE;
 
     //all sub functions should have these two lines
@@ -126,11 +131,11 @@ PsychError SCREENDrawLines(void)
     colors = NULL;
     bytecolors = NULL;
 
-    PsychPrepareRenderBatch(windowRecord, 2, &nrvertices, &xy, 4, &nc, &mc, &colors, &bytecolors, 3, &nrsize, &size, (GL_FLOAT == PsychGLFloatType(windowRecord)));
+    PsychPrepareRenderBatch(windowRecord, 2, &nrvertices, &xy, 4, &nc, &mc, &colors, &bytecolors, 3, &nrsize, &size, (GL_FLOAT == PsychGLFloatType(windowRecord)), &xytype, &sizetype);
     usecolorvector = (nc>1) ? TRUE:FALSE;
 
-    // Assign sizef as float-type array of sizes, if float mode active, NULL otherwise:
-    sizef = (GL_FLOAT == PsychGLFloatType(windowRecord)) ? (float*) size : NULL;
+    // Assign sizef as float-type array of sizes, if sizes are float, NULL otherwise:
+    sizef = (sizetype == GL_FLOAT) ? (float*) size : NULL;
 
     // Get center argument
     isArgThere = PsychIsArgPresent(PsychArgIn, 5);
@@ -204,13 +209,29 @@ PsychError SCREENDrawLines(void)
     // associated with the original implementation below and is potentially
     // optimized in specific OpenGL implementations.
 
+    // Copy the arrays into the streaming vertex buffer if possible, so the driver
+    // doesn't have to copy and synchronize on our client memory at each draw call:
+    xyptr = (const GLvoid*) xy;
+    colorptr = (usecolorvector) ? ((colors) ? (const GLvoid*) colors : (const GLvoid*) bytecolors) : NULL;
+    xybytes = (size_t) nrvertices * 2 * PsychGLTypeSize(xytype);
+    colorbytes = (usecolorvector) ? (size_t) nrvertices * mc * ((colors) ? PsychGLTypeSize(PSYCHGLFLOAT) : 1) : 0;
+
+    streamed = PsychVertexStreamBegin(windowRecord, xybytes + colorbytes);
+    if (streamed) {
+        xyptr = PsychVertexStreamPush(windowRecord, xyptr, xybytes);
+        if (colorbytes) colorptr = PsychVertexStreamPush(windowRecord, colorptr, colorbytes);
+    }
+
     // Pass a pointer to the start of the arrays:
-    glVertexPointer(2, PSYCHGLFLOAT, 0, &xy[0]);
+    glVertexPointer(2, xytype, 0, xyptr);
 
     if (usecolorvector) {
-        PsychSetupVertexColorArrays(windowRecord, TRUE, mc, colors, bytecolors);
+        PsychSetupVertexColorArrays(windowRecord, TRUE, mc, (colors) ? (double*) colorptr : NULL, (bytecolors) ? (unsigned char*) colorptr : NULL);
     }
 
+    // Array pointers are setup, so the vertex buffer can be unbound:
+    if (streamed) PsychVertexStreamEnd(windowRecord);
+
     // Enable fast rendering of arrays:
     glEnableClientState(GL_VERTEX_ARRAY);
 
@@ -237,7 +258,7 @@ PsychError SCREENDrawLines(void)
 
     // Disable fast rendering of arrays:
     glDisableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(2, PSYCHGLFLOAT, 0, NULL);
+    glVertexPointer(2, xytype, 0, NULL);
 
     if (usecolorvector) PsychSetupVertexColorArrays(windowRecord, FALSE, 0, NULL, NULL);
 
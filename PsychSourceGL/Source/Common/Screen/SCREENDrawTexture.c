@@ -100,6 +100,8 @@ PsychError SCREENDrawTexture(void)
     int numAuxParams, m, n, p;
     psych_bool isclassic;
     int specialFlags = 0;
+    PsychDeferredDrawCommand *cmd;
+    GLdouble colorvalues[4];
 
     //all subfunctions should have these two lines.
     PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -141,6 +143,28 @@ PsychError SCREENDrawTexture(void)
     // for HDR rendering or procedural shading.
     PsychCopyInDoubleArg(7, kPsychArgOptional, &globalAlpha);
 
+    // In deferred drawing mode, only record the texture for drawing later, unless it gets drawn
+    // into itself, or with a textureShader, specialFlags or auxParameters:
+    if (PsychIsDeferredDrawingActive(target) && (source != target) && !PsychIsArgPresent(PsychArgIn, 9) &&
+        !PsychIsArgPresent(PsychArgIn, 10) && !PsychIsArgPresent(PsychArgIn, 11)) {
+        if (PsychCopyInColorArg(8, kPsychArgOptional, &color)) {
+            PsychCoerceColorMode(&color);
+            PsychConvertColorToDoubleVector(&color, target, colorvalues);
+            globalAlpha = DBL_MAX;
+        }
+
+        cmd = PsychAddDeferredDrawCommand(target, kPsychDeferredDrawTexture);
+        if (globalAlpha == DBL_MAX) memcpy(cmd->color, colorvalues, sizeof(colorvalues));
+        PsychCopyRect(cmd->srcRect, sourceRect);
+        PsychCopyRect(cmd->rect, targetRect);
+        cmd->param = rotationAngle;
+        cmd->globalAlpha = globalAlpha;
+        cmd->filterMode = filterMode;
+        cmd->source = source;
+
+        return(PsychError_none);
+    }
+
     PsychSetDrawingTarget(target);
     PsychUpdateAlphaBlendingFactorLazily(target);
 
@@ -238,14 +262,14 @@ PsychError SCREENDrawTextures(void)
     "b) n textures drawn to n different locations: Same as a) but provide a n component vector of 'texturePointers' one for "
     "each texture to be drawn to one of n locations at n angles.\n";
 
-    PsychWindowRecordType *source, *target;
+    PsychWindowRecordType *source, *target, *batchSource = NULL;
     PsychRectType sourceRect, targetRect, tempRect;
     PsychColorType color;
     double *dstRects, *srcRects, *colors, *penSizes, *globalAlphas, *filterModes, *rotationAngles;
     unsigned char *bytecolors;
     int numTexs, numdstRects, numsrcRects, i, nc, mc, nrsize, m, n, p, numAngles, numFilterModes, numAlphas, numRef;
     double* texids;
-    double rotationAngle, globalAlpha, filterMode;
+    double rotationAngle, globalAlpha, filterMode, batchFilterMode = 0;
     double* auxParameters;
     int numAuxParams, numAuxComponents;
     psych_bool isclassic;
@@ -294,7 +318,7 @@ PsychError SCREENDrawTextures(void)
 
     // The negative position -4 means: dstRects coords are expected at position 4, but they are optional.
     // NULL means - don't want a size's vector.
-    PsychPrepareRenderBatch(target, -4, &numdstRects, &dstRects, 8, &nc, &mc, &colors, &bytecolors, 5, &nrsize, &penSizes, FALSE);
+    PsychPrepareRenderBatch(target, -4, &numdstRects, &dstRects, 8, &nc, &mc, &colors, &bytecolors, 5, &nrsize, &penSizes, FALSE, NULL, NULL);
 
     // At this point, target is set up as target window, i.e. its GL-Context is active, it is set as drawing target,
     // alpha blending is set up according to Screen('BlendFunction'), and the drawing color is set if it is a singular one.
@@ -428,8 +452,11 @@ PsychError SCREENDrawTextures(void)
     // Assign any other optional special flags:
     PsychCopyInIntegerArg(10, kPsychArgOptional, &specialFlags);
 
-    // Check if efficient batch drawing is possible at the GL level:
-    if (isclassic && (numTexs == 1) && (numFilterModes <= 1)) {
+    // Check if efficient batch drawing is possible at the GL level. With multiple textures or
+    // filterModes, each run of consecutive items with the same texture and filterMode is drawn
+    // as one batch, so the drawing order is preserved. Textures from the same page of the texture
+    // pool count as the same texture:
+    if (isclassic) {
         batchIt = TRUE;
     }
     else {
@@ -439,12 +466,6 @@ PsychError SCREENDrawTextures(void)
     if (PsychPrefStateGet_Verbosity() > 5)
         printf("PTB-DEBUG: DrawTextures optimized batch submit: %i\n", (int) batchIt);
 
-    if (batchIt) {
-        // Signal start of new batch with numRef drawn textures, all sourced from source and
-        // drawn into windo target with filterMode:
-        PsychBatchBlitTexturesToDisplay(0, numRef, source, target, NULL, NULL, 0, (int) filterMode, 1.0);
-    }
-
     // Texture blitting loop:
     for (i=0; i < numRef; i++) {
         // Draw i'th texture:
@@ -577,8 +598,22 @@ PsychError SCREENDrawTextures(void)
         }
 
         if (batchIt) {
+            // Texture which can't be batched with the current batch, or different filterMode? Finalize it:
+            if (batchSource && (!PsychCanBatchBlitTextures(batchSource, source) || (batchFilterMode != filterMode))) {
+                PsychBatchBlitTexturesToDisplay(1, numRef - i, batchSource, target, NULL, NULL, 0, (int) batchFilterMode, 1.0);
+                batchSource = NULL;
+            }
+
+            // Signal start of new batch with at most numRef - i drawn textures, all sourced from
+            // source and drawn into window target with filterMode:
+            if (NULL == batchSource) {
+                batchSource = source;
+                batchFilterMode = filterMode;
+                PsychBatchBlitTexturesToDisplay(0, numRef - i, source, target, NULL, NULL, 0, (int) filterMode, 1.0);
+            }
+
             // Add current element to the batch to be drawn:
-            PsychBatchBlitTexturesToDisplay(2, numRef, source, target, sourceRect, targetRect, rotationAngle, (int) filterMode, globalAlpha);
+            PsychBatchBlitTexturesToDisplay(2, numRef - i, source, target, sourceRect, targetRect, rotationAngle, (int) filterMode, globalAlpha);
         }
         else {
             // Perform blit operation for i'th texture, either with or without an override texture shader applied:
@@ -598,9 +633,9 @@ PsychError SCREENDrawTextures(void)
     target->auxShaderParams = NULL;
     target->auxShaderParamsCount = 0;
 
-    if (batchIt) {
+    if (batchSource) {
         // Finalize batch drawing:
-        PsychBatchBlitTexturesToDisplay(1, numRef, source, target, NULL, NULL, 0, (int) filterMode, 1.0);
+        PsychBatchBlitTexturesToDisplay(1, numRef, batchSource, target, NULL, NULL, 0, (int) batchFilterMode, 1.0);
     }
 
     // Mark end of drawing op. This is needed for single buffered drawing:
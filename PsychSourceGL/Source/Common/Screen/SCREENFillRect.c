@@ -52,6 +52,96 @@ static char synopsisString[] =
 	"matrix, the i'th column specifiying the color of the i'th rectangle. ";
 static char seeAlsoString[] = "FrameRect";	
 
+// Draw a batch of 'numRects' rects 'xy' as quads from the streaming vertex buffer, with one draw call.
+// Colors are either already set, or provided as 'nc' colors of 'mc' components in 'colors' or 'bytecolors',
+// one per rect. Returns FALSE without drawing if this isn't possible, so the caller has to draw the rects
+// one by one:
+static psych_bool PsychFillRectsStreamed(PsychWindowRecordType *windowRecord, int numRects, double *xy, int nc, int mc, double *colors, unsigned char *bytecolors)
+{
+	double			*vertices, *rect, *vcolors;
+	unsigned char	*vbytecolors;
+	const GLvoid	*xyptr, *colorptr;
+	size_t			xybytes, colorbytes;
+	int				i, j, k;
+
+	// Unclamped color mode can't take uint8 vertex color arrays:
+	if ((nc > 1) && bytecolors && windowRecord->defaultDrawShader) return(FALSE);
+
+	xybytes = (size_t) numRects * 4 * 2 * sizeof(double);
+	colorbytes = (nc > 1) ? (size_t) numRects * 4 * mc * ((colors) ? sizeof(double) : 1) : 0;
+	if (!PsychVertexStreamBegin(windowRecord, xybytes + colorbytes)) return(FALSE);
+
+	// Build the 4 vertices of each rect, in the same order as glRectd():
+	vertices = (double*) PsychMallocTemp(xybytes);
+	for (i = 0; i < numRects; i++) {
+		rect = &(xy[i*4]);
+		vertices[i*8 + 0] = rect[kPsychLeft];  vertices[i*8 + 1] = rect[kPsychTop];
+		vertices[i*8 + 2] = rect[kPsychRight]; vertices[i*8 + 3] = rect[kPsychTop];
+		vertices[i*8 + 4] = rect[kPsychRight]; vertices[i*8 + 5] = rect[kPsychBottom];
+		vertices[i*8 + 6] = rect[kPsychLeft];  vertices[i*8 + 7] = rect[kPsychBottom];
+	}
+	xyptr = PsychVertexStreamPush(windowRecord, vertices, xybytes);
+
+	if (nc > 1) {
+		// Replicate color of each rect for its 4 vertices:
+		if (colors) {
+			vcolors = (double*) PsychMallocTemp(colorbytes);
+			for (i = 0; i < numRects; i++) for (j = 0; j < 4; j++) for (k = 0; k < mc; k++) vcolors[(i*4 + j)*mc + k] = colors[i*mc + k];
+			colorptr = PsychVertexStreamPush(windowRecord, vcolors, colorbytes);
+		}
+		else {
+			vbytecolors = (unsigned char*) PsychMallocTemp(colorbytes);
+			for (i = 0; i < numRects; i++) for (j = 0; j < 4; j++) memcpy(&vbytecolors[(i*4 + j)*mc], &bytecolors[i*mc], mc);
+			colorptr = PsychVertexStreamPush(windowRecord, vbytecolors, colorbytes);
+		}
+
+		PsychSetupVertexColorArrays(windowRecord, TRUE, mc, (colors) ? (double*) colorptr : NULL, (bytecolors) ? (unsigned char*) colorptr : NULL);
+	}
+
+	glVertexPointer(2, GL_DOUBLE, 0, xyptr);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	PsychVertexStreamEnd(windowRecord);
+
+	glDrawArrays(GL_QUADS, 0, numRects * 4);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_DOUBLE, 0, NULL);
+	if (nc > 1) PsychSetupVertexColorArrays(windowRecord, FALSE, 0, NULL, NULL);
+
+	return(TRUE);
+}
+
+// Record a fill of a single rect in a single color in deferred drawing mode, instead of drawing it. Returns FALSE
+// without recording anything for fills of multiple rects or the whole window, which are drawn immediately:
+static psych_bool PsychDeferFillRect(PsychWindowRecordType *windowRecord)
+{
+	PsychDeferredDrawCommand		*cmd;
+	PsychColorType					color;
+	PsychRectType					rect;
+	GLdouble						colorvalues[4];
+	double							whiteValue;
+
+	if (!PsychIsArgPresent(PsychArgIn, 3) || (PsychGetArgM(3) * PsychGetArgN(3) != 4)) return(FALSE);
+	if (PsychIsArgPresent(PsychArgIn, 2) && (PsychGetArgM(2) * PsychGetArgN(2) > 4)) return(FALSE);
+
+	PsychCopyInRectArg(3, kPsychArgRequired, rect);
+	if (IsPsychRectEmpty(rect)) return(TRUE);
+	if (PsychMatchRect(rect, windowRecord->clientrect)) return(FALSE);
+
+	if (!PsychCopyInColorArg(2, kPsychArgOptional, &color)) {
+		whiteValue=PsychGetWhiteValueFromWindow(windowRecord);
+		PsychLoadColorStruct(&color, kPsychIndexColor, whiteValue ); //index mode will coerce to any other.
+	}
+	PsychCoerceColorMode(&color);
+	PsychConvertColorToDoubleVector(&color, windowRecord, colorvalues);
+
+	cmd = PsychAddDeferredDrawCommand(windowRecord, kPsychDeferredFillRect);
+	memcpy(cmd->color, colorvalues, sizeof(colorvalues));
+	PsychCopyRect(cmd->rect, rect);
+
+	return(TRUE);
+}
+
 PsychError SCREENFillRect(void)  
 {
 	
@@ -74,6 +164,9 @@ PsychError SCREENFillRect(void)
 
 	//get the window record from the window record argument and get info from the window record
 	PsychAllocInWindowRecordArg(1, kPsychArgRequired, &windowRecord);
+
+	// In deferred drawing mode, single rects are only recorded for drawing later:
+	if (PsychIsDeferredDrawingActive(windowRecord) && PsychDeferFillRect(windowRecord)) return(PsychError_none);
 	
 	// Query, allocate and copy in all vectors...
 	numRects = 4;
@@ -83,7 +176,7 @@ PsychError SCREENFillRect(void)
 
 	// The negative position -3 means: xy coords are expected at position 3, but they are optional.
 	// NULL means - don't want a size's vector.
-	PsychPrepareRenderBatch(windowRecord, -3, &numRects, &xy, 2, &nc, &mc, &colors, &bytecolors, 0, &nrsize, NULL, FALSE);
+	PsychPrepareRenderBatch(windowRecord, -3, &numRects, &xy, 2, &nc, &mc, &colors, &bytecolors, 0, &nrsize, NULL, FALSE, NULL, NULL);
 	isScreenRect=FALSE;
 	
 	// Only up to one rect provided?
@@ -153,16 +246,18 @@ PsychError SCREENFillRect(void)
 	  } else {
 	    // Partial fill: Draw provided rects:
 		if (numRects>1) {
-			// Multiple rects provided: Draw the whole batch:
-			for (i=0; i<numRects; i++) {
-				// Per rect color provided?
-				if (nc>1) {
-					// Yes. Set color for this specific rect:
-					PsychSetArrayColor(windowRecord, i, mc, colors, bytecolors);
+			// Multiple rects provided: Draw the whole batch, with one draw call if possible, otherwise one by one:
+			if (!PsychFillRectsStreamed(windowRecord, numRects, xy, nc, mc, colors, bytecolors)) {
+				for (i=0; i<numRects; i++) {
+					// Per rect color provided?
+					if (nc>1) {
+						// Yes. Set color for this specific rect:
+						PsychSetArrayColor(windowRecord, i, mc, colors, bytecolors);
+					}
+
+					// Submit rect for drawing:
+					if (!IsPsychRectEmpty(rect)) PsychGLRect(&(xy[i*4]));
 				}
-				
-				// Submit rect for drawing:
-				if (!IsPsychRectEmpty(rect)) PsychGLRect(&(xy[i*4]));
 			}
 		}
 		else {
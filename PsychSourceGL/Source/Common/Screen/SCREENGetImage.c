@@ -142,7 +142,78 @@ static char synopsisString2[] =
 "Not all video codecs allow for lossless encoding or encoding of all color channels.\n\n"
 "See Screen('CreateMovie?') for help on movie creation.\n";
 
-static char seeAlsoString[] = "PutImage CopyWindow CreateMovie FinalizeMovie";
+static char useString3[] = "handle=Screen('GetImageAsyncBegin', windowPtr [,rect] [,bufferName] [,floatprecision=0] [,nrchannels=3])";
+//                                                              1           2       3             4                   5
+
+static char synopsisString3[] =
+"Start an asynchronous copy of an image from a window or texture to Matlab/Octave.\n\n"
+"This works like Screen('GetImage'), but doesn't wait for the graphics card to finish "
+"rendering and copying the image. Instead the graphics card copies the image into a "
+"buffer in the background, while your script and the graphics card go on with their "
+"work, e.g., with drawing and flipping the next stimulus frames. The function returns "
+"a 'handle' to the pending image. Pass it to Screen('GetImageAsyncEnd') a few frames "
+"later, to retrieve the image. This allows to record each frame of a stimulus with "
+"much less impact on performance and timing than Screen('GetImage').\n\n"
+"Up to 8 asynchronous copies can be pending for an onscreen window and all its "
+"offscreen windows and textures. The function aborts with an error if you try to "
+"start more without retrieving the pending ones.\n\n"
+"The arguments have the same meaning as for Screen('GetImage'), see 'help' for that "
+"function. Copies in 'floatprecision' need more time for the final conversion into a "
+"double matrix in Screen('GetImageAsyncEnd').\n\n"
+"This function requires graphics hardware with support for OpenGL pixel buffer objects.\n";
+
+static char useString4[] = "imageArray=Screen('GetImageAsyncEnd', windowPtr, handle [,waitForCompletion=1])";
+//                                                               1          2        3
+
+static char synopsisString4[] =
+"Retrieve the image of an asynchronous copy started by Screen('GetImageAsyncBegin').\n\n"
+"\"windowPtr\" is the handle of the window or texture which was passed to 'GetImageAsyncBegin', "
+"or of any other window or texture which belongs to the same onscreen window.\n\n"
+"\"handle\" is the handle returned by 'GetImageAsyncBegin'. It becomes invalid after "
+"the image has been retrieved.\n\n"
+"\"waitForCompletion\" If set to the default of 1, the function waits for the graphics "
+"card to finish the copy, if it is not yet finished. If set to 0, the function returns "
+"an empty 'imageArray' instead of waiting, and the copy remains pending, so you can "
+"try again later. This polling requires OpenGL sync object support, otherwise the "
+"function always waits.\n\n"
+"The returned 'imageArray' is the same as from Screen('GetImage') for the arguments "
+"passed to 'GetImageAsyncBegin'.\n";
+
+static char seeAlsoString[] = "PutImage CopyWindow CreateMovie FinalizeMovie GetImageAsyncBegin GetImageAsyncEnd";
+
+// Return OpenGL pixel format for readback of 'nrchannels' color channels, and the
+// number of components per pixel in 'stride'. RGB images are read back as RGBA, as
+// 4 component pixels are the native format of most gpu's and of our conversion:
+static GLenum PsychGetImageReadFormat(psych_bool isOES, int nrchannels, int* stride)
+{
+    // We only do RGBA reads on OES, then discard unwanted stuff ourselves:
+    if (isOES || (nrchannels >= 3)) {
+        *stride = 4;
+        return(GL_RGBA);
+    }
+
+    *stride = nrchannels;
+    return((nrchannels == 1) ? GL_RED : GL_LUMINANCE_ALPHA);
+}
+
+// Return image of 'width' x 'height' pixels read back by glReadPixels() into 'pixels' as return argument 1:
+static void PsychGetImageCopyOut(const void* pixels, psych_bool floatprecision, int nrchannels, int stride, size_t width, size_t height)
+{
+    psych_uint8     *returnArrayBase;
+    double          *returnArrayBaseDouble;
+
+    // Transpose and flip what we read with glReadPixels before returning:
+    // -glReadPixels insists on filling up memory in sequence by reading the screen row-wise whearas Matlab reads up memory into columns.
+    // -the Psychtoolbox screen as setup by gluOrtho puts 0,0 at the top left of the window but glReadPixels always believes that it's at the bottom left.
+    if (floatprecision) {
+        PsychAllocOutDoubleMatArg(1, TRUE, (int) height, (int) width, (int) nrchannels, &returnArrayBaseDouble);
+        PsychReadbackTexelsToDouble(returnArrayBaseDouble, (const GLfloat*) pixels, nrchannels, stride, width, height);
+    }
+    else {
+        PsychAllocOutUnsignedByteMatArg(1, TRUE, (int) height, (int) width, (int) nrchannels, &returnArrayBase);
+        PsychReadbackTexelsToUByte(returnArrayBase, (const GLubyte*) pixels, nrchannels, stride, width, height);
+    }
+}
 
 // This also works as 'AddFrameToMovie', as almost all code is shared with 'GetImage'.
 // Only difference is where the fetched pixeldata is sent: To the movie encoder or to
@@ -151,12 +222,13 @@ PsychError SCREENGetImage(void)
 {
     PsychRectType   windowRect, sampleRect;
     int             nrchannels, invertedY, stride;
-    size_t          ix, iy, sampleRectWidth, sampleRectHeight, redReturnIndex, greenReturnIndex, blueReturnIndex, alphaReturnIndex;
+    size_t          sampleRectWidth, sampleRectHeight, bufferSize;
     int             viewid = 0;
-    psych_uint8     *returnArrayBase, *redPlane;
-    float           *dredPlane;
-    double          *returnArrayBaseDouble;
-    PsychWindowRecordType *windowRecord;
+    void            *pixels;
+    GLenum          readformat, readtype;
+    PsychWindowRecordType *windowRecord, *parentRecord;
+    PsychAsyncReadback *readback;
+    int             i;
     GLboolean       isDoubleBuffer, isStereo;
     char*           buffername = NULL;
     psych_bool      floatprecision = FALSE;
@@ -167,13 +239,17 @@ PsychError SCREENGetImage(void)
     unsigned char*  framepixels;
     psych_bool      isOES;
 
-    // Called as 2nd personality "AddFrameToMovie" ?
+    // Called as 2nd personality "AddFrameToMovie" or 3rd personality "GetImageAsyncBegin" ?
     psych_bool isAddMovieFrame = PsychMatch(PsychGetFunctionName(), "AddFrameToMovie");
+    psych_bool isAsyncBegin = PsychMatch(PsychGetFunctionName(), "GetImageAsyncBegin");
 
     // All sub functions should have these two lines
     if (isAddMovieFrame) {
         PsychPushHelp(useString2, synopsisString2, seeAlsoString);
     }
+    else if (isAsyncBegin) {
+        PsychPushHelp(useString3, synopsisString3, seeAlsoString);
+    }
     else {
         PsychPushHelp(useString, synopsisString, seeAlsoString);
     }
@@ -459,110 +535,76 @@ PsychError SCREENGetImage(void)
         PsychCopyInIntegerArg(5, FALSE, &nrchannels);
         if (nrchannels < 1 || nrchannels > 4) PsychErrorExitMsg(PsychError_user, "Number of requested channels 'nrchannels' must be between 1 and 4!");
 
-        if (!floatprecision) {
-            // Readback of standard 8bpc uint8 pixels:
-
-            // No Luminance + Alpha on OES:
-            if (isOES && (nrchannels == 2)) PsychErrorExitMsg(PsychError_user, "Number of requested channels 'nrchannels' == 2 not supported on OpenGL-ES!");
+        // No Luminance + Alpha on OES:
+        if (isOES && (nrchannels == 2)) PsychErrorExitMsg(PsychError_user, "Number of requested channels 'nrchannels' == 2 not supported on OpenGL-ES!");
 
-            PsychAllocOutUnsignedByteMatArg(1, TRUE, (int) sampleRectHeight, (int) sampleRectWidth, (int) nrchannels, &returnArrayBase);
-            if (isOES) {
-                // We only do RGBA reads on OES, then discard unwanted stuff ourselves:
-                redPlane  = (psych_uint8*) PsychMallocTemp((size_t) 4 * sampleRectWidth * sampleRectHeight);
-            }
-            else {
-                redPlane  = (psych_uint8*) PsychMallocTemp((size_t) nrchannels * sampleRectWidth * sampleRectHeight);
-            }
-
-            glPixelStorei(GL_PACK_ALIGNMENT,1);
-            invertedY = (int) (windowRect[kPsychBottom] - sampleRect[kPsychBottom]);
-
-            if (isOES) {
-                glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGBA, GL_UNSIGNED_BYTE, redPlane);
-                stride = 4;
-            }
-            else {
-                stride = nrchannels;
-                if (nrchannels==1) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RED, GL_UNSIGNED_BYTE, redPlane);
-                if (nrchannels==2) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, redPlane);
-                if (nrchannels==3) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGB, GL_UNSIGNED_BYTE, redPlane);
-                if (nrchannels==4) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGBA, GL_UNSIGNED_BYTE, redPlane);
-            }
-
-            //in one pass transpose and flip what we read with glReadPixels before returning.
-            //-glReadPixels insists on filling up memory in sequence by reading the screen row-wise whearas Matlab reads up memory into columns.
-            //-the Psychtoolbox screen as setup by gluOrtho puts 0,0 at the top left of the window but glReadPixels always believes that it's at the bottom left.
-            for(ix=0; ix < sampleRectWidth; ix++){
-                for(iy=0; iy < sampleRectHeight; iy++){
-                    // Compute write-indices for returned data:
-                    redReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth, nrchannels, iy, ix, 0);
-                    greenReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 1);
-                    blueReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 2);
-                    alphaReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 3);
-
-                    // Always return RED/LUMINANCE channel:
-                    returnArrayBase[redReturnIndex] = redPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 0];
-                    // Other channels on demand:
-                    if (nrchannels>1) returnArrayBase[greenReturnIndex] = redPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 1];
-                    if (nrchannels>2) returnArrayBase[blueReturnIndex]  = redPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 2];
-                    if (nrchannels>3) returnArrayBase[alphaReturnIndex] = redPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 3];
-                }
-            }
-        }
-        else {
+        if (floatprecision) {
             // Readback of standard 32bpc float pixels into a double matrix:
 
-            // No Luminance + Alpha on OES:
-            if (isOES && (nrchannels == 2)) PsychErrorExitMsg(PsychError_user, "Number of requested channels 'nrchannels' == 2 not supported on OpenGL-ES!");
-
             // Only float readback on floating point FBO's with EXT_color_buffer_float support:
             if (isOES && ((whichBuffer != GL_COLOR_ATTACHMENT0_EXT) || (windowRecord->bpc < 16) || !glewIsSupported("GL_EXT_color_buffer_float"))) {
                 printf("PTB-ERROR: Tried to 'GetImage' pixels in floating point format from a non-floating point surface, or not supported by your hardware.\n");
                 PsychErrorExitMsg(PsychError_user, "'GetImage' of floating point values from given object not supported on OpenGL-ES!");
             }
+        }
 
-            PsychAllocOutDoubleMatArg(1, TRUE, (int) sampleRectHeight, (int) sampleRectWidth, (int) nrchannels, &returnArrayBaseDouble);
-            if (isOES) {
-                dredPlane = (float*) PsychMallocTemp((size_t) 4 * sizeof(float) * sampleRectWidth * sampleRectHeight);
-                stride = 4;
-            }
-            else {
-                dredPlane = (float*) PsychMallocTemp((size_t) nrchannels * sizeof(float) * sampleRectWidth * sampleRectHeight);
-                stride = nrchannels;
-            }
+        // Readback of standard 8bpc uint8 pixels or 32bpc float pixels:
+        readformat = PsychGetImageReadFormat(isOES, nrchannels, &stride);
+        readtype = (floatprecision) ? GL_FLOAT : GL_UNSIGNED_BYTE;
+        bufferSize = (size_t) stride * ((floatprecision) ? sizeof(float) : sizeof(psych_uint8)) * sampleRectWidth * sampleRectHeight;
 
-            glPixelStorei(GL_PACK_ALIGNMENT, 1);
-            invertedY = (int) (windowRect[kPsychBottom]-sampleRect[kPsychBottom]);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        invertedY = (int) (windowRect[kPsychBottom] - sampleRect[kPsychBottom]);
 
-            if (!isOES) {
-                if (nrchannels==1) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RED, GL_FLOAT, dredPlane);
-                if (nrchannels==2) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_LUMINANCE_ALPHA, GL_FLOAT, dredPlane);
-                if (nrchannels==3) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGB, GL_FLOAT, dredPlane);
-                if (nrchannels==4) glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGBA, GL_FLOAT, dredPlane);
-            }
-            else {
-                glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, GL_RGBA, GL_FLOAT, dredPlane);
+        if (isAsyncBegin) {
+            // Asynchronous readback into a pixel buffer object. The buffers belong to the
+            // parent onscreen window, as all its offscreen windows and textures share its OpenGL context:
+            parentRecord = PsychGetParentWindow(windowRecord);
+            if (!PsychIsOnscreenWindow(parentRecord)) PsychErrorExitMsg(PsychError_user, "Asynchronous 'GetImage' is only possible for windows and textures which belong to an onscreen window.");
+
+            if ((isOES && !glMapBufferRange) || (!isOES && !(GLEW_VERSION_2_1 || glewIsSupported("GL_ARB_pixel_buffer_object")))) {
+                PsychErrorExitMsg(PsychError_user, "Asynchronous 'GetImage' not supported by your graphics hardware, as it lacks pixel buffer objects.");
             }
 
-            //in one pass transpose and flip what we read with glReadPixels before returning.
-            //-glReadPixels insists on filling up memory in sequence by reading the screen row-wise whearas Matlab reads up memory into columns.
-            //-the Psychtoolbox screen as setup by gluOrtho puts 0,0 at the top left of the window but glReadPixels always believes that it's at the bottom left.
-            for(ix=0; ix < sampleRectWidth; ix++){
-                for(iy=0; iy < sampleRectHeight; iy++){
-                    // Compute write-indices for returned data:
-                    redReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth, nrchannels, iy, ix, 0);
-                    greenReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 1);
-                    blueReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 2);
-                    alphaReturnIndex=PsychIndexElementFrom3DArray(sampleRectHeight, sampleRectWidth,  nrchannels, iy, ix, 3);
-
-                    // Always return RED/LUMINANCE channel:
-                    returnArrayBaseDouble[redReturnIndex] = dredPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 0];
-                    // Other channels on demand:
-                    if (nrchannels>1) returnArrayBaseDouble[greenReturnIndex] = dredPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 1];
-                    if (nrchannels>2) returnArrayBaseDouble[blueReturnIndex]  = dredPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 2];
-                    if (nrchannels>3) returnArrayBaseDouble[alphaReturnIndex] = dredPlane[(ix + ((sampleRectHeight-1) - iy ) * sampleRectWidth) * (size_t) stride + 3];
-                }
+            // Use any free slot, as readbacks may be retrieved in any order. Prefer one whose pixel
+            // buffer already has the needed size, so it doesn't need to be reallocated:
+            readback = NULL;
+            for (i = 0; i < kPsychMaxAsyncReadbacks; i++) {
+                if (parentRecord->asyncReadbacks[i].handle) continue;
+                if (!readback || (parentRecord->asyncReadbacks[i].pboSize == bufferSize)) readback = &(parentRecord->asyncReadbacks[i]);
+                if (readback->pboSize == bufferSize) break;
             }
+            if (!readback) PsychErrorExitMsg(PsychError_user, "Too many pending asynchronous readbacks. Retrieve them via Screen('GetImageAsyncEnd') before starting new ones.");
+
+            // Create or resize pixel buffer if needed. Otherwise we reuse it without reallocation:
+            if (!readback->pbo) glGenBuffers(1, &(readback->pbo));
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+            if (readback->pboSize != bufferSize) {
+                glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) bufferSize, NULL, GL_STREAM_READ);
+                readback->pboSize = bufferSize;
+            }
+
+            // Readback into pixel buffer doesn't block, and the fence allows to poll for its completion:
+            glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, readformat, readtype, NULL);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            readback->fence = (glFenceSync) ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : NULL;
+
+            // Submit to gpu now, so the readback executes while we go on:
+            glFlush();
+
+            readback->handle = ++(parentRecord->asyncReadbackCount);
+            readback->width = (int) sampleRectWidth;
+            readback->height = (int) sampleRectHeight;
+            readback->nrchannels = nrchannels;
+            readback->stride = stride;
+            readback->floatprecision = floatprecision;
+
+            PsychCopyOutDoubleArg(1, FALSE, (double) readback->handle);
+        }
+        else {
+            pixels = PsychMallocTemp(bufferSize);
+            glReadPixels((int) sampleRect[kPsychLeft], invertedY, (int) sampleRectWidth, (int) sampleRectHeight, readformat, readtype, pixels);
+            PsychGetImageCopyOut(pixels, floatprecision, nrchannels, stride, sampleRectWidth, sampleRectHeight);
         }
     }
 
@@ -642,3 +684,71 @@ PsychError SCREENGetImage(void)
 
     return(PsychError_none);
 }
+
+PsychError SCREENGetImageAsyncEnd(void)
+{
+    PsychWindowRecordType *windowRecord, *parentRecord;
+    PsychAsyncReadback *readback;
+    int             handle, i;
+    int             waitForCompletion = 1;
+    double          dummy;
+    void            *pixels;
+
+    // All sub functions should have these two lines
+    PsychPushHelp(useString4, synopsisString4, seeAlsoString);
+    if (PsychIsGiveHelp()) { PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(3));
+    PsychErrorExit(PsychRequireNumInputArgs(2));
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+
+    // Get the window or texture, and its parent onscreen window which owns the readbacks:
+    PsychAllocInWindowRecordArg(1, TRUE, &windowRecord);
+    parentRecord = PsychGetParentWindow(windowRecord);
+
+    PsychCopyInIntegerArg(2, TRUE, &handle);
+    PsychCopyInIntegerArg(3, FALSE, &waitForCompletion);
+
+    // Find the slot of the pending readback:
+    readback = NULL;
+    if (PsychIsOnscreenWindow(parentRecord) && (handle > 0)) {
+        for (i = 0; i < kPsychMaxAsyncReadbacks; i++) {
+            if (parentRecord->asyncReadbacks[i].handle == handle) readback = &(parentRecord->asyncReadbacks[i]);
+        }
+    }
+    if (!readback) PsychErrorExitMsg(PsychError_user, "Invalid 'handle' provided. Doesn't correspond to a pending asynchronous readback of this window.");
+
+    // Onscreen window busy with an async flip? Then we can't touch its OpenGL context:
+    if (parentRecord->flipInfo->asyncstate > 0) PsychErrorExitMsg(PsychError_user, "Tried to retrieve an asynchronous readback while an async flip is pending on its onscreen window. Unsupported!");
+
+    PsychSetGLContext(parentRecord);
+
+    // Readback not yet finished and polling requested? Then return an empty matrix:
+    if (!waitForCompletion && readback->fence && (glClientWaitSync(readback->fence, 0, 0) == GL_TIMEOUT_EXPIRED)) {
+        PsychCopyOutDoubleMatArg(1, kPsychArgOptional, 0, 0, 0, &dummy);
+        return(PsychError_none);
+    }
+
+    // Mapping the buffer waits for completion of the readback, if needed:
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    if (glMapBufferRange) {
+        pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) readback->pboSize, GL_MAP_READ_BIT);
+    }
+    else {
+        pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    }
+
+    if (pixels) PsychGetImageCopyOut(pixels, readback->floatprecision, readback->nrchannels, readback->stride, (size_t) readback->width, (size_t) readback->height);
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Readback done, the slot is free again:
+    if (readback->fence) glDeleteSync(readback->fence);
+    readback->fence = NULL;
+    readback->handle = 0;
+
+    if (!pixels) PsychErrorExitMsg(PsychError_system, "Failed to map buffer of asynchronous readback for retrieval of the image!");
+
+    return(PsychError_none);
+}
@@ -58,6 +58,17 @@ PsychError SCREENGetOpenGLTexture(void)
     if (!PsychIsTexture(textureRecord)) {
         PsychErrorExitMsg(PsychError_user, "You tried to query texture information on something else than a texture!");
     }
+
+    // Pooled textures don't have an OpenGL texture of their own:
+    PsychTexturePoolCheckUnsupported(textureRecord, "query the OpenGL texture of");
+
+    // External OpenGL code may use the texture in its own context, which can't wait on our fences,
+    // so a pending background upload must be fully completed on the gpu:
+    PsychSetGLContext(textureRecord);
+    if (!PsychTextureUploadIsReady(textureRecord)) {
+        PsychTextureUploadWait(textureRecord);
+        glFinish();
+    }
     
     // Query optional x-pos:
     PsychCopyInDoubleArg(3, FALSE, &x);
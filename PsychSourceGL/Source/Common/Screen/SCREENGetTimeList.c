@@ -25,19 +25,23 @@
 #include "Screen.h"
 
 // If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
-static char useString[] = "timeList= Screen('GetTimelist');";
+static char useString[] = "[timeList, tagList] = Screen('GetTimelist');";
 //                          
 static char synopsisString[] = 
 	"Return a vector of doubles holding times as reported by GetSecs.  When debugging is enabled for particular  "
 	"Screen subfunctions using a Screen preference setting, diagnostics may store time values in an array held by Screen."
-	" GetTimelist returns that array. The array is cleared by using the Screen 'ClearTimeList' command.";
-static char seeAlsoString[] = "ClearTimeList";
+	" GetTimelist returns that array. The array is cleared by using the Screen 'ClearTimeList' command.\n"
+	"The optional 'tagList' returns a vector of the same size, with the numeric tag of the call site which stored "
+	"the corresponding time value. Screen('MakeTexture') uses tags 1 to 4 with 'DebugMakeTexture' debugging enabled: "
+	"1 = Start of call, 2 = Before texture memory allocation, 3 = After allocation, 4 = End of call.\n"
+	"If the list was set up as a ringbuffer via Screen('ClearTimeList'), only the most recent values are returned.";
+static char seeAlsoString[] = "ClearTimeList GetTimeListStats";
 	 
 
 PsychError SCREENGetTimeList(void) 
 {
 	unsigned int	numTimeValues;
-	double			*timeValueArray;
+	double			*timeValueArray, *tagArray;
 	
 	
 	//all subfunctions should have these two lines.  
@@ -46,23 +50,83 @@ PsychError SCREENGetTimeList(void)
 	
 	//cap the numbers of inputs and outputs
 	PsychErrorExit(PsychCapNumInputArgs(0));   //The maximum number of inputs
-	PsychErrorExit(PsychCapNumOutputArgs(1));  //The maximum number of outputs
+	PsychErrorExit(PsychCapNumOutputArgs(2));  //The maximum number of outputs
 	
 	//return the array
 	numTimeValues=GetNumTimeValues();
 	PsychAllocOutDoubleMatArg(1, kPsychArgOptional, 1, numTimeValues, 1, &timeValueArray);
 	CopyTimeArray(timeValueArray,numTimeValues);
+
+	//return the optional array of tags
+	if (PsychAllocOutDoubleMatArg(2, kPsychArgOptional, 1, numTimeValues, 1, &tagArray))
+		CopyTimeArrayTags(tagArray, numTimeValues);
 	
 	return(PsychError_none);
 	
 }
 
+// If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
+static char useStatsString[] = "stats = Screen('GetTimeListStats' [, tags]);";
+//                          
+static char synopsisStatsString[] = 
+	"Return statistics about the time values stored in the time list by Screen's internal diagnostics.\n"
+	"For each time value with a given tag, the duration since the time value preceeding it in the list is computed, "
+	"ie. the time spent executing code between the call site that stored the preceeding value and the call site with "
+	"that tag. Statistics about these durations are returned in the struct array 'stats', one element per tag, for the "
+	"numeric tags listed in the optional vector 'tags'. By default, statistics for all tags in the list are returned.\n"
+	"Each struct element has the following fields, durations are in seconds:\n"
+	"'Tag' The tag. 'Count' Number of durations. 'Min' Minimum duration. 'Max' Maximum duration. 'Mean' Mean duration. "
+	"'Median' Median duration. 'P90' 90th percentile of durations. 'P99' 99th percentile of durations.\n"
+	"See Screen('GetTimeList') for the tags used by different call sites.";
+static char seeAlsoStatsString[] = "GetTimeList ClearTimeList";
+	 
 
+PsychError SCREENGetTimeListStats(void) 
+{
+	const char *FieldNames[] = { "Tag", "Count", "Min", "Max", "Mean", "Median", "P90", "P99" };
+	PsychGenericScriptType *stats;
+	unsigned int	numTimeValues, numTags, i, j;
+	int				m, n, p;
+	double			*tagList, *tags, values[TIMELIST_NUMSTATS];
 	
+	//all subfunctions should have these two lines.  
+	PsychPushHelp(useStatsString, synopsisStatsString, seeAlsoStatsString);
+	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
 	
+	//cap the numbers of inputs and outputs
+	PsychErrorExit(PsychCapNumInputArgs(1));   //The maximum number of inputs
+	PsychErrorExit(PsychCapNumOutputArgs(1));  //The maximum number of outputs
+	
+	if (PsychAllocInDoubleMatArg(1, kPsychArgOptional, &m, &n, &p, &tags)) {
+		numTags = (unsigned int) (m * n * p);
+	}
+	else {
+		// No tags given: Collect all distinct tags in the list, in order of first appearance:
+		numTimeValues = GetNumTimeValues();
+		tagList = (double*) PsychMallocTemp(maxInt(1, numTimeValues) * sizeof(double));
+		tags = (double*) PsychMallocTemp(maxInt(1, numTimeValues) * sizeof(double));
+		CopyTimeArrayTags(tagList, numTimeValues);
+
+		numTags = 0;
+		for (i = 0; i < numTimeValues; i++) {
+			for (j = 0; j < numTags; j++) if (tags[j] == tagList[i]) break;
+			if (j == numTags) tags[numTags++] = tagList[i];
+		}
+	}
+
+	PsychAllocOutStructArray(1, kPsychArgOptional, numTags, 8, FieldNames, &stats);
+	for (i = 0; i < numTags; i++) {
+		if (tags[i] < 0) PsychErrorExitMsg(PsychError_user, "Invalid tag specified. Tags must be non-negative integers.");
+		GetTimeListTagStats((unsigned int) tags[i], values);
+		PsychSetStructArrayDoubleElement("Tag", i, tags[i], stats);
+		PsychSetStructArrayDoubleElement("Count", i, values[0], stats);
+		PsychSetStructArrayDoubleElement("Min", i, values[1], stats);
+		PsychSetStructArrayDoubleElement("Max", i, values[2], stats);
+		PsychSetStructArrayDoubleElement("Mean", i, values[3], stats);
+		PsychSetStructArrayDoubleElement("Median", i, values[4], stats);
+		PsychSetStructArrayDoubleElement("P90", i, values[5], stats);
+		PsychSetStructArrayDoubleElement("P99", i, values[6], stats);
+	}
 
-
-
-
-
-
+	return(PsychError_none);
+}
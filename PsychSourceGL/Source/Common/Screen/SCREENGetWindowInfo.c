@@ -199,6 +199,8 @@ static char synopsisString[] =
     "MissedDeadlines: Number of missed Screen('Flip') stimulus onset deadlines, according to internal skip detector.\n"
     "FlipCount: Total number of flip command executions, ie., of stimulus updates.\n"
     "GuesstimatedMemoryUsageMB: Estimated memory usage of window or texture in Megabytes. Can be very inaccurate or unavailable!\n"
+    "TexturePoolPages: Number of shared textures (pages) of the texture pool for small textures of an onscreen window, see Screen('MakeTexture') specialFlags 64.\n"
+    "TexturePoolMemoryMB: Estimated memory usage of all pages of the texture pool of an onscreen window in Megabytes.\n"
     "VBLStartLine, VBLEndline: Start/Endline of vertical blanking interval. The VBLEndline value is not available/valid on all GPU's.\n"
     "SwapGroup: Swap group id of the swap group to which this window is assigned. Zero for none.\n"
     "SwapBarrier: Swap barrier id of the swap barrier to which this windows swap group is assigned. Zero for none.\n"
@@ -229,8 +231,9 @@ PsychError SCREENGetWindowInfo(void)
                                 "VBLTimePostFlip", "OSSwapTimestamp", "GPULastFrameRenderTime", "StereoMode", "ImagingMode", "MultiSampling", "MissedDeadlines", "FlipCount", "StereoDrawBuffer",
                                 "GuesstimatedMemoryUsageMB", "VBLStartline", "VBLEndline", "VideoRefreshFromBeamposition", "GLVendor", "GLRenderer", "GLVersion", "GPUCoreId", "GPUMinorType",
                                 "DisplayCoreId", "GLSupportsFBOUpToBpc", "GLSupportsBlendingUpToBpc", "GLSupportsTexturesUpToBpc", "GLSupportsFilteringUpToBpc", "GLSupportsPrecisionColors",
-                                "GLSupportsFP32Shading", "BitsPerColorComponent", "IsFullscreen", "SpecialFlags", "SwapGroup", "SwapBarrier" };
-    const int fieldCount = 37;
+                                "GLSupportsFP32Shading", "BitsPerColorComponent", "IsFullscreen", "SpecialFlags", "SwapGroup", "SwapBarrier",
+                                "TexturePoolPages", "TexturePoolMemoryMB" };
+    const int fieldCount = 39;
     PsychGenericScriptType *s;
 
     PsychWindowRecordType *windowRecord;
@@ -243,6 +246,8 @@ PsychError SCREENGetWindowInfo(void)
     int queryState;
     unsigned int gpuTimeElapsed;
     int gpuMaintype, gpuMinorType;
+    int poolPages = 0;
+    double poolBytes = 0;
 
     //all subfunctions should have these two lines.  
     PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -503,6 +508,11 @@ PsychError SCREENGetWindowInfo(void)
         PsychSetStructArrayDoubleElement("FlipCount", 0, windowRecord->flipCount, s);
         PsychSetStructArrayDoubleElement("StereoDrawBuffer", 0, windowRecord->stereodrawbuffer, s);
         PsychSetStructArrayDoubleElement("GuesstimatedMemoryUsageMB", 0, (double) windowRecord->surfaceSizeBytes / 1024 / 1024, s);
+
+        // Usage of texture pool for small textures:
+        if (onscreen) PsychTexturePoolGetStats(windowRecord, &poolPages, &poolBytes);
+        PsychSetStructArrayDoubleElement("TexturePoolPages", 0, (double) poolPages, s);
+        PsychSetStructArrayDoubleElement("TexturePoolMemoryMB", 0, poolBytes / 1024 / 1024, s);
         PsychSetStructArrayDoubleElement("BitsPerColorComponent", 0, (double) windowRecord->bpc, s);
 
         // Return VBL startline:
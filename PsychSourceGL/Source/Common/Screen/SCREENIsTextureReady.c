@@ -0,0 +1,69 @@
+/*
+    SCREENIsTextureReady.c
+
+    PLATFORMS:
+
+        All.
+
+    DESCRIPTION:
+
+        Check for completion of background uploads of textures created via Screen('MakeTexture')
+        with specialFlags 128. See PsychTextureUpload.c for the implementation.
+*/
+
+#include "Screen.h"
+
+// If you change useString then also change the corresponding synopsis string in ScreenSynopsis.c
+static char useString[] = "ready = Screen('IsTextureReady', textureIndices [, waitForReady=0]);";
+//                                                          1                 2
+static char synopsisString[] =
+    "Check if textures are ready for use without waiting for their upload.\n"
+    "'textureIndices' is a vector of one or more texture handles. Returns a vector 'ready' of the same length, "
+    "with 1 for each texture which is ready, and 0 for each texture whose asynchronous upload, requested via "
+    "'specialFlags' 128 in Screen('MakeTexture'), is still in progress. Textures created without asynchronous "
+    "upload are always ready. Using a texture which is not ready, e.g., via Screen('DrawTexture'), is fine, "
+    "but it will wait for completion of the upload first. If the optional flag 'waitForReady' is set to 1, "
+    "waits until all textures are ready and returns all ones.";
+static char seeAlsoString[] = "MakeTexture DrawTexture PreloadTextures";
+
+PsychError SCREENIsTextureReady(void)
+{
+    PsychWindowRecordType *textureRecord;
+    int *textureIndices;
+    int i, n, waitForReady;
+    double *ready;
+
+    // All subfunctions should have these two lines:
+    PsychPushHelp(useString, synopsisString, seeAlsoString);
+    if (PsychIsGiveHelp()) { PsychGiveHelp(); return(PsychError_none); };
+
+    PsychErrorExit(PsychCapNumInputArgs(2));
+    PsychErrorExit(PsychRequireNumInputArgs(1));
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+
+    PsychAllocInIntegerListArg(1, kPsychArgRequired, &n, &textureIndices);
+    if (n < 1) PsychErrorExitMsg(PsychError_user, "Empty 'textureIndices' vector provided. Need at least one texture handle.");
+
+    waitForReady = 0;
+    PsychCopyInIntegerArg(2, kPsychArgOptional, &waitForReady);
+    if (waitForReady < 0 || waitForReady > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'waitForReady' flag provided. Must be 0 or 1.");
+
+    PsychAllocOutDoubleMatArg(1, kPsychArgOptional, 1, n, 1, &ready);
+
+    for (i = 0; i < n; i++) {
+        textureRecord = NULL;
+        if (IsWindowIndex(textureIndices[i])) FindWindowRecord(textureIndices[i], &textureRecord);
+        if ((NULL == textureRecord) || !PsychIsTexture(textureRecord)) {
+            printf("PTB-ERROR: Entry %i of 'textureIndices' vector (handle %i) is not a texture handle!\n", i + 1, textureIndices[i]);
+            PsychErrorExitMsg(PsychError_user, "Invalid texture handle provided in 'textureIndices'.");
+        }
+
+        // Fences can only be queried with the OpenGL context of the texture bound:
+        if (textureRecord->textureUploadJob) PsychSetGLContext(textureRecord);
+
+        if (waitForReady) PsychTextureUploadWait(textureRecord);
+        ready[i] = (PsychTextureUploadIsReady(textureRecord)) ? 1 : 0;
+    }
+
+    return(PsychError_none);
+}
@@ -66,6 +66,20 @@ static char synopsisString[] =
     "A 'specialFlags' == 8 will prevent automatic mipmap-generation for GL_TEXTURE_2D textures.\n"
     "A 'specialFlags' == 32 setting will prevent automatic closing of the texture if Screen('Close'); is called. Only "
     "Screen('Close', textureIndex); would close the texture.\n"
+    "A 'specialFlags' == 64 setting asks to store the texture in the texture pool for small textures, if possible: Instead of "
+    "a texture of its own, it gets a slot in a large shared texture, together with other small textures of the same format. "
+    "Screen('DrawTextures') and deferred drawing mode can then draw many different pooled textures in one batch, which can "
+    "be much faster and saves memory if you use many small textures, e.g., thousands of different small image patches. "
+    "Only 8 bit integer textures of at most 256 x 256 pixels without 'textureShader' and without specialFlags 1 or 2 are "
+    "pooled, and only with rectangle textures on desktop OpenGL. Other textures are created as usual. Pooled textures can't "
+    "be drawn into, transformed via Screen('TransformTexture'), or accessed via Screen('GetOpenGLTexture'). Texture "
+    "coordinates outside the texture, e.g., when rotating via the texture matrix, sample neighbouring pooled textures.\n"
+    "A 'specialFlags' == 128 setting asks to upload the texture asynchronously, if possible: Conversion of 'imageMatrix' "
+    "still happens during the call, but the upload to the graphics card is done by a background thread with its own "
+    "OpenGL context, so 'MakeTexture' returns faster, e.g., to create many large textures while animating. The first use "
+    "of the texture, e.g., by Screen('DrawTexture'), waits for completion of its upload. Screen('IsTextureReady') allows "
+    "to check for completion without waiting. Only 8 bit integer textures on desktop OpenGL are uploaded asynchronously, "
+    "other textures are created as usual. Pooled textures of specialFlags 64 are never uploaded asynchronously.\n"
 	"'floatprecision' defines the precision with which the texture should be stored and processed. Default value is zero, "
 	"which asks to store textures with 8 bit per color component precision, a suitable format for standard images read via "
 	"imread(). A non-zero value will store the textures color component values as floating point precision numbers, useful "
@@ -96,6 +110,22 @@ static char synopsisString[] =
 	"real data matrix associated with it -- all content is generated on the fly.\n";
 
 static char seeAlsoString[] = "DrawTexture TransformTexture BlendFunction";
+
+// Order of color planes in 8 bpc RGBA textures: ARGB on big-endian machines like PowerPC, BGRA on
+// little-endian machines like Intel Pentium:
+static const int texelOrderBigEndian[4] = { 3, 0, 1, 2 };
+static const int texelOrderLittleEndian[4] = { 2, 1, 0, 3 };
+
+// Setup pointers to the 'numMatrixPlanes' color planes of 'planeBytes' bytes each of a column-major
+// image matrix. 4 layer images are reordered by 'order', unless it is NULL:
+static void PsychGetTexelPlanes(const void** planes, const void* matrix, int numMatrixPlanes, size_t planeBytes, const int* order)
+{
+    int i;
+
+    for (i = 0; i < numMatrixPlanes; i++) {
+        planes[i] = (const void*) ((const char*) matrix + (size_t) (((numMatrixPlanes == 4) && order) ? order[i] : i) * planeBytes);
+    }
+}
 	 
 PsychError SCREENMakeTexture(void) 
 {
@@ -110,8 +140,9 @@ PsychError SCREENMakeTexture(void)
     GLuint								*texturePointer;
     GLubyte								*texturePointer_b;
     GLfloat								*texturePointer_f;
-    double								*rp, *gp, *bp, *ap;
-    GLubyte								*rpb, *gpb, *bpb, *apb;
+    const double*						dplanes[4];
+    const GLubyte*						bplanes[4];
+    psych_bool							flushTiny;
     int									usepoweroftwo, usefloatformat, assume_texorientation, textureShader;
     double                              optimized_orientation;
     psych_bool							bigendian;
@@ -120,12 +151,12 @@ PsychError SCREENMakeTexture(void)
 
     // Detect endianity (byte-order) of machine:
     ix=255;
-    rpb=(GLubyte*) &ix;
-    bigendian = ( *rpb == 255 ) ? FALSE : TRUE;
-    ix = 0; rpb = NULL;
+    texturePointer_b=(GLubyte*) &ix;
+    bigendian = ( *texturePointer_b == 255 ) ? FALSE : TRUE;
+    ix = 0; texturePointer_b = NULL;
 
     if(PsychPrefStateGet_DebugMakeTexture())	//MARK #1
-        StoreNowTime();
+        StoreNowTimeTagged(1);
     
     //all subfunctions should have these two lines.  
     PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -285,9 +316,9 @@ PsychError SCREENMakeTexture(void)
 	}
 	else {
 		// Allocate memory:
-		if(PsychPrefStateGet_DebugMakeTexture()) StoreNowTime();
+		if(PsychPrefStateGet_DebugMakeTexture()) StoreNowTimeTagged(2);
 		textureRecord->textureMemory = malloc(textureRecord->textureMemorySizeBytes);
-		if(PsychPrefStateGet_DebugMakeTexture()) StoreNowTime();
+		if(PsychPrefStateGet_DebugMakeTexture()) StoreNowTimeTagged(3);
 		texturePointer = textureRecord->textureMemory;
 	}
 	
@@ -297,8 +328,16 @@ PsychError SCREENMakeTexture(void)
       textureRecord->texturetarget=GL_TEXTURE_2D;
     }
 
+	// This is a special workaround for bugs in FLOAT16 texture creation on Mac OS/X 10.4.x and 10.5.x.
+	// The OpenGL fails to properly flush very small values (< 1e-9) to zero when creating a FLOAT16
+	// type texture. Instead it seems to initialize with trash data, corrupting the texture.
+	// Therefore, if FLOAT16 texture creation is requested, the conversion sets all values with
+	// magnitude smaller than 1e-9 to zero. Better safe than sorry...
+	flushTiny = ((usefloatformat==1) && (windowRecord->gfxcaps & kPsychGfxCapFPTex16)) ? TRUE : FALSE;
+
 	// Now the conversion routines that convert Matlab/Octave matrices into memory
-	// buffers suitable for OpenGL:
+	// buffers suitable for OpenGL. They use SIMD instructions and worker threads for
+	// big images, see PsychTextureConversion.c:
 	if (planar_storage) {
 		// Planar texture storage, backed by a LUMINANCE texture container:
 
@@ -309,7 +348,7 @@ PsychError SCREENMakeTexture(void)
 			// Set size to zero, so PsychCreateTexture() does not free() our
 			// input buffer:
 			textureRecord->textureMemorySizeBytes = 0;
-			
+
 			// This is always a LUMINANCE8 texture, backing our planar uint8 texture:
 			textureRecord->depth = 8 * numMatrixPlanes;
 			textureRecord->textureexternaltype   = GL_UNSIGNED_BYTE;
@@ -322,22 +361,21 @@ PsychError SCREENMakeTexture(void)
 			// normalization and/or checking of value range.
 			textureRecord->textureexternalformat = GL_LUMINANCE;
 
+			// All planes are converted in one go, as if they were one plane:
+			iters = (size_t) xSize * (size_t) ySize;
+			dplanes[0] = doubleMatrix;
+
 			if (usefloatformat) {
 				// Floating point or other high precision format:
 				textureRecord->depth = ((usefloatformat == 1) ? 16 : 32) * numMatrixPlanes;
 				textureRecord->textureexternaltype = GL_FLOAT;
 				textureRecord->textureinternalformat = (usefloatformat == 1) ? GL_LUMINANCE_FLOAT16_APPLE : GL_LUMINANCE_FLOAT32_APPLE;
-				
+
 				// Override for missing floating point texture support: Try to use 16 bit fixed point signed normalized textures [-1.0 ; 1.0] resolved at 15 bits:
 				if ((usefloatformat == 1) && !(windowRecord->gfxcaps & kPsychGfxCapFPTex16)) textureRecord->textureinternalformat = GL_LUMINANCE16_SNORM;
 
 				// Perform copy with double -> float cast:
-				iters = (size_t) xSize * (size_t) ySize * (size_t) numMatrixPlanes;
-				texturePointer_f = (GLfloat*) texturePointer;
-				for(ix = 0; ix < iters; ix++) {
-					*(texturePointer_f++) = (GLfloat) *(doubleMatrix++);
-				}
-				iters = (size_t) xSize * (size_t) ySize;
+				PsychConvertTexelsToFloat((GLfloat*) texturePointer, dplanes, 1, iters * (size_t) numMatrixPlanes, flushTiny);
 			}
 			else {
 				// 8 Bit format, but from double input matrix -> cast to uint8:
@@ -345,12 +383,7 @@ PsychError SCREENMakeTexture(void)
 				textureRecord->textureexternaltype = GL_UNSIGNED_BYTE;
 				textureRecord->textureinternalformat = GL_LUMINANCE8;
 
-				iters = (size_t) xSize * (size_t) ySize * (size_t) numMatrixPlanes;
-				texturePointer_b = (GLubyte*) texturePointer;
-				for(ix = 0; ix < iters; ix++) {
-					*(texturePointer_b++) = (GLubyte) (scaled * *(doubleMatrix++));
-				}
-				iters = (size_t) xSize * (size_t) ySize;
+				PsychConvertTexelsToUByte((GLubyte*) texturePointer, dplanes, 1, iters * (size_t) numMatrixPlanes, scaled);
 			}
 		}
 	}
@@ -361,15 +394,14 @@ PsychError SCREENMakeTexture(void)
 
 		// Our input buffer is always of GL_FLOAT precision:
 		textureRecord->textureexternaltype = GL_FLOAT;
-		texturePointer_f=(GLfloat*) texturePointer;
-		
-		if(numMatrixPlanes==1) {
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_f++)= (GLfloat) *(doubleMatrix++);  
-			}
-			textureRecord->depth=(usefloatformat==1) ? 16 : 32;
 
-			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_LUMINANCE_FLOAT16_APPLE : GL_LUMINANCE_FLOAT32_APPLE; 
+		// Interleave the planes into RGBA order with double -> float cast:
+		PsychGetTexelPlanes((const void**) dplanes, doubleMatrix, numMatrixPlanes, iters * sizeof(double), NULL);
+		PsychConvertTexelsToFloat((GLfloat*) texturePointer, dplanes, numMatrixPlanes, iters, flushTiny);
+		textureRecord->depth = ((usefloatformat==1) ? 16 : 32) * numMatrixPlanes;
+
+		if(numMatrixPlanes==1) {
+			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_LUMINANCE_FLOAT16_APPLE : GL_LUMINANCE_FLOAT32_APPLE;
 			textureRecord->textureexternalformat = GL_LUMINANCE;
 
 			// Override for missing floating point texture support: Try to use 16 bit fixed point signed normalized textures [-1.0 ; 1.0] resolved at 15 bits:
@@ -377,86 +409,47 @@ PsychError SCREENMakeTexture(void)
 		}
 
 		if(numMatrixPlanes==2) {
-			rp=(double*) ((size_t) doubleMatrix);
-			ap=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_f++)= (GLfloat) *(rp++);  
-				*(texturePointer_f++)= (GLfloat) *(ap++);  
-			}
-			textureRecord->depth=(usefloatformat==1) ? 32 : 64;
-			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_LUMINANCE_ALPHA_FLOAT16_APPLE : GL_LUMINANCE_ALPHA_FLOAT32_APPLE; 
+			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_LUMINANCE_ALPHA_FLOAT16_APPLE : GL_LUMINANCE_ALPHA_FLOAT32_APPLE;
 			textureRecord->textureexternalformat = GL_LUMINANCE_ALPHA;
 
 			// Override for missing floating point texture support: Try to use 16 bit fixed point signed normalized textures [-1.0 ; 1.0] resolved at 15 bits:
 			if ((usefloatformat==1) && !(windowRecord->gfxcaps & kPsychGfxCapFPTex16)) textureRecord->textureinternalformat = GL_LUMINANCE16_ALPHA16_SNORM;
 		}
-		
+
 		if(numMatrixPlanes==3) {
-			rp=(double*) ((size_t) doubleMatrix);
-			gp=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-			bp=(double*) ((size_t) gp + (size_t) iters * sizeof(double));
-
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_f++)= (GLfloat) *(rp++);  
-				*(texturePointer_f++)= (GLfloat) *(gp++);  
-				*(texturePointer_f++)= (GLfloat) *(bp++);  
-			}
-			textureRecord->depth=(usefloatformat==1) ? 48 : 96;
-			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_RGB_FLOAT16_APPLE : GL_RGB_FLOAT32_APPLE; 
+			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_RGB_FLOAT16_APPLE : GL_RGB_FLOAT32_APPLE;
 			textureRecord->textureexternalformat = GL_RGB;
 
 			// Override for missing floating point texture support: Try to use 16 bit fixed point signed normalized textures [-1.0 ; 1.0] resolved at 15 bits:
 			if ((usefloatformat==1) && !(windowRecord->gfxcaps & kPsychGfxCapFPTex16)) textureRecord->textureinternalformat = GL_RGB16_SNORM;
 		}
-		
+
 		if(numMatrixPlanes==4) {
-			rp=(double*) ((size_t) doubleMatrix);
-			gp=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-			bp=(double*) ((size_t) gp + (size_t) iters * sizeof(double));
-			ap=(double*) ((size_t) bp + (size_t) iters * sizeof(double));
-
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_f++)= (GLfloat) *(rp++);  
-				*(texturePointer_f++)= (GLfloat) *(gp++);  
-				*(texturePointer_f++)= (GLfloat) *(bp++);  
-				*(texturePointer_f++)= (GLfloat) *(ap++);  
-			}			
-			textureRecord->depth=(usefloatformat==1) ? 64 : 128;
-			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_RGBA_FLOAT16_APPLE : GL_RGBA_FLOAT32_APPLE; 
+			textureRecord->textureinternalformat = (usefloatformat==1) ? GL_RGBA_FLOAT16_APPLE : GL_RGBA_FLOAT32_APPLE;
 			textureRecord->textureexternalformat = GL_RGBA;
 
 			// Override for missing floating point texture support: Try to use 16 bit fixed point signed normalized textures [-1.0 ; 1.0] resolved at 15 bits:
 			if ((usefloatformat==1) && !(windowRecord->gfxcaps & kPsychGfxCapFPTex16)) textureRecord->textureinternalformat = GL_RGBA16_SNORM;
-		}		
+		}
 		// End of HDR conversion code...
 	}
     else {
 		// Standard LDR texture 8 bpc conversion routines -- Fast path.
 		iters = (size_t) xSize * (size_t) ySize;
+		textureRecord->depth = 8 * numMatrixPlanes;
 
-		// Improved implementation: Takes 13 ms on a 800x800 texture...
-		if(isImageMatrixDoubles && numMatrixPlanes==1){
-			texturePointer_b=(GLubyte*) texturePointer;
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_b++)= (GLubyte) (scaled * *(doubleMatrix++));
-			}
-			textureRecord->depth=8;
+		if (isImageMatrixDoubles) {
+			// Double input -> Scaled cast to uint8, interleaved into texel order:
+			PsychGetTexelPlanes((const void**) dplanes, doubleMatrix, numMatrixPlanes, iters * sizeof(double), (bigendian) ? texelOrderBigEndian : texelOrderLittleEndian);
+			PsychConvertTexelsToUByte((GLubyte*) texturePointer, dplanes, numMatrixPlanes, iters, scaled);
 		}
-		
-		// Improved version: Takes 3 ms on a 800x800 texture...
-		// NB: Implementing memcpy manually by a for-loop takes 10 ms! This is a huge difference.
-		// -> That's because memcpy on MacOS-X is implemented with hand-coded, highly tuned Assembler code for PowerPC.
-		// -> It's always wise to use system-routines if available, instead of coding it by yourself!
-		if(isImageMatrixBytes && numMatrixPlanes==1) {
+		else if (numMatrixPlanes == 1) {
+			// NB: Implementing memcpy manually by a for-loop takes 10 ms! This is a huge difference.
+			// -> That's because memcpy on MacOS-X is implemented with hand-coded, highly tuned Assembler code for PowerPC.
+			// -> It's always wise to use system-routines if available, instead of coding it by yourself!
 			if (texturePointer) {
 				// Need to do a copy. Use optimized memcpy():
 				memcpy((void*) texturePointer, (void*) byteMatrix, iters);
-				
-				//texturePointer_b=(GLubyte*) texturePointer;
-				//for(ix=0;ix<iters;ix++){
-				//	*(texturePointer_b++) = *(byteMatrix++);  
-				//}
 			}
 			else {
 				// Zero-Copy path. Just pass a pointer to our input matrix:
@@ -466,121 +459,14 @@ PsychError SCREENMakeTexture(void)
 				// input buffer:
 				textureRecord->textureMemorySizeBytes = 0;
 			}
-
-			textureRecord->depth=8;
-		}
-		
-		// New version: Takes 33 ms on a 800x800 texture...
-		if(isImageMatrixDoubles && numMatrixPlanes==2){
-			texturePointer_b=(GLubyte*) texturePointer;
-			rp=(double*) ((size_t) doubleMatrix);
-			ap=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_b++)= (GLubyte) (scaled * *(rp++));
-				*(texturePointer_b++)= (GLubyte) (scaled * *(ap++));
-			}
-			textureRecord->depth=16;
-		}
-		
-		// New version: Takes 20 ms on a 800x800 texture...
-		if(isImageMatrixBytes && numMatrixPlanes==2){
-			texturePointer_b=(GLubyte*) texturePointer;
-			rpb=(GLubyte*) ((size_t) byteMatrix);
-			apb=(GLubyte*) ((size_t) rpb + (size_t) iters);
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_b++)= *(rpb++);  
-				*(texturePointer_b++)= *(apb++);  
-			}
-			textureRecord->depth=16;
-		}
-		
-		// Improved version: Takes 43 ms on a 800x800 texture...
-		if(isImageMatrixDoubles && numMatrixPlanes==3){
-			texturePointer_b=(GLubyte*) texturePointer;
-			rp=(double*) ((size_t) doubleMatrix);
-			gp=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-			bp=(double*) ((size_t) gp + (size_t) iters * sizeof(double));
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_b++)= (GLubyte) (scaled * *(rp++));
-				*(texturePointer_b++)= (GLubyte) (scaled * *(gp++));
-				*(texturePointer_b++)= (GLubyte) (scaled * *(bp++));
-			}
-			textureRecord->depth=24;
 		}
-		
-		// Improved version: Takes 25 ms on a 800x800 texture...
-		if(isImageMatrixBytes && numMatrixPlanes==3){
-			texturePointer_b=(GLubyte*) texturePointer;			
-			rpb=(GLubyte*) ((size_t) byteMatrix);
-			gpb=(GLubyte*) ((size_t) rpb + (size_t) iters);
-			bpb=(GLubyte*) ((size_t) gpb + (size_t) iters);
-			for(ix=0;ix<iters;ix++){
-				*(texturePointer_b++)= *(rpb++);  
-				*(texturePointer_b++)= *(gpb++);  
-				*(texturePointer_b++)= *(bpb++);  
-			}
-			textureRecord->depth=24;
-		}
-		
-		// Improved version: Takes 55 ms on a 800x800 texture...
-		if(isImageMatrixDoubles && numMatrixPlanes==4){
-			texturePointer_b=(GLubyte*) texturePointer;			
-			rp=(double*) ((size_t) doubleMatrix);
-			gp=(double*) ((size_t) rp + (size_t) iters * sizeof(double));
-			bp=(double*) ((size_t) gp + (size_t) iters * sizeof(double));
-			ap=(double*) ((size_t) bp + (size_t) iters * sizeof(double));
-			if (bigendian) {
-				// Code for big-endian machines like PowerPC:
-				for(ix=0;ix<iters;ix++){
-					*(texturePointer_b++)= (GLubyte) (scaled * *(ap++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(rp++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(gp++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(bp++));
-				}
-			}
-			else {
-				// Code for little-endian machines like Intel Pentium:
-				for(ix=0;ix<iters;ix++){
-					*(texturePointer_b++)= (GLubyte) (scaled * *(bp++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(gp++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(rp++));
-					*(texturePointer_b++)= (GLubyte) (scaled * *(ap++));
-				}
-			}
-			
-			textureRecord->depth=32;
-		}
-		
-		// Improved version: Takes 33 ms on a 800x800 texture...
-		if(isImageMatrixBytes && numMatrixPlanes==4){
-			texturePointer_b=(GLubyte*) texturePointer;			
-			rpb=(GLubyte*) ((size_t) byteMatrix);
-			gpb=(GLubyte*) ((size_t) rpb + (size_t) iters);
-			bpb=(GLubyte*) ((size_t) gpb + (size_t) iters);
-			apb=(GLubyte*) ((size_t) bpb + (size_t) iters);
-			if (bigendian) {
-				// Code for big-endian machines like PowerPC:
-				for(ix=0;ix<iters;ix++){
-					*(texturePointer_b++)= *(apb++);  
-					*(texturePointer_b++)= *(rpb++);  
-					*(texturePointer_b++)= *(gpb++);  
-					*(texturePointer_b++)= *(bpb++);  
-				}
-			}
-			else {
-				// Code for little-endian machines like Intel Pentium:
-				for(ix=0;ix<iters;ix++){
-					*(texturePointer_b++)= *(bpb++);  
-					*(texturePointer_b++)= *(gpb++);  
-					*(texturePointer_b++)= *(rpb++);  
-					*(texturePointer_b++)= *(apb++);  
-				}
-			}
-			
-			textureRecord->depth=32;
+		else {
+			// uint8 input -> Interleave planes into texel order:
+			PsychGetTexelPlanes((const void**) bplanes, byteMatrix, numMatrixPlanes, iters, (bigendian) ? texelOrderBigEndian : texelOrderLittleEndian);
+			PsychInterleaveTexels((GLubyte*) texturePointer, bplanes, numMatrixPlanes, iters);
 		}
 	} // End of 8 bpc texture conversion code (fast-path for LDR textures)
-    
+
 	// Override for missing floating point texture support?
 	if ((usefloatformat==1) && !(windowRecord->gfxcaps & kPsychGfxCapFPTex16)) {
 		// Override enabled. Instead of a 16bpc float texture with 11 bit linear precision in the
@@ -591,14 +477,14 @@ PsychError SCREENMakeTexture(void)
 		// replacement at high verbosity levels:
 		if (PsychPrefStateGet_Verbosity() > 4)
 			printf("PTB-INFO:MakeTexture: Code requested 16 bpc float texture, but this is unsupported. Trying to use 16 bit snorm texture instead.\n");
-		
+
 		// Signed normalized textures supported? Otherwise we bail...
 		if (!(windowRecord->gfxcaps & kPsychGfxCapSNTex16)) {
 			printf("PTB-ERROR:MakeTexture: Code requested 16 bpc floating point texture, but this is unsupported by this graphics card.\n");
 			printf("PTB-ERROR:MakeTexture: Tried to use 16 bit snorm texture instead, but failed as this is unsupported as well.\n");
 			PsychErrorExitMsg(PsychError_user, "Creation of 15 bit linear precision signed normalized texture failed. Not supported by your graphics hardware!");
 		}
-		
+
 		// Check value range of pixels. This will not work for out of [-1; 1] range values.
 		texturePointer_f=(GLfloat*) texturePointer;
 		iters = iters * (size_t) numMatrixPlanes;
@@ -613,17 +499,6 @@ PsychError SCREENMakeTexture(void)
 		}
 	}
 
-	// This is a special workaround for bugs in FLOAT16 texture creation on Mac OS/X 10.4.x and 10.5.x.
-	// The OpenGL fails to properly flush very small values (< 1e-9) to zero when creating a FLOAT16
-	// type texture. Instead it seems to initialize with trash data, corrupting the texture.
-	// Therefore, if FLOAT16 texture creation is requested, we loop over the whole input buffer and
-	// set all values with magnitude smaller than 1e-9 to zero. Better safe than sorry...
-	if ((usefloatformat==1) && (windowRecord->gfxcaps & kPsychGfxCapFPTex16)) {
-		texturePointer_f=(GLfloat*) texturePointer;
-		iters = iters * (size_t) numMatrixPlanes;
-		for(ix=0; ix<iters; ix++, texturePointer_f++) if(fabs((double) *texturePointer_f) < 1e-9) { *texturePointer_f = 0.0; }
-	}
-
     // On OpenGL-ES, 32 bpc floating point textures are selected via the GL_FLOAT type specifier, and
     // internal format must be == external format == not defining resolution. External format is already
     // properly set by common desktop/es HDR setup code, as is type spec, so we just need to make sure that
@@ -667,8 +542,15 @@ PsychError SCREENMakeTexture(void)
 		textureRecord->specialflags = kPsychPlanarTexture;
 	}
 	else {
-		// Let's create and bind a new texture object and fill it with our new texture data.
-		PsychCreateTexture(textureRecord);
+		// Store small textures in the texture pool if requested via specialFlags 64 and possible. Otherwise
+		// upload on the background upload thread if requested via specialFlags 128 and possible. Otherwise
+		// create and bind a new texture object and fill it with our new texture data:
+		if (!(usepoweroftwo & 64) || (usepoweroftwo & (1 | 2)) || usefloatformat || (textureShader != 0) || (assume_texorientation == 1) ||
+			!PsychTexturePoolCreateTexture(textureRecord)) {
+			if (!(usepoweroftwo & 128) || usefloatformat || (assume_texorientation == 1) || !PsychTextureUploadCreateTexture(textureRecord)) {
+				PsychCreateTexture(textureRecord);
+			}
+		}
 		
 		// Assign GLSL filter-/lookup-shaders if needed:
 		PsychAssignHighPrecisionTextureShaders(textureRecord, windowRecord, usefloatformat, (usepoweroftwo & 2) ? 1 : 0);
@@ -711,7 +593,7 @@ PsychError SCREENMakeTexture(void)
     if (usepoweroftwo & 32) textureRecord->specialflags |= kPsychDontDeleteOnClose;    
 
     if(PsychPrefStateGet_DebugMakeTexture()) 	//MARK #4
-        StoreNowTime();
+        StoreNowTimeTagged(4);
     
     return(PsychError_none);
 }
@@ -104,6 +104,8 @@ PsychError SCREENPreloadTextures(void)
             for(i=0; i<numWindows; i++) {                
                 if (windowRecordArray[i]->windowType==kPsychTexture) {
                     n++;
+                    // Wait for completion of a pending background upload:
+                    PsychTextureUploadWait(windowRecordArray[i]);
                     // Prioritize this texture:
                     glPrioritizeTextures(1, (GLuint*) &(windowRecordArray[i]->textureNumber), &maxprio);
                     // Bind this texture:
@@ -139,6 +141,8 @@ PsychError SCREENPreloadTextures(void)
                 texwin = NULL;
                 if (IsWindowIndex(myhandle)) FindWindowRecord(myhandle, &texwin);
                 if (texwin && texwin->windowType==kPsychTexture) {
+                    // Wait for completion of a pending background upload:
+                    PsychTextureUploadWait(texwin);
                     // Prioritize this texture:
                     glPrioritizeTextures(1, (GLuint*) &(texwin->textureNumber), &maxprio);
                     // Bind this texture:
@@ -86,6 +86,9 @@ PsychError SCREENSelectStereoDrawBuffer(void)
 		bufferid = 0;
 	}
 	
+	// Pending commands of deferred drawing mode must be executed into the old eye buffer:
+	PsychFlushDeferredDrawing();
+
 	// Store assignment in windowRecord:
 	windowRecord->stereodrawbuffer = bufferid;
 	
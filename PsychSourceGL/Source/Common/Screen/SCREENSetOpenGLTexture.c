@@ -95,6 +95,9 @@ PsychError SCREENSetOpenGLTexture(void)
     if (!PsychIsTexture(textureRecord)) {
         PsychErrorExitMsg(PsychError_user, "You tried to set texture information on something else than a texture!");
     }
+
+    // Pooled textures share their OpenGL texture with other textures, so it can't be replaced:
+    PsychTexturePoolCheckUnsupported(textureRecord, "replace the OpenGL texture of");
     
     // Query OpenGL texid:
     PsychCopyInIntegerArg(3, TRUE, &texid);
@@ -120,6 +123,9 @@ PsychError SCREENSetOpenGLTexture(void)
     
     // Activate OpenGL rendering context of windowRecord:
     PsychSetGLContext(windowRecord);
+
+    // Upload thread must be done with a pending background upload into the old texture of textureRecord:
+    PsychTextureUploadCancel(textureRecord);
     
     // Bind the provided external OpenGL texture object:
     PsychTestForGLErrors();
@@ -70,7 +70,11 @@
 #include "PsychWindowSupport.h"
 #include "PsychMovieSupport.h"
 #include "PsychTextureSupport.h"
+#include "PsychTexturePool.h"
+#include "PsychTextureUpload.h"
+#include "PsychTextureConversion.h"
 #include "PsychAlphaBlending.h"
+#include "PsychDeferredDrawing.h"
 #include "PsychVideoCaptureSupport.h"
 #include "PsychImagingPipelineSupport.h"
 #include "PsychMovieWritingSupport.h"
@@ -105,8 +109,13 @@ char		*PsychGetGLErrorNameString(GLenum errorConstant);
 #define		PsychTestForGLErrors()		PsychTestForGLErrorsC(__LINE__, __func__, __FILE__) 
 void		PsychTestForGLErrorsC(int lineNum, const char *funcName, const char *fileName);
 GLdouble	*PsychExtractQuadVertexFromRect(double *rect, int vertexNumber, GLdouble *vertex);
-void		PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos, int* coords_count, double** xy, int colors_pos, int* colors_count, int* colorcomponent_count, double** colors, unsigned char** bytecolors, int sizes_pos, int* sizes_count, double** size, psych_bool usefloat);
+void		PsychPrepareRenderBatch(PsychWindowRecordType *windowRecord, int coords_pos, int* coords_count, double** xy, int colors_pos, int* colors_count, int* colorcomponent_count, double** colors, unsigned char** bytecolors, int sizes_pos, int* sizes_count, double** size, psych_bool usefloat, GLenum* xytype, GLenum* sizetype);
 void		PsychWaitPixelSyncToken(PsychWindowRecordType *windowRecord, psych_bool flushOnly);
+size_t		PsychGLTypeSize(GLenum type);
+psych_bool	PsychVertexStreamBegin(PsychWindowRecordType *windowRecord, size_t nbytes);
+const GLvoid*	PsychVertexStreamPush(PsychWindowRecordType *windowRecord, const void* data, size_t nbytes);
+void		PsychVertexStreamEnd(PsychWindowRecordType *windowRecord);
+void		PsychVertexStreamDestroy(PsychWindowRecordType *windowRecord);
 psych_bool	PsychIsGLClassic(PsychWindowRecordType *windowRecord);
 GLenum		PsychGLFloatType(PsychWindowRecordType *windowRecord);
 #define PSYCHGLFLOAT PsychGLFloatType(windowRecord)
@@ -159,6 +168,7 @@ PsychError 	SCREENCopyWindow(void);
 PsychError 	SCREENFlip(void);					
 PsychError 	SCREENFillRect(void);					
 PsychError	SCREENGetImage(void);					
+PsychError	SCREENGetImageAsyncEnd(void);
 PsychError 	SCREENPutImage(void);					
 PsychError 	SCREENHideCursorHelper(void);					
 PsychError 	SCREENShowCursorHelper(void);					
@@ -194,12 +204,14 @@ PsychError      SCREENGlobalRect(void);
 PsychError	SCREENDrawDots(void); 
 PsychError	SCREENGetTimeList(void);
 PsychError	SCREENClearTimeList(void);
+PsychError	SCREENGetTimeListStats(void);	// In SCREENGetTimeList.c
 PsychError	SCREENBlendFunction(void);
 PsychError      SCREENWindowSize(void); 
 PsychError	SCREENTextBackgroundColor(void); 
 PsychError      SCREENLineStipple(void);
 PsychError      SCREENSelectStereoDrawBuffer(void); 
 PsychError      SCREENDrawingFinished(void); 
+PsychError      SCREENDeferredDrawing(void);
 PsychError      SCREENDrawLines(void);
 PsychError      SCREENGetFlipInterval(void);
 PsychError      SCREENCloseMovie(void);
@@ -215,6 +227,7 @@ PsychError      SCREENglTranslate(void);
 PsychError      SCREENglScale(void);
 PsychError      SCREENglRotate(void);
 PsychError      SCREENPreloadTextures(void);
+PsychError      SCREENIsTextureReady(void);
 PsychError      SCREENFillArc(void);
 PsychError      SCREENDrawArc(void);
 PsychError      SCREENFrameArc(void);
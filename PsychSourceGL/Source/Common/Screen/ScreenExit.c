@@ -43,6 +43,9 @@ PsychError ScreenExitFunction(void)
 	// This is defined in Common/Screen/SCREENFillPoly.c
 	PsychCleanupSCREENFillPoly();
 
+	// Shutdown worker threads of texture conversion for SCREEN('MakeTexture'):
+	PsychExitTextureConversion();
+
 	// Release our internal locale object for character <-> unicode conversion:
 	PsychSetUnicodeTextConversionLocale(NULL);
 
@@ -79,6 +79,7 @@ void InitializeSynopsis()
     synopsis[i++] = "[windowPtr,rect]=Screen('OpenWindow',windowPtrOrScreenNumber [,color] [,rect] [,pixelSize] [,numberOfBuffers] [,stereomode] [,multisample][,imagingmode][,specialFlags][,clientRect]);";
     synopsis[i++] = "[windowPtr,rect]=Screen('OpenOffscreenWindow',windowPtrOrScreenNumber [,color] [,rect] [,pixelSize] [,specialFlags] [,multiSample]);";
     synopsis[i++] = "textureIndex=Screen('MakeTexture', WindowIndex, imageMatrix [, optimizeForDrawAngle=0] [, specialFlags=0] [, floatprecision=0] [, textureOrientation=0] [, textureShader=0]);";
+    synopsis[i++] = "ready = Screen('IsTextureReady', textureIndices [, waitForReady=0]);";
     synopsis[i++] = "oldParams = Screen('PanelFitter', windowPtr [, newParams]);";
     synopsis[i++] = "Screen('Close', [windowOrTextureIndex or list of textureIndices/offscreenWindowIndices]);";
     synopsis[i++] = "Screen('CloseAll');";
@@ -128,6 +129,8 @@ void InitializeSynopsis()
     // Copy an image, slowly, between matrices and windows
     synopsis[i++] = "\n% Copy an image, slowly, between matrices and windows :";
     synopsis[i++] = "imageArray=Screen('GetImage', windowPtr [,rect] [,bufferName] [,floatprecision=0] [,nrchannels=3])";
+    synopsis[i++] = "handle=Screen('GetImageAsyncBegin', windowPtr [,rect] [,bufferName] [,floatprecision=0] [,nrchannels=3])";
+    synopsis[i++] = "imageArray=Screen('GetImageAsyncEnd', windowPtr, handle [,waitForCompletion=1])";
     synopsis[i++] = "Screen('PutImage', windowPtr, imageArray [,rect]);";
 
     // Synchronize with the window's screen (on-screen only):
@@ -139,6 +142,7 @@ void InitializeSynopsis()
     synopsis[i++] = "[VBLTimestamp StimulusOnsetTime swapCertainTime] = Screen('WaitUntilAsyncFlipCertain', windowPtr);";
     synopsis[i++] = "[info] = Screen('GetFlipInfo', windowPtr [, infoType=0] [, auxArg1]);";
     synopsis[i++] = "[telapsed] = Screen('DrawingFinished', windowPtr [, dontclear] [, sync]);";
+    synopsis[i++] = "oldEnable = Screen('DeferredDrawing', windowPtr [, enable]);";
     synopsis[i++] = "framesSinceLastWait = Screen('WaitBlanking', windowPtr [, waitFrames]);";
 
     // Load color lookup table of the window's screen (on-screen only)
@@ -262,6 +262,14 @@ typedef struct {
 // assume the gpu can process/interpolate vertex colors at full 32bpc float precision.
 #define kPsychAssumeGfxCapVCGood (1 << 28)
 
+// Do not stream vertex arrays of batch drawing commands like 'DrawDots' into a VBO,
+// but let OpenGL source them from client memory as in the past:
+#define kPsychDontUseVertexStreaming (1 << 29)
+
+// Do not use instanced rendering for batches of textures drawn via 'DrawTextures',
+// but expand each drawn texture quad on the cpu into a vertex array:
+#define kPsychDontUseInstancedTextureBlits (1 << 30)
+
 //function protoptypes
 
 //Accessors for PsychDepthType 
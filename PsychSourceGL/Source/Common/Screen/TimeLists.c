@@ -17,7 +17,8 @@
 	DESCRIPTION:
 
 		For purposes of instrumenting Screen, maintain times samples in an abstract list type.  Internally we use a 
-		linked list.  To external functions reading out values, the list appears to be an array.
+		table of fixed size chunks of preallocated storage.  To external functions reading out values, the list
+		appears to be an array.
 		
 		It is easy to time  Screen subfuntions from MATLAB by surrounding them with calls to GetSecs().  
 
@@ -37,105 +38,227 @@
 		The close routine which you register with ScriptingGlue, that routine which is executed before the mex file 
 		is flushed, must call ClearTimingArray() to free storage allocated by TimeLists.
 	
+		Storage is allocated in chunks of TIMELIST_CHUNKSIZE samples. SetTimeListCapacity() allocates all chunks
+		for a given capacity upfront, so StoreNowTime() doesn't need to allocate memory, unless the list grows beyond
+		its capacity. Each sample carries a numeric tag, so different call sites can be told apart by using
+		StoreNowTimeTagged() with different tags. StoreNowTime() uses tag zero. In ring mode, the list doesn't grow
+		beyond its capacity, but overwrites its oldest samples instead, so instrumentation can stay enabled for long
+		running sessions. The ring wraps at exactly the requested capacity, even if the last chunk has room to spare,
+		so it keeps exactly as many samples as the caller asked for.
+
+		GetTimeListTagStats() computes statistics for the durations between each sample with a given tag and the
+		sample immediately preceeding it in the list, ie. the execution time of the code between two call sites.
+
 	TO DO:
 	
-		No provision is made for multiple simultaneous lists of times.  However, it seems better to only maintain one list of 
-		times, and to have a second, parallel list of strings labeling the events which occured at particular times. 
+		No provision is made for multiple simultaneous lists of times.
 		
 */
 
 #include "Psych.h"
 
-
+// Number of samples per chunk. Must be a power of two:
+#define TIMELIST_CHUNKSHIFT	12
+#define TIMELIST_CHUNKSIZE	(1 << TIMELIST_CHUNKSHIFT)
+#define TIMELIST_CHUNKMASK	(TIMELIST_CHUNKSIZE - 1)
 
 typedef struct _timeArrayElement_{
 	double							timeValue;
-	struct _timeArrayElement_		*next;
+	unsigned int					tag;
 } timeArrayElement;
 
+static timeArrayElement		**timeListChunks=NULL;		// Table of pointers to chunks.
+static unsigned int			numChunksAllocated=0;		// Number of allocated chunks.
+static unsigned int			numChunkSlots=0;			// Size of chunk pointer table.
+static psych_uint64			numStored=0;				// Number of samples stored since last clear, including overwritten ones.
+static unsigned int			writeIndex=0;				// Index of next sample to write.
+static unsigned int			capacityElements=0;			// Capacity in samples. Exactly the requested one in ring mode.
+static psych_bool			ringMode=FALSE;				// Overwrite oldest samples if capacity is exhausted?
 
-static timeArrayElement		*timeListHead=NULL;
-static timeArrayElement		*timeListTail=NULL;
-static unsigned int			numElements=0;
+// Make sure there is a chunk at index chunkIndex. Returns FALSE if out of memory:
+static psych_bool AllocTimeListChunk(unsigned int chunkIndex)
+{
+	timeArrayElement	**newChunks;
+	unsigned int		newSlots;
+
+	if (chunkIndex < numChunksAllocated) return(TRUE);
+
+	// Grow chunk table if needed:
+	if (chunkIndex >= numChunkSlots) {
+		newSlots = (numChunkSlots > 0) ? numChunkSlots * 2 : 16;
+		while (newSlots <= chunkIndex) newSlots *= 2;
+		newChunks = (timeArrayElement**) realloc(timeListChunks, newSlots * sizeof(timeArrayElement*));
+		if (newChunks == NULL) return(FALSE);
+		timeListChunks = newChunks;
+		numChunkSlots = newSlots;
+	}
 
+	while (numChunksAllocated <= chunkIndex) {
+		timeListChunks[numChunksAllocated] = (timeArrayElement*) malloc(TIMELIST_CHUNKSIZE * sizeof(timeArrayElement));
+		if (timeListChunks[numChunksAllocated] == NULL) return(FALSE);
+		numChunksAllocated++;
+	}
 
-void StoreNowTime(void)
+	return(TRUE);
+}
+
+void StoreNowTimeTagged(unsigned int tag)
 {
 	double				now;
-	timeArrayElement	*newElement;
-	
+	unsigned int		index;
+	timeArrayElement	*element;
+
 	PsychGetAdjustedPrecisionTimerSeconds(&now);
-	newElement=(timeArrayElement *)malloc(sizeof(timeArrayElement));
-	newElement->timeValue=now;
-	newElement->next=NULL;
-	if(timeListTail != NULL)
-		timeListTail->next=newElement;
-	timeListTail=newElement;
-	if(timeListHead==NULL)
-		timeListHead=newElement;
-	++numElements;
+
+	index = writeIndex;
+	if (index >= capacityElements) {
+		// Growth mode: Out of preallocated chunks, allocate one more. This is the only
+		// case where recording a sample needs to allocate memory:
+		if (!AllocTimeListChunk(index >> TIMELIST_CHUNKSHIFT)) return;
+		capacityElements = numChunksAllocated * TIMELIST_CHUNKSIZE;
+	}
+
+	element = &(timeListChunks[index >> TIMELIST_CHUNKSHIFT][index & TIMELIST_CHUNKMASK]);
+	element->timeValue = now;
+	element->tag = tag;
+	++numStored;
+
+	// Ring mode: Wrap around to overwrite the oldest sample next time:
+	if ((++writeIndex == capacityElements) && ringMode) writeIndex = 0;
+}
+
+void StoreNowTime(void)
+{
+	StoreNowTimeTagged(0);
 }
 
 void ClearTimingArray(void)
 {
-	timeArrayElement	*thisElement, *tempElement;
-	
-	
-	thisElement=timeListHead;
-	while(thisElement!=NULL){
-		if(thisElement->next==NULL){
-			//end of list.  free this element.
-			free(thisElement);
-			thisElement=NULL;
-			timeListHead=NULL;
-			timeListTail=NULL;
-			numElements=0;
-		}else{
-			//step ahead and free the element behind
-			tempElement=thisElement;
-			thisElement=thisElement->next;
-			free(tempElement);
+	unsigned int i;
+
+	for (i = 0; i < numChunksAllocated; i++) free(timeListChunks[i]);
+	free(timeListChunks);
+	timeListChunks = NULL;
+	numChunksAllocated = 0;
+	numChunkSlots = 0;
+	numStored = 0;
+	writeIndex = 0;
+	capacityElements = 0;
+	ringMode = FALSE;
+}
+
+/* SetTimeListCapacity()
+ *
+ * Clear the time list and preallocate storage for at least 'capacity' samples.
+ * If 'overwrite' is TRUE, the list operates as ringbuffer and only the most
+ * recent 'capacity' samples are kept once capacity is exhausted, otherwise it
+ * grows, and starts to allocate once the preallocated chunks are full.
+ * Returns FALSE if the storage could not be allocated.
+ */
+psych_bool SetTimeListCapacity(unsigned int capacity, psych_bool overwrite)
+{
+	ClearTimingArray();
+
+	if (capacity > 0) {
+		if (!AllocTimeListChunk((capacity - 1) >> TIMELIST_CHUNKSHIFT)) {
+			ClearTimingArray();
+			return(FALSE);
 		}
-	}	
+		capacityElements = (overwrite) ? capacity : numChunksAllocated * TIMELIST_CHUNKSIZE;
+	}
+
+	ringMode = (overwrite && (capacity > 0)) ? TRUE : FALSE;
+
+	return(TRUE);
 }
 
 unsigned int GetNumTimeValues(void)
 {
-	return(numElements);
+	return((ringMode && (numStored > capacityElements)) ? capacityElements : (unsigned int) numStored);
 }
 
 unsigned int GetTimeArraySizeBytes(void)
 {
-	return(numElements * sizeof(double));
+	return(GetNumTimeValues() * sizeof(double));
 }
 
+// Return the i'th stored element, counting from the oldest one still in the list:
+static timeArrayElement* GetTimeArrayElement(unsigned int i)
+{
+	// Once a ringbuffer has wrapped around, the oldest sample is the one to be overwritten next:
+	if (ringMode && (numStored > capacityElements)) i = (writeIndex + i) % capacityElements;
+	return(&(timeListChunks[i >> TIMELIST_CHUNKSHIFT][i & TIMELIST_CHUNKMASK]));
+}
 
 void CopyTimeArray(double *destination, unsigned int numElements)
 {
-	timeArrayElement	*thisElement;
 	unsigned int		i;
 
-	thisElement=timeListHead;
-	for(i=0;i<numElements;i++){
-		if(thisElement==NULL)
-			PsychErrorExitMsg(PsychError_internal, "Attempted to copy out more values than are stored in list");
-		else{
-			destination[i]=thisElement->timeValue;
-			thisElement=thisElement->next;
-		}
-	}
-}
-
-
-
-
-
-
+	if (numElements > GetNumTimeValues())
+		PsychErrorExitMsg(PsychError_internal, "Attempted to copy out more values than are stored in list");
 
+	for(i=0;i<numElements;i++) destination[i] = GetTimeArrayElement(i)->timeValue;
+}
 
+void CopyTimeArrayTags(double *destination, unsigned int numElements)
+{
+	unsigned int		i;
 
+	if (numElements > GetNumTimeValues())
+		PsychErrorExitMsg(PsychError_internal, "Attempted to copy out more tags than are stored in list");
 
+	for(i=0;i<numElements;i++) destination[i] = (double) GetTimeArrayElement(i)->tag;
+}
 
+static int CompareTimeListDurations(const void *a, const void *b)
+{
+	double da = *((const double*) a);
+	double db = *((const double*) b);
+	return((da < db) ? -1 : ((da > db) ? 1 : 0));
+}
 
+/* GetTimeListTagStats()
+ *
+ * Compute statistics over the durations between each sample with tag 'tag' and its
+ * immediate predecessor sample in the list. 'stats' must have room for TIMELIST_NUMSTATS
+ * values, which are returned in the order: count, min, max, mean, median, 90th percentile,
+ * 99th percentile. Durations are in seconds. Returns number of durations found.
+ */
+unsigned int GetTimeListTagStats(unsigned int tag, double *stats)
+{
+	unsigned int	i, n, count;
+	double			*durations, sum;
+	timeArrayElement *element, *prev;
+
+	for (i = 0; i < TIMELIST_NUMSTATS; i++) stats[i] = 0;
+
+	n = GetNumTimeValues();
+	if (n < 2) return(0);
+
+	durations = (double*) PsychMallocTemp((n - 1) * sizeof(double));
+	count = 0;
+	sum = 0;
+	prev = GetTimeArrayElement(0);
+	for (i = 1; i < n; i++) {
+		element = GetTimeArrayElement(i);
+		if (element->tag == tag) {
+			durations[count] = element->timeValue - prev->timeValue;
+			sum += durations[count];
+			count++;
+		}
+		prev = element;
+	}
 
+	if (count > 0) {
+		qsort(durations, count, sizeof(double), CompareTimeListDurations);
+		stats[0] = (double) count;
+		stats[1] = durations[0];
+		stats[2] = durations[count - 1];
+		stats[3] = sum / (double) count;
+		stats[4] = durations[(unsigned int) (0.50 * (count - 1) + 0.5)];
+		stats[5] = durations[(unsigned int) (0.90 * (count - 1) + 0.5)];
+		stats[6] = durations[(unsigned int) (0.99 * (count - 1) + 0.5)];
+	}
 
+	return(count);
+}
@@ -17,7 +17,7 @@
 	DESCRIPTION:
 
 		For purposes of instrumenting Screen, maintain times samples in an abstract list type.  Internally we use a 
-		linked list.  To external functions reading out values, it appears to be an array.
+		table of preallocated chunks.  To external functions reading out values, it appears to be an array.
 */
 
 //begin include once 
@@ -25,11 +25,18 @@
 #define PSYCH_IS_INCLUDED_TimeLists
 
 
+// Number of values returned by GetTimeListTagStats():
+#define TIMELIST_NUMSTATS 7
+
 void StoreNowTime(void);
+void StoreNowTimeTagged(unsigned int tag);
 void ClearTimingArray(void);
+psych_bool SetTimeListCapacity(unsigned int capacity, psych_bool overwrite);
 unsigned int GetNumTimeValues(void);
 unsigned int GetTimeArraySizeBytes(void);
 void CopyTimeArray(double *destination, unsigned int numElements);
+void CopyTimeArrayTags(double *destination, unsigned int numElements);
+unsigned int GetTimeListTagStats(unsigned int tag, double *stats);
 
 //end include once
 #endif
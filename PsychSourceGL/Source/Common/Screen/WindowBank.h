@@ -182,6 +182,123 @@ typedef struct PsychFBO {
     GLenum                  textarget;      // Type of texture target for texture coltexid (GL_TEXTURE_RECTANGLE_EXT or GL_TEXTURE_2D etc.)
 } PsychFBO;
 
+// Maximum number of pending asynchronous image readbacks of Screen('GetImageAsyncBegin') per onscreen window,
+// i.e., size of its pool of readback slots:
+#define kPsychMaxAsyncReadbacks 8
+
+// Definition of an asynchronous image readback into an OpenGL pixel pack buffer object (PBO):
+typedef struct PsychAsyncReadback {
+    GLuint                  pbo;            // Handle to PBO. Zero if not yet created.
+    size_t                  pboSize;        // Size of PBO in bytes.
+    GLsync                  fence;          // Fence to poll for completion of the readback. NULL if unsupported.
+    int                     handle;         // Handle of the pending readback in this slot. Zero if slot is free.
+    int                     width;          // Width of image.
+    int                     height;         // Height of image.
+    int                     nrchannels;     // Number of color channels to return.
+    int                     stride;         // Number of color channels per pixel in the PBO.
+    psych_bool              floatprecision; // Pixels are floats instead of uint8.
+} PsychAsyncReadback;
+
+// Size of streaming vertex buffer object for batch drawing commands, and number of segments it is split into for fencing:
+#define kPsychVertexStreamSize      (16 * 1024 * 1024)
+#define kPsychVertexStreamSegments  4
+
+// Definition of a streaming vertex buffer object (VBO) for the vertex arrays of batch drawing commands like 'DrawDots':
+typedef struct PsychVertexStream {
+    GLuint                  vbo;            // Handle to VBO. Zero if not yet created.
+    size_t                  offset;         // Offset of next free byte in VBO.
+    void*                   mapped;         // Persistently mapped VBO memory, or NULL if VBO is updated via glBufferSubData() and orphaning.
+    int                     segment;        // Index of segment currently written to.
+    GLsync                  fences[kPsychVertexStreamSegments]; // Fences for completion of all draws from each segment. NULL if none pending.
+    psych_bool              unsupported;    // VBO's unsupported or creation of VBO failed. Use client memory vertex arrays.
+} PsychVertexStream;
+
+// Types of drawing commands recorded in deferred drawing mode, see Screen('DeferredDrawing'):
+#define kPsychDeferredFillRect      0
+#define kPsychDeferredDrawLine      1
+#define kPsychDeferredDrawTexture   2
+
+// Maximum number of pending deferred drawing commands per window. Commands get executed when this is reached:
+#define kPsychMaxDeferredCommands   65536
+
+// Definition of one drawing command recorded in deferred drawing mode:
+typedef struct PsychDeferredDrawCommand {
+    int                     type;           // kPsychDeferredFillRect, kPsychDeferredDrawLine or kPsychDeferredDrawTexture.
+    GLdouble                color[4];       // Normalized color of rect or line, or modulateColor of texture.
+    double                  rect[4];        // Rect to fill, line as [fromH fromV toH toV], or destinationRect of texture.
+    double                  srcRect[4];     // sourceRect of texture.
+    double                  param;          // penWidth of line, or rotationAngle of texture.
+    double                  globalAlpha;    // globalAlpha of texture, or DBL_MAX if 'color' is used as modulateColor.
+    int                     filterMode;     // filterMode of texture.
+    struct _PsychWindowRecordType_ *source; // Texture to draw.
+} PsychDeferredDrawCommand;
+
+// Size of the pages of the texture pool for small textures created via Screen('MakeTexture') with
+// specialFlags 64, maximum size of a pooled texture, and size of the border around each pooled texture:
+#define kPsychTexturePoolPageSize       2048
+#define kPsychTexturePoolMaxTextureSize 256
+#define kPsychTexturePoolBorder         1
+
+// Maximum number of shelves and of free slots in a page of the texture pool:
+#define kPsychTexturePoolMaxShelves     256
+#define kPsychTexturePoolMaxFreeSlots   1024
+
+// Definition of a rectangular slot in a page of the texture pool, which holds one texture and its border:
+typedef struct PsychTexturePoolSlot {
+    int                     x;              // Left edge of slot in page, in texels.
+    int                     y;              // Top edge of slot in page, in texels.
+    int                     width;          // Width of slot, in texels.
+    int                     height;         // Height of slot, in texels.
+} PsychTexturePoolSlot;
+
+// Definition of one page of the texture pool: A rectangle texture which stores many small textures of the same internal format:
+typedef struct PsychTexturePoolPage {
+    GLuint                  textureNumber;  // OpenGL rectangle texture of the page.
+    GLint                   internalFormat; // GL_LUMINANCE8 or GL_RGBA8.
+    int                     width;          // Width of page, in texels.
+    int                     height;         // Height of page, in texels.
+    int                     refCount;       // Number of textures stored in this page. Page gets deleted when it drops to zero.
+    int                     usedHeight;     // Total height of all shelves.
+    int                     shelfCount;     // Number of shelves, i.e., rows of slots filled from left to right.
+    int                     shelfY[kPsychTexturePoolMaxShelves];        // Top edge of each shelf.
+    int                     shelfHeight[kPsychTexturePoolMaxShelves];   // Height of each shelf.
+    int                     shelfX[kPsychTexturePoolMaxShelves];        // Left edge of free space on each shelf.
+    int                     freeCount;      // Number of free slots.
+    PsychTexturePoolSlot    freeSlots[kPsychTexturePoolMaxFreeSlots];   // Slots of closed textures, for reuse.
+    struct PsychTexturePoolPage *next;      // Next page in list of pages, or NULL.
+} PsychTexturePoolPage;
+
+// Definition of one upload of a texture created via Screen('MakeTexture') with specialFlags 128,
+// executed by the background texture upload thread of its onscreen window:
+typedef struct PsychTextureUploadJob {
+    GLuint                  textureNumber;  // OpenGL texture to upload into. Created by the main thread.
+    GLenum                  target;         // Texture target, GL_TEXTURE_RECTANGLE_EXT or GL_TEXTURE_2D.
+    GLint                   internalFormat; // Internal format of texture.
+    GLenum                  format;         // Format of texel data.
+    GLenum                  type;           // Data type of texel data.
+    int                     width;          // Width of texture.
+    int                     height;         // Height of texture.
+    int                     alignment;      // GL_UNPACK_ALIGNMENT for texel data.
+    void*                   data;           // malloc()'ed texel data. Free'd by the upload thread after upload.
+    size_t                  size;           // Size of texel data in bytes.
+    GLsync                  fence;          // Fence behind the upload, inserted by the upload thread. NULL if none.
+    psych_bool              done;           // Upload thread is done with this job, successfully or not.
+    psych_bool              failed;         // Upload thread could not upload. Main thread must do it synchronously.
+    struct PsychTextureUploadJob *next;     // Next job in queue of upload thread, or NULL.
+} PsychTextureUploadJob;
+
+// Definition of the background texture upload thread of an onscreen window and its queue of jobs:
+typedef struct PsychTextureUploader {
+    psych_thread            thread;         // Upload thread.
+    psych_mutex             mutex;          // Lock protecting queue and all job states.
+    psych_condition         workCondition;  // Signalled by main thread when a new job was queued, or at shutdown.
+    psych_condition         doneCondition;  // Broadcast by upload thread when a job is done.
+    PsychTextureUploadJob*  head;           // First job in queue, next one to process, or NULL.
+    PsychTextureUploadJob*  tail;           // Last job in queue, or NULL.
+    psych_bool              shutdown;       // Request for upload thread to exit after the queue is empty.
+    psych_bool              contextFailed;  // Upload thread could not bind its OpenGL context. All jobs fail.
+} PsychTextureUploader;
+
 // Typedefs for WindowRecord in WindowBank.h
 
 // This support structure for async flips is supported on all non-Windows platforms, aka all Unix platforms:
@@ -215,6 +332,7 @@ typedef struct{
         CGLPixelFormatObj   pixelFormatObject;
         CGLContextObj       glusercontextObject;    // OpenGL context for userspace rendering code, e.g., moglcore...
         CGLContextObj       glswapcontextObject;    // OpenGL context for performing doublebuffer swaps in PsychFlipWindowBuffers().
+        CGLContextObj       gluploadcontextObject;  // OpenGL context for background texture uploads, or NULL.
         void*               deviceContext;          // Pointer to an AGLContext object, or a NULL-pointer.
         // NSWindow* type stored in void* to avoid "Cocoa/Objective-C pollution" in this header file.
         void*               windowHandle;           // Handle for Cocoa window when using windowed mode. (NULL in non-windowed mode).
@@ -235,6 +353,7 @@ typedef struct{
   PIXELFORMATDESCRIPTOR     pixelFormatObject;      // The context's pixel format object.
   HGLRC                     glusercontextObject;    // OpenGL context for userspace rendering code, e.g., moglcore...
   HGLRC                     glswapcontextObject;    // OpenGL context for performing doublebuffer swaps in PsychFlipWindowBuffers().
+  HGLRC                     gluploadcontextObject;  // OpenGL context for background texture uploads, or NULL.
 } PsychTargetSpecificWindowRecordType;
 #endif 
 
@@ -258,6 +377,8 @@ typedef struct {
     struct wl_surface*        xwindowHandle;                  // Associated Wayland "window", if any.
     struct waffle_context*    glusercontextObject;            // OpenGL context for userspace rendering code, e.g., moglcore...
     struct waffle_context*    glswapcontextObject;            // OpenGL context for performing doublebuffer swaps in PsychFlipWindowBuffers().
+    struct waffle_context*    gluploadcontextObject;          // OpenGL context for background texture uploads, or NULL.
+    struct waffle_config*     uploadconfigObject;             // Config of primary context, for creation of gluploadcontextObject on first use.
     struct wl_list            presentation_feedback_list;     // Used for Wayland backend presentation_feedback extension to queue feedback events.
 } PsychTargetSpecificWindowRecordType;
 #else
@@ -271,6 +392,8 @@ typedef struct {
   Window                    xwindowHandle;                  // Associated X-Window if any.
   struct waffle_context*    glusercontextObject;            // OpenGL context for userspace rendering code, e.g., moglcore...
   struct waffle_context*    glswapcontextObject;            // OpenGL context for performing doublebuffer swaps in PsychFlipWindowBuffers().
+  struct waffle_context*    gluploadcontextObject;          // OpenGL context for background texture uploads, or NULL.
+  struct waffle_config*     uploadconfigObject;             // Config of primary context, for creation of gluploadcontextObject on first use.
 #ifdef PTB_USE_WAYLAND_PRESENT
   struct wl_list            presentation_feedback_list;     // Used for Wayland backend presentation_feedback extension to queue feedback events.
 #endif
@@ -288,6 +411,7 @@ typedef struct{
   Window            xwindowHandle;       // Associated X-Window if any.
   GLXContext        glusercontextObject; // OpenGL context for userspace rendering code, e.g., moglcore...
   GLXContext        glswapcontextObject; // OpenGL context for performing doublebuffer swaps in PsychFlipWindowBuffers().
+  GLXContext        gluploadcontextObject; // OpenGL context for background texture uploads, or NULL.
 } PsychTargetSpecificWindowRecordType;
 #endif
 
@@ -391,6 +515,22 @@ typedef struct _PsychWindowRecordType_{
     double                      osbuiltin_swaptime;     // Optional timestamp of swap completion computed via PsychOSGetSwapCompletionTimestamp();
     double                      gpuRenderTime;          // GPU time spent on rendering. Only returned if a query object is successfully generated.
     GLuint                      gpuRenderTimeQuery;     // Handle to the GPU time query object. 0 if none assigned.
+    PsychAsyncReadback          asyncReadbacks[kPsychMaxAsyncReadbacks]; // Pool of slots for pending image readbacks of Screen('GetImageAsyncBegin'), used in any order. Onscreen windows only.
+    int                         asyncReadbackCount;     // Number of readbacks started via Screen('GetImageAsyncBegin'), for generation of handles.
+    PsychVertexStream           vertexStream;           // Streaming VBO for vertex arrays of batch drawing commands. Onscreen windows only.
+    psych_bool                  deferredDrawing;        // Deferred drawing mode enabled via Screen('DeferredDrawing')?
+    PsychDeferredDrawCommand*   deferredCommands;       // Array of recorded drawing commands in deferred drawing mode, or NULL.
+    int                         deferredCount;          // Number of recorded commands pending execution.
+    int                         deferredCapacity;       // Allocated number of elements in deferredCommands.
+    GLfloat                     lineWidthRange[2];      // Supported range of line widths, queried when deferred drawing gets enabled.
+    GLuint                      instancedBlitShader[2]; // Shaders for instanced drawing of texture batches, for rectangle- and 2D textures. 0 if none yet. Onscreen windows only.
+    psych_bool                  instancedBlitUnsupported; // Instanced drawing of texture batches unsupported, or shader creation failed?
+    PsychTexturePoolPage*       texturePool;            // List of pages of the texture pool for small textures, or NULL. Onscreen windows only.
+    PsychTexturePoolPage*       texturePoolPage;        // Page of the texture pool which stores this texture, or NULL if texture has its own OpenGL texture.
+    PsychTexturePoolSlot        texturePoolSlot;        // Slot of this texture in its page of the texture pool.
+    PsychTextureUploader*       textureUploader;        // Background texture upload thread for Screen('MakeTexture') specialFlags 128, or NULL. Onscreen windows only.
+    PsychTextureUploadJob*      textureUploadJob;       // Pending background upload of this texture, or NULL if texture is ready for use.
+    psych_bool                  textureUploadUnsupported; // Setup of upload context or thread for background texture uploads failed? Onscreen windows only.
     psych_int64                 reference_ust;          // UST reference timestamp of vblank with count reference_msc from OpenML. (Optional)
     psych_int64                 reference_msc;          // MSC reference vblank count from OpenML. (Optional)
     psych_int64                 reference_sbc;          // SBC reference swapbuffers count from OpenML. (Optional)
@@ -34,6 +34,12 @@ PsychError PsychModuleInit(void)
 	// Wait until specific deadline:
 	PsychErrorExit(PsychRegister("UntilTime", &WAITSECSWaitUntilSecs));
 	PsychErrorExit(PsychRegister("YieldSecs", &WAITSECSYieldSecs));
+
+	// Benchmark of clocks usable as time base:
+	PsychErrorExit(PsychRegister("ClockBenchmark", &WAITSECSClockBenchmark));
+
+	// Statistics of timed waits:
+	PsychErrorExit(PsychRegister("Stats", &WAITSECSStats));
 	
 	//report the version
 	PsychErrorExit(PsychRegister("Version", &MODULEVersion));
@@ -46,6 +46,8 @@ void WAITSECSSynopsis(void)
 	printf("[realWakeupTimeSecs] = WaitSecs(waitPeriodSecs);              -- Wait for at least 'waitPeriodSecs' seconds. Try to be precise.\n");
 	printf("[realWakeupTimeSecs] = WaitSecs('UntilTime', whenSecs);       -- Wait until at least time 'whenSecs'.\n");
 	printf("[realWakeupTimeSecs] = WaitSecs('YieldSecs', waitPeriodSecs); -- Wait for at least 'waitPeriodSecs' seconds. Be more sloppy.\n");
+	printf("results = WaitSecs('ClockBenchmark' [, durationSecs=0.2]);     -- Benchmark cost, resolution and monotonicity of clocks.\n");
+	printf("stats = WaitSecs('Stats' [, reset=0][, percentile]);          -- Return statistics of timed waits. Linux only.\n");
 	printf("\nThe optional 'realWakeupTimeSecs' is the real system time when WaitSecs finished waiting,\n");
 	printf("just as if you'd call realWakeupTimeSecs = GetSecs; after calling WaitSecs. This for your\n");
 	printf("convenience and to reduce call overhead and drift a bit for this common combo of commands.\n\n");
@@ -154,3 +156,198 @@ PsychError WAITSECSYieldSecs(void)
 
     return(PsychError_none);	
 }
+
+// Read clock 'whichClock' for WAITSECSClockBenchmark: -1 = GetSecs, >= 0 = one of the
+// Linux time bases. Returns FALSE if that clock isn't available:
+static psych_bool WAITSECSReadClock(int whichClock, double *secs)
+{
+    if (whichClock < 0) {
+        PsychGetAdjustedPrecisionTimerSeconds(secs);
+        return(TRUE);
+    }
+
+    #if PSYCH_SYSTEM == PSYCH_LINUX
+        return(PsychOSGetTimeBaseSeconds(whichClock, secs));
+    #else
+        return(FALSE);
+    #endif
+}
+
+PsychError WAITSECSClockBenchmark(void)
+{
+    static char useString[] = "results = WaitSecs('ClockBenchmark' [, durationSecs=0.2]);";
+    //                                                                1
+    static char synopsisString[] =
+    "Benchmark the clocks which can be used as time base for GetSecs et al.\n"
+    "Each clock is queried in a tight loop for \"durationSecs\" seconds, default 0.2 seconds. "
+    "Returns a struct array \"results\" with one element per clock, with the following fields:\n"
+    "'name' Name of the clock. 'GetSecs' is the time base as used by GetSecs, including all overhead. "
+    "On Linux, the other clocks are the time bases selectable by setting the environment variable "
+    "PSYCH_TIMEBASE to the clock name before starting Octave or Matlab: 'realtime' is CLOCK_REALTIME "
+    "aka gettimeofday(), the default. 'monotonic' is CLOCK_MONOTONIC, which isn't affected by steps of "
+    "the system wall clock. 'monotonicraw' is CLOCK_MONOTONIC_RAW, which is also not slewed by NTP. 'tsc' "
+    "reads the invariant timestamp counter of x86 processors directly, calibrated against CLOCK_MONOTONIC "
+    "at startup. It is only available if the TSC is invariant and trusted by the Linux kernel as its clocksource.\n"
+    "'available' 1 if the clock is usable on this system, 0 otherwise.\n"
+    "'active' 1 if this clock is the time base used by GetSecs.\n"
+    "'calls' Number of queries done.\n"
+    "'nsecsPerCall' Mean duration of one query in nanoseconds.\n"
+    "'nsecsResolution' Smallest observed nonzero increment between consecutive queries in nanoseconds.\n"
+    "'monotonicityViolations' Number of times the clock went backwards between consecutive queries.\n";
+
+    static char seeAlsoString[] = "";
+
+    static const char *fieldNames[] = { "name", "available", "active", "calls", "nsecsPerCall", "nsecsResolution", "monotonicityViolations" };
+    PsychGenericScriptType *results;
+    double durationSecs = 0.2;
+    double tStart = 0, tNow = 0, t, tLast, minDelta;
+    double calls, violations;
+    int i, j, numClocks, whichClock;
+    psych_bool available;
+
+    //all sub functions should have these two lines
+    PsychPushHelp(useString, synopsisString,seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+    //check to see if the user supplied superfluous arguments
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+    PsychErrorExit(PsychCapNumInputArgs(1));
+
+    PsychCopyInDoubleArg(1, FALSE, &durationSecs);
+    if (durationSecs <= 0) PsychErrorExitMsg(PsychError_user, "Invalid 'durationSecs' specified. Must be greater than zero.");
+
+    #if PSYCH_SYSTEM == PSYCH_LINUX
+        numClocks = 1 + kPsychTimeBaseCount;
+    #else
+        numClocks = 1;
+    #endif
+
+    PsychAllocOutStructArray(1, FALSE, numClocks, 7, fieldNames, &results);
+
+    for (i = 0; i < numClocks; i++) {
+        whichClock = i - 1;
+        calls = violations = 0;
+        minDelta = DBL_MAX;
+
+        available = WAITSECSReadClock(whichClock, &tLast);
+        if (available) {
+            PsychGetAdjustedPrecisionTimerSeconds(&tStart);
+            do {
+                // Batches of 1000 queries, so the GetSecs for checking the duration doesn't matter:
+                for (j = 0; j < 1000; j++) {
+                    WAITSECSReadClock(whichClock, &t);
+                    if (t < tLast) violations++;
+                    else if ((t > tLast) && (t - tLast < minDelta)) minDelta = t - tLast;
+                    tLast = t;
+                }
+                calls += 1000;
+                PsychGetAdjustedPrecisionTimerSeconds(&tNow);
+            } while (tNow - tStart < durationSecs);
+        }
+
+        #if PSYCH_SYSTEM == PSYCH_LINUX
+            PsychSetStructArrayStringElement("name", i, (char*) ((whichClock < 0) ? "GetSecs" : PsychOSGetTimeBaseName(whichClock)), results);
+            PsychSetStructArrayDoubleElement("active", i, ((whichClock < 0) || (whichClock == PsychOSGetTimeBase())) ? 1 : 0, results);
+        #else
+            PsychSetStructArrayStringElement("name", i, "GetSecs", results);
+            PsychSetStructArrayDoubleElement("active", i, 1, results);
+        #endif
+        PsychSetStructArrayDoubleElement("available", i, (available) ? 1 : 0, results);
+        PsychSetStructArrayDoubleElement("calls", i, calls, results);
+        PsychSetStructArrayDoubleElement("nsecsPerCall", i, (available) ? (tNow - tStart) / calls * 1e9 : PsychGetNanValue(), results);
+        PsychSetStructArrayDoubleElement("nsecsResolution", i, (minDelta < DBL_MAX) ? minDelta * 1e9 : PsychGetNanValue(), results);
+        PsychSetStructArrayDoubleElement("monotonicityViolations", i, violations, results);
+    }
+
+    return(PsychError_none);
+}
+
+PsychError WAITSECSStats(void)
+{
+    static char useString[] = "stats = WaitSecs('Stats' [, reset=0][, percentile]);";
+    //                                                     1          2
+    static char synopsisString[] =
+    "Return statistics about timed waits done by all threads of this mex file, ie., WaitSecs(), "
+    "WaitSecs('UntilTime') and WaitSecs('YieldSecs'), since start or since the last reset. Linux only.\n"
+    "Waits first sleep until a bit before the deadline, then busy-wait, ie. spin, until the deadline. "
+    "The duration of this spin window is adapted per thread, so that the wakeup latency of the sleep, "
+    "ie. how late the operating system wakes up the thread after its sleep target time, stays below it in "
+    "\"percentile\" percent of all cases. If you set the optional \"reset\" flag to 1, the statistics "
+    "are reset after returning them. The optional \"percentile\" sets the percentile for all threads, default 95. "
+    "A higher setting causes more busy-waiting and cpu load, but fewer missed deadlines, and vice versa. "
+    "\"stats\" is a struct with the following fields:\n"
+    "'waits' Number of waits.\n"
+    "'sleeps' Number of waits which slept before spinning. Shorter waits only spin.\n"
+    "'missedDeadlines' Number of waits which ended more than 0.1 msecs after their deadline.\n"
+    "'totalWaitSecs' Total duration of all waits.\n"
+    "'totalSpinSecs' Total duration of busy-waiting, ie. the cpu time burned by the waits.\n"
+    "'maxLatenessSecs' Maximum time a wait ended after its deadline.\n"
+    "'binEdgesUsecs' Lower edges of the bins of the following histograms in microseconds. The last bin "
+    "also counts all larger values.\n"
+    "'latenessHistogram' Histogram of the time waits ended after their deadline.\n"
+    "'sleepLatencyHistogram' Histogram of the wakeup latencies of sleeps.\n"
+    "'spinHistogram' Histogram of the time spent busy-waiting.\n"
+    "'spinWindowUsecs' The current spin window of the calling thread in microseconds.\n"
+    "'percentile' The percentile setting before the change by this call, if any.\n";
+
+    static char seeAlsoString[] = "";
+
+#if PSYCH_SYSTEM == PSYCH_LINUX
+    static const char *fieldNames[] = { "waits", "sleeps", "missedDeadlines", "totalWaitSecs", "totalSpinSecs", "maxLatenessSecs", "binEdgesUsecs",
+                                        "latenessHistogram", "sleepLatencyHistogram", "spinHistogram", "spinWindowUsecs", "percentile" };
+    PsychGenericScriptType *stats, *outMat;
+    PsychWaitStats waitStats;
+    const double *binEdges;
+    double *v, percentile = -1;
+    int reset = 0, i;
+#endif
+
+    //all sub functions should have these two lines
+    PsychPushHelp(useString, synopsisString,seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+    //check to see if the user supplied superfluous arguments
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+    PsychErrorExit(PsychCapNumInputArgs(2));
+
+#if PSYCH_SYSTEM == PSYCH_LINUX
+    PsychCopyInIntegerArg(1, FALSE, &reset);
+    if (PsychCopyInDoubleArg(2, FALSE, &percentile) && ((percentile < 0) || (percentile > 100))) {
+        PsychErrorExitMsg(PsychError_user, "Invalid 'percentile' specified. Must be between 0 and 100.");
+    }
+
+    PsychOSGetWaitStats(&waitStats, (reset) ? TRUE : FALSE);
+    binEdges = PsychOSGetWaitStatsBinEdges();
+
+    PsychAllocOutStructArray(1, FALSE, 1, 12, fieldNames, &stats);
+    PsychSetStructArrayDoubleElement("waits", 0, waitStats.waits, stats);
+    PsychSetStructArrayDoubleElement("sleeps", 0, waitStats.sleeps, stats);
+    PsychSetStructArrayDoubleElement("missedDeadlines", 0, waitStats.missedDeadlines, stats);
+    PsychSetStructArrayDoubleElement("totalWaitSecs", 0, waitStats.totalWaitSecs, stats);
+    PsychSetStructArrayDoubleElement("totalSpinSecs", 0, waitStats.totalSpinSecs, stats);
+    PsychSetStructArrayDoubleElement("maxLatenessSecs", 0, waitStats.maxLatenessSecs, stats);
+
+    PsychAllocateNativeDoubleMat(1, kPsychWaitStatsBins, 1, &v, &outMat);
+    for (i = 0; i < kPsychWaitStatsBins; i++) v[i] = binEdges[i] * 1e6;
+    PsychSetStructArrayNativeElement("binEdgesUsecs", 0, outMat, stats);
+
+    PsychAllocateNativeDoubleMat(1, kPsychWaitStatsBins, 1, &v, &outMat);
+    memcpy(v, waitStats.latenessHistogram, sizeof(waitStats.latenessHistogram));
+    PsychSetStructArrayNativeElement("latenessHistogram", 0, outMat, stats);
+
+    PsychAllocateNativeDoubleMat(1, kPsychWaitStatsBins, 1, &v, &outMat);
+    memcpy(v, waitStats.sleepLatencyHistogram, sizeof(waitStats.sleepLatencyHistogram));
+    PsychSetStructArrayNativeElement("sleepLatencyHistogram", 0, outMat, stats);
+
+    PsychAllocateNativeDoubleMat(1, kPsychWaitStatsBins, 1, &v, &outMat);
+    memcpy(v, waitStats.spinHistogram, sizeof(waitStats.spinHistogram));
+    PsychSetStructArrayNativeElement("spinHistogram", 0, outMat, stats);
+
+    PsychSetStructArrayDoubleElement("spinWindowUsecs", 0, PsychOSGetWaitSpinWindow() * 1e6, stats);
+    PsychSetStructArrayDoubleElement("percentile", 0, PsychOSSetWaitPercentile(percentile), stats);
+#else
+    PsychErrorExitMsg(PsychError_unimplemented, "WaitSecs('Stats') is only supported on Linux.");
+#endif
+
+    return(PsychError_none);
+}
@@ -28,6 +28,8 @@ PsychError MODULEVersion(void);			//MODULEVersion.c
 PsychError WAITSECSWaitSecs(void);
 PsychError WAITSECSWaitUntilSecs(void);
 PsychError WAITSECSYieldSecs(void);
+PsychError WAITSECSClockBenchmark(void);
+PsychError WAITSECSStats(void);
 
 //end include once
 #endif
@@ -35,6 +35,13 @@
 // utsname for uname() so we can find out on which kernel we're running:
 #include <sys/utsname.h>
 
+// Intrinsics for reading and checking the TSC on x86:
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define PSYCH_HAVE_TSC 1
+#endif
+
 /*
  *		file local state variables
  */
@@ -46,12 +53,297 @@ static double	        kernelTimebaseFrequencyHz;
 static double           sleepwait_threshold = 0.01;
 static double		clockinc = 0;
 
+// Time base used for GetSecs et al., and its clock id for clock_gettime(). The
+// TSC time base is calibrated against CLOCK_MONOTONIC:
+static int              timeBase = kPsychTimeBaseRealtime;
+static clockid_t        timeBaseClockId = CLOCK_REALTIME;
+
+// TSC calibration: tscState 0 = not yet tried, 1 = calibrated, -1 = unusable. TSC time is
+// tscBaseSecs + (ticks - tscBaseTicks) * tscSecsPerTick. These three get updated together at
+// each recalibration, under the seqlock tscSeq, which is odd while an update is in progress:
+static int              tscState = 0;
+static psych_uint64     tscBaseTicks = 0;
+static double           tscBaseSecs = 0;
+static double           tscSecsPerTick = 0;
+static volatile unsigned int tscSeq = 0;
+
+// Last calibration sample of TSC and CLOCK_MONOTONIC, and TSC ticks between recalibrations:
+static psych_uint64     tscLastTicks = 0;
+static double           tscLastSecs = 0;
+static psych_uint64     tscRecalTicks = 0;
+static volatile int     tscRecalBusy = 0;
+
+// Recalibration interval, and maximum rate correction for slewing out the TSC time error:
+#define kPsychTSCRecalSecs  1.0
+#define kPsychTSCMaxSlew    0.0005
+
+static const char* timeBaseNames[kPsychTimeBaseCount] = { "realtime", "monotonic", "monotonicraw", "tsc" };
+
+#ifdef PSYCH_HAVE_TSC
+/* Sample the TSC and CLOCK_MONOTONIC as close together as possible: Take the
+ * best of a few tries, ie. the one with the smallest TSC interval around the
+ * clock query, and use the middle of that interval.
+ */
+static void PsychOSSampleTSC(psych_uint64 *ticks, double *secs)
+{
+    psych_uint64 a, b, best = 0xffffffffffffffffULL;
+    struct timespec ts;
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        a = __rdtsc();
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        b = __rdtsc();
+        if (b - a < best) {
+            best = b - a;
+            *ticks = a + (b - a) / 2;
+            *secs = (double) ts.tv_sec + ((double) ts.tv_nsec / 1e9);
+        }
+    }
+}
+#endif
+
+/* Calibrate the TSC against CLOCK_MONOTONIC, if it is usable as a time base.
+ *
+ * This needs an invariant TSC, ie. one which ticks at a constant rate regardless
+ * of cpu frequency and sleep states, and the kernel must use the TSC as its own
+ * clocksource, which it only does if it found it to be synchronized across all
+ * cpu cores. Calibration takes about 50 msecs. Returns TRUE if usable.
+ *
+ * The rate measured over 50 msecs is only accurate to a few ppm, and CLOCK_MONOTONIC
+ * gets slewed by NTP, so PsychOSReadTSCSeconds() recalibrates every second, see there.
+ */
+static psych_bool PsychOSCalibrateTSC(void)
+{
+#ifdef PSYCH_HAVE_TSC
+    unsigned int eax, ebx, ecx, edx;
+    char clocksource[32] = "";
+    struct timespec delay = { 0, 50000000 };
+    psych_uint64 ticks0, ticks1;
+    double secs0, secs1;
+    FILE *fd;
+
+    if (tscState) return((tscState > 0) ? TRUE : FALSE);
+    tscState = -1;
+
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8))) return(FALSE);
+
+    fd = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+    if (fd) {
+        if (NULL == fgets(clocksource, sizeof(clocksource), fd)) clocksource[0] = 0;
+        fclose(fd);
+    }
+    if (strncmp(clocksource, "tsc", 3)) return(FALSE);
+
+    PsychOSSampleTSC(&ticks0, &secs0);
+    nanosleep(&delay, NULL);
+    PsychOSSampleTSC(&ticks1, &secs1);
+
+    tscSecsPerTick = (secs1 - secs0) / (double) (ticks1 - ticks0);
+    tscBaseTicks = ticks1;
+    tscBaseSecs = secs1;
+    tscLastTicks = ticks1;
+    tscLastSecs = secs1;
+    tscRecalTicks = (psych_uint64) (kPsychTSCRecalSecs / tscSecsPerTick);
+    tscState = 1;
+
+    return(TRUE);
+#else
+    tscState = -1;
+    return(FALSE);
+#endif
+}
+
+#ifdef PSYCH_HAVE_TSC
+/* Recalibrate the TSC against CLOCK_MONOTONIC. Called by one thread at a time.
+ *
+ * The rate is measured over the whole interval since the last calibration sample.
+ * The error of TSC time against CLOCK_MONOTONIC is not corrected by a step, which
+ * could make time go backwards, but slewed out over the next interval, by at most
+ * kPsychTSCMaxSlew. The new base is TSC time at the sample, so time stays continuous.
+ */
+static void PsychOSRecalibrateTSC(void)
+{
+    psych_uint64 ticks;
+    double secs, predicted, rate, slew;
+
+    PsychOSSampleTSC(&ticks, &secs);
+
+    // Another thread just did it?
+    if (ticks - tscLastTicks < tscRecalTicks) return;
+
+    rate = (secs - tscLastSecs) / (double) (ticks - tscLastTicks);
+    predicted = tscBaseSecs + (double) ((psych_int64) (ticks - tscBaseTicks)) * tscSecsPerTick;
+
+    slew = (secs - predicted) / kPsychTSCRecalSecs;
+    if (slew > kPsychTSCMaxSlew) slew = kPsychTSCMaxSlew;
+    if (slew < -kPsychTSCMaxSlew) slew = -kPsychTSCMaxSlew;
+
+    tscSeq++;
+    PsychMemoryBarrier();
+    tscBaseTicks = ticks;
+    tscBaseSecs = predicted;
+    tscSecsPerTick = rate * (1.0 + slew);
+    PsychMemoryBarrier();
+    tscSeq++;
+
+    tscLastTicks = ticks;
+    tscLastSecs = secs;
+}
+
+/* Return TSC time in seconds, and recalibrate if it is due.
+ *
+ * TSC time follows CLOCK_MONOTONIC, including its NTP slewing, with a lag of one
+ * recalibration interval of kPsychTSCRecalSecs. Within an interval, the error is
+ * the rate error of the last measurement times the elapsed time, typically well
+ * below 1 usec, plus the residual of the previous error still being slewed out,
+ * plus the sampling error of PsychOSSampleTSC() of some tens of nanoseconds.
+ *
+ * The reader side of the seqlock only needs compiler barriers, as x86 doesn't
+ * reorder loads against other loads.
+ */
+static double PsychOSReadTSCSeconds(void)
+{
+    psych_uint64 ticks;
+    unsigned int seq;
+    double secs;
+
+    do {
+        seq = tscSeq;
+        __asm__ __volatile__("" ::: "memory");
+        ticks = __rdtsc();
+        secs = tscBaseSecs + (double) ((psych_int64) (ticks - tscBaseTicks)) * tscSecsPerTick;
+        __asm__ __volatile__("" ::: "memory");
+    } while ((seq & 1) || (seq != tscSeq));
+
+    if ((ticks - tscLastTicks >= tscRecalTicks) && __sync_bool_compare_and_swap(&tscRecalBusy, 0, 1)) {
+        PsychOSRecalibrateTSC();
+        PsychMemoryBarrier();
+        tscRecalBusy = 0;
+    }
+
+    return(secs);
+}
+#endif
+
+/* Select the time base for GetSecs et al. from environment variable PSYCH_TIMEBASE.
+ * Each mex module has its own copy of the time glue, so this setting must be the same
+ * for all of them, which is why it is not switchable at runtime.
+ */
+static void PsychOSInitTimeBase(void)
+{
+    char *env = getenv("PSYCH_TIMEBASE");
+    int i;
+
+    timeBase = kPsychTimeBaseRealtime;
+    if (env && env[0]) {
+        for (i = 0; i < kPsychTimeBaseCount; i++) if (!strcmp(env, timeBaseNames[i])) timeBase = i;
+        if (strcmp(env, timeBaseNames[timeBase])) printf("PTB-WARNING: Unknown time base '%s' requested via PSYCH_TIMEBASE. Using '%s' instead.\n", env, timeBaseNames[timeBase]);
+    }
+
+    #ifndef CLOCK_MONOTONIC_RAW
+    if (timeBase == kPsychTimeBaseMonotonicRaw) {
+        printf("PTB-WARNING: Time base 'monotonicraw' not supported by this system. Using 'monotonic' instead.\n");
+        timeBase = kPsychTimeBaseMonotonic;
+    }
+    #endif
+
+    if ((timeBase == kPsychTimeBaseTSC) && !PsychOSCalibrateTSC()) {
+        printf("PTB-WARNING: Time base 'tsc' requested, but the TSC is not invariant or not trusted by the kernel. Using 'monotonic' instead.\n");
+        timeBase = kPsychTimeBaseMonotonic;
+    }
+
+    switch (timeBase) {
+        case kPsychTimeBaseRealtime:
+            timeBaseClockId = CLOCK_REALTIME;
+        break;
+
+        #ifdef CLOCK_MONOTONIC_RAW
+        case kPsychTimeBaseMonotonicRaw:
+            timeBaseClockId = CLOCK_MONOTONIC_RAW;
+        break;
+        #endif
+
+        default:
+            timeBaseClockId = CLOCK_MONOTONIC;
+    }
+}
+
+/* Per-thread estimate of the wakeup latency of clock_nanosleep(), ie. of how late it wakes up
+ * after the requested time: A decaying estimate of the waitPercentile'th percentile of observed
+ * latencies, which moves up by waitPercentile/100 steps if a latency is above it and down by
+ * 1 - waitPercentile/100 steps otherwise, so only that fraction of latencies stays above it.
+ * Waits shorter than the spin window don't sleep, so they also move it down, otherwise it
+ * could get stuck after an outlier. A deadline miss moves it halfway to the latency of the
+ * miss immediately. The spin window, ie. the time we busy-wait before a deadline, is the
+ * estimate plus a small margin. -1 = not yet set.
+ */
+static __thread double  waitLatencyEstimate = -1;
+static __thread unsigned int waitMissedCount = 0;
+static double           waitPercentile = 95;
+#define kPsychWaitSpinMargin 0.00002
+
+// Wait statistics, shared by all threads:
+static pthread_mutex_t  waitStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static PsychWaitStats   waitStats;
+static const double     waitStatsBinEdges[kPsychWaitStatsBins] = { 0, 0.000001, 0.000002, 0.000005, 0.00001, 0.00002, 0.00005, 0.0001,
+                                                                   0.0002, 0.0005, 0.001, 0.002, 0.005, 0.01, 0.02 };
+
+static void PsychWaitStatsAdd(double *histogram, double secs)
+{
+  int i;
+
+  for (i = kPsychWaitStatsBins - 1; (i > 0) && (secs < waitStatsBinEdges[i]); i--);
+  histogram[i]++;
+}
+
+/* Return spin window of calling thread in seconds: */
+double PsychOSGetWaitSpinWindow(void)
+{
+  double window;
+
+  // Threads start with the global sleepwait_threshold, calibrated to the clock resolution:
+  if (waitLatencyEstimate < 0) waitLatencyEstimate = sleepwait_threshold;
+
+  window = waitLatencyEstimate + kPsychWaitSpinMargin;
+  if (window < 100 * clockinc) window = 100 * clockinc;
+  if (window > 0.01) window = 0.01;
+
+  return(window);
+}
+
+/* Set percentile of wakeup latencies to cover by the spin window, return old setting. Values
+ * outside 0 - 100 only return the current setting.
+ */
+double PsychOSSetWaitPercentile(double percentile)
+{
+  double old = waitPercentile;
+
+  if ((percentile >= 0) && (percentile <= 100)) waitPercentile = percentile;
+  return(old);
+}
+
+/* Return wait statistics of all threads since start or last reset, and optionally reset them: */
+void PsychOSGetWaitStats(PsychWaitStats *stats, psych_bool reset)
+{
+  pthread_mutex_lock(&waitStatsMutex);
+  if (stats) *stats = waitStats;
+  if (reset) memset(&waitStats, 0, sizeof(waitStats));
+  pthread_mutex_unlock(&waitStatsMutex);
+}
+
+/* Return lower edges of the histogram bins of PsychWaitStats in seconds: */
+const double* PsychOSGetWaitStatsBinEdges(void)
+{
+  return(waitStatsBinEdges);
+}
+
 void PsychWaitUntilSeconds(double whenSecs)
 {
   struct timespec rqtp;
-  double targettime;
-  static unsigned int missed_count=0;
-  double now=0.0;
+  double targettime, sleeptime, window, latency, step;
+  double now=0.0, tStart, tSpin;
+  psych_bool slept = FALSE;
   int rc;
 
   // Get current time:
@@ -59,20 +351,28 @@ void PsychWaitUntilSeconds(double whenSecs)
 
   // If the deadline has already passed, we do nothing and return immediately:
   if (now >= whenSecs) return;
+  tStart = now;
 
-  // Waiting stage 1: If we have more than sleepwait_threshold seconds left
-  // until the deadline, we call the OS usleep() function, so the
-  // CPU gets released for (difference - sleepwait_threshold) seconds to other processes and threads.
+  // Waiting stage 1: If we have more than our spin window seconds left
+  // until the deadline, we call the OS clock_nanosleep() function, so the
+  // CPU gets released for (difference - window) seconds to other processes and threads.
   // -> Good for general system behaviour and for lowered power-consumption (longer battery runtime for
   // Laptops) as the CPU can go idle if nothing else to do...
 
-  // Set an absolute deadline of whenSecs - sleepwait_threshold. We busy-wait the last few microseconds
-  // to take scheduling jitter/delays gracefully into account:
-  targettime    = whenSecs - sleepwait_threshold;
+  // Set an absolute deadline of whenSecs - window. We busy-wait the last few microseconds
+  // to take scheduling jitter/delays gracefully into account. The window is sized per
+  // thread from the wakeup latencies observed by this thread:
+  window = PsychOSGetWaitSpinWindow();
+  targettime    = whenSecs - window;
 
-  // Convert targettime to timespec for the Posix clock functions:
-  rqtp.tv_sec   = (unsigned long long) targettime;
-  rqtp.tv_nsec = ((targettime - (double) rqtp.tv_sec) * (double) 1e9);  
+  // clock_nanosleep() can only sleep on CLOCK_REALTIME or CLOCK_MONOTONIC. Map
+  // targettime to CLOCK_MONOTONIC unless it already is in one of these clocks:
+  sleeptime = targettime;
+  if ((timeBase != kPsychTimeBaseRealtime) && (timeBase != kPsychTimeBaseMonotonic)) sleeptime = PsychOSRefTimeToMonotonic(targettime);
+
+  // Convert sleeptime to timespec for the Posix clock functions:
+  rqtp.tv_sec   = (unsigned long long) sleeptime;
+  rqtp.tv_nsec = ((sleeptime - (double) rqtp.tv_sec) * (double) 1e9);  
 
   // Use clock_nanosleep() to high-res sleep until targettime, repeat if that gets
   // prematurely interrupted for whatever reason...
@@ -85,43 +385,66 @@ void PsychWaitUntilSeconds(double whenSecs)
     // cause inconsistencies to other times reported by different useful system services which all measure
     // against wall clock, and in practice, the effect of NTP adjustments is minimal or negligible, as these
     // never create backwards running time or large timewarps, only 1 ppm level adjustments per second, ie,
-    // the effect is way below the sleepwait_threshold for any reasonable sleep time -- easily compensated by
+    // the effect is way below the spin window for any reasonable sleep time -- easily compensated by
     // our hybrid approach...
     // We use TIMER_ABSTIME, so we are totally drift-free and restartable in case our sleep gets interrupted by
     // signals. If clock_nanosleep gets EINTR - Interrupted by a posix signal, we simply loop and restart the
     // sleep. If it returns a different error condition, we abort sleep iteration -- something would be seriously
     // wrong... 
-    if ((rc = clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &rqtp, NULL)) && (rc != EINTR)) break;
+    // If a monotonic time base was selected via PSYCH_TIMEBASE, we sleep on CLOCK_MONOTONIC instead.
+    if ((rc = clock_nanosleep((timeBase == kPsychTimeBaseRealtime) ? CLOCK_REALTIME : CLOCK_MONOTONIC, TIMER_ABSTIME, &rqtp, NULL)) && (rc != EINTR)) break;
 
     // Update our 'now' time for reiterating or continuing with busy-sleep...
     PsychGetPrecisionTimerSeconds(&now);
+    slept = TRUE;
   }
 
-  // Waiting stage 2: We are less than sleepwait_threshold seconds away from deadline.
+  // Update wakeup latency estimate of this thread, as described above:
+  latency = now - targettime;
+  step = 0.05 * waitLatencyEstimate + 0.000001;
+  if (slept && (latency > waitLatencyEstimate)) waitLatencyEstimate += step * waitPercentile / 100;
+  else waitLatencyEstimate -= step * (1 - waitPercentile / 100);
+  if (waitLatencyEstimate < 0) waitLatencyEstimate = 0;
+
+  // Waiting stage 2: We are less than window seconds away from deadline.
   // Perform busy-waiting until deadline reached:
+  tSpin = now;
   while(now < whenSecs) PsychGetPrecisionTimerSeconds(&now);
 
   // Check for deadline-miss of more than 0.1 ms:
   if (now - whenSecs > 0.0001) {
     // Deadline missed by over 0.1 ms.
-    missed_count++;
-    // As long as the threshold is below a msec, immediately increase by 100 microsecs...
-    if (sleepwait_threshold < 0.001) sleepwait_threshold+=0.0001;
-
-    // If threshold has reached 1 msec, we require multiple consecutive misses before increasing any further:
-    if (missed_count>5) {
-      // Too many consecutive misses. Increase our threshold for sleep-waiting
-      // by 0.1 ms until it reaches max. 10 ms.
-      if (sleepwait_threshold < 0.01) sleepwait_threshold+=0.0001;
-      printf("PTB-WARNING: Wait-Deadline missed for %i consecutive times (Last miss %lf ms). New sleepwait_threshold is %lf ms.\n",
-	     missed_count, (now - whenSecs)*1000.0f, sleepwait_threshold*1000.0f);
+    waitMissedCount++;
+
+    // If we woke up too late from sleep, widen the spin window immediately:
+    if (slept && (latency > waitLatencyEstimate)) waitLatencyEstimate += (((latency < 0.01) ? latency : 0.01) - waitLatencyEstimate) / 2;
+
+    // Report repeated consecutive misses:
+    if (waitMissedCount>5) {
+      printf("PTB-WARNING: Wait-Deadline missed for %i consecutive times (Last miss %lf ms). New spin window is %lf ms.\n",
+	     waitMissedCount, (now - whenSecs)*1000.0f, PsychOSGetWaitSpinWindow()*1000.0f);
     }
   }
   else {
     // No miss detected. Reset counter...
-    missed_count=0;
+    waitMissedCount=0;
   }
 
+  // Account for statistics:
+  pthread_mutex_lock(&waitStatsMutex);
+  waitStats.waits++;
+  waitStats.totalWaitSecs += now - tStart;
+  waitStats.totalSpinSecs += now - tSpin;
+  if (now - whenSecs > 0.0001) waitStats.missedDeadlines++;
+  if (now - whenSecs > waitStats.maxLatenessSecs) waitStats.maxLatenessSecs = now - whenSecs;
+  PsychWaitStatsAdd(waitStats.latenessHistogram, now - whenSecs);
+  PsychWaitStatsAdd(waitStats.spinHistogram, now - tSpin);
+  if (slept) {
+    waitStats.sleeps++;
+    PsychWaitStatsAdd(waitStats.sleepLatencyHistogram, latency);
+  }
+  pthread_mutex_unlock(&waitStatsMutex);
+
   // Ready.
   return;
 }
@@ -164,17 +487,20 @@ void PsychWaitIntervalSeconds(double delaySecs)
  */
 void PsychYieldIntervalSeconds(double delaySecs)
 {
+	double window;
+
 	if (delaySecs <= 0) {
 		// Yield cpu for remainder of this timeslice:
 		sched_yield();
 	}
 	else {
 		// On Linux we use standard wait ops - they're good enough for us.
-		// However, we make sure that the wait lasts at least 2x the sleepwait_threshold,
+		// However, we make sure that the wait lasts at least 2x the spin window,
 		// so the cpu gets certainly released to other threads, instead of getting hogged
 		// by busy-waiting for too short delaySecs intervals - which would be detrimental
 		// to the goals of PsychYieldIntervalSeconds():
-		delaySecs = (delaySecs > 2.0 * sleepwait_threshold) ? delaySecs : (2.0 * sleepwait_threshold);
+		window = PsychOSGetWaitSpinWindow();
+		delaySecs = (delaySecs > 2.0 * window) ? delaySecs : (2.0 * window);
 		PsychWaitIntervalSeconds(delaySecs);
 	}
 }
@@ -190,10 +516,16 @@ double	PsychGetKernelTimebaseFrequencyHz(void)
 
 void PsychInitTimeGlue(void)
 {
+  double now;
+
   // TODO: Add Mutex init code for the timeglue mutex!
   
   // Set this, although its totally pointless on our implementation...
   PsychEstimateGetSecsValueAtTickCountZero();
+
+  // Select time base and do the TSC calibration if needed, now at module load time
+  // on the main thread, instead of at the first time query:
+  PsychGetPrecisionTimerSeconds(&now);
 }
 
 /* Called at module shutdown/jettison time: */
@@ -227,7 +559,7 @@ void PsychGetPrecisionTimerTicksMinimumDelta(psych_uint32 *delta)
 
   // We return the real clock tick resolution in microseconds, as 1 tick == 1 microsec
   // in our implementation.
-  clock_getres(CLOCK_REALTIME, &res);
+  clock_getres(timeBaseClockId, &res);
   *delta = (psych_uint32) ((((double) res.tv_sec) + ((double) res.tv_nsec / 1e9)) * 1e6);
 }
 
@@ -258,46 +590,130 @@ double PsychOSGetLinuxMonotonicTime(void)
  * Map given input time value monotonicTime to PTB reference time if
  * neccessary, pass-through otherwise.
  *
- * Can conditionally convert from CLOCK_MONOTONIC time to reftime, e.g.,
- * to CLOCK_REALTIME aka gettimeofday().
+ * The input can be in CLOCK_MONOTONIC time or in CLOCK_REALTIME aka
+ * gettimeofday() time. Both are far apart, so we find out which one it
+ * is by comparing with the current value of both clocks, then remap
+ * from that clock to the time base selected for GetSecs, unless it
+ * already is that time base.
  *
  */
 double PsychOSMonotonicToRefTime(double monotonicTime)
 {
-    double now, now2, tMonotonic;
-    
-    // Get current reftime:
-    PsychGetAdjustedPrecisionTimerSeconds(&now);
-    // Get current CLOCK_MONOTONIC time:
+    double now, now2, tClock, tMonotonic, tRealtime;
+    psych_bool isMonotonic;
+    struct timespec ts;
+
+    // Get current CLOCK_MONOTONIC and CLOCK_REALTIME time:
     tMonotonic = PsychOSGetLinuxMonotonicTime();
-    
-    // Given input monotonicTime time value closer to tMonotonic than to GetSecs time?
-    if (fabs(monotonicTime - tMonotonic) < fabs(monotonicTime - now)) {
-        // Timestamps are in monotonic time! Need to remap.
-        // Requery reference and monotonic time in a retry-loop
-        // to make sure remapping error is tighlty bounded to max. 20 usecs:
-        do {
-            // Get current reftime:
-            PsychGetAdjustedPrecisionTimerSeconds(&now);
-            // Get current CLOCK_MONOTONIC time:
-            tMonotonic = PsychOSGetLinuxMonotonicTime();
-            // Requery to make sure mapping is tight:
-            PsychGetAdjustedPrecisionTimerSeconds(&now2);
-        } while (now2 - now > 0.000020);
-        
-        // Computer average of both timestamps to get best estimate of "now":
-        now = (now + now2) / 2;
-        
-        // tMonotonic shall be the offset between GetSecs and monotonic time,
-        // i.e., the offset that needs to be added to monotonic timestamps to
-        // remap them to GetSecs time:
-        tMonotonic = now - tMonotonic;
-        
-        // Correct timestamp by adding corrective offset:
-        monotonicTime += tMonotonic;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    tRealtime = (double) ts.tv_sec + ((double) ts.tv_nsec / (double) 1e9);
+
+    // Given input monotonicTime time value closer to tMonotonic than to tRealtime?
+    isMonotonic = (fabs(monotonicTime - tMonotonic) < fabs(monotonicTime - tRealtime)) ? TRUE : FALSE;
+
+    // Already in our reference time base? Then we are done:
+    if ((isMonotonic && (timeBase == kPsychTimeBaseMonotonic)) || (!isMonotonic && (timeBase == kPsychTimeBaseRealtime))) return(monotonicTime);
+
+    // Timestamps need remapping.
+    // Requery reference and clock time in a retry-loop
+    // to make sure remapping error is tighlty bounded to max. 20 usecs:
+    do {
+        // Get current reftime:
+        PsychGetAdjustedPrecisionTimerSeconds(&now);
+        // Get current clock time:
+        clock_gettime((isMonotonic) ? CLOCK_MONOTONIC : CLOCK_REALTIME, &ts);
+        // Requery to make sure mapping is tight:
+        PsychGetAdjustedPrecisionTimerSeconds(&now2);
+    } while (now2 - now > 0.000020);
+
+    // Computer average of both timestamps to get best estimate of "now":
+    now = (now + now2) / 2;
+
+    // tClock shall be the offset between GetSecs and the clock,
+    // i.e., the offset that needs to be added to clock timestamps to
+    // remap them to GetSecs time:
+    tClock = now - ((double) ts.tv_sec + ((double) ts.tv_nsec / (double) 1e9));
+
+    // Correct timestamp by adding corrective offset:
+    return(monotonicTime + tClock);
+}
+
+/* PsychOSRefTimeToMonotonic(t)
+ *
+ * Map given PTB reference time refTime to CLOCK_MONOTONIC time, e.g., for
+ * sleeping until refTime via clock_nanosleep(), or for comparing with
+ * timestamps of a subsystem which uses CLOCK_MONOTONIC time.
+ *
+ */
+double PsychOSRefTimeToMonotonic(double refTime)
+{
+    double now, now2, tMonotonic;
+
+    if (timeBase == kPsychTimeBaseMonotonic) return(refTime);
+
+    // Same tightly bounded clock calibration as in PsychOSMonotonicToRefTime():
+    do {
+        PsychGetAdjustedPrecisionTimerSeconds(&now);
+        tMonotonic = PsychOSGetLinuxMonotonicTime();
+        PsychGetAdjustedPrecisionTimerSeconds(&now2);
+    } while (now2 - now > 0.000020);
+
+    return(refTime - (now + now2) / 2 + tMonotonic);
+}
+
+/* PsychOSGetTimeBase() -- Return time base used for GetSecs et al., one of kPsychTimeBaseXXX. */
+int PsychOSGetTimeBase(void)
+{
+    return(timeBase);
+}
+
+/* PsychOSGetTimeBaseName() -- Return name of given time base, as used for PSYCH_TIMEBASE. */
+const char* PsychOSGetTimeBaseName(int whichBase)
+{
+    return(((whichBase >= 0) && (whichBase < kPsychTimeBaseCount)) ? timeBaseNames[whichBase] : "unknown");
+}
+
+/* PsychOSGetTimeBaseSeconds() -- Query any of the supported time bases, e.g., for benchmarking.
+ *
+ * Returns time of time base 'whichBase' in seconds in 'secs', without any checking or
+ * adjustment, and TRUE on success, or FALSE if that time base isn't supported. The TSC
+ * gets calibrated at first query, if it wasn't already.
+ */
+psych_bool PsychOSGetTimeBaseSeconds(int whichBase, double *secs)
+{
+    struct timespec ts;
+    clockid_t clockId;
+
+    switch (whichBase) {
+        case kPsychTimeBaseRealtime:
+            clockId = CLOCK_REALTIME;
+        break;
+
+        case kPsychTimeBaseMonotonic:
+            clockId = CLOCK_MONOTONIC;
+        break;
+
+        #ifdef CLOCK_MONOTONIC_RAW
+        case kPsychTimeBaseMonotonicRaw:
+            clockId = CLOCK_MONOTONIC_RAW;
+        break;
+        #endif
+
+        #ifdef PSYCH_HAVE_TSC
+        case kPsychTimeBaseTSC:
+            if ((tscState <= 0) && !PsychOSCalibrateTSC()) return(FALSE);
+            *secs = PsychOSReadTSCSeconds();
+            return(TRUE);
+        #endif
+
+        default:
+            return(FALSE);
     }
-    
-    return(monotonicTime);
+
+    if (clock_gettime(clockId, &ts)) return(FALSE);
+    *secs = (double) ts.tv_sec + ((double) ts.tv_nsec / (double) 1e9);
+
+    return(TRUE);
 }
 
 void PsychGetPrecisionTimerSeconds(double *secs)
@@ -308,14 +724,19 @@ void PsychGetPrecisionTimerSeconds(double *secs)
 
   // First time invocation?
   if (firstTime) {
+	// Select time base, as requested via PSYCH_TIMEBASE:
+	PsychOSInitTimeBase();
+
 	// We query the real clock tick resolution in secs and store in global clockinc.
 	// This is useful as a constraint on sleepwait_threshold etc. for our sleep routines...
-	clock_getres(CLOCK_REALTIME, &res);
+	clock_getres((timeBase == kPsychTimeBaseRealtime) ? CLOCK_REALTIME : CLOCK_MONOTONIC, &res);
 	clockinc = ((double) res.tv_sec) + ((double) res.tv_nsec / 1.e9);
 
 	// sleepwait_threshold should be significantly higher than the granularity of
 	// the underlying system clock, say 100x the resolution, but no higher than 10 msecs,
 	// and no lower than 100 microseconds. We start with optimistic 250 microseconds...
+	// This is the starting value of the spin window of each thread, which then adapts
+	// to the wakeup latencies observed by that thread, see PsychWaitUntilSeconds().
 	sleepwait_threshold = 0.00025;
 	if (sleepwait_threshold < 100 * clockinc) sleepwait_threshold = 100 * clockinc;
 	if (sleepwait_threshold > 0.010) sleepwait_threshold = 0.010;
@@ -326,20 +747,32 @@ void PsychGetPrecisionTimerSeconds(double *secs)
 	firstTime = FALSE;
   }
 
-  // We use gettimeofday() - It works with microsecond resolution and
+  // We use clock_gettime() - It works with nanosecond resolution and
   // is implemented via the highest precision time source on each
   // Linux system, e.g., the processors performance counters on
-  // Intel Pentium systems. Actually, the resolution of the underlying
-  // clocksource is often much better than 1 microsecond, e.g., nanoseconds,
-  // but Linux chooses always the highest precision reliable source, so in
+  // Intel Pentium systems, without a syscall via the vDSO on modern systems.
+  // Linux chooses always the highest precision reliable source, so in
   // case TSC's are broken and HPET's are not available and ACPI PM-Timers
   // aren't available, it could be a worse than 1 usec source, although this
   // is extremely unlikely...
+  // By default we use CLOCK_REALTIME aka gettimeofday() time. PSYCH_TIMEBASE
+  // can select CLOCK_MONOTONIC or CLOCK_MONOTONIC_RAW instead, which are immune
+  // to wall clock steps, or direct reads of a calibrated invariant TSC, which
+  // are a bit cheaper still:
   static double oldss = -1;
   double ss;
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  ss = ((double) tv.tv_sec) + (((double) tv.tv_usec) / 1000000.0);
+  struct timespec tv;
+
+  #ifdef PSYCH_HAVE_TSC
+  if (timeBase == kPsychTimeBaseTSC) {
+	ss = PsychOSReadTSCSeconds();
+  }
+  else
+  #endif
+  {
+	clock_gettime(timeBaseClockId, &tv);
+	ss = ((double) tv.tv_sec) + (((double) tv.tv_nsec) / 1e9);
+  }
 
   // Some correctness checks against last queried value, if initialized:
   if (oldss > -1) {
@@ -659,11 +1092,12 @@ int PsychWaitCondition(psych_condition* condition, psych_mutex* mutex)
 int PsychTimedWaitCondition(psych_condition* condition, psych_mutex* mutex, double maxwaittimesecs)
 {
 	struct timespec abstime;
-	double tnow;
 
-	// Convert relative wait time to absolute system time:
-	PsychGetAdjustedPrecisionTimerSeconds(&tnow);
-	maxwaittimesecs+=tnow;
+	// Convert relative wait time to absolute system time. pthread_cond_timedwait()
+	// waits on CLOCK_REALTIME, which is not our time base if PSYCH_TIMEBASE selected
+	// a different one, so query that clock directly:
+	clock_gettime(CLOCK_REALTIME, &abstime);
+	maxwaittimesecs += (double) abstime.tv_sec + ((double) abstime.tv_nsec / 1e9);
 
 	// Split maxwaittimesecs in...
 		
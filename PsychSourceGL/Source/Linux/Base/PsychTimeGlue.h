@@ -71,5 +71,34 @@ const char* PsychSupportStatus(void);
 // Linux specific: CLOCK_MONOTONIC time in seconds -- Usually the system uptime:
 double PsychOSGetLinuxMonotonicTime(void);
 double PsychOSMonotonicToRefTime(double monotonicTime);
+double PsychOSRefTimeToMonotonic(double refTime);
+
+// Linux specific: Time bases for GetSecs, selectable via environment variable PSYCH_TIMEBASE:
+#define kPsychTimeBaseRealtime      0   // "realtime": CLOCK_REALTIME aka gettimeofday(). The default.
+#define kPsychTimeBaseMonotonic     1   // "monotonic": CLOCK_MONOTONIC.
+#define kPsychTimeBaseMonotonicRaw  2   // "monotonicraw": CLOCK_MONOTONIC_RAW, not slewed by NTP.
+#define kPsychTimeBaseTSC           3   // "tsc": Invariant TSC, calibrated against CLOCK_MONOTONIC.
+#define kPsychTimeBaseCount         4
+int PsychOSGetTimeBase(void);
+const char* PsychOSGetTimeBaseName(int whichBase);
+psych_bool PsychOSGetTimeBaseSeconds(int whichBase, double *secs);
+
+// Linux specific: Statistics of PsychWaitUntilSeconds() et al.:
+#define kPsychWaitStatsBins 15
+typedef struct PsychWaitStats {
+    double waits;                                       // Number of waits.
+    double sleeps;                                      // Number of waits which slept before spinning.
+    double missedDeadlines;                             // Number of waits which ended over 0.1 msecs late.
+    double totalWaitSecs;                               // Total time spent waiting.
+    double totalSpinSecs;                               // Total time spent busy-waiting.
+    double maxLatenessSecs;                             // Maximum lateness wrt. deadline.
+    double latenessHistogram[kPsychWaitStatsBins];      // Lateness wrt. deadline.
+    double sleepLatencyHistogram[kPsychWaitStatsBins];  // Wakeup latency of the sleep wrt. its target time.
+    double spinHistogram[kPsychWaitStatsBins];          // Duration of busy-waiting.
+} PsychWaitStats;
+void PsychOSGetWaitStats(PsychWaitStats *stats, psych_bool reset);
+const double* PsychOSGetWaitStatsBinEdges(void);
+double PsychOSGetWaitSpinWindow(void);
+double PsychOSSetWaitPercentile(double percentile);
 //end include once
 #endif
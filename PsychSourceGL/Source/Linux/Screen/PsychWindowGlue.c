@@ -352,6 +352,7 @@ psych_bool PsychOSOpenOnscreenWindow(PsychScreenSettingsType *screenSettings, Ps
     // Init userspace GL context to safe default:
     windowRecord->targetSpecific.glusercontextObject = NULL;
     windowRecord->targetSpecific.glswapcontextObject = NULL;
+    windowRecord->targetSpecific.gluploadcontextObject = NULL;
 
     // Which display depth is requested?
     depth = PsychGetValueFromDepthStruct(0, &(screenSettings->depth));
@@ -1432,6 +1433,12 @@ void PsychOSCloseWindow(PsychWindowRecordType *windowRecord)
     glXDestroyContext(dpy, windowRecord->targetSpecific.glswapcontextObject);
     windowRecord->targetSpecific.glswapcontextObject=NULL;
 
+    // Delete texture upload context, if any:
+    if (windowRecord->targetSpecific.gluploadcontextObject) {
+        glXDestroyContext(dpy, windowRecord->targetSpecific.gluploadcontextObject);
+        windowRecord->targetSpecific.gluploadcontextObject = NULL;
+    }
+
     // Delete userspace context, if any:
     if (windowRecord->targetSpecific.glusercontextObject) {
         glXDestroyContext(dpy, windowRecord->targetSpecific.glusercontextObject);
@@ -2584,6 +2591,38 @@ void PsychOSSetUserGLContext(PsychWindowRecordType *windowRecord, psych_bool cop
     }
 }
 
+/* PsychOSCreateUploadContext()
+ *
+ * Create the rendering context for background texture uploads of Screen('MakeTexture') of onscreen
+ * window 'windowRecord', sharing all heavyweight ressources with its main context, unless it already
+ * exists. Called on first use, so windows which never use background uploads don't pay for an extra
+ * context. The fbconfig of the main context is looked up again, so the upload context can be bound
+ * to the same window. Returns TRUE if the context is available.
+ */
+psych_bool PsychOSCreateUploadContext(PsychWindowRecordType *windowRecord)
+{
+    Display *dpy = windowRecord->targetSpecific.deviceContext;
+    GLXFBConfig *fbconfig = NULL;
+    int attrib[3] = { GLX_FBCONFIG_ID, 0, None };
+    int nrconfigs = 0;
+
+    if (windowRecord->targetSpecific.gluploadcontextObject) return(TRUE);
+
+    PsychLockDisplay();
+    if ((Success == glXQueryContext(dpy, windowRecord->targetSpecific.contextObject, GLX_FBCONFIG_ID, &attrib[1])) &&
+        (fbconfig = glXChooseFBConfig(dpy, PsychGetXScreenIdForScreen(windowRecord->screenNumber), attrib, &nrconfigs)) && (nrconfigs > 0)) {
+        windowRecord->targetSpecific.gluploadcontextObject = glXCreateNewContext(dpy, fbconfig[0], GLX_RGBA_TYPE, windowRecord->targetSpecific.contextObject, True);
+    }
+    if (fbconfig) XFree(fbconfig);
+    PsychUnlockDisplay();
+
+    if ((windowRecord->targetSpecific.gluploadcontextObject == NULL) && (PsychPrefStateGet_Verbosity() > 3)) {
+        printf("PTB-INFO: Creating a private OpenGL context for background texture uploads failed. Asynchronous Screen('MakeTexture') will be synchronous.\n");
+    }
+
+    return((windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE);
+}
+
 /* PsychOSSetupFrameLock - Check if framelock / swaplock support is available on
  * the given graphics system implementation and try to enable it for the given
  * pair of onscreen windows.
@@ -38,6 +38,7 @@ void        PsychOSSetVBLSyncLevel(PsychWindowRecordType *windowRecord, int swap
 void        PsychOSSetGLContext(PsychWindowRecordType *windowRecord);
 void        PsychOSUnsetGLContext(PsychWindowRecordType *windowRecord);
 void        PsychOSSetUserGLContext(PsychWindowRecordType *windowRecord, psych_bool copyfromPTBContext);
+psych_bool  PsychOSCreateUploadContext(PsychWindowRecordType *windowRecord);
 double      PsychOSGetVBLTimeAndCount(PsychWindowRecordType *windowRecord, psych_uint64* vblCount);
 psych_bool  PsychOSSetupFrameLock(PsychWindowRecordType *masterWindow, PsychWindowRecordType *slaveWindow);
 psych_int64 PsychOSScheduleFlipWindowBuffers(PsychWindowRecordType *windowRecord, double tWhen, psych_int64 targetMSC, psych_int64 divisor, psych_int64 remainder, unsigned int specialFlags);
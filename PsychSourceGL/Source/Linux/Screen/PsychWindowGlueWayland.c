@@ -532,6 +532,8 @@ psych_bool PsychOSOpenOnscreenWindow(PsychScreenSettingsType * screenSettings, P
     // Init userspace GL context to safe default:
     windowRecord->targetSpecific.glusercontextObject = NULL;
     windowRecord->targetSpecific.glswapcontextObject = NULL;
+    windowRecord->targetSpecific.gluploadcontextObject = NULL;
+    windowRecord->targetSpecific.uploadconfigObject = NULL;
 
     // Default to use of one shared x-display connection "dpy" for all onscreen windows
     // on a given x-display and x-screen:
@@ -830,8 +832,8 @@ psych_bool PsychOSOpenOnscreenWindow(PsychScreenSettingsType * screenSettings, P
         }
     }
 
-    // Release config info:
-    waffle_config_destroy(config);
+    // Keep config info for creation of the background texture upload context on first use, release it at window close:
+    windowRecord->targetSpecific.uploadconfigObject = config;
 
     // Setup window transparency:
     if ((windowLevel >= 1000) && (windowLevel < 2000)) {
@@ -1161,6 +1163,18 @@ void PsychOSCloseWindow(PsychWindowRecordType * windowRecord)
     waffle_context_destroy(windowRecord->targetSpecific.glswapcontextObject);
     windowRecord->targetSpecific.glswapcontextObject = NULL;
 
+    // Delete texture upload context, if any:
+    if (windowRecord->targetSpecific.gluploadcontextObject) {
+        waffle_context_destroy(windowRecord->targetSpecific.gluploadcontextObject);
+        windowRecord->targetSpecific.gluploadcontextObject = NULL;
+    }
+
+    // Release config info for texture upload context:
+    if (windowRecord->targetSpecific.uploadconfigObject) {
+        waffle_config_destroy(windowRecord->targetSpecific.uploadconfigObject);
+        windowRecord->targetSpecific.uploadconfigObject = NULL;
+    }
+
     // Delete userspace context, if any:
     if (windowRecord->targetSpecific.glusercontextObject) {
         waffle_context_destroy(windowRecord->targetSpecific.glusercontextObject);
@@ -1644,6 +1658,30 @@ void PsychOSSetUserGLContext(PsychWindowRecordType * windowRecord, psych_bool co
     return;
 }
 
+/* PsychOSCreateUploadContext()
+ *
+ * Create the rendering context for background texture uploads of Screen('MakeTexture') of onscreen
+ * window 'windowRecord', sharing all heavyweight ressources with its main context, unless it already
+ * exists. Called on first use, so windows which never use background uploads don't pay for an extra
+ * context. Uses the config of the main context, kept around for this purpose until window close.
+ * Returns TRUE if the context is available.
+ */
+psych_bool PsychOSCreateUploadContext(PsychWindowRecordType *windowRecord)
+{
+    if (windowRecord->targetSpecific.gluploadcontextObject) return(TRUE);
+
+    PsychLockDisplay();
+    if (windowRecord->targetSpecific.uploadconfigObject)
+        windowRecord->targetSpecific.gluploadcontextObject = waffle_context_create(windowRecord->targetSpecific.uploadconfigObject, windowRecord->targetSpecific.contextObject);
+    PsychUnlockDisplay();
+
+    if ((windowRecord->targetSpecific.gluploadcontextObject == NULL) && (PsychPrefStateGet_Verbosity() > 3)) {
+        printf("PTB-INFO: Creating a private OpenGL context for background texture uploads failed. Asynchronous Screen('MakeTexture') will be synchronous.\n");
+    }
+
+    return((windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE);
+}
+
 /* PsychOSSetupFrameLock - Check if framelock / swaplock support is available on
  * the given graphics system implementation and try to enable it for the given
  * pair of onscreen windows.
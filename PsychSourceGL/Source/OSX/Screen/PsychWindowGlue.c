@@ -499,6 +499,7 @@ psych_bool PsychOSOpenOnscreenWindow(PsychScreenSettingsType *screenSettings, Ps
     windowRecord->targetSpecific.pixelFormatObject = NULL;
     windowRecord->targetSpecific.glusercontextObject = NULL;
     windowRecord->targetSpecific.glswapcontextObject = NULL;
+    windowRecord->targetSpecific.gluploadcontextObject = NULL;
 
     // Try to find matching pixelformat:
     error = CGLChoosePixelFormat(attribs, &(windowRecord->targetSpecific.pixelFormatObject), &numVirtualScreens);
@@ -746,6 +747,7 @@ void PsychOSCloseWindow(PsychWindowRecordType *windowRecord)
     CGLReleaseContext(windowRecord->targetSpecific.contextObject);
     if (windowRecord->targetSpecific.glusercontextObject) CGLReleaseContext(windowRecord->targetSpecific.glusercontextObject);
     if (windowRecord->targetSpecific.glswapcontextObject) CGLReleaseContext(windowRecord->targetSpecific.glswapcontextObject);
+    if (windowRecord->targetSpecific.gluploadcontextObject) CGLReleaseContext(windowRecord->targetSpecific.gluploadcontextObject);
 
     // Last reference to this screen? In that case we have to shutdown the fallback
     // vbl timestamping and vblank counting facilities for this screen:
@@ -939,6 +941,29 @@ void PsychOSSetVBLSyncLevel(PsychWindowRecordType *windowRecord, int swapInterva
     }
 }
 
+/* PsychOSCreateUploadContext()
+ *
+ * Create gluploadcontextObject - An OpenGL context for background texture uploads of Screen('MakeTexture')
+ * of onscreen window 'windowRecord', sharing all heavyweight ressources with its main context, unless it
+ * already exists. Called on first use, so windows which never use background uploads don't pay for an
+ * extra context. Returns TRUE if the context is available.
+ */
+psych_bool PsychOSCreateUploadContext(PsychWindowRecordType *windowRecord)
+{
+    CGLError error;
+
+    if (windowRecord->targetSpecific.gluploadcontextObject) return(TRUE);
+
+    error = CGLCreateContext(windowRecord->targetSpecific.pixelFormatObject, windowRecord->targetSpecific.contextObject, &(windowRecord->targetSpecific.gluploadcontextObject));
+    if (error) {
+        windowRecord->targetSpecific.gluploadcontextObject = NULL;
+        if (PsychPrefStateGet_Verbosity() > 3) printf("PTB-INFO: Creating a private OpenGL context for background texture uploads failed [%s]. Asynchronous Screen('MakeTexture') will be synchronous.\n", CGLErrorString(error));
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
 /* PsychOSSetupFrameLock - Check if framelock / swaplock support is available on
  * the given graphics system implementation and try to enable it for the given
  * pair of onscreen windows.
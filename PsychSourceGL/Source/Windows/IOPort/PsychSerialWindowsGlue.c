@@ -963,6 +963,11 @@ PsychError PsychIOOSConfigureSerialPort( PsychSerialDeviceRecord* device, const
         }
     }
 
+    if ((p = strstr(configString, "FramingMode=")) && !strstr(p, "FramingMode=None")) {
+        if (verbosity > 0) printf("FramingMode= settings other than None are not supported on MS-Windows!\n");
+        return(PsychError_user);
+    }
+
     if ((p = strstr(configString, "BlockingBackgroundRead="))) {
         if (1!=sscanf(p, "BlockingBackgroundRead=%i", &inint)) {
             if (verbosity > 0) printf("Invalid parameter for BlockingBackgroundRead= set!\n");
@@ -1401,6 +1406,28 @@ int PsychIOOSCheckError(PsychSerialDeviceRecord* device, char* inerrmsg)
     return((int) estatus);
 }
 
+int PsychIOOSWriteSerialPortAsync(PsychSerialDeviceRecord* device, void* writedata, unsigned int amount, double when, char* errmsg)
+{
+    // Asynchronous writes are not supported on MS-Windows:
+    sprintf(errmsg, "Error: 'WriteAsync' is not supported on MS-Windows.\n");
+    return(-1);
+}
+
+int PsychIOOSWriteSerialPortAsyncResult(PsychSerialDeviceRecord* device, int ticket, int waitForCompletion, char* errmsg, double* timestamps, int* nwritten)
+{
+    // Asynchronous writes are not supported on MS-Windows:
+    sprintf(errmsg, "Error: 'WriteAsyncResult' is not supported on MS-Windows.\n");
+    return(-1);
+}
+
+int PsychIOOSReadSerialPortPackets(PsychSerialDeviceRecord* device, unsigned int maxPackets, psych_bool maxPacketsGiven, int blocking, char* errmsg, PsychIOPortPackets* packets)
+{
+    // Packet framing background reads are not supported on MS-Windows:
+    memset(packets, 0, sizeof(PsychIOPortPackets));
+    sprintf(errmsg, "Error: Reading packets via 'FramingMode' is not supported on MS-Windows.\n");
+    return(-1);
+}
+
 int PsychIOOSBytesAvailableSerialPort(PsychSerialDeviceRecord* device)
 {
     COMSTAT dstatus;
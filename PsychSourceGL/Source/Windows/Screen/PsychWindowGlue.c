@@ -800,6 +800,7 @@ psych_bool PsychOSOpenOnscreenWindow(PsychScreenSettingsType *screenSettings, Ps
     // Init to safe default:
     windowRecord->targetSpecific.glusercontextObject = NULL;
     windowRecord->targetSpecific.glswapcontextObject = NULL;
+    windowRecord->targetSpecific.gluploadcontextObject = NULL;
 
     // Map the logical screen number to a device handle for the corresponding
     // physical display device: CGDirectDisplayID is currently typedef'd to a
@@ -1875,6 +1876,12 @@ void PsychOSCloseWindow(PsychWindowRecordType *windowRecord)
   wglDeleteContext(windowRecord->targetSpecific.glswapcontextObject);
   windowRecord->targetSpecific.glswapcontextObject=NULL;
 
+  // Delete texture upload context, if any:
+  if (windowRecord->targetSpecific.gluploadcontextObject) {
+        wglDeleteContext(windowRecord->targetSpecific.gluploadcontextObject);
+        windowRecord->targetSpecific.gluploadcontextObject = NULL;
+  }
+
   // Delete userspace context:
   if (windowRecord->targetSpecific.glusercontextObject) {
         wglDeleteContext(windowRecord->targetSpecific.glusercontextObject);
@@ -2514,6 +2521,31 @@ void PsychOSSetUserGLContext(PsychWindowRecordType *windowRecord, psych_bool cop
     }
 }
 
+/* PsychOSCreateUploadContext()
+ *
+ * Setup dedicated context for background texture uploads of Screen('MakeTexture') of onscreen window
+ * 'windowRecord', unless it already exists. It must share ressources with the master context to be useful.
+ * Called on first use, so windows which never use background uploads don't pay for an extra context.
+ * Returns TRUE if the context is available.
+ */
+psych_bool PsychOSCreateUploadContext(PsychWindowRecordType *windowRecord)
+{
+    if (windowRecord->targetSpecific.gluploadcontextObject) return(TRUE);
+
+    windowRecord->targetSpecific.gluploadcontextObject = wglCreateContext(windowRecord->targetSpecific.deviceContext);
+    if (windowRecord->targetSpecific.gluploadcontextObject &&
+        !wglShareLists(windowRecord->targetSpecific.contextObject, windowRecord->targetSpecific.gluploadcontextObject)) {
+        wglDeleteContext(windowRecord->targetSpecific.gluploadcontextObject);
+        windowRecord->targetSpecific.gluploadcontextObject = NULL;
+    }
+
+    if ((windowRecord->targetSpecific.gluploadcontextObject == NULL) && (PsychPrefStateGet_Verbosity() > 3)) {
+        printf("PTB-INFO: Creating a private OpenGL context for background texture uploads failed. Asynchronous Screen('MakeTexture') will be synchronous.\n");
+    }
+
+    return((windowRecord->targetSpecific.gluploadcontextObject) ? TRUE : FALSE);
+}
+
 /* PsychOSSetupFrameLock - Check if framelock / swaplock support is available on
  * the given graphics system implementation and try to enable it for the given
  * pair of onscreen windows.
@@ -48,6 +48,21 @@ function s=GetSecs(s,subscript)
 % reliability, acccuracy and performance. To our current knowledge, all
 % computers running a Linux 2.6 kernel have reliably working clocks.
 %
+% GetSecs time is gettimeofday() time by default, ie. CLOCK_REALTIME, which
+% can jump if the system wall clock gets set. You can select a different
+% time base by setting the environment variable PSYCH_TIMEBASE before
+% starting Octave or Matlab, so all mex files use the same time base:
+% 'monotonic' for CLOCK_MONOTONIC, which never jumps, 'monotonicraw' for
+% CLOCK_MONOTONIC_RAW, which isn't even slewed by NTP, or 'tsc' for direct
+% reads of the processors invariant timestamp counter, calibrated against
+% CLOCK_MONOTONIC at startup and recalibrated every second, so it follows
+% CLOCK_MONOTONIC with a typical error well below 1 microsecond. 'tsc' has
+% the lowest overhead per query, but is only available on x86 processors
+% with an invariant TSC that Linux uses as its clocksource. Otherwise 'monotonic' is used. Timestamps of other
+% system components, e.g., of display and sound drivers, get mapped into
+% the selected time base automatically. WaitSecs('ClockBenchmark') reports
+% cost per query, resolution and monotonicity of all time bases.
+%
 %
 % See also: WaitSecs, GetSecsTest, 
 
@@ -18,6 +18,14 @@ function r=WaitSecs(s,se)
 % even suitable for waiting a given interval, because errors can't accumulate:
 %
 % wakeup = WaitSecs('UntilTime', when);
+%
+% results = WaitSecs('ClockBenchmark' [, durationSecs=0.2]) benchmarks the
+% cost per query, resolution and monotonicity of the clocks usable as time
+% base for GetSecs. See "WaitSecs ClockBenchmark?" and "help GetSecs".
+%
+% stats = WaitSecs('Stats' [, reset=0][, percentile]) returns statistics of
+% lateness and busy-waiting of all waits on Linux, and allows to trade cpu
+% load against precision via the 'percentile' setting. See "WaitSecs Stats?".
 % 
 % TIMING ADVICE: the first time you access any MEX function or M file,
 % Matlab takes several hundred milliseconds to load it from disk.
@@ -47,9 +55,12 @@ function r=WaitSecs(s,se)
 % Linux: __________________________________________________________________
 %
 % WaitSecs always uses the POSIX realtime high-precision timing facilities
-% (clock_nanosleep(CLOCK_RT,...)). It sleeps the main MATLAB thread for the
+% (clock_nanosleep(CLOCK_RT,...), or CLOCK_MONOTONIC if a monotonic time
+% base was selected, see "help GetSecs"). It sleeps the main MATLAB thread for the
 % given wait period, surrendering CPU time to other processes while waiting.
-% WaitSecs is now safe to use at any priority setting.
+% WaitSecs is now safe to use at any priority setting. It busy-waits only for
+% the last fraction of a millisecond of a wait. This spin window adapts to the
+% wakeup latencies of the operating system observed by each thread.
 %
 % NB.: Use of a modern 2.6.x kernel is recommended, and many modern
 % distros, e.g., Ubuntu 7.1, offer the option of installing a special
@@ -330,6 +330,22 @@
 % drivers and advice the user to use this flag in such situations.
 %
 %
+% 2^29 == kPsychDontUseVertexStreaming
+% Do not copy the vertex arrays of Screen('DrawDots'), Screen('DrawLines')
+% and Screen('FillRect') with multiple rects into a streaming vertex buffer
+% object in video memory, but let OpenGL read them directly from the
+% matrices passed to Screen, as Psychtoolbox did in the past. This may help
+% with graphics drivers which have bugs with vertex buffer objects.
+%
+%
+% 2^30 == kPsychDontUseInstancedTextureBlits
+% Do not use instanced rendering for batches of textures drawn via
+% Screen('DrawTextures'), but compute the corners of all drawn texture
+% quads on the cpu and draw them from a vertex array. This is slower for
+% large numbers of textures, but may help with graphics drivers which have
+% bugs with instanced drawing.
+%
+%
 % --> It's always better to update your graphics drivers with fixed
 % versions or buy proper hardware than using these workarounds. They are
 % meant as a last ressort, e.g., if you need to get something going quickly
@@ -18,9 +18,13 @@
 %   Color3DLUTTest                  - Test PsychColorCorrection() method for 3D-CLUT color correction.
 %   ConvolutionKernelTest           - Test routine for correctness, accuracy and speed of PTB imaging convolution shaders.
 %   DatapixxGPUDitherpatternTest    - Low level diagnostic of GPU dithering bugs via Datapixx et al.
+%   DeferredDrawingBenchmark        - Benchmark frames of many small mixed primitives with and without deferred drawing.
 %   DeinterlacerTest                - Simple correctness test for GLSL video image deinterlacer. INCOMPLETE.
+%   DispatchOverheadBenchmark       - Measure the fixed overhead of an empty call into Psychtoolbox mex files.
+%   DrawDotsDataTypeBenchmark       - Benchmark DrawDots with coordinates as double, single and int16 matrices.
 %   DrawingIntoTexturesTest         - Tests if using a texture as an offscreen window, i.e., for drawing, works.
 %   DrawTextFontSwitchSpeedTest - Test speed of text drawing when switching between different font type/style/size settings.
+%   DrawTexturesInstancingBenchmark - Benchmark DrawTextures with many patches with and without instanced drawing.
 %   DriftTexturePrecisionTest       - Test subpixel accuracy of texture interpolators: What is the smallest
 %                                     fraction of a pixel that one can scroll, using built-in bilinear interpolation?
 %   FitCumNormYNTest                - Fit a cumulative normal to yes-no data.
@@ -30,6 +34,7 @@
 %   DaqTest                         - Test PsychHID and routines to control the  USB-1208FS digital acquistion device.
 %   DrawingStuffTest                - FrameRect, DrawLine, FillPoly, FramePoly.
 %   EventAvailTest                  - Test EventAvail
+%   EyelinkQueuedDataBenchmark      - Benchmark loss and throughput of Eyelink('GetQueuedData') with and without background drain thread.
 %   FillPolyTest                    - Test drawing concave polygons.
 %   FitConeFundamentalsTest         - Test/explore fitting CIE cone fundamentals with absorbance obtained from nomograms.
 %   FitWeibullTAFCTest              - Fit a Weibull to 2AFC data.
@@ -38,17 +43,24 @@
 %   FloatTexturePrecisionTest       - Test effective precision of floating point 16bpc textures.
 %   FrameSequentialStereoTest       - Test routine for timing and stimulus onset on quad-buffered frame-sequential stereo hardware.
 %   GetCharTest                     - Tests of GetChar.
+%   GetImageBenchmark               - Benchmark recording of frames via synchronous and asynchronous GetImage.
 %   GetSecsTest                     - Timing test of clock used by Psychtoolbox, e.g., GetSecs, WaitSecs, Screen...
 %   GraphicsDisplaySyncAcrossDualHeadsTest - Test synchronization of refresh cycles of different display heads.
 %   GraphicsDisplaySyncAcrossDualHeadsTestLinux - Linux version of the test.
+%   HIDReportsBenchmark             - Test and benchmark reception of USB-HID reports at high rates from a simulated device.
 %   HIDIntervalTest                 - Sample HID keyboard and mouse, plot distribution of detected event times.
 %   HighColorPrecisionDrawingTest   - Test drawing precision of a variety of Screen() functions, esp. wrt. high precision framebuffers.
 %   HighPrecisionLuminanceOutputDriversImagingPipelineTest - Test precision of a variety of high precision luminance device output drivers.
+%   IOPortPacketLatencyBenchmark    - Benchmark latency and cpu load of IOPort background serial reads with and without packet framing.
+%   IOPortWriteAsyncBenchmark       - Benchmark cpu time and timestamp accuracy of IOPort polling writes and queued asynchronous writes.
 %   JavaClockTest                   - Timing test of clock used by Java functions (e.g. GetChar)
+%   KbQueueEventBufferBenchmark     - Benchmark throughput of PsychHID keyboard queue event buffers for bursts of events.
 %   KeyboardLatencyTest             - Get a feeling for keyboard and mouse latency via some sound-based measurement procedure.
 %   LabLuvTest                      - Test routines that convert to CIELAB and CIELUV.
 %   LoadGenerator                   - Create cpu load by spinning in an infinite loop. Used in conjunction with FlipTimingWithRTBoxPhotoDiodeTest.
 %   LosslessMovieWritingTest        - Test lossless encoding and decoding of video in movie files.
+%   MakeTextureAsyncBenchmark       - Benchmark time blocked in MakeTexture for many large textures with and without asynchronous upload.
+%   MakeTextureConversionBenchmark  - Benchmark the conversion of image matrices into textures by MakeTexture.
 %   MakeTextureTimingTest           - Time memory allocation by MakeTexture
 %   MakeTextureTimingTest2          - Time texture creation -> upload -> destruction for given texture by MakeTexture et al.
 %   MatlabTimingTest                - Test for MATLAB timing glitch caused by sigsetjmp().
@@ -64,7 +76,13 @@
 %   PosterBatchAnalyzeTimestamps    - Batch analysis of timestamp logs generated by FlipTimingWithRTBoxPhotoDiodeTest for ECVP 2010 poster.
 %   PsychHIDTest                    - PsychHID MEX file for HID-compliant USB devices.
 %   PupilDiameterTest               - Test functions that compute pupil diameter from luminance.
+%   PsychPortAudioBufferFormatsTest - Test and benchmark of double, single, int16 and sound file input of PsychPortAudio buffers.
 %   PsychPortAudioDataPixxTimingTest - Test PsychPortAudio's timing with a DataPixx device and a audio line cable.
+%   PsychPortAudioMixerBenchmark    - Benchmark cpu cost of PsychPortAudio's master device mixer for the different SIMD kernel levels.
+%   PsychPortAudioOfflineTest       - Regression test and benchmark of PsychPortAudio offline devices. Works without sound hardware.
+%   PsychPortAudioRecordToFileTest  - Test of background streaming of captured sound to a file via PsychPortAudio('RecordToFile').
+%   PsychPortAudioResamplerTest     - Quality test and benchmark of PsychPortAudio's sample rate conversion of sound data.
+%   PsychPortAudioStressTest        - Stress test of lock-free status queries and volume changes against PsychPortAudio's audio thread.
 %   PsychPortAudioTimingTest        - Testsignal generator for test of PsychPortAudios timing with external measurement equipment.
 %   QuestTest                       - Some Quest simulations, more elaborate than QuestDemo.
 %   ResolutionTest                  - Use Screen Resolutions to print table of display resolutions.
@@ -74,13 +92,18 @@
 %   StandaloneTimingTest            - Test for timing glitch outside of MATLAB process. 
 %   StructsFileTest                 - Test routines for reading and writing struct arrays to text files.
 %   SyncedCLUTUpdateTest            - Visual test of clut write synching to vertical retrace.
+%   TempMemoryBenchmark             - Benchmark the temporary memory allocator of Screen with a typical call mix.
 %   TextBoundsTest                  - Test Screen('TestBounds')
 %   TextBugTest                     - Look for interference between
 %   TextFontTest                    - Test setting the text font.
 %   TextInitBugTest                 - Test for failure of 'DrawText' default font.
 %   TextInOffscreenWindowTest       - Compare text rendered into onscreen and offscreen windows. 
+%   TimeListTest                    - Exercise Screen's internal tagged timestamp list and print per call site timing statistics.
 %   TextureChannelsTest             - Test assignment of matrix layers to RGBA texture channels
 %   TextureTest                     - Exercise Screen('DrawTexture').
+%   TexturePoolBenchmark            - Benchmark drawing of many small textures with and without the texture pool of MakeTexture.
 %   TrolandTest                     - Colorimetric conversions.
 %   VBLSyncTest                     - Tests syncing of PTB-OSX to the vertical retrace.
+%   VertexStreamingBenchmark        - Benchmark batch drawing with and without streaming vertex buffers.
+%   WaitSecsJitterBenchmark         - Benchmark lateness and cpu cost of WaitSecs with and without cpu load. Linux only.
 %   WavelengthSamplingTest          - Test conversion between representations of wavelength sampling information.
@@ -0,0 +1,111 @@
+function results = DeferredDrawingBenchmark(numPrims, numFrames, screenNumber)
+% results = DeferredDrawingBenchmark([numPrims=2000][, numFrames=100][, screenNumber=max])
+%
+% Benchmark frames composed of many small primitives, drawn by individual
+% calls to Screen('FillRect'), Screen('DrawLine') and Screen('DrawTexture'),
+% with deferred drawing mode of Screen('DeferredDrawing') disabled and
+% enabled.
+%
+% Each frame consists of 'numPrims' primitives: Runs of 10 rects, 10 lines
+% and 10 textures at random positions and in random colors, repeated until
+% 'numPrims' calls are made, then a Screen('Flip') without sync to retrace.
+% In deferred drawing mode, each run is executed as one batch.
+%
+% Also draws the same frame once in both modes and reports the maximum
+% difference between the pixels read back via Screen('GetImage'), which
+% should be zero or close to zero.
+%
+% Returns a struct 'results' with the fields 'msecsImmediate' and
+% 'msecsDeferred' for the mean duration of a frame in milliseconds, and
+% 'maxDifference' for the maximum pixel difference.
+%
+% see also: PsychTests, VertexStreamingBenchmark
+
+if nargin < 1 || isempty(numPrims)
+    numPrims = 2000;
+end
+
+if nargin < 2 || isempty(numFrames)
+    numFrames = 100;
+end
+
+if nargin < 3 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+    [width, height] = Screen('WindowSize', w);
+    Screen('BlendFunction', w, 'GL_SRC_ALPHA', 'GL_ONE_MINUS_SRC_ALPHA');
+    tex = Screen('MakeTexture', w, uint8(rand(16, 16, 3) * 255));
+
+    % Same frame in both modes, for comparison of results:
+    Screen('FillRect', w, 0);
+    rand('state', 0); %#ok<RAND>
+    DrawFrame(w, tex, width, height, numPrims);
+    imgImmediate = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+
+    Screen('DeferredDrawing', w, 1);
+    Screen('FillRect', w, 0);
+    rand('state', 0); %#ok<RAND>
+    DrawFrame(w, tex, width, height, numPrims);
+    imgDeferred = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+    Screen('DeferredDrawing', w, 0);
+
+    results.maxDifference = max(abs(double(imgImmediate(:)) - double(imgDeferred(:))));
+
+    results.msecsImmediate = MeasureFrames(w, tex, width, height, numPrims, numFrames, 0);
+    results.msecsDeferred = MeasureFrames(w, tex, width, height, numPrims, numFrames, 1);
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nFrames of %i primitives, mean duration in msecs:\n\n', numPrims);
+fprintf('Immediate drawing: %10.3f\n', results.msecsImmediate);
+fprintf('Deferred drawing:  %10.3f\n', results.msecsDeferred);
+fprintf('\nMaximum difference of pixel values: %f\n\n', results.maxDifference);
+
+return;
+
+function msecs = MeasureFrames(w, tex, width, height, numPrims, numFrames, deferred)
+% Return mean duration of drawing and flipping a frame, in msecs:
+Screen('DeferredDrawing', w, deferred);
+
+% Warmup:
+DrawFrame(w, tex, width, height, numPrims);
+Screen('Flip', w, [], [], 2);
+
+t0 = GetSecs;
+for i = 1:numFrames
+    DrawFrame(w, tex, width, height, numPrims);
+    Screen('Flip', w, [], [], 2);
+end
+Screen('DrawingFinished', w, [], 1);
+msecs = (GetSecs - t0) / numFrames * 1000;
+
+Screen('DeferredDrawing', w, 0);
+return;
+
+function DrawFrame(w, tex, width, height, numPrims)
+% Draw one frame of 'numPrims' primitives, in runs of 10 of each kind:
+xy = [rand(1, numPrims) * (width - 20); rand(1, numPrims) * (height - 20)];
+colors = round(rand(4, numPrims) * 255);
+
+for i = 1:numPrims
+    x = xy(1, i);
+    y = xy(2, i);
+    switch mod(floor((i - 1) / 10), 3)
+        case 0
+            Screen('FillRect', w, colors(:, i), [x y x+10 y+10]);
+        case 1
+            Screen('DrawLine', w, colors(:, i), x, y, x+20, y+10, 2);
+        case 2
+            Screen('DrawTexture', w, tex, [], [x y x+16 y+16], [], 0, [], colors(:, i));
+    end
+end
+return;
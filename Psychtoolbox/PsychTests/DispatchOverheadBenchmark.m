@@ -0,0 +1,61 @@
+function results = DispatchOverheadBenchmark(numCalls, modules)
+% results = DispatchOverheadBenchmark([numCalls=100000][, modules])
+%
+% Measure the fixed overhead of a call into Psychtoolbox mex files, in
+% nanoseconds per call.
+%
+% Calls the hidden subfunction 'NullCallHelper' of each module, which does
+% nothing, so the measured time is the cost of the call from Matlab/Octave
+% into the module, argument setup and lookup of the subfunction by its
+% name. Runs 'numCalls' calls per module and reports the median of 5 runs.
+%
+% 'modules' is a cell array of module names, by default all mex modules of
+% Psychtoolbox which are available on this system. Modules which are not
+% installed are skipped.
+%
+% Returns a struct array 'results' with one element per measured module,
+% with the fields 'module' and 'nsPerCall'.
+%
+% see also: PsychTests, GetSecsTest
+
+if nargin < 1 || isempty(numCalls)
+    numCalls = 100000;
+end
+
+if nargin < 2 || isempty(modules)
+    modules = {'Screen', 'GetSecs', 'WaitSecs', 'PsychPortAudio', 'PsychHID', 'IOPort', 'Eyelink', 'PsychKinect', 'PsychCV'};
+end
+
+fprintf('\nOverhead of an empty call into a module, in nanoseconds per call:\n\n');
+
+results = struct('module', {}, 'nsPerCall', {});
+for i = 1:length(modules)
+    module = modules{i};
+    if ~ismember(exist(module), [2 3]) %#ok<EXIST>
+        continue;
+    end
+
+    fcn = str2func(module);
+    try
+        % Warmup: Loads the module and initializes it:
+        fcn('NullCallHelper');
+    catch
+        fprintf('%-16s not supported.\n', module);
+        continue;
+    end
+
+    runs = zeros(1, 5);
+    for r = 1:length(runs)
+        t0 = GetSecs;
+        for c = 1:numCalls
+            fcn('NullCallHelper');
+        end
+        runs(r) = (GetSecs - t0) / numCalls * 1e9;
+    end
+
+    results(end+1).module = module; %#ok<AGROW>
+    results(end).nsPerCall = median(runs);
+    fprintf('%-16s %10.1f\n', module, results(end).nsPerCall);
+end
+
+return;
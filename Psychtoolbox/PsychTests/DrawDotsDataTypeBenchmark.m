@@ -0,0 +1,94 @@
+function results = DrawDotsDataTypeBenchmark(numFrames, screenNumber)
+% results = DrawDotsDataTypeBenchmark([numFrames=300][, screenNumber=max])
+%
+% Benchmark Screen('DrawDots') with dot coordinates and sizes passed as
+% double, single and int16 matrices, for 10000, 100000 and 1000000 dots.
+%
+% Coordinates of type single, int16 or uint16 and sizes of type single are
+% passed to OpenGL as they are, without a conversion or copy of the
+% matrices. Double matrices are also passed as they are on desktop OpenGL,
+% but OpenGL has to convert them into single precision, and on OpenGL-ES
+% Screen has to convert them. The dot fields are created once, outside the
+% measurement, so only the cost of the DrawDots call is measured.
+%
+% Reports the mean cpu time of a Screen('DrawDots') call in milliseconds,
+% and the mean duration of a frame, including the Screen('Flip') without
+% sync to retrace, which also includes the time the graphics driver and
+% hardware needed to process the dots.
+%
+% On Octave, all matrices other than uint8 are passed to Screen as double
+% matrices, so there all data types perform the same.
+%
+% Returns a struct array 'results' with one element per tested config,
+% with the fields 'numDots', 'type', 'drawTime' and 'frameTime'.
+%
+% see also: PsychTests, DotDemo
+
+if nargin < 1 || isempty(numFrames)
+    numFrames = 300;
+end
+
+if nargin < 2 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+    [width, height] = Screen('WindowSize', w);
+
+    fprintf('\nDrawDots of %i frames, mean time in msecs:\n\n', numFrames);
+    fprintf('%-10s %-8s %10s %10s\n', 'Dots', 'Type', 'DrawDots', 'Frame');
+
+    results = struct('numDots', {}, 'type', {}, 'drawTime', {}, 'frameTime', {});
+    for numDots = [10000, 100000, 1000000]
+        xy = [rand(1, numDots) * width; rand(1, numDots) * height];
+        sizes = 1 + rand(1, numDots) * 3;
+        colors = uint8(rand(3, numDots) * 255);
+
+        for type = {'double', 'single', 'int16'}
+            type = type{1};
+            txy = cast(xy, type);
+            if strcmp(type, 'int16')
+                % Sizes are double or single only:
+                tsizes = single(sizes);
+            else
+                tsizes = cast(sizes, type);
+            end
+
+            [drawTime, frameTime] = DrawFrames(w, txy, tsizes, colors, numFrames);
+
+            results(end+1).numDots = numDots; %#ok<AGROW>
+            results(end).type = type;
+            results(end).drawTime = drawTime;
+            results(end).frameTime = frameTime;
+            fprintf('%-10i %-8s %10.3f %10.3f\n', numDots, type, drawTime * 1000, frameTime * 1000);
+        end
+    end
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+return;
+
+function [drawTime, frameTime] = DrawFrames(w, xy, sizes, colors, numFrames)
+% Return mean duration of the DrawDots call and of a whole frame:
+Screen('DrawDots', w, xy, sizes, colors, [], 4);
+Screen('Flip', w);
+
+drawTime = 0;
+t0 = GetSecs;
+for i = 1:numFrames
+    t1 = GetSecs;
+    Screen('DrawDots', w, xy, sizes, colors, [], 4);
+    drawTime = drawTime + GetSecs - t1;
+    Screen('Flip', w, [], [], 2);
+end
+
+% Wait for the last frame to complete, to include all pending work:
+Screen('DrawingFinished', w, [], 1);
+frameTime = (GetSecs - t0) / numFrames;
+drawTime = drawTime / numFrames;
+return;
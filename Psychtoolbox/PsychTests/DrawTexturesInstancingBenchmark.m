@@ -0,0 +1,139 @@
+function results = DrawTexturesInstancingBenchmark(numFrames, screenNumber)
+% results = DrawTexturesInstancingBenchmark([numFrames=100][, screenNumber=max])
+%
+% Benchmark Screen('DrawTextures') with 1000, 10000 and 50000 patches per
+% frame, with and without instanced drawing.
+%
+% By default, Screen draws a batch of textures without a texture shader via
+% one instanced draw call, with the corners, texture coordinates and
+% rotation of each texture quad computed by a vertex shader. The
+% 'ConserveVRAM' setting kPsychDontUseInstancedTextureBlits = 2^30 disables
+% this, so the quads are computed on the cpu and drawn from a vertex array,
+% as is always done for textures with a shader, e.g., procedural textures.
+%
+% Tests a 32 x 32 pixels image texture and a 32 x 32 pixels procedural
+% Gabor patch, drawn at random positions with random rotation angles. The
+% image texture is drawn with individual modulateColors, the Gabors with
+% individual 'auxParameters'. Each frame is one call to Screen('DrawTextures'),
+% followed by a Screen('Flip') without sync to retrace.
+%
+% Also draws the same frame of image textures with and without instanced
+% drawing and reports the maximum difference between the pixels read back
+% via Screen('GetImage'), which should be zero or close to zero.
+%
+% Returns a struct array 'results' with one element per tested config,
+% with the fields 'texture', 'numPatches', 'instancing' and 'fps'.
+%
+% see also: PsychTests, ConserveVRAMSettings, DeferredDrawingBenchmark
+
+if nargin < 1 || isempty(numFrames)
+    numFrames = 100;
+end
+
+if nargin < 2 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+oldConserve = Screen('Preference', 'ConserveVRAM');
+kPsychDontUseInstancedTextureBlits = 2^30;
+instancingOn = oldConserve - bitand(oldConserve, kPsychDontUseInstancedTextureBlits);
+instancingOff = bitor(oldConserve, kPsychDontUseInstancedTextureBlits);
+
+try
+    w = Screen('OpenWindow', screenNumber, 128);
+    [width, height] = Screen('WindowSize', w);
+    Screen('BlendFunction', w, 'GL_SRC_ALPHA', 'GL_ONE_MINUS_SRC_ALPHA');
+
+    tex = Screen('MakeTexture', w, uint8(rand(32, 32, 3) * 255));
+    gabor = CreateProceduralGabor(w, 32, 32, [], [0.5 0.5 0.5 0.0]);
+
+    % Same frame with and without instancing, for comparison of results:
+    [dstRects, angles, colors] = RandomPatches(1000, width, height);
+    Screen('Preference', 'ConserveVRAM', instancingOn);
+    Screen('FillRect', w, 128);
+    Screen('DrawTextures', w, tex, [], dstRects, angles, [], [], colors);
+    imgInstanced = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+
+    Screen('Preference', 'ConserveVRAM', instancingOff);
+    Screen('FillRect', w, 128);
+    Screen('DrawTextures', w, tex, [], dstRects, angles, [], [], colors);
+    imgArrays = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+
+    maxDifference = max(abs(double(imgInstanced(:)) - double(imgArrays(:))));
+
+    fprintf('\n%-10s %10s %10s %10s\n', 'Texture', 'Patches', 'Instanced', 'Frames/sec');
+
+    results = struct('texture', {}, 'numPatches', {}, 'instancing', {}, 'fps', {});
+    for texture = {'image', 'gabor'}
+        texture = texture{1};
+        for numPatches = [1000, 10000, 50000]
+            [dstRects, angles, colors] = RandomPatches(numPatches, width, height);
+            auxParameters = [rand(1, numPatches) * 180; repmat([0.05; 5; 0.5; 1; 0; 0; 0], 1, numPatches)];
+
+            for instancing = [1 0]
+                if instancing
+                    Screen('Preference', 'ConserveVRAM', instancingOn);
+                else
+                    Screen('Preference', 'ConserveVRAM', instancingOff);
+                end
+
+                if strcmp(texture, 'image')
+                    t = DrawFrames(w, numFrames, tex, dstRects, angles, colors, []);
+                else
+                    t = DrawFrames(w, numFrames, gabor, dstRects, angles, [], auxParameters);
+                end
+
+                results(end+1).texture = texture; %#ok<AGROW>
+                results(end).numPatches = numPatches;
+                results(end).instancing = instancing;
+                results(end).fps = numFrames / t;
+                fprintf('%-10s %10i %10i %10.1f\n', texture, numPatches, instancing, results(end).fps);
+            end
+        end
+    end
+
+    Screen('Preference', 'ConserveVRAM', oldConserve);
+    sca;
+catch
+    Screen('Preference', 'ConserveVRAM', oldConserve);
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nMaximum difference of pixel values with and without instancing: %f\n\n', maxDifference);
+
+return;
+
+function [dstRects, angles, colors] = RandomPatches(numPatches, width, height)
+% Random 32 x 32 pixels target rects, rotation angles and modulateColors:
+xy = [rand(1, numPatches) * (width - 32); rand(1, numPatches) * (height - 32)];
+dstRects = [xy; xy + 32];
+angles = rand(1, numPatches) * 360;
+colors = [round(rand(3, numPatches) * 255); 255 * ones(1, numPatches)];
+return;
+
+function t = DrawFrames(w, numFrames, tex, dstRects, angles, colors, auxParameters)
+% Return wall clock time of 'numFrames' frames of drawing:
+DrawPatches(w, tex, dstRects, angles, colors, auxParameters);
+Screen('Flip', w);
+
+t0 = GetSecs;
+for i = 1:numFrames
+    DrawPatches(w, tex, dstRects, angles, colors, auxParameters);
+    Screen('Flip', w, [], [], 2);
+end
+
+% Wait for the last frame to complete, to include all pending work:
+Screen('DrawingFinished', w, [], 1);
+t = GetSecs - t0;
+return;
+
+function DrawPatches(w, tex, dstRects, angles, colors, auxParameters)
+if isempty(auxParameters)
+    Screen('DrawTextures', w, tex, [], dstRects, angles, [], [], colors);
+else
+    Screen('DrawTextures', w, tex, [], dstRects, angles, [], [], [], [], kPsychDontDoRotation, auxParameters);
+end
+return;
@@ -0,0 +1,120 @@
+function results = EyelinkQueuedDataBenchmark(durationSecs, pollIntervalSecs)
+% results = EyelinkQueuedDataBenchmark([durationSecs=5][, pollIntervalSecs=0.5])
+%
+% Benchmark loss and throughput of samples fetched via
+% Eyelink('GetQueuedData'), once directly from the link queue, and once
+% with a background drain thread started via
+% Eyelink('StartQueuedDataDrain').
+%
+% For 'durationSecs' seconds (default 5 seconds), it records and fetches
+% all queued data only every 'pollIntervalSecs' seconds (default 0.5
+% seconds), as a script which only fetches data between trials would do.
+% Without the drain thread, the link queue will overflow at high sampling
+% rates, and samples get lost.
+%
+% This works with a real tracker, but it is meant for use with the stub
+% libeyelink_core in PsychSourceGL/Source/Common/Eyelink/EyelinkCoreStub/
+% on Linux, which simulates a tracker with configurable sampling rate and
+% link queue size, and stores a serial number in the left gaze x position
+% of each sample, so lost samples can be counted exactly. See the comments
+% in eyelink_core_stub.c for how to build and use it. Without the stub,
+% lost samples are only counted via the LOSTDATAEVENT's in the data stream.
+%
+% Returns a struct array 'results' with one element per method, with the
+% fields 'method', 'samples' for the number of received samples,
+% 'lostEvents' for the number of LOSTDATAEVENT's, 'lostSamples' for the
+% number of samples missing according to the serial numbers, 'msecsFetch'
+% for the mean duration of one Eyelink('GetQueuedData') call, and
+% 'msecsMaxLatency' for the maximum delay between consecutive receive
+% times of samples.
+%
+% see also: PsychTests, Eyelink
+
+if nargin < 1 || isempty(durationSecs)
+    durationSecs = 5;
+end
+
+if nargin < 2 || isempty(pollIntervalSecs)
+    pollIntervalSecs = 0.5;
+end
+
+methods = {'link', 'drain'};
+results = struct('method', {}, 'samples', {}, 'lostEvents', {}, 'lostSamples', {}, 'msecsFetch', {}, 'msecsMaxLatency', {});
+
+el = EyelinkInitDefaults;
+
+try
+    if Eyelink('Initialize') ~= 0
+        error('Eyelink initialization failed!');
+    end
+
+    for m = 1:length(methods)
+        Eyelink('StartRecording');
+
+        if strcmp(methods{m}, 'drain')
+            Eyelink('StartQueuedDataDrain');
+        end
+
+        types = [];
+        serials = [];
+        times = [];
+        fetchSecs = 0;
+        nFetches = 0;
+        tEnd = GetSecs + durationSecs;
+        while 1
+            WaitSecs('YieldSecs', pollIntervalSecs);
+            done = GetSecs > tEnd;
+
+            if done
+                Eyelink('StopRecording');
+                if strcmp(methods{m}, 'drain')
+                    Eyelink('StopQueuedDataDrain');
+                end
+            end
+
+            t0 = GetSecs;
+            [samples, events, drained, sampleTimes] = Eyelink('GetQueuedData'); %#ok<ASGLU>
+            fetchSecs = fetchSecs + GetSecs - t0;
+            nFetches = nFetches + 1;
+
+            if ~isempty(samples)
+                types = [types, samples(2, :)]; %#ok<AGROW>
+                serials = [serials, samples(14, :)]; %#ok<AGROW>
+                times = [times, sampleTimes]; %#ok<AGROW>
+            end
+
+            if done
+                break;
+            end
+        end
+
+        isSample = (types == el.SAMPLE_TYPE);
+        s = serials(isSample);
+
+        results(m).method = methods{m};
+        results(m).samples = length(s);
+        results(m).lostEvents = sum(types == el.LOSTDATAEVENT);
+        if isempty(s)
+            results(m).lostSamples = NaN;
+        else
+            results(m).lostSamples = s(end) - s(1) + 1 - length(s);
+        end
+        results(m).msecsFetch = fetchSecs / nFetches * 1000;
+        results(m).msecsMaxLatency = max(diff(times(isSample))) * 1000;
+    end
+
+    Eyelink('Shutdown');
+catch
+    Eyelink('Shutdown');
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nFetching queued data every %f seconds for %f seconds:\n\n', pollIntervalSecs, durationSecs);
+fprintf('%-6s %10s %12s %12s %14s %18s\n', 'Method', 'Samples', 'Lost events', 'Lost samples', 'Fetch msecs', 'Max latency msecs');
+for m = 1:length(results)
+    fprintf('%-6s %10i %12i %12i %14.3f %18.3f\n', results(m).method, results(m).samples, results(m).lostEvents, ...
+            results(m).lostSamples, results(m).msecsFetch, results(m).msecsMaxLatency);
+end
+fprintf('\n');
+
+return;
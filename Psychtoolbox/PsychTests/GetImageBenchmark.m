@@ -0,0 +1,99 @@
+function results = GetImageBenchmark(numFrames, lag, screenNumber)
+% results = GetImageBenchmark([numFrames=300][, lag=2][, screenNumber=max])
+%
+% Benchmark recording of stimulus frames via Screen('GetImage'), compared
+% to asynchronous recording via Screen('GetImageAsyncBegin') and
+% Screen('GetImageAsyncEnd').
+%
+% Draws and flips 'numFrames' frames of a simple animation, and reads each
+% frame back after drawing it, before the flip. The synchronous
+% Screen('GetImage') waits for each readback. The asynchronous variant
+% starts the readback of each frame, and retrieves it 'lag' frames later.
+%
+% Tests rects of 1920 x 1080 and 3840 x 2160 pixels, clamped to the size of
+% the window, with 3 and 4 channels of uint8 pixels each. Flips are done
+% without sync to retrace, so the frames per second reported are the rate
+% at which a script could draw and record its stimulus.
+%
+% Returns a struct array 'results' with one element per tested config,
+% with the fields 'rect', 'nrchannels', 'fpsSync' and 'fpsAsync'.
+%
+% see also: PsychTests, AsyncFlipTest
+
+if nargin < 1 || isempty(numFrames)
+    numFrames = 300;
+end
+
+if nargin < 2 || isempty(lag)
+    lag = 2;
+end
+
+% Number of pending async readbacks is limited to 8 per onscreen window:
+lag = max(1, min(lag, 7));
+
+if nargin < 3 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+    winRect = Screen('Rect', w);
+
+    fprintf('\nGetImage recording of %i frames, in frames per second:\n\n', numFrames);
+    fprintf('%-12s %8s %10s %10s\n', 'Size', 'Channels', 'Sync', 'Async');
+
+    results = struct('rect', {}, 'nrchannels', {}, 'fpsSync', {}, 'fpsAsync', {});
+    for rect = {[0 0 1920 1080], [0 0 3840 2160]}
+        rect = ClipRect(rect{1}, winRect);
+        for nrchannels = [3 4]
+            fpsSync = numFrames / RecordFrames(w, rect, nrchannels, numFrames, 0);
+            fpsAsync = numFrames / RecordFrames(w, rect, nrchannels, numFrames, lag);
+
+            results(end+1).rect = rect; %#ok<AGROW>
+            results(end).nrchannels = nrchannels;
+            results(end).fpsSync = fpsSync;
+            results(end).fpsAsync = fpsAsync;
+            fprintf('%-12s %8i %10.1f %10.1f\n', sprintf('%i x %i', RectWidth(rect), RectHeight(rect)), nrchannels, fpsSync, fpsAsync);
+        end
+    end
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+return;
+
+function t = RecordFrames(w, rect, nrchannels, numFrames, lag)
+% Return duration of drawing, recording and flipping of 'numFrames' frames.
+% Records synchronously if 'lag' is zero, otherwise asynchronously with
+% retrieval of each frame 'lag' frames later:
+handles = [];
+Screen('Flip', w);
+
+t0 = GetSecs;
+for i = 1:numFrames
+    Screen('FillRect', w, mod(i, 256));
+    Screen('FillOval', w, [255 255 0], CenterRectOnPoint([0 0 200 200], mod(i * 10, RectWidth(rect)), RectHeight(rect) / 2));
+
+    if lag == 0
+        img = Screen('GetImage', w, rect, 'backBuffer', 0, nrchannels); %#ok<NASGU>
+    else
+        handles(end+1) = Screen('GetImageAsyncBegin', w, rect, 'backBuffer', 0, nrchannels); %#ok<AGROW>
+        if length(handles) > lag
+            img = Screen('GetImageAsyncEnd', w, handles(1)); %#ok<NASGU>
+            handles = handles(2:end);
+        end
+    end
+
+    Screen('Flip', w, [], [], 2);
+end
+
+% Retrieve the remaining frames:
+for h = handles
+    img = Screen('GetImageAsyncEnd', w, h); %#ok<NASGU>
+end
+
+t = GetSecs - t0;
+return;
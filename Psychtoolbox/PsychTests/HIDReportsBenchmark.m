@@ -0,0 +1,110 @@
+function results = HIDReportsBenchmark(rate, durationSecs, deviceNumber)
+% results = HIDReportsBenchmark([rate=2000][, durationSecs=5][, deviceNumber=1])
+%
+% Test and benchmark reception of USB-HID reports by PsychHID at high rates.
+%
+% This doesn't need any HID device. It uses the 'simulateRate' option of
+% PsychHID('ReceiveReports') to simulate a device 'deviceNumber' which
+% sends 'rate' reports per second (default 2000 Hz) for 'durationSecs'
+% seconds (default 5 seconds). Each simulated report carries a 32-bit
+% serial number, so lost reports can be detected. On Linux and MS-Windows
+% the reports are received by a background thread, so they arrive even
+% while the script is busy.
+%
+% The test fetches the reports every 100 msecs via PsychHID('GiveReports'),
+% and checks that no report got lost and that their serial numbers and
+% timestamps are in order. It reports the number of lost reports, and the
+% mean and maximum interval between consecutive reports in msecs.
+%
+% Then it lets a backlog of 10000 reports pile up and drains it once via
+% PsychHID('GiveMeReports'), which returns one struct per report, and once
+% via PsychHID('GiveReports'), which returns all reports as one matrix,
+% and reports the time taken for draining in both cases.
+%
+% Returns a struct 'results' with the fields 'received', 'lost',
+% 'msecsMeanInterval', 'msecsMaxInterval', 'msecsGiveMeReports' and
+% 'msecsGiveReports'.
+%
+% see also: PsychTests, DaqTest, HIDIntervalTest
+
+if nargin < 1 || isempty(rate)
+    rate = 2000;
+end
+
+if nargin < 2 || isempty(durationSecs)
+    durationSecs = 5;
+end
+
+if nargin < 3 || isempty(deviceNumber)
+    deviceNumber = 1;
+end
+
+backlog = 10000;
+options.simulateRate = rate;
+options.maxReports = 2 * backlog;
+options.maxReportSize = 64;
+
+try
+    % Throughput and loss test while fetching reports periodically:
+    PsychHID('ReceiveReports', deviceNumber, options);
+
+    serials = [];
+    times = [];
+    tEnd = GetSecs + durationSecs;
+    while GetSecs < tEnd
+        WaitSecs('YieldSecs', 0.1);
+        [reports, t] = PsychHID('GiveReports', deviceNumber);
+        if ~isempty(t)
+            serials = [serials, [1, 256, 65536, 16777216] * double(reports(1:4, :))]; %#ok<AGROW>
+            times = [times, t]; %#ok<AGROW>
+        end
+    end
+
+    PsychHID('ReceiveReportsStop', deviceNumber);
+    PsychHID('GiveReports', deviceNumber);
+
+    % Backlog draining test:
+    opts.simulateRate = rate;
+    PsychHID('ReceiveReports', deviceNumber, opts);
+    WaitSecs(backlog / rate);
+    PsychHID('ReceiveReportsStop', deviceNumber);
+
+    t0 = GetSecs;
+    r1 = PsychHID('GiveMeReports', deviceNumber);
+    results.msecsGiveMeReports = (GetSecs - t0) * 1000;
+
+    PsychHID('ReceiveReports', deviceNumber, opts);
+    WaitSecs(backlog / rate);
+    PsychHID('ReceiveReportsStop', deviceNumber);
+
+    t0 = GetSecs;
+    r2 = PsychHID('GiveReports', deviceNumber);
+    results.msecsGiveReports = (GetSecs - t0) * 1000;
+catch
+    PsychHID('ReceiveReportsStop', deviceNumber);
+    psychrethrow(psychlasterror);
+end
+
+if isempty(serials)
+    error('No reports received!');
+end
+
+if any(diff(serials) <= 0) || any(diff(times) < 0)
+    error('Reports received out of order!');
+end
+
+results.received = length(serials);
+results.lost = serials(end) - serials(1) + 1 - length(serials);
+results.msecsMeanInterval = mean(diff(times)) * 1000;
+results.msecsMaxInterval = max(diff(times)) * 1000;
+
+fprintf('\nSimulated device at %i Hz for %f seconds:\n\n', rate, durationSecs);
+fprintf('Received reports:       %i\n', results.received);
+fprintf('Lost reports:           %i\n', results.lost);
+fprintf('Mean interval msecs:    %f\n', results.msecsMeanInterval);
+fprintf('Max interval msecs:     %f\n', results.msecsMaxInterval);
+fprintf('\nDraining a backlog of reports:\n\n');
+fprintf('GiveMeReports:          %i reports in %f msecs.\n', length(r1), results.msecsGiveMeReports);
+fprintf('GiveReports:            %i reports in %f msecs.\n\n', size(r2, 2), results.msecsGiveReports);
+
+return;
@@ -0,0 +1,129 @@
+function results = IOPortPacketLatencyBenchmark(durationSecs, packetSize)
+% results = IOPortPacketLatencyBenchmark([durationSecs=5][, packetSize=16])
+%
+% Benchmark latency and cpu load of background serial port reads in IOPort,
+% with the polling reader and with the event driven packet framing reader.
+%
+% This doesn't need any serial port hardware. It needs Linux or OSX and the
+% 'socat' utility, which it uses to create a pair of connected
+% pseudo-terminals /tmp/ptbptyA and /tmp/ptbptyB. One is opened for
+% writing, the other for reading, like a real serial port connection.
+%
+% For 'durationSecs' seconds (default 5 seconds), it sends packets of
+% 'packetSize' bytes (default 16 bytes), which contain the GetSecs time of
+% their sending, at data rates of a 115200 baud serial port and of a 3
+% Mbaud serial port. They are received once by a background reader with
+% 'StartBackgroundRead' and the default polling reader, fetched via
+% IOPort('Read'), and once with 'FramingMode=Fixed', fetched via
+% IOPort('ReadPackets'). The latency is the difference between the receive
+% timestamp and the send time of each packet.
+%
+% Returns a struct array 'results' with one element per rate and reader,
+% with the fields 'baud', 'reader', 'received', 'msecsMedian', 'msecs99',
+% 'msecsMax' for the median, 99th percentile and maximum latency, and
+% 'cpuPercent' for the cpu time used by the whole process.
+%
+% see also: PsychTests, IOPort
+
+if nargin < 1 || isempty(durationSecs)
+    durationSecs = 5;
+end
+
+if nargin < 2 || isempty(packetSize)
+    packetSize = 16;
+end
+
+if IsWin
+    error('This test needs Linux or OSX, as packet framing is not supported on MS-Windows.');
+end
+
+if packetSize < 8
+    error('packetSize must be at least 8 bytes, to hold the send timestamp.');
+end
+
+% Create connected pty pair:
+system('socat pty,raw,echo=0,link=/tmp/ptbptyA pty,raw,echo=0,link=/tmp/ptbptyB & sleep 1');
+
+bauds = [115200, 3000000];
+readers = {'polling', 'framing'};
+results = struct('baud', {}, 'reader', {}, 'received', {}, 'msecsMedian', {}, 'msecs99', {}, 'msecsMax', {}, 'cpuPercent', {});
+config = sprintf('InputBufferSize=%i ReceiveTimeout=1 ', 1000 * packetSize);
+
+try
+    wr = IOPort('OpenSerialPort', '/tmp/ptbptyA', 'OutputBufferSize=65536');
+
+    for b = 1:length(bauds)
+        % Packets per msec, assuming 10 bits per byte on the wire:
+        packetsPerMsec = bauds(b) / 10 / packetSize / 1000;
+
+        for r = 1:length(readers)
+            if r == 1
+                rd = IOPort('OpenSerialPort', '/tmp/ptbptyB', [config sprintf('StartBackgroundRead=%i', packetSize)]);
+            else
+                rd = IOPort('OpenSerialPort', '/tmp/ptbptyB', [config sprintf('FramingMode=Fixed StartBackgroundRead=%i', packetSize)]);
+            end
+
+            latencies = [];
+            sent = 0;
+            cpu0 = cputime;
+            t0 = GetSecs;
+            tNow = t0;
+            while tNow < t0 + durationSecs
+                % Send all packets which are due by now, stamped with the current time:
+                n = floor((tNow - t0) * 1000 * packetsPerMsec) - sent;
+                if n > 0
+                    packet = zeros(1, packetSize, 'uint8');
+                    packet(1:8) = typecast(tNow, 'uint8');
+                    IOPort('Write', wr, repmat(packet, 1, n), 0);
+                    sent = sent + n;
+                end
+
+                % Fetch everything received so far:
+                if r == 1
+                    while IOPort('BytesAvailable', rd) >= packetSize
+                        [data, when] = IOPort('Read', rd, 0, packetSize);
+                        latencies(end+1) = when - typecast(uint8(data(1:8)), 'double'); %#ok<AGROW>
+                    end
+                else
+                    [data, when] = IOPort('ReadPackets', rd);
+                    if ~isempty(when)
+                        latencies = [latencies, when - typecast(reshape(data(1:8, :), 1, []), 'double')]; %#ok<AGROW>
+                    end
+                end
+
+                WaitSecs('YieldSecs', 0.001);
+                tNow = GetSecs;
+            end
+            cpu = (cputime - cpu0) / (GetSecs - t0);
+
+            IOPort('Close', rd);
+
+            latencies = sort(latencies) * 1000;
+            i = length(results) + 1;
+            results(i).baud = bauds(b);
+            results(i).reader = readers{r};
+            results(i).received = length(latencies);
+            results(i).msecsMedian = latencies(max(1, round(0.5 * end)));
+            results(i).msecs99 = latencies(max(1, round(0.99 * end)));
+            results(i).msecsMax = latencies(end);
+            results(i).cpuPercent = cpu * 100;
+        end
+    end
+
+    IOPort('CloseAll');
+    system('pkill -f "socat pty,raw,echo=0,link=/tmp/ptbptyA"');
+catch
+    IOPort('CloseAll');
+    system('pkill -f "socat pty,raw,echo=0,link=/tmp/ptbptyA"');
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nLatency of %i byte packets over a pty pair:\n\n', packetSize);
+fprintf('%-9s %-8s %10s %14s %14s %14s %8s\n', 'Baud', 'Reader', 'Received', 'Median msecs', '99% msecs', 'Max msecs', 'CPU %');
+for i = 1:length(results)
+    fprintf('%-9i %-8s %10i %14.3f %14.3f %14.3f %8.1f\n', results(i).baud, results(i).reader, results(i).received, ...
+            results(i).msecsMedian, results(i).msecs99, results(i).msecsMax, results(i).cpuPercent);
+end
+fprintf('\n');
+
+return;
@@ -0,0 +1,118 @@
+function results = IOPortWriteAsyncBenchmark(nTrials, nBytes)
+% results = IOPortWriteAsyncBenchmark([nTrials=500][, nBytes=8])
+%
+% Benchmark cpu time and timestamp accuracy of IOPort writes with the
+% polling 'Write' and with the queued 'WriteAsync'.
+%
+% This doesn't need any serial port hardware. It needs Linux or OSX and the
+% 'socat' utility, which it uses to create a pair of connected
+% pseudo-terminals /tmp/ptbptyA and /tmp/ptbptyB. One is opened for
+% writing, the other one for reading with an event driven background
+% reader, whose receive timestamps serve as reference for the write
+% completion timestamps.
+%
+% Writes 'nTrials' times 'nBytes' bytes (default 500 times 8 bytes) in
+% three ways:
+%
+% 'polling': IOPort('Write') with 'blocking' mode 2, which spins until the
+% output queue is empty.
+%
+% 'async': IOPort('WriteAsync'), then IOPort('WriteAsyncResult') with
+% waiting for completion.
+%
+% 'scheduled': IOPort('WriteAsync') with a target time 5 msecs in the
+% future, then IOPort('WriteAsyncResult') with waiting for completion.
+%
+% Returns a struct array 'results' with one element per method, with the
+% fields 'method', 'cpuMsecsPerWrite' for the cpu time of the whole process
+% per write, 'msecsMeanError' and 'msecsMaxError' for the mean and maximum
+% absolute difference between reported write completion time and receive
+% time, and for scheduled writes 'msecsMeanLateness' and 'msecsMaxLateness'
+% for the delay of the start of the write wrt. its target time.
+%
+% see also: PsychTests, IOPort, IOPortPacketLatencyBenchmark
+
+if nargin < 1 || isempty(nTrials)
+    nTrials = 500;
+end
+
+if nargin < 2 || isempty(nBytes)
+    nBytes = 8;
+end
+
+if IsWin
+    error('This test needs Linux or OSX, as WriteAsync is not supported on MS-Windows.');
+end
+
+% Create connected pty pair:
+system('socat pty,raw,echo=0,link=/tmp/ptbptyA pty,raw,echo=0,link=/tmp/ptbptyB & sleep 1');
+
+methods = {'polling', 'async', 'scheduled'};
+results = struct('method', {}, 'cpuMsecsPerWrite', {}, 'msecsMeanError', {}, 'msecsMaxError', {}, 'msecsMeanLateness', {}, 'msecsMaxLateness', {});
+data = uint8(1:nBytes);
+
+try
+    wr = IOPort('OpenSerialPort', '/tmp/ptbptyA');
+    rd = IOPort('OpenSerialPort', '/tmp/ptbptyB', sprintf('InputBufferSize=%i FramingMode=Fixed StartBackgroundRead=%i', 1000 * nBytes, nBytes));
+
+    for m = 1:length(methods)
+        errors = zeros(1, nTrials);
+        lateness = zeros(1, nTrials);
+        cpu = 0;
+
+        for i = 1:nTrials
+            % Let things settle between trials:
+            WaitSecs('YieldSecs', 0.002);
+            IOPort('ReadPackets', rd);
+
+            cpu0 = cputime;
+            switch methods{m}
+                case 'polling'
+                    [nwritten, tDone] = IOPort('Write', wr, data, 2);
+                case 'async'
+                    ticket = IOPort('WriteAsync', wr, data);
+                    [done, nwritten, tDone] = IOPort('WriteAsyncResult', wr, ticket, 1);
+                case 'scheduled'
+                    tWhen = GetSecs + 0.005;
+                    ticket = IOPort('WriteAsync', wr, data, tWhen);
+                    [done, nwritten, tDone, errmsg, tStart] = IOPort('WriteAsyncResult', wr, ticket, 1);
+                    lateness(i) = tStart - tWhen;
+            end
+            cpu = cpu + cputime - cpu0;
+
+            if nwritten ~= nBytes
+                error('Write of trial %i for method %s failed!', i, methods{m});
+            end
+
+            [packet, tReceived] = IOPort('ReadPackets', rd, 1, 1);
+            if isempty(tReceived)
+                error('Data of trial %i for method %s not received!', i, methods{m});
+            end
+            errors(i) = tDone - tReceived;
+        end
+
+        results(m).method = methods{m};
+        results(m).cpuMsecsPerWrite = cpu / nTrials * 1000;
+        results(m).msecsMeanError = mean(abs(errors)) * 1000;
+        results(m).msecsMaxError = max(abs(errors)) * 1000;
+        results(m).msecsMeanLateness = mean(lateness) * 1000;
+        results(m).msecsMaxLateness = max(lateness) * 1000;
+    end
+
+    IOPort('CloseAll');
+    system('pkill -f "socat pty,raw,echo=0,link=/tmp/ptbptyA"');
+catch
+    IOPort('CloseAll');
+    system('pkill -f "socat pty,raw,echo=0,link=/tmp/ptbptyA"');
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\n%i writes of %i bytes over a pty pair:\n\n', nTrials, nBytes);
+fprintf('%-10s %14s %16s %16s %16s %16s\n', 'Method', 'CPU msecs', 'Mean err msecs', 'Max err msecs', 'Mean late msecs', 'Max late msecs');
+for m = 1:length(results)
+    fprintf('%-10s %14.3f %16.3f %16.3f %16.3f %16.3f\n', results(m).method, results(m).cpuMsecsPerWrite, results(m).msecsMeanError, ...
+            results(m).msecsMaxError, results(m).msecsMeanLateness, results(m).msecsMaxLateness);
+end
+fprintf('\n');
+
+return;
@@ -0,0 +1,100 @@
+function KbQueueEventBufferBenchmark(nEvents, deviceIndex)
+% KbQueueEventBufferBenchmark([nEvents=10000][, deviceIndex])
+%
+% Benchmark throughput of the keyboard queue event buffer of PsychHID.
+%
+% This test is currently meant for Linux/X11 only, as it uses the
+% 'xdotool' command line utility to inject a burst of synthetic key
+% events. Install it via "sudo apt-get install xdotool" if necessary.
+%
+% The test creates and starts a keyboard queue for the keyboard
+% 'deviceIndex' (default: default keyboard), then injects a burst of about
+% 'nEvents' key press and release events (default 10000) and waits until
+% all of them have arrived in the event buffer. It reports the rate of
+% event arrival in events/sec, as measured by the KbQueue timestamps.
+%
+% Then it drains the burst of events from the event buffer, once via
+% repeated calls to PsychHID('KbQueueGetEvent'), ie. one event per call,
+% and once via a single call to PsychHID('KbQueueGetEvents'), ie. all
+% events in one bulk call, and reports the time taken for draining in
+% both cases.
+%
+% Don't touch the keyboard while the test is running!
+%
+% see also: PsychTests, KbEventGet, KbQueueCreate
+
+if ~IsLinux
+    error('Sorry, this test is only supported on Linux.');
+end
+
+[rc, dummy] = system('which xdotool');
+if rc ~= 0
+    error('This test needs the xdotool utility, but it is not installed.');
+end
+
+if nargin < 1 || isempty(nEvents)
+    nEvents = 10000;
+end
+
+if nargin < 2
+    deviceIndex = [];
+end
+
+% Each xdotool key stroke creates one press and one release event:
+nStrokes = ceil(nEvents / 2);
+nEvents = 2 * nStrokes;
+keys = repmat('shift ', 1, nStrokes);
+
+KbQueueCreate(deviceIndex);
+KbQueueStart(deviceIndex);
+
+try
+    results = zeros(2, 1);
+    for mode = 1:2
+        % Inject burst, wait until all events have arrived:
+        PsychHID('KbQueueFlush', deviceIndex, 3);
+        system(['xdotool key --delay 0 ' keys]);
+
+        tdeadline = GetSecs + 30;
+        while (PsychHID('KbQueueFlush', deviceIndex, 0) < nEvents) && (GetSecs < tdeadline)
+            WaitSecs('YieldSecs', 0.010);
+        end
+
+        navail = PsychHID('KbQueueFlush', deviceIndex, 0);
+        if navail < nEvents
+            fprintf('Only %i of %i injected events arrived in time. Results will be unreliable.\n', navail, nEvents);
+        end
+
+        if mode == 1
+            % One event per call:
+            times = zeros(1, navail);
+            t1 = GetSecs;
+            for i = 1:navail
+                evt = PsychHID('KbQueueGetEvent', deviceIndex);
+                times(i) = evt.Time;
+            end
+            t2 = GetSecs;
+        else
+            % All events in one call:
+            t1 = GetSecs;
+            evts = PsychHID('KbQueueGetEvents', deviceIndex);
+            t2 = GetSecs;
+            times = evts.Time;
+        end
+
+        results(mode) = t2 - t1;
+        if numel(times) > 1
+            fprintf('Event arrival rate during burst: %f events/sec.\n', (numel(times) - 1) / (times(end) - times(1)));
+        end
+    end
+catch
+    KbQueueRelease(deviceIndex);
+    psychrethrow(psychlasterror);
+end
+
+KbQueueRelease(deviceIndex);
+
+fprintf('\nDraining %i events via KbQueueGetEvent took %f msecs, ie. %f usecs per event.\n', navail, 1000 * results(1), 1e6 * results(1) / max(1, navail));
+fprintf('Draining %i events via KbQueueGetEvents took %f msecs, ie. %f usecs per event.\n\n', navail, 1000 * results(2), 1e6 * results(2) / max(1, navail));
+
+return;
@@ -0,0 +1,88 @@
+function results = MakeTextureAsyncBenchmark(numTextures, screenNumber)
+% results = MakeTextureAsyncBenchmark([numTextures=200][, screenNumber=max])
+%
+% Benchmark the time the script is blocked in Screen('MakeTexture') when
+% creating many large textures, with synchronous and asynchronous upload.
+%
+% Creates 'numTextures' textures of 1920 x 1080 pixels from a random RGB
+% uint8 image matrix, once with the standard synchronous upload and once
+% with 'specialFlags' 128, which asks for upload of the texture on a
+% background thread. Measures the total and maximum time spent inside
+% Screen('MakeTexture'), and the time until all textures are ready for
+% drawing, as reported by Screen('IsTextureReady'). With asynchronous
+% upload, the conversion of the image matrix still happens inside
+% Screen('MakeTexture'), only the upload to the graphics card is done in
+% the background.
+%
+% Also draws one texture of each set and reports the maximum difference
+% between the pixels read back via Screen('GetImage'), which should be zero.
+%
+% Returns a struct array 'results' with one element per upload mode, with
+% the fields 'mode', 'msecsBlocked' for the total time spent inside
+% Screen('MakeTexture'), 'msecsMaxCall' for the longest call, and
+% 'msecsReady' for the time until all textures were ready.
+%
+% see also: PsychTests, MakeTextureConversionBenchmark, MakeTextureTimingTest2
+
+if nargin < 1 || isempty(numTextures)
+    numTextures = 200;
+end
+
+if nargin < 2 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+img = uint8(rand(1080, 1920, 3) * 255);
+modes = {'sync', 'async'};
+flags = [0, 128];
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+
+    % Warmup, also starts the background upload thread:
+    tex = Screen('MakeTexture', w, img, [], 128);
+    Screen('IsTextureReady', tex, 1);
+    Screen('Close', tex);
+
+    results = struct('mode', {}, 'msecsBlocked', {}, 'msecsMaxCall', {}, 'msecsReady', {});
+    images = cell(1, 2);
+    for m = 1:2
+        textures = zeros(1, numTextures);
+        callTimes = zeros(1, numTextures);
+
+        t0 = GetSecs;
+        for i = 1:numTextures
+            tc = GetSecs;
+            textures(i) = Screen('MakeTexture', w, img, [], flags(m));
+            callTimes(i) = GetSecs - tc;
+        end
+        Screen('IsTextureReady', textures, 1);
+        Screen('DrawingFinished', w, [], 1);
+        tReady = GetSecs - t0;
+
+        results(m).mode = modes{m};
+        results(m).msecsBlocked = sum(callTimes) * 1000;
+        results(m).msecsMaxCall = max(callTimes) * 1000;
+        results(m).msecsReady = tReady * 1000;
+
+        Screen('DrawTexture', w, textures(end));
+        images{m} = Screen('GetImage', w, [], 'backBuffer');
+        Screen('Flip', w);
+
+        Screen('Close', textures);
+    end
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nCreation of %i textures of 1920 x 1080 pixels:\n\n', numTextures);
+fprintf('%-8s %16s %16s %16s\n', 'Upload', 'Blocked msecs', 'Max call msecs', 'Ready msecs');
+for m = 1:2
+    fprintf('%-8s %16.1f %16.2f %16.1f\n', results(m).mode, results(m).msecsBlocked, results(m).msecsMaxCall, results(m).msecsReady);
+end
+fprintf('\nMaximum difference of pixel values: %f\n\n', max(abs(double(images{1}(:)) - double(images{2}(:)))));
+
+return;
@@ -0,0 +1,108 @@
+function results = MakeTextureConversionBenchmark(imageSize, numSamples, screenNumber)
+% results = MakeTextureConversionBenchmark([imageSize=2048][, numSamples=10][, screenNumber=max])
+%
+% Benchmark the conversion of image matrices into textures by
+% Screen('MakeTexture'), for all combinations of input data type, number
+% of color layers and texture precision.
+%
+% Creates textures from random imageSize x imageSize matrices, and reports
+% the throughput of each conversion mode in MB of image matrix per second,
+% once with texture conversion restricted to one thread, via the
+% environment variable PSYCH_TEXCONV_THREADS, and once with all threads.
+%
+% The measured times include memory allocation and texture upload to the
+% graphics card. The uint8 single layer mode does not need any conversion,
+% as its matrix gets uploaded directly, so it serves as baseline for the
+% time not spent on conversion. The planar modes use 'specialFlags' 4.
+%
+% Returns a struct array 'results' with one element per conversion mode,
+% with the fields 'mode', 'mbPerSec1' for one thread and 'mbPerSecN' for
+% all threads.
+%
+% see also: PsychTests, MakeTextureTimingTest2
+
+if nargin < 1 || isempty(imageSize)
+    imageSize = 2048;
+end
+
+if nargin < 2 || isempty(numSamples)
+    numSamples = 10;
+end
+
+if nargin < 3 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+% Conversion modes: Data type, number of layers, floatprecision, specialFlags:
+modes = {};
+for layers = 1:4
+    modes{end+1} = {'uint8', layers, 0, 0}; %#ok<AGROW>
+end
+
+for layers = 1:4
+    for precision = 0:2
+        modes{end+1} = {'double', layers, precision, 0}; %#ok<AGROW>
+    end
+end
+
+for layers = 2:4
+    modes{end+1} = {'uint8', layers, 0, 4}; %#ok<AGROW>
+    modes{end+1} = {'double', layers, 0, 4}; %#ok<AGROW>
+    modes{end+1} = {'double', layers, 2, 4}; %#ok<AGROW>
+end
+
+oldThreads = getenv('PSYCH_TEXCONV_THREADS');
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+
+    fprintf('\nMakeTexture conversion throughput for %i x %i pixel images, in MB/s of image matrix:\n\n', imageSize, imageSize);
+    fprintf('%-8s %6s %9s %7s %12s %12s\n', 'Type', 'Layers', 'Precision', 'Flags', '1 thread', 'All threads');
+
+    results = struct('mode', {}, 'mbPerSec1', {}, 'mbPerSecN', {});
+    for i = 1:length(modes)
+        mode = modes{i};
+        img = rand(imageSize, imageSize, mode{2});
+        if strcmp(mode{1}, 'uint8')
+            img = uint8(img * 255);
+            mb = numel(img) / 1e6;
+        else
+            mb = numel(img) * 8 / 1e6;
+        end
+
+        setenv('PSYCH_TEXCONV_THREADS', '1');
+        mbPerSec1 = mb / TimeMakeTexture(w, img, mode{3}, mode{4}, numSamples);
+        setenv('PSYCH_TEXCONV_THREADS', '');
+        mbPerSecN = mb / TimeMakeTexture(w, img, mode{3}, mode{4}, numSamples);
+
+        results(end+1).mode = mode; %#ok<AGROW>
+        results(end).mbPerSec1 = mbPerSec1;
+        results(end).mbPerSecN = mbPerSecN;
+        fprintf('%-8s %6i %9i %7i %12.1f %12.1f\n', mode{1}, mode{2}, mode{3}, mode{4}, mbPerSec1, mbPerSecN);
+    end
+
+    setenv('PSYCH_TEXCONV_THREADS', oldThreads);
+    sca;
+catch
+    setenv('PSYCH_TEXCONV_THREADS', oldThreads);
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+return;
+
+function t = TimeMakeTexture(w, img, precision, specialFlags, numSamples)
+% Return median duration of MakeTexture in seconds, after one warmup run:
+tex = Screen('MakeTexture', w, img, [], specialFlags, precision);
+Screen('Close', tex);
+
+times = zeros(1, numSamples);
+for s = 1:numSamples
+    t0 = GetSecs;
+    tex = Screen('MakeTexture', w, img, [], specialFlags, precision);
+    times(s) = GetSecs - t0;
+    Screen('Close', tex);
+end
+
+t = median(times);
+return;
@@ -0,0 +1,123 @@
+function PsychPortAudioBufferFormatsTest(wavfile)
+% PsychPortAudioBufferFormatsTest([wavfile])
+%
+% Regression test and benchmark for the sound data formats accepted by
+% PsychPortAudio('FillBuffer'), PsychPortAudio('RefillBuffer') and
+% PsychPortAudio('CreateBuffer'). Uses full-duplex offline devices, which
+% loop their output back into their capture buffer, so it works without
+% sound hardware, see PsychPortAudioOfflineTest.
+%
+% The test performs the following steps:
+%
+% 1. Equivalence: Plays the same test signal as double(), single() and
+%    int16() matrix and checks that the looped back sound data is identical.
+%
+% 2. Sound files: Renders a sine tone into the 32 bit float WAV file
+%    'wavfile' (default: a file in the temp directory), creates a buffer from
+%    that file via PsychPortAudio('CreateBuffer', pahandle, wavfile), plays it
+%    and checks that the looped back sound matches the tone.
+%
+% 3. Throughput: Reports the time 'FillBuffer' takes for 10 seconds of
+%    stereo sound in each of the three formats.
+%
+% see also: PsychTests, PsychPortAudio, PsychPortAudioOfflineTest
+
+if nargin < 1 || isempty(wavfile)
+    wavfile = [tempdir 'PsychPortAudioBufferFormatsTest.wav'];
+end
+
+InitializePsychSound(1);
+
+freq = 48000;
+buffersize = 256;
+failed = 0;
+
+try
+    % Test 1: Equivalence of double, single and int16 input. The int16 values map
+    % exactly to the double values, so the results must be identical:
+    isignal = int16(round(32767 * sin(2 * pi * 440 * (0:freq/10-1) / freq)));
+    signals = { double(isignal) / 32768, single(double(isignal) / 32768), isignal };
+    names = { 'double', 'single', 'int16' };
+    recorded = cell(1, 3);
+
+    for i = 1:3
+        recorded{i} = playAndRecord(freq, buffersize, 1, signals{i});
+    end
+
+    for i = 2:3
+        if ~isequal(size(recorded{i}), size(recorded{1})) || any(recorded{i}(:) ~= recorded{1}(:))
+            fprintf('FAILED: Playback of %s data differs from playback of double data!\n', names{i});
+            failed = failed + 1;
+        end
+    end
+    fprintf('Equivalence: double, single and int16 data tested.\n');
+
+    % Test 2: Buffer created from a float WAV file:
+    tone = 0.5 * [1; 1] * sin(2 * pi * 440 * (0:freq-1) / freq);
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0, wavfile);
+    PsychPortAudio('RunMode', pa, 0);
+    PsychPortAudio('FillBuffer', pa, tone);
+    PsychPortAudio('Start', pa, 1, 0, 1);
+    PsychPortAudio('Stop', pa, 1);
+    PsychPortAudio('Close', pa);
+
+    rec = playAndRecord(freq, buffersize, 2, wavfile);
+    rec = rec(:, 1:min(size(rec, 2), size(tone, 2)));
+    [dummy, onset] = max(abs(rec(1, :)) > 0.1);
+    n = min(size(rec, 2) - onset + 1, freq / 2);
+    if isempty(rec) || max(max(abs(rec(:, onset:onset+n-1) - tone(:, onset:onset+n-1)))) > 1e-3
+        fprintf('FAILED: Playback of buffer created from WAV file %s does not match the tone!\n', wavfile);
+        failed = failed + 1;
+    else
+        fprintf('Sound files: Buffer created from WAV file plays correctly.\n');
+    end
+
+    % Test 3: Throughput of 'FillBuffer' for the different formats:
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0);
+    isignal = int16(round(32767 * (rand(2, 10 * freq) - 0.5)));
+    signals = { double(isignal) / 32768, single(double(isignal) / 32768), isignal };
+    for i = 1:3
+        PsychPortAudio('FillBuffer', pa, signals{i});
+        tstart = GetSecs;
+        for trial = 1:10
+            PsychPortAudio('FillBuffer', pa, signals{i});
+        end
+        fprintf('Throughput: FillBuffer of 10 secs stereo %s data takes %f msecs.\n', names{i}, 1000 * (GetSecs - tstart) / 10);
+    end
+    PsychPortAudio('Close', pa);
+catch
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+if failed > 0
+    error('%i buffer format tests failed.', failed);
+end
+
+fprintf('All buffer format tests passed.\n');
+
+return;
+
+function recorded = playAndRecord(freq, buffersize, nchannels, data)
+% Play 'data' on a full-duplex offline device and return the looped back
+% capture. 'data' is a sound matrix or the filename of a sound file:
+pa = PsychPortAudio('Open', [], 3, [], freq, nchannels, buffersize, [], [], 32);
+PsychPortAudio('OfflineSettings', pa, 0);
+PsychPortAudio('RunMode', pa, 0);
+PsychPortAudio('GetAudioData', pa, 2);
+
+if ischar(data)
+    buffer = PsychPortAudio('CreateBuffer', pa, data);
+    PsychPortAudio('FillBuffer', pa, buffer);
+else
+    PsychPortAudio('FillBuffer', pa, data);
+end
+
+PsychPortAudio('Start', pa, 1, 0, 1);
+PsychPortAudio('Stop', pa, 1);
+recorded = PsychPortAudio('GetAudioData', pa);
+PsychPortAudio('Close', pa);
+
+return;
@@ -0,0 +1,134 @@
+function PsychPortAudioMixerBenchmark(deviceid, nslaves, duration)
+% PsychPortAudioMixerBenchmark([deviceid=-1][, nslaves=16][, duration=5])
+%
+% Benchmark the cpu cost of the mixer of PsychPortAudio master devices for
+% the different sample processing kernels selectable via the 'simdLevel'
+% setting of PsychPortAudio('EngineTunables').
+%
+% The test opens a master device on audio output device 'deviceid' (default:
+% -1 = default output device) with up to 8 output channels, and attaches
+% 'nslaves' slave devices (default 16) to it. The slaves use a mix of mono,
+% stereo and multi-channel playback with contiguous channel mappings, some
+% with non-contiguous channel mappings, and one slave is an AM modulator.
+% All slaves play a looped noise signal at very low volume.
+%
+% For each simdLevel (0 = scalar, 1 = SSE2/NEON, 2 = AVX2, -1 = auto) the
+% mixer is run for 'duration' seconds (default 5) and the average cpu load
+% of the audio processing thread, as reported by PsychPortAudio('GetStatus'),
+% is printed, together with the resulting cost in nanoseconds per sample
+% frame. Levels not supported by the cpu fall back to the next lower level.
+%
+% Note that the reported cpu load includes the processing overhead of the
+% audio driver itself, so the speedup of the mixing kernels alone is larger
+% than the ratio of the printed numbers.
+%
+% see also: PsychTests, PsychPortAudio, BasicSoundScheduleDemo
+
+if nargin < 1 || isempty(deviceid)
+    deviceid = -1;
+end
+
+if nargin < 2 || isempty(nslaves)
+    nslaves = 16;
+end
+
+if nargin < 3 || isempty(duration)
+    duration = 5;
+end
+
+InitializePsychSound(1);
+
+% Open master with up to 8 output channels:
+devs = PsychPortAudio('GetDevices');
+if deviceid < 0
+    nchannels = 2;
+    for i = 1:numel(devs)
+        if devs(i).NrOutputChannels > 0
+            nchannels = devs(i).NrOutputChannels;
+            break;
+        end
+    end
+else
+    nchannels = devs([devs.DeviceIndex] == deviceid).NrOutputChannels;
+end
+nchannels = max(1, min(nchannels, 8));
+
+pamaster = PsychPortAudio('Open', deviceid, 1+8, 1, [], nchannels);
+s = PsychPortAudio('GetStatus', pamaster);
+freq = s.SampleRate;
+
+try
+    % Create slaves with different channel configurations:
+    slaves = [];
+    for i = 1:nslaves
+        switch mod(i, 4)
+            case 0
+                % Mono on last channel:
+                chans = 1;
+                map = nchannels;
+            case 1
+                % Stereo or mono on first channels, contiguous mapping:
+                chans = min(2, nchannels);
+                map = 1:chans;
+            case 2
+                % All channels, identity mapping:
+                chans = nchannels;
+                map = 1:chans;
+            case 3
+                % Reversed, ie. non-contiguous, mapping:
+                chans = nchannels;
+                map = nchannels:-1:1;
+        end
+
+        pa = PsychPortAudio('OpenSlave', pamaster, 1, chans, map);
+        PsychPortAudio('FillBuffer', pa, 0.01 * (rand(chans, round(freq)) - 0.5));
+        PsychPortAudio('Volume', pa, 0.5, 0.5 * ones(1, chans));
+        slaves(end+1) = pa; %#ok<AGROW>
+    end
+
+    % One AM modulator for the whole master output:
+    pamod = PsychPortAudio('OpenSlave', pamaster, 32, nchannels);
+    PsychPortAudio('FillBuffer', pamod, repmat(0.5 + 0.5 * sin(linspace(0, 2*pi, round(freq))), nchannels, 1));
+
+    PsychPortAudio('Start', pamaster, 0, 0, 1);
+    for pa = slaves
+        PsychPortAudio('Start', pa, 0, 0, 1);
+    end
+    PsychPortAudio('Start', pamod, 0, 0, 1);
+
+    levels = [0, 1, 2, -1];
+    names = {'scalar', 'SSE2/NEON', 'AVX2', 'auto'};
+
+    fprintf('\nMaster with %i channels at %f Hz, %i slaves + 1 AM modulator:\n\n', nchannels, freq, nslaves);
+
+    for i = 1:numel(levels)
+        % Select kernels and find out what level we actually got:
+        PsychPortAudio('EngineTunables', [], [], [], [], levels(i));
+        [d1, d2, d3, d4, level] = PsychPortAudio('EngineTunables');
+
+        % Settle, then sample cpu load:
+        WaitSecs(0.5);
+        cpuload = [];
+        tend = GetSecs + duration;
+        while GetSecs < tend
+            s = PsychPortAudio('GetStatus', pamaster);
+            cpuload(end+1) = s.CPULoad; %#ok<AGROW>
+            WaitSecs('YieldSecs', 0.1);
+        end
+
+        cpuload = mean(cpuload);
+        fprintf('simdLevel %2i [%-9s] -> level %i: cpu load %6.3f %%, %8.2f nsecs per sample frame.\n', ...
+                levels(i), names{i}, level, 100 * cpuload, cpuload * 1e9 / freq);
+    end
+    fprintf('\n');
+catch
+    PsychPortAudio('EngineTunables', [], [], [], [], -1);
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+PsychPortAudio('Stop', pamaster, 1);
+PsychPortAudio('EngineTunables', [], [], [], [], -1);
+PsychPortAudio('Close');
+
+return;
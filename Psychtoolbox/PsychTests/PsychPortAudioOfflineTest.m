@@ -0,0 +1,145 @@
+function PsychPortAudioOfflineTest(nslaves, outfile)
+% PsychPortAudioOfflineTest([nslaves=32][, outfile])
+%
+% Regression test and benchmark for PsychPortAudio's offline devices, which
+% run the audio engine without any sound hardware, driven by a virtual clock.
+% Offline devices are opened via PsychPortAudio('Open') with specialFlags 32
+% and controlled via PsychPortAudio('OfflineSettings'). This test therefore
+% also works on headless machines without sound cards.
+%
+% The test performs the following steps, all at maximum speed, ie. faster
+% than realtime. Tests 1 to 3 use runMode 0, so the virtual clock only runs
+% while sound is played:
+%
+% 1. Schedule timing: Starts playback of a short sound at a series of
+%    scheduled start times and checks that the reported start times match
+%    the requested ones to within one sample duration.
+%
+% 2. Loopback: Plays a click on a full-duplex offline device and checks that
+%    the click appears in the captured sound data, which is a loopback of the
+%    output.
+%
+% 3. WAV output: Renders one second of a sine tone into the WAV file 'outfile'
+%    (default: a file in the temp directory) and checks the file size.
+%
+% 4. Throughput: Opens a master device with 'nslaves' slave devices (default
+%    32), all playing looped noise, and reports processed buffers per second,
+%    cpu time per buffer and the realtime factor of the mixing engine.
+%
+% see also: PsychTests, PsychPortAudio, PsychPortAudioMixerBenchmark
+
+if nargin < 1 || isempty(nslaves)
+    nslaves = 32;
+end
+
+if nargin < 2 || isempty(outfile)
+    outfile = [tempdir 'PsychPortAudioOfflineTest.wav'];
+end
+
+InitializePsychSound(1);
+
+freq = 48000;
+buffersize = 256;
+failed = 0;
+
+try
+    % Test 1: Schedule timing:
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0);
+    PsychPortAudio('RunMode', pa, 0);
+    PsychPortAudio('FillBuffer', pa, zeros(2, 100));
+
+    maxerr = 0;
+    for trial = 1:20
+        [dummy, stats] = PsychPortAudio('OfflineSettings', pa);
+        when = max(stats.VirtualTime, GetSecs) + 0.1 + rand * 0.1;
+        tonset = PsychPortAudio('Start', pa, 1, when, 1);
+        PsychPortAudio('Stop', pa, 1);
+        maxerr = max(maxerr, abs(tonset - when));
+    end
+    PsychPortAudio('Close', pa);
+
+    fprintf('Schedule timing: Maximum start time error %f usecs, one sample is %f usecs.\n', 1e6 * maxerr, 1e6 / freq);
+    if maxerr > 1 / freq
+        fprintf('FAILED: Start time error exceeds one sample duration!\n');
+        failed = failed + 1;
+    end
+
+    % Test 2: Loopback of a click:
+    pa = PsychPortAudio('Open', [], 3, [], freq, 1, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0);
+    PsychPortAudio('RunMode', pa, 0);
+    PsychPortAudio('GetAudioData', pa, 2);
+    click = zeros(1, freq / 10);
+    click(1000) = 0.5;
+    PsychPortAudio('FillBuffer', pa, click);
+    PsychPortAudio('Start', pa, 1, 0, 1);
+    PsychPortAudio('Stop', pa, 1);
+    recorded = PsychPortAudio('GetAudioData', pa);
+    PsychPortAudio('Close', pa);
+
+    if max(abs(recorded)) < 0.4
+        fprintf('FAILED: Click not found in looped back capture data!\n');
+        failed = failed + 1;
+    else
+        fprintf('Loopback: Click found in captured data.\n');
+    end
+
+    % Test 3: WAV file output:
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0, outfile);
+    PsychPortAudio('RunMode', pa, 0);
+    PsychPortAudio('FillBuffer', pa, 0.5 * [1; 1] * sin(2 * pi * 440 * (0:freq-1) / freq));
+    PsychPortAudio('Start', pa, 1, 0, 1);
+
+    % Changing the output file of a running device must be rejected:
+    try
+        PsychPortAudio('OfflineSettings', pa, [], [outfile '.new']);
+        fprintf('FAILED: Change of output file accepted while device is running!\n');
+        failed = failed + 1;
+    catch %#ok<CTCH>
+    end
+
+    PsychPortAudio('Stop', pa, 1);
+    [dummy, stats] = PsychPortAudio('OfflineSettings', pa);
+    PsychPortAudio('Close', pa);
+
+    d = dir(outfile);
+    if isempty(d) || (d.bytes ~= 44 + stats.FramesWritten * 2 * 4) || (stats.FramesWritten < freq)
+        fprintf('FAILED: WAV output file %s missing or of wrong size!\n', outfile);
+        failed = failed + 1;
+    else
+        fprintf('WAV output: %i frames written to %s.\n', stats.FramesWritten, outfile);
+    end
+
+    % Test 4: Throughput of master + slaves mixing:
+    pamaster = PsychPortAudio('Open', [], 1+8, [], freq, 8, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pamaster, 0);
+    for i = 1:nslaves
+        chans = 1 + mod(i, 2);
+        pa = PsychPortAudio('OpenSlave', pamaster, 1, chans, mod(i, 7) + (1:chans));
+        PsychPortAudio('FillBuffer', pa, 0.01 * (rand(chans, freq) - 0.5));
+        PsychPortAudio('Start', pa, 0, 0, 1);
+    end
+
+    PsychPortAudio('Start', pamaster, 0, 0, 1);
+    WaitSecs(2);
+    PsychPortAudio('Stop', pamaster, 1);
+    [dummy, stats] = PsychPortAudio('OfflineSettings', pamaster);
+    PsychPortAudio('Close');
+
+    fprintf('Throughput with %i slaves: %f buffers/sec, %f usecs cpu per buffer of %i frames, max %f usecs, %f x realtime.\n', ...
+            nslaves, stats.CallbacksPerSec, 1e6 * stats.CallbackSecsTotal / max(1, stats.Callbacks), buffersize, ...
+            1e6 * stats.CallbackSecsMax, stats.RealtimeFactor);
+catch
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+if failed > 0
+    error('%i offline device tests failed.', failed);
+end
+
+fprintf('All offline device tests passed.\n');
+
+return;
@@ -0,0 +1,102 @@
+function PsychPortAudioRecordToFileTest(duration, outfile)
+% PsychPortAudioRecordToFileTest([duration=10][, outfile])
+%
+% Regression test for streaming of captured sound data to a file via
+% PsychPortAudio('RecordToFile'). Uses a full-duplex offline device, which
+% loops its output back into its capture buffer, so it works without sound
+% hardware, see PsychPortAudioOfflineTest.
+%
+% The test plays a looped 1 second ramp signal on an offline device running
+% at 4 times realtime speed, with a capture buffer of only 2 seconds. It
+% records 'duration' seconds (default 10) of looped back sound into the raw
+% file 'outfile' (default: a file in the temp directory), without calling
+% PsychPortAudio('GetAudioData'). It then checks that the file contains the
+% complete ramp signal, and that the timestamps sidecar file logged the
+% start of the capture session. Overflows of the capture buffer, reported by
+% PsychPortAudio('GetStatus'), are reported as failures, so on a slow or
+% busy disk the test can fail without a bug in PsychPortAudio.
+%
+% see also: PsychTests, PsychPortAudio, PsychPortAudioOfflineTest
+
+if nargin < 1 || isempty(duration)
+    duration = 10;
+end
+
+if nargin < 2 || isempty(outfile)
+    outfile = [tempdir 'PsychPortAudioRecordToFileTest.raw'];
+end
+
+InitializePsychSound(1);
+
+freq = 48000;
+nchannels = 2;
+speed = 4;
+failed = 0;
+
+% Ramp from -0.5 to 0.5, different per channel:
+ramp = [1; 0.5] * ((0:freq-1) / freq - 0.5);
+
+try
+    pa = PsychPortAudio('Open', [], 3, [], freq, nchannels, 256, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, speed);
+    PsychPortAudio('GetAudioData', pa, 2);
+    PsychPortAudio('FillBuffer', pa, ramp);
+    PsychPortAudio('RecordToFile', pa, outfile);
+
+    PsychPortAudio('Start', pa, 0, 0, 1);
+    WaitSecs(duration / speed);
+    PsychPortAudio('Stop', pa, 1);
+
+    s = PsychPortAudio('GetStatus', pa);
+    PsychPortAudio('RecordToFile', pa);
+    s2 = PsychPortAudio('GetStatus', pa);
+    PsychPortAudio('Close', pa);
+catch
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+fprintf('Recorded %f secs, %f secs written to file before stop, %i overflows, %f secs lost.\n', ...
+        s.RecordedSecs, s.FileRecordedSecs, s.FileOverflows, s.FileLostSecs);
+
+fid = fopen(outfile, 'r');
+data = fread(fid, [nchannels, inf], 'float32');
+fclose(fid);
+
+if size(data, 2) ~= round(s.RecordedSecs * freq)
+    fprintf('FAILED: File contains %i sample frames instead of %i!\n', size(data, 2), round(s.RecordedSecs * freq));
+    failed = failed + 1;
+end
+
+if s.FileOverflows > 0 || s2.FileOverflows > 0
+    fprintf('FAILED: Capture buffer overflowed during recording!\n');
+    failed = failed + 1;
+end
+
+% Looped back ramp starts one buffer delayed, so find its start in the file:
+onset = find(abs(data(1, :) + 0.5) < 1e-3, 1);
+if isempty(onset) || size(data, 2) < onset + 2 * freq
+    fprintf('FAILED: Ramp signal not found in recorded file!\n');
+    failed = failed + 1;
+else
+    n = floor((size(data, 2) - onset + 1) / freq) * freq;
+    expected = repmat(ramp, 1, n / freq);
+    if max(max(abs(data(:, onset:onset+n-1) - expected))) > 1e-3
+        fprintf('FAILED: Recorded file does not contain the looped ramp signal!\n');
+        failed = failed + 1;
+    end
+end
+
+stamps = fileread([outfile '.timestamps']);
+if isempty(strfind(stamps, 'start,0,'))
+    fprintf('FAILED: Timestamps file lacks the start of the capture session!\n');
+    failed = failed + 1;
+end
+
+if failed > 0
+    error('%i record to file tests failed.', failed);
+end
+
+fprintf('Record to file test passed.\n');
+
+return;
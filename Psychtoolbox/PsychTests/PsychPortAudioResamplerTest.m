@@ -0,0 +1,120 @@
+function PsychPortAudioResamplerTest
+% PsychPortAudioResamplerTest
+%
+% Quality test and benchmark for the conversion of sound data at a sample
+% rate different from the one of the audio device, via the optional
+% 'sampleRate' argument of PsychPortAudio('FillBuffer'),
+% PsychPortAudio('RefillBuffer') and PsychPortAudio('CreateBuffer'). Uses
+% full-duplex offline devices, which loop their output back into their
+% capture buffer, so it works without sound hardware, see
+% PsychPortAudioOfflineTest.
+%
+% The test performs the following steps:
+%
+% 1. Length: Checks that n sample frames at 44100 Hz convert into
+%    ceil(n * 48000 / 44100) sample frames on a 48000 Hz device.
+%
+% 2. THD+N: Plays a 1 kHz sine tone at 44100 Hz on a 48000 Hz device, fits
+%    an ideal sine to the looped back sound and reports the total harmonic
+%    distortion plus noise as power of the residual relative to the tone.
+%
+% 3. Passband ripple: Plays tones from 100 Hz to 19 kHz at 44100 Hz on a
+%    48000 Hz device and reports the spread of their looped back amplitudes.
+%
+% 4. Throughput: Reports how much faster than realtime 'CreateBuffer'
+%    converts 60 seconds of stereo sound from 44100 Hz to 48000 Hz.
+%
+% see also: PsychTests, PsychPortAudio, PsychPortAudioOfflineTest
+
+InitializePsychSound(1);
+
+freq = 48000;
+srcfreq = 44100;
+buffersize = 256;
+failed = 0;
+
+try
+    % Test 1: Length of converted sound data:
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0);
+    for n = [1, 147, 1000, srcfreq + 1]
+        [dummy, nextIndex] = PsychPortAudio('FillBuffer', pa, zeros(2, n), 0, [], srcfreq);
+        if nextIndex ~= ceil(n * freq / srcfreq)
+            fprintf('FAILED: %i frames at %i Hz converted into %i instead of %i frames!\n', n, srcfreq, nextIndex, ceil(n * freq / srcfreq));
+            failed = failed + 1;
+        end
+    end
+    PsychPortAudio('Close', pa);
+    fprintf('Length: Converted lengths tested.\n');
+
+    % Test 2: THD+N of a 1 kHz tone:
+    [amplitude, residual] = playTone(freq, srcfreq, buffersize, 1000);
+    thdn = 20 * log10(residual / (amplitude / sqrt(2)));
+    fprintf('THD+N: 1 kHz tone at %i Hz on %i Hz device: %f dB.\n', srcfreq, freq, thdn);
+    if thdn > -90
+        fprintf('FAILED: THD+N of %f dB exceeds -90 dB!\n', thdn);
+        failed = failed + 1;
+    end
+
+    % Test 3: Passband ripple:
+    tones = [100, 1000:1000:19000];
+    amplitudes = zeros(size(tones));
+    for i = 1:length(tones)
+        amplitudes(i) = playTone(freq, srcfreq, buffersize, tones(i));
+    end
+    ripple = 20 * log10(max(amplitudes) / min(amplitudes));
+    fprintf('Passband ripple: %f dB for tones from %i Hz to %i Hz.\n', ripple, tones(1), tones(end));
+    if ripple > 0.1
+        fprintf('FAILED: Passband ripple of %f dB exceeds 0.1 dB!\n', ripple);
+        failed = failed + 1;
+    end
+
+    % Test 4: Throughput of conversion in 'CreateBuffer':
+    pa = PsychPortAudio('Open', [], 1, [], freq, 2, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pa, 0);
+    signal = single(rand(2, 60 * srcfreq) - 0.5);
+    tstart = GetSecs;
+    buffer = PsychPortAudio('CreateBuffer', pa, signal, srcfreq);
+    telapsed = GetSecs - tstart;
+    PsychPortAudio('DeleteBuffer', buffer);
+    PsychPortAudio('Close', pa);
+    fprintf('Throughput: Conversion of 60 secs stereo from %i Hz to %i Hz takes %f secs, %f times realtime.\n', srcfreq, freq, telapsed, 60 / telapsed);
+catch
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+if failed > 0
+    error('%i resampler tests failed.', failed);
+end
+
+fprintf('All resampler tests passed.\n');
+
+return;
+
+function [amplitude, residual] = playTone(freq, srcfreq, buffersize, tonefreq)
+% Play a 1 second sine tone of 'tonefreq' Hz at sample rate 'srcfreq' on a
+% full-duplex offline device at 'freq' Hz. Fit a sine to the looped back
+% sound and return its amplitude and the rms of the residual:
+tone = 0.5 * sin(2 * pi * tonefreq * (0:srcfreq-1) / srcfreq);
+
+pa = PsychPortAudio('Open', [], 3, [], freq, 1, buffersize, [], [], 32);
+PsychPortAudio('OfflineSettings', pa, 0);
+PsychPortAudio('RunMode', pa, 0);
+PsychPortAudio('GetAudioData', pa, 2);
+PsychPortAudio('FillBuffer', pa, tone, 0, [], srcfreq);
+PsychPortAudio('Start', pa, 1, 0, 1);
+PsychPortAudio('Stop', pa, 1);
+recorded = double(PsychPortAudio('GetAudioData', pa));
+PsychPortAudio('Close', pa);
+
+% Skip onset and fade out of the tone, where the filters see silence:
+onset = find(abs(recorded) > 1e-3, 1);
+x = recorded(onset + 1000 : onset + freq / 2)';
+t = (0:length(x)-1)' / freq;
+basis = [sin(2 * pi * tonefreq * t), cos(2 * pi * tonefreq * t), ones(size(t))];
+coeffs = basis \ x;
+amplitude = norm(coeffs(1:2));
+residual = sqrt(mean((x - basis * coeffs).^2));
+
+return;
@@ -0,0 +1,142 @@
+function PsychPortAudioStressTest(duration, nslaves, buffersize)
+% PsychPortAudioStressTest([duration=10][, nslaves=16][, buffersize=64])
+%
+% Stress test for the communication between the scripting thread and the
+% audio processing thread of PsychPortAudio. Uses an offline device, so it
+% works without sound hardware, see PsychPortAudioOfflineTest.
+%
+% The test opens an offline master device with a small 'buffersize' (default
+% 64 sample frames, ie. a deadline of 1.3 msecs per buffer at 48 kHz), which
+% runs at realtime speed. 'nslaves' slave devices (default 16) play looped
+% noise, and one additional slave is fed by streaming refills via
+% PsychPortAudio('FillBuffer', ..., 1). For 'duration' seconds (default 10),
+% the script then hammers the engine as fast as it can with
+% PsychPortAudio('GetStatus') calls on the master and the slaves, and with
+% PsychPortAudio('Volume') changes of master volume and slave channel
+% volumes, while keeping the streaming slave fed.
+%
+% None of these calls should stall the audio processing thread. The test
+% reports the number of calls per second, the number of dropouts, ie. the
+% 'XRuns' of the master and the 'DeadlineMisses' of the offline device, and
+% the maximum time spent in the audio engine for one buffer. It also checks
+% that each status returned by 'GetStatus' is a consistent snapshot, ie.
+% that 'ElapsedOutSamples' and 'CurrentStreamTime' of the master belong to
+% the same buffer, and that 'ElapsedOutSamples' never decreases.
+%
+% Dropouts can also be caused by other load on the machine, so if the test
+% fails due to dropouts, rerun it on an idle machine before drawing any
+% conclusions.
+%
+% see also: PsychTests, PsychPortAudio, PsychPortAudioOfflineTest
+
+if nargin < 1 || isempty(duration)
+    duration = 10;
+end
+
+if nargin < 2 || isempty(nslaves)
+    nslaves = 16;
+end
+
+if nargin < 3 || isempty(buffersize)
+    buffersize = 64;
+end
+
+InitializePsychSound(1);
+
+freq = 48000;
+nchannels = 2;
+failed = 0;
+
+try
+    % Offline master at realtime speed:
+    pamaster = PsychPortAudio('Open', [], 1+8, [], freq, nchannels, buffersize, [], [], 32);
+    PsychPortAudio('OfflineSettings', pamaster, 1);
+    PsychPortAudio('Start', pamaster, 0, 0, 1);
+
+    % Slaves with looped noise:
+    slaves = zeros(1, nslaves);
+    for i = 1:nslaves
+        slaves(i) = PsychPortAudio('OpenSlave', pamaster, 1, nchannels);
+        PsychPortAudio('FillBuffer', slaves(i), 0.01 * (rand(nchannels, freq) - 0.5));
+        PsychPortAudio('Start', slaves(i), 0, 0, 1);
+    end
+
+    % Streaming slave with a 1 second ringbuffer, fed in 50 msecs chunks:
+    pastream = PsychPortAudio('OpenSlave', pamaster, 1, nchannels);
+    chunk = round(freq / 20);
+    PsychPortAudio('FillBuffer', pastream, zeros(nchannels, freq));
+    PsychPortAudio('Start', pastream, 0, 0, 1);
+    written = freq;
+
+    ncalls = 0;
+    nrefills = 0;
+    inconsistent = 0;
+    lastElapsed = 0;
+    tstart = GetSecs;
+
+    while GetSecs - tstart < duration
+        % Status of master: Must be a consistent snapshot:
+        s = PsychPortAudio('GetStatus', pamaster);
+        if s.ElapsedOutSamples < lastElapsed
+            inconsistent = inconsistent + 1;
+        end
+        lastElapsed = s.ElapsedOutSamples;
+
+        if s.Active && abs((s.CurrentStreamTime - s.StartTime) - s.ElapsedOutSamples / freq) > 2 / freq
+            inconsistent = inconsistent + 1;
+        end
+
+        % Status and volume changes of a random slave, and of the master:
+        pa = slaves(randi(nslaves));
+        PsychPortAudio('GetStatus', pa);
+        PsychPortAudio('Volume', pa, 1, 0.5 + 0.5 * rand(1, nchannels));
+        PsychPortAudio('Volume', pamaster, 0.9 + 0.1 * rand);
+        ncalls = ncalls + 4;
+
+        % Keep the streaming slave fed half a second ahead:
+        s = PsychPortAudio('GetStatus', pastream);
+        if written - s.ElapsedOutSamples < freq / 2
+            PsychPortAudio('FillBuffer', pastream, 0.01 * (rand(nchannels, chunk) - 0.5), 1);
+            written = written + chunk;
+            nrefills = nrefills + 1;
+        end
+    end
+
+    telapsed = GetSecs - tstart;
+    s = PsychPortAudio('GetStatus', pamaster);
+    [dummy, stats] = PsychPortAudio('OfflineSettings', pamaster);
+    sstream = PsychPortAudio('GetStatus', pastream);
+    PsychPortAudio('Stop', pamaster, 1);
+    PsychPortAudio('Close');
+catch
+    PsychPortAudio('Close');
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\n%i slaves, buffersize %i frames = %f msecs per buffer, %f secs:\n', nslaves, buffersize, 1000 * buffersize / freq, telapsed);
+fprintf('%f GetStatus/Volume calls per second, %i streaming refills.\n', ncalls / telapsed, nrefills);
+fprintf('%i buffers processed, max %f msecs per buffer, %i xruns, %i deadline misses.\n', ...
+        stats.Callbacks, 1000 * stats.CallbackSecsMax, s.XRuns, stats.DeadlineMisses);
+
+if inconsistent > 0
+    fprintf('FAILED: %i inconsistent status snapshots returned by GetStatus!\n', inconsistent);
+    failed = failed + 1;
+end
+
+if s.XRuns > 0
+    fprintf('FAILED: Audio engine missed %i buffer deadlines!\n', s.XRuns);
+    failed = failed + 1;
+end
+
+if written - sstream.ElapsedOutSamples < 0
+    fprintf('FAILED: Streaming refills fell behind playback!\n');
+    failed = failed + 1;
+end
+
+if failed > 0
+    error('%i stress tests failed.', failed);
+end
+
+fprintf('Stress test passed.\n');
+
+return;
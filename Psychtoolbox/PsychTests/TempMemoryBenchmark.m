@@ -0,0 +1,84 @@
+function results = TempMemoryBenchmark(numFrames, screenNumber)
+% results = TempMemoryBenchmark([numFrames=600][, screenNumber=max])
+%
+% Benchmark the allocator for temporary memory of Screen() with a typical
+% mix of calls per frame: Screen('DrawDots') with 1000 dots of individual
+% colors and sizes, Screen('DrawTextures') of 100 textures with individual
+% rects, angles and colors, and Screen('GetImage') of a 256 x 256 pixels
+% rect, then Screen('Flip') without sync to retrace.
+%
+% Reports the mean duration of a frame, and the statistics of the temporary
+% memory allocator, as returned by Screen('Profile', 'TempMemory'), over
+% the measured frames. After a few frames of warmup, all frames should be
+% served from the arena and the pool of released buffers, so the number of
+% 'SystemAllocations' should not grow during the measurement. On Matlab,
+% temporary memory is managed by Matlab instead, so only the number of
+% allocations and Bytes requested are meaningful.
+%
+% Returns a struct 'results' with the fields 'frameTime' for the mean
+% duration of a frame in seconds, and 'before' and 'after' with the
+% allocator statistics before and after the measurement.
+%
+% see also: PsychTests, DispatchOverheadBenchmark
+
+if nargin < 1 || isempty(numFrames)
+    numFrames = 600;
+end
+
+if nargin < 2 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+    [width, height] = Screen('WindowSize', w);
+
+    numDots = 1000;
+    numTex = 100;
+    tex = Screen('MakeTexture', w, uint8(rand(64, 64, 3) * 255));
+
+    % Warmup, so the allocator fills its arena and pool:
+    for i = 1:10
+        DrawFrame(w, tex, width, height, numDots, numTex);
+    end
+
+    results.before = Screen('Profile', 'TempMemory');
+    t0 = GetSecs;
+    for i = 1:numFrames
+        DrawFrame(w, tex, width, height, numDots, numTex);
+    end
+    results.frameTime = (GetSecs - t0) / numFrames;
+    results.after = Screen('Profile', 'TempMemory');
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nMean duration of a frame: %f msecs.\n\n', results.frameTime * 1000);
+fprintf('Temporary memory allocator, per frame:\n');
+fields = fieldnames(results.after);
+for i = 1:length(fields)
+    if any(strcmp(fields{i}, {'BytesInUse', 'PeakBytesInUse', 'BytesPooled', 'ArenaBytes'}))
+        fprintf('%-20s %14.0f\n', fields{i}, results.after.(fields{i}));
+    else
+        fprintf('%-20s %14.1f\n', fields{i}, (results.after.(fields{i}) - results.before.(fields{i})) / numFrames);
+    end
+end
+fprintf('\n');
+
+return;
+
+function DrawFrame(w, tex, width, height, numDots, numTex)
+% Draw, read back and flip one frame of the call mix:
+xy = [rand(1, numDots) * width; rand(1, numDots) * height];
+Screen('DrawDots', w, xy, 1 + rand(1, numDots) * 4, rand(3, numDots) * 255, [], 1);
+
+rects = [rand(1, numTex) * width; rand(1, numTex) * height];
+rects = [rects; rects + 64];
+Screen('DrawTextures', w, tex, [], rects, rand(1, numTex) * 360, [], [], rand(3, numTex) * 255);
+
+img = Screen('GetImage', w, [0 0 256 256]); %#ok<NASGU>
+Screen('Flip', w, [], [], 2);
+return;
@@ -0,0 +1,129 @@
+function results = TexturePoolBenchmark(numTextures, numFrames, screenNumber)
+% results = TexturePoolBenchmark([numTextures=2000][, numFrames=100][, screenNumber=max])
+%
+% Benchmark drawing of many different small textures with and without the
+% texture pool for small textures of Screen('MakeTexture').
+%
+% Creates 'numTextures' textures of random sizes between 8 x 8 and 64 x 64
+% pixels, once as standalone textures and once with 'specialFlags' 64, which
+% stores them in the shared pages of the texture pool. Then every second
+% texture gets closed and recreated with a new random size, so the pool
+% recycles the slots of closed textures, which may be bigger than needed.
+% Each frame draws all
+% textures with one call to Screen('DrawTextures'), scaled and rotated at
+% random positions with bilinear filtering, followed by a Screen('Flip')
+% without sync to retrace. Without the pool, each texture is its own batch
+% with its own texture bind. With the pool, all textures are one batch.
+%
+% Also draws the same frame with both sets of textures and reports the
+% maximum difference between the pixels read back via Screen('GetImage'),
+% which should be zero or close to zero.
+%
+% Returns a struct 'results' with the fields 'msecsStandalone' and
+% 'msecsPooled' for the mean duration of a frame in milliseconds,
+% 'memoryMBStandalone' and 'memoryMBPooled' for the estimated texture
+% memory in Megabytes, 'poolPages' for the number of pages of the pool,
+% and 'maxDifference' for the maximum pixel difference. Memory of the
+% standalone textures is estimated as 4 bytes per texel, as Screen does for
+% its own accounting. It doesn't include per texture overhead of the
+% graphics driver, so real savings are usually higher.
+%
+% see also: PsychTests, DrawTexturesInstancingBenchmark
+
+if nargin < 1 || isempty(numTextures)
+    numTextures = 2000;
+end
+
+if nargin < 2 || isempty(numFrames)
+    numFrames = 100;
+end
+
+if nargin < 3 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+try
+    w = Screen('OpenWindow', screenNumber, 128);
+    [width, height] = Screen('WindowSize', w);
+    Screen('BlendFunction', w, 'GL_SRC_ALPHA', 'GL_ONE_MINUS_SRC_ALPHA');
+
+    % Same random images for both sets of textures:
+    standalone = zeros(1, numTextures);
+    pooled = zeros(1, numTextures);
+    texels = zeros(1, numTextures);
+    for i = 1:numTextures
+        img = uint8(rand(8 + floor(rand * 57), 8 + floor(rand * 57), 4) * 255);
+        texels(i) = size(img, 1) * size(img, 2);
+        standalone(i) = Screen('MakeTexture', w, img);
+        pooled(i) = Screen('MakeTexture', w, img, [], 64);
+    end
+
+    % Close and recreate every second texture, so freed slots get reused:
+    reused = 2:2:numTextures;
+    Screen('Close', [standalone(reused), pooled(reused)]);
+    for i = reused
+        img = uint8(rand(8 + floor(rand * 57), 8 + floor(rand * 57), 4) * 255);
+        texels(i) = size(img, 1) * size(img, 2);
+        standalone(i) = Screen('MakeTexture', w, img);
+        pooled(i) = Screen('MakeTexture', w, img, [], 64);
+    end
+
+    info = Screen('GetWindowInfo', w);
+    results.memoryMBStandalone = sum(texels) * 4 / 1024 / 1024;
+    results.memoryMBPooled = info.TexturePoolMemoryMB;
+    results.poolPages = info.TexturePoolPages;
+
+    % Same frame with both sets, for comparison of results:
+    [dstRects, angles] = RandomPatches(numTextures, width, height);
+    Screen('FillRect', w, 128);
+    Screen('DrawTextures', w, standalone, [], dstRects, angles, 1);
+    imgStandalone = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+
+    Screen('FillRect', w, 128);
+    Screen('DrawTextures', w, pooled, [], dstRects, angles, 1);
+    imgPooled = Screen('GetImage', w, [], 'backBuffer');
+    Screen('Flip', w, [], [], 2);
+
+    results.maxDifference = max(abs(double(imgStandalone(:)) - double(imgPooled(:))));
+
+    results.msecsStandalone = MeasureFrames(w, standalone, dstRects, angles, numFrames);
+    results.msecsPooled = MeasureFrames(w, pooled, dstRects, angles, numFrames);
+
+    sca;
+catch
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nFrames of %i different textures:\n\n', numTextures);
+fprintf('%-12s %14s %14s\n', '', 'Msecs/frame', 'Memory MB');
+fprintf('%-12s %14.3f %14.1f\n', 'Standalone', results.msecsStandalone, results.memoryMBStandalone);
+fprintf('%-12s %14.3f %14.1f  (%i pages)\n', 'Pooled', results.msecsPooled, results.memoryMBPooled, results.poolPages);
+fprintf('\nMaximum difference of pixel values: %f\n\n', results.maxDifference);
+
+return;
+
+function [dstRects, angles] = RandomPatches(numPatches, width, height)
+% Random target rects between 16 x 16 and 96 x 96 pixels and rotation angles:
+sizes = 16 + rand(1, numPatches) * 80;
+xy = [rand(1, numPatches) * (width - 96); rand(1, numPatches) * (height - 96)];
+dstRects = [xy; xy + [sizes; sizes]];
+angles = rand(1, numPatches) * 360;
+return;
+
+function msecs = MeasureFrames(w, textures, dstRects, angles, numFrames)
+% Return mean duration of drawing and flipping a frame, in msecs:
+
+% Warmup:
+Screen('DrawTextures', w, textures, [], dstRects, angles, 1);
+Screen('Flip', w, [], [], 2);
+
+t0 = GetSecs;
+for i = 1:numFrames
+    Screen('DrawTextures', w, textures, [], dstRects, angles, 1);
+    Screen('Flip', w, [], [], 2);
+end
+Screen('DrawingFinished', w, [], 1);
+msecs = (GetSecs - t0) / numFrames * 1000;
+return;
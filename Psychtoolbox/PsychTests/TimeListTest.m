@@ -0,0 +1,70 @@
+function TimeListTest(nSamples, capacity, ringMode)
+% TimeListTest([nSamples=1000][, capacity=100000][, ringMode=0])
+%
+% Exercise Screen's internal timestamp list, as used by Screen's internal
+% diagnostics, and print per call site timing statistics.
+%
+% The test enables the 'DebugMakeTexture' preference, which makes
+% Screen('MakeTexture') store tagged timestamps at four points of its
+% execution into Screen's time list, then creates and destroys 'nSamples'
+% small textures. The time list is preallocated for 'capacity' timestamps
+% via Screen('ClearTimeList', capacity, ringMode), so storing timestamps
+% doesn't allocate memory. If 'ringMode' is 1, only the most recent
+% 'capacity' timestamps are kept.
+%
+% Afterwards it prints the statistics computed by Screen('GetTimeListStats')
+% for each tag. Tag 3 vs. tag 2 brackets a single malloc() call, so the
+% minimum duration for tag 3 is an upper bound on the overhead of storing a
+% single timestamp.
+%
+% see also: PsychTests
+
+if nargin < 1 || isempty(nSamples)
+    nSamples = 1000;
+end
+
+if nargin < 2 || isempty(capacity)
+    capacity = 100000;
+end
+
+if nargin < 3 || isempty(ringMode)
+    ringMode = 0;
+end
+
+oldDebug = Screen('Preference', 'DebugMakeTexture', 1);
+
+try
+    w = Screen('OpenWindow', max(Screen('Screens')), 0, [0 0 100 100]);
+    img = uint8(rand(16, 16) * 255);
+
+    Screen('ClearTimeList', capacity, ringMode);
+    for i = 1:nSamples
+        tex = Screen('MakeTexture', w, img);
+        Screen('Close', tex);
+    end
+
+    [times, tags] = Screen('GetTimeList');
+    stats = Screen('GetTimeListStats');
+    Screen('ClearTimeList');
+    sca;
+
+    if ringMode && numel(times) > capacity
+        error('Ring mode time list returned %i timestamps, more than its capacity of %i!', numel(times), capacity);
+    end
+catch
+    Screen('Preference', 'DebugMakeTexture', oldDebug);
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+Screen('Preference', 'DebugMakeTexture', oldDebug);
+
+fprintf('\n%i timestamps retrieved, %i distinct tags.\n\n', numel(times), numel(unique(tags)));
+fprintf('Tag     Count      Min [us]    Median [us]   P90 [us]     P99 [us]     Max [us]\n');
+for i = 1:numel(stats)
+    fprintf('%3i  %8i  %12.3f %12.3f %12.3f %12.3f %12.3f\n', stats(i).Tag, stats(i).Count, ...
+            1e6 * stats(i).Min, 1e6 * stats(i).Median, 1e6 * stats(i).P90, 1e6 * stats(i).P99, 1e6 * stats(i).Max);
+end
+fprintf('\n');
+
+return;
@@ -0,0 +1,118 @@
+function results = VertexStreamingBenchmark(numFrames, screenNumber)
+% results = VertexStreamingBenchmark([numFrames=100][, screenNumber=max])
+%
+% Benchmark Screen('DrawDots'), Screen('DrawLines') and Screen('FillRect')
+% with batches of 10 to 100000 primitives, with and without streaming of
+% their vertex arrays into a vertex buffer object.
+%
+% By default, Screen copies the vertex arrays of these batch drawing
+% commands into a persistently mapped streaming vertex buffer, or into a
+% vertex buffer updated via glBufferSubData() if persistent mapping is not
+% supported. The 'ConserveVRAM' setting kPsychDontUseVertexStreaming = 2^29
+% disables this, so OpenGL reads the arrays from the matrices passed to
+% Screen. Each frame draws 20 batches of each command, followed by a
+% Screen('Flip') without sync to retrace.
+%
+% Reports the calls per second of each command and the cpu time per call in
+% microseconds, which includes the time the OpenGL driver spent in the
+% calling thread. For results independent of a specific graphics card,
+% e.g., for regression testing, run this under Mesa's software rasterizer
+% on Linux, by starting Octave or Matlab with the environment variable
+% LIBGL_ALWAYS_SOFTWARE=1 set.
+%
+% Returns a struct array 'results' with one element per tested config,
+% with the fields 'command', 'batchSize', 'streaming', 'callsPerSec' and
+% 'cpuPerCall'.
+%
+% see also: PsychTests, ConserveVRAMSettings, DrawDotsDataTypeBenchmark
+
+if nargin < 1 || isempty(numFrames)
+    numFrames = 100;
+end
+
+if nargin < 2 || isempty(screenNumber)
+    screenNumber = max(Screen('Screens'));
+end
+
+callsPerFrame = 20;
+oldConserve = Screen('Preference', 'ConserveVRAM');
+kPsychDontUseVertexStreaming = 2^29;
+
+try
+    w = Screen('OpenWindow', screenNumber, 0);
+    [width, height] = Screen('WindowSize', w);
+
+    fprintf('\n%-10s %10s %10s %14s %14s\n', 'Command', 'Batch', 'Streaming', 'Calls/sec', 'CPU usecs/call');
+
+    results = struct('command', {}, 'batchSize', {}, 'streaming', {}, 'callsPerSec', {}, 'cpuPerCall', {});
+    for command = {'DrawDots', 'DrawLines', 'FillRect'}
+        command = command{1};
+        for batchSize = [10, 100, 1000, 10000, 100000]
+            % Random primitives with individual colors:
+            if strcmp(command, 'FillRect')
+                xy = [rand(1, batchSize) * width; rand(1, batchSize) * height];
+                xy = [xy; xy + 10];
+            else
+                xy = [rand(1, batchSize) * width; rand(1, batchSize) * height];
+            end
+            colors = uint8(rand(3, size(xy, 2)) * 255);
+
+            for streaming = [1 0]
+                if streaming
+                    Screen('Preference', 'ConserveVRAM', oldConserve - bitand(oldConserve, kPsychDontUseVertexStreaming));
+                else
+                    Screen('Preference', 'ConserveVRAM', bitor(oldConserve, kPsychDontUseVertexStreaming));
+                end
+
+                [t, c] = DrawFrames(w, command, xy, colors, numFrames, callsPerFrame);
+
+                results(end+1).command = command; %#ok<AGROW>
+                results(end).batchSize = batchSize;
+                results(end).streaming = streaming;
+                results(end).callsPerSec = numFrames * callsPerFrame / t;
+                results(end).cpuPerCall = c / (numFrames * callsPerFrame) * 1e6;
+                fprintf('%-10s %10i %10i %14.1f %14.1f\n', command, batchSize, streaming, results(end).callsPerSec, results(end).cpuPerCall);
+            end
+        end
+    end
+
+    Screen('Preference', 'ConserveVRAM', oldConserve);
+    sca;
+catch
+    Screen('Preference', 'ConserveVRAM', oldConserve);
+    sca;
+    psychrethrow(psychlasterror);
+end
+
+return;
+
+function [t, c] = DrawFrames(w, command, xy, colors, numFrames, callsPerFrame)
+% Return wall clock and cpu time of 'numFrames' frames of drawing:
+DrawBatch(w, command, xy, colors);
+Screen('Flip', w);
+
+t0 = GetSecs;
+c0 = cputime;
+for i = 1:numFrames
+    for j = 1:callsPerFrame
+        DrawBatch(w, command, xy, colors);
+    end
+    Screen('Flip', w, [], [], 2);
+end
+
+% Wait for the last frame to complete, to include all pending work:
+Screen('DrawingFinished', w, [], 1);
+t = GetSecs - t0;
+c = cputime - c0;
+return;
+
+function DrawBatch(w, command, xy, colors)
+switch command
+    case 'DrawDots'
+        Screen('DrawDots', w, xy, 2, colors);
+    case 'DrawLines'
+        Screen('DrawLines', w, xy, 1, colors);
+    case 'FillRect'
+        Screen('FillRect', w, colors, xy);
+end
+return;
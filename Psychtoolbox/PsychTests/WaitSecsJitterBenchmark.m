@@ -0,0 +1,120 @@
+function results = WaitSecsJitterBenchmark(nWaits, percentiles, nLoadProcesses)
+% results = WaitSecsJitterBenchmark([nWaits=1000][, percentiles=[50, 95, 99.9]][, nLoadProcesses=#cpus])
+%
+% Benchmark lateness and cpu cost of WaitSecs('UntilTime') on Linux, for
+% different settings of the spin window percentile, once on an idle
+% machine and once under cpu load.
+%
+% WaitSecs sleeps until shortly before a deadline, then busy-waits until
+% the deadline. The busy-waiting window is adapted to the wakeup latencies
+% of the operating system, so that a given percentile of them is covered,
+% see "WaitSecs Stats?". Higher percentiles cause fewer late wakeups, but
+% more cpu load.
+%
+% This doesn't need a display, so it can run on a headless machine. For
+% each of the 'percentiles' (default 50, 95 and 99.9 percent), it does
+% 'nWaits' waits (default 1000) of 1 to 5 msecs. The cpu load is generated
+% by 'nLoadProcesses' processes (default one per cpu core), via the
+% 'stress-ng' utility if it is installed, or via shell busy loops
+% otherwise.
+%
+% Returns a struct array 'results' with one element per load condition and
+% percentile, with the fields 'load', 'percentile', 'missedDeadlines' for
+% the number of waits which ended over 0.1 msecs late, 'msecsMedianLate',
+% 'msecs99Late' and 'msecsMaxLate' for the median, 99th percentile and
+% maximum lateness, 'spinPercent' for the percentage of wait time spent
+% busy-waiting, and 'stats' for the full WaitSecs('Stats') of the run.
+%
+% see also: PsychTests, WaitSecs, GetSecsTest
+
+if nargin < 1 || isempty(nWaits)
+    nWaits = 1000;
+end
+
+if nargin < 2 || isempty(percentiles)
+    percentiles = [50, 95, 99.9];
+end
+
+if nargin < 3 || isempty(nLoadProcesses)
+    [rc, ncpus] = system('nproc');
+    nLoadProcesses = str2double(ncpus);
+    if rc ~= 0 || isnan(nLoadProcesses)
+        nLoadProcesses = 1;
+    end
+end
+
+if ~IsLinux
+    error('This test needs Linux, as WaitSecs(''Stats'') is only supported on Linux.');
+end
+
+% Load generator, which terminates itself after a while in any case. The
+% pids of its processes get recorded in a file, so only they get killed.
+% stress-ng and timeout pass the termination on to their child processes:
+loadSecs = ceil(nWaits * 0.004 * length(percentiles)) + 10;
+pidFile = tempname;
+if system('which stress-ng > /dev/null') == 0
+    loadStart = sprintf('stress-ng --cpu %i --timeout %i > /dev/null 2>&1 & echo $! > %s', nLoadProcesses, loadSecs, pidFile);
+else
+    loadStart = sprintf('rm -f %s; for i in $(seq %i); do timeout %i sh -c "while :; do :; done" & echo $! >> %s; done', pidFile, nLoadProcesses, loadSecs, pidFile);
+end
+loadStop = sprintf('kill $(cat %s 2> /dev/null) 2> /dev/null; rm -f %s', pidFile, pidFile);
+
+loads = {'idle', 'loaded'};
+results = struct('load', {}, 'percentile', {}, 'missedDeadlines', {}, 'msecsMedianLate', {}, 'msecs99Late', {}, 'msecsMaxLate', {}, 'spinPercent', {}, 'stats', {});
+oldStats = WaitSecs('Stats');
+
+try
+    for l = 1:length(loads)
+        if strcmp(loads{l}, 'loaded')
+            system(loadStart);
+            WaitSecs('YieldSecs', 1);
+        end
+
+        for p = 1:length(percentiles)
+            % Set percentile and let the spin window adapt to it:
+            WaitSecs('Stats', 1, percentiles(p));
+            for i = 1:100
+                WaitSecs('UntilTime', GetSecs + 0.001 + rand * 0.004);
+            end
+            WaitSecs('Stats', 1);
+
+            late = zeros(1, nWaits);
+            for i = 1:nWaits
+                tWhen = GetSecs + 0.001 + rand * 0.004;
+                late(i) = WaitSecs('UntilTime', tWhen) - tWhen;
+            end
+            stats = WaitSecs('Stats', 1);
+
+            late = sort(late) * 1000;
+            i = length(results) + 1;
+            results(i).load = loads{l};
+            results(i).percentile = percentiles(p);
+            results(i).missedDeadlines = stats.missedDeadlines;
+            results(i).msecsMedianLate = late(max(1, round(0.5 * end)));
+            results(i).msecs99Late = late(max(1, round(0.99 * end)));
+            results(i).msecsMaxLate = late(end);
+            results(i).spinPercent = stats.totalSpinSecs / stats.totalWaitSecs * 100;
+            results(i).stats = stats;
+        end
+
+        if strcmp(loads{l}, 'loaded')
+            system(loadStop);
+        end
+    end
+catch
+    system(loadStop);
+    WaitSecs('Stats', 0, oldStats.percentile);
+    psychrethrow(psychlasterror);
+end
+
+WaitSecs('Stats', 0, oldStats.percentile);
+
+fprintf('\n%i waits of 1 to 5 msecs, load by %i processes:\n\n', nWaits, nLoadProcesses);
+fprintf('%-7s %10s %8s %16s %14s %14s %8s\n', 'Load', 'Percentile', 'Missed', 'Median late ms', '99% late ms', 'Max late ms', 'Spin %');
+for i = 1:length(results)
+    fprintf('%-7s %10.1f %8i %16.3f %14.3f %14.3f %8.1f\n', results(i).load, results(i).percentile, results(i).missedDeadlines, ...
+            results(i).msecsMedianLate, results(i).msecs99Late, results(i).msecsMaxLate, results(i).spinPercent);
+end
+fprintf('\n');
+
+return;